@@ -202,6 +202,22 @@ uint16_t fifoBuf_getData(t_fifo_buffer *buf, void *data, uint16_t len)
     return i;                   // return number of bytes copied
 }
 
+uint16_t fifoBuf_getReadRegion(t_fifo_buffer *buf, uint8_t **data)
+{       // point at the oldest data without copying it, release it with fifoBuf_removeData()
+
+    uint16_t rd = buf->rd;
+    uint16_t wr = buf->wr;
+    uint16_t buf_size = buf->buf_size;
+
+    *data = buf->buf_ptr + rd;
+
+    // only the part up to the end of the buffer is contiguous
+    if (wr < rd)
+        return buf_size - rd;
+
+    return wr - rd;
+}
+
 uint16_t fifoBuf_putByte(t_fifo_buffer *buf, const uint8_t b)
 {       // add a data byte to the buffer
 
@@ -56,6 +56,8 @@ int16_t fifoBuf_getByte(t_fifo_buffer *buf);
 uint16_t fifoBuf_getDataPeek(t_fifo_buffer *buf, void *data, uint16_t len);
 uint16_t fifoBuf_getData(t_fifo_buffer *buf, void *data, uint16_t len);
 
+uint16_t fifoBuf_getReadRegion(t_fifo_buffer *buf, uint8_t **data);
+
 uint16_t fifoBuf_putByte(t_fifo_buffer *buf, const uint8_t b);
 
 uint16_t fifoBuf_putData(t_fifo_buffer *buf, const void *data, uint16_t len);
@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ *
+ * @file       sample_clock.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Time step of sensor samples from their capture time
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pios_delay.h"
+
+//! Tracks the gyro samples a filter has integrated
+struct sample_clock {
+	uint32_t last_timestamp; //!< capture time of the previous sample
+	uint32_t last_timeval;   //!< when the previous sample was processed
+	bool restarted;          //!< no previous sample to measure from
+};
+
+//! Longest believable time between two gyro samples
+#define SAMPLE_DT_MAX 0.1f
+
+/**
+ * Restart a sample clock, the next interval is taken from the cpu clock
+ */
+static inline void sample_clock_reset(struct sample_clock *clock)
+{
+	clock->last_timeval = PIOS_DELAY_GetRaw();
+	clock->restarted = true;
+}
+
+/**
+ * Compute the time covered by a gyro sample from the time the driver
+ * captured it, so that scheduling jitter of the filter task does not get
+ * into the integration. Samples without a usable capture time, such as
+ * gyros written by a simulator, fall back to the time between calls.
+ * @param[in] clock The filter's sample clock
+ * @param[in] timestamp The capture time of the new sample
+ * @return the time step in seconds
+ */
+static inline float sample_clock_dT(struct sample_clock *clock, uint32_t timestamp)
+{
+	float dT = PIOS_DELAY_DiffuS2(clock->last_timestamp, timestamp) * 1.0e-6f;
+
+	if (clock->restarted || dT <= 0 || dT > SAMPLE_DT_MAX)
+		dT = PIOS_DELAY_DiffuS(clock->last_timeval) * 1.0e-6f;
+
+	clock->last_timestamp = timestamp;
+	clock->last_timeval = PIOS_DELAY_GetRaw();
+	clock->restarted = false;
+
+	return dT;
+}
+
+#endif /* SAMPLE_CLOCK_H */
+
+/**
+ * @}
+ */
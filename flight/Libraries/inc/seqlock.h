@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ *
+ * @file       seqlock.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Lock free handoff of a structure from one writer to readers
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/**
+ * Mark the start of a write, the sequence is odd until seqlock_write_end().
+ * There must only ever be one writer.
+ * @param[in] seq The sequence of the protected data
+ */
+static inline void seqlock_write_begin(volatile uint32_t *seq)
+{
+	*seq = *seq + 1;
+	__sync_synchronize();
+}
+
+/**
+ * Mark the end of a write
+ * @param[in] seq The sequence of the protected data
+ */
+static inline void seqlock_write_end(volatile uint32_t *seq)
+{
+	__sync_synchronize();
+	*seq = *seq + 1;
+}
+
+/**
+ * Copy the protected data without blocking the writer
+ * @param[in] seq The sequence of the protected data
+ * @param[out] dest Where to copy the data, left torn if the copy failed
+ * @param[in] src The protected data
+ * @param[in] size Size of the data
+ * @param[in] tries How many copies to attempt
+ * @return true if a consistent copy was made
+ *
+ * A reader that preempted the writer can not wait for it to finish, so
+ * the number of attempts is bounded and the caller decides what to do
+ * without a copy.
+ */
+static inline bool seqlock_read(const volatile uint32_t *seq, void *dest,
+                                const void *src, size_t size, uint8_t tries)
+{
+	for (uint8_t i = 0; i < tries; i++) {
+		uint32_t start = *seq;
+		if (start & 1)
+			continue;
+
+		__sync_synchronize();
+		memcpy(dest, src, size);
+		__sync_synchronize();
+
+		if (*seq == start)
+			return true;
+	}
+
+	return false;
+}
+
+#endif /* SEQLOCK_H */
+
+/**
+ * @}
+ */
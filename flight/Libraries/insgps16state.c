@@ -40,6 +40,11 @@
 #define NUMW 12			// number of plant noise inputs, w is disturbance noise vector
 #define NUMV 10			// number of measurements, v is the measurement noise vector
 #define NUMU 6			// number of deterministic inputs, U is the input vector
+#define NUMP (NUMX * (NUMX + 1) / 2)	// number of unique elements of the covariance P
+
+// P is symmetric so only the upper triangle is stored, row by row. PIDX gives the
+// position of element (i,j) for i <= j and folds to a constant for constant indices.
+#define PIDX(i, j) ((i) * (2 * NUMX - (i) - 1) / 2 + (j))
 
 #if defined(GENERAL_COV)
 // This might trick people so I have a note here.  There is a slower but bigger version of the 
@@ -49,9 +54,9 @@
 
 // Private functions
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-			  float Q[NUMW], float dT, float P[NUMX][NUMX]);
+			  float Q[NUMW], float dT, float P[NUMP]);
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-		  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+		  float Y[NUMV], float P[NUMP], float X[NUMX],
 		  uint16_t SensorsUsed);
 void RungeKutta(float X[NUMX], float U[NUMU], float dT);
 void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX]);
@@ -64,7 +69,7 @@ void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
 float F[NUMX][NUMX], G[NUMX][NUMW], H[NUMV][NUMX];	// linearized system matrices
 													// global to init to zero and maintain zero elements
 float Be[3];			// local magnetic unit vector in NED frame
-float P[NUMX][NUMX], X[NUMX];	// covariance matrix and state vector
+float P[NUMP], X[NUMX];		// covariance matrix (upper triangle) and state vector
 float Q[NUMW], R[NUMV];		// input noise and measurement noise variances
 float K[NUMX][NUMV];		// feedback gain matrix
 
@@ -82,11 +87,12 @@ void INSGPSInit()		//pretty much just a place holder for now
 	Be[1] = 0;
 	Be[2] = 0;		// local magnetic unit vector
 
+	for (int i = 0; i < NUMP; i++)
+		P[i] = 0.0f; // zero all terms
+
 	for (int i = 0; i < NUMX; i++) {
-		for (int j = 0; j < NUMX; j++) {
-			P[i][j] = 0.0f; // zero all terms
+		for (int j = 0; j < NUMX; j++)
 			F[i][j] = 0.0f;
-		}
 		for (int j = 0; j < NUMW; j++)
 			G[i][j] = 0.0f;
 			
@@ -102,11 +108,11 @@ void INSGPSInit()		//pretty much just a place holder for now
 	for (int i = 0; i < NUMV; i++) 
 		R[i] = 0.0f;
 	
-	P[0][0] = P[1][1] = P[2][2] = 25.0f;	// initial position variance (m^2)
-	P[3][3] = P[4][4] = P[5][5] = 5.0f;	// initial velocity variance (m/s)^2
-	P[6][6] = P[7][7] = P[8][8] = P[9][9] = 1e-5f;	// initial quaternion variance
-	P[10][10] = P[11][11] = P[12][12] = 1e-6f;	// initial gyro bias variance (rad/s)^2
-	P[13][13] = P[14][14] = P[15][15] = 1e-5f;	// initial accel bias variance (deg/s)^2
+	P[PIDX(0,0)] = P[PIDX(1,1)] = P[PIDX(2,2)] = 25.0f;	// initial position variance (m^2)
+	P[PIDX(3,3)] = P[PIDX(4,4)] = P[PIDX(5,5)] = 5.0f;	// initial velocity variance (m/s)^2
+	P[PIDX(6,6)] = P[PIDX(7,7)] = P[PIDX(8,8)] = P[PIDX(9,9)] = 1e-5f;	// initial quaternion variance
+	P[PIDX(10,10)] = P[PIDX(11,11)] = P[PIDX(12,12)] = 1e-6f;	// initial gyro bias variance (rad/s)^2
+	P[PIDX(13,13)] = P[PIDX(14,14)] = P[PIDX(15,15)] = 1e-5f;	// initial accel bias variance (deg/s)^2
 
 	X[0] = X[1] = X[2] = X[3] = X[4] = X[5] = 0.0f;	// initial pos and vel (m)
 	X[6] = 1.0f;
@@ -193,7 +199,7 @@ void INSGetState(float *pos, float *vel, float *attitude, float *gyro_bias, floa
 void INSGetVariance(float *var_out)
  {
    for (uint32_t i = 0; i < NUMX; i++)
-           var_out[i] = P[i][i];
+           var_out[i] = P[PIDX(i,i)];
  }
  
 void INSResetP(const float *PDiag)
@@ -203,9 +209,11 @@ void INSResetP(const float *PDiag)
 	// if PDiag[i] nonzero then clear row and column and set diagonal element
 	for (i=0;i<NUMX;i++){
 		if (PDiag != 0){
-			for (j=0;j<NUMX;j++)
-				P[i][j]=P[j][i]=0.0f;
-			P[i][i]=PDiag[i];
+			for (j=0;j<i;j++)
+				P[PIDX(j,i)]=0.0f;
+			for (j=i;j<NUMX;j++)
+				P[PIDX(i,j)]=0.0f;
+			P[PIDX(i,i)]=PDiag[i];
 		}
 	}
 }
@@ -233,14 +241,12 @@ void INSSetState(const float pos[3], const float vel[3], const float q[4], const
 void INSPosVelReset(const float pos[3], const float vel[3]) 
 {
 	for (int i = 0; i < 6; i++) {
-		for(int j = i; j < NUMX; j++) {
-			P[i][j] = 0.0f;  // zero the first 6 rows and columns
-			P[j][i] = 0.0f; 
-		}
+		for(int j = i; j < NUMX; j++)
+			P[PIDX(i,j)] = 0.0f;  // zero the first 6 rows and columns
 	}
 	
-	P[0][0] = P[1][1] = P[2][2] = 25.0f;	// initial position variance (m^2)
-	P[3][3] = P[4][4] = P[5][5] = 5.0f;	// initial velocity variance (m/s)^2
+	P[PIDX(0,0)] = P[PIDX(1,1)] = P[PIDX(2,2)] = 25.0f;	// initial position variance (m^2)
+	P[PIDX(3,3)] = P[PIDX(4,4)] = P[PIDX(5,5)] = 5.0f;	// initial velocity variance (m/s)^2
 	
 	X[0] = pos[0];
 	X[1] = pos[1];
@@ -406,186 +412,189 @@ void INSCorrection(const float mag_data[3], const float Pos[3], const float Vel[
 #ifdef COVARIANCE_PREDICTION_GENERAL
 
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-			  float Q[NUMW], float dT, float P[NUMX][NUMX])
+			  float Q[NUMW], float dT, float P[NUMP])
 {
-	float Dummy[NUMX][NUMX], dTsq;
+	float Dummy[NUMX][NUMX], Pfull[NUMX][NUMX], dTsq;
 	uint8_t i, j, k;
 
 	//  Pnew = (I+F*T)*P*(I+F*T)' + T^2*G*Q*G' = T^2[(P/T + F*P)*(I/T + F') + G*Q*G')]
 
 	dTsq = dT * dT;
 
+	for (i = 0; i < NUMX; i++)	// Unpack P into a full matrix
+		for (j = i; j < NUMX; j++)
+			Pfull[i][j] = Pfull[j][i] = P[PIDX(i,j)];
+
 	for (i = 0; i < NUMX; i++)	// Calculate Dummy = (P/T +F*P)
 		for (j = 0; j < NUMX; j++) {
-			Dummy[i][j] = P[i][j] / dT;
+			Dummy[i][j] = Pfull[i][j] / dT;
 			for (k = 0; k < NUMX; k++)
-				Dummy[i][j] += F[i][k] * P[k][j];
+				Dummy[i][j] += F[i][k] * Pfull[k][j];
 		}
 	for (i = 0; i < NUMX; i++)	// Calculate Pnew = Dummy/T + Dummy*F' + G*Qw*G'
 		for (j = i; j < NUMX; j++) {	// Use symmetry, ie only find upper triangular
-			P[i][j] = Dummy[i][j] / dT;
+			float Pij = Dummy[i][j] / dT;
 			for (k = 0; k < NUMX; k++)
-				P[i][j] += Dummy[i][k] * F[j][k];	// P = Dummy/T + Dummy*F'
+				Pij += Dummy[i][k] * F[j][k];	// P = Dummy/T + Dummy*F'
 			for (k = 0; k < NUMW; k++)
-				P[i][j] += Q[k] * G[i][k] * G[j][k];	// P = Dummy/T + Dummy*F' + G*Q*G'
-			P[j][i] = P[i][j] = P[i][j] * dTsq;	// Pnew = T^2*P and fill in lower triangular;
+				Pij += Q[k] * G[i][k] * G[j][k];	// P = Dummy/T + Dummy*F' + G*Q*G'
+			P[PIDX(i,j)] = Pij * dTsq;	// Pnew = T^2*P
 		}
 }
 
 #else
 
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-			  float Q[NUMW], float dT, float P[NUMX][NUMX])
+			  float Q[NUMW], float dT, float P[NUMP])
 {
-	float D[NUMX][NUMX], T, Tsq;
-	uint8_t i, j;
+	float D[NUMP], T, Tsq;
+	uint8_t i;
 
 	//  Pnew = (I+F*T)*P*(I+F*T)' + T^2*G*Q*G' = scalar expansion from symbolic manipulator
 
 	T = dT;
 	Tsq = dT * dT;
 
-	for (i = 0; i < NUMX; i++)	// Create a copy of the upper triangular of P
-		for (j = i; j < NUMX; j++)
-			D[i][j] = P[i][j];
+	for (i = 0; i < NUMP; i++)	// Create a copy of the upper triangular of P
+		D[i] = P[i];
 
 	// Brute force calculation of the elements of P
-	P[0][0] = D[3][3]*Tsq + (2*D[0][3])*T + D[0][0];
-	P[0][1] = P[1][0] = D[3][4]*Tsq + (D[0][4] + D[1][3])*T + D[0][1];
-	P[0][2] = P[2][0] = D[3][5]*Tsq + (D[0][5] + D[2][3])*T + D[0][2];
-	P[0][3] = P[3][0] = (F[3][6]*D[3][6] + F[3][7]*D[3][7] + F[3][8]*D[3][8] + F[3][9]*D[3][9] + F[3][13]*D[3][13] + F[3][14]*D[3][14] + F[3][15]*D[3][15])*Tsq + (D[3][3] + F[3][6]*D[0][6] + F[3][7]*D[0][7] + F[3][8]*D[0][8] + F[3][9]*D[0][9] + F[3][13]*D[0][13] + F[3][14]*D[0][14] + F[3][15]*D[0][15])*T + D[0][3];
-	P[0][4] = P[4][0] = (F[4][6]*D[3][6] + F[4][7]*D[3][7] + F[4][8]*D[3][8] + F[4][9]*D[3][9] + F[4][13]*D[3][13] + F[4][14]*D[3][14] + F[4][15]*D[3][15])*Tsq + (D[3][4] + F[4][6]*D[0][6] + F[4][7]*D[0][7] + F[4][8]*D[0][8] + F[4][9]*D[0][9] + F[4][13]*D[0][13] + F[4][14]*D[0][14] + F[4][15]*D[0][15])*T + D[0][4];
-	P[0][5] = P[5][0] = (F[5][6]*D[3][6] + F[5][7]*D[3][7] + F[5][8]*D[3][8] + F[5][9]*D[3][9] + F[5][13]*D[3][13] + F[5][14]*D[3][14] + F[5][15]*D[3][15])*Tsq + (D[3][5] + F[5][6]*D[0][6] + F[5][7]*D[0][7] + F[5][8]*D[0][8] + F[5][9]*D[0][9] + F[5][13]*D[0][13] + F[5][14]*D[0][14] + F[5][15]*D[0][15])*T + D[0][5];
-	P[0][6] = P[6][0] = (F[6][7]*D[3][7] + F[6][8]*D[3][8] + F[6][9]*D[3][9] + F[6][10]*D[3][10] + F[6][11]*D[3][11] + F[6][12]*D[3][12])*Tsq + (D[3][6] + F[6][7]*D[0][7] + F[6][8]*D[0][8] + F[6][9]*D[0][9] + F[6][10]*D[0][10] + F[6][11]*D[0][11] + F[6][12]*D[0][12])*T + D[0][6];
-	P[0][7] = P[7][0] = (F[7][6]*D[3][6] + F[7][8]*D[3][8] + F[7][9]*D[3][9] + F[7][10]*D[3][10] + F[7][11]*D[3][11] + F[7][12]*D[3][12])*Tsq + (D[3][7] + F[7][6]*D[0][6] + F[7][8]*D[0][8] + F[7][9]*D[0][9] + F[7][10]*D[0][10] + F[7][11]*D[0][11] + F[7][12]*D[0][12])*T + D[0][7];
-	P[0][8] = P[8][0] = (F[8][6]*D[3][6] + F[8][7]*D[3][7] + F[8][9]*D[3][9] + F[8][10]*D[3][10] + F[8][11]*D[3][11] + F[8][12]*D[3][12])*Tsq + (D[3][8] + F[8][6]*D[0][6] + F[8][7]*D[0][7] + F[8][9]*D[0][9] + F[8][10]*D[0][10] + F[8][11]*D[0][11] + F[8][12]*D[0][12])*T + D[0][8];
-	P[0][9] = P[9][0] = (F[9][6]*D[3][6] + F[9][7]*D[3][7] + F[9][8]*D[3][8] + F[9][10]*D[3][10] + F[9][11]*D[3][11] + F[9][12]*D[3][12])*Tsq + (D[3][9] + F[9][6]*D[0][6] + F[9][7]*D[0][7] + F[9][8]*D[0][8] + F[9][10]*D[0][10] + F[9][11]*D[0][11] + F[9][12]*D[0][12])*T + D[0][9];
-	P[0][10] = P[10][0] = D[3][10]*T + D[0][10];
-	P[0][11] = P[11][0] = D[3][11]*T + D[0][11];
-	P[0][12] = P[12][0] = D[3][12]*T + D[0][12];
-	P[0][13] = P[13][0] = D[3][13]*T + D[0][13];
-	P[0][14] = P[14][0] = D[3][14]*T + D[0][14];
-	P[0][15] = P[15][0] = D[3][15]*T + D[0][15];
-	P[1][1] = D[4][4]*Tsq + (2*D[1][4])*T + D[1][1];
-	P[1][2] = P[2][1] = D[4][5]*Tsq + (D[1][5] + D[2][4])*T + D[1][2];
-	P[1][3] = P[3][1] = (F[3][6]*D[4][6] + F[3][7]*D[4][7] + F[3][8]*D[4][8] + F[3][9]*D[4][9] + F[3][13]*D[4][13] + F[3][14]*D[4][14] + F[3][15]*D[4][15])*Tsq + (D[3][4] + F[3][6]*D[1][6] + F[3][7]*D[1][7] + F[3][8]*D[1][8] + F[3][9]*D[1][9] + F[3][13]*D[1][13] + F[3][14]*D[1][14] + F[3][15]*D[1][15])*T + D[1][3];
-	P[1][4] = P[4][1] = (F[4][6]*D[4][6] + F[4][7]*D[4][7] + F[4][8]*D[4][8] + F[4][9]*D[4][9] + F[4][13]*D[4][13] + F[4][14]*D[4][14] + F[4][15]*D[4][15])*Tsq + (D[4][4] + F[4][6]*D[1][6] + F[4][7]*D[1][7] + F[4][8]*D[1][8] + F[4][9]*D[1][9] + F[4][13]*D[1][13] + F[4][14]*D[1][14] + F[4][15]*D[1][15])*T + D[1][4];
-	P[1][5] = P[5][1] = (F[5][6]*D[4][6] + F[5][7]*D[4][7] + F[5][8]*D[4][8] + F[5][9]*D[4][9] + F[5][13]*D[4][13] + F[5][14]*D[4][14] + F[5][15]*D[4][15])*Tsq + (D[4][5] + F[5][6]*D[1][6] + F[5][7]*D[1][7] + F[5][8]*D[1][8] + F[5][9]*D[1][9] + F[5][13]*D[1][13] + F[5][14]*D[1][14] + F[5][15]*D[1][15])*T + D[1][5];
-	P[1][6] = P[6][1] = (F[6][7]*D[4][7] + F[6][8]*D[4][8] + F[6][9]*D[4][9] + F[6][10]*D[4][10] + F[6][11]*D[4][11] + F[6][12]*D[4][12])*Tsq + (D[4][6] + F[6][7]*D[1][7] + F[6][8]*D[1][8] + F[6][9]*D[1][9] + F[6][10]*D[1][10] + F[6][11]*D[1][11] + F[6][12]*D[1][12])*T + D[1][6];
-	P[1][7] = P[7][1] = (F[7][6]*D[4][6] + F[7][8]*D[4][8] + F[7][9]*D[4][9] + F[7][10]*D[4][10] + F[7][11]*D[4][11] + F[7][12]*D[4][12])*Tsq + (D[4][7] + F[7][6]*D[1][6] + F[7][8]*D[1][8] + F[7][9]*D[1][9] + F[7][10]*D[1][10] + F[7][11]*D[1][11] + F[7][12]*D[1][12])*T + D[1][7];
-	P[1][8] = P[8][1] = (F[8][6]*D[4][6] + F[8][7]*D[4][7] + F[8][9]*D[4][9] + F[8][10]*D[4][10] + F[8][11]*D[4][11] + F[8][12]*D[4][12])*Tsq + (D[4][8] + F[8][6]*D[1][6] + F[8][7]*D[1][7] + F[8][9]*D[1][9] + F[8][10]*D[1][10] + F[8][11]*D[1][11] + F[8][12]*D[1][12])*T + D[1][8];
-	P[1][9] = P[9][1] = (F[9][6]*D[4][6] + F[9][7]*D[4][7] + F[9][8]*D[4][8] + F[9][10]*D[4][10] + F[9][11]*D[4][11] + F[9][12]*D[4][12])*Tsq + (D[4][9] + F[9][6]*D[1][6] + F[9][7]*D[1][7] + F[9][8]*D[1][8] + F[9][10]*D[1][10] + F[9][11]*D[1][11] + F[9][12]*D[1][12])*T + D[1][9];
-	P[1][10] = P[10][1] = D[4][10]*T + D[1][10];
-	P[1][11] = P[11][1] = D[4][11]*T + D[1][11];
-	P[1][12] = P[12][1] = D[4][12]*T + D[1][12];
-	P[1][13] = P[13][1] = D[4][13]*T + D[1][13];
-	P[1][14] = P[14][1] = D[4][14]*T + D[1][14];
-	P[1][15] = P[15][1] = D[4][15]*T + D[1][15];
-	P[2][2] = D[5][5]*Tsq + (2*D[2][5])*T + D[2][2];
-	P[2][3] = P[3][2] = (F[3][6]*D[5][6] + F[3][7]*D[5][7] + F[3][8]*D[5][8] + F[3][9]*D[5][9] + F[3][13]*D[5][13] + F[3][14]*D[5][14] + F[3][15]*D[5][15])*Tsq + (D[3][5] + F[3][6]*D[2][6] + F[3][7]*D[2][7] + F[3][8]*D[2][8] + F[3][9]*D[2][9] + F[3][13]*D[2][13] + F[3][14]*D[2][14] + F[3][15]*D[2][15])*T + D[2][3];
-	P[2][4] = P[4][2] = (F[4][6]*D[5][6] + F[4][7]*D[5][7] + F[4][8]*D[5][8] + F[4][9]*D[5][9] + F[4][13]*D[5][13] + F[4][14]*D[5][14] + F[4][15]*D[5][15])*Tsq + (D[4][5] + F[4][6]*D[2][6] + F[4][7]*D[2][7] + F[4][8]*D[2][8] + F[4][9]*D[2][9] + F[4][13]*D[2][13] + F[4][14]*D[2][14] + F[4][15]*D[2][15])*T + D[2][4];
-	P[2][5] = P[5][2] = (F[5][6]*D[5][6] + F[5][7]*D[5][7] + F[5][8]*D[5][8] + F[5][9]*D[5][9] + F[5][13]*D[5][13] + F[5][14]*D[5][14] + F[5][15]*D[5][15])*Tsq + (D[5][5] + F[5][6]*D[2][6] + F[5][7]*D[2][7] + F[5][8]*D[2][8] + F[5][9]*D[2][9] + F[5][13]*D[2][13] + F[5][14]*D[2][14] + F[5][15]*D[2][15])*T + D[2][5];
-	P[2][6] = P[6][2] = (F[6][7]*D[5][7] + F[6][8]*D[5][8] + F[6][9]*D[5][9] + F[6][10]*D[5][10] + F[6][11]*D[5][11] + F[6][12]*D[5][12])*Tsq + (D[5][6] + F[6][7]*D[2][7] + F[6][8]*D[2][8] + F[6][9]*D[2][9] + F[6][10]*D[2][10] + F[6][11]*D[2][11] + F[6][12]*D[2][12])*T + D[2][6];
-	P[2][7] = P[7][2] = (F[7][6]*D[5][6] + F[7][8]*D[5][8] + F[7][9]*D[5][9] + F[7][10]*D[5][10] + F[7][11]*D[5][11] + F[7][12]*D[5][12])*Tsq + (D[5][7] + F[7][6]*D[2][6] + F[7][8]*D[2][8] + F[7][9]*D[2][9] + F[7][10]*D[2][10] + F[7][11]*D[2][11] + F[7][12]*D[2][12])*T + D[2][7];
-	P[2][8] = P[8][2] = (F[8][6]*D[5][6] + F[8][7]*D[5][7] + F[8][9]*D[5][9] + F[8][10]*D[5][10] + F[8][11]*D[5][11] + F[8][12]*D[5][12])*Tsq + (D[5][8] + F[8][6]*D[2][6] + F[8][7]*D[2][7] + F[8][9]*D[2][9] + F[8][10]*D[2][10] + F[8][11]*D[2][11] + F[8][12]*D[2][12])*T + D[2][8];
-	P[2][9] = P[9][2] = (F[9][6]*D[5][6] + F[9][7]*D[5][7] + F[9][8]*D[5][8] + F[9][10]*D[5][10] + F[9][11]*D[5][11] + F[9][12]*D[5][12])*Tsq + (D[5][9] + F[9][6]*D[2][6] + F[9][7]*D[2][7] + F[9][8]*D[2][8] + F[9][10]*D[2][10] + F[9][11]*D[2][11] + F[9][12]*D[2][12])*T + D[2][9];
-	P[2][10] = P[10][2] = D[5][10]*T + D[2][10];
-	P[2][11] = P[11][2] = D[5][11]*T + D[2][11];
-	P[2][12] = P[12][2] = D[5][12]*T + D[2][12];
-	P[2][13] = P[13][2] = D[5][13]*T + D[2][13];
-	P[2][14] = P[14][2] = D[5][14]*T + D[2][14];
-	P[2][15] = P[15][2] = D[5][15]*T + D[2][15];
-	P[3][3] = (Q[3]*G[3][3]*G[3][3] + Q[4]*G[3][4]*G[3][4] + Q[5]*G[3][5]*G[3][5] + F[3][6]*(F[3][6]*D[6][6] + F[3][7]*D[6][7] + F[3][8]*D[6][8] + F[3][9]*D[6][9] + F[3][13]*D[6][13] + F[3][14]*D[6][14] + F[3][15]*D[6][15]) + F[3][7]*(F[3][6]*D[6][7] + F[3][7]*D[7][7] + F[3][8]*D[7][8] + F[3][9]*D[7][9] + F[3][13]*D[7][13] + F[3][14]*D[7][14] + F[3][15]*D[7][15]) + F[3][8]*(F[3][6]*D[6][8] + F[3][7]*D[7][8] + F[3][8]*D[8][8] + F[3][9]*D[8][9] + F[3][13]*D[8][13] + F[3][14]*D[8][14] + F[3][15]*D[8][15]) + F[3][9]*(F[3][6]*D[6][9] + F[3][7]*D[7][9] + F[3][8]*D[8][9] + F[3][9]*D[9][9] + F[3][13]*D[9][13] + F[3][14]*D[9][14] + F[3][15]*D[9][15]) + F[3][13]*(F[3][6]*D[6][13] + F[3][7]*D[7][13] + F[3][8]*D[8][13] + F[3][9]*D[9][13] + F[3][13]*D[13][13] + F[3][14]*D[13][14] + F[3][15]*D[13][15]) + F[3][14]*(F[3][6]*D[6][14] + F[3][7]*D[7][14] + F[3][8]*D[8][14] + F[3][9]*D[9][14] + F[3][13]*D[13][14] + F[3][14]*D[14][14] + F[3][15]*D[14][15]) + F[3][15]*(F[3][6]*D[6][15] + F[3][7]*D[7][15] + F[3][8]*D[8][15] + F[3][9]*D[9][15] + F[3][13]*D[13][15] + F[3][14]*D[14][15] + F[3][15]*D[15][15]))*Tsq + (2*F[3][6]*D[3][6] + 2*F[3][7]*D[3][7] + 2*F[3][8]*D[3][8] + 2*F[3][9]*D[3][9] + 2*F[3][13]*D[3][13] + 2*F[3][14]*D[3][14] + 2*F[3][15]*D[3][15])*T + D[3][3];
-	P[3][4] = P[4][3] = (F[4][6]*(F[3][6]*D[6][6] + F[3][7]*D[6][7] + F[3][8]*D[6][8] + F[3][9]*D[6][9] + F[3][13]*D[6][13] + F[3][14]*D[6][14] + F[3][15]*D[6][15]) + F[4][7]*(F[3][6]*D[6][7] + F[3][7]*D[7][7] + F[3][8]*D[7][8] + F[3][9]*D[7][9] + F[3][13]*D[7][13] + F[3][14]*D[7][14] + F[3][15]*D[7][15]) + F[4][8]*(F[3][6]*D[6][8] + F[3][7]*D[7][8] + F[3][8]*D[8][8] + F[3][9]*D[8][9] + F[3][13]*D[8][13] + F[3][14]*D[8][14] + F[3][15]*D[8][15]) + F[4][9]*(F[3][6]*D[6][9] + F[3][7]*D[7][9] + F[3][8]*D[8][9] + F[3][9]*D[9][9] + F[3][13]*D[9][13] + F[3][14]*D[9][14] + F[3][15]*D[9][15]) + F[4][13]*(F[3][6]*D[6][13] + F[3][7]*D[7][13] + F[3][8]*D[8][13] + F[3][9]*D[9][13] + F[3][13]*D[13][13] + F[3][14]*D[13][14] + F[3][15]*D[13][15]) + F[4][14]*(F[3][6]*D[6][14] + F[3][7]*D[7][14] + F[3][8]*D[8][14] + F[3][9]*D[9][14] + F[3][13]*D[13][14] + F[3][14]*D[14][14] + F[3][15]*D[14][15]) + F[4][15]*(F[3][6]*D[6][15] + F[3][7]*D[7][15] + F[3][8]*D[8][15] + F[3][9]*D[9][15] + F[3][13]*D[13][15] + F[3][14]*D[14][15] + F[3][15]*D[15][15]) + G[3][3]*G[4][3]*Q[3] + G[3][4]*G[4][4]*Q[4] + G[3][5]*G[4][5]*Q[5])*Tsq + (F[3][6]*D[4][6] + F[4][6]*D[3][6] + F[3][7]*D[4][7] + F[4][7]*D[3][7] + F[3][8]*D[4][8] + F[4][8]*D[3][8] + F[3][9]*D[4][9] + F[4][9]*D[3][9] + F[3][13]*D[4][13] + F[4][13]*D[3][13] + F[3][14]*D[4][14] + F[4][14]*D[3][14] + F[3][15]*D[4][15] + F[4][15]*D[3][15])*T + D[3][4];
-	P[3][5] = P[5][3] = (F[5][6]*(F[3][6]*D[6][6] + F[3][7]*D[6][7] + F[3][8]*D[6][8] + F[3][9]*D[6][9] + F[3][13]*D[6][13] + F[3][14]*D[6][14] + F[3][15]*D[6][15]) + F[5][7]*(F[3][6]*D[6][7] + F[3][7]*D[7][7] + F[3][8]*D[7][8] + F[3][9]*D[7][9] + F[3][13]*D[7][13] + F[3][14]*D[7][14] + F[3][15]*D[7][15]) + F[5][8]*(F[3][6]*D[6][8] + F[3][7]*D[7][8] + F[3][8]*D[8][8] + F[3][9]*D[8][9] + F[3][13]*D[8][13] + F[3][14]*D[8][14] + F[3][15]*D[8][15]) + F[5][9]*(F[3][6]*D[6][9] + F[3][7]*D[7][9] + F[3][8]*D[8][9] + F[3][9]*D[9][9] + F[3][13]*D[9][13] + F[3][14]*D[9][14] + F[3][15]*D[9][15]) + F[5][13]*(F[3][6]*D[6][13] + F[3][7]*D[7][13] + F[3][8]*D[8][13] + F[3][9]*D[9][13] + F[3][13]*D[13][13] + F[3][14]*D[13][14] + F[3][15]*D[13][15]) + F[5][14]*(F[3][6]*D[6][14] + F[3][7]*D[7][14] + F[3][8]*D[8][14] + F[3][9]*D[9][14] + F[3][13]*D[13][14] + F[3][14]*D[14][14] + F[3][15]*D[14][15]) + F[5][15]*(F[3][6]*D[6][15] + F[3][7]*D[7][15] + F[3][8]*D[8][15] + F[3][9]*D[9][15] + F[3][13]*D[13][15] + F[3][14]*D[14][15] + F[3][15]*D[15][15]) + G[3][3]*G[5][3]*Q[3] + G[3][4]*G[5][4]*Q[4] + G[3][5]*G[5][5]*Q[5])*Tsq + (F[3][6]*D[5][6] + F[5][6]*D[3][6] + F[3][7]*D[5][7] + F[5][7]*D[3][7] + F[3][8]*D[5][8] + F[5][8]*D[3][8] + F[3][9]*D[5][9] + F[5][9]*D[3][9] + F[3][13]*D[5][13] + F[5][13]*D[3][13] + F[3][14]*D[5][14] + F[5][14]*D[3][14] + F[3][15]*D[5][15] + F[5][15]*D[3][15])*T + D[3][5];
-	P[3][6] = P[6][3] = (F[6][7]*(F[3][6]*D[6][7] + F[3][7]*D[7][7] + F[3][8]*D[7][8] + F[3][9]*D[7][9] + F[3][13]*D[7][13] + F[3][14]*D[7][14] + F[3][15]*D[7][15]) + F[6][8]*(F[3][6]*D[6][8] + F[3][7]*D[7][8] + F[3][8]*D[8][8] + F[3][9]*D[8][9] + F[3][13]*D[8][13] + F[3][14]*D[8][14] + F[3][15]*D[8][15]) + F[6][9]*(F[3][6]*D[6][9] + F[3][7]*D[7][9] + F[3][8]*D[8][9] + F[3][9]*D[9][9] + F[3][13]*D[9][13] + F[3][14]*D[9][14] + F[3][15]*D[9][15]) + F[6][10]*(F[3][6]*D[6][10] + F[3][7]*D[7][10] + F[3][8]*D[8][10] + F[3][9]*D[9][10] + F[3][13]*D[10][13] + F[3][14]*D[10][14] + F[3][15]*D[10][15]) + F[6][11]*(F[3][6]*D[6][11] + F[3][7]*D[7][11] + F[3][8]*D[8][11] + F[3][9]*D[9][11] + F[3][13]*D[11][13] + F[3][14]*D[11][14] + F[3][15]*D[11][15]) + F[6][12]*(F[3][6]*D[6][12] + F[3][7]*D[7][12] + F[3][8]*D[8][12] + F[3][9]*D[9][12] + F[3][13]*D[12][13] + F[3][14]*D[12][14] + F[3][15]*D[12][15]))*Tsq + (F[3][6]*D[6][6] + F[3][7]*D[6][7] + F[6][7]*D[3][7] + F[3][8]*D[6][8] + F[6][8]*D[3][8] + F[3][9]*D[6][9] + F[6][9]*D[3][9] + F[6][10]*D[3][10] + F[6][11]*D[3][11] + F[6][12]*D[3][12] + F[3][13]*D[6][13] + F[3][14]*D[6][14] + F[3][15]*D[6][15])*T + D[3][6];
-	P[3][7] = P[7][3] = (F[7][6]*(F[3][6]*D[6][6] + F[3][7]*D[6][7] + F[3][8]*D[6][8] + F[3][9]*D[6][9] + F[3][13]*D[6][13] + F[3][14]*D[6][14] + F[3][15]*D[6][15]) + F[7][8]*(F[3][6]*D[6][8] + F[3][7]*D[7][8] + F[3][8]*D[8][8] + F[3][9]*D[8][9] + F[3][13]*D[8][13] + F[3][14]*D[8][14] + F[3][15]*D[8][15]) + F[7][9]*(F[3][6]*D[6][9] + F[3][7]*D[7][9] + F[3][8]*D[8][9] + F[3][9]*D[9][9] + F[3][13]*D[9][13] + F[3][14]*D[9][14] + F[3][15]*D[9][15]) + F[7][10]*(F[3][6]*D[6][10] + F[3][7]*D[7][10] + F[3][8]*D[8][10] + F[3][9]*D[9][10] + F[3][13]*D[10][13] + F[3][14]*D[10][14] + F[3][15]*D[10][15]) + F[7][11]*(F[3][6]*D[6][11] + F[3][7]*D[7][11] + F[3][8]*D[8][11] + F[3][9]*D[9][11] + F[3][13]*D[11][13] + F[3][14]*D[11][14] + F[3][15]*D[11][15]) + F[7][12]*(F[3][6]*D[6][12] + F[3][7]*D[7][12] + F[3][8]*D[8][12] + F[3][9]*D[9][12] + F[3][13]*D[12][13] + F[3][14]*D[12][14] + F[3][15]*D[12][15]))*Tsq + (F[3][6]*D[6][7] + F[7][6]*D[3][6] + F[3][7]*D[7][7] + F[3][8]*D[7][8] + F[7][8]*D[3][8] + F[3][9]*D[7][9] + F[7][9]*D[3][9] + F[7][10]*D[3][10] + F[7][11]*D[3][11] + F[7][12]*D[3][12] + F[3][13]*D[7][13] + F[3][14]*D[7][14] + F[3][15]*D[7][15])*T + D[3][7];
-	P[3][8] = P[8][3] = (F[8][6]*(F[3][6]*D[6][6] + F[3][7]*D[6][7] + F[3][8]*D[6][8] + F[3][9]*D[6][9] + F[3][13]*D[6][13] + F[3][14]*D[6][14] + F[3][15]*D[6][15]) + F[8][7]*(F[3][6]*D[6][7] + F[3][7]*D[7][7] + F[3][8]*D[7][8] + F[3][9]*D[7][9] + F[3][13]*D[7][13] + F[3][14]*D[7][14] + F[3][15]*D[7][15]) + F[8][9]*(F[3][6]*D[6][9] + F[3][7]*D[7][9] + F[3][8]*D[8][9] + F[3][9]*D[9][9] + F[3][13]*D[9][13] + F[3][14]*D[9][14] + F[3][15]*D[9][15]) + F[8][10]*(F[3][6]*D[6][10] + F[3][7]*D[7][10] + F[3][8]*D[8][10] + F[3][9]*D[9][10] + F[3][13]*D[10][13] + F[3][14]*D[10][14] + F[3][15]*D[10][15]) + F[8][11]*(F[3][6]*D[6][11] + F[3][7]*D[7][11] + F[3][8]*D[8][11] + F[3][9]*D[9][11] + F[3][13]*D[11][13] + F[3][14]*D[11][14] + F[3][15]*D[11][15]) + F[8][12]*(F[3][6]*D[6][12] + F[3][7]*D[7][12] + F[3][8]*D[8][12] + F[3][9]*D[9][12] + F[3][13]*D[12][13] + F[3][14]*D[12][14] + F[3][15]*D[12][15]))*Tsq + (F[3][6]*D[6][8] + F[3][7]*D[7][8] + F[8][6]*D[3][6] + F[8][7]*D[3][7] + F[3][8]*D[8][8] + F[3][9]*D[8][9] + F[8][9]*D[3][9] + F[8][10]*D[3][10] + F[8][11]*D[3][11] + F[8][12]*D[3][12] + F[3][13]*D[8][13] + F[3][14]*D[8][14] + F[3][15]*D[8][15])*T + D[3][8];
-	P[3][9] = P[9][3] = (F[9][6]*(F[3][6]*D[6][6] + F[3][7]*D[6][7] + F[3][8]*D[6][8] + F[3][9]*D[6][9] + F[3][13]*D[6][13] + F[3][14]*D[6][14] + F[3][15]*D[6][15]) + F[9][7]*(F[3][6]*D[6][7] + F[3][7]*D[7][7] + F[3][8]*D[7][8] + F[3][9]*D[7][9] + F[3][13]*D[7][13] + F[3][14]*D[7][14] + F[3][15]*D[7][15]) + F[9][8]*(F[3][6]*D[6][8] + F[3][7]*D[7][8] + F[3][8]*D[8][8] + F[3][9]*D[8][9] + F[3][13]*D[8][13] + F[3][14]*D[8][14] + F[3][15]*D[8][15]) + F[9][10]*(F[3][6]*D[6][10] + F[3][7]*D[7][10] + F[3][8]*D[8][10] + F[3][9]*D[9][10] + F[3][13]*D[10][13] + F[3][14]*D[10][14] + F[3][15]*D[10][15]) + F[9][11]*(F[3][6]*D[6][11] + F[3][7]*D[7][11] + F[3][8]*D[8][11] + F[3][9]*D[9][11] + F[3][13]*D[11][13] + F[3][14]*D[11][14] + F[3][15]*D[11][15]) + F[9][12]*(F[3][6]*D[6][12] + F[3][7]*D[7][12] + F[3][8]*D[8][12] + F[3][9]*D[9][12] + F[3][13]*D[12][13] + F[3][14]*D[12][14] + F[3][15]*D[12][15]))*Tsq + (F[9][6]*D[3][6] + F[9][7]*D[3][7] + F[9][8]*D[3][8] + F[3][6]*D[6][9] + F[3][7]*D[7][9] + F[3][8]*D[8][9] + F[3][9]*D[9][9] + F[9][10]*D[3][10] + F[9][11]*D[3][11] + F[9][12]*D[3][12] + F[3][13]*D[9][13] + F[3][14]*D[9][14] + F[3][15]*D[9][15])*T + D[3][9];
-	P[3][10] = P[10][3] = (F[3][6]*D[6][10] + F[3][7]*D[7][10] + F[3][8]*D[8][10] + F[3][9]*D[9][10] + F[3][13]*D[10][13] + F[3][14]*D[10][14] + F[3][15]*D[10][15])*T + D[3][10];
-	P[3][11] = P[11][3] = (F[3][6]*D[6][11] + F[3][7]*D[7][11] + F[3][8]*D[8][11] + F[3][9]*D[9][11] + F[3][13]*D[11][13] + F[3][14]*D[11][14] + F[3][15]*D[11][15])*T + D[3][11];
-	P[3][12] = P[12][3] = (F[3][6]*D[6][12] + F[3][7]*D[7][12] + F[3][8]*D[8][12] + F[3][9]*D[9][12] + F[3][13]*D[12][13] + F[3][14]*D[12][14] + F[3][15]*D[12][15])*T + D[3][12];
-	P[3][13] = P[13][3] = (F[3][6]*D[6][13] + F[3][7]*D[7][13] + F[3][8]*D[8][13] + F[3][9]*D[9][13] + F[3][13]*D[13][13] + F[3][14]*D[13][14] + F[3][15]*D[13][15])*T + D[3][13];
-	P[3][14] = P[14][3] = (F[3][6]*D[6][14] + F[3][7]*D[7][14] + F[3][8]*D[8][14] + F[3][9]*D[9][14] + F[3][13]*D[13][14] + F[3][14]*D[14][14] + F[3][15]*D[14][15])*T + D[3][14];
-	P[3][15] = P[15][3] = (F[3][6]*D[6][15] + F[3][7]*D[7][15] + F[3][8]*D[8][15] + F[3][9]*D[9][15] + F[3][13]*D[13][15] + F[3][14]*D[14][15] + F[3][15]*D[15][15])*T + D[3][15];
-	P[4][4] = (Q[3]*G[4][3]*G[4][3] + Q[4]*G[4][4]*G[4][4] + Q[5]*G[4][5]*G[4][5] + F[4][6]*(F[4][6]*D[6][6] + F[4][7]*D[6][7] + F[4][8]*D[6][8] + F[4][9]*D[6][9] + F[4][13]*D[6][13] + F[4][14]*D[6][14] + F[4][15]*D[6][15]) + F[4][7]*(F[4][6]*D[6][7] + F[4][7]*D[7][7] + F[4][8]*D[7][8] + F[4][9]*D[7][9] + F[4][13]*D[7][13] + F[4][14]*D[7][14] + F[4][15]*D[7][15]) + F[4][8]*(F[4][6]*D[6][8] + F[4][7]*D[7][8] + F[4][8]*D[8][8] + F[4][9]*D[8][9] + F[4][13]*D[8][13] + F[4][14]*D[8][14] + F[4][15]*D[8][15]) + F[4][9]*(F[4][6]*D[6][9] + F[4][7]*D[7][9] + F[4][8]*D[8][9] + F[4][9]*D[9][9] + F[4][13]*D[9][13] + F[4][14]*D[9][14] + F[4][15]*D[9][15]) + F[4][13]*(F[4][6]*D[6][13] + F[4][7]*D[7][13] + F[4][8]*D[8][13] + F[4][9]*D[9][13] + F[4][13]*D[13][13] + F[4][14]*D[13][14] + F[4][15]*D[13][15]) + F[4][14]*(F[4][6]*D[6][14] + F[4][7]*D[7][14] + F[4][8]*D[8][14] + F[4][9]*D[9][14] + F[4][13]*D[13][14] + F[4][14]*D[14][14] + F[4][15]*D[14][15]) + F[4][15]*(F[4][6]*D[6][15] + F[4][7]*D[7][15] + F[4][8]*D[8][15] + F[4][9]*D[9][15] + F[4][13]*D[13][15] + F[4][14]*D[14][15] + F[4][15]*D[15][15]))*Tsq + (2*F[4][6]*D[4][6] + 2*F[4][7]*D[4][7] + 2*F[4][8]*D[4][8] + 2*F[4][9]*D[4][9] + 2*F[4][13]*D[4][13] + 2*F[4][14]*D[4][14] + 2*F[4][15]*D[4][15])*T + D[4][4];
-	P[4][5] = P[5][4] = (F[5][6]*(F[4][6]*D[6][6] + F[4][7]*D[6][7] + F[4][8]*D[6][8] + F[4][9]*D[6][9] + F[4][13]*D[6][13] + F[4][14]*D[6][14] + F[4][15]*D[6][15]) + F[5][7]*(F[4][6]*D[6][7] + F[4][7]*D[7][7] + F[4][8]*D[7][8] + F[4][9]*D[7][9] + F[4][13]*D[7][13] + F[4][14]*D[7][14] + F[4][15]*D[7][15]) + F[5][8]*(F[4][6]*D[6][8] + F[4][7]*D[7][8] + F[4][8]*D[8][8] + F[4][9]*D[8][9] + F[4][13]*D[8][13] + F[4][14]*D[8][14] + F[4][15]*D[8][15]) + F[5][9]*(F[4][6]*D[6][9] + F[4][7]*D[7][9] + F[4][8]*D[8][9] + F[4][9]*D[9][9] + F[4][13]*D[9][13] + F[4][14]*D[9][14] + F[4][15]*D[9][15]) + F[5][13]*(F[4][6]*D[6][13] + F[4][7]*D[7][13] + F[4][8]*D[8][13] + F[4][9]*D[9][13] + F[4][13]*D[13][13] + F[4][14]*D[13][14] + F[4][15]*D[13][15]) + F[5][14]*(F[4][6]*D[6][14] + F[4][7]*D[7][14] + F[4][8]*D[8][14] + F[4][9]*D[9][14] + F[4][13]*D[13][14] + F[4][14]*D[14][14] + F[4][15]*D[14][15]) + F[5][15]*(F[4][6]*D[6][15] + F[4][7]*D[7][15] + F[4][8]*D[8][15] + F[4][9]*D[9][15] + F[4][13]*D[13][15] + F[4][14]*D[14][15] + F[4][15]*D[15][15]) + G[4][3]*G[5][3]*Q[3] + G[4][4]*G[5][4]*Q[4] + G[4][5]*G[5][5]*Q[5])*Tsq + (F[4][6]*D[5][6] + F[5][6]*D[4][6] + F[4][7]*D[5][7] + F[5][7]*D[4][7] + F[4][8]*D[5][8] + F[5][8]*D[4][8] + F[4][9]*D[5][9] + F[5][9]*D[4][9] + F[4][13]*D[5][13] + F[5][13]*D[4][13] + F[4][14]*D[5][14] + F[5][14]*D[4][14] + F[4][15]*D[5][15] + F[5][15]*D[4][15])*T + D[4][5];
-	P[4][6] = P[6][4] = (F[6][7]*(F[4][6]*D[6][7] + F[4][7]*D[7][7] + F[4][8]*D[7][8] + F[4][9]*D[7][9] + F[4][13]*D[7][13] + F[4][14]*D[7][14] + F[4][15]*D[7][15]) + F[6][8]*(F[4][6]*D[6][8] + F[4][7]*D[7][8] + F[4][8]*D[8][8] + F[4][9]*D[8][9] + F[4][13]*D[8][13] + F[4][14]*D[8][14] + F[4][15]*D[8][15]) + F[6][9]*(F[4][6]*D[6][9] + F[4][7]*D[7][9] + F[4][8]*D[8][9] + F[4][9]*D[9][9] + F[4][13]*D[9][13] + F[4][14]*D[9][14] + F[4][15]*D[9][15]) + F[6][10]*(F[4][6]*D[6][10] + F[4][7]*D[7][10] + F[4][8]*D[8][10] + F[4][9]*D[9][10] + F[4][13]*D[10][13] + F[4][14]*D[10][14] + F[4][15]*D[10][15]) + F[6][11]*(F[4][6]*D[6][11] + F[4][7]*D[7][11] + F[4][8]*D[8][11] + F[4][9]*D[9][11] + F[4][13]*D[11][13] + F[4][14]*D[11][14] + F[4][15]*D[11][15]) + F[6][12]*(F[4][6]*D[6][12] + F[4][7]*D[7][12] + F[4][8]*D[8][12] + F[4][9]*D[9][12] + F[4][13]*D[12][13] + F[4][14]*D[12][14] + F[4][15]*D[12][15]))*Tsq + (F[4][6]*D[6][6] + F[4][7]*D[6][7] + F[6][7]*D[4][7] + F[4][8]*D[6][8] + F[6][8]*D[4][8] + F[4][9]*D[6][9] + F[6][9]*D[4][9] + F[6][10]*D[4][10] + F[6][11]*D[4][11] + F[6][12]*D[4][12] + F[4][13]*D[6][13] + F[4][14]*D[6][14] + F[4][15]*D[6][15])*T + D[4][6];
-	P[4][7] = P[7][4] = (F[7][6]*(F[4][6]*D[6][6] + F[4][7]*D[6][7] + F[4][8]*D[6][8] + F[4][9]*D[6][9] + F[4][13]*D[6][13] + F[4][14]*D[6][14] + F[4][15]*D[6][15]) + F[7][8]*(F[4][6]*D[6][8] + F[4][7]*D[7][8] + F[4][8]*D[8][8] + F[4][9]*D[8][9] + F[4][13]*D[8][13] + F[4][14]*D[8][14] + F[4][15]*D[8][15]) + F[7][9]*(F[4][6]*D[6][9] + F[4][7]*D[7][9] + F[4][8]*D[8][9] + F[4][9]*D[9][9] + F[4][13]*D[9][13] + F[4][14]*D[9][14] + F[4][15]*D[9][15]) + F[7][10]*(F[4][6]*D[6][10] + F[4][7]*D[7][10] + F[4][8]*D[8][10] + F[4][9]*D[9][10] + F[4][13]*D[10][13] + F[4][14]*D[10][14] + F[4][15]*D[10][15]) + F[7][11]*(F[4][6]*D[6][11] + F[4][7]*D[7][11] + F[4][8]*D[8][11] + F[4][9]*D[9][11] + F[4][13]*D[11][13] + F[4][14]*D[11][14] + F[4][15]*D[11][15]) + F[7][12]*(F[4][6]*D[6][12] + F[4][7]*D[7][12] + F[4][8]*D[8][12] + F[4][9]*D[9][12] + F[4][13]*D[12][13] + F[4][14]*D[12][14] + F[4][15]*D[12][15]))*Tsq + (F[4][6]*D[6][7] + F[7][6]*D[4][6] + F[4][7]*D[7][7] + F[4][8]*D[7][8] + F[7][8]*D[4][8] + F[4][9]*D[7][9] + F[7][9]*D[4][9] + F[7][10]*D[4][10] + F[7][11]*D[4][11] + F[7][12]*D[4][12] + F[4][13]*D[7][13] + F[4][14]*D[7][14] + F[4][15]*D[7][15])*T + D[4][7];
-	P[4][8] = P[8][4] = (F[8][6]*(F[4][6]*D[6][6] + F[4][7]*D[6][7] + F[4][8]*D[6][8] + F[4][9]*D[6][9] + F[4][13]*D[6][13] + F[4][14]*D[6][14] + F[4][15]*D[6][15]) + F[8][7]*(F[4][6]*D[6][7] + F[4][7]*D[7][7] + F[4][8]*D[7][8] + F[4][9]*D[7][9] + F[4][13]*D[7][13] + F[4][14]*D[7][14] + F[4][15]*D[7][15]) + F[8][9]*(F[4][6]*D[6][9] + F[4][7]*D[7][9] + F[4][8]*D[8][9] + F[4][9]*D[9][9] + F[4][13]*D[9][13] + F[4][14]*D[9][14] + F[4][15]*D[9][15]) + F[8][10]*(F[4][6]*D[6][10] + F[4][7]*D[7][10] + F[4][8]*D[8][10] + F[4][9]*D[9][10] + F[4][13]*D[10][13] + F[4][14]*D[10][14] + F[4][15]*D[10][15]) + F[8][11]*(F[4][6]*D[6][11] + F[4][7]*D[7][11] + F[4][8]*D[8][11] + F[4][9]*D[9][11] + F[4][13]*D[11][13] + F[4][14]*D[11][14] + F[4][15]*D[11][15]) + F[8][12]*(F[4][6]*D[6][12] + F[4][7]*D[7][12] + F[4][8]*D[8][12] + F[4][9]*D[9][12] + F[4][13]*D[12][13] + F[4][14]*D[12][14] + F[4][15]*D[12][15]))*Tsq + (F[4][6]*D[6][8] + F[4][7]*D[7][8] + F[8][6]*D[4][6] + F[8][7]*D[4][7] + F[4][8]*D[8][8] + F[4][9]*D[8][9] + F[8][9]*D[4][9] + F[8][10]*D[4][10] + F[8][11]*D[4][11] + F[8][12]*D[4][12] + F[4][13]*D[8][13] + F[4][14]*D[8][14] + F[4][15]*D[8][15])*T + D[4][8];
-	P[4][9] = P[9][4] = (F[9][6]*(F[4][6]*D[6][6] + F[4][7]*D[6][7] + F[4][8]*D[6][8] + F[4][9]*D[6][9] + F[4][13]*D[6][13] + F[4][14]*D[6][14] + F[4][15]*D[6][15]) + F[9][7]*(F[4][6]*D[6][7] + F[4][7]*D[7][7] + F[4][8]*D[7][8] + F[4][9]*D[7][9] + F[4][13]*D[7][13] + F[4][14]*D[7][14] + F[4][15]*D[7][15]) + F[9][8]*(F[4][6]*D[6][8] + F[4][7]*D[7][8] + F[4][8]*D[8][8] + F[4][9]*D[8][9] + F[4][13]*D[8][13] + F[4][14]*D[8][14] + F[4][15]*D[8][15]) + F[9][10]*(F[4][6]*D[6][10] + F[4][7]*D[7][10] + F[4][8]*D[8][10] + F[4][9]*D[9][10] + F[4][13]*D[10][13] + F[4][14]*D[10][14] + F[4][15]*D[10][15]) + F[9][11]*(F[4][6]*D[6][11] + F[4][7]*D[7][11] + F[4][8]*D[8][11] + F[4][9]*D[9][11] + F[4][13]*D[11][13] + F[4][14]*D[11][14] + F[4][15]*D[11][15]) + F[9][12]*(F[4][6]*D[6][12] + F[4][7]*D[7][12] + F[4][8]*D[8][12] + F[4][9]*D[9][12] + F[4][13]*D[12][13] + F[4][14]*D[12][14] + F[4][15]*D[12][15]))*Tsq + (F[9][6]*D[4][6] + F[9][7]*D[4][7] + F[9][8]*D[4][8] + F[4][6]*D[6][9] + F[4][7]*D[7][9] + F[4][8]*D[8][9] + F[4][9]*D[9][9] + F[9][10]*D[4][10] + F[9][11]*D[4][11] + F[9][12]*D[4][12] + F[4][13]*D[9][13] + F[4][14]*D[9][14] + F[4][15]*D[9][15])*T + D[4][9];
-	P[4][10] = P[10][4] = (F[4][6]*D[6][10] + F[4][7]*D[7][10] + F[4][8]*D[8][10] + F[4][9]*D[9][10] + F[4][13]*D[10][13] + F[4][14]*D[10][14] + F[4][15]*D[10][15])*T + D[4][10];
-	P[4][11] = P[11][4] = (F[4][6]*D[6][11] + F[4][7]*D[7][11] + F[4][8]*D[8][11] + F[4][9]*D[9][11] + F[4][13]*D[11][13] + F[4][14]*D[11][14] + F[4][15]*D[11][15])*T + D[4][11];
-	P[4][12] = P[12][4] = (F[4][6]*D[6][12] + F[4][7]*D[7][12] + F[4][8]*D[8][12] + F[4][9]*D[9][12] + F[4][13]*D[12][13] + F[4][14]*D[12][14] + F[4][15]*D[12][15])*T + D[4][12];
-	P[4][13] = P[13][4] = (F[4][6]*D[6][13] + F[4][7]*D[7][13] + F[4][8]*D[8][13] + F[4][9]*D[9][13] + F[4][13]*D[13][13] + F[4][14]*D[13][14] + F[4][15]*D[13][15])*T + D[4][13];
-	P[4][14] = P[14][4] = (F[4][6]*D[6][14] + F[4][7]*D[7][14] + F[4][8]*D[8][14] + F[4][9]*D[9][14] + F[4][13]*D[13][14] + F[4][14]*D[14][14] + F[4][15]*D[14][15])*T + D[4][14];
-	P[4][15] = P[15][4] = (F[4][6]*D[6][15] + F[4][7]*D[7][15] + F[4][8]*D[8][15] + F[4][9]*D[9][15] + F[4][13]*D[13][15] + F[4][14]*D[14][15] + F[4][15]*D[15][15])*T + D[4][15];
-	P[5][5] = (Q[3]*G[5][3]*G[5][3] + Q[4]*G[5][4]*G[5][4] + Q[5]*G[5][5]*G[5][5] + F[5][6]*(F[5][6]*D[6][6] + F[5][7]*D[6][7] + F[5][8]*D[6][8] + F[5][9]*D[6][9] + F[5][13]*D[6][13] + F[5][14]*D[6][14] + F[5][15]*D[6][15]) + F[5][7]*(F[5][6]*D[6][7] + F[5][7]*D[7][7] + F[5][8]*D[7][8] + F[5][9]*D[7][9] + F[5][13]*D[7][13] + F[5][14]*D[7][14] + F[5][15]*D[7][15]) + F[5][8]*(F[5][6]*D[6][8] + F[5][7]*D[7][8] + F[5][8]*D[8][8] + F[5][9]*D[8][9] + F[5][13]*D[8][13] + F[5][14]*D[8][14] + F[5][15]*D[8][15]) + F[5][9]*(F[5][6]*D[6][9] + F[5][7]*D[7][9] + F[5][8]*D[8][9] + F[5][9]*D[9][9] + F[5][13]*D[9][13] + F[5][14]*D[9][14] + F[5][15]*D[9][15]) + F[5][13]*(F[5][6]*D[6][13] + F[5][7]*D[7][13] + F[5][8]*D[8][13] + F[5][9]*D[9][13] + F[5][13]*D[13][13] + F[5][14]*D[13][14] + F[5][15]*D[13][15]) + F[5][14]*(F[5][6]*D[6][14] + F[5][7]*D[7][14] + F[5][8]*D[8][14] + F[5][9]*D[9][14] + F[5][13]*D[13][14] + F[5][14]*D[14][14] + F[5][15]*D[14][15]) + F[5][15]*(F[5][6]*D[6][15] + F[5][7]*D[7][15] + F[5][8]*D[8][15] + F[5][9]*D[9][15] + F[5][13]*D[13][15] + F[5][14]*D[14][15] + F[5][15]*D[15][15]))*Tsq + (2*F[5][6]*D[5][6] + 2*F[5][7]*D[5][7] + 2*F[5][8]*D[5][8] + 2*F[5][9]*D[5][9] + 2*F[5][13]*D[5][13] + 2*F[5][14]*D[5][14] + 2*F[5][15]*D[5][15])*T + D[5][5];
-	P[5][6] = P[6][5] = (F[6][7]*(F[5][6]*D[6][7] + F[5][7]*D[7][7] + F[5][8]*D[7][8] + F[5][9]*D[7][9] + F[5][13]*D[7][13] + F[5][14]*D[7][14] + F[5][15]*D[7][15]) + F[6][8]*(F[5][6]*D[6][8] + F[5][7]*D[7][8] + F[5][8]*D[8][8] + F[5][9]*D[8][9] + F[5][13]*D[8][13] + F[5][14]*D[8][14] + F[5][15]*D[8][15]) + F[6][9]*(F[5][6]*D[6][9] + F[5][7]*D[7][9] + F[5][8]*D[8][9] + F[5][9]*D[9][9] + F[5][13]*D[9][13] + F[5][14]*D[9][14] + F[5][15]*D[9][15]) + F[6][10]*(F[5][6]*D[6][10] + F[5][7]*D[7][10] + F[5][8]*D[8][10] + F[5][9]*D[9][10] + F[5][13]*D[10][13] + F[5][14]*D[10][14] + F[5][15]*D[10][15]) + F[6][11]*(F[5][6]*D[6][11] + F[5][7]*D[7][11] + F[5][8]*D[8][11] + F[5][9]*D[9][11] + F[5][13]*D[11][13] + F[5][14]*D[11][14] + F[5][15]*D[11][15]) + F[6][12]*(F[5][6]*D[6][12] + F[5][7]*D[7][12] + F[5][8]*D[8][12] + F[5][9]*D[9][12] + F[5][13]*D[12][13] + F[5][14]*D[12][14] + F[5][15]*D[12][15]))*Tsq + (F[5][6]*D[6][6] + F[5][7]*D[6][7] + F[6][7]*D[5][7] + F[5][8]*D[6][8] + F[6][8]*D[5][8] + F[5][9]*D[6][9] + F[6][9]*D[5][9] + F[6][10]*D[5][10] + F[6][11]*D[5][11] + F[6][12]*D[5][12] + F[5][13]*D[6][13] + F[5][14]*D[6][14] + F[5][15]*D[6][15])*T + D[5][6];
-	P[5][7] = P[7][5] = (F[7][6]*(F[5][6]*D[6][6] + F[5][7]*D[6][7] + F[5][8]*D[6][8] + F[5][9]*D[6][9] + F[5][13]*D[6][13] + F[5][14]*D[6][14] + F[5][15]*D[6][15]) + F[7][8]*(F[5][6]*D[6][8] + F[5][7]*D[7][8] + F[5][8]*D[8][8] + F[5][9]*D[8][9] + F[5][13]*D[8][13] + F[5][14]*D[8][14] + F[5][15]*D[8][15]) + F[7][9]*(F[5][6]*D[6][9] + F[5][7]*D[7][9] + F[5][8]*D[8][9] + F[5][9]*D[9][9] + F[5][13]*D[9][13] + F[5][14]*D[9][14] + F[5][15]*D[9][15]) + F[7][10]*(F[5][6]*D[6][10] + F[5][7]*D[7][10] + F[5][8]*D[8][10] + F[5][9]*D[9][10] + F[5][13]*D[10][13] + F[5][14]*D[10][14] + F[5][15]*D[10][15]) + F[7][11]*(F[5][6]*D[6][11] + F[5][7]*D[7][11] + F[5][8]*D[8][11] + F[5][9]*D[9][11] + F[5][13]*D[11][13] + F[5][14]*D[11][14] + F[5][15]*D[11][15]) + F[7][12]*(F[5][6]*D[6][12] + F[5][7]*D[7][12] + F[5][8]*D[8][12] + F[5][9]*D[9][12] + F[5][13]*D[12][13] + F[5][14]*D[12][14] + F[5][15]*D[12][15]))*Tsq + (F[5][6]*D[6][7] + F[7][6]*D[5][6] + F[5][7]*D[7][7] + F[5][8]*D[7][8] + F[7][8]*D[5][8] + F[5][9]*D[7][9] + F[7][9]*D[5][9] + F[7][10]*D[5][10] + F[7][11]*D[5][11] + F[7][12]*D[5][12] + F[5][13]*D[7][13] + F[5][14]*D[7][14] + F[5][15]*D[7][15])*T + D[5][7];
-	P[5][8] = P[8][5] = (F[8][6]*(F[5][6]*D[6][6] + F[5][7]*D[6][7] + F[5][8]*D[6][8] + F[5][9]*D[6][9] + F[5][13]*D[6][13] + F[5][14]*D[6][14] + F[5][15]*D[6][15]) + F[8][7]*(F[5][6]*D[6][7] + F[5][7]*D[7][7] + F[5][8]*D[7][8] + F[5][9]*D[7][9] + F[5][13]*D[7][13] + F[5][14]*D[7][14] + F[5][15]*D[7][15]) + F[8][9]*(F[5][6]*D[6][9] + F[5][7]*D[7][9] + F[5][8]*D[8][9] + F[5][9]*D[9][9] + F[5][13]*D[9][13] + F[5][14]*D[9][14] + F[5][15]*D[9][15]) + F[8][10]*(F[5][6]*D[6][10] + F[5][7]*D[7][10] + F[5][8]*D[8][10] + F[5][9]*D[9][10] + F[5][13]*D[10][13] + F[5][14]*D[10][14] + F[5][15]*D[10][15]) + F[8][11]*(F[5][6]*D[6][11] + F[5][7]*D[7][11] + F[5][8]*D[8][11] + F[5][9]*D[9][11] + F[5][13]*D[11][13] + F[5][14]*D[11][14] + F[5][15]*D[11][15]) + F[8][12]*(F[5][6]*D[6][12] + F[5][7]*D[7][12] + F[5][8]*D[8][12] + F[5][9]*D[9][12] + F[5][13]*D[12][13] + F[5][14]*D[12][14] + F[5][15]*D[12][15]))*Tsq + (F[5][6]*D[6][8] + F[5][7]*D[7][8] + F[8][6]*D[5][6] + F[8][7]*D[5][7] + F[5][8]*D[8][8] + F[5][9]*D[8][9] + F[8][9]*D[5][9] + F[8][10]*D[5][10] + F[8][11]*D[5][11] + F[8][12]*D[5][12] + F[5][13]*D[8][13] + F[5][14]*D[8][14] + F[5][15]*D[8][15])*T + D[5][8];
-	P[5][9] = P[9][5] = (F[9][6]*(F[5][6]*D[6][6] + F[5][7]*D[6][7] + F[5][8]*D[6][8] + F[5][9]*D[6][9] + F[5][13]*D[6][13] + F[5][14]*D[6][14] + F[5][15]*D[6][15]) + F[9][7]*(F[5][6]*D[6][7] + F[5][7]*D[7][7] + F[5][8]*D[7][8] + F[5][9]*D[7][9] + F[5][13]*D[7][13] + F[5][14]*D[7][14] + F[5][15]*D[7][15]) + F[9][8]*(F[5][6]*D[6][8] + F[5][7]*D[7][8] + F[5][8]*D[8][8] + F[5][9]*D[8][9] + F[5][13]*D[8][13] + F[5][14]*D[8][14] + F[5][15]*D[8][15]) + F[9][10]*(F[5][6]*D[6][10] + F[5][7]*D[7][10] + F[5][8]*D[8][10] + F[5][9]*D[9][10] + F[5][13]*D[10][13] + F[5][14]*D[10][14] + F[5][15]*D[10][15]) + F[9][11]*(F[5][6]*D[6][11] + F[5][7]*D[7][11] + F[5][8]*D[8][11] + F[5][9]*D[9][11] + F[5][13]*D[11][13] + F[5][14]*D[11][14] + F[5][15]*D[11][15]) + F[9][12]*(F[5][6]*D[6][12] + F[5][7]*D[7][12] + F[5][8]*D[8][12] + F[5][9]*D[9][12] + F[5][13]*D[12][13] + F[5][14]*D[12][14] + F[5][15]*D[12][15]))*Tsq + (F[9][6]*D[5][6] + F[9][7]*D[5][7] + F[9][8]*D[5][8] + F[5][6]*D[6][9] + F[5][7]*D[7][9] + F[5][8]*D[8][9] + F[5][9]*D[9][9] + F[9][10]*D[5][10] + F[9][11]*D[5][11] + F[9][12]*D[5][12] + F[5][13]*D[9][13] + F[5][14]*D[9][14] + F[5][15]*D[9][15])*T + D[5][9];
-	P[5][10] = P[10][5] = (F[5][6]*D[6][10] + F[5][7]*D[7][10] + F[5][8]*D[8][10] + F[5][9]*D[9][10] + F[5][13]*D[10][13] + F[5][14]*D[10][14] + F[5][15]*D[10][15])*T + D[5][10];
-	P[5][11] = P[11][5] = (F[5][6]*D[6][11] + F[5][7]*D[7][11] + F[5][8]*D[8][11] + F[5][9]*D[9][11] + F[5][13]*D[11][13] + F[5][14]*D[11][14] + F[5][15]*D[11][15])*T + D[5][11];
-	P[5][12] = P[12][5] = (F[5][6]*D[6][12] + F[5][7]*D[7][12] + F[5][8]*D[8][12] + F[5][9]*D[9][12] + F[5][13]*D[12][13] + F[5][14]*D[12][14] + F[5][15]*D[12][15])*T + D[5][12];
-	P[5][13] = P[13][5] = (F[5][6]*D[6][13] + F[5][7]*D[7][13] + F[5][8]*D[8][13] + F[5][9]*D[9][13] + F[5][13]*D[13][13] + F[5][14]*D[13][14] + F[5][15]*D[13][15])*T + D[5][13];
-	P[5][14] = P[14][5] = (F[5][6]*D[6][14] + F[5][7]*D[7][14] + F[5][8]*D[8][14] + F[5][9]*D[9][14] + F[5][13]*D[13][14] + F[5][14]*D[14][14] + F[5][15]*D[14][15])*T + D[5][14];
-	P[5][15] = P[15][5] = (F[5][6]*D[6][15] + F[5][7]*D[7][15] + F[5][8]*D[8][15] + F[5][9]*D[9][15] + F[5][13]*D[13][15] + F[5][14]*D[14][15] + F[5][15]*D[15][15])*T + D[5][15];
-	P[6][6] = (Q[0]*G[6][0]*G[6][0] + Q[1]*G[6][1]*G[6][1] + Q[2]*G[6][2]*G[6][2] + F[6][7]*(F[6][7]*D[7][7] + F[6][8]*D[7][8] + F[6][9]*D[7][9] + F[6][10]*D[7][10] + F[6][11]*D[7][11] + F[6][12]*D[7][12]) + F[6][8]*(F[6][7]*D[7][8] + F[6][8]*D[8][8] + F[6][9]*D[8][9] + F[6][10]*D[8][10] + F[6][11]*D[8][11] + F[6][12]*D[8][12]) + F[6][9]*(F[6][7]*D[7][9] + F[6][8]*D[8][9] + F[6][9]*D[9][9] + F[6][10]*D[9][10] + F[6][11]*D[9][11] + F[6][12]*D[9][12]) + F[6][10]*(F[6][7]*D[7][10] + F[6][8]*D[8][10] + F[6][9]*D[9][10] + F[6][10]*D[10][10] + F[6][11]*D[10][11] + F[6][12]*D[10][12]) + F[6][11]*(F[6][7]*D[7][11] + F[6][8]*D[8][11] + F[6][9]*D[9][11] + F[6][10]*D[10][11] + F[6][11]*D[11][11] + F[6][12]*D[11][12]) + F[6][12]*(F[6][7]*D[7][12] + F[6][8]*D[8][12] + F[6][9]*D[9][12] + F[6][10]*D[10][12] + F[6][11]*D[11][12] + F[6][12]*D[12][12]))*Tsq + (2*F[6][7]*D[6][7] + 2*F[6][8]*D[6][8] + 2*F[6][9]*D[6][9] + 2*F[6][10]*D[6][10] + 2*F[6][11]*D[6][11] + 2*F[6][12]*D[6][12])*T + D[6][6];
-	P[6][7] = P[7][6] = (F[7][6]*(F[6][7]*D[6][7] + F[6][8]*D[6][8] + F[6][9]*D[6][9] + F[6][10]*D[6][10] + F[6][11]*D[6][11] + F[6][12]*D[6][12]) + F[7][8]*(F[6][7]*D[7][8] + F[6][8]*D[8][8] + F[6][9]*D[8][9] + F[6][10]*D[8][10] + F[6][11]*D[8][11] + F[6][12]*D[8][12]) + F[7][9]*(F[6][7]*D[7][9] + F[6][8]*D[8][9] + F[6][9]*D[9][9] + F[6][10]*D[9][10] + F[6][11]*D[9][11] + F[6][12]*D[9][12]) + F[7][10]*(F[6][7]*D[7][10] + F[6][8]*D[8][10] + F[6][9]*D[9][10] + F[6][10]*D[10][10] + F[6][11]*D[10][11] + F[6][12]*D[10][12]) + F[7][11]*(F[6][7]*D[7][11] + F[6][8]*D[8][11] + F[6][9]*D[9][11] + F[6][10]*D[10][11] + F[6][11]*D[11][11] + F[6][12]*D[11][12]) + F[7][12]*(F[6][7]*D[7][12] + F[6][8]*D[8][12] + F[6][9]*D[9][12] + F[6][10]*D[10][12] + F[6][11]*D[11][12] + F[6][12]*D[12][12]) + G[6][0]*G[7][0]*Q[0] + G[6][1]*G[7][1]*Q[1] + G[6][2]*G[7][2]*Q[2])*Tsq + (F[7][6]*D[6][6] + F[6][7]*D[7][7] + F[6][8]*D[7][8] + F[7][8]*D[6][8] + F[6][9]*D[7][9] + F[7][9]*D[6][9] + F[6][10]*D[7][10] + F[7][10]*D[6][10] + F[6][11]*D[7][11] + F[7][11]*D[6][11] + F[6][12]*D[7][12] + F[7][12]*D[6][12])*T + D[6][7];
-	P[6][8] = P[8][6] = (F[8][6]*(F[6][7]*D[6][7] + F[6][8]*D[6][8] + F[6][9]*D[6][9] + F[6][10]*D[6][10] + F[6][11]*D[6][11] + F[6][12]*D[6][12]) + F[8][7]*(F[6][7]*D[7][7] + F[6][8]*D[7][8] + F[6][9]*D[7][9] + F[6][10]*D[7][10] + F[6][11]*D[7][11] + F[6][12]*D[7][12]) + F[8][9]*(F[6][7]*D[7][9] + F[6][8]*D[8][9] + F[6][9]*D[9][9] + F[6][10]*D[9][10] + F[6][11]*D[9][11] + F[6][12]*D[9][12]) + F[8][10]*(F[6][7]*D[7][10] + F[6][8]*D[8][10] + F[6][9]*D[9][10] + F[6][10]*D[10][10] + F[6][11]*D[10][11] + F[6][12]*D[10][12]) + F[8][11]*(F[6][7]*D[7][11] + F[6][8]*D[8][11] + F[6][9]*D[9][11] + F[6][10]*D[10][11] + F[6][11]*D[11][11] + F[6][12]*D[11][12]) + F[8][12]*(F[6][7]*D[7][12] + F[6][8]*D[8][12] + F[6][9]*D[9][12] + F[6][10]*D[10][12] + F[6][11]*D[11][12] + F[6][12]*D[12][12]) + G[6][0]*G[8][0]*Q[0] + G[6][1]*G[8][1]*Q[1] + G[6][2]*G[8][2]*Q[2])*Tsq + (F[6][7]*D[7][8] + F[8][6]*D[6][6] + F[8][7]*D[6][7] + F[6][8]*D[8][8] + F[6][9]*D[8][9] + F[8][9]*D[6][9] + F[6][10]*D[8][10] + F[8][10]*D[6][10] + F[6][11]*D[8][11] + F[8][11]*D[6][11] + F[6][12]*D[8][12] + F[8][12]*D[6][12])*T + D[6][8];
-	P[6][9] = P[9][6] = (F[9][6]*(F[6][7]*D[6][7] + F[6][8]*D[6][8] + F[6][9]*D[6][9] + F[6][10]*D[6][10] + F[6][11]*D[6][11] + F[6][12]*D[6][12]) + F[9][7]*(F[6][7]*D[7][7] + F[6][8]*D[7][8] + F[6][9]*D[7][9] + F[6][10]*D[7][10] + F[6][11]*D[7][11] + F[6][12]*D[7][12]) + F[9][8]*(F[6][7]*D[7][8] + F[6][8]*D[8][8] + F[6][9]*D[8][9] + F[6][10]*D[8][10] + F[6][11]*D[8][11] + F[6][12]*D[8][12]) + F[9][10]*(F[6][7]*D[7][10] + F[6][8]*D[8][10] + F[6][9]*D[9][10] + F[6][10]*D[10][10] + F[6][11]*D[10][11] + F[6][12]*D[10][12]) + F[9][11]*(F[6][7]*D[7][11] + F[6][8]*D[8][11] + F[6][9]*D[9][11] + F[6][10]*D[10][11] + F[6][11]*D[11][11] + F[6][12]*D[11][12]) + F[9][12]*(F[6][7]*D[7][12] + F[6][8]*D[8][12] + F[6][9]*D[9][12] + F[6][10]*D[10][12] + F[6][11]*D[11][12] + F[6][12]*D[12][12]) + G[6][0]*G[9][0]*Q[0] + G[6][1]*G[9][1]*Q[1] + G[6][2]*G[9][2]*Q[2])*Tsq + (F[9][6]*D[6][6] + F[9][7]*D[6][7] + F[9][8]*D[6][8] + F[6][7]*D[7][9] + F[6][8]*D[8][9] + F[6][9]*D[9][9] + F[6][10]*D[9][10] + F[9][10]*D[6][10] + F[6][11]*D[9][11] + F[9][11]*D[6][11] + F[6][12]*D[9][12] + F[9][12]*D[6][12])*T + D[6][9];
-	P[6][10] = P[10][6] = (F[6][7]*D[7][10] + F[6][8]*D[8][10] + F[6][9]*D[9][10] + F[6][10]*D[10][10] + F[6][11]*D[10][11] + F[6][12]*D[10][12])*T + D[6][10];
-	P[6][11] = P[11][6] = (F[6][7]*D[7][11] + F[6][8]*D[8][11] + F[6][9]*D[9][11] + F[6][10]*D[10][11] + F[6][11]*D[11][11] + F[6][12]*D[11][12])*T + D[6][11];
-	P[6][12] = P[12][6] = (F[6][7]*D[7][12] + F[6][8]*D[8][12] + F[6][9]*D[9][12] + F[6][10]*D[10][12] + F[6][11]*D[11][12] + F[6][12]*D[12][12])*T + D[6][12];
-	P[6][13] = P[13][6] = (F[6][7]*D[7][13] + F[6][8]*D[8][13] + F[6][9]*D[9][13] + F[6][10]*D[10][13] + F[6][11]*D[11][13] + F[6][12]*D[12][13])*T + D[6][13];
-	P[6][14] = P[14][6] = (F[6][7]*D[7][14] + F[6][8]*D[8][14] + F[6][9]*D[9][14] + F[6][10]*D[10][14] + F[6][11]*D[11][14] + F[6][12]*D[12][14])*T + D[6][14];
-	P[6][15] = P[15][6] = (F[6][7]*D[7][15] + F[6][8]*D[8][15] + F[6][9]*D[9][15] + F[6][10]*D[10][15] + F[6][11]*D[11][15] + F[6][12]*D[12][15])*T + D[6][15];
-	P[7][7] = (Q[0]*G[7][0]*G[7][0] + Q[1]*G[7][1]*G[7][1] + Q[2]*G[7][2]*G[7][2] + F[7][6]*(F[7][6]*D[6][6] + F[7][8]*D[6][8] + F[7][9]*D[6][9] + F[7][10]*D[6][10] + F[7][11]*D[6][11] + F[7][12]*D[6][12]) + F[7][8]*(F[7][6]*D[6][8] + F[7][8]*D[8][8] + F[7][9]*D[8][9] + F[7][10]*D[8][10] + F[7][11]*D[8][11] + F[7][12]*D[8][12]) + F[7][9]*(F[7][6]*D[6][9] + F[7][8]*D[8][9] + F[7][9]*D[9][9] + F[7][10]*D[9][10] + F[7][11]*D[9][11] + F[7][12]*D[9][12]) + F[7][10]*(F[7][6]*D[6][10] + F[7][8]*D[8][10] + F[7][9]*D[9][10] + F[7][10]*D[10][10] + F[7][11]*D[10][11] + F[7][12]*D[10][12]) + F[7][11]*(F[7][6]*D[6][11] + F[7][8]*D[8][11] + F[7][9]*D[9][11] + F[7][10]*D[10][11] + F[7][11]*D[11][11] + F[7][12]*D[11][12]) + F[7][12]*(F[7][6]*D[6][12] + F[7][8]*D[8][12] + F[7][9]*D[9][12] + F[7][10]*D[10][12] + F[7][11]*D[11][12] + F[7][12]*D[12][12]))*Tsq + (2*F[7][6]*D[6][7] + 2*F[7][8]*D[7][8] + 2*F[7][9]*D[7][9] + 2*F[7][10]*D[7][10] + 2*F[7][11]*D[7][11] + 2*F[7][12]*D[7][12])*T + D[7][7];
-	P[7][8] = P[8][7] = (F[8][6]*(F[7][6]*D[6][6] + F[7][8]*D[6][8] + F[7][9]*D[6][9] + F[7][10]*D[6][10] + F[7][11]*D[6][11] + F[7][12]*D[6][12]) + F[8][7]*(F[7][6]*D[6][7] + F[7][8]*D[7][8] + F[7][9]*D[7][9] + F[7][10]*D[7][10] + F[7][11]*D[7][11] + F[7][12]*D[7][12]) + F[8][9]*(F[7][6]*D[6][9] + F[7][8]*D[8][9] + F[7][9]*D[9][9] + F[7][10]*D[9][10] + F[7][11]*D[9][11] + F[7][12]*D[9][12]) + F[8][10]*(F[7][6]*D[6][10] + F[7][8]*D[8][10] + F[7][9]*D[9][10] + F[7][10]*D[10][10] + F[7][11]*D[10][11] + F[7][12]*D[10][12]) + F[8][11]*(F[7][6]*D[6][11] + F[7][8]*D[8][11] + F[7][9]*D[9][11] + F[7][10]*D[10][11] + F[7][11]*D[11][11] + F[7][12]*D[11][12]) + F[8][12]*(F[7][6]*D[6][12] + F[7][8]*D[8][12] + F[7][9]*D[9][12] + F[7][10]*D[10][12] + F[7][11]*D[11][12] + F[7][12]*D[12][12]) + G[7][0]*G[8][0]*Q[0] + G[7][1]*G[8][1]*Q[1] + G[7][2]*G[8][2]*Q[2])*Tsq + (F[7][6]*D[6][8] + F[8][6]*D[6][7] + F[8][7]*D[7][7] + F[7][8]*D[8][8] + F[7][9]*D[8][9] + F[8][9]*D[7][9] + F[7][10]*D[8][10] + F[8][10]*D[7][10] + F[7][11]*D[8][11] + F[8][11]*D[7][11] + F[7][12]*D[8][12] + F[8][12]*D[7][12])*T + D[7][8];
-	P[7][9] = P[9][7] = (F[9][6]*(F[7][6]*D[6][6] + F[7][8]*D[6][8] + F[7][9]*D[6][9] + F[7][10]*D[6][10] + F[7][11]*D[6][11] + F[7][12]*D[6][12]) + F[9][7]*(F[7][6]*D[6][7] + F[7][8]*D[7][8] + F[7][9]*D[7][9] + F[7][10]*D[7][10] + F[7][11]*D[7][11] + F[7][12]*D[7][12]) + F[9][8]*(F[7][6]*D[6][8] + F[7][8]*D[8][8] + F[7][9]*D[8][9] + F[7][10]*D[8][10] + F[7][11]*D[8][11] + F[7][12]*D[8][12]) + F[9][10]*(F[7][6]*D[6][10] + F[7][8]*D[8][10] + F[7][9]*D[9][10] + F[7][10]*D[10][10] + F[7][11]*D[10][11] + F[7][12]*D[10][12]) + F[9][11]*(F[7][6]*D[6][11] + F[7][8]*D[8][11] + F[7][9]*D[9][11] + F[7][10]*D[10][11] + F[7][11]*D[11][11] + F[7][12]*D[11][12]) + F[9][12]*(F[7][6]*D[6][12] + F[7][8]*D[8][12] + F[7][9]*D[9][12] + F[7][10]*D[10][12] + F[7][11]*D[11][12] + F[7][12]*D[12][12]) + G[7][0]*G[9][0]*Q[0] + G[7][1]*G[9][1]*Q[1] + G[7][2]*G[9][2]*Q[2])*Tsq + (F[9][6]*D[6][7] + F[9][7]*D[7][7] + F[9][8]*D[7][8] + F[7][6]*D[6][9] + F[7][8]*D[8][9] + F[7][9]*D[9][9] + F[7][10]*D[9][10] + F[9][10]*D[7][10] + F[7][11]*D[9][11] + F[9][11]*D[7][11] + F[7][12]*D[9][12] + F[9][12]*D[7][12])*T + D[7][9];
-	P[7][10] = P[10][7] = (F[7][6]*D[6][10] + F[7][8]*D[8][10] + F[7][9]*D[9][10] + F[7][10]*D[10][10] + F[7][11]*D[10][11] + F[7][12]*D[10][12])*T + D[7][10];
-	P[7][11] = P[11][7] = (F[7][6]*D[6][11] + F[7][8]*D[8][11] + F[7][9]*D[9][11] + F[7][10]*D[10][11] + F[7][11]*D[11][11] + F[7][12]*D[11][12])*T + D[7][11];
-	P[7][12] = P[12][7] = (F[7][6]*D[6][12] + F[7][8]*D[8][12] + F[7][9]*D[9][12] + F[7][10]*D[10][12] + F[7][11]*D[11][12] + F[7][12]*D[12][12])*T + D[7][12];
-	P[7][13] = P[13][7] = (F[7][6]*D[6][13] + F[7][8]*D[8][13] + F[7][9]*D[9][13] + F[7][10]*D[10][13] + F[7][11]*D[11][13] + F[7][12]*D[12][13])*T + D[7][13];
-	P[7][14] = P[14][7] = (F[7][6]*D[6][14] + F[7][8]*D[8][14] + F[7][9]*D[9][14] + F[7][10]*D[10][14] + F[7][11]*D[11][14] + F[7][12]*D[12][14])*T + D[7][14];
-	P[7][15] = P[15][7] = (F[7][6]*D[6][15] + F[7][8]*D[8][15] + F[7][9]*D[9][15] + F[7][10]*D[10][15] + F[7][11]*D[11][15] + F[7][12]*D[12][15])*T + D[7][15];
-	P[8][8] = (Q[0]*G[8][0]*G[8][0] + Q[1]*G[8][1]*G[8][1] + Q[2]*G[8][2]*G[8][2] + F[8][6]*(F[8][6]*D[6][6] + F[8][7]*D[6][7] + F[8][9]*D[6][9] + F[8][10]*D[6][10] + F[8][11]*D[6][11] + F[8][12]*D[6][12]) + F[8][7]*(F[8][6]*D[6][7] + F[8][7]*D[7][7] + F[8][9]*D[7][9] + F[8][10]*D[7][10] + F[8][11]*D[7][11] + F[8][12]*D[7][12]) + F[8][9]*(F[8][6]*D[6][9] + F[8][7]*D[7][9] + F[8][9]*D[9][9] + F[8][10]*D[9][10] + F[8][11]*D[9][11] + F[8][12]*D[9][12]) + F[8][10]*(F[8][6]*D[6][10] + F[8][7]*D[7][10] + F[8][9]*D[9][10] + F[8][10]*D[10][10] + F[8][11]*D[10][11] + F[8][12]*D[10][12]) + F[8][11]*(F[8][6]*D[6][11] + F[8][7]*D[7][11] + F[8][9]*D[9][11] + F[8][10]*D[10][11] + F[8][11]*D[11][11] + F[8][12]*D[11][12]) + F[8][12]*(F[8][6]*D[6][12] + F[8][7]*D[7][12] + F[8][9]*D[9][12] + F[8][10]*D[10][12] + F[8][11]*D[11][12] + F[8][12]*D[12][12]))*Tsq + (2*F[8][6]*D[6][8] + 2*F[8][7]*D[7][8] + 2*F[8][9]*D[8][9] + 2*F[8][10]*D[8][10] + 2*F[8][11]*D[8][11] + 2*F[8][12]*D[8][12])*T + D[8][8];
-	P[8][9] = P[9][8] = (F[9][6]*(F[8][6]*D[6][6] + F[8][7]*D[6][7] + F[8][9]*D[6][9] + F[8][10]*D[6][10] + F[8][11]*D[6][11] + F[8][12]*D[6][12]) + F[9][7]*(F[8][6]*D[6][7] + F[8][7]*D[7][7] + F[8][9]*D[7][9] + F[8][10]*D[7][10] + F[8][11]*D[7][11] + F[8][12]*D[7][12]) + F[9][8]*(F[8][6]*D[6][8] + F[8][7]*D[7][8] + F[8][9]*D[8][9] + F[8][10]*D[8][10] + F[8][11]*D[8][11] + F[8][12]*D[8][12]) + F[9][10]*(F[8][6]*D[6][10] + F[8][7]*D[7][10] + F[8][9]*D[9][10] + F[8][10]*D[10][10] + F[8][11]*D[10][11] + F[8][12]*D[10][12]) + F[9][11]*(F[8][6]*D[6][11] + F[8][7]*D[7][11] + F[8][9]*D[9][11] + F[8][10]*D[10][11] + F[8][11]*D[11][11] + F[8][12]*D[11][12]) + F[9][12]*(F[8][6]*D[6][12] + F[8][7]*D[7][12] + F[8][9]*D[9][12] + F[8][10]*D[10][12] + F[8][11]*D[11][12] + F[8][12]*D[12][12]) + G[8][0]*G[9][0]*Q[0] + G[8][1]*G[9][1]*Q[1] + G[8][2]*G[9][2]*Q[2])*Tsq + (F[9][6]*D[6][8] + F[9][7]*D[7][8] + F[9][8]*D[8][8] + F[8][6]*D[6][9] + F[8][7]*D[7][9] + F[8][9]*D[9][9] + F[8][10]*D[9][10] + F[9][10]*D[8][10] + F[8][11]*D[9][11] + F[9][11]*D[8][11] + F[8][12]*D[9][12] + F[9][12]*D[8][12])*T + D[8][9];
-	P[8][10] = P[10][8] = (F[8][6]*D[6][10] + F[8][7]*D[7][10] + F[8][9]*D[9][10] + F[8][10]*D[10][10] + F[8][11]*D[10][11] + F[8][12]*D[10][12])*T + D[8][10];
-	P[8][11] = P[11][8] = (F[8][6]*D[6][11] + F[8][7]*D[7][11] + F[8][9]*D[9][11] + F[8][10]*D[10][11] + F[8][11]*D[11][11] + F[8][12]*D[11][12])*T + D[8][11];
-	P[8][12] = P[12][8] = (F[8][6]*D[6][12] + F[8][7]*D[7][12] + F[8][9]*D[9][12] + F[8][10]*D[10][12] + F[8][11]*D[11][12] + F[8][12]*D[12][12])*T + D[8][12];
-	P[8][13] = P[13][8] = (F[8][6]*D[6][13] + F[8][7]*D[7][13] + F[8][9]*D[9][13] + F[8][10]*D[10][13] + F[8][11]*D[11][13] + F[8][12]*D[12][13])*T + D[8][13];
-	P[8][14] = P[14][8] = (F[8][6]*D[6][14] + F[8][7]*D[7][14] + F[8][9]*D[9][14] + F[8][10]*D[10][14] + F[8][11]*D[11][14] + F[8][12]*D[12][14])*T + D[8][14];
-	P[8][15] = P[15][8] = (F[8][6]*D[6][15] + F[8][7]*D[7][15] + F[8][9]*D[9][15] + F[8][10]*D[10][15] + F[8][11]*D[11][15] + F[8][12]*D[12][15])*T + D[8][15];
-	P[9][9] = (Q[0]*G[9][0]*G[9][0] + Q[1]*G[9][1]*G[9][1] + Q[2]*G[9][2]*G[9][2] + F[9][6]*(F[9][6]*D[6][6] + F[9][7]*D[6][7] + F[9][8]*D[6][8] + F[9][10]*D[6][10] + F[9][11]*D[6][11] + F[9][12]*D[6][12]) + F[9][7]*(F[9][6]*D[6][7] + F[9][7]*D[7][7] + F[9][8]*D[7][8] + F[9][10]*D[7][10] + F[9][11]*D[7][11] + F[9][12]*D[7][12]) + F[9][8]*(F[9][6]*D[6][8] + F[9][7]*D[7][8] + F[9][8]*D[8][8] + F[9][10]*D[8][10] + F[9][11]*D[8][11] + F[9][12]*D[8][12]) + F[9][10]*(F[9][6]*D[6][10] + F[9][7]*D[7][10] + F[9][8]*D[8][10] + F[9][10]*D[10][10] + F[9][11]*D[10][11] + F[9][12]*D[10][12]) + F[9][11]*(F[9][6]*D[6][11] + F[9][7]*D[7][11] + F[9][8]*D[8][11] + F[9][10]*D[10][11] + F[9][11]*D[11][11] + F[9][12]*D[11][12]) + F[9][12]*(F[9][6]*D[6][12] + F[9][7]*D[7][12] + F[9][8]*D[8][12] + F[9][10]*D[10][12] + F[9][11]*D[11][12] + F[9][12]*D[12][12]))*Tsq + (2*F[9][6]*D[6][9] + 2*F[9][7]*D[7][9] + 2*F[9][8]*D[8][9] + 2*F[9][10]*D[9][10] + 2*F[9][11]*D[9][11] + 2*F[9][12]*D[9][12])*T + D[9][9];
-	P[9][10] = P[10][9] = (F[9][6]*D[6][10] + F[9][7]*D[7][10] + F[9][8]*D[8][10] + F[9][10]*D[10][10] + F[9][11]*D[10][11] + F[9][12]*D[10][12])*T + D[9][10];
-	P[9][11] = P[11][9] = (F[9][6]*D[6][11] + F[9][7]*D[7][11] + F[9][8]*D[8][11] + F[9][10]*D[10][11] + F[9][11]*D[11][11] + F[9][12]*D[11][12])*T + D[9][11];
-	P[9][12] = P[12][9] = (F[9][6]*D[6][12] + F[9][7]*D[7][12] + F[9][8]*D[8][12] + F[9][10]*D[10][12] + F[9][11]*D[11][12] + F[9][12]*D[12][12])*T + D[9][12];
-	P[9][13] = P[13][9] = (F[9][6]*D[6][13] + F[9][7]*D[7][13] + F[9][8]*D[8][13] + F[9][10]*D[10][13] + F[9][11]*D[11][13] + F[9][12]*D[12][13])*T + D[9][13];
-	P[9][14] = P[14][9] = (F[9][6]*D[6][14] + F[9][7]*D[7][14] + F[9][8]*D[8][14] + F[9][10]*D[10][14] + F[9][11]*D[11][14] + F[9][12]*D[12][14])*T + D[9][14];
-	P[9][15] = P[15][9] = (F[9][6]*D[6][15] + F[9][7]*D[7][15] + F[9][8]*D[8][15] + F[9][10]*D[10][15] + F[9][11]*D[11][15] + F[9][12]*D[12][15])*T + D[9][15];
-	P[10][10] = Q[6]*Tsq + D[10][10];
-	P[10][11] = P[11][10] = D[10][11];
-	P[10][12] = P[12][10] = D[10][12];
-	P[10][13] = P[13][10] = D[10][13];
-	P[10][14] = P[14][10] = D[10][14];
-	P[10][15] = P[15][10] = D[10][15];
-	P[11][11] = Q[7]*Tsq + D[11][11];
-	P[11][12] = P[12][11] = D[11][12];
-	P[11][13] = P[13][11] = D[11][13];
-	P[11][14] = P[14][11] = D[11][14];
-	P[11][15] = P[15][11] = D[11][15];
-	P[12][12] = Q[8]*Tsq + D[12][12];
-	P[12][13] = P[13][12] = D[12][13];
-	P[12][14] = P[14][12] = D[12][14];
-	P[12][15] = P[15][12] = D[12][15];
-	P[13][13] = Q[9]*Tsq + D[13][13];
-	P[13][14] = P[14][13] = D[13][14];
-	P[13][15] = P[15][13] = D[13][15];
-	P[14][14] = Q[10]*Tsq + D[14][14];
-	P[14][15] = P[15][14] = D[14][15];
-	P[15][15] = Q[11]*Tsq + D[15][15];
+	P[PIDX(0,0)] = D[PIDX(3,3)]*Tsq + (2*D[PIDX(0,3)])*T + D[PIDX(0,0)];
+	P[PIDX(0,1)] = D[PIDX(3,4)]*Tsq + (D[PIDX(0,4)] + D[PIDX(1,3)])*T + D[PIDX(0,1)];
+	P[PIDX(0,2)] = D[PIDX(3,5)]*Tsq + (D[PIDX(0,5)] + D[PIDX(2,3)])*T + D[PIDX(0,2)];
+	P[PIDX(0,3)] = (F[3][6]*D[PIDX(3,6)] + F[3][7]*D[PIDX(3,7)] + F[3][8]*D[PIDX(3,8)] + F[3][9]*D[PIDX(3,9)] + F[3][13]*D[PIDX(3,13)] + F[3][14]*D[PIDX(3,14)] + F[3][15]*D[PIDX(3,15)])*Tsq + (D[PIDX(3,3)] + F[3][6]*D[PIDX(0,6)] + F[3][7]*D[PIDX(0,7)] + F[3][8]*D[PIDX(0,8)] + F[3][9]*D[PIDX(0,9)] + F[3][13]*D[PIDX(0,13)] + F[3][14]*D[PIDX(0,14)] + F[3][15]*D[PIDX(0,15)])*T + D[PIDX(0,3)];
+	P[PIDX(0,4)] = (F[4][6]*D[PIDX(3,6)] + F[4][7]*D[PIDX(3,7)] + F[4][8]*D[PIDX(3,8)] + F[4][9]*D[PIDX(3,9)] + F[4][13]*D[PIDX(3,13)] + F[4][14]*D[PIDX(3,14)] + F[4][15]*D[PIDX(3,15)])*Tsq + (D[PIDX(3,4)] + F[4][6]*D[PIDX(0,6)] + F[4][7]*D[PIDX(0,7)] + F[4][8]*D[PIDX(0,8)] + F[4][9]*D[PIDX(0,9)] + F[4][13]*D[PIDX(0,13)] + F[4][14]*D[PIDX(0,14)] + F[4][15]*D[PIDX(0,15)])*T + D[PIDX(0,4)];
+	P[PIDX(0,5)] = (F[5][6]*D[PIDX(3,6)] + F[5][7]*D[PIDX(3,7)] + F[5][8]*D[PIDX(3,8)] + F[5][9]*D[PIDX(3,9)] + F[5][13]*D[PIDX(3,13)] + F[5][14]*D[PIDX(3,14)] + F[5][15]*D[PIDX(3,15)])*Tsq + (D[PIDX(3,5)] + F[5][6]*D[PIDX(0,6)] + F[5][7]*D[PIDX(0,7)] + F[5][8]*D[PIDX(0,8)] + F[5][9]*D[PIDX(0,9)] + F[5][13]*D[PIDX(0,13)] + F[5][14]*D[PIDX(0,14)] + F[5][15]*D[PIDX(0,15)])*T + D[PIDX(0,5)];
+	P[PIDX(0,6)] = (F[6][7]*D[PIDX(3,7)] + F[6][8]*D[PIDX(3,8)] + F[6][9]*D[PIDX(3,9)] + F[6][10]*D[PIDX(3,10)] + F[6][11]*D[PIDX(3,11)] + F[6][12]*D[PIDX(3,12)])*Tsq + (D[PIDX(3,6)] + F[6][7]*D[PIDX(0,7)] + F[6][8]*D[PIDX(0,8)] + F[6][9]*D[PIDX(0,9)] + F[6][10]*D[PIDX(0,10)] + F[6][11]*D[PIDX(0,11)] + F[6][12]*D[PIDX(0,12)])*T + D[PIDX(0,6)];
+	P[PIDX(0,7)] = (F[7][6]*D[PIDX(3,6)] + F[7][8]*D[PIDX(3,8)] + F[7][9]*D[PIDX(3,9)] + F[7][10]*D[PIDX(3,10)] + F[7][11]*D[PIDX(3,11)] + F[7][12]*D[PIDX(3,12)])*Tsq + (D[PIDX(3,7)] + F[7][6]*D[PIDX(0,6)] + F[7][8]*D[PIDX(0,8)] + F[7][9]*D[PIDX(0,9)] + F[7][10]*D[PIDX(0,10)] + F[7][11]*D[PIDX(0,11)] + F[7][12]*D[PIDX(0,12)])*T + D[PIDX(0,7)];
+	P[PIDX(0,8)] = (F[8][6]*D[PIDX(3,6)] + F[8][7]*D[PIDX(3,7)] + F[8][9]*D[PIDX(3,9)] + F[8][10]*D[PIDX(3,10)] + F[8][11]*D[PIDX(3,11)] + F[8][12]*D[PIDX(3,12)])*Tsq + (D[PIDX(3,8)] + F[8][6]*D[PIDX(0,6)] + F[8][7]*D[PIDX(0,7)] + F[8][9]*D[PIDX(0,9)] + F[8][10]*D[PIDX(0,10)] + F[8][11]*D[PIDX(0,11)] + F[8][12]*D[PIDX(0,12)])*T + D[PIDX(0,8)];
+	P[PIDX(0,9)] = (F[9][6]*D[PIDX(3,6)] + F[9][7]*D[PIDX(3,7)] + F[9][8]*D[PIDX(3,8)] + F[9][10]*D[PIDX(3,10)] + F[9][11]*D[PIDX(3,11)] + F[9][12]*D[PIDX(3,12)])*Tsq + (D[PIDX(3,9)] + F[9][6]*D[PIDX(0,6)] + F[9][7]*D[PIDX(0,7)] + F[9][8]*D[PIDX(0,8)] + F[9][10]*D[PIDX(0,10)] + F[9][11]*D[PIDX(0,11)] + F[9][12]*D[PIDX(0,12)])*T + D[PIDX(0,9)];
+	P[PIDX(0,10)] = D[PIDX(3,10)]*T + D[PIDX(0,10)];
+	P[PIDX(0,11)] = D[PIDX(3,11)]*T + D[PIDX(0,11)];
+	P[PIDX(0,12)] = D[PIDX(3,12)]*T + D[PIDX(0,12)];
+	P[PIDX(0,13)] = D[PIDX(3,13)]*T + D[PIDX(0,13)];
+	P[PIDX(0,14)] = D[PIDX(3,14)]*T + D[PIDX(0,14)];
+	P[PIDX(0,15)] = D[PIDX(3,15)]*T + D[PIDX(0,15)];
+	P[PIDX(1,1)] = D[PIDX(4,4)]*Tsq + (2*D[PIDX(1,4)])*T + D[PIDX(1,1)];
+	P[PIDX(1,2)] = D[PIDX(4,5)]*Tsq + (D[PIDX(1,5)] + D[PIDX(2,4)])*T + D[PIDX(1,2)];
+	P[PIDX(1,3)] = (F[3][6]*D[PIDX(4,6)] + F[3][7]*D[PIDX(4,7)] + F[3][8]*D[PIDX(4,8)] + F[3][9]*D[PIDX(4,9)] + F[3][13]*D[PIDX(4,13)] + F[3][14]*D[PIDX(4,14)] + F[3][15]*D[PIDX(4,15)])*Tsq + (D[PIDX(3,4)] + F[3][6]*D[PIDX(1,6)] + F[3][7]*D[PIDX(1,7)] + F[3][8]*D[PIDX(1,8)] + F[3][9]*D[PIDX(1,9)] + F[3][13]*D[PIDX(1,13)] + F[3][14]*D[PIDX(1,14)] + F[3][15]*D[PIDX(1,15)])*T + D[PIDX(1,3)];
+	P[PIDX(1,4)] = (F[4][6]*D[PIDX(4,6)] + F[4][7]*D[PIDX(4,7)] + F[4][8]*D[PIDX(4,8)] + F[4][9]*D[PIDX(4,9)] + F[4][13]*D[PIDX(4,13)] + F[4][14]*D[PIDX(4,14)] + F[4][15]*D[PIDX(4,15)])*Tsq + (D[PIDX(4,4)] + F[4][6]*D[PIDX(1,6)] + F[4][7]*D[PIDX(1,7)] + F[4][8]*D[PIDX(1,8)] + F[4][9]*D[PIDX(1,9)] + F[4][13]*D[PIDX(1,13)] + F[4][14]*D[PIDX(1,14)] + F[4][15]*D[PIDX(1,15)])*T + D[PIDX(1,4)];
+	P[PIDX(1,5)] = (F[5][6]*D[PIDX(4,6)] + F[5][7]*D[PIDX(4,7)] + F[5][8]*D[PIDX(4,8)] + F[5][9]*D[PIDX(4,9)] + F[5][13]*D[PIDX(4,13)] + F[5][14]*D[PIDX(4,14)] + F[5][15]*D[PIDX(4,15)])*Tsq + (D[PIDX(4,5)] + F[5][6]*D[PIDX(1,6)] + F[5][7]*D[PIDX(1,7)] + F[5][8]*D[PIDX(1,8)] + F[5][9]*D[PIDX(1,9)] + F[5][13]*D[PIDX(1,13)] + F[5][14]*D[PIDX(1,14)] + F[5][15]*D[PIDX(1,15)])*T + D[PIDX(1,5)];
+	P[PIDX(1,6)] = (F[6][7]*D[PIDX(4,7)] + F[6][8]*D[PIDX(4,8)] + F[6][9]*D[PIDX(4,9)] + F[6][10]*D[PIDX(4,10)] + F[6][11]*D[PIDX(4,11)] + F[6][12]*D[PIDX(4,12)])*Tsq + (D[PIDX(4,6)] + F[6][7]*D[PIDX(1,7)] + F[6][8]*D[PIDX(1,8)] + F[6][9]*D[PIDX(1,9)] + F[6][10]*D[PIDX(1,10)] + F[6][11]*D[PIDX(1,11)] + F[6][12]*D[PIDX(1,12)])*T + D[PIDX(1,6)];
+	P[PIDX(1,7)] = (F[7][6]*D[PIDX(4,6)] + F[7][8]*D[PIDX(4,8)] + F[7][9]*D[PIDX(4,9)] + F[7][10]*D[PIDX(4,10)] + F[7][11]*D[PIDX(4,11)] + F[7][12]*D[PIDX(4,12)])*Tsq + (D[PIDX(4,7)] + F[7][6]*D[PIDX(1,6)] + F[7][8]*D[PIDX(1,8)] + F[7][9]*D[PIDX(1,9)] + F[7][10]*D[PIDX(1,10)] + F[7][11]*D[PIDX(1,11)] + F[7][12]*D[PIDX(1,12)])*T + D[PIDX(1,7)];
+	P[PIDX(1,8)] = (F[8][6]*D[PIDX(4,6)] + F[8][7]*D[PIDX(4,7)] + F[8][9]*D[PIDX(4,9)] + F[8][10]*D[PIDX(4,10)] + F[8][11]*D[PIDX(4,11)] + F[8][12]*D[PIDX(4,12)])*Tsq + (D[PIDX(4,8)] + F[8][6]*D[PIDX(1,6)] + F[8][7]*D[PIDX(1,7)] + F[8][9]*D[PIDX(1,9)] + F[8][10]*D[PIDX(1,10)] + F[8][11]*D[PIDX(1,11)] + F[8][12]*D[PIDX(1,12)])*T + D[PIDX(1,8)];
+	P[PIDX(1,9)] = (F[9][6]*D[PIDX(4,6)] + F[9][7]*D[PIDX(4,7)] + F[9][8]*D[PIDX(4,8)] + F[9][10]*D[PIDX(4,10)] + F[9][11]*D[PIDX(4,11)] + F[9][12]*D[PIDX(4,12)])*Tsq + (D[PIDX(4,9)] + F[9][6]*D[PIDX(1,6)] + F[9][7]*D[PIDX(1,7)] + F[9][8]*D[PIDX(1,8)] + F[9][10]*D[PIDX(1,10)] + F[9][11]*D[PIDX(1,11)] + F[9][12]*D[PIDX(1,12)])*T + D[PIDX(1,9)];
+	P[PIDX(1,10)] = D[PIDX(4,10)]*T + D[PIDX(1,10)];
+	P[PIDX(1,11)] = D[PIDX(4,11)]*T + D[PIDX(1,11)];
+	P[PIDX(1,12)] = D[PIDX(4,12)]*T + D[PIDX(1,12)];
+	P[PIDX(1,13)] = D[PIDX(4,13)]*T + D[PIDX(1,13)];
+	P[PIDX(1,14)] = D[PIDX(4,14)]*T + D[PIDX(1,14)];
+	P[PIDX(1,15)] = D[PIDX(4,15)]*T + D[PIDX(1,15)];
+	P[PIDX(2,2)] = D[PIDX(5,5)]*Tsq + (2*D[PIDX(2,5)])*T + D[PIDX(2,2)];
+	P[PIDX(2,3)] = (F[3][6]*D[PIDX(5,6)] + F[3][7]*D[PIDX(5,7)] + F[3][8]*D[PIDX(5,8)] + F[3][9]*D[PIDX(5,9)] + F[3][13]*D[PIDX(5,13)] + F[3][14]*D[PIDX(5,14)] + F[3][15]*D[PIDX(5,15)])*Tsq + (D[PIDX(3,5)] + F[3][6]*D[PIDX(2,6)] + F[3][7]*D[PIDX(2,7)] + F[3][8]*D[PIDX(2,8)] + F[3][9]*D[PIDX(2,9)] + F[3][13]*D[PIDX(2,13)] + F[3][14]*D[PIDX(2,14)] + F[3][15]*D[PIDX(2,15)])*T + D[PIDX(2,3)];
+	P[PIDX(2,4)] = (F[4][6]*D[PIDX(5,6)] + F[4][7]*D[PIDX(5,7)] + F[4][8]*D[PIDX(5,8)] + F[4][9]*D[PIDX(5,9)] + F[4][13]*D[PIDX(5,13)] + F[4][14]*D[PIDX(5,14)] + F[4][15]*D[PIDX(5,15)])*Tsq + (D[PIDX(4,5)] + F[4][6]*D[PIDX(2,6)] + F[4][7]*D[PIDX(2,7)] + F[4][8]*D[PIDX(2,8)] + F[4][9]*D[PIDX(2,9)] + F[4][13]*D[PIDX(2,13)] + F[4][14]*D[PIDX(2,14)] + F[4][15]*D[PIDX(2,15)])*T + D[PIDX(2,4)];
+	P[PIDX(2,5)] = (F[5][6]*D[PIDX(5,6)] + F[5][7]*D[PIDX(5,7)] + F[5][8]*D[PIDX(5,8)] + F[5][9]*D[PIDX(5,9)] + F[5][13]*D[PIDX(5,13)] + F[5][14]*D[PIDX(5,14)] + F[5][15]*D[PIDX(5,15)])*Tsq + (D[PIDX(5,5)] + F[5][6]*D[PIDX(2,6)] + F[5][7]*D[PIDX(2,7)] + F[5][8]*D[PIDX(2,8)] + F[5][9]*D[PIDX(2,9)] + F[5][13]*D[PIDX(2,13)] + F[5][14]*D[PIDX(2,14)] + F[5][15]*D[PIDX(2,15)])*T + D[PIDX(2,5)];
+	P[PIDX(2,6)] = (F[6][7]*D[PIDX(5,7)] + F[6][8]*D[PIDX(5,8)] + F[6][9]*D[PIDX(5,9)] + F[6][10]*D[PIDX(5,10)] + F[6][11]*D[PIDX(5,11)] + F[6][12]*D[PIDX(5,12)])*Tsq + (D[PIDX(5,6)] + F[6][7]*D[PIDX(2,7)] + F[6][8]*D[PIDX(2,8)] + F[6][9]*D[PIDX(2,9)] + F[6][10]*D[PIDX(2,10)] + F[6][11]*D[PIDX(2,11)] + F[6][12]*D[PIDX(2,12)])*T + D[PIDX(2,6)];
+	P[PIDX(2,7)] = (F[7][6]*D[PIDX(5,6)] + F[7][8]*D[PIDX(5,8)] + F[7][9]*D[PIDX(5,9)] + F[7][10]*D[PIDX(5,10)] + F[7][11]*D[PIDX(5,11)] + F[7][12]*D[PIDX(5,12)])*Tsq + (D[PIDX(5,7)] + F[7][6]*D[PIDX(2,6)] + F[7][8]*D[PIDX(2,8)] + F[7][9]*D[PIDX(2,9)] + F[7][10]*D[PIDX(2,10)] + F[7][11]*D[PIDX(2,11)] + F[7][12]*D[PIDX(2,12)])*T + D[PIDX(2,7)];
+	P[PIDX(2,8)] = (F[8][6]*D[PIDX(5,6)] + F[8][7]*D[PIDX(5,7)] + F[8][9]*D[PIDX(5,9)] + F[8][10]*D[PIDX(5,10)] + F[8][11]*D[PIDX(5,11)] + F[8][12]*D[PIDX(5,12)])*Tsq + (D[PIDX(5,8)] + F[8][6]*D[PIDX(2,6)] + F[8][7]*D[PIDX(2,7)] + F[8][9]*D[PIDX(2,9)] + F[8][10]*D[PIDX(2,10)] + F[8][11]*D[PIDX(2,11)] + F[8][12]*D[PIDX(2,12)])*T + D[PIDX(2,8)];
+	P[PIDX(2,9)] = (F[9][6]*D[PIDX(5,6)] + F[9][7]*D[PIDX(5,7)] + F[9][8]*D[PIDX(5,8)] + F[9][10]*D[PIDX(5,10)] + F[9][11]*D[PIDX(5,11)] + F[9][12]*D[PIDX(5,12)])*Tsq + (D[PIDX(5,9)] + F[9][6]*D[PIDX(2,6)] + F[9][7]*D[PIDX(2,7)] + F[9][8]*D[PIDX(2,8)] + F[9][10]*D[PIDX(2,10)] + F[9][11]*D[PIDX(2,11)] + F[9][12]*D[PIDX(2,12)])*T + D[PIDX(2,9)];
+	P[PIDX(2,10)] = D[PIDX(5,10)]*T + D[PIDX(2,10)];
+	P[PIDX(2,11)] = D[PIDX(5,11)]*T + D[PIDX(2,11)];
+	P[PIDX(2,12)] = D[PIDX(5,12)]*T + D[PIDX(2,12)];
+	P[PIDX(2,13)] = D[PIDX(5,13)]*T + D[PIDX(2,13)];
+	P[PIDX(2,14)] = D[PIDX(5,14)]*T + D[PIDX(2,14)];
+	P[PIDX(2,15)] = D[PIDX(5,15)]*T + D[PIDX(2,15)];
+	P[PIDX(3,3)] = (Q[3]*G[3][3]*G[3][3] + Q[4]*G[3][4]*G[3][4] + Q[5]*G[3][5]*G[3][5] + F[3][6]*(F[3][6]*D[PIDX(6,6)] + F[3][7]*D[PIDX(6,7)] + F[3][8]*D[PIDX(6,8)] + F[3][9]*D[PIDX(6,9)] + F[3][13]*D[PIDX(6,13)] + F[3][14]*D[PIDX(6,14)] + F[3][15]*D[PIDX(6,15)]) + F[3][7]*(F[3][6]*D[PIDX(6,7)] + F[3][7]*D[PIDX(7,7)] + F[3][8]*D[PIDX(7,8)] + F[3][9]*D[PIDX(7,9)] + F[3][13]*D[PIDX(7,13)] + F[3][14]*D[PIDX(7,14)] + F[3][15]*D[PIDX(7,15)]) + F[3][8]*(F[3][6]*D[PIDX(6,8)] + F[3][7]*D[PIDX(7,8)] + F[3][8]*D[PIDX(8,8)] + F[3][9]*D[PIDX(8,9)] + F[3][13]*D[PIDX(8,13)] + F[3][14]*D[PIDX(8,14)] + F[3][15]*D[PIDX(8,15)]) + F[3][9]*(F[3][6]*D[PIDX(6,9)] + F[3][7]*D[PIDX(7,9)] + F[3][8]*D[PIDX(8,9)] + F[3][9]*D[PIDX(9,9)] + F[3][13]*D[PIDX(9,13)] + F[3][14]*D[PIDX(9,14)] + F[3][15]*D[PIDX(9,15)]) + F[3][13]*(F[3][6]*D[PIDX(6,13)] + F[3][7]*D[PIDX(7,13)] + F[3][8]*D[PIDX(8,13)] + F[3][9]*D[PIDX(9,13)] + F[3][13]*D[PIDX(13,13)] + F[3][14]*D[PIDX(13,14)] + F[3][15]*D[PIDX(13,15)]) + F[3][14]*(F[3][6]*D[PIDX(6,14)] + F[3][7]*D[PIDX(7,14)] + F[3][8]*D[PIDX(8,14)] + F[3][9]*D[PIDX(9,14)] + F[3][13]*D[PIDX(13,14)] + F[3][14]*D[PIDX(14,14)] + F[3][15]*D[PIDX(14,15)]) + F[3][15]*(F[3][6]*D[PIDX(6,15)] + F[3][7]*D[PIDX(7,15)] + F[3][8]*D[PIDX(8,15)] + F[3][9]*D[PIDX(9,15)] + F[3][13]*D[PIDX(13,15)] + F[3][14]*D[PIDX(14,15)] + F[3][15]*D[PIDX(15,15)]))*Tsq + (2*F[3][6]*D[PIDX(3,6)] + 2*F[3][7]*D[PIDX(3,7)] + 2*F[3][8]*D[PIDX(3,8)] + 2*F[3][9]*D[PIDX(3,9)] + 2*F[3][13]*D[PIDX(3,13)] + 2*F[3][14]*D[PIDX(3,14)] + 2*F[3][15]*D[PIDX(3,15)])*T + D[PIDX(3,3)];
+	P[PIDX(3,4)] = (F[4][6]*(F[3][6]*D[PIDX(6,6)] + F[3][7]*D[PIDX(6,7)] + F[3][8]*D[PIDX(6,8)] + F[3][9]*D[PIDX(6,9)] + F[3][13]*D[PIDX(6,13)] + F[3][14]*D[PIDX(6,14)] + F[3][15]*D[PIDX(6,15)]) + F[4][7]*(F[3][6]*D[PIDX(6,7)] + F[3][7]*D[PIDX(7,7)] + F[3][8]*D[PIDX(7,8)] + F[3][9]*D[PIDX(7,9)] + F[3][13]*D[PIDX(7,13)] + F[3][14]*D[PIDX(7,14)] + F[3][15]*D[PIDX(7,15)]) + F[4][8]*(F[3][6]*D[PIDX(6,8)] + F[3][7]*D[PIDX(7,8)] + F[3][8]*D[PIDX(8,8)] + F[3][9]*D[PIDX(8,9)] + F[3][13]*D[PIDX(8,13)] + F[3][14]*D[PIDX(8,14)] + F[3][15]*D[PIDX(8,15)]) + F[4][9]*(F[3][6]*D[PIDX(6,9)] + F[3][7]*D[PIDX(7,9)] + F[3][8]*D[PIDX(8,9)] + F[3][9]*D[PIDX(9,9)] + F[3][13]*D[PIDX(9,13)] + F[3][14]*D[PIDX(9,14)] + F[3][15]*D[PIDX(9,15)]) + F[4][13]*(F[3][6]*D[PIDX(6,13)] + F[3][7]*D[PIDX(7,13)] + F[3][8]*D[PIDX(8,13)] + F[3][9]*D[PIDX(9,13)] + F[3][13]*D[PIDX(13,13)] + F[3][14]*D[PIDX(13,14)] + F[3][15]*D[PIDX(13,15)]) + F[4][14]*(F[3][6]*D[PIDX(6,14)] + F[3][7]*D[PIDX(7,14)] + F[3][8]*D[PIDX(8,14)] + F[3][9]*D[PIDX(9,14)] + F[3][13]*D[PIDX(13,14)] + F[3][14]*D[PIDX(14,14)] + F[3][15]*D[PIDX(14,15)]) + F[4][15]*(F[3][6]*D[PIDX(6,15)] + F[3][7]*D[PIDX(7,15)] + F[3][8]*D[PIDX(8,15)] + F[3][9]*D[PIDX(9,15)] + F[3][13]*D[PIDX(13,15)] + F[3][14]*D[PIDX(14,15)] + F[3][15]*D[PIDX(15,15)]) + G[3][3]*G[4][3]*Q[3] + G[3][4]*G[4][4]*Q[4] + G[3][5]*G[4][5]*Q[5])*Tsq + (F[3][6]*D[PIDX(4,6)] + F[4][6]*D[PIDX(3,6)] + F[3][7]*D[PIDX(4,7)] + F[4][7]*D[PIDX(3,7)] + F[3][8]*D[PIDX(4,8)] + F[4][8]*D[PIDX(3,8)] + F[3][9]*D[PIDX(4,9)] + F[4][9]*D[PIDX(3,9)] + F[3][13]*D[PIDX(4,13)] + F[4][13]*D[PIDX(3,13)] + F[3][14]*D[PIDX(4,14)] + F[4][14]*D[PIDX(3,14)] + F[3][15]*D[PIDX(4,15)] + F[4][15]*D[PIDX(3,15)])*T + D[PIDX(3,4)];
+	P[PIDX(3,5)] = (F[5][6]*(F[3][6]*D[PIDX(6,6)] + F[3][7]*D[PIDX(6,7)] + F[3][8]*D[PIDX(6,8)] + F[3][9]*D[PIDX(6,9)] + F[3][13]*D[PIDX(6,13)] + F[3][14]*D[PIDX(6,14)] + F[3][15]*D[PIDX(6,15)]) + F[5][7]*(F[3][6]*D[PIDX(6,7)] + F[3][7]*D[PIDX(7,7)] + F[3][8]*D[PIDX(7,8)] + F[3][9]*D[PIDX(7,9)] + F[3][13]*D[PIDX(7,13)] + F[3][14]*D[PIDX(7,14)] + F[3][15]*D[PIDX(7,15)]) + F[5][8]*(F[3][6]*D[PIDX(6,8)] + F[3][7]*D[PIDX(7,8)] + F[3][8]*D[PIDX(8,8)] + F[3][9]*D[PIDX(8,9)] + F[3][13]*D[PIDX(8,13)] + F[3][14]*D[PIDX(8,14)] + F[3][15]*D[PIDX(8,15)]) + F[5][9]*(F[3][6]*D[PIDX(6,9)] + F[3][7]*D[PIDX(7,9)] + F[3][8]*D[PIDX(8,9)] + F[3][9]*D[PIDX(9,9)] + F[3][13]*D[PIDX(9,13)] + F[3][14]*D[PIDX(9,14)] + F[3][15]*D[PIDX(9,15)]) + F[5][13]*(F[3][6]*D[PIDX(6,13)] + F[3][7]*D[PIDX(7,13)] + F[3][8]*D[PIDX(8,13)] + F[3][9]*D[PIDX(9,13)] + F[3][13]*D[PIDX(13,13)] + F[3][14]*D[PIDX(13,14)] + F[3][15]*D[PIDX(13,15)]) + F[5][14]*(F[3][6]*D[PIDX(6,14)] + F[3][7]*D[PIDX(7,14)] + F[3][8]*D[PIDX(8,14)] + F[3][9]*D[PIDX(9,14)] + F[3][13]*D[PIDX(13,14)] + F[3][14]*D[PIDX(14,14)] + F[3][15]*D[PIDX(14,15)]) + F[5][15]*(F[3][6]*D[PIDX(6,15)] + F[3][7]*D[PIDX(7,15)] + F[3][8]*D[PIDX(8,15)] + F[3][9]*D[PIDX(9,15)] + F[3][13]*D[PIDX(13,15)] + F[3][14]*D[PIDX(14,15)] + F[3][15]*D[PIDX(15,15)]) + G[3][3]*G[5][3]*Q[3] + G[3][4]*G[5][4]*Q[4] + G[3][5]*G[5][5]*Q[5])*Tsq + (F[3][6]*D[PIDX(5,6)] + F[5][6]*D[PIDX(3,6)] + F[3][7]*D[PIDX(5,7)] + F[5][7]*D[PIDX(3,7)] + F[3][8]*D[PIDX(5,8)] + F[5][8]*D[PIDX(3,8)] + F[3][9]*D[PIDX(5,9)] + F[5][9]*D[PIDX(3,9)] + F[3][13]*D[PIDX(5,13)] + F[5][13]*D[PIDX(3,13)] + F[3][14]*D[PIDX(5,14)] + F[5][14]*D[PIDX(3,14)] + F[3][15]*D[PIDX(5,15)] + F[5][15]*D[PIDX(3,15)])*T + D[PIDX(3,5)];
+	P[PIDX(3,6)] = (F[6][7]*(F[3][6]*D[PIDX(6,7)] + F[3][7]*D[PIDX(7,7)] + F[3][8]*D[PIDX(7,8)] + F[3][9]*D[PIDX(7,9)] + F[3][13]*D[PIDX(7,13)] + F[3][14]*D[PIDX(7,14)] + F[3][15]*D[PIDX(7,15)]) + F[6][8]*(F[3][6]*D[PIDX(6,8)] + F[3][7]*D[PIDX(7,8)] + F[3][8]*D[PIDX(8,8)] + F[3][9]*D[PIDX(8,9)] + F[3][13]*D[PIDX(8,13)] + F[3][14]*D[PIDX(8,14)] + F[3][15]*D[PIDX(8,15)]) + F[6][9]*(F[3][6]*D[PIDX(6,9)] + F[3][7]*D[PIDX(7,9)] + F[3][8]*D[PIDX(8,9)] + F[3][9]*D[PIDX(9,9)] + F[3][13]*D[PIDX(9,13)] + F[3][14]*D[PIDX(9,14)] + F[3][15]*D[PIDX(9,15)]) + F[6][10]*(F[3][6]*D[PIDX(6,10)] + F[3][7]*D[PIDX(7,10)] + F[3][8]*D[PIDX(8,10)] + F[3][9]*D[PIDX(9,10)] + F[3][13]*D[PIDX(10,13)] + F[3][14]*D[PIDX(10,14)] + F[3][15]*D[PIDX(10,15)]) + F[6][11]*(F[3][6]*D[PIDX(6,11)] + F[3][7]*D[PIDX(7,11)] + F[3][8]*D[PIDX(8,11)] + F[3][9]*D[PIDX(9,11)] + F[3][13]*D[PIDX(11,13)] + F[3][14]*D[PIDX(11,14)] + F[3][15]*D[PIDX(11,15)]) + F[6][12]*(F[3][6]*D[PIDX(6,12)] + F[3][7]*D[PIDX(7,12)] + F[3][8]*D[PIDX(8,12)] + F[3][9]*D[PIDX(9,12)] + F[3][13]*D[PIDX(12,13)] + F[3][14]*D[PIDX(12,14)] + F[3][15]*D[PIDX(12,15)]))*Tsq + (F[3][6]*D[PIDX(6,6)] + F[3][7]*D[PIDX(6,7)] + F[6][7]*D[PIDX(3,7)] + F[3][8]*D[PIDX(6,8)] + F[6][8]*D[PIDX(3,8)] + F[3][9]*D[PIDX(6,9)] + F[6][9]*D[PIDX(3,9)] + F[6][10]*D[PIDX(3,10)] + F[6][11]*D[PIDX(3,11)] + F[6][12]*D[PIDX(3,12)] + F[3][13]*D[PIDX(6,13)] + F[3][14]*D[PIDX(6,14)] + F[3][15]*D[PIDX(6,15)])*T + D[PIDX(3,6)];
+	P[PIDX(3,7)] = (F[7][6]*(F[3][6]*D[PIDX(6,6)] + F[3][7]*D[PIDX(6,7)] + F[3][8]*D[PIDX(6,8)] + F[3][9]*D[PIDX(6,9)] + F[3][13]*D[PIDX(6,13)] + F[3][14]*D[PIDX(6,14)] + F[3][15]*D[PIDX(6,15)]) + F[7][8]*(F[3][6]*D[PIDX(6,8)] + F[3][7]*D[PIDX(7,8)] + F[3][8]*D[PIDX(8,8)] + F[3][9]*D[PIDX(8,9)] + F[3][13]*D[PIDX(8,13)] + F[3][14]*D[PIDX(8,14)] + F[3][15]*D[PIDX(8,15)]) + F[7][9]*(F[3][6]*D[PIDX(6,9)] + F[3][7]*D[PIDX(7,9)] + F[3][8]*D[PIDX(8,9)] + F[3][9]*D[PIDX(9,9)] + F[3][13]*D[PIDX(9,13)] + F[3][14]*D[PIDX(9,14)] + F[3][15]*D[PIDX(9,15)]) + F[7][10]*(F[3][6]*D[PIDX(6,10)] + F[3][7]*D[PIDX(7,10)] + F[3][8]*D[PIDX(8,10)] + F[3][9]*D[PIDX(9,10)] + F[3][13]*D[PIDX(10,13)] + F[3][14]*D[PIDX(10,14)] + F[3][15]*D[PIDX(10,15)]) + F[7][11]*(F[3][6]*D[PIDX(6,11)] + F[3][7]*D[PIDX(7,11)] + F[3][8]*D[PIDX(8,11)] + F[3][9]*D[PIDX(9,11)] + F[3][13]*D[PIDX(11,13)] + F[3][14]*D[PIDX(11,14)] + F[3][15]*D[PIDX(11,15)]) + F[7][12]*(F[3][6]*D[PIDX(6,12)] + F[3][7]*D[PIDX(7,12)] + F[3][8]*D[PIDX(8,12)] + F[3][9]*D[PIDX(9,12)] + F[3][13]*D[PIDX(12,13)] + F[3][14]*D[PIDX(12,14)] + F[3][15]*D[PIDX(12,15)]))*Tsq + (F[3][6]*D[PIDX(6,7)] + F[7][6]*D[PIDX(3,6)] + F[3][7]*D[PIDX(7,7)] + F[3][8]*D[PIDX(7,8)] + F[7][8]*D[PIDX(3,8)] + F[3][9]*D[PIDX(7,9)] + F[7][9]*D[PIDX(3,9)] + F[7][10]*D[PIDX(3,10)] + F[7][11]*D[PIDX(3,11)] + F[7][12]*D[PIDX(3,12)] + F[3][13]*D[PIDX(7,13)] + F[3][14]*D[PIDX(7,14)] + F[3][15]*D[PIDX(7,15)])*T + D[PIDX(3,7)];
+	P[PIDX(3,8)] = (F[8][6]*(F[3][6]*D[PIDX(6,6)] + F[3][7]*D[PIDX(6,7)] + F[3][8]*D[PIDX(6,8)] + F[3][9]*D[PIDX(6,9)] + F[3][13]*D[PIDX(6,13)] + F[3][14]*D[PIDX(6,14)] + F[3][15]*D[PIDX(6,15)]) + F[8][7]*(F[3][6]*D[PIDX(6,7)] + F[3][7]*D[PIDX(7,7)] + F[3][8]*D[PIDX(7,8)] + F[3][9]*D[PIDX(7,9)] + F[3][13]*D[PIDX(7,13)] + F[3][14]*D[PIDX(7,14)] + F[3][15]*D[PIDX(7,15)]) + F[8][9]*(F[3][6]*D[PIDX(6,9)] + F[3][7]*D[PIDX(7,9)] + F[3][8]*D[PIDX(8,9)] + F[3][9]*D[PIDX(9,9)] + F[3][13]*D[PIDX(9,13)] + F[3][14]*D[PIDX(9,14)] + F[3][15]*D[PIDX(9,15)]) + F[8][10]*(F[3][6]*D[PIDX(6,10)] + F[3][7]*D[PIDX(7,10)] + F[3][8]*D[PIDX(8,10)] + F[3][9]*D[PIDX(9,10)] + F[3][13]*D[PIDX(10,13)] + F[3][14]*D[PIDX(10,14)] + F[3][15]*D[PIDX(10,15)]) + F[8][11]*(F[3][6]*D[PIDX(6,11)] + F[3][7]*D[PIDX(7,11)] + F[3][8]*D[PIDX(8,11)] + F[3][9]*D[PIDX(9,11)] + F[3][13]*D[PIDX(11,13)] + F[3][14]*D[PIDX(11,14)] + F[3][15]*D[PIDX(11,15)]) + F[8][12]*(F[3][6]*D[PIDX(6,12)] + F[3][7]*D[PIDX(7,12)] + F[3][8]*D[PIDX(8,12)] + F[3][9]*D[PIDX(9,12)] + F[3][13]*D[PIDX(12,13)] + F[3][14]*D[PIDX(12,14)] + F[3][15]*D[PIDX(12,15)]))*Tsq + (F[3][6]*D[PIDX(6,8)] + F[3][7]*D[PIDX(7,8)] + F[8][6]*D[PIDX(3,6)] + F[8][7]*D[PIDX(3,7)] + F[3][8]*D[PIDX(8,8)] + F[3][9]*D[PIDX(8,9)] + F[8][9]*D[PIDX(3,9)] + F[8][10]*D[PIDX(3,10)] + F[8][11]*D[PIDX(3,11)] + F[8][12]*D[PIDX(3,12)] + F[3][13]*D[PIDX(8,13)] + F[3][14]*D[PIDX(8,14)] + F[3][15]*D[PIDX(8,15)])*T + D[PIDX(3,8)];
+	P[PIDX(3,9)] = (F[9][6]*(F[3][6]*D[PIDX(6,6)] + F[3][7]*D[PIDX(6,7)] + F[3][8]*D[PIDX(6,8)] + F[3][9]*D[PIDX(6,9)] + F[3][13]*D[PIDX(6,13)] + F[3][14]*D[PIDX(6,14)] + F[3][15]*D[PIDX(6,15)]) + F[9][7]*(F[3][6]*D[PIDX(6,7)] + F[3][7]*D[PIDX(7,7)] + F[3][8]*D[PIDX(7,8)] + F[3][9]*D[PIDX(7,9)] + F[3][13]*D[PIDX(7,13)] + F[3][14]*D[PIDX(7,14)] + F[3][15]*D[PIDX(7,15)]) + F[9][8]*(F[3][6]*D[PIDX(6,8)] + F[3][7]*D[PIDX(7,8)] + F[3][8]*D[PIDX(8,8)] + F[3][9]*D[PIDX(8,9)] + F[3][13]*D[PIDX(8,13)] + F[3][14]*D[PIDX(8,14)] + F[3][15]*D[PIDX(8,15)]) + F[9][10]*(F[3][6]*D[PIDX(6,10)] + F[3][7]*D[PIDX(7,10)] + F[3][8]*D[PIDX(8,10)] + F[3][9]*D[PIDX(9,10)] + F[3][13]*D[PIDX(10,13)] + F[3][14]*D[PIDX(10,14)] + F[3][15]*D[PIDX(10,15)]) + F[9][11]*(F[3][6]*D[PIDX(6,11)] + F[3][7]*D[PIDX(7,11)] + F[3][8]*D[PIDX(8,11)] + F[3][9]*D[PIDX(9,11)] + F[3][13]*D[PIDX(11,13)] + F[3][14]*D[PIDX(11,14)] + F[3][15]*D[PIDX(11,15)]) + F[9][12]*(F[3][6]*D[PIDX(6,12)] + F[3][7]*D[PIDX(7,12)] + F[3][8]*D[PIDX(8,12)] + F[3][9]*D[PIDX(9,12)] + F[3][13]*D[PIDX(12,13)] + F[3][14]*D[PIDX(12,14)] + F[3][15]*D[PIDX(12,15)]))*Tsq + (F[9][6]*D[PIDX(3,6)] + F[9][7]*D[PIDX(3,7)] + F[9][8]*D[PIDX(3,8)] + F[3][6]*D[PIDX(6,9)] + F[3][7]*D[PIDX(7,9)] + F[3][8]*D[PIDX(8,9)] + F[3][9]*D[PIDX(9,9)] + F[9][10]*D[PIDX(3,10)] + F[9][11]*D[PIDX(3,11)] + F[9][12]*D[PIDX(3,12)] + F[3][13]*D[PIDX(9,13)] + F[3][14]*D[PIDX(9,14)] + F[3][15]*D[PIDX(9,15)])*T + D[PIDX(3,9)];
+	P[PIDX(3,10)] = (F[3][6]*D[PIDX(6,10)] + F[3][7]*D[PIDX(7,10)] + F[3][8]*D[PIDX(8,10)] + F[3][9]*D[PIDX(9,10)] + F[3][13]*D[PIDX(10,13)] + F[3][14]*D[PIDX(10,14)] + F[3][15]*D[PIDX(10,15)])*T + D[PIDX(3,10)];
+	P[PIDX(3,11)] = (F[3][6]*D[PIDX(6,11)] + F[3][7]*D[PIDX(7,11)] + F[3][8]*D[PIDX(8,11)] + F[3][9]*D[PIDX(9,11)] + F[3][13]*D[PIDX(11,13)] + F[3][14]*D[PIDX(11,14)] + F[3][15]*D[PIDX(11,15)])*T + D[PIDX(3,11)];
+	P[PIDX(3,12)] = (F[3][6]*D[PIDX(6,12)] + F[3][7]*D[PIDX(7,12)] + F[3][8]*D[PIDX(8,12)] + F[3][9]*D[PIDX(9,12)] + F[3][13]*D[PIDX(12,13)] + F[3][14]*D[PIDX(12,14)] + F[3][15]*D[PIDX(12,15)])*T + D[PIDX(3,12)];
+	P[PIDX(3,13)] = (F[3][6]*D[PIDX(6,13)] + F[3][7]*D[PIDX(7,13)] + F[3][8]*D[PIDX(8,13)] + F[3][9]*D[PIDX(9,13)] + F[3][13]*D[PIDX(13,13)] + F[3][14]*D[PIDX(13,14)] + F[3][15]*D[PIDX(13,15)])*T + D[PIDX(3,13)];
+	P[PIDX(3,14)] = (F[3][6]*D[PIDX(6,14)] + F[3][7]*D[PIDX(7,14)] + F[3][8]*D[PIDX(8,14)] + F[3][9]*D[PIDX(9,14)] + F[3][13]*D[PIDX(13,14)] + F[3][14]*D[PIDX(14,14)] + F[3][15]*D[PIDX(14,15)])*T + D[PIDX(3,14)];
+	P[PIDX(3,15)] = (F[3][6]*D[PIDX(6,15)] + F[3][7]*D[PIDX(7,15)] + F[3][8]*D[PIDX(8,15)] + F[3][9]*D[PIDX(9,15)] + F[3][13]*D[PIDX(13,15)] + F[3][14]*D[PIDX(14,15)] + F[3][15]*D[PIDX(15,15)])*T + D[PIDX(3,15)];
+	P[PIDX(4,4)] = (Q[3]*G[4][3]*G[4][3] + Q[4]*G[4][4]*G[4][4] + Q[5]*G[4][5]*G[4][5] + F[4][6]*(F[4][6]*D[PIDX(6,6)] + F[4][7]*D[PIDX(6,7)] + F[4][8]*D[PIDX(6,8)] + F[4][9]*D[PIDX(6,9)] + F[4][13]*D[PIDX(6,13)] + F[4][14]*D[PIDX(6,14)] + F[4][15]*D[PIDX(6,15)]) + F[4][7]*(F[4][6]*D[PIDX(6,7)] + F[4][7]*D[PIDX(7,7)] + F[4][8]*D[PIDX(7,8)] + F[4][9]*D[PIDX(7,9)] + F[4][13]*D[PIDX(7,13)] + F[4][14]*D[PIDX(7,14)] + F[4][15]*D[PIDX(7,15)]) + F[4][8]*(F[4][6]*D[PIDX(6,8)] + F[4][7]*D[PIDX(7,8)] + F[4][8]*D[PIDX(8,8)] + F[4][9]*D[PIDX(8,9)] + F[4][13]*D[PIDX(8,13)] + F[4][14]*D[PIDX(8,14)] + F[4][15]*D[PIDX(8,15)]) + F[4][9]*(F[4][6]*D[PIDX(6,9)] + F[4][7]*D[PIDX(7,9)] + F[4][8]*D[PIDX(8,9)] + F[4][9]*D[PIDX(9,9)] + F[4][13]*D[PIDX(9,13)] + F[4][14]*D[PIDX(9,14)] + F[4][15]*D[PIDX(9,15)]) + F[4][13]*(F[4][6]*D[PIDX(6,13)] + F[4][7]*D[PIDX(7,13)] + F[4][8]*D[PIDX(8,13)] + F[4][9]*D[PIDX(9,13)] + F[4][13]*D[PIDX(13,13)] + F[4][14]*D[PIDX(13,14)] + F[4][15]*D[PIDX(13,15)]) + F[4][14]*(F[4][6]*D[PIDX(6,14)] + F[4][7]*D[PIDX(7,14)] + F[4][8]*D[PIDX(8,14)] + F[4][9]*D[PIDX(9,14)] + F[4][13]*D[PIDX(13,14)] + F[4][14]*D[PIDX(14,14)] + F[4][15]*D[PIDX(14,15)]) + F[4][15]*(F[4][6]*D[PIDX(6,15)] + F[4][7]*D[PIDX(7,15)] + F[4][8]*D[PIDX(8,15)] + F[4][9]*D[PIDX(9,15)] + F[4][13]*D[PIDX(13,15)] + F[4][14]*D[PIDX(14,15)] + F[4][15]*D[PIDX(15,15)]))*Tsq + (2*F[4][6]*D[PIDX(4,6)] + 2*F[4][7]*D[PIDX(4,7)] + 2*F[4][8]*D[PIDX(4,8)] + 2*F[4][9]*D[PIDX(4,9)] + 2*F[4][13]*D[PIDX(4,13)] + 2*F[4][14]*D[PIDX(4,14)] + 2*F[4][15]*D[PIDX(4,15)])*T + D[PIDX(4,4)];
+	P[PIDX(4,5)] = (F[5][6]*(F[4][6]*D[PIDX(6,6)] + F[4][7]*D[PIDX(6,7)] + F[4][8]*D[PIDX(6,8)] + F[4][9]*D[PIDX(6,9)] + F[4][13]*D[PIDX(6,13)] + F[4][14]*D[PIDX(6,14)] + F[4][15]*D[PIDX(6,15)]) + F[5][7]*(F[4][6]*D[PIDX(6,7)] + F[4][7]*D[PIDX(7,7)] + F[4][8]*D[PIDX(7,8)] + F[4][9]*D[PIDX(7,9)] + F[4][13]*D[PIDX(7,13)] + F[4][14]*D[PIDX(7,14)] + F[4][15]*D[PIDX(7,15)]) + F[5][8]*(F[4][6]*D[PIDX(6,8)] + F[4][7]*D[PIDX(7,8)] + F[4][8]*D[PIDX(8,8)] + F[4][9]*D[PIDX(8,9)] + F[4][13]*D[PIDX(8,13)] + F[4][14]*D[PIDX(8,14)] + F[4][15]*D[PIDX(8,15)]) + F[5][9]*(F[4][6]*D[PIDX(6,9)] + F[4][7]*D[PIDX(7,9)] + F[4][8]*D[PIDX(8,9)] + F[4][9]*D[PIDX(9,9)] + F[4][13]*D[PIDX(9,13)] + F[4][14]*D[PIDX(9,14)] + F[4][15]*D[PIDX(9,15)]) + F[5][13]*(F[4][6]*D[PIDX(6,13)] + F[4][7]*D[PIDX(7,13)] + F[4][8]*D[PIDX(8,13)] + F[4][9]*D[PIDX(9,13)] + F[4][13]*D[PIDX(13,13)] + F[4][14]*D[PIDX(13,14)] + F[4][15]*D[PIDX(13,15)]) + F[5][14]*(F[4][6]*D[PIDX(6,14)] + F[4][7]*D[PIDX(7,14)] + F[4][8]*D[PIDX(8,14)] + F[4][9]*D[PIDX(9,14)] + F[4][13]*D[PIDX(13,14)] + F[4][14]*D[PIDX(14,14)] + F[4][15]*D[PIDX(14,15)]) + F[5][15]*(F[4][6]*D[PIDX(6,15)] + F[4][7]*D[PIDX(7,15)] + F[4][8]*D[PIDX(8,15)] + F[4][9]*D[PIDX(9,15)] + F[4][13]*D[PIDX(13,15)] + F[4][14]*D[PIDX(14,15)] + F[4][15]*D[PIDX(15,15)]) + G[4][3]*G[5][3]*Q[3] + G[4][4]*G[5][4]*Q[4] + G[4][5]*G[5][5]*Q[5])*Tsq + (F[4][6]*D[PIDX(5,6)] + F[5][6]*D[PIDX(4,6)] + F[4][7]*D[PIDX(5,7)] + F[5][7]*D[PIDX(4,7)] + F[4][8]*D[PIDX(5,8)] + F[5][8]*D[PIDX(4,8)] + F[4][9]*D[PIDX(5,9)] + F[5][9]*D[PIDX(4,9)] + F[4][13]*D[PIDX(5,13)] + F[5][13]*D[PIDX(4,13)] + F[4][14]*D[PIDX(5,14)] + F[5][14]*D[PIDX(4,14)] + F[4][15]*D[PIDX(5,15)] + F[5][15]*D[PIDX(4,15)])*T + D[PIDX(4,5)];
+	P[PIDX(4,6)] = (F[6][7]*(F[4][6]*D[PIDX(6,7)] + F[4][7]*D[PIDX(7,7)] + F[4][8]*D[PIDX(7,8)] + F[4][9]*D[PIDX(7,9)] + F[4][13]*D[PIDX(7,13)] + F[4][14]*D[PIDX(7,14)] + F[4][15]*D[PIDX(7,15)]) + F[6][8]*(F[4][6]*D[PIDX(6,8)] + F[4][7]*D[PIDX(7,8)] + F[4][8]*D[PIDX(8,8)] + F[4][9]*D[PIDX(8,9)] + F[4][13]*D[PIDX(8,13)] + F[4][14]*D[PIDX(8,14)] + F[4][15]*D[PIDX(8,15)]) + F[6][9]*(F[4][6]*D[PIDX(6,9)] + F[4][7]*D[PIDX(7,9)] + F[4][8]*D[PIDX(8,9)] + F[4][9]*D[PIDX(9,9)] + F[4][13]*D[PIDX(9,13)] + F[4][14]*D[PIDX(9,14)] + F[4][15]*D[PIDX(9,15)]) + F[6][10]*(F[4][6]*D[PIDX(6,10)] + F[4][7]*D[PIDX(7,10)] + F[4][8]*D[PIDX(8,10)] + F[4][9]*D[PIDX(9,10)] + F[4][13]*D[PIDX(10,13)] + F[4][14]*D[PIDX(10,14)] + F[4][15]*D[PIDX(10,15)]) + F[6][11]*(F[4][6]*D[PIDX(6,11)] + F[4][7]*D[PIDX(7,11)] + F[4][8]*D[PIDX(8,11)] + F[4][9]*D[PIDX(9,11)] + F[4][13]*D[PIDX(11,13)] + F[4][14]*D[PIDX(11,14)] + F[4][15]*D[PIDX(11,15)]) + F[6][12]*(F[4][6]*D[PIDX(6,12)] + F[4][7]*D[PIDX(7,12)] + F[4][8]*D[PIDX(8,12)] + F[4][9]*D[PIDX(9,12)] + F[4][13]*D[PIDX(12,13)] + F[4][14]*D[PIDX(12,14)] + F[4][15]*D[PIDX(12,15)]))*Tsq + (F[4][6]*D[PIDX(6,6)] + F[4][7]*D[PIDX(6,7)] + F[6][7]*D[PIDX(4,7)] + F[4][8]*D[PIDX(6,8)] + F[6][8]*D[PIDX(4,8)] + F[4][9]*D[PIDX(6,9)] + F[6][9]*D[PIDX(4,9)] + F[6][10]*D[PIDX(4,10)] + F[6][11]*D[PIDX(4,11)] + F[6][12]*D[PIDX(4,12)] + F[4][13]*D[PIDX(6,13)] + F[4][14]*D[PIDX(6,14)] + F[4][15]*D[PIDX(6,15)])*T + D[PIDX(4,6)];
+	P[PIDX(4,7)] = (F[7][6]*(F[4][6]*D[PIDX(6,6)] + F[4][7]*D[PIDX(6,7)] + F[4][8]*D[PIDX(6,8)] + F[4][9]*D[PIDX(6,9)] + F[4][13]*D[PIDX(6,13)] + F[4][14]*D[PIDX(6,14)] + F[4][15]*D[PIDX(6,15)]) + F[7][8]*(F[4][6]*D[PIDX(6,8)] + F[4][7]*D[PIDX(7,8)] + F[4][8]*D[PIDX(8,8)] + F[4][9]*D[PIDX(8,9)] + F[4][13]*D[PIDX(8,13)] + F[4][14]*D[PIDX(8,14)] + F[4][15]*D[PIDX(8,15)]) + F[7][9]*(F[4][6]*D[PIDX(6,9)] + F[4][7]*D[PIDX(7,9)] + F[4][8]*D[PIDX(8,9)] + F[4][9]*D[PIDX(9,9)] + F[4][13]*D[PIDX(9,13)] + F[4][14]*D[PIDX(9,14)] + F[4][15]*D[PIDX(9,15)]) + F[7][10]*(F[4][6]*D[PIDX(6,10)] + F[4][7]*D[PIDX(7,10)] + F[4][8]*D[PIDX(8,10)] + F[4][9]*D[PIDX(9,10)] + F[4][13]*D[PIDX(10,13)] + F[4][14]*D[PIDX(10,14)] + F[4][15]*D[PIDX(10,15)]) + F[7][11]*(F[4][6]*D[PIDX(6,11)] + F[4][7]*D[PIDX(7,11)] + F[4][8]*D[PIDX(8,11)] + F[4][9]*D[PIDX(9,11)] + F[4][13]*D[PIDX(11,13)] + F[4][14]*D[PIDX(11,14)] + F[4][15]*D[PIDX(11,15)]) + F[7][12]*(F[4][6]*D[PIDX(6,12)] + F[4][7]*D[PIDX(7,12)] + F[4][8]*D[PIDX(8,12)] + F[4][9]*D[PIDX(9,12)] + F[4][13]*D[PIDX(12,13)] + F[4][14]*D[PIDX(12,14)] + F[4][15]*D[PIDX(12,15)]))*Tsq + (F[4][6]*D[PIDX(6,7)] + F[7][6]*D[PIDX(4,6)] + F[4][7]*D[PIDX(7,7)] + F[4][8]*D[PIDX(7,8)] + F[7][8]*D[PIDX(4,8)] + F[4][9]*D[PIDX(7,9)] + F[7][9]*D[PIDX(4,9)] + F[7][10]*D[PIDX(4,10)] + F[7][11]*D[PIDX(4,11)] + F[7][12]*D[PIDX(4,12)] + F[4][13]*D[PIDX(7,13)] + F[4][14]*D[PIDX(7,14)] + F[4][15]*D[PIDX(7,15)])*T + D[PIDX(4,7)];
+	P[PIDX(4,8)] = (F[8][6]*(F[4][6]*D[PIDX(6,6)] + F[4][7]*D[PIDX(6,7)] + F[4][8]*D[PIDX(6,8)] + F[4][9]*D[PIDX(6,9)] + F[4][13]*D[PIDX(6,13)] + F[4][14]*D[PIDX(6,14)] + F[4][15]*D[PIDX(6,15)]) + F[8][7]*(F[4][6]*D[PIDX(6,7)] + F[4][7]*D[PIDX(7,7)] + F[4][8]*D[PIDX(7,8)] + F[4][9]*D[PIDX(7,9)] + F[4][13]*D[PIDX(7,13)] + F[4][14]*D[PIDX(7,14)] + F[4][15]*D[PIDX(7,15)]) + F[8][9]*(F[4][6]*D[PIDX(6,9)] + F[4][7]*D[PIDX(7,9)] + F[4][8]*D[PIDX(8,9)] + F[4][9]*D[PIDX(9,9)] + F[4][13]*D[PIDX(9,13)] + F[4][14]*D[PIDX(9,14)] + F[4][15]*D[PIDX(9,15)]) + F[8][10]*(F[4][6]*D[PIDX(6,10)] + F[4][7]*D[PIDX(7,10)] + F[4][8]*D[PIDX(8,10)] + F[4][9]*D[PIDX(9,10)] + F[4][13]*D[PIDX(10,13)] + F[4][14]*D[PIDX(10,14)] + F[4][15]*D[PIDX(10,15)]) + F[8][11]*(F[4][6]*D[PIDX(6,11)] + F[4][7]*D[PIDX(7,11)] + F[4][8]*D[PIDX(8,11)] + F[4][9]*D[PIDX(9,11)] + F[4][13]*D[PIDX(11,13)] + F[4][14]*D[PIDX(11,14)] + F[4][15]*D[PIDX(11,15)]) + F[8][12]*(F[4][6]*D[PIDX(6,12)] + F[4][7]*D[PIDX(7,12)] + F[4][8]*D[PIDX(8,12)] + F[4][9]*D[PIDX(9,12)] + F[4][13]*D[PIDX(12,13)] + F[4][14]*D[PIDX(12,14)] + F[4][15]*D[PIDX(12,15)]))*Tsq + (F[4][6]*D[PIDX(6,8)] + F[4][7]*D[PIDX(7,8)] + F[8][6]*D[PIDX(4,6)] + F[8][7]*D[PIDX(4,7)] + F[4][8]*D[PIDX(8,8)] + F[4][9]*D[PIDX(8,9)] + F[8][9]*D[PIDX(4,9)] + F[8][10]*D[PIDX(4,10)] + F[8][11]*D[PIDX(4,11)] + F[8][12]*D[PIDX(4,12)] + F[4][13]*D[PIDX(8,13)] + F[4][14]*D[PIDX(8,14)] + F[4][15]*D[PIDX(8,15)])*T + D[PIDX(4,8)];
+	P[PIDX(4,9)] = (F[9][6]*(F[4][6]*D[PIDX(6,6)] + F[4][7]*D[PIDX(6,7)] + F[4][8]*D[PIDX(6,8)] + F[4][9]*D[PIDX(6,9)] + F[4][13]*D[PIDX(6,13)] + F[4][14]*D[PIDX(6,14)] + F[4][15]*D[PIDX(6,15)]) + F[9][7]*(F[4][6]*D[PIDX(6,7)] + F[4][7]*D[PIDX(7,7)] + F[4][8]*D[PIDX(7,8)] + F[4][9]*D[PIDX(7,9)] + F[4][13]*D[PIDX(7,13)] + F[4][14]*D[PIDX(7,14)] + F[4][15]*D[PIDX(7,15)]) + F[9][8]*(F[4][6]*D[PIDX(6,8)] + F[4][7]*D[PIDX(7,8)] + F[4][8]*D[PIDX(8,8)] + F[4][9]*D[PIDX(8,9)] + F[4][13]*D[PIDX(8,13)] + F[4][14]*D[PIDX(8,14)] + F[4][15]*D[PIDX(8,15)]) + F[9][10]*(F[4][6]*D[PIDX(6,10)] + F[4][7]*D[PIDX(7,10)] + F[4][8]*D[PIDX(8,10)] + F[4][9]*D[PIDX(9,10)] + F[4][13]*D[PIDX(10,13)] + F[4][14]*D[PIDX(10,14)] + F[4][15]*D[PIDX(10,15)]) + F[9][11]*(F[4][6]*D[PIDX(6,11)] + F[4][7]*D[PIDX(7,11)] + F[4][8]*D[PIDX(8,11)] + F[4][9]*D[PIDX(9,11)] + F[4][13]*D[PIDX(11,13)] + F[4][14]*D[PIDX(11,14)] + F[4][15]*D[PIDX(11,15)]) + F[9][12]*(F[4][6]*D[PIDX(6,12)] + F[4][7]*D[PIDX(7,12)] + F[4][8]*D[PIDX(8,12)] + F[4][9]*D[PIDX(9,12)] + F[4][13]*D[PIDX(12,13)] + F[4][14]*D[PIDX(12,14)] + F[4][15]*D[PIDX(12,15)]))*Tsq + (F[9][6]*D[PIDX(4,6)] + F[9][7]*D[PIDX(4,7)] + F[9][8]*D[PIDX(4,8)] + F[4][6]*D[PIDX(6,9)] + F[4][7]*D[PIDX(7,9)] + F[4][8]*D[PIDX(8,9)] + F[4][9]*D[PIDX(9,9)] + F[9][10]*D[PIDX(4,10)] + F[9][11]*D[PIDX(4,11)] + F[9][12]*D[PIDX(4,12)] + F[4][13]*D[PIDX(9,13)] + F[4][14]*D[PIDX(9,14)] + F[4][15]*D[PIDX(9,15)])*T + D[PIDX(4,9)];
+	P[PIDX(4,10)] = (F[4][6]*D[PIDX(6,10)] + F[4][7]*D[PIDX(7,10)] + F[4][8]*D[PIDX(8,10)] + F[4][9]*D[PIDX(9,10)] + F[4][13]*D[PIDX(10,13)] + F[4][14]*D[PIDX(10,14)] + F[4][15]*D[PIDX(10,15)])*T + D[PIDX(4,10)];
+	P[PIDX(4,11)] = (F[4][6]*D[PIDX(6,11)] + F[4][7]*D[PIDX(7,11)] + F[4][8]*D[PIDX(8,11)] + F[4][9]*D[PIDX(9,11)] + F[4][13]*D[PIDX(11,13)] + F[4][14]*D[PIDX(11,14)] + F[4][15]*D[PIDX(11,15)])*T + D[PIDX(4,11)];
+	P[PIDX(4,12)] = (F[4][6]*D[PIDX(6,12)] + F[4][7]*D[PIDX(7,12)] + F[4][8]*D[PIDX(8,12)] + F[4][9]*D[PIDX(9,12)] + F[4][13]*D[PIDX(12,13)] + F[4][14]*D[PIDX(12,14)] + F[4][15]*D[PIDX(12,15)])*T + D[PIDX(4,12)];
+	P[PIDX(4,13)] = (F[4][6]*D[PIDX(6,13)] + F[4][7]*D[PIDX(7,13)] + F[4][8]*D[PIDX(8,13)] + F[4][9]*D[PIDX(9,13)] + F[4][13]*D[PIDX(13,13)] + F[4][14]*D[PIDX(13,14)] + F[4][15]*D[PIDX(13,15)])*T + D[PIDX(4,13)];
+	P[PIDX(4,14)] = (F[4][6]*D[PIDX(6,14)] + F[4][7]*D[PIDX(7,14)] + F[4][8]*D[PIDX(8,14)] + F[4][9]*D[PIDX(9,14)] + F[4][13]*D[PIDX(13,14)] + F[4][14]*D[PIDX(14,14)] + F[4][15]*D[PIDX(14,15)])*T + D[PIDX(4,14)];
+	P[PIDX(4,15)] = (F[4][6]*D[PIDX(6,15)] + F[4][7]*D[PIDX(7,15)] + F[4][8]*D[PIDX(8,15)] + F[4][9]*D[PIDX(9,15)] + F[4][13]*D[PIDX(13,15)] + F[4][14]*D[PIDX(14,15)] + F[4][15]*D[PIDX(15,15)])*T + D[PIDX(4,15)];
+	P[PIDX(5,5)] = (Q[3]*G[5][3]*G[5][3] + Q[4]*G[5][4]*G[5][4] + Q[5]*G[5][5]*G[5][5] + F[5][6]*(F[5][6]*D[PIDX(6,6)] + F[5][7]*D[PIDX(6,7)] + F[5][8]*D[PIDX(6,8)] + F[5][9]*D[PIDX(6,9)] + F[5][13]*D[PIDX(6,13)] + F[5][14]*D[PIDX(6,14)] + F[5][15]*D[PIDX(6,15)]) + F[5][7]*(F[5][6]*D[PIDX(6,7)] + F[5][7]*D[PIDX(7,7)] + F[5][8]*D[PIDX(7,8)] + F[5][9]*D[PIDX(7,9)] + F[5][13]*D[PIDX(7,13)] + F[5][14]*D[PIDX(7,14)] + F[5][15]*D[PIDX(7,15)]) + F[5][8]*(F[5][6]*D[PIDX(6,8)] + F[5][7]*D[PIDX(7,8)] + F[5][8]*D[PIDX(8,8)] + F[5][9]*D[PIDX(8,9)] + F[5][13]*D[PIDX(8,13)] + F[5][14]*D[PIDX(8,14)] + F[5][15]*D[PIDX(8,15)]) + F[5][9]*(F[5][6]*D[PIDX(6,9)] + F[5][7]*D[PIDX(7,9)] + F[5][8]*D[PIDX(8,9)] + F[5][9]*D[PIDX(9,9)] + F[5][13]*D[PIDX(9,13)] + F[5][14]*D[PIDX(9,14)] + F[5][15]*D[PIDX(9,15)]) + F[5][13]*(F[5][6]*D[PIDX(6,13)] + F[5][7]*D[PIDX(7,13)] + F[5][8]*D[PIDX(8,13)] + F[5][9]*D[PIDX(9,13)] + F[5][13]*D[PIDX(13,13)] + F[5][14]*D[PIDX(13,14)] + F[5][15]*D[PIDX(13,15)]) + F[5][14]*(F[5][6]*D[PIDX(6,14)] + F[5][7]*D[PIDX(7,14)] + F[5][8]*D[PIDX(8,14)] + F[5][9]*D[PIDX(9,14)] + F[5][13]*D[PIDX(13,14)] + F[5][14]*D[PIDX(14,14)] + F[5][15]*D[PIDX(14,15)]) + F[5][15]*(F[5][6]*D[PIDX(6,15)] + F[5][7]*D[PIDX(7,15)] + F[5][8]*D[PIDX(8,15)] + F[5][9]*D[PIDX(9,15)] + F[5][13]*D[PIDX(13,15)] + F[5][14]*D[PIDX(14,15)] + F[5][15]*D[PIDX(15,15)]))*Tsq + (2*F[5][6]*D[PIDX(5,6)] + 2*F[5][7]*D[PIDX(5,7)] + 2*F[5][8]*D[PIDX(5,8)] + 2*F[5][9]*D[PIDX(5,9)] + 2*F[5][13]*D[PIDX(5,13)] + 2*F[5][14]*D[PIDX(5,14)] + 2*F[5][15]*D[PIDX(5,15)])*T + D[PIDX(5,5)];
+	P[PIDX(5,6)] = (F[6][7]*(F[5][6]*D[PIDX(6,7)] + F[5][7]*D[PIDX(7,7)] + F[5][8]*D[PIDX(7,8)] + F[5][9]*D[PIDX(7,9)] + F[5][13]*D[PIDX(7,13)] + F[5][14]*D[PIDX(7,14)] + F[5][15]*D[PIDX(7,15)]) + F[6][8]*(F[5][6]*D[PIDX(6,8)] + F[5][7]*D[PIDX(7,8)] + F[5][8]*D[PIDX(8,8)] + F[5][9]*D[PIDX(8,9)] + F[5][13]*D[PIDX(8,13)] + F[5][14]*D[PIDX(8,14)] + F[5][15]*D[PIDX(8,15)]) + F[6][9]*(F[5][6]*D[PIDX(6,9)] + F[5][7]*D[PIDX(7,9)] + F[5][8]*D[PIDX(8,9)] + F[5][9]*D[PIDX(9,9)] + F[5][13]*D[PIDX(9,13)] + F[5][14]*D[PIDX(9,14)] + F[5][15]*D[PIDX(9,15)]) + F[6][10]*(F[5][6]*D[PIDX(6,10)] + F[5][7]*D[PIDX(7,10)] + F[5][8]*D[PIDX(8,10)] + F[5][9]*D[PIDX(9,10)] + F[5][13]*D[PIDX(10,13)] + F[5][14]*D[PIDX(10,14)] + F[5][15]*D[PIDX(10,15)]) + F[6][11]*(F[5][6]*D[PIDX(6,11)] + F[5][7]*D[PIDX(7,11)] + F[5][8]*D[PIDX(8,11)] + F[5][9]*D[PIDX(9,11)] + F[5][13]*D[PIDX(11,13)] + F[5][14]*D[PIDX(11,14)] + F[5][15]*D[PIDX(11,15)]) + F[6][12]*(F[5][6]*D[PIDX(6,12)] + F[5][7]*D[PIDX(7,12)] + F[5][8]*D[PIDX(8,12)] + F[5][9]*D[PIDX(9,12)] + F[5][13]*D[PIDX(12,13)] + F[5][14]*D[PIDX(12,14)] + F[5][15]*D[PIDX(12,15)]))*Tsq + (F[5][6]*D[PIDX(6,6)] + F[5][7]*D[PIDX(6,7)] + F[6][7]*D[PIDX(5,7)] + F[5][8]*D[PIDX(6,8)] + F[6][8]*D[PIDX(5,8)] + F[5][9]*D[PIDX(6,9)] + F[6][9]*D[PIDX(5,9)] + F[6][10]*D[PIDX(5,10)] + F[6][11]*D[PIDX(5,11)] + F[6][12]*D[PIDX(5,12)] + F[5][13]*D[PIDX(6,13)] + F[5][14]*D[PIDX(6,14)] + F[5][15]*D[PIDX(6,15)])*T + D[PIDX(5,6)];
+	P[PIDX(5,7)] = (F[7][6]*(F[5][6]*D[PIDX(6,6)] + F[5][7]*D[PIDX(6,7)] + F[5][8]*D[PIDX(6,8)] + F[5][9]*D[PIDX(6,9)] + F[5][13]*D[PIDX(6,13)] + F[5][14]*D[PIDX(6,14)] + F[5][15]*D[PIDX(6,15)]) + F[7][8]*(F[5][6]*D[PIDX(6,8)] + F[5][7]*D[PIDX(7,8)] + F[5][8]*D[PIDX(8,8)] + F[5][9]*D[PIDX(8,9)] + F[5][13]*D[PIDX(8,13)] + F[5][14]*D[PIDX(8,14)] + F[5][15]*D[PIDX(8,15)]) + F[7][9]*(F[5][6]*D[PIDX(6,9)] + F[5][7]*D[PIDX(7,9)] + F[5][8]*D[PIDX(8,9)] + F[5][9]*D[PIDX(9,9)] + F[5][13]*D[PIDX(9,13)] + F[5][14]*D[PIDX(9,14)] + F[5][15]*D[PIDX(9,15)]) + F[7][10]*(F[5][6]*D[PIDX(6,10)] + F[5][7]*D[PIDX(7,10)] + F[5][8]*D[PIDX(8,10)] + F[5][9]*D[PIDX(9,10)] + F[5][13]*D[PIDX(10,13)] + F[5][14]*D[PIDX(10,14)] + F[5][15]*D[PIDX(10,15)]) + F[7][11]*(F[5][6]*D[PIDX(6,11)] + F[5][7]*D[PIDX(7,11)] + F[5][8]*D[PIDX(8,11)] + F[5][9]*D[PIDX(9,11)] + F[5][13]*D[PIDX(11,13)] + F[5][14]*D[PIDX(11,14)] + F[5][15]*D[PIDX(11,15)]) + F[7][12]*(F[5][6]*D[PIDX(6,12)] + F[5][7]*D[PIDX(7,12)] + F[5][8]*D[PIDX(8,12)] + F[5][9]*D[PIDX(9,12)] + F[5][13]*D[PIDX(12,13)] + F[5][14]*D[PIDX(12,14)] + F[5][15]*D[PIDX(12,15)]))*Tsq + (F[5][6]*D[PIDX(6,7)] + F[7][6]*D[PIDX(5,6)] + F[5][7]*D[PIDX(7,7)] + F[5][8]*D[PIDX(7,8)] + F[7][8]*D[PIDX(5,8)] + F[5][9]*D[PIDX(7,9)] + F[7][9]*D[PIDX(5,9)] + F[7][10]*D[PIDX(5,10)] + F[7][11]*D[PIDX(5,11)] + F[7][12]*D[PIDX(5,12)] + F[5][13]*D[PIDX(7,13)] + F[5][14]*D[PIDX(7,14)] + F[5][15]*D[PIDX(7,15)])*T + D[PIDX(5,7)];
+	P[PIDX(5,8)] = (F[8][6]*(F[5][6]*D[PIDX(6,6)] + F[5][7]*D[PIDX(6,7)] + F[5][8]*D[PIDX(6,8)] + F[5][9]*D[PIDX(6,9)] + F[5][13]*D[PIDX(6,13)] + F[5][14]*D[PIDX(6,14)] + F[5][15]*D[PIDX(6,15)]) + F[8][7]*(F[5][6]*D[PIDX(6,7)] + F[5][7]*D[PIDX(7,7)] + F[5][8]*D[PIDX(7,8)] + F[5][9]*D[PIDX(7,9)] + F[5][13]*D[PIDX(7,13)] + F[5][14]*D[PIDX(7,14)] + F[5][15]*D[PIDX(7,15)]) + F[8][9]*(F[5][6]*D[PIDX(6,9)] + F[5][7]*D[PIDX(7,9)] + F[5][8]*D[PIDX(8,9)] + F[5][9]*D[PIDX(9,9)] + F[5][13]*D[PIDX(9,13)] + F[5][14]*D[PIDX(9,14)] + F[5][15]*D[PIDX(9,15)]) + F[8][10]*(F[5][6]*D[PIDX(6,10)] + F[5][7]*D[PIDX(7,10)] + F[5][8]*D[PIDX(8,10)] + F[5][9]*D[PIDX(9,10)] + F[5][13]*D[PIDX(10,13)] + F[5][14]*D[PIDX(10,14)] + F[5][15]*D[PIDX(10,15)]) + F[8][11]*(F[5][6]*D[PIDX(6,11)] + F[5][7]*D[PIDX(7,11)] + F[5][8]*D[PIDX(8,11)] + F[5][9]*D[PIDX(9,11)] + F[5][13]*D[PIDX(11,13)] + F[5][14]*D[PIDX(11,14)] + F[5][15]*D[PIDX(11,15)]) + F[8][12]*(F[5][6]*D[PIDX(6,12)] + F[5][7]*D[PIDX(7,12)] + F[5][8]*D[PIDX(8,12)] + F[5][9]*D[PIDX(9,12)] + F[5][13]*D[PIDX(12,13)] + F[5][14]*D[PIDX(12,14)] + F[5][15]*D[PIDX(12,15)]))*Tsq + (F[5][6]*D[PIDX(6,8)] + F[5][7]*D[PIDX(7,8)] + F[8][6]*D[PIDX(5,6)] + F[8][7]*D[PIDX(5,7)] + F[5][8]*D[PIDX(8,8)] + F[5][9]*D[PIDX(8,9)] + F[8][9]*D[PIDX(5,9)] + F[8][10]*D[PIDX(5,10)] + F[8][11]*D[PIDX(5,11)] + F[8][12]*D[PIDX(5,12)] + F[5][13]*D[PIDX(8,13)] + F[5][14]*D[PIDX(8,14)] + F[5][15]*D[PIDX(8,15)])*T + D[PIDX(5,8)];
+	P[PIDX(5,9)] = (F[9][6]*(F[5][6]*D[PIDX(6,6)] + F[5][7]*D[PIDX(6,7)] + F[5][8]*D[PIDX(6,8)] + F[5][9]*D[PIDX(6,9)] + F[5][13]*D[PIDX(6,13)] + F[5][14]*D[PIDX(6,14)] + F[5][15]*D[PIDX(6,15)]) + F[9][7]*(F[5][6]*D[PIDX(6,7)] + F[5][7]*D[PIDX(7,7)] + F[5][8]*D[PIDX(7,8)] + F[5][9]*D[PIDX(7,9)] + F[5][13]*D[PIDX(7,13)] + F[5][14]*D[PIDX(7,14)] + F[5][15]*D[PIDX(7,15)]) + F[9][8]*(F[5][6]*D[PIDX(6,8)] + F[5][7]*D[PIDX(7,8)] + F[5][8]*D[PIDX(8,8)] + F[5][9]*D[PIDX(8,9)] + F[5][13]*D[PIDX(8,13)] + F[5][14]*D[PIDX(8,14)] + F[5][15]*D[PIDX(8,15)]) + F[9][10]*(F[5][6]*D[PIDX(6,10)] + F[5][7]*D[PIDX(7,10)] + F[5][8]*D[PIDX(8,10)] + F[5][9]*D[PIDX(9,10)] + F[5][13]*D[PIDX(10,13)] + F[5][14]*D[PIDX(10,14)] + F[5][15]*D[PIDX(10,15)]) + F[9][11]*(F[5][6]*D[PIDX(6,11)] + F[5][7]*D[PIDX(7,11)] + F[5][8]*D[PIDX(8,11)] + F[5][9]*D[PIDX(9,11)] + F[5][13]*D[PIDX(11,13)] + F[5][14]*D[PIDX(11,14)] + F[5][15]*D[PIDX(11,15)]) + F[9][12]*(F[5][6]*D[PIDX(6,12)] + F[5][7]*D[PIDX(7,12)] + F[5][8]*D[PIDX(8,12)] + F[5][9]*D[PIDX(9,12)] + F[5][13]*D[PIDX(12,13)] + F[5][14]*D[PIDX(12,14)] + F[5][15]*D[PIDX(12,15)]))*Tsq + (F[9][6]*D[PIDX(5,6)] + F[9][7]*D[PIDX(5,7)] + F[9][8]*D[PIDX(5,8)] + F[5][6]*D[PIDX(6,9)] + F[5][7]*D[PIDX(7,9)] + F[5][8]*D[PIDX(8,9)] + F[5][9]*D[PIDX(9,9)] + F[9][10]*D[PIDX(5,10)] + F[9][11]*D[PIDX(5,11)] + F[9][12]*D[PIDX(5,12)] + F[5][13]*D[PIDX(9,13)] + F[5][14]*D[PIDX(9,14)] + F[5][15]*D[PIDX(9,15)])*T + D[PIDX(5,9)];
+	P[PIDX(5,10)] = (F[5][6]*D[PIDX(6,10)] + F[5][7]*D[PIDX(7,10)] + F[5][8]*D[PIDX(8,10)] + F[5][9]*D[PIDX(9,10)] + F[5][13]*D[PIDX(10,13)] + F[5][14]*D[PIDX(10,14)] + F[5][15]*D[PIDX(10,15)])*T + D[PIDX(5,10)];
+	P[PIDX(5,11)] = (F[5][6]*D[PIDX(6,11)] + F[5][7]*D[PIDX(7,11)] + F[5][8]*D[PIDX(8,11)] + F[5][9]*D[PIDX(9,11)] + F[5][13]*D[PIDX(11,13)] + F[5][14]*D[PIDX(11,14)] + F[5][15]*D[PIDX(11,15)])*T + D[PIDX(5,11)];
+	P[PIDX(5,12)] = (F[5][6]*D[PIDX(6,12)] + F[5][7]*D[PIDX(7,12)] + F[5][8]*D[PIDX(8,12)] + F[5][9]*D[PIDX(9,12)] + F[5][13]*D[PIDX(12,13)] + F[5][14]*D[PIDX(12,14)] + F[5][15]*D[PIDX(12,15)])*T + D[PIDX(5,12)];
+	P[PIDX(5,13)] = (F[5][6]*D[PIDX(6,13)] + F[5][7]*D[PIDX(7,13)] + F[5][8]*D[PIDX(8,13)] + F[5][9]*D[PIDX(9,13)] + F[5][13]*D[PIDX(13,13)] + F[5][14]*D[PIDX(13,14)] + F[5][15]*D[PIDX(13,15)])*T + D[PIDX(5,13)];
+	P[PIDX(5,14)] = (F[5][6]*D[PIDX(6,14)] + F[5][7]*D[PIDX(7,14)] + F[5][8]*D[PIDX(8,14)] + F[5][9]*D[PIDX(9,14)] + F[5][13]*D[PIDX(13,14)] + F[5][14]*D[PIDX(14,14)] + F[5][15]*D[PIDX(14,15)])*T + D[PIDX(5,14)];
+	P[PIDX(5,15)] = (F[5][6]*D[PIDX(6,15)] + F[5][7]*D[PIDX(7,15)] + F[5][8]*D[PIDX(8,15)] + F[5][9]*D[PIDX(9,15)] + F[5][13]*D[PIDX(13,15)] + F[5][14]*D[PIDX(14,15)] + F[5][15]*D[PIDX(15,15)])*T + D[PIDX(5,15)];
+	P[PIDX(6,6)] = (Q[0]*G[6][0]*G[6][0] + Q[1]*G[6][1]*G[6][1] + Q[2]*G[6][2]*G[6][2] + F[6][7]*(F[6][7]*D[PIDX(7,7)] + F[6][8]*D[PIDX(7,8)] + F[6][9]*D[PIDX(7,9)] + F[6][10]*D[PIDX(7,10)] + F[6][11]*D[PIDX(7,11)] + F[6][12]*D[PIDX(7,12)]) + F[6][8]*(F[6][7]*D[PIDX(7,8)] + F[6][8]*D[PIDX(8,8)] + F[6][9]*D[PIDX(8,9)] + F[6][10]*D[PIDX(8,10)] + F[6][11]*D[PIDX(8,11)] + F[6][12]*D[PIDX(8,12)]) + F[6][9]*(F[6][7]*D[PIDX(7,9)] + F[6][8]*D[PIDX(8,9)] + F[6][9]*D[PIDX(9,9)] + F[6][10]*D[PIDX(9,10)] + F[6][11]*D[PIDX(9,11)] + F[6][12]*D[PIDX(9,12)]) + F[6][10]*(F[6][7]*D[PIDX(7,10)] + F[6][8]*D[PIDX(8,10)] + F[6][9]*D[PIDX(9,10)] + F[6][10]*D[PIDX(10,10)] + F[6][11]*D[PIDX(10,11)] + F[6][12]*D[PIDX(10,12)]) + F[6][11]*(F[6][7]*D[PIDX(7,11)] + F[6][8]*D[PIDX(8,11)] + F[6][9]*D[PIDX(9,11)] + F[6][10]*D[PIDX(10,11)] + F[6][11]*D[PIDX(11,11)] + F[6][12]*D[PIDX(11,12)]) + F[6][12]*(F[6][7]*D[PIDX(7,12)] + F[6][8]*D[PIDX(8,12)] + F[6][9]*D[PIDX(9,12)] + F[6][10]*D[PIDX(10,12)] + F[6][11]*D[PIDX(11,12)] + F[6][12]*D[PIDX(12,12)]))*Tsq + (2*F[6][7]*D[PIDX(6,7)] + 2*F[6][8]*D[PIDX(6,8)] + 2*F[6][9]*D[PIDX(6,9)] + 2*F[6][10]*D[PIDX(6,10)] + 2*F[6][11]*D[PIDX(6,11)] + 2*F[6][12]*D[PIDX(6,12)])*T + D[PIDX(6,6)];
+	P[PIDX(6,7)] = (F[7][6]*(F[6][7]*D[PIDX(6,7)] + F[6][8]*D[PIDX(6,8)] + F[6][9]*D[PIDX(6,9)] + F[6][10]*D[PIDX(6,10)] + F[6][11]*D[PIDX(6,11)] + F[6][12]*D[PIDX(6,12)]) + F[7][8]*(F[6][7]*D[PIDX(7,8)] + F[6][8]*D[PIDX(8,8)] + F[6][9]*D[PIDX(8,9)] + F[6][10]*D[PIDX(8,10)] + F[6][11]*D[PIDX(8,11)] + F[6][12]*D[PIDX(8,12)]) + F[7][9]*(F[6][7]*D[PIDX(7,9)] + F[6][8]*D[PIDX(8,9)] + F[6][9]*D[PIDX(9,9)] + F[6][10]*D[PIDX(9,10)] + F[6][11]*D[PIDX(9,11)] + F[6][12]*D[PIDX(9,12)]) + F[7][10]*(F[6][7]*D[PIDX(7,10)] + F[6][8]*D[PIDX(8,10)] + F[6][9]*D[PIDX(9,10)] + F[6][10]*D[PIDX(10,10)] + F[6][11]*D[PIDX(10,11)] + F[6][12]*D[PIDX(10,12)]) + F[7][11]*(F[6][7]*D[PIDX(7,11)] + F[6][8]*D[PIDX(8,11)] + F[6][9]*D[PIDX(9,11)] + F[6][10]*D[PIDX(10,11)] + F[6][11]*D[PIDX(11,11)] + F[6][12]*D[PIDX(11,12)]) + F[7][12]*(F[6][7]*D[PIDX(7,12)] + F[6][8]*D[PIDX(8,12)] + F[6][9]*D[PIDX(9,12)] + F[6][10]*D[PIDX(10,12)] + F[6][11]*D[PIDX(11,12)] + F[6][12]*D[PIDX(12,12)]) + G[6][0]*G[7][0]*Q[0] + G[6][1]*G[7][1]*Q[1] + G[6][2]*G[7][2]*Q[2])*Tsq + (F[7][6]*D[PIDX(6,6)] + F[6][7]*D[PIDX(7,7)] + F[6][8]*D[PIDX(7,8)] + F[7][8]*D[PIDX(6,8)] + F[6][9]*D[PIDX(7,9)] + F[7][9]*D[PIDX(6,9)] + F[6][10]*D[PIDX(7,10)] + F[7][10]*D[PIDX(6,10)] + F[6][11]*D[PIDX(7,11)] + F[7][11]*D[PIDX(6,11)] + F[6][12]*D[PIDX(7,12)] + F[7][12]*D[PIDX(6,12)])*T + D[PIDX(6,7)];
+	P[PIDX(6,8)] = (F[8][6]*(F[6][7]*D[PIDX(6,7)] + F[6][8]*D[PIDX(6,8)] + F[6][9]*D[PIDX(6,9)] + F[6][10]*D[PIDX(6,10)] + F[6][11]*D[PIDX(6,11)] + F[6][12]*D[PIDX(6,12)]) + F[8][7]*(F[6][7]*D[PIDX(7,7)] + F[6][8]*D[PIDX(7,8)] + F[6][9]*D[PIDX(7,9)] + F[6][10]*D[PIDX(7,10)] + F[6][11]*D[PIDX(7,11)] + F[6][12]*D[PIDX(7,12)]) + F[8][9]*(F[6][7]*D[PIDX(7,9)] + F[6][8]*D[PIDX(8,9)] + F[6][9]*D[PIDX(9,9)] + F[6][10]*D[PIDX(9,10)] + F[6][11]*D[PIDX(9,11)] + F[6][12]*D[PIDX(9,12)]) + F[8][10]*(F[6][7]*D[PIDX(7,10)] + F[6][8]*D[PIDX(8,10)] + F[6][9]*D[PIDX(9,10)] + F[6][10]*D[PIDX(10,10)] + F[6][11]*D[PIDX(10,11)] + F[6][12]*D[PIDX(10,12)]) + F[8][11]*(F[6][7]*D[PIDX(7,11)] + F[6][8]*D[PIDX(8,11)] + F[6][9]*D[PIDX(9,11)] + F[6][10]*D[PIDX(10,11)] + F[6][11]*D[PIDX(11,11)] + F[6][12]*D[PIDX(11,12)]) + F[8][12]*(F[6][7]*D[PIDX(7,12)] + F[6][8]*D[PIDX(8,12)] + F[6][9]*D[PIDX(9,12)] + F[6][10]*D[PIDX(10,12)] + F[6][11]*D[PIDX(11,12)] + F[6][12]*D[PIDX(12,12)]) + G[6][0]*G[8][0]*Q[0] + G[6][1]*G[8][1]*Q[1] + G[6][2]*G[8][2]*Q[2])*Tsq + (F[6][7]*D[PIDX(7,8)] + F[8][6]*D[PIDX(6,6)] + F[8][7]*D[PIDX(6,7)] + F[6][8]*D[PIDX(8,8)] + F[6][9]*D[PIDX(8,9)] + F[8][9]*D[PIDX(6,9)] + F[6][10]*D[PIDX(8,10)] + F[8][10]*D[PIDX(6,10)] + F[6][11]*D[PIDX(8,11)] + F[8][11]*D[PIDX(6,11)] + F[6][12]*D[PIDX(8,12)] + F[8][12]*D[PIDX(6,12)])*T + D[PIDX(6,8)];
+	P[PIDX(6,9)] = (F[9][6]*(F[6][7]*D[PIDX(6,7)] + F[6][8]*D[PIDX(6,8)] + F[6][9]*D[PIDX(6,9)] + F[6][10]*D[PIDX(6,10)] + F[6][11]*D[PIDX(6,11)] + F[6][12]*D[PIDX(6,12)]) + F[9][7]*(F[6][7]*D[PIDX(7,7)] + F[6][8]*D[PIDX(7,8)] + F[6][9]*D[PIDX(7,9)] + F[6][10]*D[PIDX(7,10)] + F[6][11]*D[PIDX(7,11)] + F[6][12]*D[PIDX(7,12)]) + F[9][8]*(F[6][7]*D[PIDX(7,8)] + F[6][8]*D[PIDX(8,8)] + F[6][9]*D[PIDX(8,9)] + F[6][10]*D[PIDX(8,10)] + F[6][11]*D[PIDX(8,11)] + F[6][12]*D[PIDX(8,12)]) + F[9][10]*(F[6][7]*D[PIDX(7,10)] + F[6][8]*D[PIDX(8,10)] + F[6][9]*D[PIDX(9,10)] + F[6][10]*D[PIDX(10,10)] + F[6][11]*D[PIDX(10,11)] + F[6][12]*D[PIDX(10,12)]) + F[9][11]*(F[6][7]*D[PIDX(7,11)] + F[6][8]*D[PIDX(8,11)] + F[6][9]*D[PIDX(9,11)] + F[6][10]*D[PIDX(10,11)] + F[6][11]*D[PIDX(11,11)] + F[6][12]*D[PIDX(11,12)]) + F[9][12]*(F[6][7]*D[PIDX(7,12)] + F[6][8]*D[PIDX(8,12)] + F[6][9]*D[PIDX(9,12)] + F[6][10]*D[PIDX(10,12)] + F[6][11]*D[PIDX(11,12)] + F[6][12]*D[PIDX(12,12)]) + G[6][0]*G[9][0]*Q[0] + G[6][1]*G[9][1]*Q[1] + G[6][2]*G[9][2]*Q[2])*Tsq + (F[9][6]*D[PIDX(6,6)] + F[9][7]*D[PIDX(6,7)] + F[9][8]*D[PIDX(6,8)] + F[6][7]*D[PIDX(7,9)] + F[6][8]*D[PIDX(8,9)] + F[6][9]*D[PIDX(9,9)] + F[6][10]*D[PIDX(9,10)] + F[9][10]*D[PIDX(6,10)] + F[6][11]*D[PIDX(9,11)] + F[9][11]*D[PIDX(6,11)] + F[6][12]*D[PIDX(9,12)] + F[9][12]*D[PIDX(6,12)])*T + D[PIDX(6,9)];
+	P[PIDX(6,10)] = (F[6][7]*D[PIDX(7,10)] + F[6][8]*D[PIDX(8,10)] + F[6][9]*D[PIDX(9,10)] + F[6][10]*D[PIDX(10,10)] + F[6][11]*D[PIDX(10,11)] + F[6][12]*D[PIDX(10,12)])*T + D[PIDX(6,10)];
+	P[PIDX(6,11)] = (F[6][7]*D[PIDX(7,11)] + F[6][8]*D[PIDX(8,11)] + F[6][9]*D[PIDX(9,11)] + F[6][10]*D[PIDX(10,11)] + F[6][11]*D[PIDX(11,11)] + F[6][12]*D[PIDX(11,12)])*T + D[PIDX(6,11)];
+	P[PIDX(6,12)] = (F[6][7]*D[PIDX(7,12)] + F[6][8]*D[PIDX(8,12)] + F[6][9]*D[PIDX(9,12)] + F[6][10]*D[PIDX(10,12)] + F[6][11]*D[PIDX(11,12)] + F[6][12]*D[PIDX(12,12)])*T + D[PIDX(6,12)];
+	P[PIDX(6,13)] = (F[6][7]*D[PIDX(7,13)] + F[6][8]*D[PIDX(8,13)] + F[6][9]*D[PIDX(9,13)] + F[6][10]*D[PIDX(10,13)] + F[6][11]*D[PIDX(11,13)] + F[6][12]*D[PIDX(12,13)])*T + D[PIDX(6,13)];
+	P[PIDX(6,14)] = (F[6][7]*D[PIDX(7,14)] + F[6][8]*D[PIDX(8,14)] + F[6][9]*D[PIDX(9,14)] + F[6][10]*D[PIDX(10,14)] + F[6][11]*D[PIDX(11,14)] + F[6][12]*D[PIDX(12,14)])*T + D[PIDX(6,14)];
+	P[PIDX(6,15)] = (F[6][7]*D[PIDX(7,15)] + F[6][8]*D[PIDX(8,15)] + F[6][9]*D[PIDX(9,15)] + F[6][10]*D[PIDX(10,15)] + F[6][11]*D[PIDX(11,15)] + F[6][12]*D[PIDX(12,15)])*T + D[PIDX(6,15)];
+	P[PIDX(7,7)] = (Q[0]*G[7][0]*G[7][0] + Q[1]*G[7][1]*G[7][1] + Q[2]*G[7][2]*G[7][2] + F[7][6]*(F[7][6]*D[PIDX(6,6)] + F[7][8]*D[PIDX(6,8)] + F[7][9]*D[PIDX(6,9)] + F[7][10]*D[PIDX(6,10)] + F[7][11]*D[PIDX(6,11)] + F[7][12]*D[PIDX(6,12)]) + F[7][8]*(F[7][6]*D[PIDX(6,8)] + F[7][8]*D[PIDX(8,8)] + F[7][9]*D[PIDX(8,9)] + F[7][10]*D[PIDX(8,10)] + F[7][11]*D[PIDX(8,11)] + F[7][12]*D[PIDX(8,12)]) + F[7][9]*(F[7][6]*D[PIDX(6,9)] + F[7][8]*D[PIDX(8,9)] + F[7][9]*D[PIDX(9,9)] + F[7][10]*D[PIDX(9,10)] + F[7][11]*D[PIDX(9,11)] + F[7][12]*D[PIDX(9,12)]) + F[7][10]*(F[7][6]*D[PIDX(6,10)] + F[7][8]*D[PIDX(8,10)] + F[7][9]*D[PIDX(9,10)] + F[7][10]*D[PIDX(10,10)] + F[7][11]*D[PIDX(10,11)] + F[7][12]*D[PIDX(10,12)]) + F[7][11]*(F[7][6]*D[PIDX(6,11)] + F[7][8]*D[PIDX(8,11)] + F[7][9]*D[PIDX(9,11)] + F[7][10]*D[PIDX(10,11)] + F[7][11]*D[PIDX(11,11)] + F[7][12]*D[PIDX(11,12)]) + F[7][12]*(F[7][6]*D[PIDX(6,12)] + F[7][8]*D[PIDX(8,12)] + F[7][9]*D[PIDX(9,12)] + F[7][10]*D[PIDX(10,12)] + F[7][11]*D[PIDX(11,12)] + F[7][12]*D[PIDX(12,12)]))*Tsq + (2*F[7][6]*D[PIDX(6,7)] + 2*F[7][8]*D[PIDX(7,8)] + 2*F[7][9]*D[PIDX(7,9)] + 2*F[7][10]*D[PIDX(7,10)] + 2*F[7][11]*D[PIDX(7,11)] + 2*F[7][12]*D[PIDX(7,12)])*T + D[PIDX(7,7)];
+	P[PIDX(7,8)] = (F[8][6]*(F[7][6]*D[PIDX(6,6)] + F[7][8]*D[PIDX(6,8)] + F[7][9]*D[PIDX(6,9)] + F[7][10]*D[PIDX(6,10)] + F[7][11]*D[PIDX(6,11)] + F[7][12]*D[PIDX(6,12)]) + F[8][7]*(F[7][6]*D[PIDX(6,7)] + F[7][8]*D[PIDX(7,8)] + F[7][9]*D[PIDX(7,9)] + F[7][10]*D[PIDX(7,10)] + F[7][11]*D[PIDX(7,11)] + F[7][12]*D[PIDX(7,12)]) + F[8][9]*(F[7][6]*D[PIDX(6,9)] + F[7][8]*D[PIDX(8,9)] + F[7][9]*D[PIDX(9,9)] + F[7][10]*D[PIDX(9,10)] + F[7][11]*D[PIDX(9,11)] + F[7][12]*D[PIDX(9,12)]) + F[8][10]*(F[7][6]*D[PIDX(6,10)] + F[7][8]*D[PIDX(8,10)] + F[7][9]*D[PIDX(9,10)] + F[7][10]*D[PIDX(10,10)] + F[7][11]*D[PIDX(10,11)] + F[7][12]*D[PIDX(10,12)]) + F[8][11]*(F[7][6]*D[PIDX(6,11)] + F[7][8]*D[PIDX(8,11)] + F[7][9]*D[PIDX(9,11)] + F[7][10]*D[PIDX(10,11)] + F[7][11]*D[PIDX(11,11)] + F[7][12]*D[PIDX(11,12)]) + F[8][12]*(F[7][6]*D[PIDX(6,12)] + F[7][8]*D[PIDX(8,12)] + F[7][9]*D[PIDX(9,12)] + F[7][10]*D[PIDX(10,12)] + F[7][11]*D[PIDX(11,12)] + F[7][12]*D[PIDX(12,12)]) + G[7][0]*G[8][0]*Q[0] + G[7][1]*G[8][1]*Q[1] + G[7][2]*G[8][2]*Q[2])*Tsq + (F[7][6]*D[PIDX(6,8)] + F[8][6]*D[PIDX(6,7)] + F[8][7]*D[PIDX(7,7)] + F[7][8]*D[PIDX(8,8)] + F[7][9]*D[PIDX(8,9)] + F[8][9]*D[PIDX(7,9)] + F[7][10]*D[PIDX(8,10)] + F[8][10]*D[PIDX(7,10)] + F[7][11]*D[PIDX(8,11)] + F[8][11]*D[PIDX(7,11)] + F[7][12]*D[PIDX(8,12)] + F[8][12]*D[PIDX(7,12)])*T + D[PIDX(7,8)];
+	P[PIDX(7,9)] = (F[9][6]*(F[7][6]*D[PIDX(6,6)] + F[7][8]*D[PIDX(6,8)] + F[7][9]*D[PIDX(6,9)] + F[7][10]*D[PIDX(6,10)] + F[7][11]*D[PIDX(6,11)] + F[7][12]*D[PIDX(6,12)]) + F[9][7]*(F[7][6]*D[PIDX(6,7)] + F[7][8]*D[PIDX(7,8)] + F[7][9]*D[PIDX(7,9)] + F[7][10]*D[PIDX(7,10)] + F[7][11]*D[PIDX(7,11)] + F[7][12]*D[PIDX(7,12)]) + F[9][8]*(F[7][6]*D[PIDX(6,8)] + F[7][8]*D[PIDX(8,8)] + F[7][9]*D[PIDX(8,9)] + F[7][10]*D[PIDX(8,10)] + F[7][11]*D[PIDX(8,11)] + F[7][12]*D[PIDX(8,12)]) + F[9][10]*(F[7][6]*D[PIDX(6,10)] + F[7][8]*D[PIDX(8,10)] + F[7][9]*D[PIDX(9,10)] + F[7][10]*D[PIDX(10,10)] + F[7][11]*D[PIDX(10,11)] + F[7][12]*D[PIDX(10,12)]) + F[9][11]*(F[7][6]*D[PIDX(6,11)] + F[7][8]*D[PIDX(8,11)] + F[7][9]*D[PIDX(9,11)] + F[7][10]*D[PIDX(10,11)] + F[7][11]*D[PIDX(11,11)] + F[7][12]*D[PIDX(11,12)]) + F[9][12]*(F[7][6]*D[PIDX(6,12)] + F[7][8]*D[PIDX(8,12)] + F[7][9]*D[PIDX(9,12)] + F[7][10]*D[PIDX(10,12)] + F[7][11]*D[PIDX(11,12)] + F[7][12]*D[PIDX(12,12)]) + G[7][0]*G[9][0]*Q[0] + G[7][1]*G[9][1]*Q[1] + G[7][2]*G[9][2]*Q[2])*Tsq + (F[9][6]*D[PIDX(6,7)] + F[9][7]*D[PIDX(7,7)] + F[9][8]*D[PIDX(7,8)] + F[7][6]*D[PIDX(6,9)] + F[7][8]*D[PIDX(8,9)] + F[7][9]*D[PIDX(9,9)] + F[7][10]*D[PIDX(9,10)] + F[9][10]*D[PIDX(7,10)] + F[7][11]*D[PIDX(9,11)] + F[9][11]*D[PIDX(7,11)] + F[7][12]*D[PIDX(9,12)] + F[9][12]*D[PIDX(7,12)])*T + D[PIDX(7,9)];
+	P[PIDX(7,10)] = (F[7][6]*D[PIDX(6,10)] + F[7][8]*D[PIDX(8,10)] + F[7][9]*D[PIDX(9,10)] + F[7][10]*D[PIDX(10,10)] + F[7][11]*D[PIDX(10,11)] + F[7][12]*D[PIDX(10,12)])*T + D[PIDX(7,10)];
+	P[PIDX(7,11)] = (F[7][6]*D[PIDX(6,11)] + F[7][8]*D[PIDX(8,11)] + F[7][9]*D[PIDX(9,11)] + F[7][10]*D[PIDX(10,11)] + F[7][11]*D[PIDX(11,11)] + F[7][12]*D[PIDX(11,12)])*T + D[PIDX(7,11)];
+	P[PIDX(7,12)] = (F[7][6]*D[PIDX(6,12)] + F[7][8]*D[PIDX(8,12)] + F[7][9]*D[PIDX(9,12)] + F[7][10]*D[PIDX(10,12)] + F[7][11]*D[PIDX(11,12)] + F[7][12]*D[PIDX(12,12)])*T + D[PIDX(7,12)];
+	P[PIDX(7,13)] = (F[7][6]*D[PIDX(6,13)] + F[7][8]*D[PIDX(8,13)] + F[7][9]*D[PIDX(9,13)] + F[7][10]*D[PIDX(10,13)] + F[7][11]*D[PIDX(11,13)] + F[7][12]*D[PIDX(12,13)])*T + D[PIDX(7,13)];
+	P[PIDX(7,14)] = (F[7][6]*D[PIDX(6,14)] + F[7][8]*D[PIDX(8,14)] + F[7][9]*D[PIDX(9,14)] + F[7][10]*D[PIDX(10,14)] + F[7][11]*D[PIDX(11,14)] + F[7][12]*D[PIDX(12,14)])*T + D[PIDX(7,14)];
+	P[PIDX(7,15)] = (F[7][6]*D[PIDX(6,15)] + F[7][8]*D[PIDX(8,15)] + F[7][9]*D[PIDX(9,15)] + F[7][10]*D[PIDX(10,15)] + F[7][11]*D[PIDX(11,15)] + F[7][12]*D[PIDX(12,15)])*T + D[PIDX(7,15)];
+	P[PIDX(8,8)] = (Q[0]*G[8][0]*G[8][0] + Q[1]*G[8][1]*G[8][1] + Q[2]*G[8][2]*G[8][2] + F[8][6]*(F[8][6]*D[PIDX(6,6)] + F[8][7]*D[PIDX(6,7)] + F[8][9]*D[PIDX(6,9)] + F[8][10]*D[PIDX(6,10)] + F[8][11]*D[PIDX(6,11)] + F[8][12]*D[PIDX(6,12)]) + F[8][7]*(F[8][6]*D[PIDX(6,7)] + F[8][7]*D[PIDX(7,7)] + F[8][9]*D[PIDX(7,9)] + F[8][10]*D[PIDX(7,10)] + F[8][11]*D[PIDX(7,11)] + F[8][12]*D[PIDX(7,12)]) + F[8][9]*(F[8][6]*D[PIDX(6,9)] + F[8][7]*D[PIDX(7,9)] + F[8][9]*D[PIDX(9,9)] + F[8][10]*D[PIDX(9,10)] + F[8][11]*D[PIDX(9,11)] + F[8][12]*D[PIDX(9,12)]) + F[8][10]*(F[8][6]*D[PIDX(6,10)] + F[8][7]*D[PIDX(7,10)] + F[8][9]*D[PIDX(9,10)] + F[8][10]*D[PIDX(10,10)] + F[8][11]*D[PIDX(10,11)] + F[8][12]*D[PIDX(10,12)]) + F[8][11]*(F[8][6]*D[PIDX(6,11)] + F[8][7]*D[PIDX(7,11)] + F[8][9]*D[PIDX(9,11)] + F[8][10]*D[PIDX(10,11)] + F[8][11]*D[PIDX(11,11)] + F[8][12]*D[PIDX(11,12)]) + F[8][12]*(F[8][6]*D[PIDX(6,12)] + F[8][7]*D[PIDX(7,12)] + F[8][9]*D[PIDX(9,12)] + F[8][10]*D[PIDX(10,12)] + F[8][11]*D[PIDX(11,12)] + F[8][12]*D[PIDX(12,12)]))*Tsq + (2*F[8][6]*D[PIDX(6,8)] + 2*F[8][7]*D[PIDX(7,8)] + 2*F[8][9]*D[PIDX(8,9)] + 2*F[8][10]*D[PIDX(8,10)] + 2*F[8][11]*D[PIDX(8,11)] + 2*F[8][12]*D[PIDX(8,12)])*T + D[PIDX(8,8)];
+	P[PIDX(8,9)] = (F[9][6]*(F[8][6]*D[PIDX(6,6)] + F[8][7]*D[PIDX(6,7)] + F[8][9]*D[PIDX(6,9)] + F[8][10]*D[PIDX(6,10)] + F[8][11]*D[PIDX(6,11)] + F[8][12]*D[PIDX(6,12)]) + F[9][7]*(F[8][6]*D[PIDX(6,7)] + F[8][7]*D[PIDX(7,7)] + F[8][9]*D[PIDX(7,9)] + F[8][10]*D[PIDX(7,10)] + F[8][11]*D[PIDX(7,11)] + F[8][12]*D[PIDX(7,12)]) + F[9][8]*(F[8][6]*D[PIDX(6,8)] + F[8][7]*D[PIDX(7,8)] + F[8][9]*D[PIDX(8,9)] + F[8][10]*D[PIDX(8,10)] + F[8][11]*D[PIDX(8,11)] + F[8][12]*D[PIDX(8,12)]) + F[9][10]*(F[8][6]*D[PIDX(6,10)] + F[8][7]*D[PIDX(7,10)] + F[8][9]*D[PIDX(9,10)] + F[8][10]*D[PIDX(10,10)] + F[8][11]*D[PIDX(10,11)] + F[8][12]*D[PIDX(10,12)]) + F[9][11]*(F[8][6]*D[PIDX(6,11)] + F[8][7]*D[PIDX(7,11)] + F[8][9]*D[PIDX(9,11)] + F[8][10]*D[PIDX(10,11)] + F[8][11]*D[PIDX(11,11)] + F[8][12]*D[PIDX(11,12)]) + F[9][12]*(F[8][6]*D[PIDX(6,12)] + F[8][7]*D[PIDX(7,12)] + F[8][9]*D[PIDX(9,12)] + F[8][10]*D[PIDX(10,12)] + F[8][11]*D[PIDX(11,12)] + F[8][12]*D[PIDX(12,12)]) + G[8][0]*G[9][0]*Q[0] + G[8][1]*G[9][1]*Q[1] + G[8][2]*G[9][2]*Q[2])*Tsq + (F[9][6]*D[PIDX(6,8)] + F[9][7]*D[PIDX(7,8)] + F[9][8]*D[PIDX(8,8)] + F[8][6]*D[PIDX(6,9)] + F[8][7]*D[PIDX(7,9)] + F[8][9]*D[PIDX(9,9)] + F[8][10]*D[PIDX(9,10)] + F[9][10]*D[PIDX(8,10)] + F[8][11]*D[PIDX(9,11)] + F[9][11]*D[PIDX(8,11)] + F[8][12]*D[PIDX(9,12)] + F[9][12]*D[PIDX(8,12)])*T + D[PIDX(8,9)];
+	P[PIDX(8,10)] = (F[8][6]*D[PIDX(6,10)] + F[8][7]*D[PIDX(7,10)] + F[8][9]*D[PIDX(9,10)] + F[8][10]*D[PIDX(10,10)] + F[8][11]*D[PIDX(10,11)] + F[8][12]*D[PIDX(10,12)])*T + D[PIDX(8,10)];
+	P[PIDX(8,11)] = (F[8][6]*D[PIDX(6,11)] + F[8][7]*D[PIDX(7,11)] + F[8][9]*D[PIDX(9,11)] + F[8][10]*D[PIDX(10,11)] + F[8][11]*D[PIDX(11,11)] + F[8][12]*D[PIDX(11,12)])*T + D[PIDX(8,11)];
+	P[PIDX(8,12)] = (F[8][6]*D[PIDX(6,12)] + F[8][7]*D[PIDX(7,12)] + F[8][9]*D[PIDX(9,12)] + F[8][10]*D[PIDX(10,12)] + F[8][11]*D[PIDX(11,12)] + F[8][12]*D[PIDX(12,12)])*T + D[PIDX(8,12)];
+	P[PIDX(8,13)] = (F[8][6]*D[PIDX(6,13)] + F[8][7]*D[PIDX(7,13)] + F[8][9]*D[PIDX(9,13)] + F[8][10]*D[PIDX(10,13)] + F[8][11]*D[PIDX(11,13)] + F[8][12]*D[PIDX(12,13)])*T + D[PIDX(8,13)];
+	P[PIDX(8,14)] = (F[8][6]*D[PIDX(6,14)] + F[8][7]*D[PIDX(7,14)] + F[8][9]*D[PIDX(9,14)] + F[8][10]*D[PIDX(10,14)] + F[8][11]*D[PIDX(11,14)] + F[8][12]*D[PIDX(12,14)])*T + D[PIDX(8,14)];
+	P[PIDX(8,15)] = (F[8][6]*D[PIDX(6,15)] + F[8][7]*D[PIDX(7,15)] + F[8][9]*D[PIDX(9,15)] + F[8][10]*D[PIDX(10,15)] + F[8][11]*D[PIDX(11,15)] + F[8][12]*D[PIDX(12,15)])*T + D[PIDX(8,15)];
+	P[PIDX(9,9)] = (Q[0]*G[9][0]*G[9][0] + Q[1]*G[9][1]*G[9][1] + Q[2]*G[9][2]*G[9][2] + F[9][6]*(F[9][6]*D[PIDX(6,6)] + F[9][7]*D[PIDX(6,7)] + F[9][8]*D[PIDX(6,8)] + F[9][10]*D[PIDX(6,10)] + F[9][11]*D[PIDX(6,11)] + F[9][12]*D[PIDX(6,12)]) + F[9][7]*(F[9][6]*D[PIDX(6,7)] + F[9][7]*D[PIDX(7,7)] + F[9][8]*D[PIDX(7,8)] + F[9][10]*D[PIDX(7,10)] + F[9][11]*D[PIDX(7,11)] + F[9][12]*D[PIDX(7,12)]) + F[9][8]*(F[9][6]*D[PIDX(6,8)] + F[9][7]*D[PIDX(7,8)] + F[9][8]*D[PIDX(8,8)] + F[9][10]*D[PIDX(8,10)] + F[9][11]*D[PIDX(8,11)] + F[9][12]*D[PIDX(8,12)]) + F[9][10]*(F[9][6]*D[PIDX(6,10)] + F[9][7]*D[PIDX(7,10)] + F[9][8]*D[PIDX(8,10)] + F[9][10]*D[PIDX(10,10)] + F[9][11]*D[PIDX(10,11)] + F[9][12]*D[PIDX(10,12)]) + F[9][11]*(F[9][6]*D[PIDX(6,11)] + F[9][7]*D[PIDX(7,11)] + F[9][8]*D[PIDX(8,11)] + F[9][10]*D[PIDX(10,11)] + F[9][11]*D[PIDX(11,11)] + F[9][12]*D[PIDX(11,12)]) + F[9][12]*(F[9][6]*D[PIDX(6,12)] + F[9][7]*D[PIDX(7,12)] + F[9][8]*D[PIDX(8,12)] + F[9][10]*D[PIDX(10,12)] + F[9][11]*D[PIDX(11,12)] + F[9][12]*D[PIDX(12,12)]))*Tsq + (2*F[9][6]*D[PIDX(6,9)] + 2*F[9][7]*D[PIDX(7,9)] + 2*F[9][8]*D[PIDX(8,9)] + 2*F[9][10]*D[PIDX(9,10)] + 2*F[9][11]*D[PIDX(9,11)] + 2*F[9][12]*D[PIDX(9,12)])*T + D[PIDX(9,9)];
+	P[PIDX(9,10)] = (F[9][6]*D[PIDX(6,10)] + F[9][7]*D[PIDX(7,10)] + F[9][8]*D[PIDX(8,10)] + F[9][10]*D[PIDX(10,10)] + F[9][11]*D[PIDX(10,11)] + F[9][12]*D[PIDX(10,12)])*T + D[PIDX(9,10)];
+	P[PIDX(9,11)] = (F[9][6]*D[PIDX(6,11)] + F[9][7]*D[PIDX(7,11)] + F[9][8]*D[PIDX(8,11)] + F[9][10]*D[PIDX(10,11)] + F[9][11]*D[PIDX(11,11)] + F[9][12]*D[PIDX(11,12)])*T + D[PIDX(9,11)];
+	P[PIDX(9,12)] = (F[9][6]*D[PIDX(6,12)] + F[9][7]*D[PIDX(7,12)] + F[9][8]*D[PIDX(8,12)] + F[9][10]*D[PIDX(10,12)] + F[9][11]*D[PIDX(11,12)] + F[9][12]*D[PIDX(12,12)])*T + D[PIDX(9,12)];
+	P[PIDX(9,13)] = (F[9][6]*D[PIDX(6,13)] + F[9][7]*D[PIDX(7,13)] + F[9][8]*D[PIDX(8,13)] + F[9][10]*D[PIDX(10,13)] + F[9][11]*D[PIDX(11,13)] + F[9][12]*D[PIDX(12,13)])*T + D[PIDX(9,13)];
+	P[PIDX(9,14)] = (F[9][6]*D[PIDX(6,14)] + F[9][7]*D[PIDX(7,14)] + F[9][8]*D[PIDX(8,14)] + F[9][10]*D[PIDX(10,14)] + F[9][11]*D[PIDX(11,14)] + F[9][12]*D[PIDX(12,14)])*T + D[PIDX(9,14)];
+	P[PIDX(9,15)] = (F[9][6]*D[PIDX(6,15)] + F[9][7]*D[PIDX(7,15)] + F[9][8]*D[PIDX(8,15)] + F[9][10]*D[PIDX(10,15)] + F[9][11]*D[PIDX(11,15)] + F[9][12]*D[PIDX(12,15)])*T + D[PIDX(9,15)];
+	P[PIDX(10,10)] = Q[6]*Tsq + D[PIDX(10,10)];
+	P[PIDX(10,11)] = D[PIDX(10,11)];
+	P[PIDX(10,12)] = D[PIDX(10,12)];
+	P[PIDX(10,13)] = D[PIDX(10,13)];
+	P[PIDX(10,14)] = D[PIDX(10,14)];
+	P[PIDX(10,15)] = D[PIDX(10,15)];
+	P[PIDX(11,11)] = Q[7]*Tsq + D[PIDX(11,11)];
+	P[PIDX(11,12)] = D[PIDX(11,12)];
+	P[PIDX(11,13)] = D[PIDX(11,13)];
+	P[PIDX(11,14)] = D[PIDX(11,14)];
+	P[PIDX(11,15)] = D[PIDX(11,15)];
+	P[PIDX(12,12)] = Q[8]*Tsq + D[PIDX(12,12)];
+	P[PIDX(12,13)] = D[PIDX(12,13)];
+	P[PIDX(12,14)] = D[PIDX(12,14)];
+	P[PIDX(12,15)] = D[PIDX(12,15)];
+	P[PIDX(13,13)] = Q[9]*Tsq + D[PIDX(13,13)];
+	P[PIDX(13,14)] = D[PIDX(13,14)];
+	P[PIDX(13,15)] = D[PIDX(13,15)];
+	P[PIDX(14,14)] = Q[10]*Tsq + D[PIDX(14,14)];
+	P[PIDX(14,15)] = D[PIDX(14,15)];
+	P[PIDX(15,15)] = Q[11]*Tsq + D[PIDX(15,15)];
 
 
 }
@@ -605,10 +614,18 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 //            - or see Simon, "Optimal State Estimation," 1st Ed, p.150
 //  The SensorsUsed variable is a bitwise mask indicating which sensors
 //     should be used in the update.
+//  Each row of H only has a few nonzero columns (see LinearizeH), so
+//     H*P and H*P*H' are only summed over those. A row with none, like
+//     the unused vertical mag component, leaves K zero and is skipped.
 //  ************************************************
 
+//! First column of each row of H that LinearizeH can make nonzero
+static const uint8_t H_first[NUMV] = {0, 1, 2, 3, 4, 5, 6, 6, 0, 2};
+//! Number of columns from H_first that can be nonzero
+static const uint8_t H_count[NUMV] = {1, 1, 1, 1, 1, 1, 4, 4, 0, 1};
+
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-		  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+		  float Y[NUMV], float P[NUMP], float X[NUMX],
 		  uint16_t SensorsUsed)
 {
 	float HP[NUMX], HPHR, Error;
@@ -618,24 +635,26 @@ void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
 	// appropriate corrections
 	for (m = 0; m < NUMV; m++) {
 
-		if (SensorsUsed & (0x01 << m)) {	// use this sensor for update
+		if ((SensorsUsed & (0x01 << m)) && H_count[m] > 0) {	// use this sensor for update
+			const uint8_t k_first = H_first[m];
+			const uint8_t k_end = H_first[m] + H_count[m];
 
 			for (j = 0; j < NUMX; j++) {	// Find Hp = H*P
 				HP[j] = 0.0f;
-				for (k = 0; k < NUMX; k++)
-					HP[j] += H[m][k] * P[k][j];
+				for (k = k_first; k < k_end; k++)
+					HP[j] += H[m][k] * (k <= j ? P[PIDX(k,j)] : P[PIDX(j,k)]);
 			}
 			HPHR = R[m];	// Find  HPHR = H*P*H' + R
-			for (k = 0; k < NUMX; k++)
+			for (k = k_first; k < k_end; k++)
 				HPHR += HP[k] * H[m][k];
 
 			for (k = 0; k < NUMX; k++)
 				K[k][m] = HP[k] / HPHR;	// find K = HP/HPHR
 
+			float *Pij = P;
 			for (i = 0; i < NUMX; i++) {	// Find P(m)= P(m-1) + K*HP
 				for (j = i; j < NUMX; j++)
-					P[i][j] = P[j][i] =
-					    P[i][j] - K[i][m] * HP[j];
+					*Pij++ -= K[i][m] * HP[j];
 			}
 
 			Error = Z[m] - Y[m];
@@ -896,6 +915,9 @@ void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV])
  * Linearize the measurement around the current state estiamte
  * so the predicted measurements are
  *    Z = H * X
+ *
+ * SerialUpdate only looks at the columns listed in H_first and H_count,
+ * so update those when a new nonzero term is added here.
  */
 void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX])
 {
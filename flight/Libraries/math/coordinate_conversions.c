@@ -342,6 +342,47 @@ void quat_mult(const float q1[4], const float q2[4], float qout[4])
 	qout[3] = q1[0]*q2[3] + q1[1]*q2[2] - q1[2]*q2[1] + q1[3]*q2[0];
 }
 
+/**
+ * @brief Advance a quaternion by body rates over one time step
+ * @param[in,out] q The quaternion, renormalized with a positive scalar part
+ * @param[in] rates Body rates in deg/s
+ * @param[in] dT Time step in s
+ * @return The length of the quaternion before renormalizing
+ */
+float quat_integrate(float q[4], const float rates[3], float dT)
+{
+	// Work out time derivative from INSAlgo writeup
+	// Also accounts for the fact that gyros are in deg/s
+	float qdot[4];
+	qdot[0] = (-q[1] * rates[0] - q[2] * rates[1] - q[3] * rates[2]) * dT * DEG2RAD / 2;
+	qdot[1] = (q[0] * rates[0] - q[3] * rates[1] + q[2] * rates[2]) * dT * DEG2RAD / 2;
+	qdot[2] = (q[3] * rates[0] + q[0] * rates[1] - q[1] * rates[2]) * dT * DEG2RAD / 2;
+	qdot[3] = (-q[2] * rates[0] + q[1] * rates[1] + q[0] * rates[2]) * dT * DEG2RAD / 2;
+
+	// Take a time step
+	q[0] = q[0] + qdot[0];
+	q[1] = q[1] + qdot[1];
+	q[2] = q[2] + qdot[2];
+	q[3] = q[3] + qdot[3];
+
+	if(q[0] < 0) {
+		q[0] = -q[0];
+		q[1] = -q[1];
+		q[2] = -q[2];
+		q[3] = -q[3];
+	}
+
+	// Renomalize
+	float qmag;
+	qmag = sqrtf(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+	q[0] = q[0] / qmag;
+	q[1] = q[1] / qmag;
+	q[2] = q[2] / qmag;
+	q[3] = q[3] / qmag;
+
+	return qmag;
+}
+
 /**
  * @brief Rotate a vector by a rotation matrix
  * @param[in] R a three by three rotation matrix (first index is row)
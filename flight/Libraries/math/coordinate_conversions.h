@@ -72,6 +72,7 @@ float VectorMagnitude(const float v[3]);
 void quat_inverse(float q[4]);
 void quat_copy(const float q[4], float qnew[4]);
 void quat_mult(const float q1[4], const float q2[4], float qout[4]);
+float quat_integrate(float q[4], const float rates[3], float dT);
 void rot_mult(float R[3][3], const float vec[3], float vec_out[3], bool transpose);
 void LLA2NED_linearization_float(int32_t home_latitude, float home_altitude, float linearized_conversion_factor_f[]);
 void LLA2NED_linearization_double(int32_t home_latitude, double home_altitude, double linearized_conversion_factor_d[]);
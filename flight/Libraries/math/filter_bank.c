@@ -0,0 +1,305 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsMath Tau Labs math support libraries
+ * @{
+ * @addtogroup TauLabsFilterBank Tau Labs biquad filter bank
+ * @{
+ *
+ * @file       filter_bank.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Biquad low pass and notch filters for three axis sensor data
+ *
+ * The coefficients follow the RBJ audio EQ cookbook.  Each stage holds one
+ * set of coefficients and the state for all three axes, so a sensor sample
+ * is filtered in a single pass with the coefficients loaded once.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "filter_bank.h"
+#include "physical_constants.h"
+
+#include <math.h>
+
+//! Frequencies above this fraction of the sample rate are not filtered
+#define MAX_FREQ_FRACTION 0.48f
+
+/**
+ * @brief biquad_passthrough Set coefficients that pass the input unchanged
+ * @param[out] c The coefficients
+ */
+void biquad_passthrough(struct biquad_coeffs *c)
+{
+	c->b0 = 1;
+	c->b1 = 0;
+	c->b2 = 0;
+	c->a1 = 0;
+	c->a2 = 0;
+}
+
+/**
+ * @brief biquad_lowpass Design a second order low pass filter
+ * @param[out] c The coefficients
+ * @param[in] cutoff_hz The cutoff frequency
+ * @param[in] sample_hz The rate the filter is applied at
+ * @param[in] q The quality factor, FILTER_BANK_BUTTERWORTH_Q for a flat passband
+ */
+void biquad_lowpass(struct biquad_coeffs *c, float cutoff_hz, float sample_hz, float q)
+{
+	if (cutoff_hz <= 0 || q <= 0 || cutoff_hz >= sample_hz * MAX_FREQ_FRACTION) {
+		biquad_passthrough(c);
+		return;
+	}
+
+	const float w0 = 2 * PI * cutoff_hz / sample_hz;
+	const float cosw = cosf(w0);
+	const float alpha = sinf(w0) / (2 * q);
+	const float a0_inv = 1 / (1 + alpha);
+
+	c->b0 = (1 - cosw) / 2 * a0_inv;
+	c->b1 = (1 - cosw) * a0_inv;
+	c->b2 = c->b0;
+	c->a1 = -2 * cosw * a0_inv;
+	c->a2 = (1 - alpha) * a0_inv;
+}
+
+/**
+ * @brief biquad_notch Design a second order notch filter
+ * @param[out] c The coefficients
+ * @param[in] center_hz The frequency to remove
+ * @param[in] sample_hz The rate the filter is applied at
+ * @param[in] q The quality factor, the center frequency over the -3dB bandwidth
+ */
+void biquad_notch(struct biquad_coeffs *c, float center_hz, float sample_hz, float q)
+{
+	if (center_hz <= 0 || q <= 0 || center_hz >= sample_hz * MAX_FREQ_FRACTION) {
+		biquad_passthrough(c);
+		return;
+	}
+
+	const float w0 = 2 * PI * center_hz / sample_hz;
+	const float cosw = cosf(w0);
+	const float alpha = sinf(w0) / (2 * q);
+	const float a0_inv = 1 / (1 + alpha);
+
+	c->b0 = a0_inv;
+	c->b1 = -2 * cosw * a0_inv;
+	c->b2 = a0_inv;
+	c->a1 = c->b1;
+	c->a2 = (1 - alpha) * a0_inv;
+}
+
+/**
+ * @brief biquad_response Evaluate the magnitude response of a filter
+ * @param[in] c The coefficients
+ * @param[in] freq_hz The frequency to evaluate at
+ * @param[in] sample_hz The rate the filter is applied at
+ * @return the gain at freq_hz
+ */
+float biquad_response(const struct biquad_coeffs *c, float freq_hz, float sample_hz)
+{
+	const float w = 2 * PI * freq_hz / sample_hz;
+	const float cos1 = cosf(w), sin1 = sinf(w);
+	const float cos2 = cosf(2 * w), sin2 = sinf(2 * w);
+
+	// H(z) at z = e^jw
+	const float num_re = c->b0 + c->b1 * cos1 + c->b2 * cos2;
+	const float num_im = -c->b1 * sin1 - c->b2 * sin2;
+	const float den_re = 1 + c->a1 * cos1 + c->a2 * cos2;
+	const float den_im = -c->a1 * sin1 - c->a2 * sin2;
+
+	return sqrtf((num_re * num_re + num_im * num_im) /
+	             (den_re * den_re + den_im * den_im));
+}
+
+/**
+ * @brief biquad_bank_init Set the coefficients and clear the state
+ * @param[out] bank The filter
+ * @param[in] c The coefficients
+ */
+void biquad_bank_init(struct biquad_bank *bank, const struct biquad_coeffs *c)
+{
+	bank->c = *c;
+
+	for (int i = 0; i < FILTER_BANK_AXES; i++) {
+		bank->z1[i] = 0;
+		bank->z2[i] = 0;
+	}
+}
+
+/**
+ * @brief biquad_bank_reset Set the state as if the input had been constant
+ * @param[in,out] bank The filter
+ * @param[in] value The input to settle on for each axis
+ */
+void biquad_bank_reset(struct biquad_bank *bank, const float value[FILTER_BANK_AXES])
+{
+	const struct biquad_coeffs *c = &bank->c;
+	const float dc_gain = (c->b0 + c->b1 + c->b2) / (1 + c->a1 + c->a2);
+
+	for (int i = 0; i < FILTER_BANK_AXES; i++) {
+		float y = dc_gain * value[i];
+		bank->z2[i] = c->b2 * value[i] - c->a2 * y;
+		bank->z1[i] = y - c->b0 * value[i];
+	}
+}
+
+/**
+ * @brief biquad_bank_apply Filter one sample on every axis
+ * @param[in,out] bank The filter
+ * @param[in,out] x The sample, replaced by the filter output
+ */
+void biquad_bank_apply(struct biquad_bank *bank, float x[FILTER_BANK_AXES])
+{
+	const float b0 = bank->c.b0, b1 = bank->c.b1, b2 = bank->c.b2;
+	const float a1 = bank->c.a1, a2 = bank->c.a2;
+
+	for (int i = 0; i < FILTER_BANK_AXES; i++) {
+		const float in = x[i];
+		const float out = b0 * in + bank->z1[i];
+
+		bank->z1[i] = b1 * in - a1 * out + bank->z2[i];
+		bank->z2[i] = b2 * in - a2 * out;
+		x[i] = out;
+	}
+}
+
+/**
+ * @brief filter_bank_init Start an empty cascade, which passes the input unchanged
+ * @param[out] fb The cascade
+ */
+void filter_bank_init(struct filter_bank *fb)
+{
+	fb->num_stages = 0;
+}
+
+/**
+ * @brief filter_bank_add Append a stage to the cascade
+ * @param[in,out] fb The cascade
+ * @param[in] c The coefficients of the new stage
+ * @return false if the cascade is already full
+ */
+bool filter_bank_add(struct filter_bank *fb, const struct biquad_coeffs *c)
+{
+	if (fb->num_stages >= FILTER_BANK_MAX_STAGES)
+		return false;
+
+	biquad_bank_init(&fb->stage[fb->num_stages++], c);
+
+	return true;
+}
+
+/**
+ * @brief filter_bank_reset Settle every stage on a constant input
+ * @param[in,out] fb The cascade
+ * @param[in] value The input to settle on for each axis
+ */
+void filter_bank_reset(struct filter_bank *fb, const float value[FILTER_BANK_AXES])
+{
+	float x[FILTER_BANK_AXES];
+
+	for (int i = 0; i < FILTER_BANK_AXES; i++)
+		x[i] = value[i];
+
+	for (int s = 0; s < fb->num_stages; s++) {
+		biquad_bank_reset(&fb->stage[s], x);
+
+		// The next stage sees this stage's steady state output
+		const struct biquad_coeffs *c = &fb->stage[s].c;
+		const float dc_gain = (c->b0 + c->b1 + c->b2) / (1 + c->a1 + c->a2);
+		for (int i = 0; i < FILTER_BANK_AXES; i++)
+			x[i] *= dc_gain;
+	}
+}
+
+/**
+ * @brief filter_bank_apply Filter one sample on every axis through all stages
+ * @param[in,out] fb The cascade
+ * @param[in,out] x The sample, replaced by the filter output
+ */
+void filter_bank_apply(struct filter_bank *fb, float x[FILTER_BANK_AXES])
+{
+	for (int s = 0; s < fb->num_stages; s++)
+		biquad_bank_apply(&fb->stage[s], x);
+}
+
+/**
+ * @brief dynamic_notch_init Set up a notch that can be retuned while running
+ * @param[out] n The notch
+ * @param[in] center_hz The initial frequency to remove, 0 to pass everything
+ * @param[in] sample_hz The rate the filter is applied at
+ * @param[in] q The quality factor
+ */
+void dynamic_notch_init(struct dynamic_notch *n, float center_hz, float sample_hz, float q)
+{
+	struct biquad_coeffs c;
+
+	n->sample_hz = sample_hz;
+	n->q = q;
+	n->center_hz = center_hz;
+
+	biquad_notch(&c, center_hz, sample_hz, q);
+	biquad_bank_init(&n->bank, &c);
+}
+
+/**
+ * @brief dynamic_notch_set_center Move the notch without clearing the state
+ *
+ * The transposed direct form keeps the output continuous when the
+ * coefficients change a little at a time, which is how a tracked
+ * vibration peak moves.
+ * @param[in,out] n The notch
+ * @param[in] center_hz The new frequency to remove
+ */
+void dynamic_notch_set_center(struct dynamic_notch *n, float center_hz)
+{
+	if (center_hz == n->center_hz)
+		return;
+
+	n->center_hz = center_hz;
+	biquad_notch(&n->bank.c, center_hz, n->sample_hz, n->q);
+}
+
+/**
+ * @brief dynamic_notch_configure Change the sample rate and width without clearing the state
+ * @param[in,out] n The notch
+ * @param[in] sample_hz The rate the filter is applied at
+ * @param[in] q The quality factor
+ */
+void dynamic_notch_configure(struct dynamic_notch *n, float sample_hz, float q)
+{
+	n->sample_hz = sample_hz;
+	n->q = q;
+	biquad_notch(&n->bank.c, n->center_hz, sample_hz, q);
+}
+
+/**
+ * @brief dynamic_notch_apply Filter one sample on every axis
+ * @param[in,out] n The notch
+ * @param[in,out] x The sample, replaced by the filter output
+ */
+void dynamic_notch_apply(struct dynamic_notch *n, float x[FILTER_BANK_AXES])
+{
+	biquad_bank_apply(&n->bank, x);
+}
+
+/**
+ * @}
+ * @}
+ */
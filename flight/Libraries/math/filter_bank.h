@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsMath Tau Labs math support libraries
+ * @{
+ * @addtogroup TauLabsFilterBank Tau Labs biquad filter bank
+ * @{
+ *
+ * @file       filter_bank.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Biquad low pass and notch filters for three axis sensor data
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef FILTER_BANK_H
+#define FILTER_BANK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FILTER_BANK_AXES 3
+#define FILTER_BANK_MAX_STAGES 4
+
+//! Q for a second order Butterworth response
+#define FILTER_BANK_BUTTERWORTH_Q 0.70710678f
+
+// Public types
+
+//! Normalized biquad coefficients, a0 is always 1
+struct biquad_coeffs {
+	float b0, b1, b2;
+	float a1, a2;
+};
+
+//! One biquad applied to every axis, in transposed direct form II
+struct biquad_bank {
+	struct biquad_coeffs c;
+	float z1[FILTER_BANK_AXES];
+	float z2[FILTER_BANK_AXES];
+};
+
+//! A cascade of biquads applied to every axis in turn
+struct filter_bank {
+	struct biquad_bank stage[FILTER_BANK_MAX_STAGES];
+	uint8_t num_stages;
+};
+
+//! A notch whose center frequency can be moved while it is running
+struct dynamic_notch {
+	struct biquad_bank bank;
+	float sample_hz;
+	float q;
+	float center_hz;
+};
+
+// Coefficient design
+void biquad_passthrough(struct biquad_coeffs *c);
+void biquad_lowpass(struct biquad_coeffs *c, float cutoff_hz, float sample_hz, float q);
+void biquad_notch(struct biquad_coeffs *c, float center_hz, float sample_hz, float q);
+float biquad_response(const struct biquad_coeffs *c, float freq_hz, float sample_hz);
+
+// Single stage
+void biquad_bank_init(struct biquad_bank *bank, const struct biquad_coeffs *c);
+void biquad_bank_reset(struct biquad_bank *bank, const float value[FILTER_BANK_AXES]);
+void biquad_bank_apply(struct biquad_bank *bank, float x[FILTER_BANK_AXES]);
+
+// Cascade
+void filter_bank_init(struct filter_bank *fb);
+bool filter_bank_add(struct filter_bank *fb, const struct biquad_coeffs *c);
+void filter_bank_reset(struct filter_bank *fb, const float value[FILTER_BANK_AXES]);
+void filter_bank_apply(struct filter_bank *fb, float x[FILTER_BANK_AXES]);
+
+// Dynamic notch
+void dynamic_notch_init(struct dynamic_notch *n, float center_hz, float sample_hz, float q);
+void dynamic_notch_set_center(struct dynamic_notch *n, float center_hz);
+void dynamic_notch_configure(struct dynamic_notch *n, float sample_hz, float q);
+void dynamic_notch_apply(struct dynamic_notch *n, float x[FILTER_BANK_AXES]);
+
+#endif /* FILTER_BANK_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -10,6 +10,11 @@
  * are combined based on the values in @ref MixerSettings and then scaled by the
  * values in @ref ActuatorSettings to create the output PWM times.
  *
+ * When @ref StabilizationModule runs its rate loop in Direct mode it calls
+ * actuator_direct_output() for every gyro sample instead.  The task then
+ * only keeps @ref ActuatorCommand up to date and watches for the direct
+ * path going quiet.
+ *
  * @file       actuator.c
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
  * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013-2015
@@ -47,7 +52,9 @@
 #include "manualcontrolcommand.h"
 #include "pios_thread.h"
 #include "pios_queue.h"
+#include "pios_mutex.h"
 #include "misc_math.h"
+#include "stabilization.h"
 
 // Private constants
 #define MAX_QUEUE_SIZE 2
@@ -78,6 +85,22 @@ static MixerSettingsData mixerSettings;
 // Ditto, for the actuator settings.
 static ActuatorSettingsData actuatorSettings;
 
+// Serializes the settings, mixer and outputs between the task and the direct path
+static struct pios_mutex *output_lock;
+
+// State shared with the direct path, updated by the task on each ActuatorDesired
+static volatile bool direct_allowed;
+
+// Latched whenever the task puts the outputs in failsafe, the direct path
+// leaves them alone until the task clears it on the next ActuatorDesired
+static volatile bool direct_failsafe = true;
+
+// Set while the direct path owns the outputs
+static volatile bool direct_active;
+static volatile uint32_t direct_time;
+static bool direct_failed;
+static float direct_channels[ACTUATORCOMMAND_CHANNEL_NUMELEM];
+
 // Private functions
 static void actuator_task(void* parameters);
 static float scale_channel(float value, int idx);
@@ -87,6 +110,9 @@ static float collective_curve(const float input, const float* curve, uint8_t num
 static bool set_channel(uint8_t mixer_channel, float value);
 static void actuator_update_rate_if_changed(bool force_update);
 static void settings_update_cb(UAVObjEvent * ev);
+static void mix_actuators(ActuatorDesiredData *desired, bool armed, float *status, float *channels);
+static bool output_channels(const float *channels);
+static void actuator_direct_output(const ActuatorDesiredData *desired);
 float process_mixer(const int index, const float curve1, const float curve2,
 		ActuatorDesiredData *desired);
 static float mix_channel(int ct, ActuatorDesiredData *desired,
@@ -133,6 +159,9 @@ int32_t ActuatorInitialize()
 	// Primary output of this module
 	ActuatorCommandInitialize();
 
+	output_lock = PIOS_Mutex_Create();
+	stabilization_direct_register_output(actuator_direct_output);
+
 #if defined(MIXERSTATUS_DIAGNOSTICS)
 	// UAVO only used for inspecting the internal status of the mixer during debug
 	MixerStatusInitialize();
@@ -216,15 +245,21 @@ static void actuator_task(void* parameters)
 	while (1) {
 		if (settings_updated) {
 			settings_updated = false;
+			PIOS_Mutex_Lock(output_lock, PIOS_MUTEX_TIMEOUT_MAX);
 			ActuatorSettingsGet(&actuatorSettings);
 			actuator_update_rate_if_changed(false);
 			MixerSettingsGet(&mixerSettings);
+			PIOS_Mutex_Unlock(output_lock);
 		}
 
 		if (rc != true) {
 			/* Update of ActuatorDesired timed out,
 			 * or first iteration.  Go to failsafe */
+			PIOS_Mutex_Lock(output_lock, PIOS_MUTEX_TIMEOUT_MAX);
+			direct_active = false;
+			direct_failsafe = true;
 			set_failsafe();
+			PIOS_Mutex_Unlock(output_lock);
 		}
 
 		PIOS_WDG_UpdateFlag(PIOS_WDG_ACTUATOR);
@@ -260,70 +295,68 @@ static void actuator_task(void* parameters)
 				nMixers++;
 			}
 		}
+		bool armed = flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED;
+
+		direct_allowed = nMixers >= 2 && !ActuatorCommandReadOnly();
+
 		if ((nMixers < 2) && !ActuatorCommandReadOnly()) { //Nothing can fly with less than two mixers.
+			PIOS_Mutex_Lock(output_lock, PIOS_MUTEX_TIMEOUT_MAX);
+			direct_active = false;
+			direct_failsafe = true;
 			set_failsafe(); // So that channels like PWM buzzer keep working
+			PIOS_Mutex_Unlock(output_lock);
 			continue;
 		}
 
 		AlarmsClear(SYSTEMALARMS_ALARM_ACTUATOR);
 
-		bool armed = flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED;
-		bool positiveThrottle = desired.Throttle >= 0.00f;
-		bool spinWhileArmed = actuatorSettings.MotorsSpinWhileArmed == ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE;
-
-		float curve1 = throt_curve(desired.Throttle, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM);
-
-		//The source for the secondary curve is selectable
-		float curve2 = collective_curve(
-				get_curve2_source(&desired, mixerSettings.Curve2Source),
-				mixerSettings.ThrottleCurve2,
-				MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+		// Store update time
+		command.UpdateTime = 1000.0f*dT;
+		if (1000.0f*dT > command.MaxUpdateTime)
+			command.MaxUpdateTime = 1000.0f*dT;
 
-		float * status = (float *)&mixerStatus; //access status objects as an array of floats
+		bool success;
 
-		for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
-			status[ct] = mix_channel(ct, &desired, curve1, curve2);
+		PIOS_Mutex_Lock(output_lock, PIOS_MUTEX_TIMEOUT_MAX);
 
-			// Motors have additional protection for when to be on
-			if (get_mixer_type(ct) == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+		// A valid ActuatorDesired, the direct path may take over again
+		direct_failsafe = false;
 
-				// If not armed or motors aren't meant to spin all the time
-				if (!armed ||
-						(!spinWhileArmed && !positiveThrottle)) {
-					status[ct] = -1;  //force min throttle
-				}
-				// If armed meant to keep spinning,
-				else if ((spinWhileArmed && !positiveThrottle) ||
-						(status[ct] < 0) )
-					status[ct] = 0;
+		if (direct_active) {
+			if (PIOS_DELAY_DiffuS(direct_time) > FAILSAFE_TIMEOUT_MS * 1000) {
+				// The direct path stopped without handing the outputs back
+				direct_active = false;
+				PIOS_Mutex_Unlock(output_lock);
+				rc = false;
+				continue;
 			}
 
-			command.Channel[ct] = scale_channel(status[ct], ct);
-		}
+			// The outputs are already set, only report what they are
+			memcpy(command.Channel, direct_channels, sizeof(command.Channel));
+			success = !direct_failed;
+			direct_failed = false;
+			PIOS_Mutex_Unlock(output_lock);
 
-		// Store update time
-		command.UpdateTime = 1000.0f*dT;
-		if (1000.0f*dT > command.MaxUpdateTime)
-			command.MaxUpdateTime = 1000.0f*dT;
+			ActuatorCommandSet(&command);
+		} else {
+			float * status = (float *)&mixerStatus; //access status objects as an array of floats
 
-		// Update output object
-		ActuatorCommandSet(&command);
-		// Update in case read only (eg. during servo configuration)
-		ActuatorCommandGet(&command);
+			mix_actuators(&desired, armed, status, command.Channel);
+
+			// Update output object
+			ActuatorCommandSet(&command);
+			// Update in case read only (eg. during servo configuration)
+			ActuatorCommandGet(&command);
 
 #if defined(MIXERSTATUS_DIAGNOSTICS)
-		MixerStatusSet(&mixerStatus);
+			MixerStatusSet(&mixerStatus);
 #endif
 
-		// Update servo outputs
-		bool success = true;
+			// Update servo outputs
+			success = output_channels(command.Channel);
 
-		for (int n = 0; n < ACTUATORCOMMAND_CHANNEL_NUMELEM; ++n) {
-			success &= set_channel(n, command.Channel[n]);
+			PIOS_Mutex_Unlock(output_lock);
 		}
-#if defined(PIOS_INCLUDE_HPWM)
-		PIOS_Servo_Update();
-#endif
 
 		if (!success) {
 			command.NumFailedUpdates++;
@@ -334,6 +367,105 @@ static void actuator_task(void* parameters)
 	}
 }
 
+/**
+ * Mix the desired axes into the output for every channel
+ * @param[in] desired The desired roll, pitch, yaw and throttle
+ * @param[in] armed Whether the motors are allowed to spin
+ * @param[out] status The mixer output for each channel, from -1 to 1
+ * @param[out] channels The output for each channel scaled to the channel range
+ */
+static void mix_actuators(ActuatorDesiredData *desired, bool armed, float *status, float *channels)
+{
+	bool positiveThrottle = desired->Throttle >= 0.00f;
+	bool spinWhileArmed = actuatorSettings.MotorsSpinWhileArmed == ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE;
+
+	float curve1 = throt_curve(desired->Throttle, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM);
+
+	//The source for the secondary curve is selectable
+	float curve2 = collective_curve(
+			get_curve2_source(desired, mixerSettings.Curve2Source),
+			mixerSettings.ThrottleCurve2,
+			MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+
+	for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
+		status[ct] = mix_channel(ct, desired, curve1, curve2);
+
+		// Motors have additional protection for when to be on
+		if (get_mixer_type(ct) == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+
+			// If not armed or motors aren't meant to spin all the time
+			if (!armed ||
+					(!spinWhileArmed && !positiveThrottle)) {
+				status[ct] = -1;  //force min throttle
+			}
+			// If armed meant to keep spinning,
+			else if ((spinWhileArmed && !positiveThrottle) ||
+					(status[ct] < 0) )
+				status[ct] = 0;
+		}
+
+		channels[ct] = scale_channel(status[ct], ct);
+	}
+}
+
+/**
+ * Write the channel values to the outputs
+ * @param[in] channels The pulse width for each channel
+ * @return true if every channel was updated
+ */
+static bool output_channels(const float *channels)
+{
+	bool success = true;
+
+	for (int n = 0; n < ACTUATORCOMMAND_CHANNEL_NUMELEM; ++n) {
+		success &= set_channel(n, channels[n]);
+	}
+#if defined(PIOS_INCLUDE_HPWM)
+	PIOS_Servo_Update();
+#endif
+
+	return success;
+}
+
+/**
+ * Mix and output ActuatorDesired straight from the stabilization rate loop
+ * @param[in] desired The new rate loop output, or NULL to hand the outputs
+ * back to the actuator task
+ *
+ * Does nothing while the actuator task holds the outputs in failsafe.
+ */
+static void actuator_direct_output(const ActuatorDesiredData *desired)
+{
+	if (desired == NULL || !direct_allowed) {
+		direct_active = false;
+		return;
+	}
+
+	ActuatorDesiredData mixed = *desired;
+	float status[MAX_MIX_ACTUATORS];
+
+	// Not from the task, a disarm must stop the motors on the next sample
+	uint8_t armed;
+	FlightStatusArmedGet(&armed);
+
+	PIOS_Mutex_Lock(output_lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	if (direct_failsafe) {
+		direct_active = false;
+		PIOS_Mutex_Unlock(output_lock);
+		return;
+	}
+
+	mix_actuators(&mixed, armed == FLIGHTSTATUS_ARMED_ARMED, status, direct_channels);
+	if (!output_channels(direct_channels))
+		direct_failed = true;
+
+	direct_time = PIOS_DELAY_GetRaw();
+	direct_active = true;
+
+	PIOS_Mutex_Unlock(output_lock);
+}
+
 /**
  *Process mixing for one actuator
  */
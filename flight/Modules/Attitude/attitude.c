@@ -55,6 +55,7 @@
 #include "physical_constants.h"
 #include "coordinate_conversions.h"
 #include "WorldMagModel.h"
+#include "sample_clock.h"
 
 // UAVOs
 #include "accels.h"
@@ -412,7 +413,7 @@ static int32_t updateAttitudeComplementary(bool first_run, bool secondary, bool
 	UAVObjEvent ev;
 	GyrosData gyrosData;
 	AccelsData accelsData;
-	static int32_t timeval;
+	static struct sample_clock cf_clock;
 	float dT;
 
 	// If this is the primary estimation filter, wait until the accel and
@@ -447,7 +448,7 @@ static int32_t updateAttitudeComplementary(bool first_run, bool secondary, bool
 		magData.z = 0;
 
 		// Wait for a mag reading if a magnetometer was registered
-		if (PIOS_SENSORS_GetQueue(PIOS_SENSOR_MAG) != NULL) {
+		if (PIOS_SENSORS_IsRegistered(PIOS_SENSOR_MAG)) {
 			if (!secondary && PIOS_Queue_Receive(magQueue, &ev, 20) != true) {
 				return -1;
 			}
@@ -489,7 +490,7 @@ static int32_t updateAttitudeComplementary(bool first_run, bool secondary, bool
 
 		complementary_filter_state.initialization = CF_POWERON;
 		complementary_filter_state.reset_timeval = PIOS_DELAY_GetRaw();
-		timeval = PIOS_DELAY_GetRaw();
+		sample_clock_reset(&cf_clock);
 
 		complementary_filter_state.arming_count = 0;
 
@@ -579,9 +580,8 @@ static int32_t updateAttitudeComplementary(bool first_run, bool secondary, bool
 	GyrosGet(&gyrosData);
 	accumulate_gyro(&gyrosData);
 
-	// Compute the dT using the cpu clock
-	dT = PIOS_DELAY_DiffuS(timeval) / 1000000.0f;
-	timeval = PIOS_DELAY_GetRaw();
+	// Compute the dT from when the gyros were sampled
+	dT = sample_clock_dT(&cf_clock, gyrosData.timestamp);
 
 	float grot[3];
 	float accel_err[3];
@@ -682,34 +682,7 @@ static int32_t updateAttitudeComplementary(bool first_run, bool secondary, bool
 	gyrosData.y += accel_err[1] * attitudeSettings.AccelKp / dT;
 	gyrosData.z += accel_err[2] * attitudeSettings.AccelKp / dT + mag_err[2] * attitudeSettings.MagKp / dT;
 
-	// Work out time derivative from INSAlgo writeup
-	// Also accounts for the fact that gyros are in deg/s
-	float qdot[4];
-	qdot[0] = (-cf_q[1] * gyrosData.x - cf_q[2] * gyrosData.y - cf_q[3] * gyrosData.z) * dT * DEG2RAD / 2;
-	qdot[1] = (cf_q[0] * gyrosData.x - cf_q[3] * gyrosData.y + cf_q[2] * gyrosData.z) * dT * DEG2RAD / 2;
-	qdot[2] = (cf_q[3] * gyrosData.x + cf_q[0] * gyrosData.y - cf_q[1] * gyrosData.z) * dT * DEG2RAD / 2;
-	qdot[3] = (-cf_q[2] * gyrosData.x + cf_q[1] * gyrosData.y + cf_q[0] * gyrosData.z) * dT * DEG2RAD / 2;
-
-	// Take a time step
-	cf_q[0] = cf_q[0] + qdot[0];
-	cf_q[1] = cf_q[1] + qdot[1];
-	cf_q[2] = cf_q[2] + qdot[2];
-	cf_q[3] = cf_q[3] + qdot[3];
-
-	if(cf_q[0] < 0) {
-		cf_q[0] = -cf_q[0];
-		cf_q[1] = -cf_q[1];
-		cf_q[2] = -cf_q[2];
-		cf_q[3] = -cf_q[3];
-	}
-
-	// Renomalize
-	float qmag;
-	qmag = sqrtf(cf_q[0]*cf_q[0] + cf_q[1]*cf_q[1] + cf_q[2]*cf_q[2] + cf_q[3]*cf_q[3]);
-	cf_q[0] = cf_q[0] / qmag;
-	cf_q[1] = cf_q[1] / qmag;
-	cf_q[2] = cf_q[2] / qmag;
-	cf_q[3] = cf_q[3] / qmag;
+	float qmag = quat_integrate(cf_q, &gyrosData.x, dT);
 
 	// If quaternion has become inappropriately short or has become Nan reinit.
 	// THIS SHOULD NEVER ACTUALLY HAPPEN
@@ -991,7 +964,7 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 
 	static float baro_offset = 0;
 
-	static uint32_t ins_last_time = 0;
+	static struct sample_clock ins_clock;
 	static uint32_t ins_init_time = 0;
 
 	static enum {INS_INIT, INS_WARMUP, INS_RUNNING} ins_state;
@@ -1016,7 +989,7 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 
 		home_location_updated = false;
 
-		ins_last_time = PIOS_DELAY_GetRaw();
+		sample_clock_reset(&ins_clock);
 
 		return 0;
 	}
@@ -1157,8 +1130,8 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 		// state to make sure filter converges
 		ins_state = INS_WARMUP;
 
-		ins_last_time = PIOS_DELAY_GetRaw();	
-		ins_init_time = ins_last_time;
+		sample_clock_reset(&ins_clock);
+		ins_init_time = PIOS_DELAY_GetRaw();
 
 		return 0;
 	} else if (ins_state == INS_INIT)
@@ -1179,8 +1152,7 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 		      (gpsPosition.PDOP <= insSettings.MinRNAVPDOP) &&
 		      (homeLocation.Set == HOMELOCATION_SET_TRUE);
 
-	dT = PIOS_DELAY_DiffuS(ins_last_time) / 1.0e6f;
-	ins_last_time = PIOS_DELAY_GetRaw();
+	dT = sample_clock_dT(&ins_clock, gyrosData.timestamp);
 
 	// This should only happen at start up or at mode switches
 	if(dT > 0.01f)
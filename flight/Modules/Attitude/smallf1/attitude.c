@@ -306,6 +306,10 @@ static int32_t updateSensorsDigital(AccelsData * accelsData, GyrosData * gyrosDa
 	// the accels to be available first
 	update_gyros(&gyros, gyrosData);
 
+	// Queued samples carry no capture time, the time they arrive is the best guess
+	gyrosData->timestamp = PIOS_DELAY_GetRaw();
+	accelsData->timestamp = gyrosData->timestamp;
+
 	GyrosSet(gyrosData);
 	AccelsSet(accelsData);
 
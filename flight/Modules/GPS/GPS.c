@@ -253,31 +253,36 @@ static void gpsTask(void *parameters)
 			continue;
 		}
 
-		uint8_t c;
+		const uint8_t *rx;
+		uint16_t rx_len;
 
 		// This blocks the task until there is something on the buffer
-		while (PIOS_COM_ReceiveBuffer(gpsPort, &c, 1, xDelay) > 0)
+		while ((rx_len = PIOS_COM_LendRxBuffer(gpsPort, &rx, xDelay)) > 0)
 		{
-			int res;
-			switch (gpsProtocol) {
+			for (uint16_t i = 0; i < rx_len; i++) {
+				uint8_t c = rx[i];
+				int res;
+				switch (gpsProtocol) {
 #if defined(PIOS_INCLUDE_GPS_NMEA_PARSER)
-				case MODULESETTINGS_GPSDATAPROTOCOL_NMEA:
-					res = parse_nmea_stream (c,gps_rx_buffer, &gpsposition, &gpsRxStats);
-					break;
+					case MODULESETTINGS_GPSDATAPROTOCOL_NMEA:
+						res = parse_nmea_stream (c,gps_rx_buffer, &gpsposition, &gpsRxStats);
+						break;
 #endif
 #if defined(PIOS_INCLUDE_GPS_UBX_PARSER)
-				case MODULESETTINGS_GPSDATAPROTOCOL_UBX:
-					res = parse_ubx_stream (c,gps_rx_buffer, &gpsposition, &gpsRxStats);
-					break;
+					case MODULESETTINGS_GPSDATAPROTOCOL_UBX:
+						res = parse_ubx_stream (c,gps_rx_buffer, &gpsposition, &gpsRxStats);
+						break;
 #endif
-				default:
-					res = NO_PARSER; // this should not happen
-					break;
-			}
-
-			if (res == PARSER_COMPLETE) {
-				timeOfLastUpdateMs = loopTimeMs;
+					default:
+						res = NO_PARSER; // this should not happen
+						break;
+				}
+
+				if (res == PARSER_COMPLETE) {
+					timeOfLastUpdateMs = loopTimeMs;
+				}
 			}
+			PIOS_COM_ReleaseRxBuffer(gpsPort, rx_len);
 
 			xDelay = 0;	// For now on, don't block / wait,
 					// but consume what we can from the fifo
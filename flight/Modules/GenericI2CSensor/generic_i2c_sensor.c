@@ -33,12 +33,11 @@
 
 #include "i2cvm.h"	   /* UAV Object (VM register file outputs) */
 #include "i2cvmuserprogram.h"	/* UAV Object (bytecode to run) */
+#include "i2c_vm.h"	   /* VM and scheduler */
 #include "pios_thread.h"
 
-extern bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter);
-
 // Private constants
-#define STACK_SIZE_BYTES 370
+#define STACK_SIZE_BYTES 450
 #define TASK_PRIORITY PIOS_THREAD_PRIO_LOW
 
 // Private variables
@@ -47,9 +46,9 @@ static bool module_enabled = false;
 
 // Private functions
 static void GenericI2CSensorTask(void *parameters);
+static bool GenericI2CSensorSelectProgram(uint8_t selected_program, const uint32_t ** program, uint16_t * program_len);
 
-static const uint32_t * i2cvm_program = NULL; /* bytecode to run in the VM */
-static uint16_t i2cvm_program_len = 0;	/* number of instructions in the program */
+static struct i2c_vm_sched i2cvm_sched;	/* programs sharing the bus */
 
 /**
 * Start the module, called on startup
@@ -86,84 +85,108 @@ static int32_t GenericI2CSensorInitialize(void)
 	if (!module_enabled)
 		return -1;
 
-	/* Module is enabled, determine which program to run (if any) */
-	uint8_t selected_program;
-	ModuleSettingsI2CVMProgramSelectGet(&selected_program);
+	/* Module is enabled, determine which programs to run (if any) */
+	uint8_t selected_programs[MODULESETTINGS_I2CVMPROGRAMSELECT_NUMELEM];
+	ModuleSettingsI2CVMProgramSelectGet(selected_programs);
+
+	i2c_vm_sched_init(&i2cvm_sched);
+
+	for (uint8_t i = 0; i < MODULESETTINGS_I2CVMPROGRAMSELECT_NUMELEM; i++) {
+		const uint32_t * program = NULL;
+		uint16_t program_len = 0;
+
+		if (!GenericI2CSensorSelectProgram(selected_programs[i], &program, &program_len))
+			return -1;
+
+		if ((program != NULL) && (program_len != 0)) {
+			if (!i2c_vm_sched_add(&i2cvm_sched, program, program_len, PIOS_I2C_MAIN_ADAPTER))
+				return -1;
+		}
+	}
+
+	/* Make sure we have something to run */
+	if (i2cvm_sched.num_vms == 0) {
+		module_enabled = false;
+		return -1;
+	}
+
+	/* One snapshot instance per program */
+	I2CVMInitialize();
+	for (uint8_t i = 1; i < i2cvm_sched.num_vms; i++)
+		I2CVMCreateInstance();
+
+	return 0;
+}
+
+MODULE_INITCALL(GenericI2CSensorInitialize, GenericI2CSensorStart)
+
+/**
+* Find the program for one of the I2CVMProgramSelect options
+* @return false if there was no memory for the user program
+*/
+static bool GenericI2CSensorSelectProgram(uint8_t selected_program, const uint32_t ** program, uint16_t * program_len)
+{
+	static uint32_t * user_program = NULL;
 
 	switch (selected_program) {
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_USER:
-		I2CVMUserProgramInitialize();
-		uint32_t * user_program;
-		user_program = PIOS_malloc(sizeof(((I2CVMUserProgramData *)0)->Program));
-		if (!user_program) {
-			/* Failed to allocate sufficient memory for the user program */
-			return -1;
+		if (user_program == NULL) {
+			I2CVMUserProgramInitialize();
+			user_program = PIOS_malloc(sizeof(((I2CVMUserProgramData *)0)->Program));
+			if (!user_program) {
+				/* Failed to allocate sufficient memory for the user program */
+				return false;
+			}
+			I2CVMUserProgramProgramGet(user_program);
 		}
-		I2CVMUserProgramProgramGet(user_program);
-		i2cvm_program = user_program;
-		i2cvm_program_len = I2CVMUSERPROGRAM_PROGRAM_NUMELEM;
+		*program = user_program;
+		*program_len = I2CVMUSERPROGRAM_PROGRAM_NUMELEM;
 		break;
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_OPBAROALTIMETER:
 		{
 		extern const uint32_t vmprog_op_mag_baro[];
 		extern const uint32_t vmprog_op_mag_baro_len;
-		i2cvm_program = vmprog_op_mag_baro;
-		i2cvm_program_len = vmprog_op_mag_baro_len;
+		*program = vmprog_op_mag_baro;
+		*program_len = vmprog_op_mag_baro_len;
 		}
 		break;
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_ENDIANTEST:
 		{
 		extern const uint32_t vmprog_endiantest[];
 		extern const uint32_t vmprog_endiantest_len;
-		i2cvm_program = vmprog_endiantest;
-		i2cvm_program_len = vmprog_endiantest_len;
+		*program = vmprog_endiantest;
+		*program_len = vmprog_endiantest_len;
 		}
 		break;
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_MATHTEST:
 		{
 		extern const uint32_t vmprog_mathtest[];
 		extern const uint32_t vmprog_mathtest_len;
-		i2cvm_program = vmprog_mathtest;
-		i2cvm_program_len = vmprog_mathtest_len;
+		*program = vmprog_mathtest;
+		*program_len = vmprog_mathtest_len;
 		}
 		break;
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_NONE:
 	default:
-		/* No program selected, module will not start */
+		/* No program selected in this slot */
 		break;
 	}
 
-	/* Make sure we have something to run */
-	if ((i2cvm_program == NULL) || (i2cvm_program_len == 0)) {
-		module_enabled = false;
-		return -1;
-	}
-
-	I2CVMInitialize();
-
-	return 0;
+	return true;
 }
 
-MODULE_INITCALL(GenericI2CSensorInitialize, GenericI2CSensorStart)
-
-
 static void GenericI2CSensorTask(void *parameters)
 {
 	// Main task loop
 	while (1) {
-		/* Run the selected program */
-		if (i2c_vm_run(i2cvm_program, i2cvm_program_len, PIOS_I2C_MAIN_ADAPTER)) {
-			/* Program ran to completion. This could be because the program is 
-			 * empty or does not infinitely loop.
-			 * Delay in order to prevent these programs from consuming all CPU.
-			 */
-			PIOS_Thread_Sleep(10);
-		} else {
-			/* Program faulted
-			 * Delay to prevent broken programs from consuming all CPU
-			 */
-			PIOS_Thread_Sleep(100);
-		}
+		/* Give each program that is due a turn on the bus.  Programs that
+		 * ran to completion or faulted are restarted by the scheduler after
+		 * a pause, so they cannot consume all CPU.
+		 */
+		uint32_t sleep_ms = i2c_vm_sched_run(&i2cvm_sched, PIOS_Thread_Systime());
+
+		if (sleep_ms)
+			PIOS_Thread_Sleep(sleep_ms);
 	}
 }
 
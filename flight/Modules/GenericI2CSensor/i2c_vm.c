@@ -33,780 +33,670 @@
 #include <stdbool.h>	      /* bool */
 #include "uavobjectmanager.h" /* UAVO types */
 #include "i2cvm.h"	      /* UAVO that holds VM state snapshots */
+#include "i2c_vm.h"	      /* VM and scheduler state */
 #include "i2c_vm_asm.h"	      /* Minimal assembler for I2C VM */
 #if defined(PIOS_INCLUDE_FREERTOS) || defined(PIOS_INCLUDE_CHIBIOS)
 #include "pios_thread.h"
 #endif /* defined(PIOS_INCLUDE_FREERTOS) || defined(PIOS_INCLUDE_CHIBIOS) */
 
-struct i2c_vm_regs {
-	bool     halted;
-	bool     fault;
+/* Programs are decoded once before they run.  Each instruction becomes a
+ * pointer to its handler plus operands that have already been checked, so
+ * the handlers index the register file directly and never fail on bad
+ * operands.  An instruction that could only fault is decoded to the fault
+ * handler, which keeps the fault at the point where the program reaches it.
+ */
 
-	uintptr_t i2c_adapter;
-	uint8_t i2c_dev_addr;
+typedef void (*i2c_vm_inst_handler) (struct i2c_vm * vm, const struct i2c_vm_insn * insn);
 
-	I2CVMData uavo;
+struct i2c_vm_insn {
+	i2c_vm_inst_handler f;
+	int32_t imm;		/* sign extended immediate data, or the absolute jump target */
+	uint8_t a;
+	uint8_t b;
+	uint8_t c;
 };
 
-/******************************
- *
- * VM internal helper functions
- *
- *****************************/
-
 #define SIMM_VAL(msb,lsb) ((int16_t)((((msb) & 0xFF) << 8) | ((lsb) & 0xFF)))
 
-/* Assign a 32-bit value into virtual machine registers
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] reg destination register where value will be stored
- * @param[in] val value to store in register
- */
-static bool i2c_vm_set_reg (struct i2c_vm_regs * vm_state, uint8_t reg, uint32_t val)
-{
-	switch (reg) {
-	case VM_R0:
-		vm_state->uavo.r0 = val;
-		break;
-	case VM_R1:
-		vm_state->uavo.r1 = val;
-		break;
-	case VM_R2:
-		vm_state->uavo.r2 = val;
-		break;
-	case VM_R3:
-		vm_state->uavo.r3 = val;
-		break;
-	case VM_R4:
-		vm_state->uavo.r4 = val;
-		break;
-	case VM_R5:
-		vm_state->uavo.r5 = val;
-		break;
-	case VM_R6:
-		vm_state->uavo.r6 = val;
-		break;
-	default:
-		return false;
-	}
-
-	return true;
-}
-
-/* Read a 32-bit value from virtual machine registers
+/*********************
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] reg register where value will be read from
- * @param[out] val pointer to hold the value of the register
- */
-static bool i2c_vm_get_reg (const struct i2c_vm_regs * vm_state, uint8_t reg, uint32_t * val)
-{
-	switch (reg) {
-	case VM_R0:
-		*val = vm_state->uavo.r0;
-		break;
-	case VM_R1:
-		*val = vm_state->uavo.r1;
-		break;
-	case VM_R2:
-		*val = vm_state->uavo.r2;
-		break;
-	case VM_R3:
-		*val = vm_state->uavo.r3;
-		break;
-	case VM_R4:
-		*val = vm_state->uavo.r4;
-		break;
-	case VM_R5:
-		*val = vm_state->uavo.r5;
-		break;
-	case VM_R6:
-		*val = vm_state->uavo.r6;
-		break;
-	default:
-		return false;
-	}
-
-	return true;
-}
-
-enum aluop {
-	ALUOP_ADD,
-	ALUOP_MUL,
-	ALUOP_DIV,
-	ALUOP_LSR,
-	ALUOP_ASR,
-	ALUOP_SL,
-	ALUOP_OR,
-	ALUOP_AND,
-};
-
-/* Perform an ALU operation and update the virtual machine state (rd = ra op rb)
+ * VM opcode execution
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] operation ALU operation to be performed
- * @param[in] rd destination register for result
- * @param[in] ra first operand register
- * @param[in] rb second operand register
- */
-static bool i2c_vm_aluop_reg (struct i2c_vm_regs * vm_state, enum aluop operation, uint8_t rd, uint8_t ra, uint8_t rb)
-{
-	uint32_t ra_val;
-	uint32_t rb_val;
-	uint32_t rd_val;
-
-	/* Load ra value */
-	if (!i2c_vm_get_reg(vm_state, ra, &ra_val))
-		return false;
-
-	/* Load rb value */
-	if (!i2c_vm_get_reg(vm_state, rb, &rb_val))
-		return false;
-
-	/* Compute result */
-	switch (operation) {
-	case ALUOP_ADD:
-		rd_val = (int32_t)ra_val + (int32_t)rb_val;
-		break;
-	case ALUOP_MUL:
-		rd_val = (int32_t)ra_val * (int32_t)rb_val;
-		break;
-	case ALUOP_DIV:
-		rd_val = (int32_t)ra_val / (int32_t)rb_val;
-		break;
-	case ALUOP_AND:
-		rd_val = ra_val & rb_val;
-		break;
-	default:
-		/* invalid operation, fault */
-		return false;
-	}
-
-	/* Write value into destination register */
-	if (!i2c_vm_set_reg(vm_state, rd, rd_val))
-		return false;
-
-	return true;
-}
+ ********************/
 
-/* Perform an ALU operation and update the virtual machine state (rd = rd op simm)
+/* Stop the virtual machine on a fault
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] operation ALU operation to be performed
- * @param[in] rd destination register for result
- * @param[in] simm_hi,simm_lo short immediate data
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn unused
  */
-static bool i2c_vm_aluop_imm (struct i2c_vm_regs * vm_state, enum aluop operation, uint8_t rd, uint8_t simm_hi, uint8_t simm_lo)
+static void i2c_vm_fault (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	uint32_t rd_val;
-	int16_t  simm_val;
-
-	/* Load rd value */
-	if (!i2c_vm_get_reg(vm_state, rd, &rd_val))
-		return false;
-
-	/* Load short-immediate data */
-	simm_val = SIMM_VAL(simm_hi, simm_lo);
-
-	/* Compute result */
-	switch (operation) {
-	case ALUOP_ADD:
-		rd_val += simm_val;
-		break;
-	case ALUOP_MUL:
-		rd_val *= simm_val;
-		break;
-	case ALUOP_DIV:
-		rd_val /= simm_val;
-		break;
-	case ALUOP_OR:
-		rd_val |= (uint16_t)simm_val;
-		break;
-	case ALUOP_ASR:
-		{
-			/* NOTE this must be a signed integer to force the >> to be an arithmetic shift */
-			int32_t rd_signed;
-
-			rd_signed = rd_val;
-			rd_signed >>= (uint8_t)(simm_val & 0x1F);
-			rd_val = rd_signed;
-		}
-		break;
-	case ALUOP_LSR:
-		rd_val >>= (uint8_t)(simm_val & 0x1F);
-		break;
-	case ALUOP_SL:
-		rd_val <<= (uint8_t)(simm_val & 0x1F);
-		break;
-	default:
-		/* invalid operation, fault */
-		return false;
-	}
-
-	/* Write value into destination register */
-	if (!i2c_vm_set_reg(vm_state, rd, rd_val))
-		return false;
-
-	return true;
+	vm->fault  = true;
+	vm->halted = true;
+	vm->stop   = true;
 }
 
-/*********************
- *
- * VM opcode execution
- *
- ********************/
-
-/* Halt the virtual machine
+/* Halt the virtual machine, also placed just past the end of the program
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] op1,op2,op3 unused
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn unused
  */
-static bool i2c_vm_halt (struct i2c_vm_regs * vm_state, uint8_t op1, uint8_t op2, uint8_t op3)
+static void i2c_vm_halt (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	vm_state->halted = true;
-	return true;
+	vm->halted = true;
+	vm->stop   = true;
 }
 
 /* Virtual machine no operation instruction
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] op1,op2,op3 unused
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn unused
  */
-static bool i2c_vm_nop (struct i2c_vm_regs * vm_state, uint8_t op1, uint8_t op2, uint8_t op3)
+static void i2c_vm_nop (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	vm_state->uavo.pc++;
-	return true;
+	vm->pc++;
 }
 
-/* Set virtual machine register
+/* Set virtual machine register: a = imm
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd register be set
- * @param[in] imm_hi,imm_lo short immediate data
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn a is the register to set, imm the value
  */
-static bool i2c_vm_set_imm (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t imm_hi, uint8_t imm_lo)
+static void i2c_vm_set_imm (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_set_reg(vm_state, rd, (uint32_t)SIMM_VAL(imm_hi, imm_lo)))
-		return false;
-
-	vm_state->uavo.pc++;
-	return true;
+	vm->r[insn->a] = insn->imm;
+	vm->pc++;
 }
 
-/* Store virtual machine data in RAM
+/* Store virtual machine data in RAM: ram[b] = a
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] val value to be stored in RAM
- * @param[in] ram_addr address (in virtual RAM) where value will be stored
- * @param[in] op3 unused
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn a is the value, b the address in virtual RAM
  */
-static bool i2c_vm_store (struct i2c_vm_regs * vm_state, uint8_t val, uint8_t ram_addr, uint8_t op3)
+static void i2c_vm_store (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (ram_addr >= sizeof(vm_state->uavo.ram))
-		return false;
-
-	vm_state->uavo.ram[ram_addr] = val;
-	vm_state->uavo.pc++;
-	return true;
+	vm->ram[insn->b] = insn->a;
+	vm->pc++;
 }
 
-
 /* Load register information in Big Endian format
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] addr address (in virtual RAM) where value should be loaded from
- * @param[in] len number of bytes to load from RAM
- * @param[in] rd register to store the value into
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn a is the address in virtual RAM, b the number of bytes, c the destination register
  */
-static bool i2c_vm_load_be (struct i2c_vm_regs * vm_state, uint8_t addr, uint8_t len, uint8_t rd)
+static void i2c_vm_load_be (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if ((len < 1) || (len > 4))
-		return false;
-
-	if (addr >= sizeof(vm_state->uavo.ram))
-		return false;
-
+	const uint8_t *p = &vm->ram[insn->a];
 	uint32_t val = 0;
-	memcpy ((void *)((uintptr_t)&val + (4 - len)), &(vm_state->uavo.ram[addr]), len);
 
-	/* Handle byte swapping */
-	val = (((val & 0xFF000000) >> 24) |
-		((val & 0x00FF0000) >> 8) |
-		((val & 0x0000FF00) << 8) |
-		((val & 0x000000FF) << 24));
+	for (uint8_t i = 0; i < insn->b; i++)
+		val = (val << 8) | p[i];
 
-	if (!i2c_vm_set_reg (vm_state, rd, val))
-		return false;
-
-	vm_state->uavo.pc++;
-	return true;
+	vm->r[insn->c] = val;
+	vm->pc++;
 }
 
 /* Load register information in Little Endian format
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] addr address (in virtual RAM) where value should be loaded from
- * @param[in] len number of bytes to load from RAM
- * @param[in] rd register to store the value into
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn a is the address in virtual RAM, b the number of bytes, c the destination register
  */
-static bool i2c_vm_load_le (struct i2c_vm_regs * vm_state, uint8_t addr, uint8_t len, uint8_t rd)
+static void i2c_vm_load_le (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if ((len < 1) || (len > 4))
-		return false;
-
-	if (addr >= sizeof(vm_state->uavo.ram))
-		return false;
-
+	const uint8_t *p = &vm->ram[insn->a];
 	uint32_t val = 0;
-	memcpy (&val, &(vm_state->uavo.ram[addr]), len);
 
-	if (!i2c_vm_set_reg (vm_state, rd, val))
-		return false;
+	for (uint8_t i = insn->b; i > 0; i--)
+		val = (val << 8) | p[i - 1];
 
-	vm_state->uavo.pc++;
-	return true;
+	vm->r[insn->c] = val;
+	vm->pc++;
 }
 
-/* ADD: rd = ra + rb
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] ra first operand register
- * @param[in] rb second operand register
- */
-static bool i2c_vm_add_reg (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t ra, uint8_t rb)
+/* ADD: a = b + c */
+static void i2c_vm_add_reg (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_reg(vm_state, ALUOP_ADD, rd, ra, rb))
-		return false;
+	vm->r[insn->a] = vm->r[insn->b] + vm->r[insn->c];
+	vm->pc++;
+}
 
-	vm_state->uavo.pc++;
-	return true;
+/* ADD: a += imm */
+static void i2c_vm_add_imm (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
+{
+	vm->r[insn->a] += insn->imm;
+	vm->pc++;
 }
 
-/* ADD: rd += simm
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] imm_hi,imm_lo short immediate data
- */
-static bool i2c_vm_add_imm (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t imm_hi, uint8_t imm_lo)
+/* Multiply: a = b * c */
+static void i2c_vm_mul_reg (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_imm(vm_state, ALUOP_ADD, rd, imm_hi, imm_lo))
-		return false;
+	vm->r[insn->a] = vm->r[insn->b] * vm->r[insn->c];
+	vm->pc++;
+}
 
-	vm_state->uavo.pc++;
-	return true;
+/* Multiply: a *= imm */
+static void i2c_vm_mul_imm (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
+{
+	vm->r[insn->a] *= insn->imm;
+	vm->pc++;
 }
 
-/* Multiply: rd = ra * rb
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] ra first operand register
- * @param[in] rb second operand register
- */
-static bool i2c_vm_mul_reg (struct i2c_vm_regs * vm_state, uint8_t op1, uint8_t op2, uint8_t op3)
+/* Divide: a = signed(b) / signed(c), faults on division by zero */
+static void i2c_vm_div_reg (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_reg(vm_state, ALUOP_MUL, op1, op2, op3))
-		return false;
+	int32_t divisor = vm->r[insn->c];
 
-	vm_state->uavo.pc++;
-	return true;
+	if (divisor == 0) {
+		i2c_vm_fault(vm, insn);
+		return;
+	}
+
+	/* Negate rather than divide by -1, which would overflow on the most negative value */
+	if (divisor == -1)
+		vm->r[insn->a] = 0 - vm->r[insn->b];
+	else
+		vm->r[insn->a] = (int32_t)vm->r[insn->b] / divisor;
+	vm->pc++;
 }
 
-/* Multiply: rd *= simm
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] imm_hi,imm_lo short immediate data
- */
-static bool i2c_vm_mul_imm (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t imm_hi, uint8_t imm_lo)
+/* Divide: a /= imm, the register is treated as unsigned.  A zero divisor is decoded to a fault */
+static void i2c_vm_div_imm (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_imm(vm_state, ALUOP_MUL, rd, imm_hi, imm_lo))
-		return false;
-
-	vm_state->uavo.pc++;
-	return true;
+	vm->r[insn->a] /= (uint32_t)insn->imm;
+	vm->pc++;
 }
 
-/* Divide: rd = ra / rb
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] ra first operand register
- * @param[in] rb second operand register
- */
-static bool i2c_vm_div_reg (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t ra, uint8_t rb)
+/* OR: a |= (imm & 0xFFFF) */
+static void i2c_vm_or_imm (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_reg(vm_state, ALUOP_DIV, rd, ra, rb))
-		return false;
+	vm->r[insn->a] |= (uint16_t)insn->imm;
+	vm->pc++;
+}
 
-	vm_state->uavo.pc++;
-	return true;
+/* AND: a = b & c */
+static void i2c_vm_and_reg (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
+{
+	vm->r[insn->a] = vm->r[insn->b] & vm->r[insn->c];
+	vm->pc++;
 }
 
-/* Divide: rd /= simm
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] imm_hi,imm_lo short immediate data
- */
-static bool i2c_vm_div_imm (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t imm_hi, uint8_t imm_lo)
+/* Arithmetic Shift Right (ASR): signed(a) >>= imm, imm already masked to 0..31 */
+static void i2c_vm_asr_imm (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_imm(vm_state, ALUOP_DIV, rd, imm_hi, imm_lo))
-		return false;
+	/* NOTE this must be a signed integer to force the >> to be an arithmetic shift */
+	int32_t rd_signed = vm->r[insn->a];
 
-	vm_state->uavo.pc++;
-	return true;
+	rd_signed >>= insn->imm;
+	vm->r[insn->a] = rd_signed;
+	vm->pc++;
 }
 
-/* OR: rd |= (simm & 0xFFFF)
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] imm_hi,imm_lo short immediate data
- */
-static bool i2c_vm_or_imm (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t imm_hi, uint8_t imm_lo)
+/* Logical Shift Right (LSR): a >>= imm, imm already masked to 0..31 */
+static void i2c_vm_lsr_imm (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_imm(vm_state, ALUOP_OR, rd, imm_hi, imm_lo))
-		return false;
+	vm->r[insn->a] >>= insn->imm;
+	vm->pc++;
+}
 
-	vm_state->uavo.pc++;
-	return true;
+/* Logical Shift Left (SL): a <<= imm, imm already masked to 0..31 */
+static void i2c_vm_sl_imm (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
+{
+	vm->r[insn->a] <<= insn->imm;
+	vm->pc++;
 }
 
-/* AND: rd = ra & rb
+/* Jump to the absolute target worked out when the program was decoded
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] ra first operand register
- * @param[in] rb second operand register
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn imm is the target
  */
-static bool i2c_vm_and_reg (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t ra, uint8_t rb)
+static void i2c_vm_jump (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_reg(vm_state, ALUOP_AND, rd, ra, rb))
-		return false;
-
-	vm_state->uavo.pc++;
-	return true;
+	vm->pc = insn->imm;
 }
 
-/* Arithmetic Shift Right (ASR): signed(rd) >>= (simm & 0x1F)
+/* Branch If Not Zero: pc = imm IFF (a != 0)
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] imm_hi,imm_lo number of bits to shift (short immediate data)
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn a is the register to compare, imm the target
  */
-static bool i2c_vm_asr_imm (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t imm_hi, uint8_t imm_lo)
+static void i2c_vm_bnz (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_imm(vm_state, ALUOP_ASR, rd, imm_hi, imm_lo))
-		return false;
-
-	vm_state->uavo.pc++;
-	return true;
+	if (vm->r[insn->a])
+		vm->pc = insn->imm;
+	else
+		vm->pc++;
 }
 
-/* Logical Shift Right (LSR): rd >>= (simm & 0x1F)
+/* Set I2C device address in virtual machine
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] imm_hi,imm_lo number of bits to shift (short immediate data)
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn a is the 7-bit I2C device address to be used in future I2C transfers
  */
-static bool i2c_vm_lsr_imm (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t imm_hi, uint8_t imm_lo)
+static void i2c_vm_set_dev_addr (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	if (!i2c_vm_aluop_imm(vm_state, ALUOP_LSR, rd, imm_hi, imm_lo))
-		return false;
-
-	vm_state->uavo.pc++;
-	return true;
+	vm->i2c_dev_addr = insn->a;
+	vm->pc++;
 }
 
-
-/* Logical Shift Left (SL): rd <<= (simm & 0x1F)
+/* Transfer I2C data between the bus and virtual machine RAM
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] rd destination register for result
- * @param[in] imm_hi,imm_lo number of bits to shift (short immediate data)
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn a is the base address in virtual RAM, b the number of bytes
+ * @param[in] rw PIOS_I2C_TXN_READ or PIOS_I2C_TXN_WRITE
  */
-static bool i2c_vm_sl_imm (struct i2c_vm_regs * vm_state, uint8_t rd, uint8_t imm_hi, uint8_t imm_lo)
+static void i2c_vm_transfer (struct i2c_vm * vm, const struct i2c_vm_insn * insn, uint8_t rw)
 {
-	if (!i2c_vm_aluop_imm(vm_state, ALUOP_SL, rd, imm_hi, imm_lo))
-		return false;
+	const struct pios_i2c_txn txn_list[] = {
+		{
+			.info = __func__,
+			.addr = vm->i2c_dev_addr,
+			.rw   = rw,
+			.len  = insn->b,
+			.buf  = vm->ram + insn->a,
+		},
+	};
 
-	vm_state->uavo.pc++;
-	return true;
+	int32_t rc = PIOS_I2C_Transfer(vm->i2c_adapter, txn_list, NELEMENTS(txn_list));
+
+	/* Fault the VM if the I2C transfer fails */
+	if (rc < 0) {
+		i2c_vm_fault(vm, insn);
+		return;
+	}
+
+	vm->pc++;
 }
 
-/* Jump: pc += simm
- *
- * @param[in,out] vm_state virtual machine state
- * @param[in] op1 unused
- * @param[in] imm_hi,imm_lo offset to apply to the program counter (short immediate data)
- */
-static bool i2c_vm_jump (struct i2c_vm_regs * vm_state, uint8_t op1, uint8_t imm_hi, uint8_t imm_lo)
+/* Read I2C data into virtual machine RAM */
+static void i2c_vm_read (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	vm_state->uavo.pc += SIMM_VAL(imm_hi, imm_lo);
+	i2c_vm_transfer(vm, insn, PIOS_I2C_TXN_READ);
+}
 
-	return true;
+/* Write I2C data from virtual machine RAM */
+static void i2c_vm_write (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
+{
+	i2c_vm_transfer(vm, insn, PIOS_I2C_TXN_WRITE);
 }
 
-/* Branch If Not Zero: pc += simm IFF (ra == 0)
+/* Send UAVObject from virtual machine registers
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] ra register to compare
- * @param[in] imm_hi,imm_lo short immediate data
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn unused
  */
-static bool i2c_vm_bnz (struct i2c_vm_regs * vm_state, uint8_t ra, uint8_t imm_hi, uint8_t imm_lo)
+static void i2c_vm_send_uavo (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	uint32_t ra_val;
+	I2CVMData uavo;
 
-	/* Load ra value */
-	if (!i2c_vm_get_reg(vm_state, ra, &ra_val))
-		return false;
+	memcpy(uavo.ram, vm->ram, sizeof(uavo.ram));
+	uavo.pc = vm->pc;
+	uavo.r0 = vm->r[VM_R0];
+	uavo.r1 = vm->r[VM_R1];
+	uavo.r2 = vm->r[VM_R2];
+	uavo.r3 = vm->r[VM_R3];
+	uavo.r4 = vm->r[VM_R4];
+	uavo.r5 = vm->r[VM_R5];
+	uavo.r6 = vm->r[VM_R6];
 
-	if (ra_val) {
-		return (i2c_vm_jump(vm_state, 0, imm_hi, imm_lo));
-	} else {
-		vm_state->uavo.pc++;
-	}
+	/* Push a snapshot of the machine state */
+	I2CVMInstSet(vm->uavo_instance, &uavo);
 
-	return true;
+	vm->pc++;
 }
 
-/* Set I2C device address in virtual machine
+/* Make virtual machine wait.  The wait itself is left to whoever runs the machine
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] i2c_dev_addr 7-bit I2C device address to be used in future I2C transfers
- * @param[in] op2,op3 unused
+ * @param[in,out] vm virtual machine state
+ * @param[in] insn imm is the number of ms to wait
  */
-static bool i2c_vm_set_dev_addr (struct i2c_vm_regs * vm_state, uint8_t i2c_dev_addr, uint8_t op2, uint8_t op3)
+static void i2c_vm_delay (struct i2c_vm * vm, const struct i2c_vm_insn * insn)
 {
-	vm_state->i2c_dev_addr = i2c_dev_addr;
-	vm_state->uavo.pc++;
-	return true;
+	vm->wait_ms = insn->imm;
+	vm->stop    = true;
+	vm->pc++;
 }
 
-/* Read I2C data into virtual machine RAM
+/******************************
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] ram_addr base address (in virtual RAM) where data will be stored
- * @param[in] len number of bytes to read from the i2c bus and store into virtual RAM
- * @param[in] op3 unused
- */
-static bool i2c_vm_read (struct i2c_vm_regs * vm_state, uint8_t ram_addr, uint8_t len, uint8_t op3)
-{
-	/* Make sure our read fits in our buffer */
-	if ((ram_addr + len) > sizeof(vm_state->uavo.ram)) {
-		return false;
-	}
+ * Program decoding
+ *
+ *****************************/
 
-	const struct pios_i2c_txn txn_list[] = {
-		{
-			.info = __func__,
-			.addr = vm_state->i2c_dev_addr,
-			.rw   = PIOS_I2C_TXN_READ,
-			.len  = len,
-			.buf  = vm_state->uavo.ram + ram_addr,
-		},
-	};
+/* Instruction layouts, which say how the operands are checked and decoded */
+enum i2c_vm_format {
+	FMT_NONE,	/* no operands */
+	FMT_REG_SIMM,	/* register, short immediate */
+	FMT_SIMM,	/* short immediate */
+	FMT_SHIFT,	/* register, shift count */
+	FMT_DIV_SIMM,	/* register, non zero short immediate */
+	FMT_BRANCH,	/* register, relative target */
+	FMT_JUMP,	/* relative target */
+	FMT_REG3,	/* three registers */
+	FMT_STORE,	/* value, RAM address */
+	FMT_LOAD,	/* RAM address, 1 to 4 bytes, register */
+	FMT_XFER,	/* RAM address, length that fits in RAM */
+	FMT_BYTE,	/* any byte */
+};
 
-	int32_t rc = PIOS_I2C_Transfer(vm_state->i2c_adapter, txn_list, NELEMENTS(txn_list));
+struct i2c_vm_opcode {
+	i2c_vm_inst_handler f;
+	enum i2c_vm_format format;
+};
 
-	/* Fault the VM if the I2C transfer fails */
-	if (rc < 0)
-		return false;
+static const struct i2c_vm_opcode i2c_vm_opcodes[] = {
+	/* Program flow operations */
+	[I2C_VM_OP_HALT]         = { i2c_vm_halt,         FMT_NONE },     /* Halt */
+	[I2C_VM_OP_NOP]          = { i2c_vm_nop,          FMT_NONE },     /* No operation */
+	[I2C_VM_OP_DELAY]        = { i2c_vm_delay,        FMT_SIMM },     /* Wait (ms) */
+	[I2C_VM_OP_BNZ]          = { i2c_vm_bnz,          FMT_BRANCH },   /* Branch if register is not zero */
+	[I2C_VM_OP_JUMP]         = { i2c_vm_jump,         FMT_JUMP },     /* Jump relative */
 
-	vm_state->uavo.pc++;
+	/* RAM operations */
+	[I2C_VM_OP_STORE]        = { i2c_vm_store,        FMT_STORE },    /* Store value */
+	[I2C_VM_OP_LOAD_BE]      = { i2c_vm_load_be,      FMT_LOAD },     /* Load big endian */
+	[I2C_VM_OP_LOAD_LE]      = { i2c_vm_load_le,      FMT_LOAD },     /* Load little endian */
+
+	/* Arithmetic operations */
+	[I2C_VM_OP_SET_IMM]      = { i2c_vm_set_imm,      FMT_REG_SIMM }, /* Set register to immediate data */
+	[I2C_VM_OP_ADD]          = { i2c_vm_add_reg,      FMT_REG3 },     /* Add two registers */
+	[I2C_VM_OP_ADD_IMM]      = { i2c_vm_add_imm,      FMT_REG_SIMM }, /* Add immediate data to register */
+	[I2C_VM_OP_MUL]          = { i2c_vm_mul_reg,      FMT_REG3 },     /* Multiply two registers */
+	[I2C_VM_OP_MUL_IMM]      = { i2c_vm_mul_imm,      FMT_REG_SIMM }, /* Multiply register by immediate data */
+	[I2C_VM_OP_DIV]          = { i2c_vm_div_reg,      FMT_REG3 },     /* Divide two registers */
+	[I2C_VM_OP_DIV_IMM]      = { i2c_vm_div_imm,      FMT_DIV_SIMM }, /* Divide register by immediate data */
+
+	/* Logical operations */
+	[I2C_VM_OP_SL_IMM]       = { i2c_vm_sl_imm,       FMT_SHIFT },    /* Shift left */
+	[I2C_VM_OP_LSR_IMM]      = { i2c_vm_lsr_imm,      FMT_SHIFT },    /* Logical Shift Right */
+	[I2C_VM_OP_ASR_IMM]      = { i2c_vm_asr_imm,      FMT_SHIFT },    /* Arithmetic Shift Right */
+	[I2C_VM_OP_OR_IMM]       = { i2c_vm_or_imm,       FMT_REG_SIMM }, /* Logical OR of register and immediate data */
+	[I2C_VM_OP_AND]          = { i2c_vm_and_reg,      FMT_REG3 },     /* Logical AND of two registers */
 
-	return (true);
+	/* I2C operations */
+	[I2C_VM_OP_SET_DEV_ADDR] = { i2c_vm_set_dev_addr, FMT_BYTE },     /* Set I2C device address */
+	[I2C_VM_OP_READ]         = { i2c_vm_read,         FMT_XFER },     /* Read from I2C bus */
+	[I2C_VM_OP_WRITE]        = { i2c_vm_write,        FMT_XFER },     /* Write to I2C bus */
+
+	/* UAVO operations */
+	[I2C_VM_OP_SEND_UAVO]    = { i2c_vm_send_uavo,    FMT_NONE },     /* Send UAV Object */
+};
+
+static bool i2c_vm_valid_reg (uint8_t reg)
+{
+	return (reg >= VM_R0) && (reg <= VM_R6);
 }
 
-/* Write I2C data from virtual machine RAM
+/* Decode one instruction
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] ram_addr base address (in virtual RAM) where data will be read from
- * @param[in] len number of bytes to read from virtual RAM and write to the the i2c bus
- * @param[in] op3 unused
+ * @param[out] insn decoded instruction
+ * @param[in] instruction the encoded instruction
+ * @param[in] pc address of the instruction
+ * @param[in] code_len number of instructions in the program
+ * @return false if the instruction can only fault
  */
-static bool i2c_vm_write (struct i2c_vm_regs * vm_state, uint8_t ram_addr, uint8_t len, uint8_t op3)
+static bool i2c_vm_decode (struct i2c_vm_insn * insn, uint32_t instruction, uint16_t pc, uint16_t code_len)
 {
-	if ((ram_addr + len) > sizeof(vm_state->uavo.ram)) {
-		return false;
+	uint8_t operator = (instruction & 0xFF000000) >> 24;
+	uint8_t op1      = (instruction & 0x00FF0000) >> 16;
+	uint8_t op2      = (instruction & 0x0000FF00) >>  8;
+	uint8_t op3      = (instruction & 0x000000FF);
+	int16_t simm     = SIMM_VAL(op2, op3);
+	int32_t target   = (int32_t)pc + simm;
+
+	if ((operator >= NELEMENTS(i2c_vm_opcodes)) || (i2c_vm_opcodes[operator].f == NULL))
+		return false;
+
+	insn->f   = i2c_vm_opcodes[operator].f;
+	insn->a   = op1;
+	insn->b   = op2;
+	insn->c   = op3;
+	insn->imm = simm;
+
+	switch (i2c_vm_opcodes[operator].format) {
+	case FMT_NONE:
+	case FMT_SIMM:
+	case FMT_BYTE:
+		return true;
+	case FMT_REG_SIMM:
+		return i2c_vm_valid_reg(op1);
+	case FMT_SHIFT:
+		insn->imm = simm & 0x1F;
+		return i2c_vm_valid_reg(op1);
+	case FMT_DIV_SIMM:
+		return i2c_vm_valid_reg(op1) && (simm != 0);
+	case FMT_BRANCH:
+		if (!i2c_vm_valid_reg(op1))
+			return false;
+		/* fall through */
+	case FMT_JUMP:
+		/* Landing just past the end completes the program, anywhere else outside faults */
+		insn->imm = ((target >= 0) && (target <= code_len)) ? target : code_len + 1;
+		return true;
+	case FMT_REG3:
+		return i2c_vm_valid_reg(op1) && i2c_vm_valid_reg(op2) && i2c_vm_valid_reg(op3);
+	case FMT_STORE:
+		return op2 < I2CVM_RAM_NUMELEM;
+	case FMT_LOAD:
+		return (op2 >= 1) && (op2 <= 4) && (op1 + op2 <= I2CVM_RAM_NUMELEM) && i2c_vm_valid_reg(op3);
+	case FMT_XFER:
+		return op1 + op2 <= I2CVM_RAM_NUMELEM;
 	}
 
-	const struct pios_i2c_txn txn_list[] = {
-		{
-			.info = __func__,
-			.addr = vm_state->i2c_dev_addr,
-			.rw   = PIOS_I2C_TXN_WRITE,
-			.len  = len,
-			.buf  = vm_state->uavo.ram + ram_addr,
-		},
-	};
-
-	int32_t rc = PIOS_I2C_Transfer(vm_state->i2c_adapter, txn_list, NELEMENTS(txn_list));
-
-	/* Fault the VM if the I2C transfer fails */
-	if (rc < 0)
-		return false;
-
-	vm_state->uavo.pc++;
-
-	return (true);
+	return false;
 }
 
-/* Send UAVObject from virtual machine registers
+/******************************
+ *
+ * Running programs
+ *
+ *****************************/
+
+/* Reboot virtual machine, clearing everything but the loaded program
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] op1,op2,op3 unused
+ * @param[in,out] vm virtual machine state
  */
-static bool i2c_vm_send_uavo (struct i2c_vm_regs * vm_state, uint8_t op1, uint8_t op2, uint8_t op3)
+void i2c_vm_reboot (struct i2c_vm * vm)
 {
-	/* Push our local copy of the UAVO */
-	I2CVMSet(&vm_state->uavo);
+	vm->stop    = false;
+	vm->halted  = false;
+	vm->fault   = false;
+	vm->wait_ms = 0;
 
-	vm_state->uavo.pc++;
-	return true;
+	/* Reset I2C configuration */
+	vm->i2c_dev_addr = 0;
+
+	/* Reset register state */
+	vm->pc = 0;
+	memset(vm->r, 0, sizeof(vm->r));
+	memset(vm->ram, 0, sizeof(vm->ram));
 }
 
-/* Make virtual machine wait
+/* Decode a program into a virtual machine and reboot it
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] op1 unused
- * @param[in] imm_hi,imm_lo number of ms to wait (short immediate data)
+ * @param[in,out] vm virtual machine state, the decoded program memory is reused when it is big enough
+ * @param[in] code pointer to program to execute
+ * @param[in] code_len number of 32-bit instructions contained in the program
+ * @param[in] i2c_adapter opaque I2C adapter handle to use for i2c transactions
+ * @param[in] uavo_instance I2CVM instance to send snapshots to
+ * @return false if there is no program or no memory to decode it into
  */
-static bool i2c_vm_delay (struct i2c_vm_regs * vm_state, uint8_t op1, uint8_t imm_hi, uint8_t imm_lo)
+bool i2c_vm_load (struct i2c_vm * vm, const uint32_t * code, uint16_t code_len, uintptr_t i2c_adapter, uint16_t uavo_instance)
 {
-#if defined(PIOS_INCLUDE_FREERTOS) || defined(PIOS_INCLUDE_CHIBIOS)
-	PIOS_Thread_Sleep(SIMM_VAL(imm_hi, imm_lo));
-#endif /* defined(PIOS_INCLUDE_FREERTOS) || defined(PIOS_INCLUDE_CHIBIOS) */
+	if (code == NULL || code_len == 0 || code_len > UINT16_MAX - 2)
+		return false;
+
+	/* Two more entries, for running off the end and for jumps outside of the program */
+	uint16_t entries = code_len + 2;
+
+	if (vm->prog_alloc < entries) {
+		if (vm->prog)
+			PIOS_free(vm->prog);
+		vm->prog_alloc = 0;
+		vm->prog = PIOS_malloc(entries * sizeof(*vm->prog));
+		if (vm->prog == NULL)
+			return false;
+		vm->prog_alloc = entries;
+	}
+
+	for (uint16_t pc = 0; pc < code_len; pc++) {
+		if (!i2c_vm_decode(&vm->prog[pc], code[pc], pc, code_len)) {
+			vm->prog[pc].f = i2c_vm_fault;
+		}
+	}
+	vm->prog[code_len].f     = i2c_vm_halt;
+	vm->prog[code_len + 1].f = i2c_vm_fault;
+	vm->prog_len = code_len;
+
+	vm->i2c_adapter   = i2c_adapter;
+	vm->uavo_instance = uavo_instance;
+	i2c_vm_reboot(vm);
 
-	vm_state->uavo.pc++;
 	return true;
 }
 
-/* Reboot virtual machine
+/* Run a loaded program until it halts, waits or has executed max_insns instructions
  *
- * @param[in,out] vm_state virtual machine state
- * @param[in] op1,op2,op3 unused
+ * @param[in,out] vm virtual machine state
+ * @param[in] max_insns number of instructions to run at most
+ * @return why the machine stopped
  */
-static bool i2c_vm_reboot (struct i2c_vm_regs * vm_state, uintptr_t i2c_adapter)
+enum i2c_vm_status i2c_vm_step (struct i2c_vm * vm, uint16_t max_insns)
 {
-	vm_state->halted  = false;
-	vm_state->fault   = false;
+	const struct i2c_vm_insn *prog = vm->prog;
 
-	/* Reset I2C configuration */
-	vm_state->i2c_dev_addr = 0;
-	vm_state->i2c_adapter  = i2c_adapter;
-
-	/* Reset register state */
-	vm_state->uavo.pc = 0;
-	vm_state->uavo.r0 = 0;
-	vm_state->uavo.r1 = 0;
-	vm_state->uavo.r2 = 0;
-	vm_state->uavo.r3 = 0;
-	vm_state->uavo.r4 = 0;
-	vm_state->uavo.r5 = 0;
-	vm_state->uavo.r6 = 0;
-	memset(vm_state->uavo.ram, 0, sizeof(vm_state->uavo.ram));
+	if (vm->halted)
+		return vm->fault ? I2C_VM_FAULTED : I2C_VM_HALTED;
 
-	return true;
-}
+	vm->stop    = false;
+	vm->wait_ms = 0;
 
+	while (max_insns--) {
+		/* Fetch, execute and writeback, all decoding is already done */
+		const struct i2c_vm_insn *insn = &prog[vm->pc];
+		insn->f(vm, insn);
 
-typedef bool (*i2c_vm_inst_handler) (struct i2c_vm_regs * vm_state, uint8_t op1, uint8_t op2, uint8_t op3);
+		if (vm->stop) {
+			if (vm->halted)
+				return vm->fault ? I2C_VM_FAULTED : I2C_VM_HALTED;
+			return I2C_VM_WAITING;
+		}
+	}
 
-const i2c_vm_inst_handler i2c_vm_handlers[] = {
-	/* Program flow operations */
-	[I2C_VM_OP_HALT]         = i2c_vm_halt,         /* Halt */
-	[I2C_VM_OP_NOP]          = i2c_vm_nop,          /* No operation */
-	[I2C_VM_OP_DELAY]        = i2c_vm_delay,        /* Wait (ms) */
-	[I2C_VM_OP_BNZ]          = i2c_vm_bnz,          /* Branch if register is not zero */
-	[I2C_VM_OP_JUMP]         = i2c_vm_jump,         /* Jump relative */
+	return I2C_VM_RUNNING;
+}
 
-	/* RAM operations */
-	[I2C_VM_OP_STORE]        = i2c_vm_store,        /* Store value */
-	[I2C_VM_OP_LOAD_BE]      = i2c_vm_load_be,      /* Load big endian */
-	[I2C_VM_OP_LOAD_LE]      = i2c_vm_load_le,      /* Load little endian */
+/* Run virtual machine to completion, waiting out any delays in the calling task
+ *
+ * @param[in] code pointer to program to execute
+ * @param[in] code_len number of 32-bit instructions contained in the program
+ * @param[in] i2c_adapter opaque I2C adapter handle to use for i2c transactions
+ * @return false if the program faulted
+ */
+bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter)
+{
+	static struct i2c_vm vm;
 
-	/* Arithmetic operations */
-	[I2C_VM_OP_SET_IMM]      = i2c_vm_set_imm,      /* Set register to immediate data */
-	[I2C_VM_OP_ADD]          = i2c_vm_add_reg,      /* Add two registers */
-	[I2C_VM_OP_ADD_IMM]      = i2c_vm_add_imm,      /* Add immediate data to register */
-	[I2C_VM_OP_MUL]          = i2c_vm_mul_reg,      /* Multiply two registers */
-	[I2C_VM_OP_MUL_IMM]      = i2c_vm_mul_imm,      /* Multiply register by immediate data */
-	[I2C_VM_OP_DIV]          = i2c_vm_div_reg,      /* Divide two registers */
-	[I2C_VM_OP_DIV_IMM]      = i2c_vm_div_imm,      /* Divide register by immediate data */
+	if (!i2c_vm_load(&vm, code, code_len, i2c_adapter, 0))
+		return false;
 
-	/* Logical operations */
-	[I2C_VM_OP_SL_IMM]       = i2c_vm_sl_imm,       /* Shift left */
-	[I2C_VM_OP_LSR_IMM]      = i2c_vm_lsr_imm,      /* Logical Shift Right */
-	[I2C_VM_OP_ASR_IMM]      = i2c_vm_asr_imm,      /* Arithmetic Shift Right */
-	[I2C_VM_OP_OR_IMM]       = i2c_vm_or_imm,       /* Logical OR of register and immediate data */
-	[I2C_VM_OP_AND]          = i2c_vm_and_reg,      /* Logical AND of two registers */
+	while (true) {
+		switch (i2c_vm_step(&vm, UINT16_MAX)) {
+		case I2C_VM_RUNNING:
+			break;
+		case I2C_VM_WAITING:
+#if defined(PIOS_INCLUDE_FREERTOS) || defined(PIOS_INCLUDE_CHIBIOS)
+			PIOS_Thread_Sleep(vm.wait_ms);
+#endif /* defined(PIOS_INCLUDE_FREERTOS) || defined(PIOS_INCLUDE_CHIBIOS) */
+			break;
+		case I2C_VM_HALTED:
+			return true;
+		case I2C_VM_FAULTED:
+			return false;
+		}
+	}
+}
 
-	/* I2C operations */
-	[I2C_VM_OP_SET_DEV_ADDR] = i2c_vm_set_dev_addr, /* Set I2C device address */
-	[I2C_VM_OP_READ]         = i2c_vm_read,         /* Read from I2C bus */
-	[I2C_VM_OP_WRITE]        = i2c_vm_write,        /* Write to I2C bus */
+/******************************
+ *
+ * Scheduling several programs
+ *
+ *****************************/
 
-	/* UAVO operations */
-	[I2C_VM_OP_SEND_UAVO]    = i2c_vm_send_uavo,    /* Send UAV Object */
-};
+/* Start a scheduler without any programs
+ *
+ * @param[out] sched scheduler state
+ */
+void i2c_vm_sched_init (struct i2c_vm_sched * sched)
+{
+	memset(sched, 0, sizeof(*sched));
+}
 
-/* Run virtual machine. This is the code that loops through and interprets all the instructions
+/* Add a program to a scheduler.  It sends its snapshots to the I2CVM instance
+ * with the same index as the program.
  *
+ * @param[in,out] sched scheduler state
  * @param[in] code pointer to program to execute
  * @param[in] code_len number of 32-bit instructions contained in the program
  * @param[in] i2c_adapter opaque I2C adapter handle to use for i2c transactions
- *
+ * @return false if the scheduler is full or the program could not be loaded
  */
-bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter)
+bool i2c_vm_sched_add (struct i2c_vm_sched * sched, const uint32_t * code, uint16_t code_len, uintptr_t i2c_adapter)
 {
-	if (code == NULL || code_len == 0)
+	if (sched->num_vms >= I2C_VM_MAX_PROGRAMS)
 		return false;
 
-	static struct i2c_vm_regs vm;
+	if (!i2c_vm_load(&sched->vm[sched->num_vms], code, code_len, i2c_adapter, sched->num_vms))
+		return false;
 
-	i2c_vm_reboot (&vm, i2c_adapter);
+	sched->wake_ms[sched->num_vms] = 0;
+	sched->num_vms++;
 
-	while (!vm.halted) {
-		if (vm.uavo.pc > code_len) {
-			/* PC is entirely out of range */
-			vm.fault  = true;
-			vm.halted = true;
-			continue;
-		}
-		if (vm.uavo.pc == code_len) {
-			/* PC is just past the end of the code, assume program is completed */
-			vm.halted = true;
-			continue;
-		}
-		/* Fetch */
-		uint32_t instruction = code[vm.uavo.pc];
-
-		/* Decode */
-		uint8_t operator = (instruction & 0xFF000000) >> 24;
-		uint8_t op1      = (instruction & 0x00FF0000) >> 16;
-		uint8_t op2      = (instruction & 0x0000FF00) >>  8;
-		uint8_t op3      = (instruction & 0x000000FF);
-
-		if (operator > NELEMENTS(i2c_vm_handlers)) {
-			vm.fault = true;
-			vm.halted = true;
-			continue;
-		}
-		i2c_vm_inst_handler f = i2c_vm_handlers[operator];
+	return true;
+}
 
-		/* Execute + Writeback */
-		if (!f || !f(&vm, op1, op2, op3)) {
-			vm.fault  = true;
-			vm.halted = true;
-			continue;
+/* Give every program that is due a slice.  As all programs run in the
+ * calling task, their bus transfers never overlap.
+ *
+ * @param[in,out] sched scheduler state
+ * @param[in] now_ms current time
+ * @return ms until the next program is due, 0 if one is ready now
+ */
+uint32_t i2c_vm_sched_run (struct i2c_vm_sched * sched, uint32_t now_ms)
+{
+	uint32_t sleep_ms = I2C_VM_FAULT_MS;
+
+	for (uint8_t i = 0; i < sched->num_vms; i++) {
+		struct i2c_vm *vm = &sched->vm[i];
+		int32_t due_in = sched->wake_ms[i] - now_ms;
+
+		if (due_in <= 0) {
+			switch (i2c_vm_step(vm, I2C_VM_SLICE)) {
+			case I2C_VM_RUNNING:
+				due_in = 0;
+				break;
+			case I2C_VM_WAITING:
+				due_in = vm->wait_ms;
+				break;
+			case I2C_VM_HALTED:
+				/* Program ran to completion, start it over after a little while */
+				i2c_vm_reboot(vm);
+				due_in = I2C_VM_RESTART_MS;
+				break;
+			case I2C_VM_FAULTED:
+				/* Delay to prevent broken programs from consuming all CPU */
+				i2c_vm_reboot(vm);
+				due_in = I2C_VM_FAULT_MS;
+				break;
+			}
+			sched->wake_ms[i] = now_ms + due_in;
 		}
+
+		if ((uint32_t)due_in < sleep_ms)
+			sleep_ms = due_in;
 	}
 
-	return (!vm.fault);
+	return sleep_ms;
 }
 
 #endif /* PIOS_INCLUDE_I2C */
@@ -815,4 +705,3 @@ bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter)
  * @}
  * @}
  */
-
@@ -0,0 +1,91 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsModules Tau Labs Modules
+ * @{
+ * @addtogroup GenericI2CSensor Generic I2C sensor interface
+ * @{
+ *
+ * @file       i2c_vm.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      The virtual machine for I2C sensors
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef I2C_VM_H_
+#define I2C_VM_H_
+
+#include <stdint.h>	      /* uint8_t, uint32_t, etc */
+#include <stdbool.h>	      /* bool */
+#include "i2cvm.h"	      /* UAVO that holds VM state snapshots */
+
+#define I2C_VM_NUM_REGS     8	/* indexed by enum i2c_vm_reg_names, VM_PC is not stored here */
+#define I2C_VM_MAX_PROGRAMS 3	/* programs a scheduler can share the bus between */
+#define I2C_VM_SLICE        64	/* instructions a program may run before the next one gets a turn */
+#define I2C_VM_RESTART_MS   10	/* pause before a program that ran to completion starts over */
+#define I2C_VM_FAULT_MS     100	/* pause before a program that faulted starts over */
+
+struct i2c_vm_insn;
+
+enum i2c_vm_status {
+	I2C_VM_RUNNING,		/* used up its slice, ready to continue */
+	I2C_VM_WAITING,		/* executed a delay, see wait_ms */
+	I2C_VM_HALTED,		/* ran to completion */
+	I2C_VM_FAULTED,		/* stopped on a bad instruction or failed transfer */
+};
+
+/* State of one virtual machine running a pre-decoded program */
+struct i2c_vm {
+	struct i2c_vm_insn *prog;	/* decoded program, followed by the end and fault entries */
+	uint16_t prog_len;		/* number of instructions in the program */
+	uint16_t prog_alloc;		/* number of entries allocated for prog */
+
+	uint16_t pc;
+	uint32_t r[I2C_VM_NUM_REGS];
+	uint8_t  ram[I2CVM_RAM_NUMELEM];
+
+	uintptr_t i2c_adapter;
+	uint8_t  i2c_dev_addr;
+	uint16_t uavo_instance;		/* I2CVM instance the snapshots are sent to */
+
+	bool     stop;			/* set by instructions that end the current slice */
+	bool     halted;
+	bool     fault;
+	uint16_t wait_ms;
+};
+
+/* Several programs sharing one I2C bus, run in turn by a single task */
+struct i2c_vm_sched {
+	struct i2c_vm vm[I2C_VM_MAX_PROGRAMS];
+	uint32_t wake_ms[I2C_VM_MAX_PROGRAMS];
+	uint8_t  num_vms;
+};
+
+bool i2c_vm_load (struct i2c_vm * vm, const uint32_t * code, uint16_t code_len, uintptr_t i2c_adapter, uint16_t uavo_instance);
+void i2c_vm_reboot (struct i2c_vm * vm);
+enum i2c_vm_status i2c_vm_step (struct i2c_vm * vm, uint16_t max_insns);
+bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter);
+
+void i2c_vm_sched_init (struct i2c_vm_sched * sched);
+bool i2c_vm_sched_add (struct i2c_vm_sched * sched, const uint32_t * code, uint16_t code_len, uintptr_t i2c_adapter);
+uint32_t i2c_vm_sched_run (struct i2c_vm_sched * sched, uint32_t now_ms);
+
+#endif /* I2C_VM_H_ */
+
+/**
+ * @}
+ * @}
+ */
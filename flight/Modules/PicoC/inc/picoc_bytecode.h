@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsModules TauLabs Modules
+ * @{
+ * @addtogroup PicoC Interpreter Module
+ * @{
+ *
+ * @file       picoc_bytecode.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      c-interpreter module for autonomous user programmed tasks
+ *             bytecode compiler and virtual machine for scalar scripts
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PICOC_BYTECODE_H
+#define PICOC_BYTECODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PICOC_BC_MAGIC   0x43426350	/* "PcBC" */
+#define PICOC_BC_VERSION 1			/* bump whenever the instruction set changes */
+
+struct LibraryFunction;
+
+//! One slot of the virtual machine, variables and stack entries alike
+union picoc_bc_cell {
+	int32_t i;
+	float f;
+};
+
+//! Start of a compiled program image, followed by the code and the native function table
+struct picoc_bc_header {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t code_words;
+	uint32_t source_hash;		//!< hash of the script the image was compiled from
+	uint32_t library_hash;		//!< hash of the library prototypes the natives index into
+	uint32_t image_hash;		//!< hash of everything after the header
+	uint16_t num_natives;
+	uint16_t num_globals;
+	uint16_t stack_need;		//!< stack cells used by the top level code
+	uint16_t reserved;
+};
+
+enum picoc_bc_result {
+	PICOC_BC_OK = 0,
+	PICOC_BC_ERR_COMPILE = -1,	//!< the script uses something the compiler does not handle
+	PICOC_BC_ERR_SIZE = -2,		//!< the image or a compiler table is too small
+	PICOC_BC_ERR_IMAGE = -3,	//!< the image is corrupt or does not match the libraries
+	PICOC_BC_ERR_STACK = -4,	//!< the script ran out of stack or call depth
+	PICOC_BC_ERR_DIVIDE = -5,	//!< integer division by zero
+};
+
+int32_t picoc_bc_compile(const char *source, const struct LibraryFunction *const *libs,
+		void *image, uint32_t image_size, uint16_t *error_line);
+uint32_t picoc_bc_image_size(const void *image);
+bool picoc_bc_valid(const void *image, uint32_t image_size, const char *source,
+		const struct LibraryFunction *const *libs);
+int32_t picoc_bc_run(const void *image, const struct LibraryFunction *const *libs,
+		union picoc_bc_cell *stack, uint32_t stack_cells, int32_t *exit_value);
+
+#endif /* PICOC_BYTECODE_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -68,6 +68,8 @@ int picoc(const char *source, size_t stack_size);
 
 /* add missing things */
 extern struct LibraryFunction CLibrary[];
+extern const struct LibraryFunction *const PlatformLibrary_bytecode[];
+void PlatformLibraryReset(void);
 
 #ifdef NO_CTYPE
 #define isdigit(c) ((c) >= '0' && (c) <= '9')
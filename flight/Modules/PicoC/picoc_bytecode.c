@@ -0,0 +1,2126 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsModules TauLabs Modules
+ * @{
+ * @addtogroup PicoC Interpreter Module
+ * @{
+ *
+ * @file       picoc_bytecode.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      c-interpreter module for autonomous user programmed tasks
+ *             bytecode compiler and virtual machine for scalar scripts
+ *
+ * The interpreter walks the token stream of every statement each time it
+ * runs it, looking up each name in hash tables as it goes. Scripts that only
+ * use int and float variables, their own functions and the scalar functions
+ * of the platform libraries are instead compiled once into 32 bit
+ * instructions, with names, types and jump targets resolved up front, and
+ * run by a single switch dispatch loop. The compiler gives up on anything
+ * else so the caller can fall back to the interpreter.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+// conditional compilation of the module
+#include "pios.h"
+#ifdef PIOS_INCLUDE_PICOC
+
+#include "picoc_port.h"
+#include "picoc_bytecode.h"
+#include <setjmp.h>
+
+// Private constants
+#define MAX_SYMBOLS		64		/* variables visible at one time */
+#define MAX_FUNCTIONS	16		/* user functions */
+#define MAX_FIXUPS		32		/* calls to functions that are not defined yet */
+#define MAX_NATIVES		24		/* distinct library functions called */
+#define MAX_ARGS		8		/* parameters of any function */
+#define MAX_JUMPS		16		/* breaks, continues or && / || terms of one construct */
+#define MAX_CALL_DEPTH	16		/* nested user function calls at run time */
+#define MAX_CODE_WORDS	0xffff	/* call targets share their operand with the argument count */
+
+#define ARG_MIN			(-0x800000)
+#define ARG_MAX			0x7fffff
+#define INC_DOWN		0x10000	/* INCG and INCL operand flag for a decrement */
+#define HASH_SEED		2166136261u
+
+#define INSN(op, arg)	((uint32_t)(op) | ((uint32_t)(arg) << 8))
+#define INSN_OP(insn)	((uint8_t)(insn))
+#define INSN_ARG(insn)	((int32_t)(insn) >> 8)
+
+/**
+ * Instructions are one word, the opcode in the low byte and a signed 24 bit
+ * operand above it. PUSHW and ENTER are followed by one more raw word.
+ */
+enum bc_op {
+	OP_HALT, OP_NOP, OP_PUSH, OP_PUSHW, OP_POP, OP_DUP,
+	OP_LDG, OP_STG, OP_LDL, OP_STL, OP_INCG, OP_INCL,
+	OP_ADDI, OP_SUBI, OP_MULI, OP_DIVI, OP_MODI,
+	OP_ANDI, OP_ORI, OP_XORI, OP_SHLI, OP_SHRI,
+	OP_EQI, OP_NEI, OP_LTI, OP_LEI, OP_GTI, OP_GEI,
+	OP_ADDF, OP_SUBF, OP_MULF, OP_DIVF,
+	OP_EQF, OP_NEF, OP_LTF, OP_LEF, OP_GTF, OP_GEF,
+	OP_NEGI, OP_NOTI, OP_LNOT, OP_NEGF, OP_I2F, OP_F2I,
+	OP_JMP, OP_JZ, OP_JNZ,
+	OP_CALL, OP_ENTER, OP_RET, OP_RETV, OP_NATIVE, OP_EXIT,
+	OP_COUNT
+};
+
+//! Change in stack depth caused by each instruction, calls are accounted for separately
+static const int8_t op_effect[OP_COUNT] = {
+	[OP_PUSH] = 1, [OP_PUSHW] = 1, [OP_POP] = -1, [OP_DUP] = 1,
+	[OP_LDG] = 1, [OP_STG] = -1, [OP_LDL] = 1, [OP_STL] = -1,
+	[OP_ADDI] = -1, [OP_SUBI] = -1, [OP_MULI] = -1, [OP_DIVI] = -1, [OP_MODI] = -1,
+	[OP_ANDI] = -1, [OP_ORI] = -1, [OP_XORI] = -1, [OP_SHLI] = -1, [OP_SHRI] = -1,
+	[OP_EQI] = -1, [OP_NEI] = -1, [OP_LTI] = -1, [OP_LEI] = -1, [OP_GTI] = -1, [OP_GEI] = -1,
+	[OP_ADDF] = -1, [OP_SUBF] = -1, [OP_MULF] = -1, [OP_DIVF] = -1,
+	[OP_EQF] = -1, [OP_NEF] = -1, [OP_LTF] = -1, [OP_LEF] = -1, [OP_GTF] = -1, [OP_GEF] = -1,
+	[OP_JZ] = -1, [OP_JNZ] = -1, [OP_RET] = -1, [OP_EXIT] = -1,
+};
+
+enum bc_type {
+	TYPE_VOID,
+	TYPE_INT,
+	TYPE_FLOAT,
+};
+
+//! How a library function parameter or result is stored in a union AnyValue
+enum bc_kind {
+	KIND_VOID,
+	KIND_CHAR, KIND_UCHAR,
+	KIND_SHORT, KIND_USHORT,
+	KIND_INT, KIND_UINT,
+	KIND_LONG, KIND_ULONG,
+	KIND_FP,
+};
+
+// Private types
+
+//! A library function resolved from its prototype
+struct bc_binding {
+	void (*func)(struct ParseState *, struct Value *, struct Value **, int);
+	uint8_t ret;
+	uint8_t nargs;
+	uint8_t arg[MAX_ARGS];
+};
+
+struct bc_token {
+	enum LexToken type;
+	const char *start;
+	uint16_t len;
+	uint16_t line;
+	union picoc_bc_cell value;
+};
+
+//! Scanner state, saved to look ahead or to compile loop conditions after the body
+struct bc_position {
+	const char *pos;
+	uint16_t line;
+	struct bc_token tok;
+};
+
+struct bc_symbol {
+	const char *name;
+	uint8_t len;
+	uint8_t type;
+	bool global;
+	uint16_t slot;
+};
+
+struct bc_function {
+	const char *name;
+	uint8_t len;
+	uint8_t ret;
+	uint8_t nargs;
+	uint8_t arg[MAX_ARGS];
+	int32_t addr;			//!< -1 while the function is only declared
+};
+
+struct bc_fixup {
+	uint16_t at;
+	uint8_t function;
+};
+
+struct bc_jumps {
+	uint16_t at[MAX_JUMPS];
+	uint8_t count;
+};
+
+struct bc_loop {
+	struct bc_loop *outer;
+	struct bc_jumps breaks;
+	struct bc_jumps continues;
+};
+
+struct bc_compiler {
+	jmp_buf fail;
+	int32_t error;
+	const char *pos;
+	uint16_t line;
+	struct bc_token tok;
+	const struct LibraryFunction *const *libs;
+
+	uint32_t *code;
+	uint32_t code_len;
+	uint32_t code_max;
+	int32_t depth;
+	int32_t max_depth;
+
+	struct bc_symbol symbols[MAX_SYMBOLS];
+	uint8_t num_symbols;
+	uint16_t num_globals;
+	uint16_t num_locals;
+
+	struct bc_function functions[MAX_FUNCTIONS];
+	uint8_t num_functions;
+	struct bc_function *function;	//!< being compiled, NULL at the top level
+	struct bc_fixup fixups[MAX_FIXUPS];
+	uint8_t num_fixups;
+
+	uint16_t natives[MAX_NATIVES];
+	uint8_t num_natives;
+	struct bc_loop *loop;
+};
+
+struct bc_frame {
+	const uint32_t *ip;
+	union picoc_bc_cell *fp;
+};
+
+// Private functions
+static uint8_t expression(struct bc_compiler *c);
+static void statement(struct bc_compiler *c);
+
+/**
+ * hashing, prototypes and images
+ */
+static uint32_t hash_bytes(uint32_t hash, const void *data, uint32_t len)
+{
+	const uint8_t *bytes = data;
+
+	// FNV-1a
+	for (uint32_t i = 0; i < len; i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static uint32_t library_hash(const struct LibraryFunction *const *libs)
+{
+	uint32_t hash = HASH_SEED;
+
+	for (int l = 0; libs[l] != NULL; l++) {
+		for (int k = 0; libs[l][k].Func != NULL; k++) {
+			hash = hash_bytes(hash, libs[l][k].Prototype, strlen(libs[l][k].Prototype) + 1);
+		}
+	}
+	return hash;
+}
+
+static uint32_t total_size(uint32_t code_words, uint32_t num_natives)
+{
+	return sizeof(struct picoc_bc_header) + code_words * sizeof(uint32_t) +
+		((num_natives * sizeof(uint16_t) + 3) & ~3);
+}
+
+static bool is_digit(char ch)
+{
+	return ch >= '0' && ch <= '9';
+}
+
+static bool is_name_start(char ch)
+{
+	return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+}
+
+static bool is_name_char(char ch)
+{
+	return is_name_start(ch) || is_digit(ch);
+}
+
+static bool word_is(const char *word, uint32_t len, const char *name)
+{
+	return strlen(name) == len && strncmp(word, name, len) == 0;
+}
+
+static void skip_spaces(const char **p)
+{
+	while (**p == ' ')
+		(*p)++;
+}
+
+/**
+ * read a type made of C type words from a library prototype
+ * @return false if there is none
+ */
+static bool prototype_type(const char **p, uint8_t *kind)
+{
+	bool is_unsigned = false;
+	bool any = false;
+	uint8_t k = KIND_INT;
+
+	for (;;) {
+		uint32_t len = 0;
+
+		skip_spaces(p);
+		while (is_name_char((*p)[len]))
+			len++;
+
+		if (word_is(*p, len, "unsigned"))
+			is_unsigned = true;
+		else if (word_is(*p, len, "char"))
+			k = KIND_CHAR;
+		else if (word_is(*p, len, "short"))
+			k = KIND_SHORT;
+		else if (word_is(*p, len, "long"))
+			k = KIND_LONG;
+		else if (word_is(*p, len, "float") || word_is(*p, len, "double"))
+			k = KIND_FP;
+		else if (word_is(*p, len, "void"))
+			k = KIND_VOID;
+		else if (!word_is(*p, len, "int") && !word_is(*p, len, "signed"))
+			break;
+
+		any = true;
+		*p += len;
+	}
+
+#ifdef NO_FP
+	if (k == KIND_FP)
+		return false;
+#endif
+	// each unsigned kind follows its signed one
+	if (is_unsigned && k >= KIND_CHAR && k <= KIND_LONG)
+		k++;
+
+	*kind = k;
+	return any;
+}
+
+/**
+ * parse a library prototype like "float AccessoryValGet(int);"
+ * @return false if it uses anything but scalar parameters and result
+ */
+static bool parse_prototype(const char *proto, struct bc_binding *b, const char **name, uint8_t *name_len)
+{
+	const char *p = proto;
+
+	if (!prototype_type(&p, &b->ret))
+		return false;
+
+	skip_spaces(&p);
+	const char *n = p;
+	while (is_name_char(*p))
+		p++;
+	if (p == n || p - n > UINT8_MAX)
+		return false;
+	if (name) {
+		*name = n;
+		*name_len = p - n;
+	}
+
+	skip_spaces(&p);
+	if (*p++ != '(')
+		return false;
+
+	b->nargs = 0;
+	skip_spaces(&p);
+	if (*p == ')')
+		return true;
+
+	for (;;) {
+		uint8_t kind;
+
+		if (!prototype_type(&p, &kind))
+			return false;
+		skip_spaces(&p);
+		if (kind == KIND_VOID)
+			return b->nargs == 0 && *p == ')';
+		if (b->nargs >= MAX_ARGS)
+			return false;
+		b->arg[b->nargs++] = kind;
+
+		// optional parameter name
+		while (is_name_char(*p))
+			p++;
+		skip_spaces(&p);
+
+		if (*p == ')')
+			return true;
+		// pointers and variable arguments end up here
+		if (*p++ != ',')
+			return false;
+	}
+}
+
+/**
+ * find a scalar library function by name
+ * @return its index counted over all libraries, -1 if there is none
+ */
+static int32_t find_native(const struct LibraryFunction *const *libs, const char *name, uint8_t len, struct bc_binding *b)
+{
+	int32_t index = 0;
+
+	for (int l = 0; libs[l] != NULL; l++) {
+		for (int k = 0; libs[l][k].Func != NULL; k++, index++) {
+			const char *n;
+			uint8_t n_len;
+
+			if (parse_prototype(libs[l][k].Prototype, b, &n, &n_len) &&
+					n_len == len && strncmp(n, name, len) == 0) {
+				b->func = libs[l][k].Func;
+				return index;
+			}
+		}
+	}
+	return -1;
+}
+
+static bool resolve_native(const struct LibraryFunction *const *libs, uint32_t index, struct bc_binding *b)
+{
+	for (int l = 0; libs[l] != NULL; l++) {
+		for (int k = 0; libs[l][k].Func != NULL; k++) {
+			if (index-- == 0) {
+				b->func = libs[l][k].Func;
+				return parse_prototype(libs[l][k].Prototype, b, NULL, NULL);
+			}
+		}
+	}
+	return false;
+}
+
+static uint8_t kind_type(uint8_t kind)
+{
+	switch (kind) {
+	case KIND_VOID:
+		return TYPE_VOID;
+	case KIND_FP:
+		return TYPE_FLOAT;
+	default:
+		return TYPE_INT;
+	}
+}
+
+/**
+ * scanner
+ */
+static void fail(struct bc_compiler *c)
+{
+	longjmp(c->fail, 1);
+}
+
+static void overflow(struct bc_compiler *c)
+{
+	c->error = PICOC_BC_ERR_SIZE;
+	longjmp(c->fail, 1);
+}
+
+static const struct {
+	const char *word;
+	enum LexToken token;
+} keywords[] = {
+	{ "int", TokenIntType },
+	{ "long", TokenLongType },
+	{ "float", TokenFloatType },
+	{ "double", TokenDoubleType },
+	{ "void", TokenVoidType },
+	{ "if", TokenIf },
+	{ "else", TokenElse },
+	{ "while", TokenWhile },
+	{ "do", TokenDo },
+	{ "for", TokenFor },
+	{ "break", TokenBreak },
+	{ "continue", TokenContinue },
+	{ "return", TokenReturn },
+};
+
+/* longest first, so the first match is the right one */
+static const struct {
+	const char *text;
+	enum LexToken token;
+} punctuators[] = {
+	{ "<<=", TokenShiftLeftAssign }, { ">>=", TokenShiftRightAssign },
+	{ "+=", TokenAddAssign }, { "-=", TokenSubtractAssign }, { "*=", TokenMultiplyAssign },
+	{ "/=", TokenDivideAssign }, { "%=", TokenModulusAssign }, { "&=", TokenArithmeticAndAssign },
+	{ "|=", TokenArithmeticOrAssign }, { "^=", TokenArithmeticExorAssign },
+	{ "==", TokenEqual }, { "!=", TokenNotEqual }, { "<=", TokenLessEqual }, { ">=", TokenGreaterEqual },
+	{ "<<", TokenShiftLeft }, { ">>", TokenShiftRight }, { "&&", TokenLogicalAnd }, { "||", TokenLogicalOr },
+	{ "++", TokenIncrement }, { "--", TokenDecrement }, { "->", TokenArrow },
+	{ "+", TokenPlus }, { "-", TokenMinus }, { "*", TokenAsterisk }, { "/", TokenSlash },
+	{ "%", TokenModulus }, { "<", TokenLessThan }, { ">", TokenGreaterThan }, { "=", TokenAssign },
+	{ "!", TokenUnaryNot }, { "~", TokenUnaryExor }, { "&", TokenAmpersand }, { "|", TokenArithmeticOr },
+	{ "^", TokenArithmeticExor }, { "?", TokenQuestionMark }, { ":", TokenColon }, { ",", TokenComma },
+	{ ";", TokenSemicolon }, { "(", TokenOpenBracket }, { ")", TokenCloseBracket },
+	{ "{", TokenLeftBrace }, { "}", TokenRightBrace }, { "[", TokenLeftSquareBracket },
+	{ "]", TokenRightSquareBracket }, { ".", TokenDot },
+};
+
+static const char *scan_number(struct bc_compiler *c, const char *p)
+{
+	struct bc_token *t = &c->tok;
+	uint32_t base = 10;
+	uint32_t value = 0;
+	double fp = 0;
+
+	if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+		base = 16;
+		p += 2;
+	} else if (p[0] == '0' && is_digit(p[1])) {
+		base = 8;
+	}
+
+	for (;; p++) {
+		uint32_t digit;
+
+		if (is_digit(*p))
+			digit = *p - '0';
+		else if (base == 16 && *p >= 'a' && *p <= 'f')
+			digit = *p - 'a' + 10;
+		else if (base == 16 && *p >= 'A' && *p <= 'F')
+			digit = *p - 'A' + 10;
+		else
+			break;
+
+		if (digit >= base)
+			fail(c);
+		value = value * base + digit;
+		fp = fp * base + digit;
+	}
+
+	if (base != 16 && (*p == '.' || *p == 'e' || *p == 'E')) {
+#ifdef NO_FP
+		fail(c);
+#else
+		double scale = 1;
+		if (*p == '.') {
+			for (p++; is_digit(*p); p++) {
+				scale /= 10;
+				fp += (*p - '0') * scale;
+			}
+		}
+		if (*p == 'e' || *p == 'E') {
+			int32_t sign = 1;
+			int32_t exponent = 0;
+
+			p++;
+			if (*p == '-' || *p == '+')
+				sign = (*p++ == '-') ? -1 : 1;
+			if (!is_digit(*p))
+				fail(c);
+			while (is_digit(*p))
+				exponent = exponent * 10 + (*p++ - '0');
+			fp *= pow(10, sign * exponent);
+		}
+		if (*p == 'f' || *p == 'F')
+			p++;
+
+		t->type = TokenFPConstant;
+		t->value.f = fp;
+#endif
+	} else {
+		while (*p == 'u' || *p == 'U' || *p == 'l' || *p == 'L')
+			p++;
+
+		t->type = TokenIntegerConstant;
+		t->value.i = value;
+	}
+	return p;
+}
+
+static const char *scan_character(struct bc_compiler *c, const char *p)
+{
+	char ch = *++p;
+
+	if (ch == '\\') {
+		switch (*++p) {
+		case 'n': ch = '\n'; break;
+		case 't': ch = '\t'; break;
+		case 'r': ch = '\r'; break;
+		case '0': ch = '\0'; break;
+		case '\\': ch = '\\'; break;
+		case '\'': ch = '\''; break;
+		default: fail(c);
+		}
+	} else if (ch == '\0' || ch == '\'') {
+		fail(c);
+	}
+
+	if (*++p != '\'')
+		fail(c);
+
+	c->tok.type = TokenIntegerConstant;
+	c->tok.value.i = ch;
+	return p + 1;
+}
+
+//! Read the next token into c->tok
+static void scan(struct bc_compiler *c)
+{
+	struct bc_token *t = &c->tok;
+	const char *p = c->pos;
+
+	for (;;) {
+		if (*p == '\n') {
+			c->line++;
+			p++;
+		} else if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\f' || *p == '\v') {
+			p++;
+		} else if (p[0] == '/' && p[1] == '/') {
+			while (*p != '\0' && *p != '\n')
+				p++;
+		} else if (p[0] == '/' && p[1] == '*') {
+			for (p += 2; !(p[0] == '*' && p[1] == '/'); p++) {
+				if (*p == '\0')
+					fail(c);
+				if (*p == '\n')
+					c->line++;
+			}
+			p += 2;
+		} else if (*p == '#') {
+			// all libraries are visible anyway, any other directive is not handled
+			if (strncmp(p, "#include", 8) != 0)
+				fail(c);
+			while (*p != '\0' && *p != '\n')
+				p++;
+		} else {
+			break;
+		}
+	}
+
+	t->start = p;
+	t->line = c->line;
+
+	if (*p == '\0') {
+		t->type = TokenEOF;
+	} else if (is_name_start(*p)) {
+		while (is_name_char(*p))
+			p++;
+
+		t->type = TokenIdentifier;
+		for (uint32_t i = 0; i < NELEMENTS(keywords); i++) {
+			if (word_is(t->start, p - t->start, keywords[i].word)) {
+				t->type = keywords[i].token;
+				break;
+			}
+		}
+	} else if (is_digit(*p) || (*p == '.' && is_digit(p[1]))) {
+		p = scan_number(c, p);
+	} else if (*p == '\'') {
+		p = scan_character(c, p);
+	} else {
+		uint32_t i;
+		for (i = 0; i < NELEMENTS(punctuators); i++) {
+			uint32_t len = strlen(punctuators[i].text);
+			if (strncmp(p, punctuators[i].text, len) == 0) {
+				t->type = punctuators[i].token;
+				p += len;
+				break;
+			}
+		}
+		// strings and anything else we do not know
+		if (i == NELEMENTS(punctuators))
+			fail(c);
+	}
+
+	if (p - t->start > UINT8_MAX && t->type == TokenIdentifier)
+		fail(c);
+
+	t->len = p - t->start;
+	c->pos = p;
+}
+
+static void mark(struct bc_compiler *c, struct bc_position *position)
+{
+	position->pos = c->pos;
+	position->line = c->line;
+	position->tok = c->tok;
+}
+
+static void restore(struct bc_compiler *c, const struct bc_position *position)
+{
+	c->pos = position->pos;
+	c->line = position->line;
+	c->tok = position->tok;
+}
+
+//! Type of the token n places after the current one
+static enum LexToken peek(struct bc_compiler *c, int n)
+{
+	struct bc_position here;
+
+	mark(c, &here);
+	while (n-- > 0)
+		scan(c);
+
+	enum LexToken type = c->tok.type;
+	restore(c, &here);
+	return type;
+}
+
+static bool accept(struct bc_compiler *c, enum LexToken type)
+{
+	if (c->tok.type != type)
+		return false;
+
+	scan(c);
+	return true;
+}
+
+static void expect(struct bc_compiler *c, enum LexToken type)
+{
+	if (!accept(c, type))
+		fail(c);
+}
+
+//! Step over tokens up to the given one outside of any brackets, leaving it current
+static void skip_to(struct bc_compiler *c, enum LexToken end)
+{
+	int32_t depth = 0;
+
+	while (depth > 0 || c->tok.type != end) {
+		if (c->tok.type == TokenEOF)
+			fail(c);
+		if (c->tok.type == TokenOpenBracket)
+			depth++;
+		if (c->tok.type == TokenCloseBracket && --depth < 0)
+			fail(c);
+		scan(c);
+	}
+}
+
+/**
+ * code generation
+ */
+static void adjust_depth(struct bc_compiler *c, int32_t change)
+{
+	c->depth += change;
+	if (c->depth > c->max_depth)
+		c->max_depth = c->depth;
+}
+
+static uint32_t emit(struct bc_compiler *c, enum bc_op op, int32_t arg)
+{
+	if (c->code_len >= c->code_max)
+		overflow(c);
+	if (arg < ARG_MIN || arg > ARG_MAX)
+		fail(c);
+
+	c->code[c->code_len] = INSN(op, arg);
+	adjust_depth(c, op_effect[op]);
+	return c->code_len++;
+}
+
+static void emit_word(struct bc_compiler *c, uint32_t word)
+{
+	if (c->code_len >= c->code_max)
+		overflow(c);
+
+	c->code[c->code_len++] = word;
+}
+
+static void patch(struct bc_compiler *c, uint32_t at, int32_t arg)
+{
+	c->code[at] = INSN(INSN_OP(c->code[at]), arg);
+}
+
+static void emit_int(struct bc_compiler *c, int32_t value)
+{
+	if (value >= ARG_MIN && value <= ARG_MAX) {
+		emit(c, OP_PUSH, value);
+	} else {
+		emit(c, OP_PUSHW, 0);
+		emit_word(c, value);
+	}
+}
+
+static void emit_float(struct bc_compiler *c, float value)
+{
+	union picoc_bc_cell cell = { .f = value };
+
+	emit(c, OP_PUSHW, 0);
+	emit_word(c, cell.i);
+}
+
+static void jump_add(struct bc_compiler *c, struct bc_jumps *jumps, enum bc_op op)
+{
+	if (jumps->count >= MAX_JUMPS)
+		overflow(c);
+
+	jumps->at[jumps->count++] = emit(c, op, 0);
+}
+
+static void jump_resolve(struct bc_compiler *c, const struct bc_jumps *jumps, uint32_t target)
+{
+	for (int i = 0; i < jumps->count; i++)
+		patch(c, jumps->at[i], target);
+}
+
+//! Convert the value depth entries below the top of the stack between types
+static void convert(struct bc_compiler *c, uint8_t from, uint8_t to, int32_t depth)
+{
+	if (from == TYPE_VOID || to == TYPE_VOID)
+		fail(c);
+
+	if (from == TYPE_INT && to == TYPE_FLOAT)
+		emit(c, OP_I2F, depth);
+	else if (from == TYPE_FLOAT && to == TYPE_INT)
+		emit(c, OP_F2I, depth);
+}
+
+//! Turn the value on top of the stack into an int that is zero for false
+static void truth(struct bc_compiler *c, uint8_t type)
+{
+	if (type == TYPE_FLOAT) {
+		emit_float(c, 0);
+		emit(c, OP_NEF, 0);
+	} else if (type != TYPE_INT) {
+		fail(c);
+	}
+}
+
+/**
+ * names
+ */
+static bool name_is(const char *name, uint8_t len, const struct bc_token *t)
+{
+	return len == t->len && strncmp(name, t->start, len) == 0;
+}
+
+static struct bc_symbol *find_symbol(struct bc_compiler *c, const struct bc_token *t)
+{
+	// innermost scope first
+	for (int i = c->num_symbols - 1; i >= 0; i--) {
+		if (name_is(c->symbols[i].name, c->symbols[i].len, t))
+			return &c->symbols[i];
+	}
+	return NULL;
+}
+
+static struct bc_symbol *variable(struct bc_compiler *c, const struct bc_token *t)
+{
+	struct bc_symbol *s = find_symbol(c, t);
+
+	if (s == NULL)
+		fail(c);
+	return s;
+}
+
+static struct bc_symbol *declare(struct bc_compiler *c, const struct bc_token *t, uint8_t type)
+{
+	if (t->type != TokenIdentifier || type == TYPE_VOID)
+		fail(c);
+	if (c->num_symbols >= MAX_SYMBOLS)
+		overflow(c);
+
+	struct bc_symbol *s = &c->symbols[c->num_symbols++];
+	s->name = t->start;
+	s->len = t->len;
+	s->type = type;
+	s->global = (c->function == NULL);
+	s->slot = s->global ? c->num_globals++ : c->num_locals++;
+
+	if (s->slot == UINT16_MAX)
+		overflow(c);
+	return s;
+}
+
+static struct bc_function *find_function(struct bc_compiler *c, const struct bc_token *t)
+{
+	for (int i = 0; i < c->num_functions; i++) {
+		if (name_is(c->functions[i].name, c->functions[i].len, t))
+			return &c->functions[i];
+	}
+	return NULL;
+}
+
+static void load(struct bc_compiler *c, const struct bc_symbol *s)
+{
+	emit(c, s->global ? OP_LDG : OP_LDL, s->slot);
+}
+
+static void store(struct bc_compiler *c, const struct bc_symbol *s)
+{
+	emit(c, s->global ? OP_STG : OP_STL, s->slot);
+}
+
+//! Leave the variable plus delta on the stack
+static void increment(struct bc_compiler *c, const struct bc_symbol *s, int32_t delta)
+{
+	load(c, s);
+	if (s->type == TYPE_FLOAT) {
+		emit_float(c, delta);
+		emit(c, OP_ADDF, 0);
+	} else {
+		emit(c, OP_PUSH, delta);
+		emit(c, OP_ADDI, 0);
+	}
+}
+
+static bool is_type(enum LexToken t)
+{
+	return t == TokenIntType || t == TokenLongType || t == TokenFloatType ||
+		t == TokenDoubleType || t == TokenVoidType;
+}
+
+static uint8_t type_name(struct bc_compiler *c)
+{
+	switch (c->tok.type) {
+	case TokenIntType:
+		scan(c);
+		return TYPE_INT;
+	case TokenLongType:
+		scan(c);
+		accept(c, TokenIntType);
+		return TYPE_INT;
+	case TokenFloatType:
+	case TokenDoubleType:
+#ifdef NO_FP
+		fail(c);
+#endif
+		scan(c);
+		return TYPE_FLOAT;
+	case TokenVoidType:
+		scan(c);
+		return TYPE_VOID;
+	default:
+		fail(c);
+		return TYPE_VOID;
+	}
+}
+
+/**
+ * expressions, each returns the type of the value it leaves on the stack
+ */
+static const struct {
+	enum LexToken token;
+	uint8_t int_op;
+	uint8_t float_op;	/* OP_NOP for integer only operators */
+} binary_ops[] = {
+	{ TokenPlus, OP_ADDI, OP_ADDF },
+	{ TokenMinus, OP_SUBI, OP_SUBF },
+	{ TokenAsterisk, OP_MULI, OP_MULF },
+	{ TokenSlash, OP_DIVI, OP_DIVF },
+	{ TokenModulus, OP_MODI, OP_NOP },
+	{ TokenAmpersand, OP_ANDI, OP_NOP },
+	{ TokenArithmeticOr, OP_ORI, OP_NOP },
+	{ TokenArithmeticExor, OP_XORI, OP_NOP },
+	{ TokenShiftLeft, OP_SHLI, OP_NOP },
+	{ TokenShiftRight, OP_SHRI, OP_NOP },
+	{ TokenEqual, OP_EQI, OP_EQF },
+	{ TokenNotEqual, OP_NEI, OP_NEF },
+	{ TokenLessThan, OP_LTI, OP_LTF },
+	{ TokenLessEqual, OP_LEI, OP_LEF },
+	{ TokenGreaterThan, OP_GTI, OP_GTF },
+	{ TokenGreaterEqual, OP_GEI, OP_GEF },
+};
+
+static uint8_t precedence(enum LexToken t)
+{
+	switch (t) {
+	case TokenArithmeticOr:
+		return 1;
+	case TokenArithmeticExor:
+		return 2;
+	case TokenAmpersand:
+		return 3;
+	case TokenEqual:
+	case TokenNotEqual:
+		return 4;
+	case TokenLessThan:
+	case TokenLessEqual:
+	case TokenGreaterThan:
+	case TokenGreaterEqual:
+		return 5;
+	case TokenShiftLeft:
+	case TokenShiftRight:
+		return 6;
+	case TokenPlus:
+	case TokenMinus:
+		return 7;
+	case TokenAsterisk:
+	case TokenSlash:
+	case TokenModulus:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+static enum LexToken compound_operator(enum LexToken t)
+{
+	switch (t) {
+	case TokenAddAssign: return TokenPlus;
+	case TokenSubtractAssign: return TokenMinus;
+	case TokenMultiplyAssign: return TokenAsterisk;
+	case TokenDivideAssign: return TokenSlash;
+	case TokenModulusAssign: return TokenModulus;
+	case TokenShiftLeftAssign: return TokenShiftLeft;
+	case TokenShiftRightAssign: return TokenShiftRight;
+	case TokenArithmeticAndAssign: return TokenAmpersand;
+	case TokenArithmeticOrAssign: return TokenArithmeticOr;
+	case TokenArithmeticExorAssign: return TokenArithmeticExor;
+	default: return TokenNone;
+	}
+}
+
+//! Apply a binary operator to the two values on top of the stack
+static uint8_t binary(struct bc_compiler *c, enum LexToken op, uint8_t left, uint8_t right)
+{
+	uint32_t i;
+
+	for (i = 0; i < NELEMENTS(binary_ops); i++) {
+		if (binary_ops[i].token == op)
+			break;
+	}
+	if (i == NELEMENTS(binary_ops) || left == TYPE_VOID || right == TYPE_VOID)
+		fail(c);
+
+	if (left == TYPE_FLOAT || right == TYPE_FLOAT) {
+		if (binary_ops[i].float_op == OP_NOP)
+			fail(c);
+
+		convert(c, left, TYPE_FLOAT, 1);
+		convert(c, right, TYPE_FLOAT, 0);
+		emit(c, binary_ops[i].float_op, 0);
+		return (op >= TokenEqual && op <= TokenGreaterEqual) ? TYPE_INT : TYPE_FLOAT;
+	}
+
+	emit(c, binary_ops[i].int_op, 0);
+	return TYPE_INT;
+}
+
+static void arguments(struct bc_compiler *c, const uint8_t *types, uint8_t nargs)
+{
+	expect(c, TokenOpenBracket);
+	for (int i = 0; i < nargs; i++) {
+		if (i > 0)
+			expect(c, TokenComma);
+		convert(c, expression(c), types[i], 0);
+	}
+	expect(c, TokenCloseBracket);
+}
+
+static uint8_t call(struct bc_compiler *c, const struct bc_token *name)
+{
+	struct bc_function *f = find_function(c, name);
+
+	if (f != NULL) {
+		arguments(c, f->arg, f->nargs);
+
+		uint32_t at = emit(c, OP_CALL, (f->addr < 0 ? 0 : f->addr) | (f->nargs << 16));
+		adjust_depth(c, (f->ret != TYPE_VOID) - f->nargs);
+		if (f->addr < 0) {
+			if (c->num_fixups >= MAX_FIXUPS)
+				overflow(c);
+			c->fixups[c->num_fixups].at = at;
+			c->fixups[c->num_fixups].function = f - c->functions;
+			c->num_fixups++;
+		}
+		return f->ret;
+	}
+
+	if (name_is("exit", 4, name)) {
+		const uint8_t types[] = { TYPE_INT };
+
+		arguments(c, types, 1);
+		emit(c, OP_EXIT, 0);
+		return TYPE_VOID;
+	}
+
+	struct bc_binding b;
+	uint8_t types[MAX_ARGS];
+	int32_t index = find_native(c->libs, name->start, name->len, &b);
+	uint8_t slot;
+
+	if (index < 0)
+		fail(c);
+
+	for (int i = 0; i < b.nargs; i++)
+		types[i] = kind_type(b.arg[i]);
+	arguments(c, types, b.nargs);
+
+	for (slot = 0; slot < c->num_natives && c->natives[slot] != index; slot++)
+		;
+	if (slot == c->num_natives) {
+		if (c->num_natives >= MAX_NATIVES)
+			overflow(c);
+		c->natives[c->num_natives++] = index;
+	}
+
+	emit(c, OP_NATIVE, slot);
+	adjust_depth(c, (b.ret != KIND_VOID) - b.nargs);
+	return kind_type(b.ret);
+}
+
+static uint8_t primary(struct bc_compiler *c)
+{
+	const struct bc_token t = c->tok;
+	uint8_t type;
+
+	switch (t.type) {
+	case TokenIntegerConstant:
+		scan(c);
+		emit_int(c, t.value.i);
+		return TYPE_INT;
+	case TokenFPConstant:
+		scan(c);
+		emit_float(c, t.value.f);
+		return TYPE_FLOAT;
+	case TokenOpenBracket:
+		scan(c);
+		type = expression(c);
+		expect(c, TokenCloseBracket);
+		return type;
+	case TokenIdentifier:
+		scan(c);
+		if (c->tok.type == TokenOpenBracket)
+			return call(c, &t);
+
+		const struct bc_symbol *s = variable(c, &t);
+		load(c, s);
+		if (c->tok.type == TokenIncrement || c->tok.type == TokenDecrement) {
+			// the old value stays below the updated one
+			increment(c, s, (c->tok.type == TokenIncrement) ? 1 : -1);
+			scan(c);
+			store(c, s);
+		}
+		return s->type;
+	default:
+		fail(c);
+		return TYPE_VOID;
+	}
+}
+
+static uint8_t unary(struct bc_compiler *c)
+{
+	uint8_t type;
+	uint32_t start;
+
+	switch (c->tok.type) {
+	case TokenMinus:
+		scan(c);
+		start = c->code_len;
+		type = unary(c);
+
+		// fold negative constants
+		if (c->code_len == start + 1 && INSN_OP(c->code[start]) == OP_PUSH) {
+			patch(c, start, -INSN_ARG(c->code[start]));
+		} else if (c->code_len == start + 2 && INSN_OP(c->code[start]) == OP_PUSHW) {
+			c->code[start + 1] = (type == TYPE_FLOAT) ? c->code[start + 1] ^ 0x80000000u : 0u - c->code[start + 1];
+		} else if (type == TYPE_FLOAT) {
+			emit(c, OP_NEGF, 0);
+		} else if (type == TYPE_INT) {
+			emit(c, OP_NEGI, 0);
+		} else {
+			fail(c);
+		}
+		return type;
+	case TokenPlus:
+		scan(c);
+		type = unary(c);
+		if (type == TYPE_VOID)
+			fail(c);
+		return type;
+	case TokenUnaryNot:
+		scan(c);
+		type = unary(c);
+		if (type == TYPE_FLOAT) {
+			emit_float(c, 0);
+			emit(c, OP_EQF, 0);
+		} else if (type == TYPE_INT) {
+			emit(c, OP_LNOT, 0);
+		} else {
+			fail(c);
+		}
+		return TYPE_INT;
+	case TokenUnaryExor:
+		scan(c);
+		if (unary(c) != TYPE_INT)
+			fail(c);
+		emit(c, OP_NOTI, 0);
+		return TYPE_INT;
+	case TokenIncrement:
+	case TokenDecrement:
+	{
+		int32_t delta = (c->tok.type == TokenIncrement) ? 1 : -1;
+
+		scan(c);
+		const struct bc_symbol *s = variable(c, &c->tok);
+		scan(c);
+		increment(c, s, delta);
+		emit(c, OP_DUP, 0);
+		store(c, s);
+		return s->type;
+	}
+	case TokenOpenBracket:
+		if (is_type(peek(c, 1))) {
+			scan(c);
+			uint8_t to = type_name(c);
+			expect(c, TokenCloseBracket);
+			convert(c, unary(c), to, 0);
+			return to;
+		}
+		return primary(c);
+	default:
+		return primary(c);
+	}
+}
+
+static uint8_t binary_expression(struct bc_compiler *c, uint8_t min_precedence)
+{
+	uint8_t left = unary(c);
+
+	for (;;) {
+		enum LexToken op = c->tok.type;
+		uint8_t prec = precedence(op);
+
+		if (prec == 0 || prec < min_precedence)
+			return left;
+
+		scan(c);
+		uint8_t right = binary_expression(c, prec + 1);
+		left = binary(c, op, left, right);
+	}
+}
+
+static uint8_t logical_and(struct bc_compiler *c)
+{
+	struct bc_jumps to_false = { .count = 0 };
+	uint8_t type = binary_expression(c, 1);
+
+	if (c->tok.type != TokenLogicalAnd)
+		return type;
+
+	truth(c, type);
+	jump_add(c, &to_false, OP_JZ);
+	while (accept(c, TokenLogicalAnd)) {
+		truth(c, binary_expression(c, 1));
+		jump_add(c, &to_false, OP_JZ);
+	}
+
+	emit(c, OP_PUSH, 1);
+	uint32_t to_end = emit(c, OP_JMP, 0);
+	adjust_depth(c, -1);
+	jump_resolve(c, &to_false, c->code_len);
+	emit(c, OP_PUSH, 0);
+	patch(c, to_end, c->code_len);
+	return TYPE_INT;
+}
+
+static uint8_t logical_or(struct bc_compiler *c)
+{
+	struct bc_jumps to_true = { .count = 0 };
+	uint8_t type = logical_and(c);
+
+	if (c->tok.type != TokenLogicalOr)
+		return type;
+
+	truth(c, type);
+	jump_add(c, &to_true, OP_JNZ);
+	while (accept(c, TokenLogicalOr)) {
+		truth(c, logical_and(c));
+		jump_add(c, &to_true, OP_JNZ);
+	}
+
+	emit(c, OP_PUSH, 0);
+	uint32_t to_end = emit(c, OP_JMP, 0);
+	adjust_depth(c, -1);
+	jump_resolve(c, &to_true, c->code_len);
+	emit(c, OP_PUSH, 1);
+	patch(c, to_end, c->code_len);
+	return TYPE_INT;
+}
+
+static uint8_t conditional(struct bc_compiler *c)
+{
+	uint8_t type = logical_or(c);
+
+	if (!accept(c, TokenQuestionMark))
+		return type;
+
+	truth(c, type);
+	uint32_t to_else = emit(c, OP_JZ, 0);
+	uint8_t first = expression(c);
+	// becomes a conversion if the other branch turns out to be float
+	uint32_t first_convert = emit(c, OP_NOP, 0);
+	uint32_t to_end = emit(c, OP_JMP, 0);
+	expect(c, TokenColon);
+
+	adjust_depth(c, -1);
+	patch(c, to_else, c->code_len);
+	uint8_t second = conditional(c);
+
+	if (first == TYPE_VOID || second == TYPE_VOID)
+		fail(c);
+	if (first != second) {
+		if (first == TYPE_INT)
+			c->code[first_convert] = INSN(OP_I2F, 0);
+		else
+			convert(c, second, TYPE_FLOAT, 0);
+		first = TYPE_FLOAT;
+	}
+	patch(c, to_end, c->code_len);
+	return first;
+}
+
+/**
+ * assignments leave their value on the stack unless it is discarded,
+ * in which case they return TYPE_VOID
+ */
+static uint8_t assignment(struct bc_compiler *c, bool discard)
+{
+	if (c->tok.type == TokenIdentifier) {
+		enum LexToken op = peek(c, 1);
+
+		if (op >= TokenAssign && op <= TokenArithmeticExorAssign) {
+			const struct bc_symbol *s = variable(c, &c->tok);
+			uint8_t type;
+
+			scan(c);
+			scan(c);
+			if (op == TokenAssign) {
+				type = assignment(c, false);
+			} else {
+				load(c, s);
+				uint8_t right = assignment(c, false);
+				type = binary(c, compound_operator(op), s->type, right);
+			}
+			convert(c, type, s->type, 0);
+
+			if (!discard)
+				emit(c, OP_DUP, 0);
+			store(c, s);
+			return discard ? TYPE_VOID : s->type;
+		}
+	}
+	return conditional(c);
+}
+
+static uint8_t expression(struct bc_compiler *c)
+{
+	return assignment(c, false);
+}
+
+/**
+ * statements
+ */
+static bool ends_expression(enum LexToken t)
+{
+	return t == TokenSemicolon || t == TokenCloseBracket;
+}
+
+static void expression_statement(struct bc_compiler *c)
+{
+	const struct bc_symbol *s = NULL;
+	int32_t delta = 0;
+
+	// a lone increment of an int is a single instruction
+	if (c->tok.type == TokenIdentifier && ends_expression(peek(c, 2))) {
+		enum LexToken op = peek(c, 1);
+		if (op == TokenIncrement || op == TokenDecrement) {
+			s = find_symbol(c, &c->tok);
+			delta = (op == TokenIncrement) ? 1 : -1;
+		}
+	} else if ((c->tok.type == TokenIncrement || c->tok.type == TokenDecrement) &&
+			peek(c, 1) == TokenIdentifier && ends_expression(peek(c, 2))) {
+		struct bc_position here;
+
+		delta = (c->tok.type == TokenIncrement) ? 1 : -1;
+		mark(c, &here);
+		scan(c);
+		s = find_symbol(c, &c->tok);
+		restore(c, &here);
+	}
+
+	if (s != NULL && s->type == TYPE_INT) {
+		emit(c, s->global ? OP_INCG : OP_INCL, s->slot | (delta < 0 ? INC_DOWN : 0));
+		scan(c);
+		scan(c);
+		return;
+	}
+
+	if (assignment(c, true) != TYPE_VOID)
+		emit(c, OP_POP, 0);
+}
+
+//! Compile a condition that jumps to target when it holds
+static void branch(struct bc_compiler *c, uint32_t target)
+{
+	uint32_t start = c->code_len;
+
+	truth(c, expression(c));
+
+	// constant conditions like while (1)
+	if (c->code_len == start + 1 && INSN_OP(c->code[start]) == OP_PUSH) {
+		bool taken = INSN_ARG(c->code[start]) != 0;
+
+		c->code_len = start;
+		adjust_depth(c, -1);
+		if (taken)
+			emit(c, OP_JMP, target);
+		return;
+	}
+	emit(c, OP_JNZ, target);
+}
+
+static void loop_statement(struct bc_compiler *c, struct bc_loop *loop)
+{
+	loop->outer = c->loop;
+	loop->breaks.count = 0;
+	loop->continues.count = 0;
+
+	c->loop = loop;
+	statement(c);
+	c->loop = loop->outer;
+}
+
+static void declaration(struct bc_compiler *c)
+{
+	uint8_t type = type_name(c);
+
+	do {
+		const struct bc_symbol *s = declare(c, &c->tok, type);
+
+		scan(c);
+		if (accept(c, TokenAssign)) {
+			convert(c, expression(c), type, 0);
+		} else {
+			// int 0 and float 0.0 share their bits
+			emit(c, OP_PUSH, 0);
+		}
+		store(c, s);
+	} while (accept(c, TokenComma));
+
+	expect(c, TokenSemicolon);
+}
+
+static void block(struct bc_compiler *c)
+{
+	uint8_t num_symbols = c->num_symbols;
+
+	expect(c, TokenLeftBrace);
+	while (!accept(c, TokenRightBrace)) {
+		if (c->tok.type == TokenEOF)
+			fail(c);
+		statement(c);
+	}
+	c->num_symbols = num_symbols;
+}
+
+static void if_statement(struct bc_compiler *c)
+{
+	scan(c);
+	expect(c, TokenOpenBracket);
+	truth(c, expression(c));
+	expect(c, TokenCloseBracket);
+
+	uint32_t to_else = emit(c, OP_JZ, 0);
+	statement(c);
+
+	if (accept(c, TokenElse)) {
+		uint32_t to_end = emit(c, OP_JMP, 0);
+		patch(c, to_else, c->code_len);
+		statement(c);
+		patch(c, to_end, c->code_len);
+	} else {
+		patch(c, to_else, c->code_len);
+	}
+}
+
+/* Loops test their condition at the bottom, so each iteration takes a single
+ * branch. The condition is compiled after the body by rewinding the scanner. */
+static void while_statement(struct bc_compiler *c)
+{
+	struct bc_position condition, after;
+	struct bc_loop loop;
+
+	scan(c);
+	expect(c, TokenOpenBracket);
+	mark(c, &condition);
+	skip_to(c, TokenCloseBracket);
+	scan(c);
+
+	uint32_t to_test = emit(c, OP_JMP, 0);
+	uint32_t body = c->code_len;
+	loop_statement(c, &loop);
+	mark(c, &after);
+
+	uint32_t test = c->code_len;
+	patch(c, to_test, test);
+	restore(c, &condition);
+	branch(c, body);
+	restore(c, &after);
+
+	jump_resolve(c, &loop.continues, test);
+	jump_resolve(c, &loop.breaks, c->code_len);
+}
+
+static void do_statement(struct bc_compiler *c)
+{
+	struct bc_loop loop;
+
+	scan(c);
+	uint32_t body = c->code_len;
+	loop_statement(c, &loop);
+
+	expect(c, TokenWhile);
+	expect(c, TokenOpenBracket);
+	uint32_t test = c->code_len;
+	branch(c, body);
+	expect(c, TokenCloseBracket);
+	expect(c, TokenSemicolon);
+
+	jump_resolve(c, &loop.continues, test);
+	jump_resolve(c, &loop.breaks, c->code_len);
+}
+
+static void for_statement(struct bc_compiler *c)
+{
+	struct bc_position condition, step, after;
+	struct bc_loop loop;
+	uint8_t num_symbols = c->num_symbols;
+
+	scan(c);
+	expect(c, TokenOpenBracket);
+	if (is_type(c->tok.type)) {
+		declaration(c);
+	} else {
+		if (c->tok.type != TokenSemicolon)
+			expression_statement(c);
+		expect(c, TokenSemicolon);
+	}
+
+	mark(c, &condition);
+	skip_to(c, TokenSemicolon);
+	scan(c);
+	mark(c, &step);
+	skip_to(c, TokenCloseBracket);
+	scan(c);
+
+	uint32_t to_test = emit(c, OP_JMP, 0);
+	uint32_t body = c->code_len;
+	loop_statement(c, &loop);
+	mark(c, &after);
+
+	uint32_t next = c->code_len;
+	restore(c, &step);
+	if (c->tok.type != TokenCloseBracket)
+		expression_statement(c);
+
+	uint32_t test = c->code_len;
+	patch(c, to_test, test);
+	restore(c, &condition);
+	if (c->tok.type == TokenSemicolon)
+		emit(c, OP_JMP, body);
+	else
+		branch(c, body);
+	restore(c, &after);
+
+	jump_resolve(c, &loop.continues, next);
+	jump_resolve(c, &loop.breaks, c->code_len);
+	c->num_symbols = num_symbols;
+}
+
+static void jump_statement(struct bc_compiler *c)
+{
+	if (c->loop == NULL)
+		fail(c);
+
+	jump_add(c, (c->tok.type == TokenBreak) ? &c->loop->breaks : &c->loop->continues, OP_JMP);
+	scan(c);
+	expect(c, TokenSemicolon);
+}
+
+static void return_statement(struct bc_compiler *c)
+{
+	const struct bc_function *f = c->function;
+
+	if (f == NULL)
+		fail(c);
+
+	scan(c);
+	if (f->ret == TYPE_VOID) {
+		emit(c, OP_RETV, 0);
+	} else {
+		convert(c, expression(c), f->ret, 0);
+		emit(c, OP_RET, 0);
+	}
+	expect(c, TokenSemicolon);
+}
+
+static void statement(struct bc_compiler *c)
+{
+	switch (c->tok.type) {
+	case TokenLeftBrace:
+		block(c);
+		break;
+	case TokenIf:
+		if_statement(c);
+		break;
+	case TokenWhile:
+		while_statement(c);
+		break;
+	case TokenDo:
+		do_statement(c);
+		break;
+	case TokenFor:
+		for_statement(c);
+		break;
+	case TokenBreak:
+	case TokenContinue:
+		jump_statement(c);
+		break;
+	case TokenReturn:
+		return_statement(c);
+		break;
+	case TokenSemicolon:
+		scan(c);
+		break;
+	case TokenIntType:
+	case TokenLongType:
+	case TokenFloatType:
+	case TokenDoubleType:
+		declaration(c);
+		break;
+	default:
+		expression_statement(c);
+		expect(c, TokenSemicolon);
+	}
+}
+
+/**
+ * functions and the whole program
+ */
+static void function_definition(struct bc_compiler *c)
+{
+	struct bc_function proto = { .addr = -1 };
+	struct bc_token params[MAX_ARGS];
+
+	proto.ret = type_name(c);
+	if (c->tok.type != TokenIdentifier)
+		fail(c);
+	const struct bc_token name = c->tok;
+	proto.name = name.start;
+	proto.len = name.len;
+	scan(c);
+
+	expect(c, TokenOpenBracket);
+	if (c->tok.type == TokenVoidType && peek(c, 1) == TokenCloseBracket)
+		scan(c);
+	while (!accept(c, TokenCloseBracket)) {
+		if (proto.nargs > 0)
+			expect(c, TokenComma);
+		if (proto.nargs >= MAX_ARGS)
+			overflow(c);
+
+		proto.arg[proto.nargs] = type_name(c);
+		params[proto.nargs] = c->tok;
+		if (c->tok.type == TokenIdentifier)
+			scan(c);
+		proto.nargs++;
+	}
+
+	struct bc_function *f = find_function(c, &name);
+	if (f == NULL) {
+		if (c->num_functions >= MAX_FUNCTIONS)
+			overflow(c);
+		f = &c->functions[c->num_functions++];
+		*f = proto;
+	} else if (f->ret != proto.ret || f->nargs != proto.nargs ||
+			memcmp(f->arg, proto.arg, proto.nargs) != 0) {
+		fail(c);
+	}
+
+	if (accept(c, TokenSemicolon))
+		return;
+	if (f->addr >= 0 || c->tok.type != TokenLeftBrace)
+		fail(c);
+
+	// the top level code jumps over the body
+	uint32_t skip = emit(c, OP_JMP, 0);
+	int32_t depth = c->depth, max_depth = c->max_depth;
+	uint8_t num_symbols = c->num_symbols;
+
+	f->addr = c->code_len;
+	c->function = f;
+	c->num_locals = 0;
+	c->depth = c->max_depth = 0;
+	for (int i = 0; i < f->nargs; i++)
+		declare(c, &params[i], f->arg[i]);
+
+	uint32_t enter = emit(c, OP_ENTER, 0);
+	emit_word(c, 0);
+	block(c);
+
+	// falling off the end returns zero
+	if (f->ret == TYPE_VOID) {
+		emit(c, OP_RETV, 0);
+	} else {
+		emit(c, OP_PUSH, 0);
+		emit(c, OP_RET, 0);
+	}
+
+	uint32_t locals = c->num_locals - f->nargs;
+	patch(c, enter, locals);
+	c->code[enter + 1] = locals + c->max_depth;
+
+	c->function = NULL;
+	c->num_symbols = num_symbols;
+	c->depth = depth;
+	c->max_depth = max_depth;
+	patch(c, skip, c->code_len);
+
+	for (int i = 0; i < c->num_fixups;) {
+		if (&c->functions[c->fixups[i].function] == f) {
+			patch(c, c->fixups[i].at, f->addr | (f->nargs << 16));
+			c->fixups[i] = c->fixups[--c->num_fixups];
+		} else {
+			i++;
+		}
+	}
+}
+
+static void program(struct bc_compiler *c)
+{
+	scan(c);
+	while (c->tok.type != TokenEOF) {
+		int name = (c->tok.type == TokenLongType && peek(c, 1) == TokenIntType) ? 2 : 1;
+
+		if (is_type(c->tok.type) && peek(c, name) == TokenIdentifier &&
+				peek(c, name + 1) == TokenOpenBracket)
+			function_definition(c);
+		else
+			statement(c);
+	}
+	emit(c, OP_HALT, 0);
+
+	// called but never defined
+	if (c->num_fixups > 0)
+		fail(c);
+}
+
+/**
+ * compile a script into a program image
+ * @param[in] source the script text
+ * @param[in] libs NULL terminated list of libraries whose scalar functions the script may call
+ * @param[out] image where to put the image, word aligned
+ * @param[in] image_size the space available for the image
+ * @param[out] error_line the line the compiler gave up on, or 0
+ * @return the size of the image or a negative picoc_bc_result
+ */
+int32_t picoc_bc_compile(const char *source, const struct LibraryFunction *const *libs,
+		void *image, uint32_t image_size, uint16_t *error_line)
+{
+	struct bc_compiler c;
+	struct picoc_bc_header *header = image;
+
+	if (error_line)
+		*error_line = 0;
+	if (image_size < sizeof(*header) || ((uintptr_t)image & 3) != 0)
+		return PICOC_BC_ERR_SIZE;
+
+	memset(&c, 0, sizeof(c));
+	c.error = PICOC_BC_ERR_COMPILE;
+	c.pos = source;
+	c.line = 1;
+	c.libs = libs;
+	c.code = (uint32_t *)(header + 1);
+	c.code_max = (image_size - sizeof(*header)) / sizeof(uint32_t);
+	if (c.code_max > MAX_CODE_WORDS)
+		c.code_max = MAX_CODE_WORDS;
+
+	if (setjmp(c.fail)) {
+		if (error_line)
+			*error_line = c.line;
+		return c.error;
+	}
+	program(&c);
+
+	uint32_t size = total_size(c.code_len, c.num_natives);
+	if (size > image_size)
+		return PICOC_BC_ERR_SIZE;
+
+	memcpy(c.code + c.code_len, c.natives, c.num_natives * sizeof(uint16_t));
+	memset((uint8_t *)(c.code + c.code_len) + c.num_natives * sizeof(uint16_t), 0,
+			size - total_size(c.code_len, 0) - c.num_natives * sizeof(uint16_t));
+
+	header->magic = PICOC_BC_MAGIC;
+	header->version = PICOC_BC_VERSION;
+	header->code_words = c.code_len;
+	header->source_hash = hash_bytes(HASH_SEED, source, strlen(source));
+	header->library_hash = library_hash(libs);
+	header->image_hash = hash_bytes(HASH_SEED, header + 1, size - sizeof(*header));
+	header->num_natives = c.num_natives;
+	header->num_globals = c.num_globals;
+	header->stack_need = c.max_depth;
+	header->reserved = 0;
+
+	return size;
+}
+
+/**
+ * @return the size of an image from its header, 0 if it is not an image
+ */
+uint32_t picoc_bc_image_size(const void *image)
+{
+	const struct picoc_bc_header *header = image;
+
+	if (header->magic != PICOC_BC_MAGIC || header->version != PICOC_BC_VERSION)
+		return 0;
+
+	return total_size(header->code_words, header->num_natives);
+}
+
+/**
+ * check an image, for example one loaded from flash, is intact and still
+ * matches the script and the libraries
+ */
+bool picoc_bc_valid(const void *image, uint32_t image_size, const char *source,
+		const struct LibraryFunction *const *libs)
+{
+	const struct picoc_bc_header *header = image;
+
+	if (image_size < sizeof(*header) || picoc_bc_image_size(image) != image_size)
+		return false;
+
+	return header->source_hash == hash_bytes(HASH_SEED, source, strlen(source)) &&
+		header->library_hash == library_hash(libs) &&
+		header->image_hash == hash_bytes(HASH_SEED, header + 1, image_size - sizeof(*header));
+}
+
+/**
+ * virtual machine
+ */
+static void kind_store(union AnyValue *v, uint8_t kind, union picoc_bc_cell cell)
+{
+	switch (kind) {
+	case KIND_CHAR: v->Character = cell.i; break;
+	case KIND_UCHAR: v->UnsignedCharacter = cell.i; break;
+	case KIND_SHORT: v->ShortInteger = cell.i; break;
+	case KIND_USHORT: v->UnsignedShortInteger = cell.i; break;
+	case KIND_INT: v->Integer = cell.i; break;
+	case KIND_UINT: v->UnsignedInteger = cell.i; break;
+	case KIND_LONG: v->LongInteger = cell.i; break;
+	case KIND_ULONG: v->UnsignedLongInteger = cell.i; break;
+#ifndef NO_FP
+	case KIND_FP: v->FP = cell.f; break;
+#endif
+	}
+}
+
+static union picoc_bc_cell kind_load(const union AnyValue *v, uint8_t kind)
+{
+	union picoc_bc_cell cell = { .i = 0 };
+
+	switch (kind) {
+	case KIND_CHAR: cell.i = v->Character; break;
+	case KIND_UCHAR: cell.i = v->UnsignedCharacter; break;
+	case KIND_SHORT: cell.i = v->ShortInteger; break;
+	case KIND_USHORT: cell.i = v->UnsignedShortInteger; break;
+	case KIND_INT: cell.i = v->Integer; break;
+	case KIND_UINT: cell.i = v->UnsignedInteger; break;
+	case KIND_LONG: cell.i = v->LongInteger; break;
+	case KIND_ULONG: cell.i = v->UnsignedLongInteger; break;
+#ifndef NO_FP
+	case KIND_FP: cell.f = v->FP; break;
+#endif
+	}
+	return cell;
+}
+
+/**
+ * call a library function the way the interpreter does
+ * @return the new top of the stack
+ */
+static union picoc_bc_cell *call_native(const struct bc_binding *b, union picoc_bc_cell *sp)
+{
+	union AnyValue args[MAX_ARGS];
+	union AnyValue result;
+	struct Value arg_values[MAX_ARGS];
+	struct Value result_value;
+	struct Value *params[MAX_ARGS];
+
+	sp -= b->nargs;
+	for (int i = 0; i < b->nargs; i++) {
+		kind_store(&args[i], b->arg[i], sp[i + 1]);
+		arg_values[i].Val = &args[i];
+		params[i] = &arg_values[i];
+	}
+
+	memset(&result, 0, sizeof(result));
+	result_value.Val = &result;
+
+	// library functions that touch the parser take pointers and are never bound
+	b->func(NULL, &result_value, params, b->nargs);
+
+	if (b->ret != KIND_VOID)
+		*++sp = kind_load(&result, b->ret);
+	return sp;
+}
+
+#define INT_BINARY(expr) do { const int32_t a = sp[-1].i, b = sp[0].i; (--sp)->i = (expr); } while (0)
+#define FLOAT_BINARY(expr) do { const float a = sp[-1].f, b = sp[0].f; (--sp)->f = (expr); } while (0)
+#define FLOAT_COMPARE(expr) do { const float a = sp[-1].f, b = sp[0].f; (--sp)->i = (expr); } while (0)
+
+/**
+ * run a program image until it ends or calls exit()
+ * @param[in] image a valid image
+ * @param[in] libs the libraries the image was compiled against
+ * @param[in] stack memory for the globals, locals and expression stack
+ * @param[in] stack_cells the size of the stack
+ * @param[out] exit_value the value passed to exit(), 0 if the program ran to the end
+ * @return a picoc_bc_result
+ */
+int32_t picoc_bc_run(const void *image, const struct LibraryFunction *const *libs,
+		union picoc_bc_cell *stack, uint32_t stack_cells, int32_t *exit_value)
+{
+	const struct picoc_bc_header *header = image;
+	const uint32_t *code = (const uint32_t *)(header + 1);
+	const uint16_t *native_index = (const uint16_t *)(code + header->code_words);
+	struct bc_binding natives[MAX_NATIVES];
+	struct bc_frame frames[MAX_CALL_DEPTH];
+
+	if (picoc_bc_image_size(image) == 0 || header->num_natives > MAX_NATIVES)
+		return PICOC_BC_ERR_IMAGE;
+
+	for (int i = 0; i < header->num_natives; i++) {
+		if (!resolve_native(libs, native_index[i], &natives[i]))
+			return PICOC_BC_ERR_IMAGE;
+	}
+
+	if ((uint32_t)header->num_globals + header->stack_need > stack_cells)
+		return PICOC_BC_ERR_STACK;
+
+	memset(stack, 0, header->num_globals * sizeof(*stack));
+
+	union picoc_bc_cell *const globals = stack;
+	union picoc_bc_cell *const stack_end = stack + stack_cells;
+	union picoc_bc_cell *fp = stack + header->num_globals;
+	union picoc_bc_cell *sp = fp - 1;
+	struct bc_frame *frame = frames;
+	const uint32_t *ip = code;
+
+	for (;;) {
+		const uint32_t insn = *ip++;
+		const int32_t arg = INSN_ARG(insn);
+
+		switch (INSN_OP(insn)) {
+		case OP_HALT:
+			*exit_value = 0;
+			return PICOC_BC_OK;
+		case OP_NOP:
+			break;
+		case OP_PUSH:
+			(++sp)->i = arg;
+			break;
+		case OP_PUSHW:
+			(++sp)->i = *ip++;
+			break;
+		case OP_POP:
+			sp--;
+			break;
+		case OP_DUP:
+			sp[1] = sp[0];
+			sp++;
+			break;
+		case OP_LDG:
+			*++sp = globals[arg];
+			break;
+		case OP_STG:
+			globals[arg] = *sp--;
+			break;
+		case OP_LDL:
+			*++sp = fp[arg];
+			break;
+		case OP_STL:
+			fp[arg] = *sp--;
+			break;
+		case OP_INCG:
+			globals[arg & 0xffff].i += (arg & INC_DOWN) ? -1 : 1;
+			break;
+		case OP_INCL:
+			fp[arg & 0xffff].i += (arg & INC_DOWN) ? -1 : 1;
+			break;
+
+		// integer arithmetic wraps like the hardware does
+		case OP_ADDI:
+			INT_BINARY((int32_t)((uint32_t)a + (uint32_t)b));
+			break;
+		case OP_SUBI:
+			INT_BINARY((int32_t)((uint32_t)a - (uint32_t)b));
+			break;
+		case OP_MULI:
+			INT_BINARY((int32_t)((uint32_t)a * (uint32_t)b));
+			break;
+		case OP_DIVI:
+			if (sp->i == 0)
+				return PICOC_BC_ERR_DIVIDE;
+			INT_BINARY((b == -1) ? (int32_t)(0u - (uint32_t)a) : a / b);
+			break;
+		case OP_MODI:
+			if (sp->i == 0)
+				return PICOC_BC_ERR_DIVIDE;
+			INT_BINARY((b == -1) ? 0 : a % b);
+			break;
+		case OP_ANDI:
+			INT_BINARY(a & b);
+			break;
+		case OP_ORI:
+			INT_BINARY(a | b);
+			break;
+		case OP_XORI:
+			INT_BINARY(a ^ b);
+			break;
+		case OP_SHLI:
+			INT_BINARY((int32_t)((uint32_t)a << (b & 31)));
+			break;
+		case OP_SHRI:
+			INT_BINARY(a >> (b & 31));
+			break;
+		case OP_EQI:
+			INT_BINARY(a == b);
+			break;
+		case OP_NEI:
+			INT_BINARY(a != b);
+			break;
+		case OP_LTI:
+			INT_BINARY(a < b);
+			break;
+		case OP_LEI:
+			INT_BINARY(a <= b);
+			break;
+		case OP_GTI:
+			INT_BINARY(a > b);
+			break;
+		case OP_GEI:
+			INT_BINARY(a >= b);
+			break;
+
+		case OP_ADDF:
+			FLOAT_BINARY(a + b);
+			break;
+		case OP_SUBF:
+			FLOAT_BINARY(a - b);
+			break;
+		case OP_MULF:
+			FLOAT_BINARY(a * b);
+			break;
+		case OP_DIVF:
+			FLOAT_BINARY(a / b);
+			break;
+		case OP_EQF:
+			FLOAT_COMPARE(a == b);
+			break;
+		case OP_NEF:
+			FLOAT_COMPARE(a != b);
+			break;
+		case OP_LTF:
+			FLOAT_COMPARE(a < b);
+			break;
+		case OP_LEF:
+			FLOAT_COMPARE(a <= b);
+			break;
+		case OP_GTF:
+			FLOAT_COMPARE(a > b);
+			break;
+		case OP_GEF:
+			FLOAT_COMPARE(a >= b);
+			break;
+
+		case OP_NEGI:
+			sp->i = (int32_t)(0u - (uint32_t)sp->i);
+			break;
+		case OP_NOTI:
+			sp->i = ~sp->i;
+			break;
+		case OP_LNOT:
+			sp->i = !sp->i;
+			break;
+		case OP_NEGF:
+			sp->f = -sp->f;
+			break;
+		case OP_I2F:
+			sp[-arg].f = sp[-arg].i;
+			break;
+		case OP_F2I:
+			sp[-arg].i = sp[-arg].f;
+			break;
+
+		case OP_JMP:
+			ip = code + arg;
+			break;
+		case OP_JZ:
+			if ((sp--)->i == 0)
+				ip = code + arg;
+			break;
+		case OP_JNZ:
+			if ((sp--)->i != 0)
+				ip = code + arg;
+			break;
+
+		case OP_CALL:
+			if (frame == &frames[MAX_CALL_DEPTH])
+				return PICOC_BC_ERR_STACK;
+			frame->ip = ip;
+			frame->fp = fp;
+			frame++;
+			fp = sp - (arg >> 16) + 1;
+			ip = code + (arg & 0xffff);
+			break;
+		case OP_ENTER:
+			// the word after ENTER is the room the whole frame needs above the arguments
+			if (sp + 1 + *ip++ > stack_end)
+				return PICOC_BC_ERR_STACK;
+			for (int32_t n = arg; n > 0; n--)
+				(++sp)->i = 0;
+			break;
+		case OP_RET:
+			*fp = *sp;
+			sp = fp;
+			frame--;
+			ip = frame->ip;
+			fp = frame->fp;
+			break;
+		case OP_RETV:
+			sp = fp - 1;
+			frame--;
+			ip = frame->ip;
+			fp = frame->fp;
+			break;
+		case OP_NATIVE:
+			sp = call_native(&natives[arg], sp);
+			break;
+		case OP_EXIT:
+			*exit_value = sp->i;
+			return PICOC_BC_OK;
+
+		default:
+			return PICOC_BC_ERR_IMAGE;
+		}
+	}
+}
+
+#endif /* PIOS_INCLUDE_PICOC */
+
+/**
+ * @}
+ * @}
+ */
@@ -1762,11 +1762,27 @@ void PlatformLibrarySetup_pid(Picoc *pc)
 #endif
 
 
-/* list all includes */
-void PlatformLibraryInit(Picoc *pc)
+/* libraries the bytecode compiler may call into, in a fixed order */
+const struct LibraryFunction *const PlatformLibrary_bytecode[] =
+{
+#ifndef NO_FP
+	PlatformLibrary_math,
+#endif
+	PlatformLibrary_system,
+	NULL
+};
+
+/* reset the library state before a script starts */
+void PlatformLibraryReset(void)
 {
 	// ensure we run in user state at startup
 	accesslevel = 0;
+}
+
+/* list all includes */
+void PlatformLibraryInit(Picoc *pc)
+{
+	PlatformLibraryReset();
 
 #ifndef NO_STRING_FUNCTIONS
 	IncludeRegister(pc, "string.h", NULL, &PlatformLibrary_string[0], NULL);
@@ -35,6 +35,7 @@
 
 #include "openpilot.h"
 #include "picoc_port.h"
+#include "picoc_bytecode.h"
 #include "picocsettings.h" 
 #include "picocstatus.h" 
 #include "flightstatus.h"
@@ -52,6 +53,7 @@ extern struct flashfs_logfs_cfg flashfs_waypoints_cfg;
 #define PICOC_STACKSIZE_MIN		(10*1024)
 #define PICOC_STACKSIZE_MAX		(128*1024)
 #define PICOC_SOURCE_FILE_TYPE	0X00704300		/* mark picoc sources with this ID */
+#define PICOC_IMAGE_FILE_TYPE	0X00704400		/* mark compiled images of the sources with this ID */
 #define PICOC_SECTOR_SIZE		48				/* size of filesystem object (less than slot_size - sizeof(slot_header) */
 #define SOH	0x01	/* (^A) start of heading */
 #define STX	0x02	/* (^B) start of text */
@@ -71,12 +73,16 @@ static PicoCStatusData picocstatus;
 // Private functions
 static void picocTask(void *parameters);
 static void updateSettings();
+static int32_t run_script(const char *source, int16_t file);
+int32_t load_image(uint8_t file, uint8_t *image, uint32_t image_size);
+int32_t save_image(uint8_t file, const uint8_t *image, uint32_t image_size);
 int32_t usart_cmd(char *buffer, uint32_t buffer_size);
 int32_t get_sector(uint16_t sector, char *buffer, uint32_t buffer_size);
 int32_t set_sector(uint16_t sector, char *buffer, uint32_t buffer_size);
 int32_t load_file(uint8_t file, char *buffer, uint32_t buffer_size);
 int32_t save_file(uint8_t file, char *buffer, uint32_t buffer_size);
 int32_t delete_file(uint8_t file);
+static int32_t delete_sectors(uint32_t file_id, uint16_t first);
 int32_t format_partition();
 
 /**
@@ -178,7 +184,7 @@ static void picocTask(void *parameters) {
 				// external start request
 				picocstatus.ExitValue = 0;
 				PicoCStatusExitValueSet(&picocstatus.ExitValue);
-				picocstatus.ExitValue = picoc(sourcebuffer, picocsettings.PicoCStackSize);
+				picocstatus.ExitValue = run_script(sourcebuffer, -1);
 				PicoCStatusExitValueSet(&picocstatus.ExitValue);
 				picocstatus.CommandError = 0;
 				picocstatus.Command = PICOCSTATUS_COMMAND_IDLE;
@@ -269,7 +275,7 @@ static void picocTask(void *parameters) {
 				// terminate source for security.
 				sourcebuffer[sourcebuffer_size - 1] = 0;
 				// start picoc in file mode.
-				picocstatus.ExitValue = picoc(sourcebuffer, picocsettings.PicoCStackSize);
+				picocstatus.ExitValue = run_script(sourcebuffer, picocsettings.BootFileID);
 				started = true;
 				break;
 			default:
@@ -319,6 +325,59 @@ static void updateSettings()
 	}
 }
 
+/**
+ * run a script, compiled to bytecode when the compiler handles it
+ * \param[in] source the script
+ * \param[in] file the file the source was loaded from, to cache the image in. -1 for none
+ * \return exit value of the script
+ */
+static int32_t run_script(const char *source, int16_t file)
+{
+	if (picocsettings.Engine == PICOCSETTINGS_ENGINE_BYTECODE) {
+		// the image takes up to half of the picoc stack, the machine stack the rest
+		uint32_t image_size = (picocsettings.PicoCStackSize / 2) & ~(sizeof(uint32_t) - 1);
+		uint8_t *memory = PlatformMalloc(picocsettings.PicoCStackSize);
+
+		if (memory != NULL) {
+			int32_t size = -1;
+			uint16_t line = 0;
+
+			if (file >= 0 && load_image(file, memory, image_size) == 0)
+				size = picoc_bc_image_size(memory);
+			if (size <= 0 || !picoc_bc_valid(memory, size, source, PlatformLibrary_bytecode)) {
+				size = picoc_bc_compile(source, PlatformLibrary_bytecode, memory, image_size, &line);
+				if (size > 0 && file >= 0)
+					save_image(file, memory, size);
+			}
+
+			picocstatus.CompileLine = line;
+			PicoCStatusCompileLineSet(&picocstatus.CompileLine);
+
+			if (size > 0) {
+				int32_t exit_value = 0;
+
+				picocstatus.Engine = PICOCSTATUS_ENGINE_BYTECODE;
+				PicoCStatusEngineSet(&picocstatus.Engine);
+
+				PlatformLibraryReset();
+				if (picoc_bc_run(memory, PlatformLibrary_bytecode, (union picoc_bc_cell *)(memory + image_size),
+						(picocsettings.PicoCStackSize - image_size) / sizeof(union picoc_bc_cell), &exit_value) != PICOC_BC_OK)
+					exit_value = -1;
+
+				PlatformFree(memory);
+				return exit_value;
+			}
+			PlatformFree(memory);
+		}
+	}
+
+	// not compiled, the interpreter handles all of the language
+	picocstatus.Engine = PICOCSTATUS_ENGINE_INTERPRETER;
+	PicoCStatusEngineSet(&picocstatus.Engine);
+
+	return picoc(source, picocsettings.PicoCStackSize);
+}
+
 /**
  * usart command
  */
@@ -465,12 +524,77 @@ int32_t save_file(uint8_t file, char *buffer, uint32_t buffer_size)
 }
 
 /**
- * delete a source file
+ * load a compiled image from flash
+ */
+int32_t load_image(uint8_t file, uint8_t *image, uint32_t image_size)
+{
+	uint32_t file_id = PICOC_IMAGE_FILE_TYPE + file;
+	uint32_t size = PICOC_SECTOR_SIZE;
+
+	if (image_size < PICOC_SECTOR_SIZE) {
+		return -1;
+	}
+
+	// the first sector holds the header, which tells how many follow
+	for (uint32_t i = 0; i < size; i += PICOC_SECTOR_SIZE) {
+		if (PIOS_FLASHFS_ObjLoad(pios_waypoints_settings_fs_id, file_id, i / PICOC_SECTOR_SIZE, &image[i], PICOC_SECTOR_SIZE) != 0) {
+			return -1;
+		}
+		if (i == 0) {
+			size = picoc_bc_image_size(image);
+			if ((size == 0) || (size > image_size - PICOC_SECTOR_SIZE)) {
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * save a compiled image to flash
+ */
+int32_t save_image(uint8_t file, const uint8_t *image, uint32_t image_size)
+{
+	uint32_t file_id = PICOC_IMAGE_FILE_TYPE + file;
+	uint8_t sector[PICOC_SECTOR_SIZE];
+	int32_t retval = 0;
+
+	for (uint32_t i = 0; (i < image_size) && (retval == 0); i += PICOC_SECTOR_SIZE) {
+		uint32_t len = (image_size - i < PICOC_SECTOR_SIZE) ? image_size - i : PICOC_SECTOR_SIZE;
+		memset(sector, 0, sizeof(sector));
+		memcpy(sector, &image[i], len);
+		retval = PIOS_FLASHFS_ObjSave(pios_waypoints_settings_fs_id, file_id, i / PICOC_SECTOR_SIZE, sector, PICOC_SECTOR_SIZE);
+	}
+
+	// drop what is left of a longer image saved before
+	if (retval == 0) {
+		retval = delete_sectors(file_id, (image_size + PICOC_SECTOR_SIZE - 1) / PICOC_SECTOR_SIZE);
+	}
+	return retval;
+}
+
+/**
+ * delete a source file and its compiled image
  */
 int32_t delete_file(uint8_t file)
 {
-	uint32_t file_id = PICOC_SOURCE_FILE_TYPE + file;
-	int32_t retval = PIOS_FLASHFS_ObjDelete(pios_waypoints_settings_fs_id, file_id, 0);
+	int32_t retval = delete_sectors(PICOC_SOURCE_FILE_TYPE + file, 0);
+	delete_sectors(PICOC_IMAGE_FILE_TYPE + file, 0);
+	return retval;
+}
+
+/**
+ * delete the sectors of a file, starting with sector first
+ */
+static int32_t delete_sectors(uint32_t file_id, uint16_t first)
+{
+	uint8_t sector[PICOC_SECTOR_SIZE];
+	int32_t retval = 0;
+
+	// deleting a missing sector succeeds too, so look for the end by loading
+	for (uint16_t i = first; (retval == 0) && (PIOS_FLASHFS_ObjLoad(pios_waypoints_settings_fs_id, file_id, i, sector, PICOC_SECTOR_SIZE) == 0); i++) {
+		retval = PIOS_FLASHFS_ObjDelete(pios_waypoints_settings_fs_id, file_id, i);
+	}
 	return retval;
 }
 
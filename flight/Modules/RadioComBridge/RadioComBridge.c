@@ -117,6 +117,7 @@ static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle,
 static void ProcessRadioStream(UAVTalkConnection inConnectionHandle,
 			       UAVTalkConnection outConnectionHandle,
 			       uint8_t rxbyte);
+static uint8_t RadioStreamObjectAction(uint32_t objId, uint16_t instId);
 static void objectPersistenceUpdatedCb(UAVObjEvent * objEv);
 static void registerObject(UAVObjHandle obj);
 
@@ -673,6 +674,52 @@ static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle,
 	}
 }
 
+/**
+ * @brief Decide how an object received on the radio data stream is handled.
+ *
+ * @param[in] objId  The object ID.
+ * @param[in] instId  The instance ID.
+ * @return A combination of UAVTALK_BATCH_RECEIVE and UAVTALK_BATCH_RELAY.
+ */
+static uint8_t RadioStreamObjectAction(uint32_t objId, uint16_t instId)
+{
+	switch (objId) {
+	case HWTAULINK_OBJID:
+	case MetaObjectId(RFM22BSTATUS_OBJID):
+	case MetaObjectId(HWTAULINK_OBJID):
+		// Ignore object...
+		// These objects are shadowed by the modem and are not transmitted to the telemetry port
+		// - RFM22BSTATUS_OBJID : ground station will receive the OPLM link status instead
+		// - HWTAULINK_OBJID : ground station will read and write the OPLM settings instead
+		return 0;
+	case RFM22BRECEIVER_OBJID:
+	case MetaObjectId(RFM22BRECEIVER_OBJID):
+		// Receive object locally
+		// These objects are received by the modem and are not transmitted to the telemetry port
+		// - RFM22BRECEIVER_OBJID : sent periodically from flight controller, not needed to echo
+		// some objects will send back a response to the remote modem
+		return UAVTALK_BATCH_RECEIVE;
+	case FLIGHTBATTERYSTATE_OBJID:
+	case FLIGHTSTATUS_OBJID:
+	case POSITIONACTUAL_OBJID:
+	case VELOCITYACTUAL_OBJID:
+	case BAROALTITUDE_OBJID:
+		// process the battery voltage locally for relaying to taranis
+		return UAVTALK_BATCH_RECEIVE | UAVTALK_BATCH_RELAY;
+	case RFM22BSTATUS_OBJID:
+		if (instId == 0) {
+			// instance 0 is from modem. do not pass this version
+			return 0;
+		}
+		// process the remote link state locally for relaying to taranis
+		// and pass it on for remote modem
+		return UAVTALK_BATCH_RECEIVE | UAVTALK_BATCH_RELAY;
+	default:
+		// all other packets are relayed to the telemetry port
+		return UAVTALK_BATCH_RELAY;
+	}
+}
+
 /**
  * @brief Process a byte of data received on the radio data stream.
  *
@@ -692,55 +739,20 @@ static void ProcessRadioStream(UAVTalkConnection inConnectionHandle,
 		// We only want to unpack certain objects from the remote modem
 		// Similarly we only want to relay certain objects to the telemetry port
 		uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
-		switch (objId) {
-		case HWTAULINK_OBJID:
-		case MetaObjectId(RFM22BSTATUS_OBJID):
-		case MetaObjectId(HWTAULINK_OBJID):
-			// Ignore object...
-			// These objects are shadowed by the modem and are not transmitted to the telemetry port
-			// - RFM22BSTATUS_OBJID : ground station will receive the OPLM link status instead
-			// - HWTAULINK_OBJID : ground station will read and write the OPLM settings instead
-			break;
-		case RFM22BRECEIVER_OBJID:
-		case MetaObjectId(RFM22BRECEIVER_OBJID):
-			// Receive object locally
-			// These objects are received by the modem and are not transmitted to the telemetry port
-			// - RFM22BRECEIVER_OBJID : sent periodically from flight controller, not needed to echo
-			// some objects will send back a response to the remote modem
-			UAVTalkReceiveObject(inConnectionHandle);
-			break;
-		case FLIGHTBATTERYSTATE_OBJID:
-		case FLIGHTSTATUS_OBJID:
-		case POSITIONACTUAL_OBJID:
-		case VELOCITYACTUAL_OBJID:
-		case BAROALTITUDE_OBJID:
-
-			// process the battery voltage locally for relaying to taranis
-			UAVTalkReceiveObject(inConnectionHandle);
-			UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
-			break;
-		case RFM22BSTATUS_OBJID:
-		{
-			uint32_t inst_id = UAVTalkGetPacketInstId(inConnectionHandle);
-			if (inst_id == 0) {
-				// instance 0 is from modem. do not pass this version
-			} else {
-				// process the remote link state locally for relaying to taranis
-				UAVTalkReceiveObject(inConnectionHandle);
-
-				// for remote modem
-				UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
-			}
+		uint32_t instId = UAVTalkGetPacketInstId(inConnectionHandle);
 
+		if (objId == UAVTALK_MULTI_OBJID) {
+			// Batched frames get the same treatment, entry by entry
+			UAVTalkRelayBatch(inConnectionHandle, outConnectionHandle,
+					  RadioStreamObjectAction);
+			return;
 		}
-			break;
 
-		default:
-			// all other packets are relayed to the telemetry port
-			UAVTalkRelayPacket(inConnectionHandle,
-					   outConnectionHandle);
-			break;
-		}
+		uint8_t action = RadioStreamObjectAction(objId, instId);
+		if (action & UAVTALK_BATCH_RECEIVE)
+			UAVTalkReceiveObject(inConnectionHandle);
+		if (action & UAVTALK_BATCH_RELAY)
+			UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
 	}
 }
 
@@ -57,12 +57,15 @@ extern uintptr_t external_i2c_adapter_id;
 #include "magnetometer.h"
 #include "magbias.h"
 #include "coordinate_conversions.h"
+#include "stabilization.h"
 
 // Private constants
-#define STACK_SIZE_BYTES 1000
+// The direct rate loop runs on this stack, see stabilization_direct_gyros()
+#define STACK_SIZE_BYTES 1200
 #define TASK_PRIORITY PIOS_THREAD_PRIO_HIGH
 #define SENSOR_PERIOD 6		// this allows sensor data to arrive as slow as 166Hz
 #define REQUIRED_GOOD_CYCLES 50
+#define SENSOR_BURST_MAX 16	// most samples taken from a sensor ring each cycle
 #define MAX_TIME_BETWEEN_VALID_BARO_DATAS_MS 100*1000  // we allow a pause time of 100 ms between two valid
                                                        // temperature/barometer dataa
 
@@ -76,8 +79,10 @@ enum mag_calibration_algo {
 static void SensorsTask(void *parameters);
 static void settingsUpdatedCb(UAVObjEvent * objEv);
 
-static void update_accels(struct pios_sensor_accel_data *accel);
-static void update_gyros(struct pios_sensor_gyro_data *gyro);
+static bool get_gyros(struct pios_sensor_gyro_data *gyros, uint32_t *timestamp, uint32_t timeout_ms);
+static bool get_accels(struct pios_sensor_accel_data *accels, uint32_t *timestamp);
+static void update_accels(struct pios_sensor_accel_data *accel, uint32_t timestamp);
+static void update_gyros(struct pios_sensor_gyro_data *gyro, uint32_t timestamp);
 static void update_mags(struct pios_sensor_mag_data *mag);
 static void update_baro(struct pios_sensor_baro_data *baro);
 
@@ -122,6 +127,14 @@ extern bool external_mag_fail;
 //! Select the algorithm to try and null out the magnetometer bias error
 static enum mag_calibration_algo mag_calibration_algo = MAG_CALIBRATION_PRELEMARI;
 
+// Samples drained from a sensor ring, kept off the task stack. Only the
+// Sensors task uses them, for one sensor at a time.
+static union {
+	struct pios_sensor_gyro_data gyros[SENSOR_BURST_MAX];
+	struct pios_sensor_accel_data accels[SENSOR_BURST_MAX];
+} burst;
+static uint32_t burst_timestamps[SENSOR_BURST_MAX];
+
 /**
  * API for sensor fusion algorithms:
  * Configure(struct pios_queue *gyro, struct pios_queue *accel, struct pios_queue *mag, struct pios_queue *baro)
@@ -184,6 +197,9 @@ static int32_t SensorsInitialize(void)
 	SensorSettingsConnectCallback(&settingsUpdatedCb);
 	INSSettingsConnectCallback(&settingsUpdatedCb);
 
+	// Every gyro update is passed to the direct rate loop
+	stabilization_direct_register_source();
+
 	return 0;
 }
 
@@ -237,28 +253,27 @@ static void SensorsTask(void *parameters)
 		struct pios_sensor_accel_data accels;
 		struct pios_sensor_mag_data mags;
 		struct pios_sensor_baro_data baro;
+		uint32_t gyros_timestamp, accels_timestamp;
 
 		uint32_t timeval = PIOS_DELAY_GetRaw();
 
 		//Block on gyro data but nothing else
 		struct pios_queue *queue;
-		queue = PIOS_SENSORS_GetQueue(PIOS_SENSOR_GYRO);
-		if (queue == NULL || PIOS_Queue_Receive(queue, &gyros, SENSOR_PERIOD) == false) {
+		if (get_gyros(&gyros, &gyros_timestamp, SENSOR_PERIOD) == false) {
 			good_runs = 0;
 			continue;
 		}
 
-		queue = PIOS_SENSORS_GetQueue(PIOS_SENSOR_ACCEL);
-		if (queue == NULL || PIOS_Queue_Receive(queue, &accels, 0) == false) {
+		if (get_accels(&accels, &accels_timestamp) == false) {
 			//If no new accels data is ready, reuse the latest sample
 			AccelsSet(&accelsData);
 		}
 		else
-			update_accels(&accels);
+			update_accels(&accels, accels_timestamp);
 
 		// Update gyros after the accels since the rest of the code expects
 		// the accels to be available first
-		update_gyros(&gyros);
+		update_gyros(&gyros, gyros_timestamp);
 
 		queue = PIOS_SENSORS_GetQueue(PIOS_SENSOR_MAG);
 		if (queue != NULL && PIOS_Queue_Receive(queue, &mags, 0) != false) {
@@ -320,11 +335,100 @@ static void SensorsTask(void *parameters)
 	}
 }
 
+/**
+ * @brief Get the gyro data, waiting for it up to timeout_ms
+ * @param[out] gyros The raw gyro data, averaged over every sample since the last call
+ * @param[out] timestamp When the latest sample was captured
+ * @return true if there was new data
+ */
+static bool get_gyros(struct pios_sensor_gyro_data *gyros, uint32_t *timestamp, uint32_t timeout_ms)
+{
+	struct pios_sensor_ring *ring = PIOS_SENSORS_GetRing(PIOS_SENSOR_GYRO);
+	if (ring == NULL) {
+		// Queued samples carry no capture time, the time they arrive is the best guess
+		struct pios_queue *queue = PIOS_SENSORS_GetQueue(PIOS_SENSOR_GYRO);
+		if (queue == NULL || !PIOS_Queue_Receive(queue, gyros, timeout_ms))
+			return false;
+
+		// Only once it arrived, the receive may have waited for it
+		*timestamp = PIOS_DELAY_GetRaw();
+		return true;
+	}
+
+	if (!PIOS_SENSORS_RingWait(ring, timeout_ms))
+		return false;
+
+	uint16_t count = PIOS_SENSORS_Drain(ring, burst.gyros, burst_timestamps, SENSOR_BURST_MAX);
+	if (count == 0)
+		return false;
+
+	// The average covers the time from the previous burst to the last sample of this one
+	*timestamp = burst_timestamps[count - 1];
+
+	// Use every sample rather than only the latest one, this also low passes
+	// whatever the sensor sampled faster than this loop runs
+	*gyros = burst.gyros[0];
+	for (uint16_t i = 1; i < count; i++) {
+		gyros->x += burst.gyros[i].x;
+		gyros->y += burst.gyros[i].y;
+		gyros->z += burst.gyros[i].z;
+		gyros->temperature += burst.gyros[i].temperature;
+	}
+	float scale = 1.0f / count;
+	gyros->x *= scale;
+	gyros->y *= scale;
+	gyros->z *= scale;
+	gyros->temperature *= scale;
+
+	return true;
+}
+
+/**
+ * @brief Get the accel data if there is any
+ * @param[out] accels The raw accel data, averaged over every sample since the last call
+ * @param[out] timestamp When the latest sample was captured
+ * @return true if there was new data
+ */
+static bool get_accels(struct pios_sensor_accel_data *accels, uint32_t *timestamp)
+{
+	struct pios_sensor_ring *ring = PIOS_SENSORS_GetRing(PIOS_SENSOR_ACCEL);
+	if (ring == NULL) {
+		struct pios_queue *queue = PIOS_SENSORS_GetQueue(PIOS_SENSOR_ACCEL);
+		if (queue == NULL || !PIOS_Queue_Receive(queue, accels, 0))
+			return false;
+
+		*timestamp = PIOS_DELAY_GetRaw();
+		return true;
+	}
+
+	uint16_t count = PIOS_SENSORS_Drain(ring, burst.accels, burst_timestamps, SENSOR_BURST_MAX);
+	if (count == 0)
+		return false;
+
+	*timestamp = burst_timestamps[count - 1];
+
+	*accels = burst.accels[0];
+	for (uint16_t i = 1; i < count; i++) {
+		accels->x += burst.accels[i].x;
+		accels->y += burst.accels[i].y;
+		accels->z += burst.accels[i].z;
+		accels->temperature += burst.accels[i].temperature;
+	}
+	float scale = 1.0f / count;
+	accels->x *= scale;
+	accels->y *= scale;
+	accels->z *= scale;
+	accels->temperature *= scale;
+
+	return true;
+}
+
 /**
  * @brief Apply calibration and rotation to the raw accel data
  * @param[in] accels The raw accel data
+ * @param[in] timestamp When the data was captured
  */
-static void update_accels(struct pios_sensor_accel_data *accels)
+static void update_accels(struct pios_sensor_accel_data *accels, uint32_t timestamp)
 {
 	// Average and scale the accels before rotation
 	float accels_out[3] = {
@@ -348,14 +452,16 @@ static void update_accels(struct pios_sensor_accel_data *accels)
 	accelsData.z += z_accel_offset;
 
 	accelsData.temperature = accels->temperature;
+	accelsData.timestamp = timestamp;
 	AccelsSet(&accelsData);
 }
 
 /**
  * @brief Apply calibration and rotation to the raw gyro data
  * @param[in] gyros The raw gyro data
+ * @param[in] timestamp When the data was captured
  */
-static void update_gyros(struct pios_sensor_gyro_data *gyros)
+static void update_gyros(struct pios_sensor_gyro_data *gyros, uint32_t timestamp)
 {
 	// Scale the gyros
 	float gyros_out[3] = {
@@ -366,6 +472,7 @@ static void update_gyros(struct pios_sensor_gyro_data *gyros)
 
 	GyrosData gyrosData;
 	gyrosData.temperature = gyros->temperature;
+	gyrosData.timestamp = timestamp;
 
 	// Update the bias due to the temperature
 	updateTemperatureComp(gyrosData.temperature, gyro_temp_bias);
@@ -407,6 +514,9 @@ static void update_gyros(struct pios_sensor_gyro_data *gyros)
 		}
 	}
 
+	// Run the rate loop before publishing so the outputs see the sample first
+	stabilization_direct_gyros(&gyrosData);
+
 	GyrosSet(&gyrosData);
 }
 
@@ -210,6 +210,7 @@ static void simulateConstant()
 	accelsData.y = 0;
 	accelsData.z = -GRAVITY;
 	accelsData.temperature = 0;
+	accelsData.timestamp = PIOS_DELAY_GetRaw();
 	AccelsSet(&accelsData);
 
 	GyrosData gyrosData; // Skip get as we set all the fields
@@ -224,6 +225,7 @@ static void simulateConstant()
 	gyrosData.y += gyrosBias.y;
 	gyrosData.z += gyrosBias.z;
 
+	gyrosData.timestamp = PIOS_DELAY_GetRaw();
 	GyrosSet(&gyrosData);
 
 	BaroAltitudeData baroAltitude;
@@ -266,6 +268,7 @@ static void simulateModelAgnostic()
 	accelsData.y = -GRAVITY * Rbe[1][2];
 	accelsData.z = -GRAVITY * Rbe[2][2];
 	accelsData.temperature = 30;
+	accelsData.timestamp = PIOS_DELAY_GetRaw();
 	AccelsSet(&accelsData);
 
 	RateDesiredData rateDesired;
@@ -283,6 +286,7 @@ static void simulateModelAgnostic()
 	gyrosData.y += gyrosBias.y;
 	gyrosData.z += gyrosBias.z;
 
+	gyrosData.timestamp = PIOS_DELAY_GetRaw();
 	GyrosSet(&gyrosData);
 
 	BaroAltitudeData baroAltitude;
@@ -357,6 +361,7 @@ static void simulateModelQuadcopter()
 	gyrosData.y = rpy[1] + rand_gauss() + (temperature - 20) * 1 + powf(temperature - 20,2) * 0.11;;
 	gyrosData.z = rpy[2] + rand_gauss() + (temperature - 20) * 1 + powf(temperature - 20,2) * 0.11;;
 	gyrosData.temperature = temperature;
+	gyrosData.timestamp = PIOS_DELAY_GetRaw();
 	GyrosSet(&gyrosData);
 	
 	// Predict the attitude forward in time
@@ -431,6 +436,7 @@ static void simulateModelQuadcopter()
 	accelsData.y = ned_accel[0] * Rbe[1][0] + ned_accel[1] * Rbe[1][1] + ned_accel[2] * Rbe[1][2] + accel_bias[1];
 	accelsData.z = ned_accel[0] * Rbe[2][0] + ned_accel[1] * Rbe[2][1] + ned_accel[2] * Rbe[2][2] + accel_bias[2];
 	accelsData.temperature = 30;
+	accelsData.timestamp = PIOS_DELAY_GetRaw();
 	AccelsSet(&accelsData);
 
 	if(baro_offset == 0) {
@@ -615,6 +621,7 @@ static void simulateModelAirplane()
 	gyrosData.x = rpy[0] + rand_gauss();
 	gyrosData.y = rpy[1] + rand_gauss();
 	gyrosData.z = rpy[2] + rand_gauss();
+	gyrosData.timestamp = PIOS_DELAY_GetRaw();
 	GyrosSet(&gyrosData);
 	
 	// Predict the attitude forward in time
@@ -718,6 +725,7 @@ static void simulateModelAirplane()
 	accelsData.y = ned_accel[0] * Rbe[1][0] + ned_accel[1] * Rbe[1][1] + ned_accel[2] * Rbe[1][2] + accel_bias[1];
 	accelsData.z = ned_accel[0] * Rbe[2][0] + ned_accel[1] * Rbe[2][1] + ned_accel[2] * Rbe[2][2] + accel_bias[2];
 	accelsData.temperature = 30;
+	accelsData.timestamp = PIOS_DELAY_GetRaw();
 	AccelsSet(&accelsData);
 	
 	if(baro_offset == 0) {
@@ -902,6 +910,7 @@ static void simulateModelCar()
 	gyrosData.x = rpy[0] + rand_gauss();
 	gyrosData.y = rpy[1] + rand_gauss();
 	gyrosData.z = rpy[2] + rand_gauss();
+	gyrosData.timestamp = PIOS_DELAY_GetRaw();
 	GyrosSet(&gyrosData);
 	
 	// Predict the attitude forward in time
@@ -985,6 +994,7 @@ static void simulateModelCar()
 	accelsData.y = ned_accel[0] * Rbe[1][0] + ned_accel[1] * Rbe[1][1] + ned_accel[2] * Rbe[1][2] + accel_bias[1];
 	accelsData.z = ned_accel[0] * Rbe[2][0] + ned_accel[1] * Rbe[2][1] + ned_accel[2] * Rbe[2][2] + accel_bias[2];
 	accelsData.temperature = 30;
+	accelsData.timestamp = PIOS_DELAY_GetRaw();
 	AccelsSet(&accelsData);
 	
 	if(baro_offset == 0) {
@@ -33,10 +33,25 @@
 #ifndef STABILIZATION_H
 #define STABILIZATION_H
 
+#include "actuatordesired.h"
+#include "gyros.h"
+
 enum {ROLL,PITCH,YAW,MAX_AXES};
 
+//! Mixes and outputs ActuatorDesired, called with NULL when stabilization hands the outputs back
+typedef void (*stabilization_direct_output_t)(const ActuatorDesiredData *desired);
+
 int32_t StabilizationInitialize();
 
+//! Register the output stage for the direct rate loop, call from a module initialize function
+void stabilization_direct_register_output(stabilization_direct_output_t output);
+
+//! Declare that stabilization_direct_gyros() is called on every gyro update, call from a module initialize function
+void stabilization_direct_register_source(void);
+
+//! Run the direct rate loop on a new gyro sample, does nothing unless it is enabled
+void stabilization_direct_gyros(const GyrosData *gyros);
+
 #endif /* STABILIZATION_H */
 
 /**
@@ -12,6 +12,21 @@
  * then based on the mode and values in @ref StabilizationSettings computing
  * the desired outputs and placing them in @ref ActuatorDesired.
  *
+ * With StabilizationSettings.RateLoop set to Decoupled (read at startup)
+ * the rate loop runs in its own task on every @ref Gyros update, while the
+ * attitude loop runs on every @ref AttitudeActual update and hands the rate
+ * setpoints over without locking.  Modes that do not use the rate PID
+ * (none, virtual flybar, MWRate and the coordinated flight slip control)
+ * are still computed at the attitude loop rate.  The time taken by each
+ * stage is reported in @ref StabilizationLatency.
+ *
+ * Direct works like Decoupled, except that the rate loop runs inside the
+ * sensor task for every gyro sample and hands its output straight to the
+ * actuator mixer, without a UAVObject event in between.  ActuatorDesired is
+ * then only published every DIRECT_PUBLISH_MS for telemetry.  Platforms
+ * without a sensor module or actuator module that support this fall back to
+ * Decoupled.
+ *
  * @file       stabilization.c
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
  * @author     dRonin, http://dronin.org Copyright (C) 2015
@@ -51,16 +66,20 @@
 #include "gyros.h"
 #include "mwratesettings.h"
 #include "ratedesired.h"
+#include "stabilizationlatency.h"
 #include "systemident.h"
 #include "stabilizationdesired.h"
 #include "stabilizationsettings.h"
 #include "trimangles.h"
 #include "trimanglessettings.h"
+#include "vibrationanalysispeak.h"
 
 // Math libraries
 #include "coordinate_conversions.h"
+#include "filter_bank.h"
 #include "pid.h"
 #include "misc_math.h"
+#include "seqlock.h"
 
 // Includes for various stabilization algorithms
 #include "virtualflybar.h"
@@ -74,8 +93,19 @@
 #define STACK_SIZE_BYTES 800
 #endif
 
+#if defined(PIOS_STABILIZATION_RATE_STACK_SIZE)
+#define RATE_STACK_SIZE_BYTES PIOS_STABILIZATION_RATE_STACK_SIZE
+#else
+#define RATE_STACK_SIZE_BYTES 512
+#endif
+
 #define TASK_PRIORITY PIOS_THREAD_PRIO_HIGHEST
+#define DECOUPLED_TASK_PRIORITY PIOS_THREAD_PRIO_HIGH
+#define RATE_TASK_PRIORITY PIOS_THREAD_PRIO_HIGHEST
+#define LATENCY_PERIOD_MS 1000
+#define DIRECT_PUBLISH_MS 20
 #define FAILSAFE_TIMEOUT_MS 30
+#define SETPOINTS_READ_TRIES 3
 #define COORDINATED_FLIGHT_MIN_ROLL_THRESHOLD 3.0f
 #define COORDINATED_FLIGHT_MAX_YAW_THRESHOLD 0.05f
 
@@ -105,8 +135,70 @@ enum {
 	PID_MAX
 };
 
+//! Rate PID gains of one axis, with the throttle attenuation applied
+struct rate_gains {
+	float kp;
+	float ki;
+	float kd;
+	float ilimit;
+};
+
+//! What the rate loop should do on one axis, filled in by the attitude loop
+struct rate_command {
+	struct rate_gains gains; //!< Rate PID gains to run with
+	float setpoint;       //!< Rate PID setpoint (deg/s)
+	float gain;           //!< Weight of the rate PID output
+	float feedforward;    //!< Added to the rate PID output, or the whole output without it
+	uint8_t resets;       //!< Changes every time the rate integral must be zeroed
+	bool rate_pid;        //!< Whether to run the rate PID at all
+	bool hold_integral;   //!< Keep the rate integral at zero
+};
+
+//! Everything the rate loop takes from the attitude loop
+struct rate_setpoints {
+	struct rate_command axis[MAX_AXES];
+	float throttle;
+	uint32_t timestamp;   //!< When the attitude loop published these
+	bool enabled;         //!< Whether ActuatorDesired belongs to stabilization
+};
+
+//! Time base for one of the control loops
+struct loop_clock {
+	uint32_t timeval;
+	uint32_t iteration;
+	float dT_filtered;
+};
+
+//! Mean and peak of one latency figure
+struct latency_stat {
+	uint32_t sum;
+	uint32_t max;
+};
+
+enum {
+	LATENCY_GYRO_TO_RATE,
+	LATENCY_RATE_LOOP,
+	LATENCY_GYRO_TO_ACTUATOR,
+	LATENCY_GYRO_TO_OUTPUT,
+	LATENCY_SETPOINT_AGE,
+	LATENCY_RATE_PERIOD,
+	LATENCY_RATE_MAX
+};
+
+enum {
+	LATENCY_ATTITUDE_LOOP,
+	LATENCY_ATTITUDE_PERIOD,
+	LATENCY_ATTITUDE_MAX
+};
+
 // Private variables
 static struct pios_thread *taskHandle;
+static struct pios_thread *rateTaskHandle;
+static struct pios_queue *rateQueue;
+static bool decoupled;
+static bool direct;
+static bool direct_source;
+static stabilization_direct_output_t direct_output;
 static MWRateSettingsData mwrate_settings;
 static StabilizationSettingsData settings;
 static TrimAnglesData trimAngles;
@@ -120,11 +212,44 @@ bool lowThrottleZeroIntegral;
 float vbar_decay = 0.991f;
 float gyro_alpha = 0.6;
 struct pid pids[PID_MAX];
+static float gyro_filtered[MAX_AXES];
+static uint8_t rate_resets[MAX_AXES];
+static struct loop_clock rate_clock;
+static struct loop_clock attitude_clock;
+
+//! Setpoints for the rate loop, setpoints_seq is odd while they are written
+static struct rate_setpoints setpoints;
+static volatile uint32_t setpoints_seq;
+
+//! Rate PID gains from calculate_pids, only the rate loop configures the rate PIDs
+static struct rate_gains rate_gains[MAX_AXES];
+
+static struct latency_stat rate_latency[LATENCY_RATE_MAX];
+static uint32_t rate_latency_count;
 
 volatile bool gyro_filter_updated = false;
 
+//! Notches at the vibration peak and its second harmonic, ahead of the gyro low pass
+static struct dynamic_notch gyro_notch[2];
+static bool notch_enabled;
+static volatile bool notch_updated;
+
 // Private functions
 static void stabilizationTask(void* parameters);
+static void stabilizationRateTask(void* parameters);
+static void rate_loop_update(const GyrosData *gyrosData, uint32_t loop_start);
+static float loop_clock_update(struct loop_clock *clock);
+static void update_filter_constants(void);
+static void filter_gyros(const GyrosData *gyros);
+static void update_notch_center(void);
+static void NotchPeakUpdatedCb(UAVObjEvent * ev);
+static void apply_rate_commands(const struct rate_command *commands, float *actuatorDesiredAxis, float dT);
+static void publish_setpoints(const struct rate_setpoints *newest);
+static bool read_setpoints(struct rate_setpoints *newest);
+static void latency_add(struct latency_stat *stat, uint32_t value);
+static void latency_flush(struct latency_stat *stat, uint32_t count, uint16_t *out);
+static void rate_latency_record(uint32_t capture, uint32_t loop_start, uint32_t output_time, uint32_t setpoint_age, float dT);
+static void flush_rate_latency(void);
 static void zero_pids(void);
 static void calculate_pids(void);
 static void SettingsUpdatedCb(UAVObjEvent * ev);
@@ -138,9 +263,40 @@ int32_t StabilizationStart()
 	// Create object queue
 	queue = PIOS_Queue_Create(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
 
+	uint8_t rate_loop;
+	StabilizationSettingsRateLoopGet(&rate_loop);
+	decoupled = rate_loop != STABILIZATIONSETTINGS_RATELOOP_COUPLED;
+
+	// Follow the vibration peak with notches on the gyros
+	uint8_t dynamic_notch;
+	StabilizationSettingsDynamicNotchGet(&dynamic_notch);
+	notch_enabled = dynamic_notch == STABILIZATIONSETTINGS_DYNAMICNOTCH_ENABLED;
+	if (notch_enabled) {
+		// Pass everything until the sample rate and a peak are known
+		for (uint8_t i = 0; i < NELEMENTS(gyro_notch); i++)
+			dynamic_notch_init(&gyro_notch[i], 0, 0, 1);
+
+		VibrationAnalysisPeakInitialize();
+		VibrationAnalysisPeakConnectCallback(NotchPeakUpdatedCb);
+	}
+
+	// The direct path needs both ends registered, otherwise run it as decoupled
+	direct = rate_loop == STABILIZATIONSETTINGS_RATELOOP_DIRECT &&
+		direct_source && direct_output != NULL;
+
 	// Listen for updates.
-	//	AttitudeActualConnectQueue(queue);
-	GyrosConnectQueue(queue);
+	if (decoupled) {
+		// The attitude loop follows the estimator and the rate loop the gyros
+		AttitudeActualConnectQueue(queue);
+		rate_clock.timeval = PIOS_DELAY_GetRaw();
+
+		if (!direct) {
+			rateQueue = PIOS_Queue_Create(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
+			GyrosConnectQueue(rateQueue);
+		}
+	} else {
+		GyrosConnectQueue(queue);
+	}
 	
 	// Connect settings callback
 	MWRateSettingsConnectCallback(SettingsUpdatedCb);
@@ -151,9 +307,15 @@ int32_t StabilizationStart()
 	PIOS_WDG_RegisterFlag(PIOS_WDG_STABILIZATION);
 
 	// Start main task
-	taskHandle = PIOS_Thread_Create(stabilizationTask, "Stabilization", STACK_SIZE_BYTES, NULL, TASK_PRIORITY);
+	taskHandle = PIOS_Thread_Create(stabilizationTask, "Stabilization", STACK_SIZE_BYTES, NULL,
+	                                decoupled ? DECOUPLED_TASK_PRIORITY : TASK_PRIORITY);
 	TaskMonitorAdd(TASKINFO_RUNNING_STABILIZATION, taskHandle);
 
+	if (decoupled && !direct) {
+		rateTaskHandle = PIOS_Thread_Create(stabilizationRateTask, "StabRate", RATE_STACK_SIZE_BYTES, NULL, RATE_TASK_PRIORITY);
+		TaskMonitorAdd(TASKINFO_RUNNING_STABILIZATIONRATE, rateTaskHandle);
+	}
+
 	return 0;
 }
 
@@ -168,6 +330,7 @@ int32_t StabilizationInitialize()
 	ActuatorDesiredInitialize();
 	TrimAnglesInitialize();
 	TrimAnglesSettingsInitialize();
+	StabilizationLatencyInitialize();
 #if defined(RATEDESIRED_DIAGNOSTICS)
 	RateDesiredInitialize();
 #endif
@@ -178,13 +341,50 @@ int32_t StabilizationInitialize()
 MODULE_INITCALL(StabilizationInitialize, StabilizationStart);
 
 /**
- * Module task
+ * Register the output stage for the direct rate loop
+ * @param[in] output Mixes and outputs ActuatorDesired
+ */
+void stabilization_direct_register_output(stabilization_direct_output_t output)
+{
+	direct_output = output;
+}
+
+/**
+ * Declare that stabilization_direct_gyros() will be called on every gyro update
+ */
+void stabilization_direct_register_source(void)
+{
+	direct_source = true;
+}
+
+/**
+ * Run the direct rate loop on a new gyro sample, from the context of the
+ * sensor task
+ * @param[in] gyros The calibrated gyro data that is about to be published
+ */
+void stabilization_direct_gyros(const GyrosData *gyros)
+{
+	if (!direct)
+		return;
+
+	uint32_t loop_start = PIOS_DELAY_GetRaw();
+
+	PIOS_WDG_UpdateFlag(PIOS_WDG_STABILIZATION);
+
+	rate_loop_update(gyros, loop_start);
+}
+
+/**
+ * Module task, runs the attitude loop and unless the rate loop is decoupled
+ * also the rate loop
  */
 static void stabilizationTask(void* parameters)
 {
 	UAVObjEvent ev;
 	
-	uint32_t timeval = PIOS_DELAY_GetRaw();
+	// Without a separate rate loop both loops share the same time base
+	struct loop_clock *clock = decoupled ? &attitude_clock : &rate_clock;
+	clock->timeval = PIOS_DELAY_GetRaw();
 	
 	ActuatorDesiredData actuatorDesired;
 	StabilizationDesiredData stabDesired;
@@ -197,65 +397,43 @@ static void stabilizationTask(void* parameters)
 	float *actuatorDesiredAxis = &actuatorDesired.Roll;
 	float *rateDesiredAxis = &rateDesired.Roll;
 	float horizonRateFraction = 0.0f;
+	struct rate_setpoints newest;
+	struct rate_command *commands = newest.axis;
+
+	struct latency_stat latency[LATENCY_ATTITUDE_MAX] = {{0}};
+	uint32_t latency_count = 0;
+	uint32_t latency_timeval = PIOS_DELAY_GetRaw();
 
 	// Force refresh of all settings immediately before entering main task loop
 	SettingsUpdatedCb((UAVObjEvent *) NULL);
 	
 	// Settings for system identification
-	uint32_t iteration = 0;
 	const uint32_t SYSTEM_IDENT_PERIOD = 75;
 	uint32_t system_ident_timeval = PIOS_DELAY_GetRaw();
 
-	float dT_filtered = 0;
-
 	// Main task loop
 	zero_pids();
 	while(1) {
-		iteration++;
-
-		PIOS_WDG_UpdateFlag(PIOS_WDG_STABILIZATION);
+		// The rate loop feeds the watchdog when it owns the actuators
+		if (!decoupled)
+			PIOS_WDG_UpdateFlag(PIOS_WDG_STABILIZATION);
 		
-		// Wait until the AttitudeRaw object is updated, if a timeout then go to failsafe
+		// Wait until the gyros (or attitude when decoupled) are updated, if a timeout then go to failsafe
 		if (PIOS_Queue_Receive(queue, &ev, FAILSAFE_TIMEOUT_MS) != true)
 		{
 			AlarmsSet(SYSTEMALARMS_ALARM_STABILIZATION,SYSTEMALARMS_ALARM_WARNING);
 			continue;
 		}
 		
-		calculate_pids();
+		uint32_t loop_start = PIOS_DELAY_GetRaw();
+		latency_add(&latency[LATENCY_ATTITUDE_PERIOD], PIOS_DELAY_DiffuS2(clock->timeval, loop_start));
 
-		float dT = PIOS_DELAY_DiffuS(timeval) * 1.0e-6f;
-		timeval = PIOS_DELAY_GetRaw();
-		
-		// exponential moving averaging (EMA) of dT to reduce jitter; ~200points
-		// to have more or less equivalent noise reduction to a normal N point moving averaging:  alpha = 2 / (N + 1)
-		// run it only at the beginning for the first samples, to reduce CPU load, and the value should converge to a constant value
-
-		if (iteration < 100) {
-			dT_filtered = dT;
-		} else if (iteration < 2000) {
-			dT_filtered = 0.01f * dT + (1.0f - 0.01f) * dT_filtered;
-		} else if (iteration == 2000) {
-			gyro_filter_updated = true;
-		}
-
-		if (gyro_filter_updated) {
-			if (settings.GyroCutoff < 1.0f) {
-				gyro_alpha = 0;
-			} else {
-				gyro_alpha = expf(-2.0f * (float)(M_PI) *
-						settings.GyroCutoff * dT_filtered);
-			}
+		calculate_pids();
 
-			// Compute time constant for vbar decay term
-			if (settings.VbarTau < 0.001f) {
-				vbar_decay = 0;
-			} else {
-				vbar_decay = expf(-dT_filtered / settings.VbarTau);
-			}
+		float dT = loop_clock_update(clock);
 
-			gyro_filter_updated = false;
-		}
+		if (!decoupled && gyro_filter_updated)
+			update_filter_constants();
 
 		FlightStatusGet(&flightStatus);
 		StabilizationDesiredGet(&stabDesired);
@@ -330,10 +508,9 @@ static void stabilizationTask(void* parameters)
 		// Wrap yaw error to [-180,180]
 		local_attitude_error[2] = circular_modulus_deg(local_attitude_error[2]);
 
-		static float gyro_filtered[3];
-		gyro_filtered[0] = gyro_filtered[0] * gyro_alpha + gyrosData.x * (1 - gyro_alpha);
-		gyro_filtered[1] = gyro_filtered[1] * gyro_alpha + gyrosData.y * (1 - gyro_alpha);
-		gyro_filtered[2] = gyro_filtered[2] * gyro_alpha + gyrosData.z * (1 - gyro_alpha);
+		// When decoupled the rate loop keeps gyro_filtered up to date
+		if (!decoupled)
+			filter_gyros(&gyrosData);
 
 		// A flag to track which stabilization mode each axis is in
 		static uint8_t previous_mode[MAX_AXES] = {255,255,255};
@@ -344,6 +521,8 @@ static void stabilizationTask(void* parameters)
 		{
 			// Check whether this axis mode needs to be reinitialized
 			bool reinit = (stabDesired.StabilizationMode[i] != previous_mode[i]);
+			// Modes that use the rate PID fill this in, others set actuatorDesiredAxis directly
+			commands[i] = (struct rate_command) { .gain = 1.0f };
 			// The unscaled input (-1,1)
 			float *raw_input = &stabDesired.Roll;
 			previous_mode[i] = stabDesired.StabilizationMode[i];
@@ -352,14 +531,14 @@ static void stabilizationTask(void* parameters)
 			{
 				case STABILIZATIONDESIRED_STABILIZATIONMODE_RATE:
 					if(reinit)
-						pids[PID_GROUP_RATE + i].iAccumulator = 0;
+						rate_resets[i]++;
 
 					// Store to rate desired variable for storing to UAVO
 					rateDesiredAxis[i] = bound_sym(stabDesiredAxis[i], settings.ManualRate[i]);
 
 					// Compute the inner loop
-					actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i],  rateDesiredAxis[i],  gyro_filtered[i], dT);
-					actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i],1.0f);
+					commands[i].rate_pid = true;
+					commands[i].setpoint = rateDesiredAxis[i];
 
 					break;
 
@@ -367,7 +546,7 @@ static void stabilizationTask(void* parameters)
 					// this implementation is based on the Openpilot/Librepilot Acro+ flightmode
 					// and our existing rate & MWRate flightmodes
 					if(reinit)
-							pids[PID_GROUP_RATE + i].iAccumulator = 0;
+							rate_resets[i]++;
 
 					// The factor for gyro suppression / mixing raw stick input into the output; scaled by raw stick input
 					float factor = fabsf(raw_input[i]) * settings.AcroInsanityFactor / 100;
@@ -378,20 +557,20 @@ static void stabilizationTask(void* parameters)
 					// Zero integral for aggressive maneuvers, like it is done for MWRate
 					if ((i < 2 && fabsf(gyro_filtered[i]) > 150.0f) ||
 											(i == 0 && fabsf(raw_input[i]) > 0.2f)) {
-							pids[PID_GROUP_RATE + i].iAccumulator = 0;
-							pids[PID_GROUP_RATE + i].i = 0;
+							commands[i].hold_integral = true;
 							}
 
-					// Compute the inner loop
-					actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i], rateDesiredAxis[i], gyro_filtered[i], dT);
-					actuatorDesiredAxis[i] = factor * raw_input[i] + (1.0f - factor) * actuatorDesiredAxis[i];
-					actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i], 1.0f);
+					// Compute the inner loop, mixed with the raw stick input
+					commands[i].rate_pid = true;
+					commands[i].setpoint = rateDesiredAxis[i];
+					commands[i].gain = 1.0f - factor;
+					commands[i].feedforward = factor * raw_input[i];
 
 					break;
 			case STABILIZATIONDESIRED_STABILIZATIONMODE_ATTITUDE:
 					if(reinit) {
 						pids[PID_GROUP_ATT + i].iAccumulator = 0;
-						pids[PID_GROUP_RATE + i].iAccumulator = 0;
+						rate_resets[i]++;
 					}
 
 					// Compute the outer loop
@@ -399,8 +578,8 @@ static void stabilizationTask(void* parameters)
 					rateDesiredAxis[i] = bound_sym(rateDesiredAxis[i], settings.MaximumRate[i]);
 
 					// Compute the inner loop
-					actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i],  rateDesiredAxis[i],  gyro_filtered[i], dT);
-					actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i],1.0f);
+					commands[i].rate_pid = true;
+					commands[i].setpoint = rateDesiredAxis[i];
 
 					break;
 
@@ -415,21 +594,21 @@ static void stabilizationTask(void* parameters)
 				case STABILIZATIONDESIRED_STABILIZATIONMODE_WEAKLEVELING:
 				{
 					if (reinit)
-						pids[PID_GROUP_RATE + i].iAccumulator = 0;
+						rate_resets[i]++;
 
 					float weak_leveling = local_attitude_error[i] * weak_leveling_kp;
 					weak_leveling = bound_sym(weak_leveling, weak_leveling_max);
 
 					// Compute desired rate as input biased towards leveling
 					rateDesiredAxis[i] = stabDesiredAxis[i] + weak_leveling;
-					actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i],  rateDesiredAxis[i],  gyro_filtered[i], dT);
-					actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i],1.0f);
+					commands[i].rate_pid = true;
+					commands[i].setpoint = rateDesiredAxis[i];
 
 					break;
 				}
 				case STABILIZATIONDESIRED_STABILIZATIONMODE_AXISLOCK:
 					if (reinit)
-						pids[PID_GROUP_RATE + i].iAccumulator = 0;
+						rate_resets[i]++;
 
 					if (fabsf(stabDesiredAxis[i]) > max_axislock_rate) {
 						// While getting strong commands act like rate mode
@@ -447,14 +626,14 @@ static void stabilizationTask(void* parameters)
 						rateDesiredAxis[i] = bound_sym(tmpRateDesired, settings.MaximumRate[i]);
 					}
 
-					actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i],  rateDesiredAxis[i],  gyro_filtered[i], dT);
-					actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i],1.0f);
+					commands[i].rate_pid = true;
+					commands[i].setpoint = rateDesiredAxis[i];
 
 					break;
 
 				case STABILIZATIONDESIRED_STABILIZATIONMODE_HORIZON:
 					if(reinit) {
-						pids[PID_GROUP_RATE + i].iAccumulator = 0;
+						rate_resets[i]++;
 					}
 
 					// Do not allow outer loop integral to wind up in this mode since the controller
@@ -473,8 +652,8 @@ static void stabilizationTask(void* parameters)
 					rateDesiredAxis[i] = bound_sym(rateDesiredAxis[i], settings.ManualRate[i]);
 
 					// Compute the inner loop
-					actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i],  rateDesiredAxis[i],  gyro_filtered[i], dT);
-					actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i],1.0f);
+					commands[i].rate_pid = true;
+					commands[i].setpoint = rateDesiredAxis[i];
 
 					break;
 
@@ -539,7 +718,7 @@ static void stabilizationTask(void* parameters)
 				case STABILIZATIONDESIRED_STABILIZATIONMODE_SYSTEMIDENT:
 					if(reinit) {
 						pids[PID_GROUP_ATT + i].iAccumulator = 0;
-						pids[PID_GROUP_RATE + i].iAccumulator = 0;
+						rate_resets[i]++;
 					}
 
 					static uint32_t ident_iteration = 0;
@@ -614,17 +793,17 @@ static void stabilizationTask(void* parameters)
 						rateDesiredAxis[i] = bound_sym(rateDesiredAxis[i], settings.MaximumRate[i]);
 
 						// Compute the inner loop
-						actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i],  rateDesiredAxis[i],  gyro_filtered[i], dT);
-						actuatorDesiredAxis[i] += ident_offsets[i];
-						actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i],1.0f);
+						commands[i].rate_pid = true;
+						commands[i].setpoint = rateDesiredAxis[i];
+						commands[i].feedforward = ident_offsets[i];
 					} else {
 						// Get the desired rate. yaw is always in rate mode in system ident.
 						rateDesiredAxis[i] = bound_sym(stabDesiredAxis[i], settings.ManualRate[i]);
 
 						// Compute the inner loop only for yaw
-						actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i],  rateDesiredAxis[i],  gyro_filtered[i], dT);
-						actuatorDesiredAxis[i] += ident_offsets[i];
-						actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i],1.0f);						
+						commands[i].rate_pid = true;
+						commands[i].setpoint = rateDesiredAxis[i];
+						commands[i].feedforward = ident_offsets[i];
 					}
 
 					break;
@@ -634,7 +813,7 @@ static void stabilizationTask(void* parameters)
 						case YAW:
 							if (reinit) {
 								pids[PID_COORDINATED_FLIGHT_YAW].iAccumulator = 0;
-								pids[PID_RATE_YAW].iAccumulator = 0;
+								rate_resets[YAW]++;
 								axis_lock_accum[YAW] = 0;
 							}
 
@@ -666,7 +845,7 @@ static void stabilizationTask(void* parameters)
 									actuatorDesiredAxis[YAW] = bound_sym(command ,1.0);
 
 									// Reset axis-lock integrals
-									pids[PID_RATE_YAW].iAccumulator = 0;
+									rate_resets[YAW]++;
 									axis_lock_accum[YAW] = 0;
 								} else if (fabsf(stabDesired.Roll) <= COORDINATED_FLIGHT_MIN_ROLL_THRESHOLD) { // We're requesting less roll than the threshold
 									// Axis lock on no gyro change
@@ -675,8 +854,8 @@ static void stabilizationTask(void* parameters)
 									rateDesiredAxis[YAW] = pid_apply(&pids[PID_ATT_YAW], axis_lock_accum[YAW], dT);
 									rateDesiredAxis[YAW] = bound_sym(rateDesiredAxis[YAW], settings.MaximumRate[YAW]);
 
-									actuatorDesiredAxis[YAW] = pid_apply_setpoint(&pids[PID_RATE_YAW],  rateDesiredAxis[YAW],  gyro_filtered[YAW], dT);
-									actuatorDesiredAxis[YAW] = bound_sym(actuatorDesiredAxis[YAW],1.0f);
+									commands[YAW].rate_pid = true;
+									commands[YAW].setpoint = rateDesiredAxis[YAW];
 
 									// Reset coordinated-flight integral
 									pids[PID_COORDINATED_FLIGHT_YAW].iAccumulator = 0;
@@ -686,7 +865,7 @@ static void stabilizationTask(void* parameters)
 
 								// Reset all integrals
 								pids[PID_COORDINATED_FLIGHT_YAW].iAccumulator = 0;
-								pids[PID_RATE_YAW].iAccumulator = 0;
+								rate_resets[YAW]++;
 								axis_lock_accum[YAW] = 0;
 							}
 							break;
@@ -705,7 +884,7 @@ static void stabilizationTask(void* parameters)
 					// for a gimbal you can select pitch too.
 					if(reinit) {
 						pids[PID_GROUP_ATT + i].iAccumulator = 0;
-						pids[PID_GROUP_RATE + i].iAccumulator = 0;
+						rate_resets[i]++;
 					}
 
 					float error;
@@ -747,8 +926,8 @@ static void stabilizationTask(void* parameters)
 					rateDesiredAxis[i] = bound_sym(rateDesiredAxis[i], settings.PoiMaximumRate[i]);
 
 					// Compute the inner loop
-					actuatorDesiredAxis[i] = pid_apply_setpoint(&pids[PID_GROUP_RATE + i],  rateDesiredAxis[i],  gyro_filtered[i], dT);
-					actuatorDesiredAxis[i] = bound_sym(actuatorDesiredAxis[i],1.0f);
+					commands[i].rate_pid = true;
+					commands[i].setpoint = rateDesiredAxis[i];
 
 					break;
 				case STABILIZATIONDESIRED_STABILIZATIONMODE_NONE:
@@ -760,6 +939,13 @@ static void stabilizationTask(void* parameters)
 			}
 		}
 
+		for(uint8_t i=0; i< MAX_AXES; i++) {
+			if (!commands[i].rate_pid)
+				commands[i].feedforward = actuatorDesiredAxis[i];
+			commands[i].resets = rate_resets[i];
+			commands[i].gains = rate_gains[i];
+		}
+
 		if (settings.VbarPiroComp == STABILIZATIONSETTINGS_VBARPIROCOMP_TRUE)
 			stabilization_virtual_flybar_pirocomp(gyro_filtered[2], dT);
 
@@ -767,13 +953,46 @@ static void stabilizationTask(void* parameters)
 		RateDesiredSet(&rateDesired);
 #endif
 
-		// Save dT
-		actuatorDesired.UpdateTime = dT * 1000;
-		actuatorDesired.Throttle = stabDesired.Throttle;
+		bool enabled = flightStatus.FlightMode != FLIGHTSTATUS_FLIGHTMODE_MANUAL;
 
-		if(flightStatus.FlightMode != FLIGHTSTATUS_FLIGHTMODE_MANUAL) {
-			ActuatorDesiredSet(&actuatorDesired);
+		if (decoupled) {
+			newest.throttle = stabDesired.Throttle;
+			newest.enabled = enabled;
+			newest.timestamp = PIOS_DELAY_GetRaw();
+			publish_setpoints(&newest);
 		} else {
+			apply_rate_commands(commands, actuatorDesiredAxis, dT);
+
+			// Save dT
+			actuatorDesired.UpdateTime = dT * 1000;
+			actuatorDesired.Throttle = stabDesired.Throttle;
+
+			if (enabled)
+				ActuatorDesiredSet(&actuatorDesired);
+		}
+
+		latency_add(&latency[LATENCY_ATTITUDE_LOOP], PIOS_DELAY_DiffuS(loop_start));
+		latency_count++;
+
+		// Both loops ran here, so the setpoints were used as soon as they were computed
+		if (!decoupled)
+			rate_latency_record(gyrosData.timestamp, loop_start, 0, 0, dT);
+
+		if (PIOS_DELAY_DiffuS(latency_timeval) > LATENCY_PERIOD_MS * 1000) {
+			latency_timeval = PIOS_DELAY_GetRaw();
+
+			uint16_t value[2];
+			latency_flush(&latency[LATENCY_ATTITUDE_LOOP], latency_count, value);
+			StabilizationLatencyAttitudeLoopSet(value);
+			latency_flush(&latency[LATENCY_ATTITUDE_PERIOD], latency_count, value);
+			StabilizationLatencyAttitudeLoopPeriodSet(value);
+			latency_count = 0;
+
+			if (!decoupled)
+				flush_rate_latency();
+		}
+
+		if (!enabled) {
 			// Force all axes to reinitialize when engaged
 			for(uint8_t i=0; i< MAX_AXES; i++)
 				previous_mode[i] = 255;
@@ -796,6 +1015,355 @@ static void stabilizationTask(void* parameters)
 	}
 }
 
+/**
+ * Rate loop task, only started when the rate loop is decoupled.  Runs the
+ * rate PIDs on every gyro update with the newest setpoints from the
+ * attitude loop.
+ */
+static void stabilizationRateTask(void* parameters)
+{
+	UAVObjEvent ev;
+	GyrosData gyrosData;
+
+	while(1) {
+		PIOS_WDG_UpdateFlag(PIOS_WDG_STABILIZATION);
+
+		if (PIOS_Queue_Receive(rateQueue, &ev, FAILSAFE_TIMEOUT_MS) != true)
+		{
+			AlarmsSet(SYSTEMALARMS_ALARM_STABILIZATION,SYSTEMALARMS_ALARM_WARNING);
+			continue;
+		}
+
+		uint32_t loop_start = PIOS_DELAY_GetRaw();
+
+		GyrosGet(&gyrosData);
+		rate_loop_update(&gyrosData, loop_start);
+	}
+}
+
+/**
+ * Run the decoupled rate loop on a new gyro sample
+ * @param[in] gyrosData The new gyro sample
+ * @param[in] loop_start When the sample was picked up
+ */
+static void rate_loop_update(const GyrosData *gyrosData, uint32_t loop_start)
+{
+	// The rate loop is the only writer of ActuatorDesired while enabled
+	static ActuatorDesiredData actuatorDesired;
+	static struct rate_setpoints current;
+	static bool have_setpoints = false;
+	static uint32_t latency_timeval;
+	static uint32_t publish_timeval;
+
+	float dT = loop_clock_update(&rate_clock);
+
+	if (gyro_filter_updated)
+		update_filter_constants();
+
+	filter_gyros(gyrosData);
+
+	// Keep using the previous setpoints if the copy was torn
+	if (read_setpoints(&current))
+		have_setpoints = true;
+	if (!have_setpoints)
+		return;
+
+	// The attitude loop clears this again once it catches up
+	uint32_t setpoint_age = PIOS_DELAY_DiffuS2(current.timestamp, loop_start);
+	if (setpoint_age > FAILSAFE_TIMEOUT_MS * 1000)
+		AlarmsSet(SYSTEMALARMS_ALARM_STABILIZATION,SYSTEMALARMS_ALARM_WARNING);
+
+	apply_rate_commands(current.axis, &actuatorDesired.Roll, dT);
+
+	// Save dT
+	actuatorDesired.UpdateTime = dT * 1000;
+	actuatorDesired.Throttle = current.throttle;
+
+	uint32_t output_time = 0;
+
+	if (direct) {
+		if (current.enabled) {
+			direct_output(&actuatorDesired);
+			output_time = PIOS_DELAY_GetRaw();
+
+			// Still publish for telemetry and the actuator failsafe, just less often
+			if (PIOS_DELAY_DiffuS(publish_timeval) > DIRECT_PUBLISH_MS * 1000) {
+				publish_timeval = PIOS_DELAY_GetRaw();
+				ActuatorDesiredSet(&actuatorDesired);
+			}
+		} else {
+			direct_output(NULL);
+		}
+	} else if (current.enabled) {
+		ActuatorDesiredSet(&actuatorDesired);
+	}
+
+	rate_latency_record(gyrosData->timestamp, loop_start, output_time, setpoint_age, dT);
+
+	if (PIOS_DELAY_DiffuS(latency_timeval) > LATENCY_PERIOD_MS * 1000) {
+		latency_timeval = PIOS_DELAY_GetRaw();
+		flush_rate_latency();
+	}
+}
+
+/**
+ * Advance the time base of a control loop
+ * @param[in] clock The clock of the loop that just woke up
+ * @return The time since the previous update in seconds
+ */
+static float loop_clock_update(struct loop_clock *clock)
+{
+	float dT = PIOS_DELAY_DiffuS(clock->timeval) * 1.0e-6f;
+	clock->timeval = PIOS_DELAY_GetRaw();
+	clock->iteration++;
+
+	// exponential moving averaging (EMA) of dT to reduce jitter; ~200points
+	// to have more or less equivalent noise reduction to a normal N point moving averaging:  alpha = 2 / (N + 1)
+	// run it only at the beginning for the first samples, to reduce CPU load, and the value should converge to a constant value
+
+	if (clock->iteration < 100) {
+		clock->dT_filtered = dT;
+	} else if (clock->iteration < 2000) {
+		clock->dT_filtered = 0.01f * dT + (1.0f - 0.01f) * clock->dT_filtered;
+	} else if (clock->iteration == 2000) {
+		gyro_filter_updated = true;
+	}
+
+	return dT;
+}
+
+/**
+ * Recompute the gyro filter and virtual flybar constants from the loop rates
+ */
+static void update_filter_constants(void)
+{
+	gyro_filter_updated = false;
+
+	if (settings.GyroCutoff < 1.0f) {
+		gyro_alpha = 0;
+	} else {
+		gyro_alpha = expf(-2.0f * (float)(M_PI) *
+				settings.GyroCutoff * rate_clock.dT_filtered);
+	}
+
+	// The virtual flybar runs in the attitude loop
+	float dT_vbar = decoupled ? attitude_clock.dT_filtered : rate_clock.dT_filtered;
+
+	// Compute time constant for vbar decay term
+	if (settings.VbarTau < 0.001f) {
+		vbar_decay = 0;
+	} else {
+		vbar_decay = expf(-dT_vbar / settings.VbarTau);
+	}
+
+	if (notch_enabled && rate_clock.dT_filtered > 0) {
+		for (uint8_t i = 0; i < NELEMENTS(gyro_notch); i++)
+			dynamic_notch_configure(&gyro_notch[i], 1.0f / rate_clock.dT_filtered, settings.DynamicNotchQ);
+
+		// Apply the new minimum frequency too
+		notch_updated = true;
+	}
+}
+
+/**
+ * Low pass the gyros for the rate loop
+ * @param[in] gyros The newest gyro data
+ */
+static void filter_gyros(const GyrosData *gyros)
+{
+	float gyro[MAX_AXES] = { gyros->x, gyros->y, gyros->z };
+
+	if (notch_enabled) {
+		if (notch_updated)
+			update_notch_center();
+
+		for (uint8_t i = 0; i < NELEMENTS(gyro_notch); i++)
+			dynamic_notch_apply(&gyro_notch[i], gyro);
+	}
+
+	gyro_filtered[0] = gyro_filtered[0] * gyro_alpha + gyro[0] * (1 - gyro_alpha);
+	gyro_filtered[1] = gyro_filtered[1] * gyro_alpha + gyro[1] * (1 - gyro_alpha);
+	gyro_filtered[2] = gyro_filtered[2] * gyro_alpha + gyro[2] * (1 - gyro_alpha);
+}
+
+/**
+ * Move the gyro notches to the latest vibration peak.  Runs in the rate loop
+ * so the coefficients never change under a running filter.
+ */
+static void update_notch_center(void)
+{
+	notch_updated = false;
+
+	VibrationAnalysisPeakData peak;
+	VibrationAnalysisPeakGet(&peak);
+
+	// Only the SensorBurst source of the analysis publishes a peak, keep
+	// passing everything rather than pin the notch at the minimum
+	if (peak.SampleRate <= 0)
+		return;
+
+	// The motors shake every axis, follow whichever sees them the most
+	uint8_t axis = 0;
+	for (uint8_t i = 1; i < VIBRATIONANALYSISPEAK_AMPLITUDE_NUMELEM; i++) {
+		if (peak.Amplitude[i] > peak.Amplitude[axis])
+			axis = i;
+	}
+
+	// Peaks below the minimum are not motor noise, hold the notch there
+	// rather than switch it off and on as the throttle moves
+	float center = MAX(peak.Frequency[axis], settings.DynamicNotchMinFreq);
+
+	dynamic_notch_set_center(&gyro_notch[0], center);
+	dynamic_notch_set_center(&gyro_notch[1], 2 * center);
+}
+
+/**
+ * Flag a new vibration peak for the rate loop to pick up
+ */
+static void NotchPeakUpdatedCb(UAVObjEvent * ev)
+{
+	notch_updated = true;
+}
+
+/**
+ * Run the rate loop on the commands from the attitude loop
+ * @param[in] commands The command for each axis
+ * @param[out] actuatorDesiredAxis The roll, pitch and yaw outputs
+ * @param[in] dT The time since the previous rate loop update
+ */
+static void apply_rate_commands(const struct rate_command *commands, float *actuatorDesiredAxis, float dT)
+{
+	static uint8_t resets_seen[MAX_AXES];
+
+	for(uint8_t i=0; i< MAX_AXES; i++) {
+		struct pid *pid = &pids[PID_GROUP_RATE + i];
+
+		pid_configure(pid, commands[i].gains.kp, commands[i].gains.ki,
+		              commands[i].gains.kd, commands[i].gains.ilimit);
+
+		if (commands[i].resets != resets_seen[i]) {
+			pid->iAccumulator = 0;
+			resets_seen[i] = commands[i].resets;
+		}
+
+		if (!commands[i].rate_pid) {
+			actuatorDesiredAxis[i] = commands[i].feedforward;
+			continue;
+		}
+
+		if (commands[i].hold_integral) {
+			pid->iAccumulator = 0;
+			pid->i = 0;
+		}
+
+		float output = pid_apply_setpoint(pid, commands[i].setpoint, gyro_filtered[i], dT);
+		actuatorDesiredAxis[i] = bound_sym(commands[i].feedforward + commands[i].gain * output, 1.0f);
+	}
+}
+
+/**
+ * Hand the attitude loop output to the rate loop without locking
+ * @param[in] newest The setpoints to publish
+ */
+static void publish_setpoints(const struct rate_setpoints *newest)
+{
+	seqlock_write_begin(&setpoints_seq);
+	setpoints = *newest;
+	seqlock_write_end(&setpoints_seq);
+}
+
+/**
+ * Copy the newest setpoints from the attitude loop
+ * @param[out] newest Where to copy them, unchanged without a consistent copy
+ * @return true if a consistent copy was made
+ *
+ * The rate loop can preempt the attitude loop in the middle of a publish,
+ * in which case the caller keeps the previous setpoints.
+ */
+static bool read_setpoints(struct rate_setpoints *newest)
+{
+	struct rate_setpoints copy;
+
+	// Nothing published yet
+	if (setpoints_seq == 0)
+		return false;
+
+	if (!seqlock_read(&setpoints_seq, &copy, &setpoints, sizeof(copy), SETPOINTS_READ_TRIES))
+		return false;
+
+	*newest = copy;
+	return true;
+}
+
+/**
+ * Add one measurement to a latency figure
+ */
+static void latency_add(struct latency_stat *stat, uint32_t value)
+{
+	stat->sum += value;
+	if (value > stat->max)
+		stat->max = value;
+}
+
+/**
+ * Get the mean and peak of a latency figure and start it over
+ * @param[in] stat The latency figure
+ * @param[in] count The number of measurements added since the last flush
+ * @param[out] out The mean and the peak in us
+ */
+static void latency_flush(struct latency_stat *stat, uint32_t count, uint16_t *out)
+{
+	out[0] = count ? MIN(stat->sum / count, UINT16_MAX) : 0;
+	out[1] = MIN(stat->max, UINT16_MAX);
+
+	stat->sum = 0;
+	stat->max = 0;
+}
+
+/**
+ * Record the latency of one rate loop update, call after ActuatorDesired is set
+ * @param[in] capture When the gyro sample was captured
+ * @param[in] loop_start When the rate loop woke up
+ * @param[in] output_time When the direct path updated the outputs, zero if it did not
+ * @param[in] setpoint_age How old the attitude loop setpoints were in us
+ * @param[in] dT The time since the previous rate loop update
+ */
+static void rate_latency_record(uint32_t capture, uint32_t loop_start, uint32_t output_time, uint32_t setpoint_age, float dT)
+{
+	uint32_t now = PIOS_DELAY_GetRaw();
+
+	latency_add(&rate_latency[LATENCY_GYRO_TO_RATE], PIOS_DELAY_DiffuS2(capture, loop_start));
+	latency_add(&rate_latency[LATENCY_RATE_LOOP], PIOS_DELAY_DiffuS2(loop_start, now));
+	latency_add(&rate_latency[LATENCY_GYRO_TO_ACTUATOR], PIOS_DELAY_DiffuS2(capture, now));
+	latency_add(&rate_latency[LATENCY_GYRO_TO_OUTPUT], output_time ? PIOS_DELAY_DiffuS2(capture, output_time) : 0);
+	latency_add(&rate_latency[LATENCY_SETPOINT_AGE], setpoint_age);
+	latency_add(&rate_latency[LATENCY_RATE_PERIOD], dT * 1.0e6f);
+	rate_latency_count++;
+}
+
+/**
+ * Publish the rate loop half of StabilizationLatency
+ */
+static void flush_rate_latency(void)
+{
+	uint16_t value[2];
+
+	latency_flush(&rate_latency[LATENCY_GYRO_TO_RATE], rate_latency_count, value);
+	StabilizationLatencyGyroToRateLoopSet(value);
+	latency_flush(&rate_latency[LATENCY_RATE_LOOP], rate_latency_count, value);
+	StabilizationLatencyRateLoopSet(value);
+	latency_flush(&rate_latency[LATENCY_GYRO_TO_ACTUATOR], rate_latency_count, value);
+	StabilizationLatencyGyroToActuatorDesiredSet(value);
+	latency_flush(&rate_latency[LATENCY_GYRO_TO_OUTPUT], rate_latency_count, value);
+	StabilizationLatencyGyroToOutputSet(value);
+	latency_flush(&rate_latency[LATENCY_SETPOINT_AGE], rate_latency_count, value);
+	StabilizationLatencySetpointAgeSet(value);
+	latency_flush(&rate_latency[LATENCY_RATE_PERIOD], rate_latency_count, value);
+	StabilizationLatencyRateLoopPeriodSet(value);
+
+	rate_latency_count = 0;
+}
+
 
 /**
  * Clear the accumulators and derivatives for all the axes
@@ -810,6 +1378,11 @@ static void zero_pids(void)
 		axis_lock_accum[i] = 0.0f;
 }
 
+/**
+ * Configure the PIDs from the settings, with the throttle PID attenuation.
+ * The rate PIDs belong to the rate loop, their gains are handed over with
+ * the rate commands instead.
+ */
 static void calculate_pids()
 {
 
@@ -869,25 +1442,28 @@ static void calculate_pids()
 	}
 
 	// Set the roll rate PID constants
-	pid_configure(&pids[PID_RATE_ROLL],
-	              settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KP] * roll_scale,
-	              settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KI],
-	              settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KD] * roll_scale,
-	              settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_ILIMIT]);
+	rate_gains[ROLL] = (struct rate_gains) {
+		.kp = settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KP] * roll_scale,
+		.ki = settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KI],
+		.kd = settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KD] * roll_scale,
+		.ilimit = settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_ILIMIT],
+	};
 
 	// Set the pitch rate PID constants
-	pid_configure(&pids[PID_RATE_PITCH],
-	              settings.PitchRatePID[STABILIZATIONSETTINGS_PITCHRATEPID_KP] * pitch_scale,
-	              settings.PitchRatePID[STABILIZATIONSETTINGS_PITCHRATEPID_KI],
-	              settings.PitchRatePID[STABILIZATIONSETTINGS_PITCHRATEPID_KD] * pitch_scale,
-	              settings.PitchRatePID[STABILIZATIONSETTINGS_PITCHRATEPID_ILIMIT]);
+	rate_gains[PITCH] = (struct rate_gains) {
+		.kp = settings.PitchRatePID[STABILIZATIONSETTINGS_PITCHRATEPID_KP] * pitch_scale,
+		.ki = settings.PitchRatePID[STABILIZATIONSETTINGS_PITCHRATEPID_KI],
+		.kd = settings.PitchRatePID[STABILIZATIONSETTINGS_PITCHRATEPID_KD] * pitch_scale,
+		.ilimit = settings.PitchRatePID[STABILIZATIONSETTINGS_PITCHRATEPID_ILIMIT],
+	};
 
 	// Set the yaw rate PID constants
-	pid_configure(&pids[PID_RATE_YAW],
-	              settings.YawRatePID[STABILIZATIONSETTINGS_YAWRATEPID_KP] * yaw_scale,
-	              settings.YawRatePID[STABILIZATIONSETTINGS_YAWRATEPID_KI],
-	              settings.YawRatePID[STABILIZATIONSETTINGS_YAWRATEPID_KD] * yaw_scale,
-	              settings.YawRatePID[STABILIZATIONSETTINGS_YAWRATEPID_ILIMIT]);
+	rate_gains[YAW] = (struct rate_gains) {
+		.kp = settings.YawRatePID[STABILIZATIONSETTINGS_YAWRATEPID_KP] * yaw_scale,
+		.ki = settings.YawRatePID[STABILIZATIONSETTINGS_YAWRATEPID_KI],
+		.kd = settings.YawRatePID[STABILIZATIONSETTINGS_YAWRATEPID_KD] * yaw_scale,
+		.ilimit = settings.YawRatePID[STABILIZATIONSETTINGS_YAWRATEPID_ILIMIT],
+	};
 
 	// Set the roll attitude PI constants
 	pid_configure(&pids[PID_ATT_ROLL],
@@ -76,6 +76,7 @@ static void registerObject(UAVObjHandle obj);
 static void updateObject(UAVObjHandle obj, int32_t eventType);
 static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs);
 static void processObjEvent(UAVObjEvent * ev);
+static int32_t sendObjectUpdate(UAVObjEvent * ev, UAVObjMetadata * metadata);
 static void updateTelemetryStats();
 static void gcsTelemetryStatsUpdated();
 static void updateSettings();
@@ -292,7 +293,7 @@ static void processObjEvent(UAVObjEvent * ev)
 				if((ev->obj !=FlightTelemetryStatsHandle()) && (ev->event == EV_UPDATED_PERIODIC) && pausePeriodicUpdates) {
 					success = 0;
 				} else {
-					success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS);	// call blocks until ack is received or timeout
+					success = sendObjectUpdate(ev, &metadata);
 				}
 				++retries;
 			}
@@ -326,7 +327,7 @@ static void processObjEvent(UAVObjEvent * ev)
 					if (pausePeriodicUpdates) {
 						success = 0;
 					} else {
-						success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS);	// call blocks until ack is received or timeout
+						success = sendObjectUpdate(ev, &metadata);
 					}
 					++retries;
 				}
@@ -349,6 +350,23 @@ static void processObjEvent(UAVObjEvent * ev)
 	}
 }
 
+/**
+ * Send an object update to the GCS. Acked updates block until the ack is
+ * received or the request times out, the others are batched when the GCS
+ * supports it and go out once the queue has been drained.  Objects flagged
+ * for delta telemetry are also delta encoded when the GCS supports it.
+ */
+static int32_t sendObjectUpdate(UAVObjEvent * ev, UAVObjMetadata * metadata)
+{
+	if (UAVObjGetTelemetryAcked(metadata))
+		return UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, 1, REQ_TIMEOUT_MS);
+
+	if (UAVObjIsTelemetryDelta(ev->obj))
+		return UAVTalkSendObjectDelta(uavTalkCon, ev->obj, ev->instId);
+
+	return UAVTalkSendObjectBatched(uavTalkCon, ev->obj, ev->instId);
+}
+
 /**
  * Telemetry transmit task, regular priority
  */
@@ -358,11 +376,15 @@ static void telemetryTxTask(void *parameters)
 
 	// Loop forever
 	while (1) {
-		// Wait for queue message
-		if (PIOS_Queue_Receive(queue, &ev, PIOS_QUEUE_TIMEOUT_MAX) == true) {
-			// Process event
-			processObjEvent(&ev);
+		// Send any batched updates before waiting for more events
+		if (PIOS_Queue_Receive(queue, &ev, 0) != true) {
+			UAVTalkFlushBatch(uavTalkCon);
+			if (PIOS_Queue_Receive(queue, &ev, PIOS_QUEUE_TIMEOUT_MAX) != true)
+				continue;
 		}
+
+		// Process event
+		processObjEvent(&ev);
 	}
 }
 
@@ -376,11 +398,15 @@ static void telemetryTxPriTask(void *parameters)
 
 	// Loop forever
 	while (1) {
-		// Wait for queue message
-		if (PIOS_Queue_Receive(priorityQueue, &ev, PIOS_QUEUE_TIMEOUT_MAX) == true) {
-			// Process event
-			processObjEvent(&ev);
+		// Send any batched updates before waiting for more events
+		if (PIOS_Queue_Receive(priorityQueue, &ev, 0) != true) {
+			UAVTalkFlushBatch(uavTalkCon);
+			if (PIOS_Queue_Receive(priorityQueue, &ev, PIOS_QUEUE_TIMEOUT_MAX) != true)
+				continue;
 		}
+
+		// Process event
+		processObjEvent(&ev);
 	}
 }
 #endif
@@ -397,14 +423,13 @@ static void telemetryRxTask(void *parameters)
 
 		if (inputPort) {
 			// Block until data are available
-			uint8_t serial_data[1];
+			const uint8_t *serial_data;
 			uint16_t bytes_to_process;
 
-			bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), 500);
+			bytes_to_process = PIOS_COM_LendRxBuffer(inputPort, &serial_data, 500);
 			if (bytes_to_process > 0) {
-				for (uint8_t i = 0; i < bytes_to_process; i++) {
-					UAVTalkProcessInputStream(uavTalkCon,serial_data[i]);
-				}
+				UAVTalkProcessInputBuffer(uavTalkCon, serial_data, bytes_to_process);
+				PIOS_COM_ReleaseRxBuffer(inputPort, bytes_to_process);
 			}
 		} else {
 			PIOS_Thread_Sleep(5);
@@ -473,6 +498,7 @@ static void updateTelemetryStats()
 	GCSTelemetryStatsData gcsStats;
 	uint8_t forceUpdate;
 	uint8_t connectionTimeout;
+	uint8_t oldStatus;
 	uint32_t timeNow;
 
 	// Get stats
@@ -515,6 +541,7 @@ static void updateTelemetryStats()
 
 	// Update connection state
 	forceUpdate = 1;
+	oldStatus = flightStats.Status;
 	if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_DISCONNECTED) {
 		// Wait for connection request
 		if (gcsStats.Status == GCSTELEMETRYSTATS_STATUS_HANDSHAKEREQ) {
@@ -537,6 +564,12 @@ static void updateTelemetryStats()
 		flightStats.Status = FLIGHTTELEMETRYSTATS_STATUS_DISCONNECTED;
 	}
 
+	// The next GCS may be older, it has to announce batching and delta support again
+	if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_DISCONNECTED && oldStatus != FLIGHTTELEMETRYSTATS_STATUS_DISCONNECTED) {
+		UAVTalkSetBatching(uavTalkCon, false);
+		UAVTalkSetDelta(uavTalkCon, false);
+	}
+
 	// Update the telemetry alarm
 	if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
 		AlarmsClear(SYSTEMALARMS_ALARM_TELEMETRY);
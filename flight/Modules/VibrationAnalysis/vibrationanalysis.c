@@ -30,11 +30,19 @@
 
 /**
  * Input objects: @ref Accels, @ref VibrationAnalysisSettings
- * Output object: @ref VibrationAnalysisOutput
+ * Output object: @ref VibrationAnalysisOutput, @ref VibrationAnalysisPeak
  *
  * This module executes on a timer trigger. When the module is
  * triggered it will update the data of VibrationAnalysiOutput, based on
  * the output of an FFT running on the accelerometer samples. 
+ *
+ * With Source set to SensorBurst the samples are instead taken straight
+ * from the accel bursts the Sensors module drains, at the full sensor
+ * rate, through a tap on the sensor ring.  That is fast enough to see
+ * motor noise, and VibrationAnalysisPeak then steers the dynamic gyro
+ * notch in @ref StabilizationModule.  The averaged samples can not show
+ * anything above half their rate, far below motor noise, so with that
+ * source VibrationAnalysisPeak is not published and the notch stays off.
  */
 
 #include "openpilot.h"
@@ -42,10 +50,14 @@
 #include "arm_math.h"
 #include "pios_thread.h"
 #include "pios_queue.h"
+#include "pios_semaphore.h"
+#include "pios_sensors.h"
+#include "misc_math.h"
 
 #include "accels.h"
 #include "modulesettings.h"
 #include "vibrationanalysisoutput.h"
+#include "vibrationanalysispeak.h"
 #include "vibrationanalysissettings.h"
 
 
@@ -64,6 +76,7 @@
 
 #define MAX_ACCEL_RANGE 16                          // Maximum accelerometer resolution in [g]
 #define FLOAT_TO_Q15 (32768/(MAX_ACCEL_RANGE*GRAVITY)) // This is the scaling constant that scales all input floats to +-
+#define PEAK_MIN_BIN 2                              // Skip DC and its leakage when looking for the peak
 
 // Private variables
 static struct pios_thread *taskHandle;
@@ -88,11 +101,26 @@ static struct VibrationAnalysis_data {
 	int16_t *accel_buffer_complex_z_q15;
 	
 	int16_t *fft_output;
+
+	// Sensor burst source. The window holds fft_window_size samples of x,
+	// then y, then z, and each axis is overwritten by its spectrum.
+	bool burst;
+	int16_t *burst_window;
+	int16_t *burst_work;
+	volatile bool burst_enabled;
+	volatile bool burst_ready;
+	volatile uint16_t burst_count;
+	uint32_t burst_first_time;
+	uint32_t burst_last_time;
+	struct pios_semaphore *burst_sem;
 } *vtd;
 
 
 // Private functions
 static void VibrationAnalysisTask(void *parameters);
+static void accel_burst_tap(const void *samples, const uint32_t *timestamps, uint16_t count);
+static void fft_magnitude(arm_cfft_radix4_instance_q15 *cfft_instance, int16_t *cmplx, int16_t *magnitude);
+static void publish_spectrum(int16_t * const spectrum[3], float sample_hz, bool with_peak);
 
 /**
  * Start the module, called on startup
@@ -168,6 +196,29 @@ static int32_t VibrationAnalysisStart(void)
 	// Now place the fft window size and number of upscale bits variables into the buffer
 	vtd->fft_window_size = fft_window_size;
 	vtd->num_upscale_bits = num_upscale_bits;
+
+	// Sample straight from the sensor bursts when the accel delivers them
+	uint8_t source;
+	VibrationAnalysisSettingsSourceGet(&source);
+	struct pios_sensor_ring *accel_ring = PIOS_SENSORS_GetRing(PIOS_SENSOR_ACCEL);
+	if (source == VIBRATIONANALYSISSETTINGS_SOURCE_SENSORBURST && accel_ring != NULL) {
+		// One window for all three axes and one complex buffer the FFT reuses
+		vtd->burst_window = (int16_t *) PIOS_malloc(fft_window_size*3*sizeof(typeof(*vtd->burst_window)));
+		vtd->burst_work = (int16_t *) PIOS_malloc(fft_window_size*2*sizeof(typeof(*vtd->burst_work)));
+		vtd->burst_sem = PIOS_Semaphore_Create();
+		if (vtd->burst_window == NULL || vtd->burst_work == NULL || vtd->burst_sem == NULL) {
+			module_enabled = false;
+			return -1;
+		}
+
+		vtd->burst = true;
+		PIOS_SENSORS_SetTap(accel_ring, accel_burst_tap);
+
+		// Start main task
+		taskHandle = PIOS_Thread_Create(VibrationAnalysisTask, "VibrationAnalysis", STACK_SIZE_BYTES, NULL, TASK_PRIORITY);
+		TaskMonitorAdd(TASKINFO_RUNNING_VIBRATIONANALYSIS, taskHandle);
+		return 0;
+	}
 	
 	// Allocate ouput vector
 	vtd->fft_output = (int16_t *) PIOS_malloc(fft_window_size*2*sizeof(typeof(*(vtd->fft_output))));
@@ -225,6 +276,7 @@ static int32_t VibrationAnalysisInitialize(void)
 	// Initialize UAVOs
 	VibrationAnalysisSettingsInitialize();
 	VibrationAnalysisOutputInitialize();
+	VibrationAnalysisPeakInitialize();
 		
 	// Create object queue
 	queue = PIOS_Queue_Create(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
@@ -247,7 +299,8 @@ static void VibrationAnalysisTask(void *parameters)
 	UAVObjEvent ev;
 	
 	// Listen for updates.
-	AccelsConnectQueue(queue);
+	if (!vtd->burst)
+		AccelsConnectQueue(queue);
 	
 	// Declare FFT structure and status variable
 	arm_cfft_radix4_instance_q15 cfft_instance;
@@ -267,7 +320,6 @@ static void VibrationAnalysisTask(void *parameters)
  */
 
 	// Main task loop
-	VibrationAnalysisOutputData vibrationAnalysisOutputData;
 	sample_count = 0;
 	lastSysTime = PIOS_Thread_Systime();
 	lastSettingsUpdateTime = PIOS_Thread_Systime() - SETTINGS_THROTTLING_MS;
@@ -290,9 +342,60 @@ static void VibrationAnalysisTask(void *parameters)
 		
 		// If analysis is turned off, delay and then loop.
 		if (runAnalysisFlag == VIBRATIONANALYSISSETTINGS_TESTINGSTATUS_OFF) {
+			vtd->burst_enabled = false;
+
+			// Start the next window afresh, not from the time of a partial one
+			__sync_synchronize();
+			vtd->burst_count = 0;
+			vtd->burst_ready = false;
+
 			PIOS_Thread_Sleep(200);
 			continue;
 		}
+
+		if (vtd->burst) {
+			vtd->burst_enabled = true;
+
+			// The tap fills the window from the sensor task and wakes us when it is full
+			if (PIOS_Semaphore_Take(vtd->burst_sem, 200) != true || !vtd->burst_ready)
+				continue;
+
+			uint16_t n = vtd->fft_window_size;
+			uint32_t window_us = PIOS_DELAY_DiffuS2(vtd->burst_first_time, vtd->burst_last_time);
+			float sample_hz = window_us > 0 ? (n - 1) * 1e6f / window_us : 0;
+			int16_t *spectrum[3];
+
+			for (int i=0; i < 3; i++) {
+				int16_t *window = &vtd->burst_window[i * n];
+
+				// Remove the window mean, which is mostly gravity
+				int32_t sum = 0;
+				for (int j=0; j < n; j++)
+					sum += window[j];
+				int32_t mean = sum / n;
+
+				for (int j=0; j < n; j++) {
+					int32_t sample = window[j] - mean;
+					vtd->burst_work[j*2] = sample > INT16_MAX ? INT16_MAX : (sample < INT16_MIN ? INT16_MIN : sample);
+					vtd->burst_work[j*2 + 1] = 0;
+				}
+
+				// The samples are consumed, so the spectrum goes over them
+				spectrum[i] = window;
+				if (status == ARM_MATH_SUCCESS)
+					fft_magnitude(&cfft_instance, vtd->burst_work, spectrum[i]);
+			}
+
+			if (status == ARM_MATH_SUCCESS && sample_hz > 0)
+				publish_spectrum(spectrum, sample_hz, true);
+
+			// Hand the window back to the tap, which must see the count
+			// cleared once it sees the window free
+			vtd->burst_count = 0;
+			__sync_synchronize();
+			vtd->burst_ready = false;
+			continue;
+		}
 		
 		// Wait until the Accels object is updated, and never time out
 		if (PIOS_Queue_Receive(queue, &ev, PIOS_QUEUE_TIMEOUT_MAX) == true)
@@ -375,25 +478,7 @@ static void VibrationAnalysisTask(void *parameters)
 							continue;
 					}
 					
-					// Process the data through the CFFT/CIFFT module. This is an in-place
-					// operation, so the FFT output is saved onto the accelerometer input buffer. 
-					// Moving forward from this point, ptr_cmplx_vec contains the DFT of the
-					// acceleration signal. 
-					// While the input is Q15, the output is not (see next comment)
-					arm_cfft_radix4_q15(&cfft_instance, ptr_cmplx_vec);
-					
-					// Upscale ptr_cmplx_vec back into Q15 format. The number of bits necessary is defined in 
-					// ARM's arm_cfft_radix4_q15 documentation, figure CFFTQ15.gif
-					arm_shift_q15(ptr_cmplx_vec, vtd->num_upscale_bits, ptr_cmplx_vec, vtd->fft_window_size);
-					
-					// Process the data through the Complex Magnitude Module. This calculates
-					// the magnitude of each complex number, so that the output is a scalar
-					// magnitude without complex phase. Only the first half of the values are
-					// calculated because in a Fourier transform the second half is symmetric.
-					arm_cmplx_mag_q15(ptr_cmplx_vec, vtd->fft_output, vtd->fft_window_size>>1);
-					
-					// Upscale fft_output back into Q15 format
-					arm_shift_q15(vtd->fft_output, 1, vtd->fft_output, vtd->fft_window_size>>1);
+					fft_magnitude(&cfft_instance, ptr_cmplx_vec, vtd->fft_output);
 					
 					// Save RAM by copying back onto original input vector.
 					memcpy(ptr_cmplx_vec, vtd->fft_output, (vtd->fft_window_size>>1) * sizeof(typeof(*vtd->accel_buffer_complex_x_q15)));
@@ -401,17 +486,12 @@ static void VibrationAnalysisTask(void *parameters)
 			}
 			
 			//Write output to UAVO
-			for (int j=0; j < (vtd->fft_window_size>>1); j++) 
-			{
-				//Assertion check that we are not trying to write to instances that don't exist
-				if (j >= VibrationAnalysisOutputGetNumInstances())
-					continue;
-				
-				vibrationAnalysisOutputData.x = vtd->accel_buffer_complex_x_q15[j]/FLOAT_TO_Q15;
-				vibrationAnalysisOutputData.y = vtd->accel_buffer_complex_y_q15[j]/FLOAT_TO_Q15;
-				vibrationAnalysisOutputData.z = vtd->accel_buffer_complex_z_q15[j]/FLOAT_TO_Q15;
-				VibrationAnalysisOutputInstSet(j, &vibrationAnalysisOutputData);
-			}
+			int16_t * const spectrum[3] = {
+				vtd->accel_buffer_complex_x_q15,
+				vtd->accel_buffer_complex_y_q15,
+				vtd->accel_buffer_complex_z_q15
+			};
+			publish_spectrum(spectrum, 1000.0f / sampleRate_ms, false);
 			
 			
 			// Erase buffer, which has the effect of setting the complex part to 0.
@@ -422,6 +502,120 @@ static void VibrationAnalysisTask(void *parameters)
 	}
 }
 
+/**
+ * Collect accel samples from the bursts the sensor task drains. Runs in
+ * the sensor task, so it only converts and stores the samples.
+ * @param[in] samples The burst of raw accel samples
+ * @param[in] timestamps When each sample was captured
+ * @param[in] count The number of samples in the burst
+ */
+static void accel_burst_tap(const void *samples, const uint32_t *timestamps, uint16_t count)
+{
+	const struct pios_sensor_accel_data *accels = samples;
+	const uint16_t n = vtd->fft_window_size;
+
+	// Drop samples while the previous window is still being transformed
+	if (!vtd->burst_enabled || vtd->burst_ready)
+		return;
+
+	for (uint16_t i = 0; i < count; i++) {
+		uint32_t timestamp = timestamps != NULL ? timestamps[i] : PIOS_DELAY_GetRaw();
+		if (vtd->burst_count == 0)
+			vtd->burst_first_time = timestamp;
+
+		int16_t *sample = &vtd->burst_window[vtd->burst_count];
+		sample[0] = bound_sym(accels[i].x * FLOAT_TO_Q15, INT16_MAX);
+		sample[n] = bound_sym(accels[i].y * FLOAT_TO_Q15, INT16_MAX);
+		sample[2*n] = bound_sym(accels[i].z * FLOAT_TO_Q15, INT16_MAX);
+
+		if (++vtd->burst_count == n) {
+			vtd->burst_last_time = timestamp;
+			vtd->burst_ready = true;
+			PIOS_Semaphore_Give(vtd->burst_sem);
+			return;
+		}
+	}
+}
+
+/**
+ * Compute the magnitude of the first half of the spectrum of one axis
+ * @param[in] cfft_instance The FFT to run
+ * @param[in,out] cmplx The complex Q15 samples, overwritten by the FFT
+ * @param[out] magnitude The fft_window_size/2 magnitudes in Q15
+ */
+static void fft_magnitude(arm_cfft_radix4_instance_q15 *cfft_instance, int16_t *cmplx, int16_t *magnitude)
+{
+	// Process the data through the CFFT/CIFFT module. This is an in-place
+	// operation, so the FFT output is saved onto the input buffer.
+	// While the input is Q15, the output is not (see next comment)
+	arm_cfft_radix4_q15(cfft_instance, cmplx);
+
+	// Upscale cmplx back into Q15 format. The number of bits necessary is defined in
+	// ARM's arm_cfft_radix4_q15 documentation, figure CFFTQ15.gif
+	arm_shift_q15(cmplx, vtd->num_upscale_bits, cmplx, vtd->fft_window_size);
+
+	// Process the data through the Complex Magnitude Module. This calculates
+	// the magnitude of each complex number, so that the output is a scalar
+	// magnitude without complex phase. Only the first half of the values are
+	// calculated because in a Fourier transform the second half is symmetric.
+	arm_cmplx_mag_q15(cmplx, magnitude, vtd->fft_window_size>>1);
+
+	// Upscale magnitude back into Q15 format
+	arm_shift_q15(magnitude, 1, magnitude, vtd->fft_window_size>>1);
+}
+
+/**
+ * Publish the spectrum of each axis and the strongest peak in it
+ * @param[in] spectrum The fft_window_size/2 Q15 magnitudes for x, y and z
+ * @param[in] sample_hz The rate the analysed samples were taken at
+ * @param[in] with_peak Whether to publish the peak for the dynamic notch as well
+ */
+static void publish_spectrum(int16_t * const spectrum[3], float sample_hz, bool with_peak)
+{
+	const uint16_t bins = vtd->fft_window_size >> 1;
+
+	VibrationAnalysisOutputData vibrationAnalysisOutputData;
+	for (int j=0; j < bins; j++)
+	{
+		//Assertion check that we are not trying to write to instances that don't exist
+		if (j >= VibrationAnalysisOutputGetNumInstances())
+			continue;
+
+		vibrationAnalysisOutputData.x = spectrum[0][j]/FLOAT_TO_Q15;
+		vibrationAnalysisOutputData.y = spectrum[1][j]/FLOAT_TO_Q15;
+		vibrationAnalysisOutputData.z = spectrum[2][j]/FLOAT_TO_Q15;
+		VibrationAnalysisOutputInstSet(j, &vibrationAnalysisOutputData);
+	}
+
+	if (!with_peak)
+		return;
+
+	VibrationAnalysisPeakData peak;
+	peak.SampleRate = sample_hz;
+
+	for (int i=0; i < 3; i++) {
+		const int16_t *s = spectrum[i];
+		uint16_t k = PEAK_MIN_BIN;
+		for (uint16_t j = PEAK_MIN_BIN + 1; j < bins; j++) {
+			if (s[j] > s[k])
+				k = j;
+		}
+
+		// Fit a parabola through the peak and its neighbours to place it between bins
+		float offset = 0;
+		if (k + 1 < bins) {
+			float denom = s[k-1] - 2.0f * s[k] + s[k+1];
+			if (denom < 0)
+				offset = 0.5f * (s[k-1] - s[k+1]) / denom;
+		}
+
+		peak.Frequency[i] = (k + offset) * sample_hz / vtd->fft_window_size;
+		peak.Amplitude[i] = s[k] / FLOAT_TO_Q15;
+	}
+
+	VibrationAnalysisPeakSet(&peak);
+}
+
 /**
  * @}
  * @}
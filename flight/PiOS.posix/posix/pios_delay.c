@@ -109,4 +109,11 @@ uint32_t PIOS_DELAY_DiffuS(uint32_t ref)
 	uint32_t diff_us = diff_clock; // (CLOCKS_PER_SEC / 1000);
 	return diff_us;
 }
+
+uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later)
+{
+	uint32_t diff_clock = later - raw;
+	uint32_t diff_us = diff_clock; // (CLOCKS_PER_SEC / 1000);
+	return diff_us;
+}
 #endif
@@ -511,6 +511,82 @@ uint16_t PIOS_COM_ReceiveBuffer(uintptr_t com_id, uint8_t * buf, uint16_t buf_le
 	return (bytes_from_fifo);
 }
 
+/**
+ * Lend the oldest received bytes straight out of the port buffer
+ * \param[in] com_id COM port
+ * \param[out] buf Set to the start of the received bytes
+ * \param[in] timeout_ms Time to wait for bytes if none are buffered
+ * \return Number of contiguous bytes at buf, 0 if none arrived in time
+ * \note The bytes stay valid until they are given back with PIOS_COM_ReleaseRxBuffer().
+ * Buffered bytes that wrap around the end of the port buffer are lent by the next call.
+ */
+uint16_t PIOS_COM_LendRxBuffer(uintptr_t com_id, const uint8_t ** buf, uint32_t timeout_ms)
+{
+	PIOS_Assert(buf);
+	uint16_t bytes_in_fifo;
+	uint8_t *region;
+
+	struct pios_com_dev * com_dev = (struct pios_com_dev *)com_id;
+
+	if (!PIOS_COM_validate(com_dev)) {
+		/* Undefined COM port for this board (see pios_board.c) */
+		PIOS_Assert(0);
+	}
+	PIOS_Assert(com_dev->has_rx);
+
+ check_again:
+	bytes_in_fifo = fifoBuf_getReadRegion(&com_dev->rx, &region);
+
+	if (bytes_in_fifo == 0) {
+		/* No more bytes in receive buffer */
+		/* Make sure the receiver is running while we wait */
+		if (com_dev->driver->rx_start) {
+			(com_dev->driver->rx_start)(com_dev->lower_id,
+						    fifoBuf_getFree(&com_dev->rx));
+		}
+		if (timeout_ms > 0) {
+#if defined(PIOS_INCLUDE_FREERTOS) || defined(PIOS_INCLUDE_CHIBIOS)
+			if (PIOS_Semaphore_Take(com_dev->rx_sem, timeout_ms) == true) {
+				/* Make sure we don't come back here again */
+				timeout_ms = 0;
+				goto check_again;
+			}
+#else
+			PIOS_DELAY_WaitmS(1);
+			timeout_ms--;
+			goto check_again;
+#endif
+		}
+	}
+
+	*buf = region;
+	return (bytes_in_fifo);
+}
+
+/**
+ * Give bytes lent by PIOS_COM_LendRxBuffer() back to the port buffer
+ * \param[in] com_id COM port
+ * \param[in] len Number of bytes consumed, at most the number lent
+ */
+void PIOS_COM_ReleaseRxBuffer(uintptr_t com_id, uint16_t len)
+{
+	struct pios_com_dev * com_dev = (struct pios_com_dev *)com_id;
+
+	if (!PIOS_COM_validate(com_dev)) {
+		/* Undefined COM port for this board (see pios_board.c) */
+		PIOS_Assert(0);
+	}
+	PIOS_Assert(com_dev->has_rx);
+
+	fifoBuf_removeData(&com_dev->rx, len);
+
+	if (com_dev->driver->rx_start) {
+		/* Notify the lower layer that there is now room in the rx buffer */
+		(com_dev->driver->rx_start)(com_dev->lower_id,
+					    fifoBuf_getFree(&com_dev->rx));
+	}
+}
+
 /**
  * Query if a com port is available for use.  That can be
  * used to check a link is established even if the device
@@ -29,6 +29,71 @@ static const uint8_t crc_table[256] = {
 	0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3
 };
 
+/*
+ * The buffer functions process four bytes per step using slice-by-4 tables:
+ * slice k gives the effect of a byte followed by k+1 zero bytes.  They cost
+ * 2.3kB of flash, boards short on it can define PIOS_CRC_NO_SLICE_BY_4 in
+ * pios_config.h to process one byte per step instead.
+ */
+#if !defined(PIOS_CRC_NO_SLICE_BY_4)
+static const uint8_t crc_table_slice[3][256] = {
+	{
+		0x00, 0x15, 0x2a, 0x3f, 0x54, 0x41, 0x7e, 0x6b, 0xa8, 0xbd, 0x82, 0x97, 0xfc, 0xe9, 0xd6, 0xc3,
+		0x57, 0x42, 0x7d, 0x68, 0x03, 0x16, 0x29, 0x3c, 0xff, 0xea, 0xd5, 0xc0, 0xab, 0xbe, 0x81, 0x94,
+		0xae, 0xbb, 0x84, 0x91, 0xfa, 0xef, 0xd0, 0xc5, 0x06, 0x13, 0x2c, 0x39, 0x52, 0x47, 0x78, 0x6d,
+		0xf9, 0xec, 0xd3, 0xc6, 0xad, 0xb8, 0x87, 0x92, 0x51, 0x44, 0x7b, 0x6e, 0x05, 0x10, 0x2f, 0x3a,
+		0x5b, 0x4e, 0x71, 0x64, 0x0f, 0x1a, 0x25, 0x30, 0xf3, 0xe6, 0xd9, 0xcc, 0xa7, 0xb2, 0x8d, 0x98,
+		0x0c, 0x19, 0x26, 0x33, 0x58, 0x4d, 0x72, 0x67, 0xa4, 0xb1, 0x8e, 0x9b, 0xf0, 0xe5, 0xda, 0xcf,
+		0xf5, 0xe0, 0xdf, 0xca, 0xa1, 0xb4, 0x8b, 0x9e, 0x5d, 0x48, 0x77, 0x62, 0x09, 0x1c, 0x23, 0x36,
+		0xa2, 0xb7, 0x88, 0x9d, 0xf6, 0xe3, 0xdc, 0xc9, 0x0a, 0x1f, 0x20, 0x35, 0x5e, 0x4b, 0x74, 0x61,
+		0xb6, 0xa3, 0x9c, 0x89, 0xe2, 0xf7, 0xc8, 0xdd, 0x1e, 0x0b, 0x34, 0x21, 0x4a, 0x5f, 0x60, 0x75,
+		0xe1, 0xf4, 0xcb, 0xde, 0xb5, 0xa0, 0x9f, 0x8a, 0x49, 0x5c, 0x63, 0x76, 0x1d, 0x08, 0x37, 0x22,
+		0x18, 0x0d, 0x32, 0x27, 0x4c, 0x59, 0x66, 0x73, 0xb0, 0xa5, 0x9a, 0x8f, 0xe4, 0xf1, 0xce, 0xdb,
+		0x4f, 0x5a, 0x65, 0x70, 0x1b, 0x0e, 0x31, 0x24, 0xe7, 0xf2, 0xcd, 0xd8, 0xb3, 0xa6, 0x99, 0x8c,
+		0xed, 0xf8, 0xc7, 0xd2, 0xb9, 0xac, 0x93, 0x86, 0x45, 0x50, 0x6f, 0x7a, 0x11, 0x04, 0x3b, 0x2e,
+		0xba, 0xaf, 0x90, 0x85, 0xee, 0xfb, 0xc4, 0xd1, 0x12, 0x07, 0x38, 0x2d, 0x46, 0x53, 0x6c, 0x79,
+		0x43, 0x56, 0x69, 0x7c, 0x17, 0x02, 0x3d, 0x28, 0xeb, 0xfe, 0xc1, 0xd4, 0xbf, 0xaa, 0x95, 0x80,
+		0x14, 0x01, 0x3e, 0x2b, 0x40, 0x55, 0x6a, 0x7f, 0xbc, 0xa9, 0x96, 0x83, 0xe8, 0xfd, 0xc2, 0xd7
+	},
+	{
+		0x00, 0x6b, 0xd6, 0xbd, 0xab, 0xc0, 0x7d, 0x16, 0x51, 0x3a, 0x87, 0xec, 0xfa, 0x91, 0x2c, 0x47,
+		0xa2, 0xc9, 0x74, 0x1f, 0x09, 0x62, 0xdf, 0xb4, 0xf3, 0x98, 0x25, 0x4e, 0x58, 0x33, 0x8e, 0xe5,
+		0x43, 0x28, 0x95, 0xfe, 0xe8, 0x83, 0x3e, 0x55, 0x12, 0x79, 0xc4, 0xaf, 0xb9, 0xd2, 0x6f, 0x04,
+		0xe1, 0x8a, 0x37, 0x5c, 0x4a, 0x21, 0x9c, 0xf7, 0xb0, 0xdb, 0x66, 0x0d, 0x1b, 0x70, 0xcd, 0xa6,
+		0x86, 0xed, 0x50, 0x3b, 0x2d, 0x46, 0xfb, 0x90, 0xd7, 0xbc, 0x01, 0x6a, 0x7c, 0x17, 0xaa, 0xc1,
+		0x24, 0x4f, 0xf2, 0x99, 0x8f, 0xe4, 0x59, 0x32, 0x75, 0x1e, 0xa3, 0xc8, 0xde, 0xb5, 0x08, 0x63,
+		0xc5, 0xae, 0x13, 0x78, 0x6e, 0x05, 0xb8, 0xd3, 0x94, 0xff, 0x42, 0x29, 0x3f, 0x54, 0xe9, 0x82,
+		0x67, 0x0c, 0xb1, 0xda, 0xcc, 0xa7, 0x1a, 0x71, 0x36, 0x5d, 0xe0, 0x8b, 0x9d, 0xf6, 0x4b, 0x20,
+		0x0b, 0x60, 0xdd, 0xb6, 0xa0, 0xcb, 0x76, 0x1d, 0x5a, 0x31, 0x8c, 0xe7, 0xf1, 0x9a, 0x27, 0x4c,
+		0xa9, 0xc2, 0x7f, 0x14, 0x02, 0x69, 0xd4, 0xbf, 0xf8, 0x93, 0x2e, 0x45, 0x53, 0x38, 0x85, 0xee,
+		0x48, 0x23, 0x9e, 0xf5, 0xe3, 0x88, 0x35, 0x5e, 0x19, 0x72, 0xcf, 0xa4, 0xb2, 0xd9, 0x64, 0x0f,
+		0xea, 0x81, 0x3c, 0x57, 0x41, 0x2a, 0x97, 0xfc, 0xbb, 0xd0, 0x6d, 0x06, 0x10, 0x7b, 0xc6, 0xad,
+		0x8d, 0xe6, 0x5b, 0x30, 0x26, 0x4d, 0xf0, 0x9b, 0xdc, 0xb7, 0x0a, 0x61, 0x77, 0x1c, 0xa1, 0xca,
+		0x2f, 0x44, 0xf9, 0x92, 0x84, 0xef, 0x52, 0x39, 0x7e, 0x15, 0xa8, 0xc3, 0xd5, 0xbe, 0x03, 0x68,
+		0xce, 0xa5, 0x18, 0x73, 0x65, 0x0e, 0xb3, 0xd8, 0x9f, 0xf4, 0x49, 0x22, 0x34, 0x5f, 0xe2, 0x89,
+		0x6c, 0x07, 0xba, 0xd1, 0xc7, 0xac, 0x11, 0x7a, 0x3d, 0x56, 0xeb, 0x80, 0x96, 0xfd, 0x40, 0x2b
+	},
+	{
+		0x00, 0x16, 0x2c, 0x3a, 0x58, 0x4e, 0x74, 0x62, 0xb0, 0xa6, 0x9c, 0x8a, 0xe8, 0xfe, 0xc4, 0xd2,
+		0x67, 0x71, 0x4b, 0x5d, 0x3f, 0x29, 0x13, 0x05, 0xd7, 0xc1, 0xfb, 0xed, 0x8f, 0x99, 0xa3, 0xb5,
+		0xce, 0xd8, 0xe2, 0xf4, 0x96, 0x80, 0xba, 0xac, 0x7e, 0x68, 0x52, 0x44, 0x26, 0x30, 0x0a, 0x1c,
+		0xa9, 0xbf, 0x85, 0x93, 0xf1, 0xe7, 0xdd, 0xcb, 0x19, 0x0f, 0x35, 0x23, 0x41, 0x57, 0x6d, 0x7b,
+		0x9b, 0x8d, 0xb7, 0xa1, 0xc3, 0xd5, 0xef, 0xf9, 0x2b, 0x3d, 0x07, 0x11, 0x73, 0x65, 0x5f, 0x49,
+		0xfc, 0xea, 0xd0, 0xc6, 0xa4, 0xb2, 0x88, 0x9e, 0x4c, 0x5a, 0x60, 0x76, 0x14, 0x02, 0x38, 0x2e,
+		0x55, 0x43, 0x79, 0x6f, 0x0d, 0x1b, 0x21, 0x37, 0xe5, 0xf3, 0xc9, 0xdf, 0xbd, 0xab, 0x91, 0x87,
+		0x32, 0x24, 0x1e, 0x08, 0x6a, 0x7c, 0x46, 0x50, 0x82, 0x94, 0xae, 0xb8, 0xda, 0xcc, 0xf6, 0xe0,
+		0x31, 0x27, 0x1d, 0x0b, 0x69, 0x7f, 0x45, 0x53, 0x81, 0x97, 0xad, 0xbb, 0xd9, 0xcf, 0xf5, 0xe3,
+		0x56, 0x40, 0x7a, 0x6c, 0x0e, 0x18, 0x22, 0x34, 0xe6, 0xf0, 0xca, 0xdc, 0xbe, 0xa8, 0x92, 0x84,
+		0xff, 0xe9, 0xd3, 0xc5, 0xa7, 0xb1, 0x8b, 0x9d, 0x4f, 0x59, 0x63, 0x75, 0x17, 0x01, 0x3b, 0x2d,
+		0x98, 0x8e, 0xb4, 0xa2, 0xc0, 0xd6, 0xec, 0xfa, 0x28, 0x3e, 0x04, 0x12, 0x70, 0x66, 0x5c, 0x4a,
+		0xaa, 0xbc, 0x86, 0x90, 0xf2, 0xe4, 0xde, 0xc8, 0x1a, 0x0c, 0x36, 0x20, 0x42, 0x54, 0x6e, 0x78,
+		0xcd, 0xdb, 0xe1, 0xf7, 0x95, 0x83, 0xb9, 0xaf, 0x7d, 0x6b, 0x51, 0x47, 0x25, 0x33, 0x09, 0x1f,
+		0x64, 0x72, 0x48, 0x5e, 0x3c, 0x2a, 0x10, 0x06, 0xd4, 0xc2, 0xf8, 0xee, 0x8c, 0x9a, 0xa0, 0xb6,
+		0x03, 0x15, 0x2f, 0x39, 0x5b, 0x4d, 0x77, 0x61, 0xb3, 0xa5, 0x9f, 0x89, 0xeb, 0xfd, 0xc7, 0xd1
+	}
+};
+#endif /* !defined(PIOS_CRC_NO_SLICE_BY_4) */
+
 static const uint16_t CRC_Table16[] = {	// HDLC polynomial
 	 0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
 	 0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
@@ -64,6 +129,113 @@ static const uint16_t CRC_Table16[] = {	// HDLC polynomial
 	 0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
 };
 
+#if !defined(PIOS_CRC_NO_SLICE_BY_4)
+static const uint16_t CRC_Table16_slice[3][256] = {
+	{
+		0x0000, 0x19d8, 0x33b0, 0x2a68, 0x6760, 0x7eb8, 0x54d0, 0x4d08,
+		0xcec0, 0xd718, 0xfd70, 0xe4a8, 0xa9a0, 0xb078, 0x9a10, 0x83c8,
+		0x9591, 0x8c49, 0xa621, 0xbff9, 0xf2f1, 0xeb29, 0xc141, 0xd899,
+		0x5b51, 0x4289, 0x68e1, 0x7139, 0x3c31, 0x25e9, 0x0f81, 0x1659,
+		0x2333, 0x3aeb, 0x1083, 0x095b, 0x4453, 0x5d8b, 0x77e3, 0x6e3b,
+		0xedf3, 0xf42b, 0xde43, 0xc79b, 0x8a93, 0x934b, 0xb923, 0xa0fb,
+		0xb6a2, 0xaf7a, 0x8512, 0x9cca, 0xd1c2, 0xc81a, 0xe272, 0xfbaa,
+		0x7862, 0x61ba, 0x4bd2, 0x520a, 0x1f02, 0x06da, 0x2cb2, 0x356a,
+		0x4666, 0x5fbe, 0x75d6, 0x6c0e, 0x2106, 0x38de, 0x12b6, 0x0b6e,
+		0x88a6, 0x917e, 0xbb16, 0xa2ce, 0xefc6, 0xf61e, 0xdc76, 0xc5ae,
+		0xd3f7, 0xca2f, 0xe047, 0xf99f, 0xb497, 0xad4f, 0x8727, 0x9eff,
+		0x1d37, 0x04ef, 0x2e87, 0x375f, 0x7a57, 0x638f, 0x49e7, 0x503f,
+		0x6555, 0x7c8d, 0x56e5, 0x4f3d, 0x0235, 0x1bed, 0x3185, 0x285d,
+		0xab95, 0xb24d, 0x9825, 0x81fd, 0xccf5, 0xd52d, 0xff45, 0xe69d,
+		0xf0c4, 0xe91c, 0xc374, 0xdaac, 0x97a4, 0x8e7c, 0xa414, 0xbdcc,
+		0x3e04, 0x27dc, 0x0db4, 0x146c, 0x5964, 0x40bc, 0x6ad4, 0x730c,
+		0x8ccc, 0x9514, 0xbf7c, 0xa6a4, 0xebac, 0xf274, 0xd81c, 0xc1c4,
+		0x420c, 0x5bd4, 0x71bc, 0x6864, 0x256c, 0x3cb4, 0x16dc, 0x0f04,
+		0x195d, 0x0085, 0x2aed, 0x3335, 0x7e3d, 0x67e5, 0x4d8d, 0x5455,
+		0xd79d, 0xce45, 0xe42d, 0xfdf5, 0xb0fd, 0xa925, 0x834d, 0x9a95,
+		0xafff, 0xb627, 0x9c4f, 0x8597, 0xc89f, 0xd147, 0xfb2f, 0xe2f7,
+		0x613f, 0x78e7, 0x528f, 0x4b57, 0x065f, 0x1f87, 0x35ef, 0x2c37,
+		0x3a6e, 0x23b6, 0x09de, 0x1006, 0x5d0e, 0x44d6, 0x6ebe, 0x7766,
+		0xf4ae, 0xed76, 0xc71e, 0xdec6, 0x93ce, 0x8a16, 0xa07e, 0xb9a6,
+		0xcaaa, 0xd372, 0xf91a, 0xe0c2, 0xadca, 0xb412, 0x9e7a, 0x87a2,
+		0x046a, 0x1db2, 0x37da, 0x2e02, 0x630a, 0x7ad2, 0x50ba, 0x4962,
+		0x5f3b, 0x46e3, 0x6c8b, 0x7553, 0x385b, 0x2183, 0x0beb, 0x1233,
+		0x91fb, 0x8823, 0xa24b, 0xbb93, 0xf69b, 0xef43, 0xc52b, 0xdcf3,
+		0xe999, 0xf041, 0xda29, 0xc3f1, 0x8ef9, 0x9721, 0xbd49, 0xa491,
+		0x2759, 0x3e81, 0x14e9, 0x0d31, 0x4039, 0x59e1, 0x7389, 0x6a51,
+		0x7c08, 0x65d0, 0x4fb8, 0x5660, 0x1b68, 0x02b0, 0x28d8, 0x3100,
+		0xb2c8, 0xab10, 0x8178, 0x98a0, 0xd5a8, 0xcc70, 0xe618, 0xffc0
+	},
+	{
+		0x0000, 0x5adc, 0xb5b8, 0xef64, 0x6361, 0x39bd, 0xd6d9, 0x8c05,
+		0xc6c2, 0x9c1e, 0x737a, 0x29a6, 0xa5a3, 0xff7f, 0x101b, 0x4ac7,
+		0x8595, 0xdf49, 0x302d, 0x6af1, 0xe6f4, 0xbc28, 0x534c, 0x0990,
+		0x4357, 0x198b, 0xf6ef, 0xac33, 0x2036, 0x7aea, 0x958e, 0xcf52,
+		0x033b, 0x59e7, 0xb683, 0xec5f, 0x605a, 0x3a86, 0xd5e2, 0x8f3e,
+		0xc5f9, 0x9f25, 0x7041, 0x2a9d, 0xa698, 0xfc44, 0x1320, 0x49fc,
+		0x86ae, 0xdc72, 0x3316, 0x69ca, 0xe5cf, 0xbf13, 0x5077, 0x0aab,
+		0x406c, 0x1ab0, 0xf5d4, 0xaf08, 0x230d, 0x79d1, 0x96b5, 0xcc69,
+		0x0676, 0x5caa, 0xb3ce, 0xe912, 0x6517, 0x3fcb, 0xd0af, 0x8a73,
+		0xc0b4, 0x9a68, 0x750c, 0x2fd0, 0xa3d5, 0xf909, 0x166d, 0x4cb1,
+		0x83e3, 0xd93f, 0x365b, 0x6c87, 0xe082, 0xba5e, 0x553a, 0x0fe6,
+		0x4521, 0x1ffd, 0xf099, 0xaa45, 0x2640, 0x7c9c, 0x93f8, 0xc924,
+		0x054d, 0x5f91, 0xb0f5, 0xea29, 0x662c, 0x3cf0, 0xd394, 0x8948,
+		0xc38f, 0x9953, 0x7637, 0x2ceb, 0xa0ee, 0xfa32, 0x1556, 0x4f8a,
+		0x80d8, 0xda04, 0x3560, 0x6fbc, 0xe3b9, 0xb965, 0x5601, 0x0cdd,
+		0x461a, 0x1cc6, 0xf3a2, 0xa97e, 0x257b, 0x7fa7, 0x90c3, 0xca1f,
+		0x0cec, 0x5630, 0xb954, 0xe388, 0x6f8d, 0x3551, 0xda35, 0x80e9,
+		0xca2e, 0x90f2, 0x7f96, 0x254a, 0xa94f, 0xf393, 0x1cf7, 0x462b,
+		0x8979, 0xd3a5, 0x3cc1, 0x661d, 0xea18, 0xb0c4, 0x5fa0, 0x057c,
+		0x4fbb, 0x1567, 0xfa03, 0xa0df, 0x2cda, 0x7606, 0x9962, 0xc3be,
+		0x0fd7, 0x550b, 0xba6f, 0xe0b3, 0x6cb6, 0x366a, 0xd90e, 0x83d2,
+		0xc915, 0x93c9, 0x7cad, 0x2671, 0xaa74, 0xf0a8, 0x1fcc, 0x4510,
+		0x8a42, 0xd09e, 0x3ffa, 0x6526, 0xe923, 0xb3ff, 0x5c9b, 0x0647,
+		0x4c80, 0x165c, 0xf938, 0xa3e4, 0x2fe1, 0x753d, 0x9a59, 0xc085,
+		0x0a9a, 0x5046, 0xbf22, 0xe5fe, 0x69fb, 0x3327, 0xdc43, 0x869f,
+		0xcc58, 0x9684, 0x79e0, 0x233c, 0xaf39, 0xf5e5, 0x1a81, 0x405d,
+		0x8f0f, 0xd5d3, 0x3ab7, 0x606b, 0xec6e, 0xb6b2, 0x59d6, 0x030a,
+		0x49cd, 0x1311, 0xfc75, 0xa6a9, 0x2aac, 0x7070, 0x9f14, 0xc5c8,
+		0x09a1, 0x537d, 0xbc19, 0xe6c5, 0x6ac0, 0x301c, 0xdf78, 0x85a4,
+		0xcf63, 0x95bf, 0x7adb, 0x2007, 0xac02, 0xf6de, 0x19ba, 0x4366,
+		0x8c34, 0xd6e8, 0x398c, 0x6350, 0xef55, 0xb589, 0x5aed, 0x0031,
+		0x4af6, 0x102a, 0xff4e, 0xa592, 0x2997, 0x734b, 0x9c2f, 0xc6f3
+	},
+	{
+		0x0000, 0x1cbb, 0x3976, 0x25cd, 0x72ec, 0x6e57, 0x4b9a, 0x5721,
+		0xe5d8, 0xf963, 0xdcae, 0xc015, 0x9734, 0x8b8f, 0xae42, 0xb2f9,
+		0xc3a1, 0xdf1a, 0xfad7, 0xe66c, 0xb14d, 0xadf6, 0x883b, 0x9480,
+		0x2679, 0x3ac2, 0x1f0f, 0x03b4, 0x5495, 0x482e, 0x6de3, 0x7158,
+		0x8f53, 0x93e8, 0xb625, 0xaa9e, 0xfdbf, 0xe104, 0xc4c9, 0xd872,
+		0x6a8b, 0x7630, 0x53fd, 0x4f46, 0x1867, 0x04dc, 0x2111, 0x3daa,
+		0x4cf2, 0x5049, 0x7584, 0x693f, 0x3e1e, 0x22a5, 0x0768, 0x1bd3,
+		0xa92a, 0xb591, 0x905c, 0x8ce7, 0xdbc6, 0xc77d, 0xe2b0, 0xfe0b,
+		0x16b7, 0x0a0c, 0x2fc1, 0x337a, 0x645b, 0x78e0, 0x5d2d, 0x4196,
+		0xf36f, 0xefd4, 0xca19, 0xd6a2, 0x8183, 0x9d38, 0xb8f5, 0xa44e,
+		0xd516, 0xc9ad, 0xec60, 0xf0db, 0xa7fa, 0xbb41, 0x9e8c, 0x8237,
+		0x30ce, 0x2c75, 0x09b8, 0x1503, 0x4222, 0x5e99, 0x7b54, 0x67ef,
+		0x99e4, 0x855f, 0xa092, 0xbc29, 0xeb08, 0xf7b3, 0xd27e, 0xcec5,
+		0x7c3c, 0x6087, 0x454a, 0x59f1, 0x0ed0, 0x126b, 0x37a6, 0x2b1d,
+		0x5a45, 0x46fe, 0x6333, 0x7f88, 0x28a9, 0x3412, 0x11df, 0x0d64,
+		0xbf9d, 0xa326, 0x86eb, 0x9a50, 0xcd71, 0xd1ca, 0xf407, 0xe8bc,
+		0x2d6e, 0x31d5, 0x1418, 0x08a3, 0x5f82, 0x4339, 0x66f4, 0x7a4f,
+		0xc8b6, 0xd40d, 0xf1c0, 0xed7b, 0xba5a, 0xa6e1, 0x832c, 0x9f97,
+		0xeecf, 0xf274, 0xd7b9, 0xcb02, 0x9c23, 0x8098, 0xa555, 0xb9ee,
+		0x0b17, 0x17ac, 0x3261, 0x2eda, 0x79fb, 0x6540, 0x408d, 0x5c36,
+		0xa23d, 0xbe86, 0x9b4b, 0x87f0, 0xd0d1, 0xcc6a, 0xe9a7, 0xf51c,
+		0x47e5, 0x5b5e, 0x7e93, 0x6228, 0x3509, 0x29b2, 0x0c7f, 0x10c4,
+		0x619c, 0x7d27, 0x58ea, 0x4451, 0x1370, 0x0fcb, 0x2a06, 0x36bd,
+		0x8444, 0x98ff, 0xbd32, 0xa189, 0xf6a8, 0xea13, 0xcfde, 0xd365,
+		0x3bd9, 0x2762, 0x02af, 0x1e14, 0x4935, 0x558e, 0x7043, 0x6cf8,
+		0xde01, 0xc2ba, 0xe777, 0xfbcc, 0xaced, 0xb056, 0x959b, 0x8920,
+		0xf878, 0xe4c3, 0xc10e, 0xddb5, 0x8a94, 0x962f, 0xb3e2, 0xaf59,
+		0x1da0, 0x011b, 0x24d6, 0x386d, 0x6f4c, 0x73f7, 0x563a, 0x4a81,
+		0xb48a, 0xa831, 0x8dfc, 0x9147, 0xc666, 0xdadd, 0xff10, 0xe3ab,
+		0x5152, 0x4de9, 0x6824, 0x749f, 0x23be, 0x3f05, 0x1ac8, 0x0673,
+		0x772b, 0x6b90, 0x4e5d, 0x52e6, 0x05c7, 0x197c, 0x3cb1, 0x200a,
+		0x92f3, 0x8e48, 0xab85, 0xb73e, 0xe01f, 0xfca4, 0xd969, 0xc5d2
+	}
+};
+#endif /* !defined(PIOS_CRC_NO_SLICE_BY_4) */
+
 static const uint32_t CRC_Table32[]	= {
 	    0x00000000, 0x04c11db7, 0x09823b6e, 0x0d4326d9, 0x130476dc, 0x17c56b6b, 0x1a864db2, 0x1e475005,
 	    0x2608edb8, 0x22c9f00f, 0x2f8ad6d6, 0x2b4bcb61, 0x350c9b64, 0x31cd86d3, 0x3c8ea00a, 0x384fbdbd,
@@ -135,8 +307,17 @@ uint8_t PIOS_CRC_updateCRC(uint8_t crc, const uint8_t* data, int32_t length)
 	register int32_t len = length;
 	register uint8_t crc8 = crc;
 	register const uint8_t *p = data;
-	
-	while (len--)
+
+#if !defined(PIOS_CRC_NO_SLICE_BY_4)
+	while (len >= 4) {
+		crc8 = crc_table_slice[2][crc8 ^ p[0]] ^ crc_table_slice[1][p[1]] ^
+			crc_table_slice[0][p[2]] ^ crc_table[p[3]];
+		p += 4;
+		len -= 4;
+	}
+#endif /* !defined(PIOS_CRC_NO_SLICE_BY_4) */
+
+	while (len-- > 0)
 		crc8 = crc_table[crc8 ^ *p++];
 	
 	return crc8;
@@ -165,7 +346,18 @@ uint16_t PIOS_CRC16_updateCRC(uint16_t crc, const uint8_t* data, int32_t length)
 {
 	register uint8_t *p = (uint8_t *)data;
 	register uint16_t _crc = crc;
-	for (register uint32_t i = length; i > 0; i--)
+	register uint32_t i = length;
+
+#if !defined(PIOS_CRC_NO_SLICE_BY_4)
+	for (; i >= 4; i -= 4) {
+		_crc ^= p[0] | (p[1] << 8);
+		_crc = CRC_Table16_slice[2][_crc & 0xff] ^ CRC_Table16_slice[1][_crc >> 8] ^
+			CRC_Table16_slice[0][p[2]] ^ CRC_Table16[p[3]];
+		p += 4;
+	}
+#endif /* !defined(PIOS_CRC_NO_SLICE_BY_4) */
+
+	for (; i > 0; i--)
 		_crc = (_crc >> 8) ^ CRC_Table16[(_crc ^ *p++) & 0xff];
 	return _crc;
 }
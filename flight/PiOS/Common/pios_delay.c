@@ -184,6 +184,17 @@ uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
 	return diff / us_ticks;
 }
 
+/**
+ * @brief Compare two raw times and convert to us, e.g. two sensor sample timestamps
+ * @param[in] raw The earlier raw time
+ * @param[in] later The later raw time
+ * @return A microsecond value
+ */
+uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later)
+{
+	return (later - raw) / us_ticks;
+}
+
 #endif
 
 /**
@@ -32,6 +32,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>		/* NULL */
+#include <string.h>		/* memset */
 
 #define MIN(x,y) ((x) < (y) ? (x) : (y))
 
@@ -43,6 +44,17 @@ enum pios_flashfs_logfs_dev_magic {
 	PIOS_FLASHFS_LOGFS_DEV_MAGIC = 0x94938201,
 };
 
+/*
+ * One bucket of the RAM index of active slots. The index is an open
+ * addressed hash table keyed on (obj_id, obj_inst_id). Only a 16 bit
+ * tag of the key is kept in RAM, a matching tag is confirmed against
+ * the slot header in flash.
+ */
+struct logfs_index_entry {
+	uint16_t slot_id;	/* 0 for an empty bucket, slot 0 holds the arena header */
+	uint16_t tag;		/* upper half of the key hash, the low bits select the home bucket */
+};
+
 struct logfs_state {
 	enum pios_flashfs_logfs_dev_magic magic;
 	const struct flashfs_logfs_cfg *cfg;
@@ -56,6 +68,16 @@ struct logfs_state {
 	uint16_t num_free_slots;   /* slots in free state */
 	uint16_t num_active_slots; /* slots in active state */
 
+	/* Index of every active slot in the active arena */
+	struct logfs_index_entry *index;
+	uint16_t index_mask;	   /* number of buckets - 1, at least slots per arena - 1 */
+
+	/* Batch save in progress, see PIOS_FLASHFS_BatchBegin() */
+	bool batch_active;
+	uint16_t batch_first_slot; /* first slot written by the batch */
+	uint16_t batch_slots;	   /* slots written so far */
+	uint16_t batch_capacity;   /* slots set aside by PIOS_FLASHFS_BatchBegin() */
+
 	/* Underlying flash partition handle */
 	uintptr_t partition_id;
 	uint32_t partition_size;
@@ -325,6 +347,7 @@ enum slot_state {
 	SLOT_STATE_EMPTY    = 0xFFFFFFFF,
 	SLOT_STATE_RESERVED = 0xFAFAFFFF,
 	SLOT_STATE_ACTIVE   = 0xFAFAAAAA,
+	SLOT_STATE_COMMIT   = 0xFAFA5555, /* batch commit marker, written over RESERVED */
 	SLOT_STATE_OBSOLETE = 0x00000000,
 } __attribute__((packed));
 
@@ -335,6 +358,89 @@ struct slot_header {
 	uint16_t obj_size;
 } __attribute__((packed));
 
+/*
+ * RAM index of active slots
+ */
+
+static uint16_t logfs_index_tag(uint32_t obj_id, uint16_t obj_inst_id)
+{
+	uint32_t hash = (obj_id ^ (obj_inst_id * 0x9E3779B1)) * 0x85EBCA6B;
+	return (hash ^ (hash >> 13)) >> 16;
+}
+
+static void logfs_index_clear(struct logfs_state *logfs)
+{
+	memset(logfs->index, 0, (logfs->index_mask + 1) * sizeof(*logfs->index));
+}
+
+static void logfs_index_insert(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint16_t slot_id)
+{
+	uint16_t tag = logfs_index_tag(obj_id, obj_inst_id);
+	uint16_t bucket = tag & logfs->index_mask;
+
+	/* There are more buckets than slots so this always finds room */
+	while (logfs->index[bucket].slot_id != 0)
+		bucket = (bucket + 1) & logfs->index_mask;
+
+	logfs->index[bucket].slot_id = slot_id;
+	logfs->index[bucket].tag     = tag;
+}
+
+/*
+ * Remove a bucket, shifting back any later entries of the same probe
+ * sequence so that no lookup stops early at the hole.
+ */
+static void logfs_index_remove(struct logfs_state *logfs, uint16_t bucket)
+{
+	uint16_t mask = logfs->index_mask;
+	uint16_t hole = bucket;
+
+	for (uint16_t i = (hole + 1) & mask; logfs->index[i].slot_id != 0; i = (i + 1) & mask) {
+		uint16_t home = logfs->index[i].tag & mask;
+
+		/* Entries whose home bucket lies after the hole have to stay put */
+		if (((i - home) & mask) >= ((i - hole) & mask)) {
+			logfs->index[hole] = logfs->index[i];
+			hole = i;
+		}
+	}
+
+	logfs->index[hole].slot_id = 0;
+}
+
+/**
+ * @brief Find the active slot holding an object
+ * @param[out] slot_hdr Header of the slot that was found
+ * @return bucket of the slot in the index, -1 if not found, -2 on flash errors
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_index_find(const struct logfs_state *logfs, struct slot_header *slot_hdr, uint32_t obj_id, uint16_t obj_inst_id)
+{
+	uint16_t tag = logfs_index_tag(obj_id, obj_inst_id);
+
+	for (uint16_t bucket = tag & logfs->index_mask;
+	     logfs->index[bucket].slot_id != 0;
+	     bucket = (bucket + 1) & logfs->index_mask) {
+		if (logfs->index[bucket].tag != tag)
+			continue;
+
+		uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, logfs->index[bucket].slot_id);
+		if (PIOS_FLASH_read_data(logfs->partition_id,
+						slot_addr,
+						(uint8_t *)slot_hdr,
+						sizeof (*slot_hdr)) != 0) {
+			return -2;
+		}
+		if (slot_hdr->state == SLOT_STATE_ACTIVE &&
+			slot_hdr->obj_id      == obj_id &&
+			slot_hdr->obj_inst_id == obj_inst_id) {
+			return bucket;
+		}
+	}
+
+	return -1;
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
 static int32_t logfs_raw_copy_bytes (const struct logfs_state *logfs, uintptr_t src_addr, uint16_t src_size, uintptr_t dst_addr)
 {
@@ -409,6 +515,8 @@ static int32_t logfs_unmount_log(struct logfs_state *logfs)
 	return 0;
 }
 
+static int8_t logfs_commit_batch(struct logfs_state *logfs, uint16_t marker_slot_id, uint16_t num_slots);
+
 static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
 {
 	PIOS_Assert (!logfs->mounted);
@@ -416,8 +524,9 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
 	logfs->num_active_slots = 0;
 	logfs->num_free_slots   = 0;
 	logfs->active_arena_id  = arena_id;
+	logfs_index_clear(logfs);
 
-	/* Scan the log to find out how full it is */
+	/* Scan the log to find out how full it is and index the active slots */
 	for (uint16_t slot_id = 1;
 	     slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
 	     slot_id++) {
@@ -443,6 +552,13 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
 			break;
 		case SLOT_STATE_ACTIVE:
 			logfs->num_active_slots++;
+			logfs_index_insert(logfs, slot_hdr.obj_id, slot_hdr.obj_inst_id, slot_id);
+			break;
+		case SLOT_STATE_COMMIT:
+			/* Power was lost while applying a committed batch, finish the job */
+			if (logfs_commit_batch(logfs, slot_id, slot_hdr.obj_inst_id) != 0) {
+				return -1;
+			}
 			break;
 		case SLOT_STATE_RESERVED:
 		case SLOT_STATE_OBSOLETE:
@@ -470,12 +586,16 @@ static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
 	if (!logfs) return (NULL);
 
 	logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+	logfs->index = NULL;
+	logfs->batch_active = false;
 	return(logfs);
 }
 static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 {
 	/* Invalidate the magic */
 	logfs->magic = ~PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+	if (logfs->index)
+		PIOS_free(logfs->index);
 	PIOS_free(logfs);
 }
 
@@ -521,6 +641,19 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
 	logfs->partition_size = partition_size; /* size of underlying partition */
 	logfs->mounted        = false;
 
+	/* Size the index to the next power of two that holds every slot of an arena */
+	uint16_t num_slots = cfg->arena_size / cfg->slot_size;
+	logfs->index_mask = 1;
+	while (logfs->index_mask < num_slots - 1)
+		logfs->index_mask = (logfs->index_mask << 1) | 1;
+
+	logfs->index = (struct logfs_index_entry *)PIOS_malloc_no_dma((logfs->index_mask + 1) * sizeof(*logfs->index));
+	if (!logfs->index) {
+		PIOS_FLASHFS_Logfs_free(logfs);
+		rc = -1;
+		goto out_exit;
+	}
+
 	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
 		rc = -1;
 		goto out_exit;
@@ -608,36 +741,67 @@ static int32_t logfs_garbage_collect (struct logfs_state *logfs) {
 		return -2;
 	}
 
-	/* Copy active slots from active arena to destination arena */
+	int32_t rc;
+
+	/*
+	 * Copy the indexed (active) slots from the active arena to the
+	 * destination arena, moving each index entry along with its slot
+	 */
 	uint16_t dst_slot_id = 1;
-	for (uint16_t src_slot_id = 1;
-	     src_slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
-	     src_slot_id++) {
+	for (uint32_t bucket = 0; bucket <= logfs->index_mask; bucket++) {
+		uint16_t src_slot_id = logfs->index[bucket].slot_id;
+		if (src_slot_id == 0)
+			continue;
+
 		struct slot_header slot_hdr;
 		uintptr_t src_addr = logfs_get_addr (logfs, src_arena_id, src_slot_id);
 		if (PIOS_FLASH_read_data(logfs->partition_id,
 						src_addr,
 						(uint8_t *)&slot_hdr,
 						sizeof (slot_hdr)) != 0) {
-			return -3;
+			rc = -3;
+			goto out_remount;
 		}
 
-		if (slot_hdr.state == SLOT_STATE_ACTIVE) {
-			uintptr_t dst_addr = logfs_get_addr (logfs, dst_arena_id, dst_slot_id);
-			if (logfs_raw_copy_bytes(logfs,
-							src_addr,
-							sizeof(slot_hdr) + slot_hdr.obj_size,
-							dst_addr) != 0) {
-				/* Failed to copy all bytes */
-				return -4;
-			}
-			dst_slot_id++;
+		uintptr_t dst_addr = logfs_get_addr (logfs, dst_arena_id, dst_slot_id);
+		if (logfs_raw_copy_bytes(logfs,
+						src_addr,
+						sizeof(slot_hdr) + slot_hdr.obj_size,
+						dst_addr) != 0) {
+			/* Failed to copy all bytes */
+			rc = -4;
+			goto out_remount;
+		}
+		logfs->index[bucket].slot_id = dst_slot_id++;
+	}
+
+	/* Carry over the objects of a batch in progress, they are not indexed until the commit */
+	uint16_t batch_first_slot = dst_slot_id;
+	for (uint16_t i = 0; logfs->batch_active && i < logfs->batch_slots; i++) {
+		struct slot_header slot_hdr;
+		uintptr_t src_addr = logfs_get_addr (logfs, src_arena_id, logfs->batch_first_slot + i);
+		if (PIOS_FLASH_read_data(logfs->partition_id,
+						src_addr,
+						(uint8_t *)&slot_hdr,
+						sizeof (slot_hdr)) != 0) {
+			rc = -3;
+			goto out_remount;
+		}
+
+		if (logfs_raw_copy_bytes(logfs,
+						src_addr,
+						sizeof(slot_hdr) + slot_hdr.obj_size,
+						logfs_get_addr (logfs, dst_arena_id, dst_slot_id)) != 0) {
+			rc = -4;
+			goto out_remount;
 		}
+		dst_slot_id++;
 	}
 
 	/* Activate the destination arena */
 	if (logfs_activate_arena (logfs, dst_arena_id) != 0) {
-		return -5;
+		rc = -5;
+		goto out_remount;
 	}
 
 	/* Unmount the source arena */
@@ -650,91 +814,57 @@ static int32_t logfs_garbage_collect (struct logfs_state *logfs) {
 		return -7;
 	}
 
-	/* Mount the new arena */
-	if (logfs_mount_log (logfs, dst_arena_id) != 0) {
-		return -8;
-	}
+	/*
+	 * Mount the new arena. The index already describes it so there is
+	 * no need to scan it again, only the slot counts are set up.
+	 */
+	logfs->active_arena_id  = dst_arena_id;
+	logfs->num_active_slots = batch_first_slot - 1;
+	logfs->num_free_slots   = (logfs->cfg->arena_size / logfs->cfg->slot_size) - dst_slot_id;
+	logfs->batch_first_slot = batch_first_slot;
+	logfs->mounted          = true;
 
 	return 0;
+
+out_remount:
+	/* Part of the index points into the destination arena, rebuild it from the source */
+	logfs_unmount_log (logfs);
+	if (logfs_mount_log (logfs, src_arena_id) != 0) {
+		return -8;
+	}
+	return rc;
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
-static int16_t logfs_object_find_next (const struct logfs_state *logfs, struct slot_header *slot_hdr, uint16_t *curr_slot, uint32_t obj_id, uint16_t obj_inst_id)
+static int8_t logfs_delete_object (struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
 {
-	PIOS_Assert(slot_hdr);
-	PIOS_Assert(curr_slot);
+	int32_t bucket;
+	struct slot_header slot_hdr;
 
-	/* First slot in the arena is reserved for arena header, skip it. */
-	if (*curr_slot == 0) *curr_slot = 1;
+	/* There should only ever be one active version, but obsolete any others found too */
+	while ((bucket = logfs_index_find (logfs, &slot_hdr, obj_id, obj_inst_id)) >= 0) {
+		/* Found a matching slot.  Obsolete it. */
+		slot_hdr.state = SLOT_STATE_OBSOLETE;
+		uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, logfs->index[bucket].slot_id);
 
-	for (uint16_t slot_id = *curr_slot;
-	     slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
-	     slot_id++) {
-		uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, slot_id);
-
-		if (PIOS_FLASH_read_data(logfs->partition_id,
+		if (PIOS_FLASH_write_data(logfs->partition_id,
 						slot_addr,
-						(uint8_t *)slot_hdr,
-						sizeof (*slot_hdr)) != 0) {
+						(uint8_t *)&slot_hdr,
+						sizeof(slot_hdr)) != 0) {
 			return -2;
 		}
-		if (slot_hdr->state == SLOT_STATE_EMPTY) {
-			/* We hit the end of the log */
-			break;
-		}
-		if (slot_hdr->state == SLOT_STATE_ACTIVE &&
-			slot_hdr->obj_id      == obj_id &&
-			slot_hdr->obj_inst_id == obj_inst_id) {
-			/* Found what we were looking for */
-			*curr_slot = slot_id;
-			return 0;
-		}
+		/* Object has been successfully obsoleted and is no longer active */
+		logfs_index_remove(logfs, bucket);
+		logfs->num_active_slots--;
 	}
 
-	/* No matching entry was found */
-	return -1;
-}
-
-/* NOTE: Must be called while holding the flash transaction lock */
-/* OPTIMIZE: could trust that there is at most one active version of every object and terminate the search when we find one */
-static int8_t logfs_delete_object (struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
-{
-	int8_t rc;
-
-	bool more = true;
-	uint16_t curr_slot_id = 0;
-	do {
-		struct slot_header slot_hdr;
-		switch (logfs_object_find_next (logfs, &slot_hdr, &curr_slot_id, obj_id, obj_inst_id)) {
-		case 0:
-			/* Found a matching slot.  Obsolete it. */
-			slot_hdr.state = SLOT_STATE_OBSOLETE;
-			uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, curr_slot_id);
-
-			if (PIOS_FLASH_write_data(logfs->partition_id,
-							slot_addr,
-							(uint8_t *)&slot_hdr,
-							sizeof(slot_hdr)) != 0) {
-				rc = -2;
-				goto out_exit;
-			}
-			/* Object has been successfully obsoleted and is no longer active */
-			logfs->num_active_slots--;
-			break;
-		case -1:
-			/* Search completed, object not found */
-			more = false;
-			rc = 0;
-			break;
-		default:
-			/* Error occurred during search */
-			rc = -1;
-			goto out_exit;
-		}
-	} while (more);
+	if (bucket != -1) {
+		/* Error occurred during search */
+		return -1;
+	}
 
-out_exit:
-	return rc;
+	/* Search completed, object not found */
+	return 0;
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
@@ -832,6 +962,133 @@ static int8_t logfs_append_to_log (struct logfs_state *logfs, uint32_t obj_id, u
 
 	/* Object has been successfully written to the slot */
 	logfs->num_active_slots++;
+	logfs_index_insert(logfs, obj_id, obj_inst_id, free_slot_id);
+	return 0;
+}
+
+/*
+ * Batches
+ *
+ * A batch writes every object into a RESERVED slot, exactly as a single
+ * save would before marking its slot ACTIVE. The slot following the batch
+ * is then turned into a COMMIT marker holding the number of batch slots,
+ * which is the point where the whole batch takes effect. Applying it
+ * obsoletes the previous version of each object before activating the
+ * new one, and finally obsoletes the marker. Mounting a log that still
+ * has a COMMIT marker redoes whatever was not applied yet, a batch that
+ * never got its marker is left RESERVED and reclaimed by the next gc.
+ * Garbage collection in the middle of a batch carries its slots over.
+ * A batch that fails to apply while running is aborted on the spot, as
+ * otherwise the next mount would apply it over the objects saved since.
+ */
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_activate_pending_slot (struct logfs_state *logfs, uint16_t slot_id)
+{
+	struct slot_header slot_hdr;
+	uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, slot_id);
+
+	if (PIOS_FLASH_read_data(logfs->partition_id,
+					slot_addr,
+					(uint8_t *)&slot_hdr,
+					sizeof (slot_hdr)) != 0) {
+		return -1;
+	}
+
+	if (slot_hdr.state != SLOT_STATE_RESERVED) {
+		/* Already applied before the power was lost */
+		return 0;
+	}
+
+	/* Retire the old version first so there is never more than one active */
+	if (logfs_delete_object (logfs, slot_hdr.obj_id, slot_hdr.obj_inst_id) != 0) {
+		return -2;
+	}
+
+	slot_hdr.state = SLOT_STATE_ACTIVE;
+	if (PIOS_FLASH_write_data(logfs->partition_id,
+					slot_addr,
+					(uint8_t *)&slot_hdr,
+					sizeof(slot_hdr)) != 0) {
+		return -3;
+	}
+
+	logfs->num_active_slots++;
+	logfs_index_insert(logfs, slot_hdr.obj_id, slot_hdr.obj_inst_id, slot_id);
+	return 0;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_commit_batch(struct logfs_state *logfs, uint16_t marker_slot_id, uint16_t num_slots)
+{
+	PIOS_Assert(num_slots < marker_slot_id);
+
+	for (uint16_t slot_id = marker_slot_id - num_slots; slot_id < marker_slot_id; slot_id++) {
+		if (logfs_activate_pending_slot (logfs, slot_id) != 0) {
+			return -1;
+		}
+	}
+
+	/* Every object of the batch is active, the marker is no longer needed */
+	struct slot_header slot_hdr = {
+		.state       = SLOT_STATE_OBSOLETE,
+		.obj_id      = 0,
+		.obj_inst_id = num_slots,
+		.obj_size    = 0,
+	};
+	if (PIOS_FLASH_write_data(logfs->partition_id,
+					logfs_get_addr (logfs, logfs->active_arena_id, marker_slot_id),
+					(uint8_t *)&slot_hdr,
+					sizeof(slot_hdr)) != 0) {
+		return -2;
+	}
+
+	return 0;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_abort_batch(struct logfs_state *logfs, uint16_t marker_slot_id, uint16_t num_slots)
+{
+	PIOS_Assert(num_slots < marker_slot_id);
+
+	struct slot_header slot_hdr;
+
+	/* Objects already applied keep their new version, the others their old one */
+	for (uint16_t slot_id = marker_slot_id - num_slots; slot_id < marker_slot_id; slot_id++) {
+		uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, slot_id);
+
+		if (PIOS_FLASH_read_data(logfs->partition_id,
+						slot_addr,
+						(uint8_t *)&slot_hdr,
+						sizeof (slot_hdr)) != 0) {
+			return -1;
+		}
+
+		if (slot_hdr.state != SLOT_STATE_RESERVED) {
+			continue;
+		}
+
+		slot_hdr.state = SLOT_STATE_OBSOLETE;
+		if (PIOS_FLASH_write_data(logfs->partition_id,
+						slot_addr,
+						(uint8_t *)&slot_hdr,
+						sizeof(slot_hdr)) != 0) {
+			return -2;
+		}
+	}
+
+	/* Either of these alone keeps a mount from applying the rest of the batch */
+	slot_hdr.state       = SLOT_STATE_OBSOLETE;
+	slot_hdr.obj_id      = 0;
+	slot_hdr.obj_inst_id = num_slots;
+	slot_hdr.obj_size    = 0;
+	if (PIOS_FLASH_write_data(logfs->partition_id,
+					logfs_get_addr (logfs, logfs->active_arena_id, marker_slot_id),
+					(uint8_t *)&slot_hdr,
+					sizeof(slot_hdr)) != 0) {
+		return -3;
+	}
+
 	return 0;
 }
 
@@ -931,6 +1188,234 @@ out_exit:
 	return rc;
 }
 
+/**
+ * @brief Starts a batch of saves that take effect all at once
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] num_objs Largest number of objects that will be saved in this batch
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if a batch is already in progress
+ * @retval -4 if the batch cannot fit alongside the current active objects
+ * @note The flash transaction is held until PIOS_FLASHFS_BatchCommit() or PIOS_FLASHFS_BatchAbort()
+ */
+int32_t PIOS_FLASHFS_BatchBegin(uintptr_t fs_id, uint16_t num_objs)
+{
+	int8_t rc;
+
+	struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+	if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+		rc = -1;
+		goto out_exit;
+	}
+
+	/* Checked first, the transaction is already held by the batch in progress */
+	if (logfs->batch_active) {
+		rc = -3;
+		goto out_exit;
+	}
+
+	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
+		rc = -2;
+		goto out_exit;
+	}
+
+	/*
+	 * The old version of every object stays active until the commit so
+	 * the batch and its commit marker need room next to all of them.
+	 */
+	if (logfs->num_active_slots + num_objs + 1 > (logfs->cfg->arena_size / logfs->cfg->slot_size) - 1) {
+		rc = -4;
+		goto out_end_trans;
+	}
+
+	logfs->batch_active     = true;
+	logfs->batch_first_slot = (logfs->cfg->arena_size / logfs->cfg->slot_size) - logfs->num_free_slots;
+	logfs->batch_slots      = 0;
+	logfs->batch_capacity   = num_objs;
+
+	/* Keep the transaction until the batch is committed or aborted */
+	return 0;
+
+out_end_trans:
+	PIOS_FLASH_end_transaction(logfs->partition_id);
+
+out_exit:
+	return rc;
+}
+
+/**
+ * @brief Adds one object instance to the batch in progress
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] obj UAVObject ID of the object to save
+ * @param[in] obj_inst_id The instance number of the object being saved
+ * @param[in] obj_data Contents of the object being saved
+ * @param[in] obj_size Size of the object being saved
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if no batch is in progress
+ * @retval -3 if the batch already holds as many objects as were asked for
+ * @retval -4 if garbage collection failed
+ * @retval -5 if writing the object to the filesystem failed
+ * @note The object is only visible once the batch is committed
+ */
+int32_t PIOS_FLASHFS_BatchSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+	struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+	if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+		return -1;
+	}
+
+	PIOS_Assert(obj_size <= (logfs->cfg->slot_size - sizeof(struct slot_header)));
+
+	if (!logfs->batch_active) {
+		return -2;
+	}
+
+	if (logfs->batch_slots >= logfs->batch_capacity) {
+		return -3;
+	}
+
+	/* BatchBegin made sure gc frees enough room, the batch is carried over */
+	if (logfs_log_is_full(logfs)) {
+		if (logfs_garbage_collect(logfs) != 0) {
+			return -4;
+		}
+	}
+
+	/* Written like any other save but left RESERVED until the commit */
+	uint16_t slot_id;
+	struct slot_header slot_hdr;
+	if (logfs_reserve_free_slot (logfs, &slot_id, &slot_hdr, obj_id, obj_inst_id, obj_size) != 0) {
+		return -5;
+	}
+	PIOS_Assert(slot_id == logfs->batch_first_slot + logfs->batch_slots);
+
+	if (obj_size > 0) {
+		uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, slot_id);
+		if (PIOS_FLASH_write_data(logfs->partition_id,
+						slot_addr + sizeof(slot_hdr),
+						obj_data,
+						obj_size) != 0) {
+			return -5;
+		}
+	}
+
+	logfs->batch_slots++;
+
+	return 0;
+}
+
+/**
+ * @brief Makes every object saved in the batch in progress take effect at once
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if no batch is in progress
+ * @retval -3 if garbage collection failed, none of the batch took effect
+ * @retval -4 if writing the commit marker failed, none of the batch took effect
+ * @retval -5 if applying the batch failed, the objects not applied yet keep their old version
+ * @retval -6 if garbage collection after the commit failed
+ */
+int32_t PIOS_FLASHFS_BatchCommit(uintptr_t fs_id)
+{
+	int8_t rc;
+
+	struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+	if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+		return -1;
+	}
+
+	if (!logfs->batch_active) {
+		return -2;
+	}
+
+	/* The marker goes right behind the batch */
+	if (logfs_log_is_full(logfs)) {
+		if (logfs_garbage_collect(logfs) != 0) {
+			rc = -3;
+			goto out_end_trans;
+		}
+	}
+
+	logfs->batch_active = false;
+
+	uint16_t marker_slot_id;
+	struct slot_header slot_hdr;
+	if (logfs_reserve_free_slot (logfs, &marker_slot_id, &slot_hdr, 0, logfs->batch_slots, 0) != 0) {
+		rc = -4;
+		goto out_end_trans;
+	}
+	PIOS_Assert(marker_slot_id == logfs->batch_first_slot + logfs->batch_slots);
+
+	/* The whole batch takes effect in this one write */
+	slot_hdr.state = SLOT_STATE_COMMIT;
+	if (PIOS_FLASH_write_data(logfs->partition_id,
+					logfs_get_addr (logfs, logfs->active_arena_id, marker_slot_id),
+					(uint8_t *)&slot_hdr,
+					sizeof(slot_hdr)) != 0) {
+		/* The marker may still have been partly written */
+		logfs_abort_batch (logfs, marker_slot_id, logfs->batch_slots);
+		rc = -4;
+		goto out_end_trans;
+	}
+
+	if (logfs_commit_batch (logfs, marker_slot_id, logfs->batch_slots) != 0) {
+		/* Saves that follow must not be undone by a mount finishing the batch */
+		logfs_abort_batch (logfs, marker_slot_id, logfs->batch_slots);
+		rc = -5;
+		goto out_end_trans;
+	}
+
+	/*
+	 * Collect the old versions now, while they are obsolete, if the next
+	 * batch of the same size would otherwise have to collect half way
+	 * through and carry all of its pending slots along.
+	 */
+	if (logfs->num_free_slots < logfs->batch_slots + 1) {
+		if (logfs_garbage_collect(logfs) != 0) {
+			rc = -6;
+			goto out_end_trans;
+		}
+	}
+
+	rc = 0;
+
+out_end_trans:
+	PIOS_FLASH_end_transaction(logfs->partition_id);
+
+	return rc;
+}
+
+/**
+ * @brief Drops the batch in progress, leaving every object as it was before it started
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if no batch is in progress
+ * @note Slots already written by the batch are reclaimed by the next garbage collection
+ */
+int32_t PIOS_FLASHFS_BatchAbort(uintptr_t fs_id)
+{
+	struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+	if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+		return -1;
+	}
+
+	if (!logfs->batch_active) {
+		return -2;
+	}
+
+	logfs->batch_active = false;
+	PIOS_FLASH_end_transaction(logfs->partition_id);
+
+	return 0;
+}
+
 /**
  * @brief Load one object instance from the filesystem
  * @param[in] fs_id The filesystem to use for this action
@@ -964,13 +1449,14 @@ int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
 	}
 
 	/* Find the object in the log */
-	uint16_t slot_id = 0;
 	struct slot_header slot_hdr;
-	if (logfs_object_find_next (logfs, &slot_hdr, &slot_id, obj_id, obj_inst_id) != 0) {
+	int32_t bucket = logfs_index_find (logfs, &slot_hdr, obj_id, obj_inst_id);
+	if (bucket < 0) {
 		/* Object does not exist in fs */
 		rc = -3;
 		goto out_end_trans;
 	}
+	uint16_t slot_id = logfs->index[bucket].slot_id;
 
 	/* Sanity check what we've found */
 	if (slot_hdr.obj_size != obj_size) {
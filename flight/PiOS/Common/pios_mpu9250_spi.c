@@ -44,6 +44,7 @@
 #define MPU9250_TASK_PRIORITY    PIOS_THREAD_PRIO_HIGHEST
 #define MPU9250_TASK_STACK_BYTES 512
 #define PIOS_MPU9250_MAX_DOWNSAMPLE 2
+#define PIOS_MPU9250_RING_DEPTH 16
 
 #define MPU9250_WHOAMI_ID       0x71
 
@@ -81,11 +82,12 @@ struct mpu9250_dev {
 	uint32_t slave_num;
 	enum pios_mpu60x0_accel_range accel_range;
 	enum pios_mpu60x0_range gyro_range;
-	struct pios_queue *gyro_queue;
-	struct pios_queue *accel_queue;
+	struct pios_sensor_ring *gyro_ring;
+	struct pios_sensor_ring *accel_ring;
 	struct pios_queue *mag_queue;
 	struct pios_thread *TaskHandle;
 	struct pios_semaphore *data_ready_sema;
+	volatile uint32_t sample_timestamp;
 	const struct pios_mpu9250_cfg *cfg;
 	enum pios_mpu9250_gyro_filter gyro_filter;
 	enum pios_mpu9250_accel_filter accel_filter;
@@ -117,15 +119,15 @@ static struct mpu9250_dev *PIOS_MPU9250_alloc(const struct pios_mpu9250_cfg *cfg
 
 	mpu9250_dev->magic = PIOS_MPU9250_DEV_MAGIC;
 
-	mpu9250_dev->accel_queue = PIOS_Queue_Create(PIOS_MPU9250_MAX_DOWNSAMPLE, sizeof(struct pios_sensor_accel_data));
-	if (mpu9250_dev->accel_queue == NULL) {
+	/* Rings are never freed, like everything else allocated at boot */
+	mpu9250_dev->accel_ring = PIOS_SENSORS_RingCreate(sizeof(struct pios_sensor_accel_data), PIOS_MPU9250_RING_DEPTH);
+	if (mpu9250_dev->accel_ring == NULL) {
 		PIOS_free(mpu9250_dev);
 		return NULL;
 	}
 
-	mpu9250_dev->gyro_queue = PIOS_Queue_Create(PIOS_MPU9250_MAX_DOWNSAMPLE, sizeof(struct pios_sensor_gyro_data));
-	if (mpu9250_dev->gyro_queue == NULL) {
-		PIOS_Queue_Delete(dev->accel_queue);
+	mpu9250_dev->gyro_ring = PIOS_SENSORS_RingCreate(sizeof(struct pios_sensor_gyro_data), PIOS_MPU9250_RING_DEPTH);
+	if (mpu9250_dev->gyro_ring == NULL) {
 		PIOS_free(mpu9250_dev);
 		return NULL;
 	}
@@ -133,8 +135,6 @@ static struct mpu9250_dev *PIOS_MPU9250_alloc(const struct pios_mpu9250_cfg *cfg
 	if (cfg->use_magnetometer) {
 		mpu9250_dev->mag_queue = PIOS_Queue_Create(PIOS_MPU9250_MAX_DOWNSAMPLE, sizeof(struct pios_sensor_mag_data));
 		if (mpu9250_dev->mag_queue == NULL) {
-			PIOS_Queue_Delete(dev->accel_queue);
-			PIOS_Queue_Delete(dev->gyro_queue);
 			PIOS_free(mpu9250_dev);
 			return NULL;
 		}
@@ -142,10 +142,8 @@ static struct mpu9250_dev *PIOS_MPU9250_alloc(const struct pios_mpu9250_cfg *cfg
 
 	mpu9250_dev->data_ready_sema = PIOS_Semaphore_Create();
 	if (mpu9250_dev->data_ready_sema == NULL) {
-		PIOS_Queue_Delete(dev->accel_queue);
-		PIOS_Queue_Delete(dev->gyro_queue);
 		if (cfg->use_magnetometer)
-			PIOS_Queue_Delete(dev->mag_queue);
+			PIOS_Queue_Delete(mpu9250_dev->mag_queue);
 		PIOS_free(mpu9250_dev);
 		return NULL;
 	}
@@ -421,8 +419,8 @@ int32_t PIOS_MPU9250_SPI_Init(uint32_t spi_id, uint32_t slave_num, const struct
 			PIOS_MPU9250_Task, "pios_mpu9250", MPU9250_TASK_STACK_BYTES, NULL, MPU9250_TASK_PRIORITY);
 	PIOS_Assert(dev->TaskHandle != NULL);
 
-	PIOS_SENSORS_Register(PIOS_SENSOR_ACCEL, dev->accel_queue);
-	PIOS_SENSORS_Register(PIOS_SENSOR_GYRO, dev->gyro_queue);
+	PIOS_SENSORS_RegisterRing(PIOS_SENSOR_ACCEL, dev->accel_ring);
+	PIOS_SENSORS_RegisterRing(PIOS_SENSOR_GYRO, dev->gyro_ring);
 
 	if (dev->cfg->use_magnetometer)
 		PIOS_SENSORS_Register(PIOS_SENSOR_MAG, dev->mag_queue);
@@ -594,6 +592,9 @@ bool PIOS_MPU9250_IRQHandler(void)
 
 	bool need_yield = false;
 
+	// Data ready means the sample was just latched, remember when
+	dev->sample_timestamp = PIOS_DELAY_GetRaw();
+
 	PIOS_Semaphore_Give_FromISR(dev->data_ready_sema, &need_yield);
 
 	return need_yield;
@@ -606,6 +607,8 @@ static void PIOS_MPU9250_Task(void *parameters)
 		if (PIOS_Semaphore_Take(dev->data_ready_sema, PIOS_SEMAPHORE_TIMEOUT_MAX) != true)
 			continue;
 
+		uint32_t timestamp = dev->sample_timestamp;
+
 		enum {
 			IDX_REG = 0,
 			IDX_ACCEL_XOUT_H,
@@ -778,8 +781,8 @@ static void PIOS_MPU9250_Task(void *parameters)
 		gyro_data.z *= gyro_scale;
 		gyro_data.temperature = temperature;
 
-		PIOS_Queue_Send(dev->accel_queue, &accel_data, 0);
-		PIOS_Queue_Send(dev->gyro_queue, &gyro_data, 0);
+		PIOS_SENSORS_Publish(dev->accel_ring, &accel_data, &timestamp, 1);
+		PIOS_SENSORS_Publish(dev->gyro_ring, &gyro_data, &timestamp, 1);
 
 		if (dev->cfg->use_magnetometer) {
 			uint8_t st1 = mpu9250_rec_buf[IDX_MAG_ST1];
@@ -32,17 +32,44 @@
 // lower driver (??)
 
 #include "pios_sensors.h"
+#include "pios_semaphore.h"
+#include "pios_heap.h"
 #include <stddef.h>
+#include <string.h>
+
+/**
+ * Single producer, single consumer ring of samples. Each entry is the
+ * capture timestamp followed by the sample itself. The producer only
+ * moves head and the consumer only moves tail, so a driver can publish
+ * a whole hardware FIFO worth of samples while the consumer drains.
+ * Neither side needs a critical section, only a barrier before it moves
+ * its index, so the producer can be an interrupt handler.
+ */
+struct pios_sensor_ring {
+	uint8_t *buf;
+	uint16_t sample_size;
+	uint16_t entry_size;
+	uint16_t depth;		//!< one more than the number of samples held
+	volatile uint16_t head;	//!< next entry to write
+	volatile uint16_t tail;	//!< next entry to read
+	volatile uint32_t overruns;
+	struct pios_semaphore *data_ready;
+	pios_sensor_tap_t tap;	//!< also sees each drained burst
+};
 
 //! The list of queue handles
 static struct pios_queue *queues[PIOS_SENSOR_LAST];
+//! The list of sample rings
+static struct pios_sensor_ring *rings[PIOS_SENSOR_LAST];
 static int32_t max_gyro_rate;
 
 //! Initialize the sensors interface
 int32_t PIOS_SENSORS_Init()
 {
-	for (uint32_t i = 0; i < PIOS_SENSOR_LAST; i++)
+	for (uint32_t i = 0; i < PIOS_SENSOR_LAST; i++) {
 		queues[i] = NULL;
+		rings[i] = NULL;
+	}
 
 	return 0;
 }
@@ -50,7 +77,7 @@ int32_t PIOS_SENSORS_Init()
 //! Register a sensor with the PIOS_SENSORS interface
 int32_t PIOS_SENSORS_Register(enum pios_sensor_type type, struct pios_queue *queue)
 {
-	if(queues[type] != NULL)
+	if(queues[type] != NULL || rings[type] != NULL)
 		return -1;
 
 	queues[type] = queue;
@@ -64,7 +91,7 @@ bool PIOS_SENSORS_IsRegistered(enum pios_sensor_type type)
 	if(type >= PIOS_SENSOR_LAST)
 		return false;
 
-	if(queues[type] != NULL)
+	if(queues[type] != NULL || rings[type] != NULL)
 		return true;
 
 	return false;
@@ -79,6 +106,204 @@ struct pios_queue *PIOS_SENSORS_GetQueue(enum pios_sensor_type type)
 	return queues[type];
 }
 
+/**
+ * @brief Create a ring for a sensor that delivers samples in bursts
+ * @param[in] sample_size size of one sample, usually one of the pios_sensor_*_data structs
+ * @param[in] depth number of samples the ring holds before dropping new ones
+ * @return the ring or NULL if it could not be allocated
+ */
+struct pios_sensor_ring *PIOS_SENSORS_RingCreate(uint16_t sample_size, uint16_t depth)
+{
+	struct pios_sensor_ring *ring = PIOS_malloc(sizeof(*ring));
+	if (ring == NULL)
+		return NULL;
+
+	/* Keep the timestamp of every entry aligned */
+	ring->sample_size = sample_size;
+	ring->entry_size = sizeof(uint32_t) + ((sample_size + 3) & ~3);
+	ring->depth = depth + 1;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->overruns = 0;
+	ring->tap = NULL;
+
+	ring->buf = PIOS_malloc(ring->depth * ring->entry_size);
+	if (ring->buf == NULL) {
+		PIOS_free(ring);
+		return NULL;
+	}
+
+	ring->data_ready = PIOS_Semaphore_Create();
+	if (ring->data_ready == NULL) {
+		PIOS_free(ring->buf);
+		PIOS_free(ring);
+		return NULL;
+	}
+
+	return ring;
+}
+
+//! Register a sensor that publishes through a ring with the PIOS_SENSORS interface
+int32_t PIOS_SENSORS_RegisterRing(enum pios_sensor_type type, struct pios_sensor_ring *ring)
+{
+	if(queues[type] != NULL || rings[type] != NULL)
+		return -1;
+
+	rings[type] = ring;
+
+	return 0;
+}
+
+//! Get the sample ring for a sensor type
+struct pios_sensor_ring *PIOS_SENSORS_GetRing(enum pios_sensor_type type)
+{
+	if (type >= PIOS_SENSOR_LAST)
+		return NULL;
+
+	return rings[type];
+}
+
+//! Copy samples into the ring, returns how many fit
+static uint16_t ring_put(struct pios_sensor_ring *ring, const void *samples, const uint32_t *timestamps, uint16_t count)
+{
+	const uint8_t *src = samples;
+	uint32_t now = (timestamps == NULL) ? PIOS_DELAY_GetRaw() : 0;
+	uint16_t head = ring->head;
+	uint16_t stored;
+
+	for (stored = 0; stored < count; stored++) {
+		uint16_t next = head + 1;
+		if (next == ring->depth)
+			next = 0;
+		if (next == ring->tail)
+			break;
+
+		uint8_t *entry = &ring->buf[head * ring->entry_size];
+		uint32_t timestamp = (timestamps == NULL) ? now : timestamps[stored];
+		memcpy(entry, &timestamp, sizeof(timestamp));
+		memcpy(entry + sizeof(timestamp), src, ring->sample_size);
+		src += ring->sample_size;
+		head = next;
+	}
+
+	/* Only now make the new entries visible to the consumer */
+	__sync_synchronize();
+	ring->head = head;
+	ring->overruns += count - stored;
+
+	return stored;
+}
+
+/**
+ * @brief Publish a burst of samples, such as the contents of a hardware FIFO
+ * @param[in] ring the ring to publish to
+ * @param[in] samples count samples, oldest first
+ * @param[in] timestamps capture time of every sample as PIOS_DELAY_GetRaw() values, or
+ * NULL to stamp them all with the current time
+ * @param[in] count number of samples
+ * @return number of samples stored, the rest were dropped because the ring was full
+ */
+uint16_t PIOS_SENSORS_Publish(struct pios_sensor_ring *ring, const void *samples, const uint32_t *timestamps, uint16_t count)
+{
+	uint16_t stored = ring_put(ring, samples, timestamps, count);
+
+	PIOS_Semaphore_Give(ring->data_ready);
+
+	return stored;
+}
+
+//! Publish a burst of samples from an interrupt handler, see @ref PIOS_SENSORS_Publish
+uint16_t PIOS_SENSORS_PublishFromISR(struct pios_sensor_ring *ring, const void *samples, const uint32_t *timestamps, uint16_t count, bool *woken)
+{
+	uint16_t stored = ring_put(ring, samples, timestamps, count);
+
+	PIOS_Semaphore_Give_FromISR(ring->data_ready, woken);
+
+	return stored;
+}
+
+/**
+ * @brief Wait until samples have been published to a ring
+ * @param[in] ring the ring to wait on
+ * @param[in] timeout_ms how long to wait
+ * @return true if samples are pending, false on timeout
+ */
+bool PIOS_SENSORS_RingWait(struct pios_sensor_ring *ring, uint32_t timeout_ms)
+{
+	if (ring->head != ring->tail)
+		return true;
+
+	/* The semaphore can be left over from samples drained already, so check again */
+	while (PIOS_Semaphore_Take(ring->data_ready, timeout_ms)) {
+		if (ring->head != ring->tail)
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Take every pending sample out of a ring in one call
+ * @param[in] ring the ring to drain
+ * @param[out] samples room for max_count samples, oldest first
+ * @param[out] timestamps room for max_count capture times, or NULL if not needed
+ * @param[in] max_count most samples to take
+ * @return number of samples taken
+ */
+uint16_t PIOS_SENSORS_Drain(struct pios_sensor_ring *ring, void *samples, uint32_t *timestamps, uint16_t max_count)
+{
+	uint8_t *dst = samples;
+	uint16_t head = ring->head;
+	uint16_t tail = ring->tail;
+	uint16_t taken;
+
+	for (taken = 0; taken < max_count && tail != head; taken++) {
+		const uint8_t *entry = &ring->buf[tail * ring->entry_size];
+		if (timestamps != NULL)
+			memcpy(&timestamps[taken], entry, sizeof(uint32_t));
+		memcpy(dst, entry + sizeof(uint32_t), ring->sample_size);
+		dst += ring->sample_size;
+		if (++tail == ring->depth)
+			tail = 0;
+	}
+
+	/* Hand the entries back to the producer once they have been copied out */
+	__sync_synchronize();
+	ring->tail = tail;
+
+	/* Let the tap read the burst in place rather than keep its own copy */
+	pios_sensor_tap_t tap = ring->tap;
+	if (tap != NULL && taken > 0)
+		tap(samples, timestamps, taken);
+
+	return taken;
+}
+
+//! Number of samples dropped because the ring was full
+uint32_t PIOS_SENSORS_GetOverruns(struct pios_sensor_ring *ring)
+{
+	return ring->overruns;
+}
+
+/**
+ * @brief Pass every burst drained from a ring to a tap as well
+ *
+ * The tap runs in the context of whoever drains the ring, right after the
+ * samples were copied out, so it must be short.  Only one tap is kept.
+ * @param[in] ring the ring to watch
+ * @param[in] tap the function to call, or NULL to remove the tap
+ * @return 0 on success, -1 if there is no ring
+ */
+int32_t PIOS_SENSORS_SetTap(struct pios_sensor_ring *ring, pios_sensor_tap_t tap)
+{
+	if (ring == NULL)
+		return -1;
+
+	ring->tap = tap;
+
+	return 0;
+}
+
 //! Set the maximum gyro rate in deg/s
 void PIOS_SENSORS_SetMaxGyro(int32_t rate)
 {
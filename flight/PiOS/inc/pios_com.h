@@ -57,6 +57,8 @@ extern int32_t PIOS_COM_SendString(uintptr_t com_id, const char *str);
 extern int32_t PIOS_COM_SendFormattedStringNonBlocking(uintptr_t com_id, const char *format, ...);
 extern int32_t PIOS_COM_SendFormattedString(uintptr_t com_id, const char *format, ...);
 extern uint16_t PIOS_COM_ReceiveBuffer(uintptr_t com_id, uint8_t * buf, uint16_t buf_len, uint32_t timeout_ms);
+extern uint16_t PIOS_COM_LendRxBuffer(uintptr_t com_id, const uint8_t ** buf, uint32_t timeout_ms);
+extern void PIOS_COM_ReleaseRxBuffer(uintptr_t com_id, uint16_t len);
 extern bool PIOS_COM_Available(uintptr_t com_id);
 
 #endif /* PIOS_COM_H */
@@ -34,4 +34,9 @@ int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
 int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t * obj_data, uint16_t obj_size);
 int32_t PIOS_FLASHFS_ObjDelete(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id);
 
+int32_t PIOS_FLASHFS_BatchBegin(uintptr_t fs_id, uint16_t num_objs);
+int32_t PIOS_FLASHFS_BatchSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t * obj_data, uint16_t obj_size);
+int32_t PIOS_FLASHFS_BatchCommit(uintptr_t fs_id);
+int32_t PIOS_FLASHFS_BatchAbort(uintptr_t fs_id);
+
 #endif	/* PIOS_FLASHFS_H_ */
@@ -92,6 +92,12 @@ enum pios_sensor_type
 	PIOS_SENSOR_LAST
 };
 
+//! Ring of timestamped samples, for sensors that deliver several samples at once
+struct pios_sensor_ring;
+
+//! Sees every burst drained from a ring, in the context of the consumer
+typedef void (*pios_sensor_tap_t)(const void *samples, const uint32_t *timestamps, uint16_t count);
+
 //! Initialize the PIOS_SENSORS interface
 int32_t PIOS_SENSORS_Init();
 
@@ -104,6 +110,33 @@ bool PIOS_SENSORS_IsRegistered(enum pios_sensor_type type);
 //! Get the data queue for a sensor type
 struct pios_queue *PIOS_SENSORS_GetQueue(enum pios_sensor_type type);
 
+//! Create a ring holding up to depth samples of sample_size bytes
+struct pios_sensor_ring *PIOS_SENSORS_RingCreate(uint16_t sample_size, uint16_t depth);
+
+//! Register a sensor that publishes through a ring with the PIOS_SENSORS interface
+int32_t PIOS_SENSORS_RegisterRing(enum pios_sensor_type type, struct pios_sensor_ring *ring);
+
+//! Get the sample ring for a sensor type
+struct pios_sensor_ring *PIOS_SENSORS_GetRing(enum pios_sensor_type type);
+
+//! Publish a burst of samples, timestamps are PIOS_DELAY_GetRaw() values or NULL for now
+uint16_t PIOS_SENSORS_Publish(struct pios_sensor_ring *ring, const void *samples, const uint32_t *timestamps, uint16_t count);
+
+//! Publish a burst of samples from an interrupt handler
+uint16_t PIOS_SENSORS_PublishFromISR(struct pios_sensor_ring *ring, const void *samples, const uint32_t *timestamps, uint16_t count, bool *woken);
+
+//! Wait until samples have been published to a ring
+bool PIOS_SENSORS_RingWait(struct pios_sensor_ring *ring, uint32_t timeout_ms);
+
+//! Take every pending sample out of a ring, oldest first
+uint16_t PIOS_SENSORS_Drain(struct pios_sensor_ring *ring, void *samples, uint32_t *timestamps, uint16_t max_count);
+
+//! Number of samples dropped because the ring was full
+uint32_t PIOS_SENSORS_GetOverruns(struct pios_sensor_ring *ring);
+
+//! Pass every burst drained from a ring to a tap as well
+int32_t PIOS_SENSORS_SetTap(struct pios_sensor_ring *ring, pios_sensor_tap_t tap);
+
 //! Set the maximum gyro rate in deg/s
 void PIOS_SENSORS_SetMaxGyro(int32_t rate);
 
@@ -139,6 +139,8 @@ typedef struct {
 	uint32_t eventCallbackErrors;
 	uint32_t lastCallbackErrorID;
 	uint32_t lastQueueErrorID;
+	uint32_t seqlockReads;
+	uint32_t seqlockFallbacks;
 } UAVObjStats;
 
 typedef void (*new_uavo_instance_cb_t)(uint32_t,uint32_t);
@@ -148,7 +150,8 @@ int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats* statsOut);
 void UAVObjClearStats();
 UAVObjHandle UAVObjRegister(uint32_t id,
-		int32_t isSingleInstance, int32_t isSettings, uint32_t numBytes, UAVObjInitializeCallback initCb);
+		int32_t isSingleInstance, int32_t isSettings, int32_t isSeqlock,
+		uint32_t numBytes, UAVObjInitializeCallback initCb);
 UAVObjHandle UAVObjGetByID(uint32_t id);
 uint32_t UAVObjGetID(UAVObjHandle obj);
 uint32_t UAVObjGetNumBytes(UAVObjHandle obj);
@@ -196,6 +199,8 @@ UAVObjUpdateMode UAVObjGetTelemetryUpdateMode(const UAVObjMetadata* dataOut);
 void UAVObjSetTelemetryUpdateMode(UAVObjMetadata* dataOut, UAVObjUpdateMode val);
 UAVObjUpdateMode UAVObjGetGcsTelemetryUpdateMode(const UAVObjMetadata* dataOut);
 void UAVObjSetTelemetryGcsUpdateMode(UAVObjMetadata* dataOut, UAVObjUpdateMode val);
+bool UAVObjIsTelemetryDelta(UAVObjHandle obj);
+void UAVObjSetTelemetryDelta(UAVObjHandle obj, bool val);
 int8_t UAVObjReadOnly(UAVObjHandle obj);
 int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, struct pios_queue *queue, uint8_t eventMask);
 int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, struct pios_queue *queue);
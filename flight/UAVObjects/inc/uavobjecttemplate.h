@@ -47,6 +47,8 @@ $(PARENT_INCLUDES)
 #define $(NAMEUC)_OBJID $(OBJIDHEX)
 #define $(NAMEUC)_ISSINGLEINST $(ISSINGLEINST)
 #define $(NAMEUC)_ISSETTINGS $(ISSETTINGS)
+#define $(NAMEUC)_ISSEQLOCK $(ISSEQLOCK)
+#define $(NAMEUC)_ISTELEMETRYDELTA $(FLIGHTTELEM_DELTA)
 #define $(NAMEUC)_NUMBYTES $(NUMBYTES)
 
 // Generic interface functions
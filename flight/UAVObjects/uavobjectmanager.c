@@ -35,11 +35,36 @@
 #include "pios_mutex.h"
 #include "pios_queue.h"
 #include "misc_math.h"
+#include "uavobjectsinit.h"	/* UAVOBJECTS_COUNT */
 
 extern uintptr_t pios_uavo_settings_fs_id;
 
 // Constants
 
+/*
+ * Number of objects that can be held in the ID lookup index.  Defaults to
+ * every object known to the generator, boards may shrink it to save RAM.
+ * Objects registered after the index is full are still found, just slower.
+ */
+#ifndef UAVOBJ_INDEX_SIZE
+#define UAVOBJ_INDEX_SIZE UAVOBJECTS_COUNT
+#endif
+
+/* Lock free read attempts on a seqlock object before falling back to the mutex */
+#ifndef UAVOBJ_SEQLOCK_RETRIES
+#define UAVOBJ_SEQLOCK_RETRIES 2
+#endif
+
+/* Largest seqlock object */
+#ifndef UAVOBJ_SEQLOCK_MAX_BYTES
+#define UAVOBJ_SEQLOCK_MAX_BYTES 128
+#endif
+
+/* Smallest number of instances allocated when a multi instance object grows */
+#ifndef UAVOBJ_INSTANCE_GROWTH_MIN
+#define UAVOBJ_INSTANCE_GROWTH_MIN 4
+#endif
+
 // Private types
 
 // Macros
@@ -70,11 +95,9 @@ struct ObjectEventEntryThrottled {
 /*
   MetaInstance   == [UAVOBase [UAVObjMetadata]]
   SingleInstance == [UAVOBase [UAVOData [InstanceData]]]
-  MultiInstance  == [UAVOBase [UAVOData [NumInstances [InstanceData0 [next]]]]
-                                                  ____________________/
-                                                  \-->[InstanceData1 [next]]
-                                                  _________...________/
-                                                  \-->[InstanceDataN [next]]
+  MultiInstance  == [UAVOBase [UAVOData [NumInstances [MaxInstances [instances [InstanceData0]]]]]]
+                                                                     ____/
+                                                                     \-->[InstanceData1 .. InstanceDataMax]
  */
 
 /*
@@ -91,6 +114,8 @@ struct UAVOBase {
 		bool isMeta        : 1;
 		bool isSingle      : 1;
 		bool isSettings    : 1;
+		bool isSeqlock     : 1;
+		bool isTelemDelta  : 1;
 	} flags;
 
 } __attribute__((packed));
@@ -122,16 +147,9 @@ struct UAVOSingle {
 	/* 
 	 * Additional space will be malloc'd here to hold the
 	 * the data for this instance.
-	 */
-} __attribute__((packed));
-
-/* Part of a linked list of instances chained off of a multi instance UAVO. */
-struct UAVOMultiInst {
-	struct UAVOMultiInst * next;
-	uint8_t                instance[];
-	/* 
-	 * Additional space will be malloc'd here to hold the
-	 * the data for this instance.
+	 *
+	 * Seqlock objects also get a word aligned sequence counter
+	 * after the data, see SeqlockCounter().
 	 */
 } __attribute__((packed));
 
@@ -140,7 +158,11 @@ struct UAVOMulti {
 	struct UAVOData        uavo;
 
 	uint16_t               num_instances;
-	struct UAVOMultiInst   instance0;
+	/* Number of instances after instance 0 that fit in the instances array */
+	uint16_t               max_instances;
+	/* Contiguous storage for instances 1..max_instances, grown on demand */
+	uint8_t              * instances;
+	uint8_t                instance0[];
 	/*
 	 * Additional space will be malloc'd here to hold the
 	 * the data for instance 0.
@@ -157,23 +179,44 @@ struct UAVOMulti {
 
 /** all information about instances are dependant on object type **/
 #define ObjSingleInstanceDataOffset(obj) ((void*)(&(( (struct UAVOSingle*)obj )->instance0)))
-#define InstanceDataOffset(inst) ((void*)&(( (struct UAVOMultiInst*)inst )->instance))
 #define InstanceData(instance) (void*)instance
+#define SeqlockCounter(obj) ((volatile uint32_t *)(((uintptr_t)ObjSingleInstanceDataOffset(obj) + (obj)->instance_size + 3) & ~(uintptr_t)3))
 
 // Private functions
 static int32_t sendEvent(struct UAVOBase * obj, uint16_t instId,
 			UAVObjEventType event);
 static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId);
 static InstanceHandle getInstance(struct UAVOData * obj, uint16_t instId);
+static int32_t reserveInstances(struct UAVOMulti * uavo_multi, uint16_t num_instances);
+static inline bool isSeqlock(UAVObjHandle obj_handle);
+static inline void seqlockWriteBegin(UAVObjHandle obj_handle);
+static inline void seqlockWriteEnd(UAVObjHandle obj_handle);
+static bool seqlockRead(struct UAVOData * obj, void * dataOut, uint32_t offset, uint32_t size);
 static int32_t connectObj(UAVObjHandle obj_handle, struct pios_queue *queue,
 			UAVObjEventCallback cb, uint8_t eventMask,
 			uint16_t interval);
 static int32_t disconnectObj(UAVObjHandle obj_handle, struct pios_queue *queue,
 			UAVObjEventCallback cb);
+static void indexInsert(struct UAVOData * obj);
+static UAVObjHandle indexLookup(uint32_t id, bool * definitive);
 
 // Private variables
 static struct UAVOData * uavo_list;
+
+/*
+ * Registered objects sorted by ID.  Only modified with the mutex held.
+ * Readers do not lock; they sample uavo_index_seq before and after the
+ * search and fall back to the locked list walk if it was odd (update in
+ * progress) or has changed.
+ */
+static struct UAVOData ** uavo_index;
+static volatile uint16_t uavo_index_len;
+static volatile uint32_t uavo_index_seq;
+static bool uavo_index_overflow;
+
 static struct pios_recursive_mutex *mutex;
+/* Guards uavobj_flash_buffer, taken before mutex when both are held */
+static struct pios_recursive_mutex *flash_mutex;
 static const UAVObjMetadata defMetadata = {
 	.flags = (ACCESS_READWRITE << UAVOBJ_ACCESS_SHIFT |
 		ACCESS_READWRITE << UAVOBJ_GCS_ACCESS_SHIFT |
@@ -200,10 +243,19 @@ int32_t UAVObjInitialize()
 
 	memset(&stats, 0, sizeof(UAVObjStats));
 
+	// Allocate the lookup index, lookups fall back to the list without it
+	uavo_index = PIOS_malloc_no_dma(UAVOBJ_INDEX_SIZE * sizeof(*uavo_index));
+	uavo_index_len = 0;
+	uavo_index_seq = 0;
+	uavo_index_overflow = (uavo_index == NULL);
+
 	// Create mutex
 	mutex = PIOS_Recursive_Mutex_Create();
 	if (mutex == NULL)
 		return -1;
+	flash_mutex = PIOS_Recursive_Mutex_Create();
+	if (flash_mutex == NULL)
+		return -1;
 	// Done
 	return 0;
 }
@@ -250,11 +302,15 @@ static void UAVObjInitMetaData (struct UAVOMeta * obj_meta)
 	memset(&(obj_meta->instance0), 0, sizeof(obj_meta->instance0));
 }
 
-static struct UAVOData * UAVObjAllocSingle(uint32_t num_bytes)
+static struct UAVOData * UAVObjAllocSingle(uint32_t num_bytes, bool seqlock)
 {
 	/* Compute the complete size of the object, including the data for a single embedded instance */
 	uint32_t object_size = sizeof(struct UAVOSingle) + num_bytes;
 
+	/* Leave room to word align the sequence counter after the data */
+	if (seqlock)
+		object_size += sizeof(uint32_t) + 3;
+
 	/* Allocate the object from the heap */
 	struct UAVOSingle * uavo_single = (struct UAVOSingle *) PIOS_malloc_no_dma(object_size);
 	if (!uavo_single)
@@ -269,6 +325,12 @@ static struct UAVOData * UAVObjAllocSingle(uint32_t num_bytes)
 	/* Clear the instance data carried in the UAVO */
 	memset(&(uavo_single->instance0), 0, num_bytes);
 
+	if (seqlock) {
+		uavo_base->flags.isSeqlock = true;
+		uavo_single->uavo.instance_size = num_bytes;
+		*SeqlockCounter(&uavo_single->uavo) = 0;
+	}
+
 	/* Give back the generic UAVO part */
 	return (&(uavo_single->uavo));
 }
@@ -291,10 +353,11 @@ static struct UAVOData * UAVObjAllocMulti(uint32_t num_bytes)
 
 	/* Set up the type-specific part of the UAVO */
 	uavo_multi->num_instances = 1;
+	uavo_multi->max_instances = 0;
+	uavo_multi->instances     = NULL;
 
 	/* Clear the instance data carried in the UAVO */
-	uavo_multi->instance0.next = NULL;
-	memset (&(uavo_multi->instance0.instance), 0, num_bytes);
+	memset (&(uavo_multi->instance0), 0, num_bytes);
 
 	/* Give back the generic UAVO part */
 	return (&(uavo_multi->uavo));
@@ -309,18 +372,21 @@ static struct UAVOData * UAVObjAllocMulti(uint32_t num_bytes)
  * \param[in] id Unique object ID
  * \param[in] isSingleInstance Is this a single instance or multi-instance object
  * \param[in] isSettings Is this a settings object
+ * \param[in] isSeqlock Let readers copy the data without locking (single instance only)
  * \param[in] numBytes Number of bytes of object data (for one instance)
  * \param[in] initCb Default field and metadata initialization function
  * \return Object handle, or NULL if failure.
  * \return
  */
 UAVObjHandle UAVObjRegister(uint32_t id, 
-			int32_t isSingleInstance, int32_t isSettings,
+			int32_t isSingleInstance, int32_t isSettings, int32_t isSeqlock,
 			uint32_t num_bytes,
 			UAVObjInitializeCallback initCb)
 {
 	struct UAVOData * uavo_data = NULL;
 
+	/* Loads the object below, so the flash lock comes first */
+	PIOS_Recursive_Mutex_Lock(flash_mutex, PIOS_MUTEX_TIMEOUT_MAX);
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
 	/* Don't allow duplicate registrations */
@@ -329,7 +395,8 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 
 	/* Map the various flags to one of the UAVO types we understand */
 	if (isSingleInstance) {
-		uavo_data = UAVObjAllocSingle (num_bytes);
+		uavo_data = UAVObjAllocSingle (num_bytes,
+			isSeqlock && !isSettings && num_bytes <= UAVOBJ_SEQLOCK_MAX_BYTES);
 	} else {
 		uavo_data = UAVObjAllocMulti (num_bytes);
 	}
@@ -349,6 +416,7 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 
 	/* Add the newly created object to the global list of objects */
 	LL_APPEND(uavo_list, uavo_data);
+	indexInsert(uavo_data);
 
 	/* Initialize object fields and metadata to default values */
 	if (initCb)
@@ -367,6 +435,7 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 
 unlock_exit:
 	PIOS_Recursive_Mutex_Unlock(mutex);
+	PIOS_Recursive_Mutex_Unlock(flash_mutex);
 	return (UAVObjHandle) uavo_data;
 }
 
@@ -377,9 +446,13 @@ unlock_exit:
  */
 UAVObjHandle UAVObjGetByID(uint32_t id)
 {
-	UAVObjHandle * found_obj = (UAVObjHandle *) NULL;
+	bool definitive;
+	UAVObjHandle * found_obj = indexLookup(id, &definitive);
 
-	// Get lock
+	if (found_obj || definitive)
+		return found_obj;
+
+	// Not every object is in the index, walk the list
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
 	// Look for object
@@ -619,7 +692,9 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
 			}
 		}
 		// Set the data
+		seqlockWriteBegin(obj_handle);
 		memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+		seqlockWriteEnd(obj_handle);
 	}
 
 	// Fire event
@@ -642,6 +717,13 @@ int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t * dataOut)
 {
 	PIOS_Assert(obj_handle);
 
+	// Seqlock objects can usually be copied without the lock
+	if (instId == 0 && isSeqlock(obj_handle) &&
+			seqlockRead((struct UAVOData *) obj_handle, dataOut, 0,
+				((struct UAVOData *) obj_handle)->instance_size)) {
+		return 0;
+	}
+
 	// Lock
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
@@ -675,15 +757,16 @@ unlock_exit:
 	return rc;
 }
 
-#if defined(PIOS_INCLUDE_FASTHEAP)
 /**
- * Trampoline buffer used for loads from the underlying filesystem.
- * This is required on platforms that store the UAVO data in non-DMA
- * RAM regions since the underlying flash driver may use DMA to transfer
- * the data into the buffer that we give it.
+ * Buffer the object data goes through on its way to and from the
+ * filesystem, guarded by flash_mutex.  The instances of a multi instance
+ * object move when another instance is created, so they are only copied
+ * to and from this buffer under the object lock and never handed to the
+ * filesystem.  It is also the trampoline on platforms that store the UAVO
+ * data in non-DMA RAM regions, since the underlying flash driver may use
+ * DMA to transfer the data.
  */
-static uint8_t uavobj_save_trampoline[256] __attribute__((aligned(4)));
-#endif	/* PIOS_INCLUDE_FASTHEAP */
+static uint8_t uavobj_flash_buffer[UAVOBJECTS_LARGEST] __attribute__((aligned(4)));
 
 /**
  * Save the data of the specified object to the file system (SD card).
@@ -699,77 +782,61 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
 
+	uint32_t num_bytes = UAVObjGetNumBytes(obj_handle);
+	if (num_bytes > sizeof(uavobj_flash_buffer))
+		return -1;
+
+	PIOS_Recursive_Mutex_Lock(flash_mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t rc = -1;
+
 	if (UAVObjIsMetaobject(obj_handle)) {
 		if (instId != 0)
-			return -1;
+			goto unlock_exit;
 
 		// Save the object to the filesystem
-		int32_t rc;
 #if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(uavobj_save_trampoline,
+		memcpy(uavobj_flash_buffer,
 			MetaDataPtr((struct UAVOMeta *)obj_handle),
-			UAVObjGetNumBytes(obj_handle));
+			num_bytes);
 
 		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
 					UAVObjGetID(obj_handle),
 					instId,
-					uavobj_save_trampoline,
-					UAVObjGetNumBytes(obj_handle));
+					uavobj_flash_buffer,
+					num_bytes);
 #else /* PIOS_INCLUDE_FASTHEAP */
 		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
 					UAVObjGetID(obj_handle),
 					instId,
 					(uint8_t*) MetaDataPtr((struct UAVOMeta *)obj_handle),
-					UAVObjGetNumBytes(obj_handle));
+					num_bytes);
 #endif  /* PIOS_INCLUDE_FASTHEAP */
-
-		if (rc != 0)
-			return -1;
 	} else {
+		PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 		InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
+		if (instEntry != NULL)
+			memcpy(uavobj_flash_buffer, InstanceData(instEntry), num_bytes);
+		PIOS_Recursive_Mutex_Unlock(mutex);
 
 		if (instEntry == NULL)
-			return -1;
-
-		if (InstanceData(instEntry) == NULL)
-			return -1;
+			goto unlock_exit;
 
 		// Save the object to the filesystem
-		int32_t rc;
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(uavobj_save_trampoline,
-			InstanceData(instEntry),
-			UAVObjGetNumBytes(obj_handle));
-
-		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					uavobj_save_trampoline,
-					UAVObjGetNumBytes(obj_handle));
-#else /* PIOS_INCLUDE_FASTHEAP */
 		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
 					UAVObjGetID(obj_handle),
 					instId,
-					InstanceData(instEntry),
-					UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
-
-		if (rc != 0)
-			return -1;
+					uavobj_flash_buffer,
+					num_bytes);
 	}
 
-	return 0;
-}
+	if (rc != 0)
+		rc = -1;
 
-#if defined(PIOS_INCLUDE_FASTHEAP)
-/**
- * Trampoline buffer used for loads from the underlying filesystem.
- * This is required on platforms that store the UAVO data in non-DMA
- * RAM regions since the underlying flash driver may use DMA to transfer
- * the data into the buffer that we give it.
- */
-static uint8_t uavobj_load_trampoline[256] __attribute__((aligned(4)));
-#endif	/* PIOS_INCLUDE_FASTHEAP */
+unlock_exit:
+	PIOS_Recursive_Mutex_Unlock(flash_mutex);
+	return rc;
+}
 
 /**
  * Load an object from the file system (SD card).
@@ -783,64 +850,64 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
 
+	uint32_t num_bytes = UAVObjGetNumBytes(obj_handle);
+	if (num_bytes > sizeof(uavobj_flash_buffer))
+		return -1;
+
+	PIOS_Recursive_Mutex_Lock(flash_mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t rc = -1;
+
 	if (UAVObjIsMetaobject(obj_handle)) {
 		if (instId != 0)
-			return -1;
+			goto unlock_exit;
 
 		// Load the object from the filesystem
-		int32_t rc;
 #if defined(PIOS_INCLUDE_FASTHEAP)
 		rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
 					UAVObjGetID(obj_handle),
 					instId,
-					uavobj_load_trampoline,
-					UAVObjGetNumBytes(obj_handle));
+					uavobj_flash_buffer,
+					num_bytes);
+
+		if (rc == 0)
+			memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), uavobj_flash_buffer, num_bytes);
 #else  /* PIOS_INCLUDE_FASTHEAP */
 		rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
 					UAVObjGetID(obj_handle),
 					instId,
 					(uint8_t*)MetaDataPtr((struct UAVOMeta *)obj_handle),
-					UAVObjGetNumBytes(obj_handle));
+					num_bytes);
 #endif  /* PIOS_INCLUDE_FASTHEAP */
-
-		if (rc != 0)
-			return -1;
-
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), uavobj_load_trampoline, UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
-
 	} else {
-
-		InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
-
-		if (instEntry == NULL)
-			return -1;
-
-		// Load the object from the filesystem
-		int32_t rc;
-#if defined(PIOS_INCLUDE_FASTHEAP)
+		// Load the object from the filesystem.  The object lock is only
+		// held for the copy, which seqlock readers see as a single write,
+		// and the instance is looked up again under it.
 		rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
 					UAVObjGetID(obj_handle),
 					instId,
-					uavobj_load_trampoline,
-					UAVObjGetNumBytes(obj_handle));
-#else  /* PIOS_INCLUDE_FASTHEAP */
-		rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					InstanceData(instEntry),
-					UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
-
-		if (rc != 0)
-			return -1;
+					uavobj_flash_buffer,
+					num_bytes);
+
+		if (rc == 0) {
+			PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+			InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
+			if (instEntry != NULL) {
+				seqlockWriteBegin(obj_handle);
+				memcpy(InstanceData(instEntry), uavobj_flash_buffer, num_bytes);
+				seqlockWriteEnd(obj_handle);
+			} else {
+				rc = -1;
+			}
+			PIOS_Recursive_Mutex_Unlock(mutex);
+		}
+	}
 
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(InstanceData(instEntry), uavobj_load_trampoline, UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
+unlock_exit:
+	PIOS_Recursive_Mutex_Unlock(flash_mutex);
 
-	}
+	if (rc != 0)
+		return -1;
 
 	sendEvent((struct UAVOBase*)obj_handle, instId, EV_UNPACKED);
 	return 0;
@@ -861,18 +928,65 @@ int32_t UAVObjDeleteById(uint32_t obj_id, uint16_t inst_id)
 
 /**
  * Save all settings objects to the SD card.
+ * The objects are saved as one batch so that either all of them or none
+ * of them are replaced if the power goes away in the middle of the save.
  * @return 0 if success or -1 if failure
  */
 int32_t UAVObjSaveSettings()
 {
 	struct UAVOData *obj;
 
-	// Get lock
+	// Get lock, the flash lock always comes first
+	PIOS_Recursive_Mutex_Lock(flash_mutex, PIOS_MUTEX_TIMEOUT_MAX);
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
 	int32_t rc = -1;
 
-	// Save all settings objects
+	uint16_t num_settings = 0;
+	LL_FOREACH(uavo_list, obj) {
+		if (UAVObjIsSettings(obj))
+			num_settings++;
+	}
+
+	if (PIOS_FLASHFS_BatchBegin(pios_uavo_settings_fs_id, num_settings) == 0) {
+		LL_FOREACH(uavo_list, obj) {
+			if (!UAVObjIsSettings(obj))
+				continue;
+
+			InstanceHandle instEntry = getInstance(obj, 0);
+			if (instEntry == NULL || InstanceData(instEntry) == NULL)
+				goto abort_exit;
+
+			int32_t save_rc;
+#if defined(PIOS_INCLUDE_FASTHEAP)
+			memcpy(uavobj_flash_buffer,
+				InstanceData(instEntry),
+				UAVObjGetNumBytes(obj));
+
+			save_rc = PIOS_FLASHFS_BatchSave(pios_uavo_settings_fs_id,
+						UAVObjGetID(obj),
+						0,
+						uavobj_flash_buffer,
+						UAVObjGetNumBytes(obj));
+#else /* PIOS_INCLUDE_FASTHEAP */
+			save_rc = PIOS_FLASHFS_BatchSave(pios_uavo_settings_fs_id,
+						UAVObjGetID(obj),
+						0,
+						InstanceData(instEntry),
+						UAVObjGetNumBytes(obj));
+#endif  /* PIOS_INCLUDE_FASTHEAP */
+
+			if (save_rc != 0)
+				goto abort_exit;
+		}
+
+		if (PIOS_FLASHFS_BatchCommit(pios_uavo_settings_fs_id) == 0)
+			rc = 0;
+
+		goto unlock_exit;
+	}
+
+	// Too many settings to batch on this filesystem, save them one at a time
 	LL_FOREACH(uavo_list, obj) {
 		// Check if this is a settings object
 		if (UAVObjIsSettings(obj)) {
@@ -885,9 +999,14 @@ int32_t UAVObjSaveSettings()
 	}
 
 	rc = 0;
+	goto unlock_exit;
+
+abort_exit:
+	PIOS_FLASHFS_BatchAbort(pios_uavo_settings_fs_id);
 
 unlock_exit:
 	PIOS_Recursive_Mutex_Unlock(mutex);
+	PIOS_Recursive_Mutex_Unlock(flash_mutex);
 	return rc;
 }
 
@@ -899,7 +1018,8 @@ int32_t UAVObjLoadSettings()
 {
 	struct UAVOData *obj;
 
-	// Get lock
+	// Get lock, the flash lock always comes first
+	PIOS_Recursive_Mutex_Lock(flash_mutex, PIOS_MUTEX_TIMEOUT_MAX);
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
 	int32_t rc = -1;
@@ -920,6 +1040,7 @@ int32_t UAVObjLoadSettings()
 
 unlock_exit:
 	PIOS_Recursive_Mutex_Unlock(mutex);
+	PIOS_Recursive_Mutex_Unlock(flash_mutex);
 	return rc;
 }
 
@@ -963,7 +1084,8 @@ int32_t UAVObjSaveMetaobjects()
 {
 	struct UAVOData *obj;
 
-	// Get lock
+	// Get lock, the flash lock always comes first
+	PIOS_Recursive_Mutex_Lock(flash_mutex, PIOS_MUTEX_TIMEOUT_MAX);
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
 	int32_t rc = -1;
@@ -981,6 +1103,7 @@ int32_t UAVObjSaveMetaobjects()
 
 unlock_exit:
 	PIOS_Recursive_Mutex_Unlock(mutex);
+	PIOS_Recursive_Mutex_Unlock(flash_mutex);
 	return rc;
 }
 
@@ -992,7 +1115,8 @@ int32_t UAVObjLoadMetaobjects()
 {
 	struct UAVOData *obj;
 
-	// Get lock
+	// Get lock, the flash lock always comes first
+	PIOS_Recursive_Mutex_Lock(flash_mutex, PIOS_MUTEX_TIMEOUT_MAX);
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
 	int32_t rc = -1;
@@ -1010,6 +1134,7 @@ int32_t UAVObjLoadMetaobjects()
 
 unlock_exit:
 	PIOS_Recursive_Mutex_Unlock(mutex);
+	PIOS_Recursive_Mutex_Unlock(flash_mutex);
 	return rc;
 }
 
@@ -1125,7 +1250,9 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 			goto unlock_exit;
 		}
 		// Set data
+		seqlockWriteBegin(obj_handle);
 		memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+		seqlockWriteEnd(obj_handle);
 	}
 
 	// Fire event
@@ -1190,7 +1317,9 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
 		}
 
 		// Set data
+		seqlockWriteBegin(obj_handle);
 		memcpy(InstanceData(instEntry) + offset, dataIn, size);
+		seqlockWriteEnd(obj_handle);
 	}
 
 
@@ -1215,6 +1344,13 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 {
 	PIOS_Assert(obj_handle);
 
+	// Seqlock objects can usually be copied without the lock
+	if (instId == 0 && isSeqlock(obj_handle) &&
+			seqlockRead((struct UAVOData *) obj_handle, dataOut, 0,
+				((struct UAVOData *) obj_handle)->instance_size)) {
+		return 0;
+	}
+
 	// Lock
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
@@ -1261,6 +1397,13 @@ int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, voi
 {
 	PIOS_Assert(obj_handle);
 
+	// Seqlock objects can usually be copied without the lock
+	if (instId == 0 && isSeqlock(obj_handle) &&
+			(size + offset) <= ((struct UAVOData *) obj_handle)->instance_size &&
+			seqlockRead((struct UAVOData *) obj_handle, dataOut, offset, size)) {
+		return 0;
+	}
+
 	// Lock
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
@@ -1484,6 +1627,28 @@ void UAVObjSetGcsTelemetryUpdateMode(UAVObjMetadata* metadata, UAVObjUpdateMode
 	SET_BITS(metadata->flags, UAVOBJ_GCS_TELEMETRY_UPDATE_MODE_SHIFT, val, UAVOBJ_UPDATE_MODE_MASK);
 }
 
+/**
+ * Check whether telemetry updates of an object may be delta encoded.
+ * This is kept with the object rather than in its metadata, so that the
+ * metadata layout stays the same for every client.
+ * \param[in] obj The object handle
+ * \return the telemetry delta boolean
+ */
+bool UAVObjIsTelemetryDelta(UAVObjHandle obj_handle) {
+	PIOS_Assert(obj_handle);
+	return ((struct UAVOBase *) obj_handle)->flags.isTelemDelta;
+}
+
+/**
+ * Set whether telemetry updates of an object may be delta encoded
+ * \param[in] obj The object handle
+ * \param[in] val The telemetry delta boolean
+ */
+void UAVObjSetTelemetryDelta(UAVObjHandle obj_handle, bool val) {
+	PIOS_Assert(obj_handle);
+	((struct UAVOBase *) obj_handle)->flags.isTelemDelta = val;
+}
+
 
 /**
  * Check if an object is read only
@@ -1713,12 +1878,51 @@ static int32_t sendEvent(struct UAVOBase * obj, uint16_t instId,
 	return 0;
 }
 
+/**
+ * Make room for at least num_instances instances in a multi instance object.
+ * The instance array is grown geometrically so that creating instances one
+ * at a time only needs a logarithmic number of allocations.
+ * \return 0 if success or -1 if failure
+ */
+static int32_t reserveInstances(struct UAVOMulti * uavo_multi, uint16_t num_instances)
+{
+	/* Instance 0 lives in the object itself */
+	uint16_t needed = num_instances - 1;
+
+	if (needed <= uavo_multi->max_instances)
+		return 0;
+
+	uint32_t new_max = uavo_multi->max_instances + uavo_multi->max_instances / 2;
+	if (new_max < UAVOBJ_INSTANCE_GROWTH_MIN)
+		new_max = UAVOBJ_INSTANCE_GROWTH_MIN;
+	if (new_max < needed)
+		new_max = needed;
+	if (new_max > UAVOBJ_MAX_INSTANCES - 1)
+		new_max = UAVOBJ_MAX_INSTANCES - 1;
+
+	uint16_t instance_size = uavo_multi->uavo.instance_size;
+	uint8_t * instances = (uint8_t *) PIOS_malloc_no_dma(new_max * instance_size);
+	if (!instances)
+		return -1;
+
+	if (uavo_multi->instances) {
+		memcpy(instances, uavo_multi->instances,
+			(uavo_multi->num_instances - 1) * instance_size);
+		PIOS_free(uavo_multi->instances);
+	}
+
+	uavo_multi->instances     = instances;
+	uavo_multi->max_instances = new_max;
+
+	return 0;
+}
+
 /**
  * Create a new object instance, return the instance info or NULL if failure.
  */
 static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId)
 {
-	struct UAVOMultiInst *instEntry;
+	struct UAVOMulti *uavo_multi = (struct UAVOMulti *) obj;
 
 	/* Don't allow more than one instance for single instance objects */
 	if (UAVObjIsSingleInstance(&(obj->base))) {
@@ -1736,30 +1940,26 @@ static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId)
 		return NULL;
 	}
 
-	// Create any missing instances (all instance IDs must be sequential)
-	for (uint16_t n = UAVObjGetNumInstances(&(obj->base)); n < instId; ++n) {
-		if (createInstance(obj, n) == NULL) {
-			return NULL;
-		}
+	/* All instance IDs must be sequential, so make room for any missing ones too */
+	if (reserveInstances(uavo_multi, instId + 1) != 0) {
+		return NULL;
 	}
 
-	/* Create the actual instance */
-	instEntry = (struct UAVOMultiInst *) PIOS_malloc_no_dma(sizeof(struct UAVOMultiInst)+obj->instance_size);
-	if (!instEntry)
-		return NULL;
-	memset(InstanceDataOffset(instEntry), 0, obj->instance_size);
-	LL_APPEND(( (struct UAVOMulti*)obj )->instance0.next, instEntry);
+	/* Create the actual instance and any missing instances before it */
+	for (uint16_t n = uavo_multi->num_instances; n <= instId; ++n) {
+		memset(uavo_multi->instances + (n - 1) * obj->instance_size, 0, obj->instance_size);
+		uavo_multi->num_instances++;
 
-	( (struct UAVOMulti*)obj )->num_instances++;
+		// Fire event
+		UAVObjInstanceUpdated((UAVObjHandle) obj, n);
 
-	// Fire event
-	UAVObjInstanceUpdated((UAVObjHandle) obj, instId);
+		if (newUavObjInstanceCB) {
+			newUavObjInstanceCB(obj->id, UAVObjGetNumInstances(obj));
+		}
+	}
 
 	// Done
-	if (newUavObjInstanceCB) {
-		newUavObjInstanceCB(obj->id, UAVObjGetNumInstances(obj));
-	}
-	return InstanceDataOffset(instEntry);
+	return getInstance(obj, instId);
 }
 
 /**
@@ -1793,18 +1993,163 @@ static InstanceHandle getInstance(struct UAVOData * obj, uint16_t instId)
 		if (instId >= uavo_multi->num_instances)
 			return NULL;
 
-		// Look for specified instance ID
-		uint16_t instance = 0;
-		struct UAVOMultiInst *instEntry;
-		LL_FOREACH(&(uavo_multi->instance0), instEntry) {
-			if (instance++ == instId) {
-				/* Found it */
-				return &(instEntry->instance);
-			}
+		if (instId == 0)
+			return (&(uavo_multi->instance0));
+
+		/* Instances are stored back to back, index straight into the array */
+		return (uavo_multi->instances + (instId - 1) * obj->instance_size);
+	}
+}
+
+/**
+ * Is this a data object whose readers may skip the mutex?
+ */
+static inline bool isSeqlock(UAVObjHandle obj_handle)
+{
+	return ((struct UAVOBase *) obj_handle)->flags.isSeqlock;
+}
+
+/**
+ * Mark the start of a write to a seqlock object, must hold the mutex.
+ * Does nothing for other objects.
+ */
+static inline void seqlockWriteBegin(UAVObjHandle obj_handle)
+{
+	if (isSeqlock(obj_handle)) {
+		(*SeqlockCounter((struct UAVOData *) obj_handle))++;
+		__sync_synchronize();
+	}
+}
+
+/**
+ * Mark the end of a write to a seqlock object, must hold the mutex.
+ */
+static inline void seqlockWriteEnd(UAVObjHandle obj_handle)
+{
+	if (isSeqlock(obj_handle)) {
+		__sync_synchronize();
+		(*SeqlockCounter((struct UAVOData *) obj_handle))++;
+	}
+}
+
+/**
+ * Copy data out of a seqlock object without taking the mutex.
+ *
+ * The copy is retried a few times if a writer changed the data while it
+ * was being made.  If a write is in progress we give up straight away: on
+ * a single core the writer can not finish until we yield, so the caller
+ * has to take the mutex instead, which all writers hold.
+ *
+ * \return true if dataOut holds a consistent copy
+ */
+static bool seqlockRead(struct UAVOData * obj, void * dataOut, uint32_t offset, uint32_t size)
+{
+	volatile uint32_t * seq_p = SeqlockCounter(obj);
+
+	for (uint8_t attempt = 0; attempt < UAVOBJ_SEQLOCK_RETRIES; attempt++) {
+		uint32_t seq = *seq_p;
+		if (seq & 1)
+			return false;
+		__sync_synchronize();
+
+		memcpy(dataOut, (uint8_t *) ObjSingleInstanceDataOffset(obj) + offset, size);
+
+		__sync_synchronize();
+		if (*seq_p == seq) {
+			++stats.seqlockReads;
+			return true;
 		}
-		/* Instance was not found */
+	}
+
+	++stats.seqlockFallbacks;
+	return false;
+}
+
+/**
+ * Add a newly registered object to the sorted lookup index.
+ * Must be called with the mutex held.
+ */
+static void indexInsert(struct UAVOData * obj)
+{
+	if (uavo_index_overflow)
+		return;
+
+	if (uavo_index_len >= UAVOBJ_INDEX_SIZE) {
+		/* From now on a miss in the index must be confirmed on the list */
+		uavo_index_overflow = true;
+		return;
+	}
+
+	uint16_t len = uavo_index_len;
+	uint16_t pos = len;
+
+	/* Enter the write side; readers racing us will fall back to the list */
+	uavo_index_seq++;
+	__sync_synchronize();
+
+	/*
+	 * Shift larger IDs up by one.  Every slot below the published length
+	 * always holds a valid object pointer so a racing reader never
+	 * dereferences garbage, it may only see an inconsistent order.
+	 */
+	while (pos > 0 && uavo_index[pos - 1]->id > obj->id) {
+		uavo_index[pos] = uavo_index[pos - 1];
+		pos--;
+	}
+	uavo_index[pos] = obj;
+	uavo_index_len = len + 1;
+
+	__sync_synchronize();
+	uavo_index_seq++;
+}
+
+/**
+ * Find an object or meta object in the lookup index without locking.
+ *
+ * A lookup that races a registration is not retried here: on a single core
+ * the reader may have preempted the writer, so spinning would never finish.
+ * It is instead reported as not definitive and the caller takes the mutex.
+ *
+ * \param[in] id The object ID
+ * \param[out] definitive Set true when a miss means the object does not exist
+ * \return The object handle or NULL if not found in the index
+ */
+static UAVObjHandle indexLookup(uint32_t id, bool * definitive)
+{
+	UAVObjHandle found_obj = NULL;
+	uint32_t seq = uavo_index_seq;
+
+	*definitive = false;
+	if (seq & 1)
 		return NULL;
+	__sync_synchronize();
+
+	/* Find the number of entries with an ID <= id */
+	uint16_t lo = 0;
+	uint16_t hi = uavo_index_len;
+	while (lo < hi) {
+		uint16_t mid = (lo + hi) / 2;
+		if (uavo_index[mid]->id <= id)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+
+	/* The closest entry is either this object or the owner of this meta object */
+	if (lo > 0) {
+		struct UAVOData * obj = uavo_index[lo - 1];
+		if (obj->id == id)
+			found_obj = (UAVObjHandle) obj;
+		else if (MetaObjectId(obj->id) == id)
+			found_obj = (UAVObjHandle) &(obj->metaObj);
+	}
+
+	__sync_synchronize();
+	if (seq != uavo_index_seq)
+		return NULL;
+
+	*definitive = !uavo_index_overflow;
+	return found_obj;
 }
 
 /**
@@ -54,11 +54,13 @@ int32_t $(NAME)Initialize(void)
 	
 	// Register object with the object manager
 	handle = UAVObjRegister($(NAMEUC)_OBJID,
-			$(NAMEUC)_ISSINGLEINST, $(NAMEUC)_ISSETTINGS, $(NAMEUC)_NUMBYTES, &$(NAME)SetDefaults);
+			$(NAMEUC)_ISSINGLEINST, $(NAMEUC)_ISSETTINGS, $(NAMEUC)_ISSEQLOCK,
+			$(NAMEUC)_NUMBYTES, &$(NAME)SetDefaults);
 
 	// Done
 	if (handle != 0)
 	{
+		UAVObjSetTelemetryDelta(handle, $(NAMEUC)_ISTELEMETRYDELTA);
 		return 0;
 	}
 	else
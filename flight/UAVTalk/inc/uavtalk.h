@@ -48,6 +48,11 @@ typedef struct {
 
 typedef void* UAVTalkConnection;
 
+//! Returned by a UAVTalkBatchFilter to select what happens to an entry of a batched frame
+#define UAVTALK_BATCH_RECEIVE  0x01
+#define UAVTALK_BATCH_RELAY    0x02
+typedef uint8_t (*UAVTalkBatchFilter)(uint32_t objId, uint16_t instId);
+
 typedef enum {UAVTALK_STATE_ERROR=0, UAVTALK_STATE_SYNC, UAVTALK_STATE_TYPE, UAVTALK_STATE_SIZE, UAVTALK_STATE_OBJID, UAVTALK_STATE_INSTID, UAVTALK_STATE_TIMESTAMP, UAVTALK_STATE_DATA, UAVTALK_STATE_CS, UAVTALK_STATE_COMPLETE} UAVTalkRxState;
 
 // Public functions
@@ -60,10 +65,21 @@ int32_t UAVTalkSendObjectRequest(UAVTalkConnection connection, UAVObjHandle obj,
 int32_t UAVTalkSendAck(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId);
 int32_t UAVTalkSendNack(UAVTalkConnection connectionHandle, uint32_t objId);
 int32_t UAVTalkSendBuf(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_t len);
+int32_t UAVTalkSendObjectBatched(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId);
+int32_t UAVTalkFlushBatch(UAVTalkConnection connectionHandle);
+int32_t UAVTalkSendBatchCapability(UAVTalkConnection connectionHandle);
+void UAVTalkSetBatching(UAVTalkConnection connectionHandle, bool enabled);
+bool UAVTalkGetBatching(UAVTalkConnection connectionHandle);
+int32_t UAVTalkSendObjectDelta(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId);
+int32_t UAVTalkSendDeltaCapability(UAVTalkConnection connectionHandle);
+void UAVTalkSetDelta(UAVTalkConnection connectionHandle, bool enabled);
+bool UAVTalkGetDelta(UAVTalkConnection connectionHandle);
 UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connection, uint8_t rxbyte);
 UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connection, uint8_t rxbyte);
+int32_t UAVTalkProcessInputBuffer(UAVTalkConnection connection, const uint8_t *data, int32_t length);
 UAVTalkRxState UAVTalkRelayInputStream(UAVTalkConnection connectionHandle, uint8_t rxbyte);
 int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle);
+int32_t UAVTalkRelayBatch(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, UAVTalkBatchFilter filter);
 int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle);
 void UAVTalkGetStats(UAVTalkConnection connection, UAVTalkStats *stats);
 void UAVTalkResetStats(UAVTalkConnection connection);
@@ -63,6 +63,53 @@ typedef uint8_t uavtalk_checksum;
 #define UAVTALK_MIN_PACKET_LENGTH       UAVTALK_MAX_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH
 #define UAVTALK_MAX_PACKET_LENGTH       UAVTALK_MIN_PACKET_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH
 
+/*
+ * Batched frames use a minimal header with a reserved object ID followed by
+ * a list of entries, each with its own object ID, instance ID and length.
+ * A single checksum covers the whole frame.  The payload is bounded so that
+ * a frame fits in one radio packet and in the receive buffer of old peers.
+ */
+#define UAVTALK_MULTI_OBJID             0x00000000
+#define UAVTALK_MULTI_ENTRY_HEADER_LENGTH 7   // object ID(4), instance ID(2), length(1)
+#if UAVTALK_MAX_PAYLOAD_LENGTH < 240
+#define UAVTALK_MULTI_MAX_PAYLOAD_LENGTH UAVTALK_MAX_PAYLOAD_LENGTH
+#else
+#define UAVTALK_MULTI_MAX_PAYLOAD_LENGTH 240
+#endif
+#define UAVTALK_MULTI_MAX_PACKET_LENGTH (UAVTALK_MIN_HEADER_LENGTH + UAVTALK_MULTI_MAX_PAYLOAD_LENGTH + UAVTALK_CHECKSUM_LENGTH)
+#define UAVTALK_MULTI_DELTA_INSTID      0x8000 // instance ID flag of an entry holding a delta payload
+
+/*
+ * Delta payloads encode an object relative to the last keyframe sent for it.
+ * The first byte holds the keyframe flag and a 7 bit keyframe sequence.  A
+ * keyframe is followed by the packed object, a delta by a bitmap of the bytes
+ * that differ from the keyframe and then those bytes in order.  A delta whose
+ * sequence does not match the keyframe held by the receiver is dropped, so a
+ * lost keyframe costs at most one keyframe interval of updates.  An empty
+ * delta frame with the reserved object ID announces delta support.
+ */
+#define UAVTALK_DELTA_OBJID             0x00000000
+#define UAVTALK_DELTA_KEYFRAME          0x80
+#define UAVTALK_DELTA_SEQ_MASK          0x7F
+#define UAVTALK_DELTA_KEYFRAME_INTERVAL 16
+#define UAVTALK_DELTA_SLOTS             8
+
+//! Keyframe kept for one object instance on one end of a delta encoded link
+typedef struct {
+    uint32_t objId;           // 0 while the slot is free
+    uint16_t instId;
+    uint8_t seq;              // sequence of the keyframe held in image
+    uint8_t count;            // deltas sent since the keyframe (sender only)
+    bool keyed;               // image holds a valid keyframe
+    uint8_t *image;           // packed object as of the keyframe
+} UAVTalkDeltaSlot;
+
+//! Keyframes for one direction of a link, allocated on first use
+typedef struct {
+    UAVTalkDeltaSlot slots[UAVTALK_DELTA_SLOTS];
+    uint8_t scratch[UAVTALK_MAX_PAYLOAD_LENGTH];
+} UAVTalkDeltaTable;
+
 //! State information for the UAVTalk parser
 typedef struct {
     UAVObjHandle obj;
@@ -94,6 +141,13 @@ typedef struct {
     uint8_t *rxBuffer;
     uint32_t txSize;
     uint8_t *txBuffer;
+    bool batchEnabled;        // peer announced it decodes UAVTALK_TYPE_OBJ_MULTI
+    uint8_t *batchBuffer;     // pending batched frame, allocated on first use
+    uint16_t batchLength;     // bytes used in batchBuffer, 0 when nothing is pending
+    uint16_t batchObjects;    // number of entries in batchBuffer
+    bool deltaEnabled;        // peer announced it decodes UAVTALK_TYPE_OBJ_DELTA
+    UAVTalkDeltaTable *txDelta; // keyframes sent to the peer
+    UAVTalkDeltaTable *rxDelta; // keyframes received from the peer
 } UAVTalkConnectionData;
 
 #define UAVTALK_CANARI         0xCA
@@ -108,6 +162,8 @@ typedef struct {
 #define UAVTALK_TYPE_OBJ_ACK   (UAVTALK_TYPE_VER | 0x02)
 #define UAVTALK_TYPE_ACK       (UAVTALK_TYPE_VER | 0x03)
 #define UAVTALK_TYPE_NACK      (UAVTALK_TYPE_VER | 0x04)
+#define UAVTALK_TYPE_OBJ_MULTI (UAVTALK_TYPE_VER | 0x05)
+#define UAVTALK_TYPE_OBJ_DELTA (UAVTALK_TYPE_VER | 0x06)
 #define UAVTALK_TYPE_OBJ_TS       (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ)
 #define UAVTALK_TYPE_OBJ_ACK_TS   (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_ACK)
 
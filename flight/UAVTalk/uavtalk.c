@@ -43,7 +43,18 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle
 static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
 static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
 static int32_t sendNack(UAVTalkConnectionData *connection, uint32_t objId);
+static UAVTalkRxState processInputByte(UAVTalkConnectionData *connection, uint8_t rxbyte);
 static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t* data, int32_t length);
+static int32_t receiveMultiObject(UAVTalkConnectionData *connection, uint8_t* data, int32_t length);
+static int32_t receiveMultiEntry(UAVTalkConnectionData *connection, uint8_t* entry);
+static int32_t batchObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, bool delta);
+static int32_t batchSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, bool delta);
+static int32_t flushBatch(UAVTalkConnectionData *connection);
+static int32_t sendCapability(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId);
+static UAVTalkDeltaSlot *findDeltaSlot(UAVTalkDeltaTable **table, uint32_t objId, uint16_t instId, int32_t length);
+static void invalidateDelta(UAVTalkDeltaTable *table);
+static int32_t encodeDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t *out);
+static int32_t receiveDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t *data, int32_t length);
 static void updateAck(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
 
 /**
@@ -71,6 +82,15 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
 	if (!connection->rxBuffer) return 0;
 	connection->txBuffer = PIOS_malloc(UAVTALK_MAX_PACKET_LENGTH);
 	if (!connection->txBuffer) return 0;
+	// batching stays off until the peer announces it can decode batched frames
+	connection->batchEnabled = false;
+	connection->batchBuffer = NULL;
+	connection->batchLength = 0;
+	connection->batchObjects = 0;
+	// likewise for delta frames, the keyframe tables are allocated on first use
+	connection->deltaEnabled = false;
+	connection->txDelta = NULL;
+	connection->rxDelta = NULL;
 	connection->respSema = PIOS_Semaphore_Create();
 	PIOS_Semaphore_Take(connection->respSema, 0); // reset to zero
 	UAVTalkResetStats( (UAVTalkConnection) connection );
@@ -257,6 +277,7 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle
 		PIOS_Recursive_Mutex_Lock(connection->transLock, PIOS_MUTEX_TIMEOUT_MAX);
 		// Send object
 		PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+		flushBatch(connection);
 		connection->respObj = obj;
 		connection->respInstId = instId;
 		sendObject(connection, obj, instId, type);
@@ -283,6 +304,8 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle
 	else if (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_TS)
 	{
 		PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+		// Keep updates in order with anything still waiting in a batch
+		flushBatch(connection);
 		sendObject(connection, obj, instId, type);
 		PIOS_Recursive_Mutex_Unlock(connection->lock);
 		return 0;
@@ -304,6 +327,86 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 	UAVTalkConnectionData *connection;
     CHECKCONHANDLE(connectionHandle,connection,return -1);
 
+	return processInputByte(connection, rxbyte);
+}
+
+/**
+ * Process a block of bytes from the telemetry stream.
+ * Bytes outside of a packet are skipped in one scan for the sync byte and
+ * packet payloads are copied and checksummed in one go, the header and
+ * checksum bytes go through the byte state machine. A packet may be split
+ * over any number of calls. Every complete packet is handled as in
+ * UAVTalkProcessInputStream.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] data Received bytes
+ * \param[in] length Number of received bytes
+ * \return Number of packets received
+ * \return -1 on failure
+ */
+int32_t UAVTalkProcessInputBuffer(UAVTalkConnection connectionHandle, const uint8_t *data, int32_t length)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	UAVTalkInputProcessor *iproc = &connection->iproc;
+	const uint8_t *end = data + length;
+	int32_t packets = 0;
+
+	while (data < end)
+	{
+		if (iproc->state == UAVTALK_STATE_SYNC || iproc->state == UAVTALK_STATE_ERROR || iproc->state == UAVTALK_STATE_COMPLETE)
+		{
+			// Skip everything up to the next sync byte
+			const uint8_t *sync = memchr(data, UAVTALK_SYNC_VAL, end - data);
+			if (sync == NULL)
+				sync = end;
+			connection->stats.rxBytes += sync - data;
+			iproc->state = UAVTALK_STATE_SYNC;
+			data = sync;
+			if (data == end)
+				break;
+		}
+		else if (iproc->state == UAVTALK_STATE_DATA)
+		{
+			// Copy as much of the payload as is available
+			int32_t count = iproc->length - iproc->rxCount;
+			if (count > end - data)
+				count = end - data;
+			memcpy(&connection->rxBuffer[iproc->rxCount], data, count);
+			iproc->rxCount += count;
+			connection->stats.rxBytes += count;
+			iproc->rxPacketLength += count;
+			data += count;
+
+			if (iproc->rxCount < iproc->length)
+				break;
+
+			iproc->cs = PIOS_CRC_updateCRC(iproc->cs, connection->rxBuffer, iproc->length);
+			iproc->state = UAVTALK_STATE_CS;
+			iproc->rxCount = 0;
+			continue;
+		}
+
+		if (processInputByte(connection, *data++) == UAVTALK_STATE_COMPLETE)
+		{
+			PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+			receiveObject(connection, iproc->type, iproc->objId, iproc->instId, connection->rxBuffer, iproc->length);
+			PIOS_Recursive_Mutex_Unlock(connection->lock);
+			packets++;
+		}
+	}
+
+	return packets;
+}
+
+/**
+ * Run one byte through the receive state machine.
+ * \param[in] connection UAVTalkConnectionData to be used
+ * \param[in] rxbyte Received byte
+ * \return UAVTalkRxState
+ */
+static UAVTalkRxState processInputByte(UAVTalkConnectionData *connection, uint8_t rxbyte)
+{
 	UAVTalkInputProcessor *iproc = &connection->iproc;
 	++connection->stats.rxBytes;
 
@@ -391,6 +494,21 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 				iproc->length = 0;
 				iproc->instanceLength = 0;
 			}
+			else if (iproc->type == UAVTALK_TYPE_OBJ_MULTI)
+			{
+				// Batched frame, the entries are unpacked once the checksum is verified
+				iproc->obj = 0;
+				iproc->length = iproc->packet_size - iproc->rxPacketLength;
+				iproc->instanceLength = 0;
+				iproc->timestampLength = 0;
+			}
+			else if (iproc->type == UAVTALK_TYPE_OBJ_DELTA)
+			{
+				// Delta frames are variable length and never timestamped
+				iproc->instanceLength = (iproc->obj && !UAVObjIsSingleInstance(iproc->obj)) ? 2 : 0;
+				iproc->timestampLength = 0;
+				iproc->length = iproc->packet_size - iproc->rxPacketLength - iproc->instanceLength;
+			}
 			else
 			{
 				if (iproc->obj)
@@ -498,13 +616,13 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 
 		case UAVTALK_STATE_DATA:
 			
-			// update the CRC
-			iproc->cs = PIOS_CRC_updateByte(iproc->cs, rxbyte);
-			
 			connection->rxBuffer[iproc->rxCount++] = rxbyte;
 			if (iproc->rxCount < iproc->length)
 				break;
 			
+			// update the CRC over the whole payload at once
+			iproc->cs = PIOS_CRC_updateCRC(iproc->cs, connection->rxBuffer, iproc->length);
+			
 			iproc->state = UAVTALK_STATE_CS;
 			iproc->rxCount = 0;
 			break;
@@ -661,6 +779,105 @@ int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnecti
     return ret;
 }
 
+/**
+ * Relay a parsed batched frame received on one connection handle out on a different connection
+ * handle.  The filter decides for every entry whether it is unpacked locally, relayed, both or
+ * neither.  The relayed entries are sent as a new batched frame, nothing is sent if no entry
+ * is left.  Empty frames announcing batching support are always relayed.
+ * \param[in] inConnectionHandle UAVTalkConnection the frame was received on
+ * \param[in] outConnectionHandle UAVTalkConnection to relay the frame to
+ * \param[in] filter Selects what happens to each entry
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkRelayBatch(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, UAVTalkBatchFilter filter)
+{
+    UAVTalkConnectionData *inConnection;
+
+    CHECKCONHANDLE(inConnectionHandle, inConnection, return -1);
+    UAVTalkInputProcessor *inIproc = &inConnection->iproc;
+
+    // Delta capability announcements share the reserved object ID, pass them on as they are
+    if (inIproc->state == UAVTALK_STATE_COMPLETE && inIproc->type == UAVTALK_TYPE_OBJ_DELTA) {
+        return UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+    }
+
+    // The input packet must be a completely parsed batched frame.
+    if (inIproc->state != UAVTALK_STATE_COMPLETE || inIproc->type != UAVTALK_TYPE_OBJ_MULTI) {
+        inConnection->stats.rxErrors++;
+
+        return -1;
+    }
+
+    UAVTalkConnectionData *outConnection;
+    CHECKCONHANDLE(outConnectionHandle, outConnection, return -1);
+
+    if (!outConnection->outStream) {
+        outConnection->stats.txErrors++;
+
+        return -1;
+    }
+
+    // Lock
+    PIOS_Recursive_Mutex_Lock(outConnection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+    uint8_t *data = inConnection->rxBuffer;
+    int32_t length = inIproc->length;
+    uint16_t outLength = UAVTALK_MIN_HEADER_LENGTH;
+
+    while (length >= UAVTALK_MULTI_ENTRY_HEADER_LENGTH) {
+        int32_t entryLength = UAVTALK_MULTI_ENTRY_HEADER_LENGTH + data[6];
+        if (entryLength > length)
+            break;
+
+        uint32_t objId = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+        uint16_t instId = data[4] | (data[5] << 8);
+        uint8_t action = filter(objId, instId & ~UAVTALK_MULTI_DELTA_INSTID);
+
+        if (action & UAVTALK_BATCH_RECEIVE) {
+            receiveMultiEntry(inConnection, data);
+        }
+
+        if (action & UAVTALK_BATCH_RELAY) {
+            memcpy(&outConnection->txBuffer[outLength], data, entryLength);
+            outLength += entryLength;
+        }
+
+        data += entryLength;
+        length -= entryLength;
+    }
+
+    int32_t ret = 0;
+    if (outLength > UAVTALK_MIN_HEADER_LENGTH || inIproc->length == 0) {
+        outConnection->txBuffer[0] = UAVTALK_SYNC_VAL;
+        outConnection->txBuffer[1] = UAVTALK_TYPE_OBJ_MULTI;
+        outConnection->txBuffer[2] = (uint8_t)(outLength & 0xFF);
+        outConnection->txBuffer[3] = (uint8_t)((outLength >> 8) & 0xFF);
+        outConnection->txBuffer[4] = (uint8_t)(UAVTALK_MULTI_OBJID & 0xFF);
+        outConnection->txBuffer[5] = (uint8_t)((UAVTALK_MULTI_OBJID >> 8) & 0xFF);
+        outConnection->txBuffer[6] = (uint8_t)((UAVTALK_MULTI_OBJID >> 16) & 0xFF);
+        outConnection->txBuffer[7] = (uint8_t)((UAVTALK_MULTI_OBJID >> 24) & 0xFF);
+        outConnection->txBuffer[outLength] = PIOS_CRC_updateCRC(0, outConnection->txBuffer, outLength);
+
+        // Send the buffer.
+        int32_t rc = (*outConnection->outStream)(outConnection->txBuffer, outLength + UAVTALK_CHECKSUM_LENGTH);
+
+        // Update stats
+        outConnection->stats.txBytes += (rc > 0) ? rc : 0;
+
+        if (rc != (int32_t)(outLength + UAVTALK_CHECKSUM_LENGTH)) {
+            outConnection->stats.txErrors++;
+            ret = -1;
+        }
+    }
+
+    // Release lock
+    PIOS_Recursive_Mutex_Unlock(outConnection->lock);
+
+    // Done
+    return ret;
+}
+
 /**
  * Complete receiving a UAVTalk packet.  This will cause the packet to be unpacked, acked, etc.
  * \param[in] connectionHandle UAVTalkConnection to be used
@@ -799,6 +1016,237 @@ int32_t UAVTalkSendAck(UAVTalkConnection connectionHandle, UAVObjHandle obj, uin
 	return ret;
 }
 
+/**
+ * Send an empty frame announcing support for a frame type.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] type Frame type the peer may use from now on
+ * \param[in] objId Reserved object ID for that frame type
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t sendCapability(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId)
+{
+	if (!connection->outStream) return -1;
+
+	connection->txBuffer[0] = UAVTALK_SYNC_VAL;
+	connection->txBuffer[1] = type;
+	connection->txBuffer[2] = UAVTALK_MIN_HEADER_LENGTH;
+	connection->txBuffer[3] = 0;
+	connection->txBuffer[4] = (uint8_t)(objId & 0xFF);
+	connection->txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
+	connection->txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
+	connection->txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
+	connection->txBuffer[8] = PIOS_CRC_updateCRC(0, connection->txBuffer, UAVTALK_MIN_HEADER_LENGTH);
+
+	uint16_t tx_msg_len = UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH;
+	int32_t rc = (*connection->outStream)(connection->txBuffer, tx_msg_len);
+
+	if (rc != tx_msg_len)
+		return -1;
+
+	connection->stats.txBytes += tx_msg_len;
+
+	return 0;
+}
+
+/**
+ * Find the keyframe slot of an object instance, claiming a free one if the
+ * instance has none yet.  The table is allocated on first use.
+ * \param[in] table Keyframe table of one direction of the link
+ * \param[in] objId Object ID
+ * \param[in] instId Instance ID
+ * \param[in] length Packed object length
+ * \return The slot or NULL if the table is full or out of memory
+ */
+static UAVTalkDeltaSlot *findDeltaSlot(UAVTalkDeltaTable **table, uint32_t objId, uint16_t instId, int32_t length)
+{
+	if (*table == NULL)
+	{
+		*table = PIOS_malloc(sizeof(UAVTalkDeltaTable));
+		if (*table == NULL)
+			return NULL;
+		memset(*table, 0, sizeof(UAVTalkDeltaTable));
+	}
+
+	UAVTalkDeltaSlot *free_slot = NULL;
+
+	for (uint32_t i = 0; i < UAVTALK_DELTA_SLOTS; i++)
+	{
+		UAVTalkDeltaSlot *slot = &(*table)->slots[i];
+
+		if (slot->objId == objId && slot->instId == instId)
+			return slot;
+
+		if (slot->objId == 0 && free_slot == NULL)
+			free_slot = slot;
+	}
+
+	if (free_slot == NULL)
+		return NULL;
+
+	// Slots are never released, objects have a fixed length
+	free_slot->image = PIOS_malloc(length);
+	if (free_slot->image == NULL)
+		return NULL;
+
+	free_slot->objId = objId;
+	free_slot->instId = instId;
+	free_slot->seq = 0;
+	free_slot->count = 0;
+	free_slot->keyed = false;
+
+	return free_slot;
+}
+
+/**
+ * Forget all keyframes of a table so that the next update of every object
+ * is sent or expected as a keyframe.
+ * \param[in] table Keyframe table, may be NULL
+ */
+static void invalidateDelta(UAVTalkDeltaTable *table)
+{
+	if (table == NULL)
+		return;
+
+	for (uint32_t i = 0; i < UAVTALK_DELTA_SLOTS; i++)
+		table->slots[i].keyed = false;
+}
+
+/**
+ * Encode an object as a delta against its last keyframe.  A new keyframe is
+ * sent instead when there is none yet, every UAVTALK_DELTA_KEYFRAME_INTERVAL
+ * updates, and whenever the delta would not be smaller than the object.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle to send
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[out] out Payload buffer, at least one byte larger than the object
+ * \return The payload length
+ * \return -1 if the object can not be delta encoded, send it plain instead
+ */
+static int32_t encodeDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t *out)
+{
+	int32_t length = UAVObjGetNumBytes(obj);
+
+	if (length + 1 >= UAVTALK_MAX_PAYLOAD_LENGTH)
+		return -1;
+
+	UAVTalkDeltaSlot *slot = findDeltaSlot(&connection->txDelta, UAVObjGetID(obj), instId, length);
+	if (slot == NULL)
+		return -1;
+
+	uint8_t *current = connection->txDelta->scratch;
+	if (UAVObjPack(obj, instId, current) < 0)
+		return -1;
+
+	if (slot->keyed && slot->count < UAVTALK_DELTA_KEYFRAME_INTERVAL)
+	{
+		int32_t mapLength = (length + 7) / 8;
+		uint8_t *map = &out[1];
+		int32_t changed = 1 + mapLength;
+
+		memset(map, 0, mapLength);
+
+		int32_t i;
+		for (i = 0; i < length && changed <= length; i++)
+		{
+			if (current[i] != slot->image[i])
+			{
+				map[i / 8] |= 1 << (i % 8);
+				out[changed++] = current[i];
+			}
+		}
+
+		// Only worth it when smaller than a keyframe
+		if (i == length && changed <= length)
+		{
+			out[0] = slot->seq;
+			slot->count++;
+			return changed;
+		}
+	}
+
+	slot->seq = (slot->seq + 1) & UAVTALK_DELTA_SEQ_MASK;
+	slot->count = 0;
+	slot->keyed = true;
+	memcpy(slot->image, current, length);
+
+	out[0] = UAVTALK_DELTA_KEYFRAME | slot->seq;
+	memcpy(&out[1], current, length);
+
+	return length + 1;
+}
+
+/**
+ * Unpack a delta payload.  Keyframes are stored for the deltas that follow,
+ * deltas against any other keyframe than the one held are dropped.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] data Delta payload
+ * \param[in] length Payload length
+ * \return 0 Success
+ * \return -1 Failure if the payload is malformed or its keyframe is missing
+ */
+static int32_t receiveDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t *data, int32_t length)
+{
+	int32_t objLength = UAVObjGetNumBytes(obj);
+
+	if (length < 1)
+		return -1;
+
+	UAVTalkDeltaSlot *slot = findDeltaSlot(&connection->rxDelta, UAVObjGetID(obj), instId, objLength);
+
+	if (data[0] & UAVTALK_DELTA_KEYFRAME)
+	{
+		if (length != objLength + 1)
+			return -1;
+
+		// Still unpack keyframes when no slot is left, only the deltas are lost
+		if (slot)
+		{
+			memcpy(slot->image, &data[1], objLength);
+			slot->seq = data[0] & UAVTALK_DELTA_SEQ_MASK;
+			slot->keyed = true;
+		}
+
+		UAVObjUnpack(obj, instId, &data[1]);
+	}
+	else
+	{
+		if (slot == NULL || !slot->keyed || slot->seq != data[0])
+			return -1;
+
+		int32_t mapLength = (objLength + 7) / 8;
+		uint8_t *map = &data[1];
+		int32_t changed = 1 + mapLength;
+
+		if (length < changed)
+			return -1;
+
+		uint8_t *current = connection->rxDelta->scratch;
+		memcpy(current, slot->image, objLength);
+
+		for (int32_t i = 0; i < objLength; i++)
+		{
+			if (map[i / 8] & (1 << (i % 8)))
+			{
+				if (changed >= length)
+					return -1;
+				current[i] = data[changed++];
+			}
+		}
+
+		if (changed != length)
+			return -1;
+
+		UAVObjUnpack(obj, instId, current);
+	}
+
+	updateAck(connection, obj, instId);
+
+	return 0;
+}
+
 /**
  * Send a NACK through the telemetry link.
  * \param[in] connectionHandle UAVTalkConnection to be used
@@ -854,6 +1302,199 @@ int32_t UAVTalkSendBuf(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_
 	return 0;
 }
 
+/**
+ * Queue an object update in a batched frame.  The frame is sent once it is
+ * full or when UAVTalkFlushBatch() is called.  If the peer has not announced
+ * support for batched frames the object is sent immediately in its own packet.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectBatched(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t ret = batchObject(connection, obj, instId, false);
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
+/**
+ * Send an object update encoded as a delta against the last keyframe sent for
+ * it, batched like UAVTalkSendObjectBatched() when the peer supports it.
+ * Falls back to UAVTalkSendObjectBatched() until the peer announces delta
+ * support or when no keyframe slot is left for the object.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectDelta(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t ret = batchObject(connection, obj, instId, connection->deltaEnabled);
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
+/**
+ * Send the pending batched frame, if any.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkFlushBatch(UAVTalkConnection connectionHandle)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t ret = flushBatch(connection);
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
+/**
+ * Tell the peer that batched frames can be decoded on this end by sending
+ * an empty batched frame.  Peers that predate batching ignore it.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendBatchCapability(UAVTalkConnection connectionHandle)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t ret = sendCapability(connection, UAVTALK_TYPE_OBJ_MULTI, UAVTALK_MULTI_OBJID);
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
+/**
+ * Tell the peer that delta frames can be decoded on this end by sending
+ * an empty delta frame.  Peers that predate delta frames ignore it.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendDeltaCapability(UAVTalkConnection connectionHandle)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t ret = sendCapability(connection, UAVTALK_TYPE_OBJ_DELTA, UAVTALK_DELTA_OBJID);
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
+/**
+ * Enable or disable batched transmission.  Batching is enabled automatically
+ * when a batched frame is received, the owner of the link should disable it
+ * again when the peer goes away since the next one might not support it.
+ * Anything still pending is sent first.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] enabled True to batch updates sent with UAVTalkSendObjectBatched()
+ */
+void UAVTalkSetBatching(UAVTalkConnection connectionHandle, bool enabled)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	flushBatch(connection);
+	connection->batchEnabled = enabled;
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+}
+
+/**
+ * Check whether updates are currently sent in batched frames
+ * \param[in] connection UAVTalkConnection to be used
+ * \return true if the peer accepts batched frames
+ */
+bool UAVTalkGetBatching(UAVTalkConnection connectionHandle)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return false);
+
+	return connection->batchEnabled;
+}
+
+/**
+ * Enable or disable delta encoding of updates sent with
+ * UAVTalkSendObjectDelta().  Delta encoding is enabled automatically when the
+ * peer announces it, the owner of the link should disable it again when the
+ * peer goes away.  Either way the next update of every object is a keyframe.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] enabled True to delta encode updates
+ */
+void UAVTalkSetDelta(UAVTalkConnection connectionHandle, bool enabled)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	invalidateDelta(connection->txDelta);
+	connection->deltaEnabled = enabled;
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+}
+
+/**
+ * Check whether updates sent with UAVTalkSendObjectDelta() are delta encoded
+ * \param[in] connection UAVTalkConnection to be used
+ * \return true if the peer accepts delta frames
+ */
+bool UAVTalkGetDelta(UAVTalkConnection connectionHandle)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return false);
+
+	return connection->deltaEnabled;
+}
+
 /**
  * Receive an object. This function process objects received through the telemetry stream.
  * \param[in] connection UAVTalkConnection to be used
@@ -925,6 +1566,28 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
 		case UAVTALK_TYPE_NACK:
 			// Do nothing on flight side, let it time out.
 			break;
+		case UAVTALK_TYPE_OBJ_MULTI:
+			// Any batched frame, even an empty one, tells us the peer understands them
+			connection->batchEnabled = true;
+			ret = receiveMultiObject(connection, data, length);
+			break;
+		case UAVTALK_TYPE_OBJ_DELTA:
+			if (objId == UAVTALK_DELTA_OBJID && length == 0)
+			{
+				// Capability announcement, start over from keyframes if this is a new peer
+				if (!connection->deltaEnabled)
+					invalidateDelta(connection->txDelta);
+				connection->deltaEnabled = true;
+			}
+			else if (obj && (instId != UAVOBJ_ALL_INSTANCES))
+			{
+				ret = receiveDelta(connection, obj, instId, data, length);
+			}
+			else
+			{
+				ret = -1;
+			}
+			break;
 		case UAVTALK_TYPE_ACK:
 			// All instances, not allowed for ACK messages
 			if (obj && (instId != UAVOBJ_ALL_INSTANCES))
@@ -944,6 +1607,70 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
 	return ret;
 }
 
+/**
+ * Unpack the entries of a batched frame.  Entries for unknown objects or with
+ * a length that does not match the local definition are skipped.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] data Frame payload
+ * \param[in] length Payload length
+ * \return 0 Success
+ * \return -1 Failure if any entry was malformed or skipped
+ */
+static int32_t receiveMultiObject(UAVTalkConnectionData *connection, uint8_t* data, int32_t length)
+{
+	int32_t ret = 0;
+
+	while (length >= UAVTALK_MULTI_ENTRY_HEADER_LENGTH)
+	{
+		int32_t entryLength = UAVTALK_MULTI_ENTRY_HEADER_LENGTH + data[6];
+
+		if (entryLength > length)
+			return -1;
+
+		if (receiveMultiEntry(connection, data) < 0)
+			ret = -1;
+
+		data += entryLength;
+		length -= entryLength;
+	}
+
+	// Trailing bytes that do not form an entry
+	if (length != 0)
+		ret = -1;
+
+	return ret;
+}
+
+/**
+ * Unpack a single entry of a batched frame
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] entry Entry header followed by the object data
+ * \return 0 Success
+ * \return -1 Failure if the object is unknown or its length does not match
+ */
+static int32_t receiveMultiEntry(UAVTalkConnectionData *connection, uint8_t* entry)
+{
+	uint32_t objId = entry[0] | (entry[1] << 8) | (entry[2] << 16) | ((uint32_t)entry[3] << 24);
+	uint16_t instId = entry[4] | (entry[5] << 8);
+	uint8_t objLength = entry[6];
+
+	UAVObjHandle obj = UAVObjGetByID(objId);
+	if (!obj || (instId == UAVOBJ_ALL_INSTANCES))
+		return -1;
+
+	if (instId & UAVTALK_MULTI_DELTA_INSTID)
+		return receiveDelta(connection, obj, instId & ~UAVTALK_MULTI_DELTA_INSTID,
+				&entry[UAVTALK_MULTI_ENTRY_HEADER_LENGTH], objLength);
+
+	if (UAVObjGetNumBytes(obj) != objLength)
+		return -1;
+
+	UAVObjUnpack(obj, instId, &entry[UAVTALK_MULTI_ENTRY_HEADER_LENGTH]);
+	updateAck(connection, obj, instId);
+
+	return 0;
+}
+
 /**
  * Check if an ack is pending on an object and give response semaphore
  * \param[in] connection UAVTalkConnection to be used
@@ -980,7 +1707,7 @@ static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, u
 	}
 	
 	// Process message type
-	if ( type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_TS || type == UAVTALK_TYPE_OBJ_ACK || type == UAVTALK_TYPE_OBJ_ACK_TS )
+	if ( type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_TS || type == UAVTALK_TYPE_OBJ_ACK || type == UAVTALK_TYPE_OBJ_ACK_TS || type == UAVTALK_TYPE_OBJ_DELTA )
 	{
 		if (instId == UAVOBJ_ALL_INSTANCES)
 		{
@@ -1072,6 +1799,17 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle
 	{
 		length = 0;
 	}
+	else if (type == UAVTALK_TYPE_OBJ_DELTA)
+	{
+		// The payload is encoded here, send the plain object if that fails
+		length = encodeDelta(connection, obj, instId, &connection->txBuffer[dataOffset]);
+		if (length < 0)
+		{
+			type = UAVTALK_TYPE_OBJ;
+			connection->txBuffer[1] = type;
+			length = UAVObjGetNumBytes(obj);
+		}
+	}
 	else
 	{
 		length = UAVObjGetNumBytes(obj);
@@ -1084,7 +1822,7 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle
 	}
 	
 	// Copy data (if any)
-	if (length > 0)
+	if (length > 0 && type != UAVTALK_TYPE_OBJ_DELTA)
 	{
 		if ( UAVObjPack(obj, instId, &connection->txBuffer[dataOffset]) < 0 )
 		{
@@ -1113,6 +1851,153 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle
 	return 0;
 }
 
+/**
+ * Queue an object update in the pending batched frame, or send it right away
+ * when the peer does not accept batched frames.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances
+ * \param[in] delta True to delta encode the update
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t batchObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, bool delta)
+{
+	int32_t ret = 0;
+
+	if (connection->batchEnabled && connection->batchBuffer == NULL)
+		connection->batchBuffer = PIOS_malloc(UAVTALK_MULTI_MAX_PACKET_LENGTH);
+
+	if (!connection->batchEnabled || connection->batchBuffer == NULL) {
+		ret = sendObject(connection, obj, instId, delta ? UAVTALK_TYPE_OBJ_DELTA : UAVTALK_TYPE_OBJ);
+	} else if (instId == UAVOBJ_ALL_INSTANCES && !UAVObjIsSingleInstance(obj)) {
+		uint32_t numInst = UAVObjGetNumInstances(obj);
+		for (uint32_t n = 0; n < numInst; ++n) {
+			if (batchSingleObject(connection, obj, n, delta) < 0)
+				ret = -1;
+		}
+	} else {
+		if (instId == UAVOBJ_ALL_INSTANCES)
+			instId = 0;
+		ret = batchSingleObject(connection, obj, instId, delta);
+	}
+
+	return ret;
+}
+
+/**
+ * Append an object to the pending batched frame, sending the frame first if
+ * the object does not fit.  Objects too large to share a frame are sent on
+ * their own.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle to send
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] delta True to delta encode the entry
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t batchSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, bool delta)
+{
+	uint32_t objId;
+	int32_t length;
+	uint16_t offset;
+	uint8_t *entry;
+
+	// Room is reserved for a keyframe, the largest delta payload
+	length = UAVObjGetNumBytes(obj) + (delta ? 1 : 0);
+
+	if (length + UAVTALK_MULTI_ENTRY_HEADER_LENGTH > UAVTALK_MULTI_MAX_PAYLOAD_LENGTH)
+	{
+		flushBatch(connection);
+		return sendSingleObject(connection, obj, instId, delta ? UAVTALK_TYPE_OBJ_DELTA : UAVTALK_TYPE_OBJ);
+	}
+
+	if (connection->batchLength + UAVTALK_MULTI_ENTRY_HEADER_LENGTH + length > UAVTALK_MIN_HEADER_LENGTH + UAVTALK_MULTI_MAX_PAYLOAD_LENGTH)
+	{
+		flushBatch(connection);
+	}
+
+	// The frame header is filled in when the frame is sent
+	offset = (connection->batchLength > 0) ? connection->batchLength : UAVTALK_MIN_HEADER_LENGTH;
+	entry = &connection->batchBuffer[offset];
+
+	objId = UAVObjGetID(obj);
+	entry[0] = (uint8_t)(objId & 0xFF);
+	entry[1] = (uint8_t)((objId >> 8) & 0xFF);
+	entry[2] = (uint8_t)((objId >> 16) & 0xFF);
+	entry[3] = (uint8_t)((objId >> 24) & 0xFF);
+
+	if (delta)
+		length = encodeDelta(connection, obj, instId, &entry[UAVTALK_MULTI_ENTRY_HEADER_LENGTH]);
+
+	if (delta && length >= 0)
+	{
+		instId |= UAVTALK_MULTI_DELTA_INSTID;
+	}
+	else
+	{
+		length = UAVObjGetNumBytes(obj);
+		if (length > 0 && UAVObjPack(obj, instId, &entry[UAVTALK_MULTI_ENTRY_HEADER_LENGTH]) < 0)
+		{
+			return -1;
+		}
+	}
+
+	entry[4] = (uint8_t)(instId & 0xFF);
+	entry[5] = (uint8_t)((instId >> 8) & 0xFF);
+	entry[6] = (uint8_t)length;
+
+	connection->batchLength = offset + UAVTALK_MULTI_ENTRY_HEADER_LENGTH + length;
+	++connection->batchObjects;
+
+	return 0;
+}
+
+/**
+ * Send the pending batched frame, if any.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t flushBatch(UAVTalkConnectionData *connection)
+{
+	uint16_t length = connection->batchLength;
+	uint16_t numObjects = connection->batchObjects;
+
+	if (length == 0)
+		return 0;
+
+	connection->batchLength = 0;
+	connection->batchObjects = 0;
+
+	if (!connection->outStream) return -1;
+
+	connection->batchBuffer[0] = UAVTALK_SYNC_VAL;
+	connection->batchBuffer[1] = UAVTALK_TYPE_OBJ_MULTI;
+	connection->batchBuffer[2] = (uint8_t)(length & 0xFF);
+	connection->batchBuffer[3] = (uint8_t)((length >> 8) & 0xFF);
+	connection->batchBuffer[4] = (uint8_t)(UAVTALK_MULTI_OBJID & 0xFF);
+	connection->batchBuffer[5] = (uint8_t)((UAVTALK_MULTI_OBJID >> 8) & 0xFF);
+	connection->batchBuffer[6] = (uint8_t)((UAVTALK_MULTI_OBJID >> 16) & 0xFF);
+	connection->batchBuffer[7] = (uint8_t)((UAVTALK_MULTI_OBJID >> 24) & 0xFF);
+
+	// Calculate checksum
+	connection->batchBuffer[length] = PIOS_CRC_updateCRC(0, connection->batchBuffer, length);
+
+	uint16_t tx_msg_len = length + UAVTALK_CHECKSUM_LENGTH;
+	int32_t rc = (*connection->outStream)(connection->batchBuffer, tx_msg_len);
+
+	if (rc != tx_msg_len)
+		return -1;
+
+	// Update stats
+	connection->stats.txObjects += numObjects;
+	connection->stats.txBytes += tx_msg_len;
+	connection->stats.txObjectBytes += length - UAVTALK_MIN_HEADER_LENGTH - numObjects * UAVTALK_MULTI_ENTRY_HEADER_LENGTH;
+
+	return 0;
+}
+
 /**
  * Send a NACK through the telemetry link.
  * \param[in] connection UAVTalkConnection to be used
@@ -139,6 +139,9 @@
 /* PIOS Initcall infrastructure */
 #define PIOS_INCLUDE_INITCALL
 
+/* CRC one byte per step, the slice-by-4 tables cost 2.3kB of flash */
+#define PIOS_CRC_NO_SLICE_BY_4
+
 #define SMALLF1
 #define COPTERCONTROL
 
@@ -0,0 +1 @@
+/* Stub accessorydesired.h, the objects actuator.c uses are in openpilot.h */
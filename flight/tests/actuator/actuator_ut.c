@@ -0,0 +1,269 @@
+#include <setjmp.h>
+
+#include "actuator_ut.h"
+#include "pios_thread.h"
+#include "pios_queue.h"
+#include "pios_mutex.h"
+#include "stabilization.h"
+
+int32_t ActuatorInitialize();
+int32_t ActuatorStart();
+
+ActuatorSettingsData actuator_ut_settings;
+MixerSettingsData actuator_ut_mixer;
+ActuatorDesiredData actuator_ut_desired;
+uint8_t actuator_ut_armed;
+float actuator_ut_servo[ACTUATORCOMMAND_CHANNEL_NUMELEM];
+
+static void (*task)(void *);
+static stabilization_direct_output_t direct_output;
+static ActuatorCommandData command;
+
+static const struct actuator_ut_wait *script;
+static uint32_t script_len;
+static uint32_t script_pos;
+static jmp_buf script_end;
+static uint32_t systime;
+
+void actuator_ut_init(void)
+{
+	ActuatorInitialize();
+	ActuatorStart();
+}
+
+void actuator_ut_run(const struct actuator_ut_wait *waits, uint32_t count)
+{
+	script = waits;
+	script_len = count;
+	script_pos = 0;
+
+	if (setjmp(script_end) == 0)
+		task(NULL);
+}
+
+void actuator_ut_direct(const ActuatorDesiredData *desired)
+{
+	direct_output(desired);
+}
+
+/* Tasks and queues */
+struct pios_thread *PIOS_Thread_Create(void (*fp)(void *), const char *namep, size_t stack_bytes, void *argp, enum pios_thread_prio_e prio)
+{
+	task = fp;
+	return (struct pios_thread *) 1;
+}
+
+uint32_t PIOS_Thread_Systime(void)
+{
+	return systime += 2;
+}
+
+struct pios_queue *PIOS_Queue_Create(size_t queue_length, size_t item_size)
+{
+	return (struct pios_queue *) 1;
+}
+
+bool PIOS_Queue_Receive(struct pios_queue *queuep, void *itemp, uint32_t timeout_ms)
+{
+	if (script_pos == script_len)
+		longjmp(script_end, 1);
+
+	const struct actuator_ut_wait *wait = &script[script_pos++];
+	if (wait->during)
+		wait->during();
+
+	return wait->received;
+}
+
+struct pios_mutex *PIOS_Mutex_Create(void)
+{
+	return (struct pios_mutex *) 1;
+}
+
+bool PIOS_Mutex_Lock(struct pios_mutex *mtx, uint32_t timeout_ms)
+{
+	return true;
+}
+
+bool PIOS_Mutex_Unlock(struct pios_mutex *mtx)
+{
+	return true;
+}
+
+/* The direct path never goes stale in these tests */
+uint32_t PIOS_DELAY_GetRaw()
+{
+	return 0;
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+	return 0;
+}
+
+/* Outputs */
+void PIOS_Servo_SetMode(const uint16_t *update_rates, const uint8_t *pwm_mode, uint8_t banks)
+{
+}
+
+void PIOS_Servo_Set(uint8_t servo, float position)
+{
+	actuator_ut_servo[servo] = position;
+}
+
+void PIOS_WDG_RegisterFlag(uint16_t flag)
+{
+}
+
+void PIOS_WDG_UpdateFlag(uint16_t flag)
+{
+}
+
+void TaskMonitorAdd(uint8_t task, struct pios_thread *threadp)
+{
+}
+
+int32_t AlarmsSet(uint8_t alarm, uint8_t severity)
+{
+	return 0;
+}
+
+uint8_t AlarmsGet(uint8_t alarm)
+{
+	return SYSTEMALARMS_ALARM_OK;
+}
+
+void AlarmsClear(uint8_t alarm)
+{
+}
+
+void stabilization_direct_register_output(stabilization_direct_output_t output)
+{
+	direct_output = output;
+}
+
+/* Objects */
+int32_t ActuatorSettingsInitialize()
+{
+	return 0;
+}
+
+int32_t ActuatorSettingsConnectCallback(UAVObjEventCallback cb)
+{
+	return 0;
+}
+
+int32_t ActuatorSettingsGet(ActuatorSettingsData *data)
+{
+	*data = actuator_ut_settings;
+	return 0;
+}
+
+int32_t MixerSettingsInitialize()
+{
+	return 0;
+}
+
+int32_t MixerSettingsConnectCallback(UAVObjEventCallback cb)
+{
+	return 0;
+}
+
+int32_t MixerSettingsGet(MixerSettingsData *data)
+{
+	*data = actuator_ut_mixer;
+	return 0;
+}
+
+int32_t MixerStatusInitialize()
+{
+	return 0;
+}
+
+int32_t MixerStatusGet(MixerStatusData *data)
+{
+	return 0;
+}
+
+int32_t MixerStatusSet(const MixerStatusData *data)
+{
+	return 0;
+}
+
+int32_t ActuatorDesiredInitialize()
+{
+	return 0;
+}
+
+int32_t ActuatorDesiredConnectQueue(struct pios_queue *queue)
+{
+	return 0;
+}
+
+int32_t ActuatorDesiredGet(ActuatorDesiredData *data)
+{
+	*data = actuator_ut_desired;
+	return 0;
+}
+
+int32_t ActuatorCommandInitialize()
+{
+	return 0;
+}
+
+int32_t ActuatorCommandGet(ActuatorCommandData *data)
+{
+	*data = command;
+	return 0;
+}
+
+int32_t ActuatorCommandSet(const ActuatorCommandData *data)
+{
+	command = *data;
+	return 0;
+}
+
+int32_t ActuatorCommandChannelGet(float *channel)
+{
+	memcpy(channel, command.Channel, sizeof(command.Channel));
+	return 0;
+}
+
+int32_t ActuatorCommandChannelSet(const float *channel)
+{
+	memcpy(command.Channel, channel, sizeof(command.Channel));
+	return 0;
+}
+
+bool ActuatorCommandReadOnly()
+{
+	return false;
+}
+
+int32_t FlightStatusGet(FlightStatusData *data)
+{
+	data->Armed = actuator_ut_armed;
+	return 0;
+}
+
+int32_t FlightStatusArmedGet(uint8_t *armed)
+{
+	*armed = actuator_ut_armed;
+	return 0;
+}
+
+int32_t AccessoryDesiredInstGet(uint16_t instId, AccessoryDesiredData *data)
+{
+	return -1;
+}
+
+int32_t CameraDesiredGet(CameraDesiredData *data)
+{
+	return -1;
+}
+
+int32_t ManualControlCommandCollectiveGet(float *collective)
+{
+	*collective = 0;
+	return 0;
+}
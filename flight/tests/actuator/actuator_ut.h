@@ -0,0 +1,28 @@
+/* Drives actuator.c on the host, one scripted ActuatorDesired wait at a time */
+#ifndef ACTUATOR_UT_H
+#define ACTUATOR_UT_H
+
+#include "openpilot.h"
+
+//! One wait of the actuator task for ActuatorDesired
+struct actuator_ut_wait {
+	void (*during)(void);   //!< Runs while the task waits, as the rate loop would
+	bool received;          //!< Whether the wait ends with an update or a timeout
+};
+
+extern ActuatorSettingsData actuator_ut_settings;
+extern MixerSettingsData actuator_ut_mixer;
+extern ActuatorDesiredData actuator_ut_desired;
+extern uint8_t actuator_ut_armed;
+extern float actuator_ut_servo[ACTUATORCOMMAND_CHANNEL_NUMELEM];
+
+//! Initialize the module and capture its task and direct output
+void actuator_ut_init(void);
+
+//! Run the actuator task through the waits, it stops at the first wait past them
+void actuator_ut_run(const struct actuator_ut_wait *waits, uint32_t count);
+
+//! Call the direct output of the module as the stabilization rate loop does
+void actuator_ut_direct(const ActuatorDesiredData *desired);
+
+#endif /* ACTUATOR_UT_H */
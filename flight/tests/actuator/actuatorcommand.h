@@ -0,0 +1 @@
+/* Stub actuatorcommand.h, the objects actuator.c uses are in openpilot.h */
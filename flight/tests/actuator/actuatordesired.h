@@ -0,0 +1 @@
+/* Stub actuatordesired.h, the objects actuator.c uses are in openpilot.h */
@@ -0,0 +1 @@
+/* Stub actuatorsettings.h, the objects actuator.c uses are in openpilot.h */
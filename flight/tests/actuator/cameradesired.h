@@ -0,0 +1 @@
+/* Stub cameradesired.h, the objects actuator.c uses are in openpilot.h */
@@ -0,0 +1 @@
+/* Stub flightstatus.h, the objects actuator.c uses are in openpilot.h */
@@ -0,0 +1 @@
+/* Stub gyros.h, the objects actuator.c uses are in openpilot.h */
@@ -0,0 +1 @@
+/* Stub manualcontrolcommand.h, the objects actuator.c uses are in openpilot.h */
@@ -0,0 +1 @@
+/* Stub mixersettings.h, the objects actuator.c uses are in openpilot.h */
@@ -0,0 +1 @@
+/* Stub mixerstatus.h, the objects actuator.c uses are in openpilot.h */
@@ -0,0 +1,200 @@
+/* Stub openpilot.h, with the parts of the objects that actuator.c uses */
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include "pios.h"
+
+struct pios_thread;
+struct pios_queue;
+
+#define MODULE_INITCALL(ifn, sfn)
+#define DONT_BUILD_IF(COND,MSG) typedef char static_assertion_##MSG[(COND)?-1:1]
+
+typedef void *UAVObjHandle;
+typedef struct {
+	UAVObjHandle obj;
+	uint16_t instId;
+	uint8_t event;
+} UAVObjEvent;
+typedef void (*UAVObjEventCallback)(UAVObjEvent *ev);
+
+/* SystemAlarms */
+enum {
+	SYSTEMALARMS_ALARM_ACTUATOR,
+	SYSTEMALARMS_ALARM_BATTERY,
+	SYSTEMALARMS_ALARM_GPS,
+};
+enum {
+	SYSTEMALARMS_ALARM_OK,
+	SYSTEMALARMS_ALARM_WARNING,
+	SYSTEMALARMS_ALARM_CRITICAL,
+};
+int32_t AlarmsSet(uint8_t alarm, uint8_t severity);
+uint8_t AlarmsGet(uint8_t alarm);
+void AlarmsClear(uint8_t alarm);
+
+/* TaskInfo */
+#define TASKINFO_RUNNING_ACTUATOR 0
+void TaskMonitorAdd(uint8_t task, struct pios_thread *threadp);
+
+/* ActuatorSettings */
+#define ACTUATORSETTINGS_TIMERUPDATEFREQ_NUMELEM 6
+#define ACTUATORSETTINGS_TIMERPWMRESOLUTION_NUMELEM 6
+#define ACTUATORSETTINGS_TIMERPWMRESOLUTION_1MHZ 0
+#define ACTUATORSETTINGS_TIMERPWMRESOLUTION_12MHZ 1
+#define ACTUATORSETTINGS_CHANNELTYPE_PWM 0
+#define ACTUATORSETTINGS_CHANNELTYPE_PWMALARM 1
+#define ACTUATORSETTINGS_CHANNELTYPE_ARMINGLED 2
+#define ACTUATORSETTINGS_CHANNELTYPE_INFOLED 3
+#define ACTUATORSETTINGS_MOTORSSPINWHILEARMED_FALSE 0
+#define ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE 1
+#define ACTUATORSETTINGS_MOTORINPUTOUTPUTCURVEFIT_A 0
+#define ACTUATORSETTINGS_MOTORINPUTOUTPUTCURVEFIT_B 1
+typedef struct {
+	uint16_t TimerUpdateFreq[6];
+	uint16_t ChannelMax[10];
+	uint16_t ChannelNeutral[10];
+	uint16_t ChannelMin[10];
+	float MotorInputOutputCurveFit[2];
+	uint8_t TimerPwmResolution[6];
+	uint8_t ChannelType[10];
+	uint8_t MotorsSpinWhileArmed;
+} ActuatorSettingsData;
+int32_t ActuatorSettingsInitialize();
+int32_t ActuatorSettingsConnectCallback(UAVObjEventCallback cb);
+int32_t ActuatorSettingsGet(ActuatorSettingsData *data);
+
+/* MixerSettings */
+typedef enum {
+	MIXERSETTINGS_MIXER1TYPE_DISABLED,
+	MIXERSETTINGS_MIXER1TYPE_MOTOR,
+	MIXERSETTINGS_MIXER1TYPE_SERVO,
+	MIXERSETTINGS_MIXER1TYPE_CAMERAROLL,
+	MIXERSETTINGS_MIXER1TYPE_CAMERAPITCH,
+	MIXERSETTINGS_MIXER1TYPE_CAMERAYAW,
+	MIXERSETTINGS_MIXER1TYPE_ACCESSORY0,
+	MIXERSETTINGS_MIXER1TYPE_ACCESSORY1,
+	MIXERSETTINGS_MIXER1TYPE_ACCESSORY2,
+	MIXERSETTINGS_MIXER1TYPE_ACCESSORY3,
+	MIXERSETTINGS_MIXER1TYPE_ACCESSORY4,
+	MIXERSETTINGS_MIXER1TYPE_ACCESSORY5,
+} MixerSettingsMixer1TypeOptions;
+typedef enum {
+	MIXERSETTINGS_CURVE2SOURCE_THROTTLE,
+	MIXERSETTINGS_CURVE2SOURCE_ROLL,
+	MIXERSETTINGS_CURVE2SOURCE_PITCH,
+	MIXERSETTINGS_CURVE2SOURCE_YAW,
+	MIXERSETTINGS_CURVE2SOURCE_COLLECTIVE,
+	MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0,
+	MIXERSETTINGS_CURVE2SOURCE_ACCESSORY1,
+	MIXERSETTINGS_CURVE2SOURCE_ACCESSORY2,
+	MIXERSETTINGS_CURVE2SOURCE_ACCESSORY3,
+	MIXERSETTINGS_CURVE2SOURCE_ACCESSORY4,
+	MIXERSETTINGS_CURVE2SOURCE_ACCESSORY5,
+} MixerSettingsCurve2SourceOptions;
+#define MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1 0
+#define MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2 1
+#define MIXERSETTINGS_MIXER1VECTOR_ROLL 2
+#define MIXERSETTINGS_MIXER1VECTOR_PITCH 3
+#define MIXERSETTINGS_MIXER1VECTOR_YAW 4
+#define MIXERSETTINGS_THROTTLECURVE1_NUMELEM 5
+#define MIXERSETTINGS_THROTTLECURVE2_NUMELEM 5
+typedef struct {
+	float ThrottleCurve1[5];
+	float ThrottleCurve2[5];
+	MixerSettingsCurve2SourceOptions Curve2Source;
+	MixerSettingsMixer1TypeOptions Mixer1Type;
+	int8_t Mixer1Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer2Type;
+	int8_t Mixer2Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer3Type;
+	int8_t Mixer3Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer4Type;
+	int8_t Mixer4Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer5Type;
+	int8_t Mixer5Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer6Type;
+	int8_t Mixer6Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer7Type;
+	int8_t Mixer7Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer8Type;
+	int8_t Mixer8Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer9Type;
+	int8_t Mixer9Vector[5];
+	MixerSettingsMixer1TypeOptions Mixer10Type;
+	int8_t Mixer10Vector[5];
+} MixerSettingsData;
+int32_t MixerSettingsInitialize();
+int32_t MixerSettingsConnectCallback(UAVObjEventCallback cb);
+int32_t MixerSettingsGet(MixerSettingsData *data);
+
+/* MixerStatus */
+typedef struct {
+	float Mixer[10];
+} MixerStatusData;
+int32_t MixerStatusInitialize();
+int32_t MixerStatusGet(MixerStatusData *data);
+int32_t MixerStatusSet(const MixerStatusData *data);
+
+/* ActuatorDesired */
+typedef struct {
+	float Roll;
+	float Pitch;
+	float Yaw;
+	float Throttle;
+	float UpdateTime;
+} ActuatorDesiredData;
+int32_t ActuatorDesiredInitialize();
+int32_t ActuatorDesiredConnectQueue(struct pios_queue *queue);
+int32_t ActuatorDesiredGet(ActuatorDesiredData *data);
+
+/* ActuatorCommand */
+#define ACTUATORCOMMAND_CHANNEL_NUMELEM 10
+typedef struct {
+	float Channel[10];
+	uint16_t MaxUpdateTime;
+	uint8_t UpdateTime;
+	uint8_t NumFailedUpdates;
+} ActuatorCommandData;
+int32_t ActuatorCommandInitialize();
+int32_t ActuatorCommandGet(ActuatorCommandData *data);
+int32_t ActuatorCommandSet(const ActuatorCommandData *data);
+int32_t ActuatorCommandChannelGet(float *channel);
+int32_t ActuatorCommandChannelSet(const float *channel);
+bool ActuatorCommandReadOnly();
+
+/* FlightStatus */
+#define FLIGHTSTATUS_ARMED_DISARMED 0
+#define FLIGHTSTATUS_ARMED_ARMING 1
+#define FLIGHTSTATUS_ARMED_ARMED 2
+typedef struct {
+	uint8_t Armed;
+} FlightStatusData;
+int32_t FlightStatusGet(FlightStatusData *data);
+int32_t FlightStatusArmedGet(uint8_t *armed);
+
+/* AccessoryDesired */
+typedef struct {
+	float AccessoryVal;
+} AccessoryDesiredData;
+int32_t AccessoryDesiredInstGet(uint16_t instId, AccessoryDesiredData *data);
+
+/* CameraDesired */
+typedef struct {
+	float Roll;
+	float Pitch;
+	float Yaw;
+} CameraDesiredData;
+int32_t CameraDesiredGet(CameraDesiredData *data);
+
+/* ManualControlCommand */
+int32_t ManualControlCommandCollectiveGet(float *collective);
+
+/* Gyros, for stabilization.h */
+typedef struct {
+	float x;
+	float y;
+	float z;
+} GyrosData;
+
+#endif /* OPENPILOT_H */
@@ -0,0 +1,28 @@
+/* Just enough of pios.h to build actuator.c on the host */
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define NELEMENTS(x) (sizeof(x) / sizeof(*(x)))
+
+#define PIOS_Assert(test) do { if (!(test)) abort(); } while (0)
+
+enum pwm_mode {PWM_MODE_1MHZ, PWM_MODE_12MHZ};
+
+void PIOS_Servo_SetMode(const uint16_t *update_rates, const uint8_t *pwm_mode, uint8_t banks);
+void PIOS_Servo_Set(uint8_t servo, float position);
+
+uint32_t PIOS_DELAY_GetRaw();
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw);
+
+#define PIOS_WDG_ACTUATOR 0x0001
+void PIOS_WDG_RegisterFlag(uint16_t flag);
+void PIOS_WDG_UpdateFlag(uint16_t flag);
+
+#endif /* PIOS_H */
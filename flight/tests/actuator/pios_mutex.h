@@ -0,0 +1,13 @@
+/* Stub pios_mutex.h, the test runs everything on one thread */
+#ifndef PIOS_MUTEX_H_
+#define PIOS_MUTEX_H_
+
+#define PIOS_MUTEX_TIMEOUT_MAX 0xffffffff
+
+struct pios_mutex;
+
+struct pios_mutex *PIOS_Mutex_Create(void);
+bool PIOS_Mutex_Lock(struct pios_mutex *mtx, uint32_t timeout_ms);
+bool PIOS_Mutex_Unlock(struct pios_mutex *mtx);
+
+#endif /* PIOS_MUTEX_H_ */
@@ -0,0 +1,10 @@
+/* Stub pios_queue.h, actuator_ut.c scripts what the task receives */
+#ifndef PIOS_QUEUE_H_
+#define PIOS_QUEUE_H_
+
+struct pios_queue;
+
+struct pios_queue *PIOS_Queue_Create(size_t queue_length, size_t item_size);
+bool PIOS_Queue_Receive(struct pios_queue *queuep, void *itemp, uint32_t timeout_ms);
+
+#endif /* PIOS_QUEUE_H_ */
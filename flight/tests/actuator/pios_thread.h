@@ -0,0 +1,17 @@
+/* Stub pios_thread.h, actuator_ut.c runs the task itself */
+#ifndef PIOS_THREAD_H_
+#define PIOS_THREAD_H_
+
+enum pios_thread_prio_e {
+	PIOS_THREAD_PRIO_LOW = 1,
+	PIOS_THREAD_PRIO_NORMAL = 2,
+	PIOS_THREAD_PRIO_HIGH = 3,
+	PIOS_THREAD_PRIO_HIGHEST = 4,
+};
+
+struct pios_thread;
+
+struct pios_thread *PIOS_Thread_Create(void (*fp)(void *), const char *namep, size_t stack_bytes, void *argp, enum pios_thread_prio_e prio);
+uint32_t PIOS_Thread_Systime(void);
+
+#endif /* PIOS_THREAD_H_ */
@@ -0,0 +1 @@
+/* Stub systemsettings.h, the objects actuator.c uses are in openpilot.h */
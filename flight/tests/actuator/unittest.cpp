@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+
+extern "C" {
+
+#include "actuator_ut.h"
+
+}
+
+#define MOTORS 4
+#define MOTOR_MIN 1000
+#define MOTOR_MAX 2000
+
+/* Full throttle in the mixer vectors */
+#define MIXER_THROTTLE 127
+
+/* ActuatorDesired throttles and the motor outputs they mix to */
+#define HOVER 0.5f
+#define CLIMB 0.75f
+#define MOTOR_US(throttle) (MOTOR_MIN + (MOTOR_MAX - MOTOR_MIN) * (throttle) * MIXER_THROTTLE / 128.0f)
+#define HOVER_US MOTOR_US(HOVER)
+#define CLIMB_US MOTOR_US(CLIMB)
+
+static const struct actuator_ut_wait update = { NULL, true };
+static const struct actuator_ut_wait timeout = { NULL, false };
+
+static ActuatorDesiredData climb;
+
+static void direct_climb(void)
+{
+  actuator_ut_direct(&climb);
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class Actuator : public testing::Test {
+protected:
+  virtual void SetUp() {
+    static bool initialized;
+
+    /* A quad with throttle only mixing and a straight throttle curve */
+    memset(&actuator_ut_settings, 0, sizeof(actuator_ut_settings));
+    memset(&actuator_ut_mixer, 0, sizeof(actuator_ut_mixer));
+    for (int i = 0; i < MOTORS; i++) {
+      actuator_ut_settings.ChannelMin[i] = MOTOR_MIN;
+      actuator_ut_settings.ChannelNeutral[i] = MOTOR_MIN;
+      actuator_ut_settings.ChannelMax[i] = MOTOR_MAX;
+    }
+    actuator_ut_settings.MotorInputOutputCurveFit[ACTUATORSETTINGS_MOTORINPUTOUTPUTCURVEFIT_A] = 1;
+    actuator_ut_settings.MotorInputOutputCurveFit[ACTUATORSETTINGS_MOTORINPUTOUTPUTCURVEFIT_B] = 1;
+
+    actuator_ut_mixer.Mixer1Type = MIXERSETTINGS_MIXER1TYPE_MOTOR;
+    actuator_ut_mixer.Mixer2Type = MIXERSETTINGS_MIXER1TYPE_MOTOR;
+    actuator_ut_mixer.Mixer3Type = MIXERSETTINGS_MIXER1TYPE_MOTOR;
+    actuator_ut_mixer.Mixer4Type = MIXERSETTINGS_MIXER1TYPE_MOTOR;
+    actuator_ut_mixer.Mixer1Vector[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = MIXER_THROTTLE;
+    actuator_ut_mixer.Mixer2Vector[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = MIXER_THROTTLE;
+    actuator_ut_mixer.Mixer3Vector[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = MIXER_THROTTLE;
+    actuator_ut_mixer.Mixer4Vector[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = MIXER_THROTTLE;
+    for (int i = 0; i < MIXERSETTINGS_THROTTLECURVE1_NUMELEM; i++) {
+      actuator_ut_mixer.ThrottleCurve1[i] = i / (MIXERSETTINGS_THROTTLECURVE1_NUMELEM - 1.0f);
+    }
+
+    memset(&actuator_ut_desired, 0, sizeof(actuator_ut_desired));
+    actuator_ut_desired.Throttle = HOVER;
+    memset(&climb, 0, sizeof(climb));
+    climb.Throttle = CLIMB;
+    actuator_ut_armed = FLIGHTSTATUS_ARMED_ARMED;
+
+    if (!initialized) {
+      actuator_ut_init();
+      initialized = true;
+    }
+  }
+
+  virtual void TearDown() {
+  }
+
+  void ExpectMotors(float us) {
+    for (int i = 0; i < MOTORS; i++) {
+      EXPECT_NEAR(us, actuator_ut_servo[i], 0.01f) << "motor " << i;
+    }
+  }
+};
+
+TEST_F(Actuator, TaskMixesDesired) {
+  const struct actuator_ut_wait waits[] = { update };
+  actuator_ut_run(waits, 1);
+
+  ExpectMotors(HOVER_US);
+}
+
+TEST_F(Actuator, DirectOutputTakesOver) {
+  const struct actuator_ut_wait waits[] = { update, { direct_climb, true } };
+  actuator_ut_run(waits, 2);
+
+  ExpectMotors(CLIMB_US);
+}
+
+TEST_F(Actuator, FailsafeBlocksDirectOutput) {
+  /* ActuatorDesired stops while the rate loop keeps calling the direct path */
+  const struct actuator_ut_wait waits[] = { update, timeout, { direct_climb, false } };
+  actuator_ut_run(waits, 3);
+
+  ExpectMotors(MOTOR_MIN);
+
+  /* The failsafe stays latched outside the task as well */
+  actuator_ut_direct(&climb);
+  ExpectMotors(MOTOR_MIN);
+
+  /* Until the task gets a new ActuatorDesired */
+  const struct actuator_ut_wait recovered[] = { update };
+  actuator_ut_run(recovered, 1);
+  actuator_ut_direct(&climb);
+  ExpectMotors(CLIMB_US);
+}
+
+TEST_F(Actuator, DisarmStopsDirectOutput) {
+  const struct actuator_ut_wait waits[] = { update };
+  actuator_ut_run(waits, 1);
+
+  actuator_ut_direct(&climb);
+  ExpectMotors(CLIMB_US);
+
+  /* Without waiting for the task to see the new FlightStatus */
+  actuator_ut_armed = FLIGHTSTATUS_ARMED_DISARMED;
+  actuator_ut_direct(&climb);
+  ExpectMotors(MOTOR_MIN);
+}
@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock_gettime */
+
+extern "C" {
+
+#include "pios_crc.h"
+
+}
+
+#define BENCH_BUFFER_LEN 4096u
+#define BENCH_BYTES (64u * 1024u * 1024u)
+
+/* Bit at a time references, straight from the polynomials */
+static uint8_t crc8_bitwise(uint8_t crc, const uint8_t *data, int32_t length)
+{
+  for (int32_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++)
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+static uint16_t crc16_bitwise(uint16_t crc, const uint8_t *data, int32_t length)
+{
+  for (int32_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++)
+      crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : (crc >> 1);
+  }
+  return crc;
+}
+
+/* Byte at a time kernels, as used by the parsers */
+static uint8_t crc8_bytewise(uint8_t crc, const uint8_t *data, int32_t length)
+{
+  for (int32_t i = 0; i < length; i++)
+    crc = PIOS_CRC_updateByte(crc, data[i]);
+  return crc;
+}
+
+static uint16_t crc16_bytewise(uint16_t crc, const uint8_t *data, int32_t length)
+{
+  for (int32_t i = 0; i < length; i++)
+    crc = PIOS_CRC16_updateByte(crc, data[i]);
+  return crc;
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class CRCTest : public testing::Test {
+protected:
+  virtual void SetUp() {
+    uint32_t state = 1;
+    for (uint32_t i = 0; i < sizeof(buffer); i++) {
+      state = state * 1664525u + 1013904223u;
+      buffer[i] = state >> 24;
+    }
+  }
+
+  virtual void TearDown() {
+  }
+
+  uint8_t buffer[BENCH_BUFFER_LEN + 4];
+};
+
+TEST_F(CRCTest, CRC8MatchesReference) {
+  // All lengths around the four byte steps, from every alignment and start value
+  for (int32_t offset = 0; offset < 4; offset++) {
+    for (int32_t length = 0; length <= 300; length++) {
+      for (uint32_t crc = 0; crc < 256; crc += 51) {
+        uint8_t expected = crc8_bitwise(crc, &buffer[offset], length);
+        ASSERT_EQ(expected, crc8_bytewise(crc, &buffer[offset], length));
+        ASSERT_EQ(expected, PIOS_CRC_updateCRC(crc, &buffer[offset], length))
+          << "offset " << offset << " length " << length;
+      }
+    }
+  }
+}
+
+TEST_F(CRCTest, CRC16MatchesReference) {
+  for (int32_t offset = 0; offset < 4; offset++) {
+    for (int32_t length = 0; length <= 300; length++) {
+      for (uint32_t crc = 0; crc < 65536; crc += 13107) {
+        uint16_t expected = crc16_bitwise(crc, &buffer[offset], length);
+        ASSERT_EQ(expected, crc16_bytewise(crc, &buffer[offset], length));
+        ASSERT_EQ(expected, PIOS_CRC16_updateCRC(crc, &buffer[offset], length))
+          << "offset " << offset << " length " << length;
+      }
+    }
+  }
+}
+
+TEST_F(CRCTest, SplitBuffers) {
+  // A buffer checksummed in pieces gives the same result as in one go
+  uint8_t crc8 = PIOS_CRC_updateCRC(0, buffer, 257);
+  uint16_t crc16 = PIOS_CRC16_updateCRC(0xffff, buffer, 257);
+
+  for (int32_t split = 0; split <= 257; split++) {
+    EXPECT_EQ(crc8, PIOS_CRC_updateCRC(PIOS_CRC_updateCRC(0, buffer, split), &buffer[split], 257 - split));
+    EXPECT_EQ(crc16, PIOS_CRC16_updateCRC(PIOS_CRC16_updateCRC(0xffff, buffer, split), &buffer[split], 257 - split));
+  }
+}
+
+TEST_F(CRCTest, Throughput) {
+  const uint32_t rounds = BENCH_BYTES / BENCH_BUFFER_LEN;
+  volatile uint32_t sink = 0;
+  double t;
+
+  t = now();
+  for (uint32_t i = 0; i < rounds; i++)
+    sink += crc8_bytewise(i, buffer, BENCH_BUFFER_LEN);
+  double crc8_byte = BENCH_BYTES / (now() - t);
+
+  t = now();
+  for (uint32_t i = 0; i < rounds; i++)
+    sink += PIOS_CRC_updateCRC(i, buffer, BENCH_BUFFER_LEN);
+  double crc8_block = BENCH_BYTES / (now() - t);
+
+  t = now();
+  for (uint32_t i = 0; i < rounds; i++)
+    sink += crc16_bytewise(i, buffer, BENCH_BUFFER_LEN);
+  double crc16_byte = BENCH_BYTES / (now() - t);
+
+  t = now();
+  for (uint32_t i = 0; i < rounds; i++)
+    sink += PIOS_CRC16_updateCRC(i, buffer, BENCH_BUFFER_LEN);
+  double crc16_block = BENCH_BYTES / (now() - t);
+
+  fprintf(stdout, "PIOS_CRC_updateByte loop:   %8.1f MB/s\n", crc8_byte / 1e6);
+  fprintf(stdout, "PIOS_CRC_updateCRC:         %8.1f MB/s\n", crc8_block / 1e6);
+  fprintf(stdout, "PIOS_CRC16_updateByte loop: %8.1f MB/s\n", crc16_byte / 1e6);
+  fprintf(stdout, "PIOS_CRC16_updateCRC:       %8.1f MB/s\n", crc16_block / 1e6);
+
+  (void)sink;
+}
@@ -0,0 +1,321 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock_gettime */
+
+extern "C" {
+
+#include "filter_bank.h"	/* API for filter bank functions */
+
+}
+
+#include <math.h>		/* fabs() */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TIME_UNITS "cycles"
+static uint64_t now(void)
+{
+  return __rdtsc();
+}
+#else
+#define TIME_UNITS "ns"
+static uint64_t now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+#define SAMPLE_HZ 1000.0f
+#define SETTLE_SAMPLES 4000
+#define MEASURE_SAMPLES 1000
+
+// To use a test fixture, derive a class from testing::Test.
+class FilterBank : public testing::Test {
+protected:
+  virtual void SetUp() {
+  }
+
+  virtual void TearDown() {
+  }
+
+  // Run a sine at freq_hz on each axis and return the steady state output
+  // amplitude, from the RMS over a whole number of periods
+  void measure(void (*apply)(void *, float *), void *filter, const float freq_hz[3], float gain[3]) {
+    double sum_sq[3] = { 0, 0, 0 };
+
+    for (int k = 0; k < SETTLE_SAMPLES + MEASURE_SAMPLES; k++) {
+      float x[3];
+      for (int i = 0; i < 3; i++)
+        x[i] = sinf(2 * M_PI * freq_hz[i] * k / SAMPLE_HZ);
+
+      apply(filter, x);
+
+      if (k >= SETTLE_SAMPLES) {
+        for (int i = 0; i < 3; i++)
+          sum_sq[i] += x[i] * x[i];
+      }
+    }
+
+    for (int i = 0; i < 3; i++)
+      gain[i] = sqrt(2 * sum_sq[i] / MEASURE_SAMPLES);
+  }
+
+  static void apply_biquad(void *filter, float *x) {
+    biquad_bank_apply((struct biquad_bank *) filter, x);
+  }
+
+  static void apply_cascade(void *filter, float *x) {
+    filter_bank_apply((struct filter_bank *) filter, x);
+  }
+
+  static void apply_notch(void *filter, float *x) {
+    dynamic_notch_apply((struct dynamic_notch *) filter, x);
+  }
+};
+
+TEST_F(FilterBank, LowpassDesign) {
+  struct biquad_coeffs c;
+  biquad_lowpass(&c, 100, SAMPLE_HZ, FILTER_BANK_BUTTERWORTH_Q);
+
+  // Unity at DC, -3dB at the cutoff and rolling off at 12dB/octave
+  EXPECT_NEAR(1.0f, biquad_response(&c, 0, SAMPLE_HZ), 1e-5f);
+  EXPECT_NEAR(M_SQRT1_2, biquad_response(&c, 100, SAMPLE_HZ), 1e-3f);
+  EXPECT_LT(biquad_response(&c, 400, SAMPLE_HZ), 0.1f);
+};
+
+TEST_F(FilterBank, NotchDesign) {
+  struct biquad_coeffs c;
+  biquad_notch(&c, 150, SAMPLE_HZ, 3);
+
+  EXPECT_NEAR(1.0f, biquad_response(&c, 0, SAMPLE_HZ), 1e-5f);
+  EXPECT_LT(biquad_response(&c, 150, SAMPLE_HZ), 1e-3f);
+
+  // Q is the center frequency over the -3dB bandwidth
+  EXPECT_NEAR(M_SQRT1_2, biquad_response(&c, 150 + 25 - 1, SAMPLE_HZ), 0.05f);
+  EXPECT_GT(biquad_response(&c, 50, SAMPLE_HZ), 0.95f);
+};
+
+TEST_F(FilterBank, OutOfRangePassesThrough) {
+  struct biquad_coeffs c;
+
+  biquad_lowpass(&c, 600, SAMPLE_HZ, FILTER_BANK_BUTTERWORTH_Q);
+  EXPECT_EQ(1.0f, c.b0);
+  EXPECT_EQ(0.0f, c.a1);
+
+  biquad_notch(&c, 0, SAMPLE_HZ, 3);
+  EXPECT_EQ(1.0f, c.b0);
+  EXPECT_EQ(0.0f, c.a2);
+};
+
+TEST_F(FilterBank, LowpassMatchesDesign) {
+  struct biquad_coeffs c;
+  struct biquad_bank bank;
+  biquad_lowpass(&c, 100, SAMPLE_HZ, FILTER_BANK_BUTTERWORTH_Q);
+  biquad_bank_init(&bank, &c);
+
+  // Different frequencies on each axis check they do not interact
+  const float freq[3] = { 20, 100, 250 };
+  float gain[3];
+  measure(apply_biquad, &bank, freq, gain);
+
+  for (int i = 0; i < 3; i++)
+    EXPECT_NEAR(biquad_response(&c, freq[i], SAMPLE_HZ), gain[i], 0.01f) << "axis " << i;
+};
+
+TEST_F(FilterBank, NotchRemovesCenter) {
+  struct biquad_coeffs c;
+  struct biquad_bank bank;
+  biquad_notch(&c, 150, SAMPLE_HZ, 3);
+  biquad_bank_init(&bank, &c);
+
+  const float freq[3] = { 150, 30, 400 };
+  float gain[3];
+  measure(apply_biquad, &bank, freq, gain);
+
+  // At least 40dB down at the center, passband untouched
+  EXPECT_LT(gain[0], 0.01f);
+  EXPECT_GT(gain[1], 0.95f);
+  EXPECT_GT(gain[2], 0.9f);
+};
+
+TEST_F(FilterBank, ResetSettles) {
+  struct filter_bank fb;
+  struct biquad_coeffs c;
+
+  filter_bank_init(&fb);
+  biquad_lowpass(&c, 80, SAMPLE_HZ, FILTER_BANK_BUTTERWORTH_Q);
+  ASSERT_TRUE(filter_bank_add(&fb, &c));
+  biquad_notch(&c, 200, SAMPLE_HZ, 2);
+  ASSERT_TRUE(filter_bank_add(&fb, &c));
+
+  const float value[3] = { 1.5f, -2.0f, 9.8f };
+  filter_bank_reset(&fb, value);
+
+  // A constant input should come straight through with no transient
+  for (int k = 0; k < 10; k++) {
+    float x[3] = { value[0], value[1], value[2] };
+    filter_bank_apply(&fb, x);
+    for (int i = 0; i < 3; i++)
+      EXPECT_NEAR(value[i], x[i], 1e-4f);
+  }
+};
+
+TEST_F(FilterBank, CascadeMultiplies) {
+  struct filter_bank fb;
+  struct biquad_coeffs lp, notch;
+
+  filter_bank_init(&fb);
+  biquad_lowpass(&lp, 120, SAMPLE_HZ, FILTER_BANK_BUTTERWORTH_Q);
+  biquad_notch(&notch, 80, SAMPLE_HZ, 4);
+  ASSERT_TRUE(filter_bank_add(&fb, &lp));
+  ASSERT_TRUE(filter_bank_add(&fb, &notch));
+
+  const float freq[3] = { 40, 80, 160 };
+  float gain[3];
+  measure(apply_cascade, &fb, freq, gain);
+
+  for (int i = 0; i < 3; i++) {
+    float expected = biquad_response(&lp, freq[i], SAMPLE_HZ) *
+                     biquad_response(&notch, freq[i], SAMPLE_HZ);
+    EXPECT_NEAR(expected, gain[i], 0.01f) << "axis " << i;
+  }
+};
+
+TEST_F(FilterBank, CascadeFull) {
+  struct filter_bank fb;
+  struct biquad_coeffs c;
+
+  filter_bank_init(&fb);
+  biquad_passthrough(&c);
+  for (int s = 0; s < FILTER_BANK_MAX_STAGES; s++)
+    EXPECT_TRUE(filter_bank_add(&fb, &c));
+  EXPECT_FALSE(filter_bank_add(&fb, &c));
+  EXPECT_EQ(FILTER_BANK_MAX_STAGES, fb.num_stages);
+};
+
+TEST_F(FilterBank, DynamicNotchTracks) {
+  struct dynamic_notch n;
+  dynamic_notch_init(&n, 100, SAMPLE_HZ, 3);
+
+  const float freq[3] = { 100, 180, 180 };
+  float gain[3];
+  measure(apply_notch, &n, freq, gain);
+  EXPECT_LT(gain[0], 0.01f);
+  EXPECT_GT(gain[1], 0.9f);
+
+  // Sweep the notch while running, the output must stay bounded
+  for (int k = 0; k < 1000; k++) {
+    dynamic_notch_set_center(&n, 100 + 80 * k / 1000.0f);
+
+    float x[3];
+    for (int i = 0; i < 3; i++)
+      x[i] = sinf(2 * M_PI * freq[i] * k / SAMPLE_HZ);
+    dynamic_notch_apply(&n, x);
+
+    for (int i = 0; i < 3; i++)
+      EXPECT_LT(fabsf(x[i]), 2.0f);
+  }
+
+  dynamic_notch_set_center(&n, 180);
+  measure(apply_notch, &n, freq, gain);
+  EXPECT_GT(gain[0], 0.9f);
+  EXPECT_LT(gain[1], 0.01f);
+  EXPECT_LT(gain[2], 0.01f);
+};
+
+TEST_F(FilterBank, DynamicNotchConfigure) {
+  struct dynamic_notch n;
+
+  // No sample rate yet, so everything passes
+  dynamic_notch_init(&n, 0, 0, 1);
+  dynamic_notch_set_center(&n, 120);
+  EXPECT_EQ(1.0f, n.bank.c.b0);
+  EXPECT_EQ(0.0f, n.bank.c.a1);
+
+  // Once the rate is known the notch lands where it was asked to be
+  dynamic_notch_configure(&n, SAMPLE_HZ, 3);
+  EXPECT_LT(biquad_response(&n.bank.c, 120, SAMPLE_HZ), 1e-3f);
+
+  const float freq[3] = { 120, 40, 300 };
+  float gain[3];
+  measure(apply_notch, &n, freq, gain);
+  EXPECT_LT(gain[0], 0.01f);
+  EXPECT_GT(gain[1], 0.9f);
+  EXPECT_GT(gain[2], 0.9f);
+};
+
+TEST_F(FilterBank, Timing) {
+  struct filter_bank fb;
+  struct biquad_coeffs c;
+  const int samples = 100000;
+
+  filter_bank_init(&fb);
+  biquad_lowpass(&c, 100, SAMPLE_HZ, FILTER_BANK_BUTTERWORTH_Q);
+  filter_bank_add(&fb, &c);
+
+  float x[3] = { 0.1f, 0.2f, 0.3f };
+  float sum = 0;
+
+  uint64_t start = now();
+  for (int k = 0; k < samples; k++) {
+    x[k % 3] += 0.01f;
+    filter_bank_apply(&fb, x);
+    sum += x[0];
+  }
+  uint64_t single = now() - start;
+
+  biquad_notch(&c, 150, SAMPLE_HZ, 3);
+  while (filter_bank_add(&fb, &c));
+
+  start = now();
+  for (int k = 0; k < samples; k++) {
+    x[k % 3] += 0.01f;
+    filter_bank_apply(&fb, x);
+    sum += x[0];
+  }
+  uint64_t full = now() - start;
+
+  printf("1 stage:  %.1f %s per 3 axis sample\n", (double) single / samples, TIME_UNITS);
+  printf("%d stages: %.1f %s per 3 axis sample\n", FILTER_BANK_MAX_STAGES, (double) full / samples, TIME_UNITS);
+
+  EXPECT_TRUE(isfinite(sum));
+};
@@ -1,6 +1,10 @@
+#ifndef I2CVM_H
+#define I2CVM_H
+
 #include <stdint.h>
 
 #define I2CVM_RAM_NUMELEMENTS 8
+#define I2CVM_RAM_NUMELEM I2CVM_RAM_NUMELEMENTS
 
 typedef struct {
 	uint8_t ram[I2CVM_RAM_NUMELEMENTS];
@@ -17,6 +21,13 @@ typedef struct {
 } I2CVMData;
 
 extern void I2CVMSet(I2CVMData * data);
+extern int32_t I2CVMInstSet(uint16_t instId, const I2CVMData * data);
 
 /* Window into the latest UAVO contents */
 extern I2CVMData uavo_data;
+
+/* Window into the latest contents of each instance */
+#define I2CVM_UT_INSTANCES 4
+extern I2CVMData uavo_instances[I2CVM_UT_INSTANCES];
+
+#endif /* I2CVM_H */
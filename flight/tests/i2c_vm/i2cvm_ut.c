@@ -2,6 +2,7 @@
 #include <string.h>		/* memcpy */
 
 I2CVMData uavo_data;
+I2CVMData uavo_instances[I2CVM_UT_INSTANCES];
 
 void I2CVMSet(I2CVMData * data)
 {
@@ -11,3 +12,14 @@ void I2CVMSet(I2CVMData * data)
 	return;
 }
 
+int32_t I2CVMInstSet(uint16_t instId, const I2CVMData * data)
+{
+	if (instId >= I2CVM_UT_INSTANCES)
+		return -1;
+
+	/* Grab a snapshot of the instance and keep the latest one overall */
+	memcpy(&uavo_instances[instId], data, sizeof(uavo_instances[instId]));
+	memcpy(&uavo_data, data, sizeof(uavo_data));
+
+	return 0;
+}
@@ -1,6 +1,12 @@
 #include "pios.h"
 
+uint32_t i2c_ut_txns[128];
+
 int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns)
 {
+	for (uint32_t i = 0; i < num_txns; i++) {
+		i2c_ut_txns[txn_list[i].addr & 0x7F]++;
+	}
+
 	return 0;
 }
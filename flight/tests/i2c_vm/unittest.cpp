@@ -37,13 +37,17 @@
 #include <stdlib.h>		/* abort */
 #include <string.h>		/* memset */
 #include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock_gettime */
 
 extern "C" {
 
 #include "i2c_vm_asm.h"
-extern bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter);
+#include "i2c_vm.h"		// i2c_vm_run, struct i2c_vm, struct i2c_vm_sched
 
 #include "i2cvm.h"		// uavo_data
+#include "pios_heap.h"		// PIOS_free
+
+extern uint32_t i2c_ut_txns[128];
 
 }
 
@@ -800,3 +804,344 @@ TEST_F(I2CVMTest, CleanReboot) {
 
   EXPECT_EQ(0, memcmp(ram2, uavo_data.ram, sizeof(ram)));
 }
+
+TEST_F(I2CVMTest, DivByZero) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_SET_IMM(VM_R0, 10),
+    I2C_VM_ASM_DIV(VM_R2, VM_R0, VM_R1),
+  };
+
+  EXPECT_FALSE(i2c_vm_run (program, NELEMENTS(program), 0));
+
+  const uint32_t program2[] = {
+    I2C_VM_ASM_DIV_IMM(VM_R0, 0),
+  };
+
+  EXPECT_FALSE(i2c_vm_run (program2, NELEMENTS(program2), 0));
+}
+
+TEST_F(I2CVMTest, DivMostNegative) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_SET_IMM(VM_R0, -32768),
+    I2C_VM_ASM_SL_IMM(VM_R0, 16),
+    I2C_VM_ASM_SET_IMM(VM_R1, -1),
+    I2C_VM_ASM_DIV(VM_R2, VM_R0, VM_R1),
+    I2C_VM_ASM_SEND_UAVO(),
+  };
+
+  EXPECT_TRUE(i2c_vm_run (program, NELEMENTS(program), 0));
+
+  EXPECT_EQ(INT32_MIN, uavo_data.r2);
+}
+
+TEST_F(I2CVMTest, BadInstructionNotReached) {
+  /* Bad instructions only fault the VM when they are executed */
+  const uint32_t program[] = {
+    I2C_VM_ASM_SET_IMM(VM_R0, 1),
+    I2C_VM_ASM_SEND_UAVO(),
+    I2C_VM_ASM_HALT(),
+    0xFFFFFFFF,
+    I2C_VM_ASM_SET_IMM(VM_PC, 1),
+    I2C_VM_ASM_LOAD_LE(6, 4, VM_R0),
+    I2C_VM_ASM_JUMP(100),
+  };
+
+  EXPECT_TRUE(i2c_vm_run (program, NELEMENTS(program), 0));
+
+  EXPECT_EQ(1, uavo_data.r0);
+}
+
+TEST_F(I2CVMTest, BadRegister) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_ADD(VM_R0, VM_R1, VM_R6 + 1),
+  };
+
+  EXPECT_FALSE(i2c_vm_run (program, NELEMENTS(program), 0));
+}
+
+TEST_F(I2CVMTest, LoadPastEndOfRam) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_LOAD_LE(I2CVM_RAM_NUMELEMENTS - 1, 2, VM_R0),
+  };
+
+  EXPECT_FALSE(i2c_vm_run (program, NELEMENTS(program), 0));
+}
+
+TEST_F(I2CVMTest, JumpPastEnd) {
+  /* Jumping to just past the end completes the program */
+  const uint32_t program[] = {
+    I2C_VM_ASM_JUMP(2),
+    I2C_VM_ASM_SET_IMM(VM_R0, 1),
+  };
+
+  EXPECT_TRUE(i2c_vm_run (program, NELEMENTS(program), 0));
+
+  /* Anywhere further out faults it */
+  const uint32_t program2[] = {
+    I2C_VM_ASM_JUMP(3),
+    I2C_VM_ASM_SET_IMM(VM_R0, 1),
+  };
+
+  EXPECT_FALSE(i2c_vm_run (program2, NELEMENTS(program2), 0));
+
+  const uint32_t program3[] = {
+    I2C_VM_ASM_SET_IMM(VM_R0, 1),
+    I2C_VM_ASM_BNZ(VM_R0, -2),
+  };
+
+  EXPECT_FALSE(i2c_vm_run (program3, NELEMENTS(program3), 0));
+}
+
+TEST_F(I2CVMTest, DelayInterval) {
+  /* i2c_vm_run waits out delays itself */
+  const uint32_t program[] = {
+    I2C_VM_ASM_DELAY(5),
+    I2C_VM_ASM_SET_IMM(VM_R0, 3),
+    I2C_VM_ASM_SEND_UAVO(),
+  };
+
+  EXPECT_TRUE(i2c_vm_run (program, NELEMENTS(program), 0));
+  EXPECT_EQ(3, uavo_data.r0);
+}
+
+// Fixture for programs loaded into a machine of their own
+class I2CVMStepTest : public testing::Test {
+protected:
+  virtual void SetUp() {
+    memset(&vm, 0, sizeof(vm));
+  }
+
+  virtual void TearDown() {
+    if (vm.prog)
+      PIOS_free(vm.prog);
+  }
+
+  struct i2c_vm vm;
+};
+
+TEST_F(I2CVMStepTest, WaitsOnDelay) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_SET_IMM(VM_R0, 1),
+    I2C_VM_ASM_DELAY(25),
+    I2C_VM_ASM_SET_IMM(VM_R0, 2),
+  };
+
+  ASSERT_TRUE(i2c_vm_load(&vm, program, NELEMENTS(program), 0, 0));
+
+  EXPECT_EQ(I2C_VM_WAITING, i2c_vm_step(&vm, I2C_VM_SLICE));
+  EXPECT_EQ(25, vm.wait_ms);
+  EXPECT_EQ(2, vm.pc);
+  EXPECT_EQ(1u, vm.r[VM_R0]);
+
+  EXPECT_EQ(I2C_VM_HALTED, i2c_vm_step(&vm, I2C_VM_SLICE));
+  EXPECT_EQ(2u, vm.r[VM_R0]);
+
+  /* Stays halted until rebooted */
+  EXPECT_EQ(I2C_VM_HALTED, i2c_vm_step(&vm, I2C_VM_SLICE));
+  i2c_vm_reboot(&vm);
+  EXPECT_EQ(0u, vm.r[VM_R0]);
+  EXPECT_EQ(I2C_VM_WAITING, i2c_vm_step(&vm, I2C_VM_SLICE));
+}
+
+TEST_F(I2CVMStepTest, SliceEndsBusyLoop) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_ADD_IMM(VM_R0, 1),
+    I2C_VM_ASM_JUMP(-1),
+  };
+
+  ASSERT_TRUE(i2c_vm_load(&vm, program, NELEMENTS(program), 0, 0));
+
+  EXPECT_EQ(I2C_VM_RUNNING, i2c_vm_step(&vm, 10));
+  EXPECT_EQ(5u, vm.r[VM_R0]);
+  EXPECT_EQ(I2C_VM_RUNNING, i2c_vm_step(&vm, 10));
+  EXPECT_EQ(10u, vm.r[VM_R0]);
+}
+
+TEST_F(I2CVMStepTest, ReloadReusesMemory) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_NOP(),
+    I2C_VM_ASM_NOP(),
+    I2C_VM_ASM_NOP(),
+  };
+  const uint32_t program2[] = {
+    I2C_VM_ASM_SET_IMM(VM_R1, 7),
+  };
+
+  ASSERT_TRUE(i2c_vm_load(&vm, program, NELEMENTS(program), 0, 0));
+  struct i2c_vm_insn *prog = vm.prog;
+
+  ASSERT_TRUE(i2c_vm_load(&vm, program2, NELEMENTS(program2), 0, 2));
+  EXPECT_EQ(prog, vm.prog);
+  EXPECT_EQ(2, vm.uavo_instance);
+  EXPECT_EQ(I2C_VM_HALTED, i2c_vm_step(&vm, I2C_VM_SLICE));
+  EXPECT_EQ(7u, vm.r[VM_R1]);
+
+  EXPECT_FALSE(i2c_vm_load(&vm, NULL, 1, 0, 0));
+  EXPECT_FALSE(i2c_vm_load(&vm, program, 0, 0, 0));
+}
+
+/* A magnetometer polled every 10ms */
+static const uint32_t mag_program[] = {
+  I2C_VM_ASM_SET_DEV_ADDR(0x1E),
+  I2C_VM_ASM_READ_I2C(0, 6),
+  I2C_VM_ASM_LOAD_BE(0, 2, VM_R0),
+  I2C_VM_ASM_SEND_UAVO(),
+  I2C_VM_ASM_DELAY(10),
+  I2C_VM_ASM_JUMP(-4),
+};
+
+/* A barometer that starts a conversion and reads it 5ms later, every 25ms */
+static const uint32_t baro_program[] = {
+  I2C_VM_ASM_SET_DEV_ADDR(0x77),
+  I2C_VM_ASM_WRITE_I2C(0, 1),
+  I2C_VM_ASM_DELAY(5),
+  I2C_VM_ASM_READ_I2C(0, 3),
+  I2C_VM_ASM_SEND_UAVO(),
+  I2C_VM_ASM_DELAY(20),
+  I2C_VM_ASM_JUMP(-5),
+};
+
+/* A program that reads once and then faults */
+static const uint32_t broken_program[] = {
+  I2C_VM_ASM_SET_DEV_ADDR(0x50),
+  I2C_VM_ASM_READ_I2C(0, 1),
+  I2C_VM_ASM_DIV(VM_R1, VM_R1, VM_R0),
+};
+
+// Fixture for several programs sharing the bus
+class I2CVMSchedTest : public testing::Test {
+protected:
+  virtual void SetUp() {
+    i2c_vm_sched_init(&sched);
+    memset(i2c_ut_txns, 0, sizeof(i2c_ut_txns));
+    memset(uavo_instances, 0, sizeof(uavo_instances));
+  }
+
+  virtual void TearDown() {
+    for (int i = 0; i < sched.num_vms; i++)
+      PIOS_free(sched.vm[i].prog);
+  }
+
+  // Run the scheduler the way the module task does, on simulated time
+  uint32_t simulate(uint32_t duration_ms) {
+    uint32_t now_ms = 0;
+    uint32_t calls = 0;
+
+    while (now_ms < duration_ms) {
+      now_ms += i2c_vm_sched_run(&sched, now_ms);
+      calls++;
+    }
+    return calls;
+  }
+
+  struct i2c_vm_sched sched;
+};
+
+TEST_F(I2CVMSchedTest, SharedBus) {
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, mag_program, NELEMENTS(mag_program), 0));
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, baro_program, NELEMENTS(baro_program), 0));
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, broken_program, NELEMENTS(broken_program), 0));
+  EXPECT_FALSE(i2c_vm_sched_add(&sched, mag_program, NELEMENTS(mag_program), 0));
+
+  simulate(1000);
+
+  /* Each program keeps its own rate */
+  EXPECT_EQ(100u, i2c_ut_txns[0x1E]);
+  EXPECT_EQ(80u, i2c_ut_txns[0x77]);
+
+  /* The broken program is restarted at the fault rate without disturbing the others */
+  EXPECT_EQ(1000u / I2C_VM_FAULT_MS, i2c_ut_txns[0x50]);
+
+  /* Each program sends its snapshots to its own instance */
+  EXPECT_EQ(3, uavo_instances[0].pc);
+  EXPECT_EQ(4, uavo_instances[1].pc);
+}
+
+TEST_F(I2CVMSchedTest, BusyProgramShares) {
+  const uint32_t busy_program[] = {
+    I2C_VM_ASM_ADD_IMM(VM_R0, 1),
+    I2C_VM_ASM_JUMP(-1),
+  };
+
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, busy_program, NELEMENTS(busy_program), 0));
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, mag_program, NELEMENTS(mag_program), 0));
+
+  /* The busy program never waits, but the other one still gets its turn */
+  EXPECT_EQ(0u, i2c_vm_sched_run(&sched, 0));
+  EXPECT_EQ(1u, i2c_ut_txns[0x1E]);
+  EXPECT_EQ((uint32_t)I2C_VM_SLICE / 2, sched.vm[0].r[VM_R0]);
+}
+
+TEST_F(I2CVMSchedTest, CompletedProgramRestarts) {
+  const uint32_t once_program[] = {
+    I2C_VM_ASM_SET_DEV_ADDR(0x20),
+    I2C_VM_ASM_READ_I2C(0, 2),
+  };
+
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, once_program, NELEMENTS(once_program), 0));
+
+  EXPECT_EQ((uint32_t)I2C_VM_RESTART_MS, i2c_vm_sched_run(&sched, 0));
+  EXPECT_EQ((uint32_t)I2C_VM_RESTART_MS - 4, i2c_vm_sched_run(&sched, 4));
+  EXPECT_EQ(1u, i2c_ut_txns[0x20]);
+  EXPECT_EQ((uint32_t)I2C_VM_RESTART_MS, i2c_vm_sched_run(&sched, I2C_VM_RESTART_MS));
+  EXPECT_EQ(2u, i2c_ut_txns[0x20]);
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* Unpack a 16 bit sample, scale it and accumulate it, 30000 times */
+static const uint32_t math_program[] = {
+  I2C_VM_ASM_SET_IMM(VM_R6, 30000),
+  I2C_VM_ASM_STORE(0x12, 0),
+  I2C_VM_ASM_STORE(0x34, 1),
+  I2C_VM_ASM_LOAD_BE(0, 2, VM_R0),
+  I2C_VM_ASM_ADD(VM_R1, VM_R1, VM_R0),
+  I2C_VM_ASM_MUL_IMM(VM_R0, 3),
+  I2C_VM_ASM_LSR_IMM(VM_R0, 1),
+  I2C_VM_ASM_AND(VM_R2, VM_R0, VM_R1),
+  I2C_VM_ASM_ADD_IMM(VM_R6, -1),
+  I2C_VM_ASM_BNZ(VM_R6, -8),
+  I2C_VM_ASM_SEND_UAVO(),
+};
+#define MATH_PROGRAM_INSNS (2 + 30000 * 9)
+
+TEST_F(I2CVMStepTest, BenchmarkThroughput) {
+  uint64_t start = now_ns();
+  ASSERT_TRUE(i2c_vm_load(&vm, math_program, NELEMENTS(math_program), 0, 0));
+  uint64_t decode = now_ns() - start;
+
+  start = now_ns();
+  enum i2c_vm_status status;
+  while ((status = i2c_vm_step(&vm, I2C_VM_SLICE)) == I2C_VM_RUNNING)
+    ;
+  uint64_t run = now_ns() - start;
+
+  EXPECT_EQ(I2C_VM_HALTED, status);
+  EXPECT_EQ(30000 * 0x1234, uavo_data.r1);
+
+  printf("decode:  %.1f ns per instruction\n", (double) decode / NELEMENTS(math_program));
+  printf("execute: %.2f ns per instruction, %.1f M instructions/s\n",
+      (double) run / MATH_PROGRAM_INSNS, MATH_PROGRAM_INSNS * 1e3 / run);
+}
+
+TEST_F(I2CVMSchedTest, BenchmarkSharedBus) {
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, mag_program, NELEMENTS(mag_program), 0));
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, baro_program, NELEMENTS(baro_program), 0));
+  ASSERT_TRUE(i2c_vm_sched_add(&sched, mag_program, NELEMENTS(mag_program), 0));
+
+  const uint32_t duration_ms = 600000;
+  uint64_t start = now_ns();
+  uint32_t calls = simulate(duration_ms);
+  uint64_t run = now_ns() - start;
+
+  uint32_t transfers = i2c_ut_txns[0x1E] + i2c_ut_txns[0x77];
+  EXPECT_EQ(2 * duration_ms / 10 + 2 * duration_ms / 25, transfers);
+
+  printf("3 programs: %u wakeups and %u transfers in %u simulated s, %.1f ns per transfer\n",
+      calls, transfers, duration_ms / 1000, (double) run / transfers);
+}
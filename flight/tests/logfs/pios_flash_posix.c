@@ -17,6 +17,10 @@ struct flash_posix_dev {
 	const struct pios_flash_posix_cfg * cfg;
 	bool transaction_in_progress;
 	FILE * flash_file;
+	uint32_t read_count;
+	uint32_t write_count;
+	int32_t write_budget;
+	int32_t write_fail_skip;
 };
 
 static struct flash_posix_dev * PIOS_Flash_Posix_Alloc(void)
@@ -42,6 +46,10 @@ int32_t PIOS_Flash_Posix_Init(uintptr_t * chip_id, const struct pios_flash_posix
 
 	flash_dev->cfg = cfg;
 	flash_dev->transaction_in_progress = false;
+	flash_dev->read_count = 0;
+	flash_dev->write_count = 0;
+	flash_dev->write_budget = -1;
+	flash_dev->write_fail_skip = -1;
 
 	flash_dev->flash_file = fopen ("theflash.bin", "r+");
 	if (flash_dev->flash_file == NULL) {
@@ -95,12 +103,33 @@ static int32_t PIOS_Flash_Posix_EndTransaction(uintptr_t chip_id)
 	return 0;
 }
 
+/* Simulates the power going away once the write budget has been used up */
+static bool PIOS_Flash_Posix_PowerLost(struct flash_posix_dev * flash_dev)
+{
+	flash_dev->write_count++;
+
+	if (flash_dev->write_fail_skip >= 0 && flash_dev->write_fail_skip-- == 0)
+		return true;
+
+	if (flash_dev->write_budget < 0)
+		return false;
+
+	if (flash_dev->write_budget == 0)
+		return true;
+
+	flash_dev->write_budget--;
+	return false;
+}
+
 static int32_t PIOS_Flash_Posix_EraseSector(uintptr_t chip_id, uint32_t chip_sector, uint32_t chip_offset)
 {
 	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
 
 	assert(flash_dev->transaction_in_progress);
 
+	if (PIOS_Flash_Posix_PowerLost(flash_dev))
+		return -1;
+
 	if (fseek (flash_dev->flash_file, chip_offset, SEEK_SET) != 0) {
 		assert(0);
 	}
@@ -128,6 +157,9 @@ static int32_t PIOS_Flash_Posix_WriteData(uintptr_t chip_id, uint32_t chip_offse
 
 	assert(flash_dev->transaction_in_progress);
 
+	if (PIOS_Flash_Posix_PowerLost(flash_dev))
+		return -1;
+
 	if (fseek (flash_dev->flash_file, chip_offset, SEEK_SET) != 0) {
 		assert(0);
 	}
@@ -155,13 +187,53 @@ static int32_t PIOS_Flash_Posix_ReadData(uintptr_t chip_id, uint32_t chip_offset
 
 	size_t s;
 	s = fread (data, 1, len, flash_dev->flash_file);
+	flash_dev->read_count++;
 
 	assert (s == len);
 
 	return 0;
 }
 
-/* Provide a flash driver to external drivers */
+/* Number of read calls so far, for counting the cost of filesystem operations */
+uint32_t PIOS_Flash_Posix_GetReadCount(uintptr_t chip_id)
+{
+	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
+
+	return flash_dev->read_count;
+}
+
+/* Number of write and erase calls so far, including the ones dropped by the budget */
+uint32_t PIOS_Flash_Posix_GetWriteCount(uintptr_t chip_id)
+{
+	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
+
+	return flash_dev->write_count;
+}
+
+/*
+ * Lets the next budget writes or erases through and fails every one after
+ * that without touching the flash, as if the power was cut. A negative
+ * budget never fails.
+ */
+void PIOS_Flash_Posix_SetWriteBudget(uintptr_t chip_id, int32_t budget)
+{
+	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
+
+	flash_dev->write_budget = budget;
+}
+
+/*
+ * Lets the next skip writes or erases through and fails only the one after
+ * that, as a transient error would. The following ones go through again.
+ */
+void PIOS_Flash_Posix_FailWrite(uintptr_t chip_id, int32_t skip)
+{
+	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
+
+	flash_dev->write_fail_skip = skip;
+}
+
+
 const struct pios_flash_driver pios_posix_flash_driver = {
 	.start_transaction = PIOS_Flash_Posix_StartTransaction,
 	.end_transaction   = PIOS_Flash_Posix_EndTransaction,
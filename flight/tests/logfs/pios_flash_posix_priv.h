@@ -7,5 +7,9 @@ struct pios_flash_posix_cfg {
 
 int32_t PIOS_Flash_Posix_Init(uintptr_t * chip_id, const struct pios_flash_posix_cfg * cfg);
 void PIOS_Flash_Posix_Destroy(uintptr_t chip_id);
+uint32_t PIOS_Flash_Posix_GetReadCount(uintptr_t chip_id);
+uint32_t PIOS_Flash_Posix_GetWriteCount(uintptr_t chip_id);
+void PIOS_Flash_Posix_SetWriteBudget(uintptr_t chip_id, int32_t budget);
+void PIOS_Flash_Posix_FailWrite(uintptr_t chip_id, int32_t skip);
 
 extern const struct pios_flash_driver pios_posix_flash_driver;
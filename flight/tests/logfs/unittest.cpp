@@ -37,6 +37,7 @@
 #include <stdlib.h>		/* abort */
 #include <string.h>		/* memset */
 #include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock_gettime */
 
 extern "C" {
 
@@ -333,6 +334,359 @@ TEST_F(LogfsTestCooked, WriteManyVerify) {
   EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
 }
 
+/*
+ * Boot time settings load and save throughput with a settings partition
+ * holding as many objects as a full featured board registers.
+ */
+#define BENCH_OBJECTS 150
+#define BENCH_OBJ_SIZE 64
+#define BENCH_SAVES 20000
+
+class LogfsTestBench : public LogfsTestCooked {
+protected:
+  static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+  }
+
+  static uint32_t bench_obj_id(uint32_t n) {
+    return 0x1000u + n * 2654435761u;
+  }
+
+  void Fill(uint32_t n, uint32_t version) {
+    for (uint32_t i = 0; i < sizeof(obj); i++)
+      obj[i] = (uint8_t)(n * 7 + version * 13 + i);
+  }
+
+  unsigned char obj[BENCH_OBJ_SIZE];
+};
+
+TEST_F(LogfsTestBench, BootLoad) {
+  /* Save every object a few times so the log also holds obsolete slots and has been garbage collected */
+  for (uint32_t version = 0; version < 4; version++) {
+    for (uint32_t n = 0; n < BENCH_OBJECTS; n++) {
+      Fill(n, version);
+      ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+    }
+  }
+
+  /* Reboot */
+  PIOS_FLASHFS_Logfs_Destroy(fs_id);
+  PIOS_Flash_Posix_Destroy(pios_posix_flash_id);
+  EXPECT_EQ(0, PIOS_Flash_Posix_Init(&pios_posix_flash_id, &flash_config));
+
+  double start = now();
+  EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_settings, FLASH_PARTITION_LABEL_SETTINGS));
+  double mounted = now();
+  uint32_t mount_reads = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id);
+
+  /* Load every settings object, as the object manager does on boot */
+  for (uint32_t n = 0; n < BENCH_OBJECTS; n++) {
+    unsigned char check[BENCH_OBJ_SIZE];
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, bench_obj_id(n), 0, check, sizeof(check)));
+    Fill(n, 3);
+    EXPECT_EQ(0, memcmp(obj, check, sizeof(obj))) << "object " << n;
+  }
+  double loaded = now();
+  uint32_t load_reads = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id) - mount_reads;
+
+  /* Objects that were never saved are not found, without walking the log */
+  uint32_t before = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id);
+  for (uint32_t n = BENCH_OBJECTS; n < 2 * BENCH_OBJECTS; n++)
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+  uint32_t miss_reads = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id) - before;
+
+  fprintf(stdout, "mount: %.2f ms, %u flash reads\n", (mounted - start) * 1e3, mount_reads);
+  fprintf(stdout, "load %u objects: %.2f ms, %.2f flash reads per object, %.2f per missing object\n",
+    BENCH_OBJECTS, (loaded - mounted) * 1e3, (double)load_reads / BENCH_OBJECTS, (double)miss_reads / BENCH_OBJECTS);
+
+  /* One header and one data read per object, plus the odd tag collision */
+  EXPECT_LT(load_reads, 3u * BENCH_OBJECTS);
+  EXPECT_LT(miss_reads, (uint32_t)BENCH_OBJECTS);
+}
+
+TEST_F(LogfsTestBench, SaveThroughput) {
+  for (uint32_t n = 0; n < BENCH_OBJECTS; n++) {
+    Fill(n, 0);
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+  }
+
+  uint32_t before = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id);
+  double start = now();
+  for (uint32_t i = 0; i < BENCH_SAVES; i++) {
+    uint32_t n = (i * 7) % BENCH_OBJECTS;
+    Fill(n, i);
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+  }
+  double elapsed = now() - start;
+  uint32_t reads = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id) - before;
+
+  fprintf(stdout, "save: %.0f saves/s, %.2f flash reads per save including garbage collection\n",
+    BENCH_SAVES / elapsed, (double)reads / BENCH_SAVES);
+
+  /* Everything is still where the index says it is */
+  for (uint32_t i = BENCH_SAVES - BENCH_OBJECTS; i < BENCH_SAVES; i++) {
+    uint32_t n = (i * 7) % BENCH_OBJECTS;
+    unsigned char check[BENCH_OBJ_SIZE];
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, bench_obj_id(n), 0, check, sizeof(check)));
+    Fill(n, i);
+    EXPECT_EQ(0, memcmp(obj, check, sizeof(obj))) << "object " << n;
+  }
+}
+
+TEST_F(LogfsTestBench, DeleteKeepsOthersReachable) {
+  for (uint32_t n = 0; n < BENCH_OBJECTS; n++) {
+    Fill(n, 0);
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+  }
+
+  /* Delete every other object, probe chains must stay intact */
+  for (uint32_t n = 0; n < BENCH_OBJECTS; n += 2)
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, bench_obj_id(n), 0));
+
+  for (uint32_t n = 0; n < BENCH_OBJECTS; n++) {
+    unsigned char check[BENCH_OBJ_SIZE];
+    if (n % 2 == 0) {
+      EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, bench_obj_id(n), 0, check, sizeof(check)));
+    } else {
+      ASSERT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, bench_obj_id(n), 0, check, sizeof(check)));
+      Fill(n, 0);
+      EXPECT_EQ(0, memcmp(obj, check, sizeof(obj))) << "object " << n;
+    }
+  }
+}
+
+/* A batch needs room for the old and new version of every object */
+#define BATCH_OBJECTS 100
+
+TEST_F(LogfsTestBench, BatchSaveThroughput) {
+  /* Same workload both ways: every settings object saved a number of times */
+  const uint32_t rounds = 40;
+
+  uint32_t writes = PIOS_Flash_Posix_GetWriteCount(pios_posix_flash_id);
+  uint32_t reads = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id);
+  double start = now();
+  for (uint32_t version = 0; version < rounds; version++) {
+    for (uint32_t n = 0; n < BATCH_OBJECTS; n++) {
+      Fill(n, version);
+      ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+    }
+  }
+  double single_time = now() - start;
+  uint32_t single_writes = PIOS_Flash_Posix_GetWriteCount(pios_posix_flash_id) - writes;
+  uint32_t single_reads = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id) - reads;
+
+  writes = PIOS_Flash_Posix_GetWriteCount(pios_posix_flash_id);
+  reads = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id);
+  start = now();
+  for (uint32_t version = rounds; version < 2 * rounds; version++) {
+    ASSERT_EQ(0, PIOS_FLASHFS_BatchBegin(fs_id, BATCH_OBJECTS));
+    for (uint32_t n = 0; n < BATCH_OBJECTS; n++) {
+      Fill(n, version);
+      ASSERT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+    }
+    ASSERT_EQ(0, PIOS_FLASHFS_BatchCommit(fs_id));
+  }
+  double batch_time = now() - start;
+  uint32_t batch_writes = PIOS_Flash_Posix_GetWriteCount(pios_posix_flash_id) - writes;
+  uint32_t batch_reads = PIOS_Flash_Posix_GetReadCount(pios_posix_flash_id) - reads;
+
+  fprintf(stdout, "save all %u objects one at a time: %.2f ms, %u writes, %u reads\n",
+    BATCH_OBJECTS, single_time * 1e3 / rounds, single_writes / rounds, single_reads / rounds);
+  fprintf(stdout, "save all %u objects as a batch:    %.2f ms, %u writes, %u reads\n",
+    BATCH_OBJECTS, batch_time * 1e3 / rounds, batch_writes / rounds, batch_reads / rounds);
+
+  for (uint32_t n = 0; n < BATCH_OBJECTS; n++) {
+    unsigned char check[BENCH_OBJ_SIZE];
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, bench_obj_id(n), 0, check, sizeof(check)));
+    Fill(n, 2 * rounds - 1);
+    EXPECT_EQ(0, memcmp(obj, check, sizeof(obj))) << "object " << n;
+  }
+}
+
+TEST_F(LogfsTestBench, BatchTooBig) {
+  /* The old and new version of every object have to fit at the same time */
+  EXPECT_EQ(-4, PIOS_FLASHFS_BatchBegin(fs_id, 255));
+
+  ASSERT_EQ(0, PIOS_FLASHFS_BatchBegin(fs_id, 2));
+  EXPECT_EQ(-3, PIOS_FLASHFS_BatchBegin(fs_id, 2));
+  Fill(0, 0);
+  EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, bench_obj_id(0), 0, obj, sizeof(obj)));
+  EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, bench_obj_id(1), 0, obj, sizeof(obj)));
+  EXPECT_EQ(-3, PIOS_FLASHFS_BatchSave(fs_id, bench_obj_id(2), 0, obj, sizeof(obj)));
+  EXPECT_EQ(0, PIOS_FLASHFS_BatchAbort(fs_id));
+
+  /* Nothing of an aborted batch is visible */
+  EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, bench_obj_id(0), 0, obj, sizeof(obj)));
+  EXPECT_EQ(-2, PIOS_FLASHFS_BatchCommit(fs_id));
+}
+
+/*
+ * Cut the power after every possible number of flash writes while a batch
+ * replaces a set of objects, then check that after a reboot either all of
+ * the objects have the old contents or all of them have the new ones.
+ */
+#define POWERLOSS_OBJECTS 20
+
+class LogfsTestPowerLoss : public LogfsTestBench {
+protected:
+  void Reboot(void) {
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    PIOS_Flash_Posix_Destroy(pios_posix_flash_id);
+    ASSERT_EQ(0, PIOS_Flash_Posix_Init(&pios_posix_flash_id, &flash_config));
+    ASSERT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_settings, FLASH_PARTITION_LABEL_SETTINGS));
+  }
+
+  void SaveBatch(uint32_t version) {
+    if (PIOS_FLASHFS_BatchBegin(fs_id, POWERLOSS_OBJECTS) != 0)
+      return;
+    for (uint32_t n = 0; n < POWERLOSS_OBJECTS; n++) {
+      Fill(n, version);
+      if (PIOS_FLASHFS_BatchSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)) != 0) {
+        PIOS_FLASHFS_BatchAbort(fs_id);
+        return;
+      }
+    }
+    PIOS_FLASHFS_BatchCommit(fs_id);
+  }
+
+  /* Returns the version every object holds, or -1 if they disagree */
+  int32_t LoadedVersion(uint32_t v1, uint32_t v2) {
+    int32_t found = -1;
+    for (uint32_t n = 0; n < POWERLOSS_OBJECTS; n++) {
+      unsigned char check[BENCH_OBJ_SIZE];
+      if (PIOS_FLASHFS_ObjLoad(fs_id, bench_obj_id(n), 0, check, sizeof(check)) != 0)
+        return -1;
+      int32_t version;
+      Fill(n, v1);
+      if (memcmp(obj, check, sizeof(obj)) == 0) {
+        version = v1;
+      } else {
+        Fill(n, v2);
+        if (memcmp(obj, check, sizeof(obj)) != 0)
+          return -1;
+        version = v2;
+      }
+      if (n > 0 && version != found)
+        return -1;
+      found = version;
+    }
+    return found;
+  }
+
+  /* Leaves prefill saves in the log ahead of the batch to control where gc happens */
+  void Run(uint32_t prefill) {
+    for (uint32_t n = 0; n < POWERLOSS_OBJECTS; n++) {
+      Fill(n, 1);
+      ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+    }
+    for (uint32_t i = 0; i < prefill; i++) {
+      uint32_t n = i % POWERLOSS_OBJECTS;
+      Fill(n, 1);
+      ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+    }
+
+    /* Keep a copy of the flash as it is before the batch */
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    PIOS_Flash_Posix_Destroy(pios_posix_flash_id);
+    FILE * theflash = fopen("theflash.bin", "r");
+    ASSERT_TRUE(theflash != NULL);
+    uint8_t * snapshot = (uint8_t *)malloc(flash_config.size_of_flash);
+    ASSERT_EQ(1u, fread(snapshot, flash_config.size_of_flash, 1, theflash));
+    fclose(theflash);
+    ASSERT_EQ(0, PIOS_Flash_Posix_Init(&pios_posix_flash_id, &flash_config));
+    ASSERT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_settings, FLASH_PARTITION_LABEL_SETTINGS));
+
+    /* Find out how many writes an uninterrupted batch takes */
+    uint32_t before = PIOS_Flash_Posix_GetWriteCount(pios_posix_flash_id);
+    SaveBatch(2);
+    uint32_t total_writes = PIOS_Flash_Posix_GetWriteCount(pios_posix_flash_id) - before;
+    EXPECT_EQ(2, LoadedVersion(1, 2));
+
+    uint32_t saw_old = 0, saw_new = 0;
+    for (uint32_t budget = 0; budget <= total_writes; budget++) {
+      PIOS_FLASHFS_Logfs_Destroy(fs_id);
+      PIOS_Flash_Posix_Destroy(pios_posix_flash_id);
+      theflash = fopen("theflash.bin", "r+");
+      ASSERT_TRUE(theflash != NULL);
+      ASSERT_EQ(1u, fwrite(snapshot, flash_config.size_of_flash, 1, theflash));
+      fclose(theflash);
+      ASSERT_EQ(0, PIOS_Flash_Posix_Init(&pios_posix_flash_id, &flash_config));
+      ASSERT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_settings, FLASH_PARTITION_LABEL_SETTINGS));
+
+      PIOS_Flash_Posix_SetWriteBudget(pios_posix_flash_id, budget);
+      SaveBatch(2);
+      Reboot();
+
+      int32_t version = LoadedVersion(1, 2);
+      ASSERT_TRUE(version == 1 || version == 2) << "power lost after " << budget << " of " << total_writes << " writes";
+      if (version == 1)
+        saw_old++;
+      else
+        saw_new++;
+
+      /* Whatever the interrupted batch left behind must not get in the way */
+      SaveBatch(3);
+      ASSERT_EQ(3, LoadedVersion(1, 3)) << "power lost after " << budget << " of " << total_writes << " writes";
+    }
+
+    fprintf(stdout, "%u writes per batch, old contents after %u cuts, new contents after %u cuts\n",
+      total_writes, saw_old, saw_new);
+    EXPECT_GT(saw_old, 0u);
+    EXPECT_GT(saw_new, 0u);
+
+    free(snapshot);
+  }
+};
+
+TEST_F(LogfsTestPowerLoss, GarbageCollectDuringBatch) {
+  /* The log is too full to hold the batch, it gets collected half way through */
+  Run(11 * POWERLOSS_OBJECTS);
+}
+
+TEST_F(LogfsTestPowerLoss, GarbageCollectBeforeCommit) {
+  /* The batch fills the log, it gets collected to make room for the marker */
+  Run(10 * POWERLOSS_OBJECTS + 15);
+}
+
+TEST_F(LogfsTestPowerLoss, GarbageCollectAfterBatch) {
+  /* The batch and its marker fill the log exactly, it gets collected after the commit */
+  Run(10 * POWERLOSS_OBJECTS + 14);
+}
+
+TEST_F(LogfsTestPowerLoss, NoGarbageCollect) {
+  Run(0);
+}
+
+TEST_F(LogfsTestPowerLoss, FailedCommitIsAborted) {
+  for (uint32_t n = 0; n < POWERLOSS_OBJECTS; n++) {
+    Fill(n, 1);
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+  }
+
+  ASSERT_EQ(0, PIOS_FLASHFS_BatchBegin(fs_id, POWERLOSS_OBJECTS));
+  for (uint32_t n = 0; n < POWERLOSS_OBJECTS; n++) {
+    Fill(n, 2);
+    ASSERT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+  }
+
+  /* The marker goes through, then retiring the old version of object 10 fails */
+  PIOS_Flash_Posix_FailWrite(pios_posix_flash_id, 1 + 2 * (POWERLOSS_OBJECTS / 2));
+  EXPECT_EQ(-5, PIOS_FLASHFS_BatchCommit(fs_id));
+
+  /* The flash works again and everything is saved once more */
+  for (uint32_t n = 0; n < POWERLOSS_OBJECTS; n++) {
+    Fill(n, 3);
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bench_obj_id(n), 0, obj, sizeof(obj)));
+  }
+  EXPECT_EQ(3, LoadedVersion(1, 3));
+
+  /* The mount must not finish the failed batch over the newer saves */
+  Reboot();
+  EXPECT_EQ(3, LoadedVersion(1, 3));
+}
+
 class LogfsTestCookedMultiPart : public LogfsTestRaw {
 protected:
   virtual void SetUp() {
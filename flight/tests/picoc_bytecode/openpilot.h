@@ -0,0 +1 @@
+/* Stub openpilot.h for the PicoC host build */
@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ * @file       picoc_host.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Host versions of the scalar picoc_library.c functions the
+ *             benchmark scripts use, backed by plain variables
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "pios.h"
+#include "picoc_port.h"
+#include "picoc_host.h"
+
+struct picoc_host_state picoc_host;
+
+/* math.h */
+void LibSinf(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	ReturnValue->Val->FP = sinf(Param[0]->Val->FP);
+}
+
+void LibFabsf(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	ReturnValue->Val->FP = fabsf(Param[0]->Val->FP);
+}
+
+void LibSqrtf(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	ReturnValue->Val->FP = sqrtf(Param[0]->Val->FP);
+}
+
+struct LibraryFunction PlatformLibrary_math[] =
+{
+	{ LibSinf,			"float sinf(float);" },
+	{ LibFabsf,			"float fabsf(float);" },
+	{ LibSqrtf,			"float sqrtf(float);" },
+	{ NULL, NULL }
+};
+
+/* system.h */
+void SystemTime(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	ReturnValue->Val->UnsignedLongInteger = picoc_host.time_ms;
+}
+
+void SystemTestValGet(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	ReturnValue->Val->Integer = picoc_host.test_value;
+}
+
+void SystemTestValSet(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	picoc_host.test_value = Param[0]->Val->Integer;
+}
+
+void SystemAccessoryValGet(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	int instance = Param[0]->Val->Integer;
+	ReturnValue->Val->FP = (instance >= 0 && instance < NELEMENTS(picoc_host.accessory)) ? picoc_host.accessory[instance] : 0;
+}
+
+void SystemAccessoryValSet(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	int instance = Param[0]->Val->Integer;
+	if (instance >= 0 && instance < NELEMENTS(picoc_host.accessory))
+		picoc_host.accessory[instance] = Param[1]->Val->FP;
+}
+
+void SystemPWMOutSet(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	int channel = Param[0]->Val->Integer;
+	if (channel >= 0 && channel < PICOC_HOST_CHANNELS)
+		picoc_host.pwm_out[channel] = Param[1]->Val->Integer;
+}
+
+void SystemTxChannelValGet(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	int channel = Param[0]->Val->Integer;
+	ReturnValue->Val->Integer = (channel >= 0 && channel < PICOC_HOST_CHANNELS) ? picoc_host.tx_channel[channel] : 0;
+}
+
+void SystemI2CRead(struct ParseState *Parser, struct Value *ReturnValue, struct Value **Param, int NumArgs)
+{
+	ReturnValue->Val->Integer = -1;
+}
+
+struct LibraryFunction PlatformLibrary_system[] =
+{
+	{ SystemTime,			"unsigned long time();" },
+	{ SystemTestValGet,		"int TestValGet();" },
+	{ SystemTestValSet,		"void TestValSet(int);" },
+	{ SystemAccessoryValGet,"float AccessoryValGet(int);" },
+	{ SystemAccessoryValSet,"void AccessoryValSet(int,float);" },
+	{ SystemPWMOutSet,		"void PWMOutSet(int,int);" },
+	{ SystemTxChannelValGet,"int TxChannelValGet(int);" },
+	{ SystemI2CRead,		"int i2c_read(unsigned char,unsigned char, void *,unsigned int);" },
+	{ NULL, NULL }
+};
+
+const struct LibraryFunction *const picoc_host_libs[] = {
+	PlatformLibrary_math,
+	PlatformLibrary_system,
+	NULL
+};
+
+void PlatformLibraryInit(Picoc *pc)
+{
+	IncludeRegister(pc, "math.h", NULL, &PlatformLibrary_math[0], NULL);
+	IncludeRegister(pc, "system.h", NULL, &PlatformLibrary_system[0], NULL);
+}
@@ -0,0 +1,26 @@
+/* Libraries and state shared between the PicoC host build and the tests */
+#ifndef PICOC_HOST_H
+#define PICOC_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PICOC_HOST_CHANNELS 8
+
+struct LibraryFunction;
+
+//! What the scripts see of the flight controller
+struct picoc_host_state {
+	int32_t test_value;
+	float accessory[3];
+	int32_t tx_channel[PICOC_HOST_CHANNELS];
+	int32_t pwm_out[PICOC_HOST_CHANNELS];
+	uint32_t time_ms;
+};
+
+extern struct picoc_host_state picoc_host;
+extern const struct LibraryFunction *const picoc_host_libs[];
+
+int picoc(const char *source, size_t stack_size);
+
+#endif /* PICOC_HOST_H */
@@ -0,0 +1 @@
+/* Stub picocstatus.h for the PicoC host build */
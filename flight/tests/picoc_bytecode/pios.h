@@ -0,0 +1,23 @@
+/* Minimal pios.h to build the PicoC module on the host */
+#ifndef PIOS_H
+#define PIOS_H
+
+/* C Lib Includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NELEMENTS(x) (sizeof(x) / sizeof(*(x)))
+
+#define PIOS_INCLUDE_PICOC
+
+#define PIOS_Assert(x) if (!(x)) { while (1) ; }
+
+void *PIOS_malloc(size_t size);
+
+#endif /* PIOS_H */
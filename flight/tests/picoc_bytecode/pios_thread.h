@@ -0,0 +1 @@
+/* Stub pios_thread.h for the PicoC host build */
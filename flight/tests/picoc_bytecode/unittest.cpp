@@ -0,0 +1,329 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* malloc */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock_gettime */
+
+extern "C" {
+
+#include "picoc_bytecode.h"	/* API for the bytecode compiler */
+#include "picoc_host.h"		/* host libraries and the interpreter */
+
+void *PIOS_malloc(size_t size)
+{
+  return malloc(size);
+}
+
+}
+
+#define IMAGE_WORDS 2048
+#define STACK_CELLS 1024
+#define INTERPRETER_STACK (64 * 1024)
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class PicocBytecode : public testing::Test {
+protected:
+  virtual void SetUp() {
+    memset(&picoc_host, 0, sizeof(picoc_host));
+    memset(image, 0, sizeof(image));
+    error_line = 0;
+  }
+
+  virtual void TearDown() {
+  }
+
+  int32_t compile(const char *source) {
+    return picoc_bc_compile(source, picoc_host_libs, image, sizeof(image), &error_line);
+  }
+
+  // Compile and run a script, returning its exit value
+  int32_t run(const char *source) {
+    int32_t exit_value = -12345;
+
+    EXPECT_GT(compile(source), 0) << "gave up on line " << error_line;
+    EXPECT_EQ(PICOC_BC_OK, picoc_bc_run(image, picoc_host_libs, stack, STACK_CELLS, &exit_value));
+    return exit_value;
+  }
+
+  // Run a script both ways and check they agree
+  int32_t run_both(const char *source) {
+    int32_t compiled = run(source);
+    int32_t interpreted = picoc(source, INTERPRETER_STACK);
+
+    EXPECT_EQ(interpreted, compiled);
+    return compiled;
+  }
+
+  uint32_t image[IMAGE_WORDS];
+  union picoc_bc_cell stack[STACK_CELLS];
+  uint16_t error_line;
+};
+
+TEST_F(PicocBytecode, ExitValue) {
+  EXPECT_EQ(42, run_both("exit(6 * 7);"));
+  EXPECT_EQ(0, run("int a = 1;"));
+  EXPECT_EQ(-3, run_both("exit(-3);"));
+}
+
+TEST_F(PicocBytecode, IntegerArithmetic) {
+  int a = 7, b = 3;
+
+  EXPECT_EQ(a + b * 2 - a / b % 2, run_both("int a = 7; int b = 3; exit(a + b * 2 - a / b % 2);"));
+  EXPECT_EQ(((a << 2) | b) ^ (a & 5), run_both("int a = 7, b = 3; exit(((a << 2) | b) ^ (a & 5));"));
+  EXPECT_EQ(-a / b, run_both("int a = 7, b = 3; exit(-a / b);"));
+  EXPECT_EQ(-a % b, run_both("int a = 7, b = 3; exit(-a % b);"));
+  EXPECT_EQ(~a + !b + !0, run_both("int a = 7, b = 3; exit(~a + !b + !0);"));
+  EXPECT_EQ(0x10 + 010 + 'A', run_both("exit(0x10 + 010 + 'A');"));
+  EXPECT_EQ(9000000, run_both("int big = 9000000; exit(big);"));
+  EXPECT_EQ(-9000000, run_both("exit(-9000000);"));
+  EXPECT_EQ(24, run_both("int x = 5; x += 3; x -= 1; x *= 6; x /= 2; x %= 7; x <<= 2; x |= 16; x &= 0x1c; x ^= 8; exit(x);"));
+}
+
+TEST_F(PicocBytecode, IncrementDecrement) {
+  EXPECT_EQ(20, run_both("int i = 1; int j = i++; exit(i * 10 + j - 1);"));
+  EXPECT_EQ(22, run_both("int i = 1; int j = ++i; exit(i * 10 + j);"));
+  EXPECT_EQ(0, run_both("int i = 1; int j = i--; exit(i * 10 + j - 1);"));
+  EXPECT_EQ(33, run_both("int i = 0; i++; ++i; i--; --i; i++; exit(i * 33);"));
+}
+
+TEST_F(PicocBytecode, FloatArithmetic) {
+  EXPECT_EQ(4, run_both("float x = 1.5; int y = x * 3; exit(y);"));
+  EXPECT_EQ(20, run_both("float f = 10 / 4; exit(f * 10);"));
+  EXPECT_EQ(25, run_both("float g = 10 / 4.0; exit(g * 10);"));
+  EXPECT_EQ(-7, run_both("float h = -3.5; exit(h * 2);"));
+  EXPECT_EQ(1, run_both("float a = 0.1, b = 0.2; exit(a < b && b > a && a != b && !(a == b));"));
+  EXPECT_EQ(1500, run_both("double d = 1.5e3; exit((int)d);"));
+  EXPECT_EQ(3, run_both("int i = 7; exit((int)((float)i / 2));"));
+  EXPECT_EQ(2, run_both("float x = 0; if (x) exit(1); exit(2);"));
+}
+
+TEST_F(PicocBytecode, ControlFlow) {
+  EXPECT_EQ(55, run_both("int s = 0; int i; for (i = 1; i <= 10; i++) s += i; exit(s);"));
+  EXPECT_EQ(25, run_both("int s = 0; for (int i = 0; i < 10; i++) { if (i % 2 == 0) continue; s += i; } exit(s);"));
+  EXPECT_EQ(21, run_both("int s = 0; int i = 0; while (1) { if (i > 6) break; s += i++; } exit(s);"));
+  EXPECT_EQ(1, run_both("int i = 5; do { i--; } while (i > 1); exit(i);"));
+  EXPECT_EQ(3, run_both("int i = 0; do i++; while (0); exit(i + 2);"));
+  EXPECT_EQ(100, run_both("int n = 0; for (int i = 0; i < 10; i++) for (int j = 0; j < 10; j++) n++; exit(n);"));
+  EXPECT_EQ(7, run_both("int a = 3; exit(a > 2 ? a + 4 : a - 4);"));
+  EXPECT_EQ(25, run_both("int a = 3; float f = a > 2 ? 2.5 : 1; exit(f * 10);"));
+  EXPECT_EQ(12, run_both("int a = 0; if (a) exit(11); else if (a == 0) exit(12); exit(13);"));
+}
+
+TEST_F(PicocBytecode, ShortCircuit) {
+  // TestValSet only runs when its operand is evaluated
+  EXPECT_EQ(0, run_both("#include \"system.h\"\nint f() { TestValSet(TestValGet() + 1); return 1; }\n"
+      "int a = 0 && f(); a = a || 0; exit(TestValGet() + a);"));
+  EXPECT_EQ(3, run("#include \"system.h\"\nint f() { TestValSet(TestValGet() + 1); return 1; }\n"
+      "int a = 1 && f() && f(); int b = 0 || f(); exit(TestValGet() + a + b - 2);"));
+}
+
+TEST_F(PicocBytecode, Functions) {
+  EXPECT_EQ(610, run_both("int fib(int n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } exit(fib(15));"));
+  EXPECT_EQ(9, run_both("int twice(int);\nint nine() { return twice(4) + 1; }\nint twice(int x) { return x * 2; }\nexit(nine());"));
+  EXPECT_EQ(7, run_both("int g = 0; void bump(int by) { g += by; } bump(3); bump(4); exit(g);"));
+  EXPECT_EQ(35, run_both("float scale(float x, int n) { return x * n; } exit(scale(3.5, 10));"));
+  EXPECT_EQ(5, run_both("int locals(int a) { int b = a + 1; { int c = b + 1; b = c; } return b + 2; } exit(locals(1));"));
+  EXPECT_EQ(4, run_both("int shadow = 4; int f(int shadow) { return shadow * 2; } f(1); exit(shadow);"));
+}
+
+TEST_F(PicocBytecode, Natives) {
+  picoc_host.tx_channel[0] = 1200;
+  picoc_host.tx_channel[1] = 1600;
+  picoc_host.accessory[0] = 0.25f;
+
+  EXPECT_EQ(2800, run("#include \"system.h\"\nPWMOutSet(2, TxChannelValGet(0) + TxChannelValGet(1)); exit(TxChannelValGet(0) + TxChannelValGet(1));"));
+  EXPECT_EQ(2800, picoc_host.pwm_out[2]);
+
+  EXPECT_EQ(0, run("#include \"math.h\"\n#include \"system.h\"\nAccessoryValSet(1, AccessoryValGet(0) * 2 + sinf(0));"));
+  EXPECT_FLOAT_EQ(0.5f, picoc_host.accessory[1]);
+
+  EXPECT_EQ(3, run("TestValSet(3.7); exit(TestValGet());"));
+  EXPECT_EQ(1, run("exit(sqrtf(16) == 4 && fabsf(-2) == 2);"));
+}
+
+TEST_F(PicocBytecode, Unsupported) {
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("int a = 1;\nprintf(\"%d\", a);"));
+  EXPECT_EQ(2, error_line);
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("int a[4];"));
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("int a;\nint *p = &a;"));
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("struct s { int a; };"));
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("char c = 'a';"));
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("#define X 1\nexit(X);"));
+  EXPECT_EQ(1, error_line);
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("int b;\n\n\ni2c_read(0, 0x40, b, 1);"));
+  EXPECT_EQ(4, error_line);
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("int f(int);\nexit(f(1));"));
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("exit(1.5 % 2);"));
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("break;"));
+  EXPECT_EQ(PICOC_BC_ERR_COMPILE, compile("int x = undefined;"));
+}
+
+TEST_F(PicocBytecode, RuntimeErrors) {
+  int32_t exit_value;
+
+  ASSERT_GT(compile("int zero = 0; exit(1 / zero);"), 0);
+  EXPECT_EQ(PICOC_BC_ERR_DIVIDE, picoc_bc_run(image, picoc_host_libs, stack, STACK_CELLS, &exit_value));
+
+  ASSERT_GT(compile("int forever(int n) { return forever(n + 1); } forever(0);"), 0);
+  EXPECT_EQ(PICOC_BC_ERR_STACK, picoc_bc_run(image, picoc_host_libs, stack, STACK_CELLS, &exit_value));
+
+  ASSERT_GT(compile("int a, b, c, d; exit(a + (b + (c + d)));"), 0);
+  EXPECT_EQ(PICOC_BC_ERR_STACK, picoc_bc_run(image, picoc_host_libs, stack, 6, &exit_value));
+  EXPECT_EQ(PICOC_BC_OK, picoc_bc_run(image, picoc_host_libs, stack, 8, &exit_value));
+}
+
+TEST_F(PicocBytecode, ImageValidation) {
+  const char *source = "#include \"system.h\"\nPWMOutSet(1, TxChannelValGet(1));";
+  const struct LibraryFunction *const *system_only = &picoc_host_libs[1];
+  int32_t size = compile(source);
+
+  ASSERT_GT(size, (int32_t) sizeof(struct picoc_bc_header));
+  EXPECT_EQ((uint32_t) size, picoc_bc_image_size(image));
+  EXPECT_TRUE(picoc_bc_valid(image, size, source, picoc_host_libs));
+
+  // edited script, different firmware libraries, truncated or corrupt image
+  EXPECT_FALSE(picoc_bc_valid(image, size, "PWMOutSet(1, TxChannelValGet(2));", picoc_host_libs));
+  EXPECT_FALSE(picoc_bc_valid(image, size, source, system_only));
+  EXPECT_FALSE(picoc_bc_valid(image, size - 4, source, picoc_host_libs));
+  ((uint8_t *) image)[size - 1] ^= 0x40;
+  EXPECT_FALSE(picoc_bc_valid(image, size, source, picoc_host_libs));
+
+  memset(image, 0xff, sizeof(image));
+  EXPECT_EQ(0u, picoc_bc_image_size(image));
+}
+
+/* Scripts in the style of the ones written against picoc_library.c, each
+ * running its control cycle N times */
+static const char mixer_script[] =
+  "#include \"system.h\"\n"
+  "int clamp(int v, int lo, int hi) { if (v < lo) return lo; if (v > hi) return hi; return v; }\n"
+  "int sum = 0;\n"
+  "int i;\n"
+  "for (i = 0; i < 2000; i++) {\n"
+  "  int throttle = TxChannelValGet(0);\n"
+  "  int roll = TxChannelValGet(1) - 1500;\n"
+  "  int pitch = TxChannelValGet(2) - 1500;\n"
+  "  PWMOutSet(0, clamp(throttle + roll + pitch, 1000, 2000));\n"
+  "  PWMOutSet(1, clamp(throttle - roll + pitch, 1000, 2000));\n"
+  "  PWMOutSet(2, clamp(throttle - roll - pitch, 1000, 2000));\n"
+  "  PWMOutSet(3, clamp(throttle + roll - pitch, 1000, 2000));\n"
+  "  sum += (i & 1) ? -i : i;\n"
+  "}\n"
+  "exit(sum);\n";
+
+static const char filter_script[] =
+  "#include \"math.h\"\n"
+  "#include \"system.h\"\n"
+  "float state = 0;\n"
+  "float alpha = 0.05;\n"
+  "int i;\n"
+  "for (i = 0; i < 2000; i++) {\n"
+  "  float input = AccessoryValGet(0) + 0.1 * sinf(i * 0.01);\n"
+  "  state = state + alpha * (input - state);\n"
+  "  if (fabsf(state) > 0.5) state = 0.5;\n"
+  "  AccessoryValSet(1, state);\n"
+  "}\n"
+  "exit(state * 1000);\n";
+
+static const char pid_script[] =
+  "int setpoint = 1000;\n"
+  "int measured = 0, integral = 0, last = 0;\n"
+  "int i;\n"
+  "for (i = 0; i < 2000; i++) {\n"
+  "  int error = setpoint - measured;\n"
+  "  integral += error;\n"
+  "  if (integral > 100000) integral = 100000; else if (integral < -100000) integral = -100000;\n"
+  "  int output = (error * 40 + integral / 8 + (error - last) * 10) / 100;\n"
+  "  last = error;\n"
+  "  measured += output / 4;\n"
+  "}\n"
+  "exit(measured);\n";
+
+class PicocBenchmark : public PicocBytecode {
+protected:
+  void benchmark(const char *name, const char *source, int32_t tolerance) {
+    int32_t exit_value = 0;
+
+    uint64_t start = now_ns();
+    int32_t interpreted = picoc(source, INTERPRETER_STACK);
+    uint64_t interpreter_ns = now_ns() - start;
+
+    start = now_ns();
+    int32_t size = compile(source);
+    uint64_t compile_ns = now_ns() - start;
+    ASSERT_GT(size, 0) << "gave up on line " << error_line;
+
+    start = now_ns();
+    ASSERT_EQ(PICOC_BC_OK, picoc_bc_run(image, picoc_host_libs, stack, STACK_CELLS, &exit_value));
+    uint64_t run_ns = now_ns() - start;
+
+    // floats are single precision in the machine, double in the interpreter
+    EXPECT_NEAR(interpreted, exit_value, tolerance);
+
+    double speedup = (double) interpreter_ns / run_ns;
+    printf("%-7s %5d byte image, interpreter %8.1f us, compile %6.1f us, bytecode %7.1f us, %5.1fx\n",
+        name, size, interpreter_ns / 1e3, compile_ns / 1e3, run_ns / 1e3, speedup);
+  }
+};
+
+TEST_F(PicocBenchmark, Mixer) {
+  picoc_host.tx_channel[0] = 1400;
+  picoc_host.tx_channel[1] = 1550;
+  picoc_host.tx_channel[2] = 1480;
+
+  benchmark("mixer", mixer_script, 0);
+  EXPECT_EQ(1430, picoc_host.pwm_out[0]);
+  EXPECT_EQ(1370, picoc_host.pwm_out[2]);
+}
+
+TEST_F(PicocBenchmark, Filter) {
+  picoc_host.accessory[0] = 0.3f;
+
+  benchmark("filter", filter_script, 1);
+  EXPECT_NEAR(0.3f, picoc_host.accessory[1], 0.1f);
+}
+
+TEST_F(PicocBenchmark, Pid) {
+  benchmark("pid", pid_script, 0);
+}
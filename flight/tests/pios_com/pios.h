@@ -0,0 +1,16 @@
+/* Just enough of pios.h to build pios_com.c on the host */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIOS_INCLUDE_COM
+
+#define PIOS_Assert(test) do { if (!(test)) abort(); } while (0)
+
+void * PIOS_malloc(size_t size);
+
+#include "pios_com.h"
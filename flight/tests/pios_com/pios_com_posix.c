@@ -0,0 +1,17 @@
+#include <stdlib.h>
+#include <sched.h>
+
+#include "pios.h"
+#include "pios_delay.h"
+
+void * PIOS_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+/* The producer runs in its own thread, let it get on with it */
+int32_t PIOS_DELAY_WaitmS(uint32_t mS)
+{
+	sched_yield();
+	return 0;
+}
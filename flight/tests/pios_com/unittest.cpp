@@ -0,0 +1,320 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock_gettime */
+#include <pthread.h>		/* pthread_create */
+
+extern "C" {
+
+#include "pios.h"
+#include "pios_com_priv.h"
+
+}
+
+#define RX_BUFFER_LEN 256u
+#define BENCH_BYTES (32u * 1024u * 1024u)
+#define BENCH_COPY_LEN 64u
+
+/* A receive only driver, the tests push bytes in through its callback */
+static pios_com_callback rx_in_cb;
+static uintptr_t rx_in_context;
+static uint32_t rx_starts;
+static uint16_t rx_start_avail;
+
+static void fake_rx_start(uintptr_t, uint16_t rx_bytes_avail)
+{
+  rx_starts++;
+  rx_start_avail = rx_bytes_avail;
+}
+
+static void fake_bind_rx_cb(uintptr_t, pios_com_callback rx_in, uintptr_t context)
+{
+  rx_in_cb = rx_in;
+  rx_in_context = context;
+}
+
+static const struct pios_com_driver fake_com_driver = {
+  NULL,			/* init */
+  NULL,			/* set_baud */
+  NULL,			/* tx_start */
+  fake_rx_start,
+  fake_bind_rx_cb,
+  NULL,			/* bind_tx_cb */
+  NULL,			/* available */
+};
+
+static uint8_t pattern(uint32_t pos)
+{
+  return (uint8_t)(pos * 131u + (pos >> 9));
+}
+
+/* Like a flow controlled USB endpoint: nothing is dropped, the sender retries */
+static uint32_t push(uint32_t pos, uint16_t len, uint32_t *stalls)
+{
+  uint8_t buf[64];
+  uint16_t headroom;
+  bool need_yield;
+
+  for (uint16_t i = 0; i < len; i++)
+    buf[i] = pattern(pos + i);
+
+  uint16_t done = 0;
+  while (done < len) {
+    uint16_t n = rx_in_cb(rx_in_context, buf + done, len - done, &headroom, &need_yield);
+    if (n == 0) {
+      if (stalls)
+        (*stalls)++;
+      sched_yield();
+    }
+    done += n;
+  }
+
+  return pos + len;
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class ComLend : public testing::Test {
+protected:
+  virtual void SetUp() {
+    rx_starts = 0;
+    ASSERT_EQ(0, PIOS_COM_Init(&com_id, &fake_com_driver, 0, rx_buffer, sizeof(rx_buffer), NULL, 0));
+    ASSERT_TRUE(rx_in_cb != NULL);
+  }
+
+  virtual void TearDown() {
+  }
+
+  uintptr_t com_id;
+  uint8_t rx_buffer[RX_BUFFER_LEN];
+};
+
+TEST_F(ComLend, NothingBuffered) {
+  const uint8_t *buf = NULL;
+
+  EXPECT_EQ(0, PIOS_COM_LendRxBuffer(com_id, &buf, 0));
+  EXPECT_GT(rx_starts, 0u);
+}
+
+TEST_F(ComLend, LendsInPlace) {
+  const uint8_t *buf = NULL;
+  uint32_t pos = push(0, 40, NULL);
+
+  ASSERT_EQ(40, PIOS_COM_LendRxBuffer(com_id, &buf, 0));
+  EXPECT_TRUE(buf >= rx_buffer && buf < rx_buffer + sizeof(rx_buffer));
+  for (uint32_t i = 0; i < 40; i++)
+    EXPECT_EQ(pattern(i), buf[i]);
+
+  // Lending again without a release gives the same bytes
+  const uint8_t *again = NULL;
+  EXPECT_EQ(40, PIOS_COM_LendRxBuffer(com_id, &again, 0));
+  EXPECT_EQ(buf, again);
+
+  // Only what is released is consumed
+  PIOS_COM_ReleaseRxBuffer(com_id, 10);
+  ASSERT_EQ(30, PIOS_COM_LendRxBuffer(com_id, &buf, 0));
+  EXPECT_EQ(pattern(10), buf[0]);
+
+  // Releasing tells the driver how much room there is
+  rx_starts = 0;
+  PIOS_COM_ReleaseRxBuffer(com_id, 30);
+  EXPECT_EQ(1u, rx_starts);
+  EXPECT_EQ(RX_BUFFER_LEN - 1, rx_start_avail);
+  EXPECT_EQ(0, PIOS_COM_LendRxBuffer(com_id, &buf, 0));
+  EXPECT_EQ(40u, pos);
+}
+
+TEST_F(ComLend, WrapsAround) {
+  const uint8_t *buf = NULL;
+  uint32_t pos = 0;
+
+  // Move the read position close to the end of the ring
+  while (pos < RX_BUFFER_LEN - 20) {
+    pos = push(pos, 60, NULL);
+    uint16_t len = PIOS_COM_LendRxBuffer(com_id, &buf, 0);
+    PIOS_COM_ReleaseRxBuffer(com_id, len);
+  }
+  ASSERT_EQ(0, PIOS_COM_LendRxBuffer(com_id, &buf, 0));
+
+  uint32_t start = pos;
+  pos = push(pos, 60, NULL);
+
+  // The bytes come in two pieces, each contiguous
+  uint32_t got = 0;
+  int pieces = 0;
+  while (got < 60) {
+    uint16_t len = PIOS_COM_LendRxBuffer(com_id, &buf, 0);
+    ASSERT_GT(len, 0);
+    for (uint16_t i = 0; i < len; i++)
+      ASSERT_EQ(pattern(start + got + i), buf[i]);
+    PIOS_COM_ReleaseRxBuffer(com_id, len);
+    got += len;
+    pieces++;
+  }
+  EXPECT_EQ(60u, got);
+  EXPECT_EQ(2, pieces);
+}
+
+/*
+ * Sustained throughput with the producer in its own thread, every byte must
+ * arrive exactly once and in order.
+ */
+struct producer_args {
+  uint32_t stalls;
+  double elapsed;
+};
+
+static void *producer(void *arg)
+{
+  struct producer_args *args = (struct producer_args *)arg;
+  uint32_t pos = 0;
+  uint32_t n = 0;
+
+  while (pos < BENCH_BYTES) {
+    uint16_t len = 1 + (n++ * 37) % 64;
+    if (len > BENCH_BYTES - pos)
+      len = BENCH_BYTES - pos;
+    pos = push(pos, len, &args->stalls);
+  }
+
+  return NULL;
+}
+
+class ComLendStream : public ComLend {
+protected:
+  /* Consume the whole stream, returns the number of bytes out of order */
+  uint32_t Consume(bool lend, double *elapsed, uint32_t *stalls) {
+    struct producer_args args;
+    pthread_t thread;
+    uint32_t pos = 0;
+    uint32_t bad = 0;
+
+    memset(&args, 0, sizeof(args));
+    double start = now();
+    EXPECT_EQ(0, pthread_create(&thread, NULL, producer, &args));
+
+    while (pos < BENCH_BYTES) {
+      if (lend) {
+        const uint8_t *buf;
+        uint16_t len = PIOS_COM_LendRxBuffer(com_id, &buf, 500);
+        for (uint16_t i = 0; i < len; i++)
+          bad += buf[i] != pattern(pos + i);
+        PIOS_COM_ReleaseRxBuffer(com_id, len);
+        pos += len;
+      } else {
+        uint8_t buf[BENCH_COPY_LEN];
+        uint16_t len = PIOS_COM_ReceiveBuffer(com_id, buf, sizeof(buf), 500);
+        for (uint16_t i = 0; i < len; i++)
+          bad += buf[i] != pattern(pos + i);
+        pos += len;
+      }
+    }
+
+    pthread_join(thread, NULL);
+    *elapsed = now() - start;
+    *stalls = args.stalls;
+
+    const uint8_t *buf;
+    EXPECT_EQ(0, PIOS_COM_LendRxBuffer(com_id, &buf, 0));
+    EXPECT_EQ(BENCH_BYTES, pos);
+    return bad;
+  }
+};
+
+TEST_F(ComLendStream, NoDataLoss) {
+  double copy_time, lend_time;
+  uint32_t copy_stalls, lend_stalls;
+
+  EXPECT_EQ(0u, Consume(false, &copy_time, &copy_stalls));
+  EXPECT_EQ(0u, Consume(true, &lend_time, &lend_stalls));
+
+  fprintf(stdout, "copy %u byte chunks: %.1f MB/s end to end, producer stalled %u times\n",
+    BENCH_COPY_LEN, BENCH_BYTES / copy_time / 1e6, copy_stalls);
+  fprintf(stdout, "lend in place:       %.1f MB/s end to end, producer stalled %u times\n",
+    BENCH_BYTES / lend_time / 1e6, lend_stalls);
+}
+
+/* Time spent by the consumer alone, draining a full receive buffer */
+TEST_F(ComLend, DrainCost) {
+  uint8_t chunk[64];
+  uint16_t headroom;
+  bool need_yield;
+  double copy_time = 0, lend_time = 0;
+  uint32_t copy_sum = 0, lend_sum = 0;
+
+  memset(chunk, 0x5a, sizeof(chunk));
+
+  for (uint32_t round = 0; round < BENCH_BYTES / RX_BUFFER_LEN; round++) {
+    bool lend = round & 1;
+
+    while (rx_in_cb(rx_in_context, chunk, sizeof(chunk), &headroom, &need_yield) > 0)
+      ;
+
+    double start = now();
+    if (lend) {
+      const uint8_t *buf;
+      uint16_t len;
+      while ((len = PIOS_COM_LendRxBuffer(com_id, &buf, 0)) > 0) {
+        for (uint16_t i = 0; i < len; i++)
+          lend_sum += buf[i];
+        PIOS_COM_ReleaseRxBuffer(com_id, len);
+      }
+      lend_time += now() - start;
+    } else {
+      uint8_t buf[BENCH_COPY_LEN];
+      uint16_t len;
+      while ((len = PIOS_COM_ReceiveBuffer(com_id, buf, sizeof(buf), 0)) > 0) {
+        for (uint16_t i = 0; i < len; i++)
+          copy_sum += buf[i];
+      }
+      copy_time += now() - start;
+    }
+  }
+
+  EXPECT_EQ(copy_sum, lend_sum);
+
+  fprintf(stdout, "drain by copy: %.1f MB/s\n", copy_sum / 0x5a / copy_time / 1e6);
+  fprintf(stdout, "drain by lend: %.1f MB/s\n", lend_sum / 0x5a / lend_time / 1e6);
+}
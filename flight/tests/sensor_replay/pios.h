@@ -0,0 +1,13 @@
+/* Just enough of pios.h to build pios_sensors.c on the host */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIOS_INCLUDE_IRQ
+
+#define PIOS_Assert(test) do { if (!(test)) abort(); } while (0)
+
+#include "pios_delay.h"
+#include "pios_irq.h"
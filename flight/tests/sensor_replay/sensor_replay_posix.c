@@ -0,0 +1,70 @@
+#include <stdlib.h>
+
+#include "pios.h"
+#include "pios_heap.h"
+#include "pios_semaphore.h"
+
+/* The test drives time itself, one raw tick per microsecond */
+uint32_t sim_time_us;
+
+uint32_t PIOS_DELAY_GetRaw()
+{
+	return sim_time_us;
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+	return sim_time_us - raw;
+}
+
+uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later)
+{
+	return later - raw;
+}
+
+/* Rings are published from interrupt handlers, they must leave the interrupt state alone */
+int32_t PIOS_IRQ_Disable(void)
+{
+	abort();
+}
+
+int32_t PIOS_IRQ_Enable(void)
+{
+	abort();
+}
+
+void * PIOS_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+void PIOS_free(void * buf)
+{
+	free(buf);
+}
+
+struct pios_semaphore *PIOS_Semaphore_Create(void)
+{
+	return calloc(1, sizeof(struct pios_semaphore));
+}
+
+bool PIOS_Semaphore_Take(struct pios_semaphore *sema, uint32_t timeout_ms)
+{
+	if (sema->sema_count == 0)
+		return false;
+
+	sema->sema_count = 0;
+	return true;
+}
+
+bool PIOS_Semaphore_Give(struct pios_semaphore *sema)
+{
+	sema->sema_count = 1;
+	return true;
+}
+
+bool PIOS_Semaphore_Give_FromISR(struct pios_semaphore *sema, bool *woken)
+{
+	*woken = true;
+	return PIOS_Semaphore_Give(sema);
+}
@@ -0,0 +1,364 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <math.h>		/* sinf */
+
+extern "C" {
+
+#include "pios.h"
+#include "pios_sensors.h"
+#include "coordinate_conversions.h"
+#include "sample_clock.h"
+#include "physical_constants.h"
+
+extern uint32_t sim_time_us;
+
+}
+
+#define SAMPLE_PERIOD_US 1000u
+#define TASK_PERIOD_US 2000u
+#define RING_DEPTH 16
+#define REPLAY_SECONDS 20
+
+// To use a test fixture, derive a class from testing::Test.
+class SensorReplay : public testing::Test {
+protected:
+  virtual void SetUp() {
+    sim_time_us = 0;
+    seed = 12345;
+
+    ring = PIOS_SENSORS_RingCreate(sizeof(struct pios_sensor_gyro_data), RING_DEPTH);
+    ASSERT_TRUE(ring != NULL);
+  }
+
+  /* Deterministic jitter so every run replays the same schedule */
+  uint32_t Random(uint32_t range) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 8) % range;
+  }
+
+  /* A tumbling vehicle, rates in deg/s */
+  static void TrueRates(uint32_t t_us, float rates[3]) {
+    float t = t_us * 1.0e-6f;
+    rates[0] = 300.0f * sinf(2 * PI * 2.1f * t);
+    rates[1] = 200.0f * cosf(2 * PI * 3.3f * t);
+    rates[2] = 250.0f * sinf(2 * PI * 1.7f * t + 0.5f);
+  }
+
+  static float AttitudeError(const float q_est[4], const float q_true[4]) {
+    float q_inv[4], q_err[4];
+    quat_copy(q_est, q_inv);
+    quat_inverse(q_inv);
+    quat_mult(q_inv, q_true, q_err);
+    return 2 * acosf(fminf(fabsf(q_err[0]), 1.0f)) * RAD2DEG;
+  }
+
+  struct pios_sensor_ring *ring;
+  uint32_t seed;
+};
+
+TEST_F(SensorReplay, TimestampsSurviveTheRing) {
+  struct pios_sensor_gyro_data samples[4];
+  uint32_t stamps[4] = { 100, 1100, 2100, 3100 };
+
+  for (uint32_t i = 0; i < 4; i++)
+    samples[i].x = i;
+
+  EXPECT_EQ(4, PIOS_SENSORS_Publish(ring, samples, stamps, 4));
+
+  struct pios_sensor_gyro_data out[RING_DEPTH];
+  uint32_t out_stamps[RING_DEPTH];
+  ASSERT_EQ(4, PIOS_SENSORS_Drain(ring, out, out_stamps, RING_DEPTH));
+
+  for (uint32_t i = 0; i < 4; i++) {
+    EXPECT_EQ(stamps[i], out_stamps[i]);
+    EXPECT_EQ((float) i, out[i].x);
+  }
+}
+
+static uint16_t tap_count;
+static float tap_last_x;
+static uint32_t tap_last_stamp;
+
+static void Tap(const void *samples, const uint32_t *timestamps, uint16_t count)
+{
+  const struct pios_sensor_gyro_data *gyros = (const struct pios_sensor_gyro_data *) samples;
+
+  tap_count += count;
+  tap_last_x = gyros[count - 1].x;
+  tap_last_stamp = timestamps[count - 1];
+}
+
+TEST_F(SensorReplay, TapSeesDrainedBursts) {
+  struct pios_sensor_gyro_data samples[3];
+  uint32_t stamps[3] = { 10, 20, 30 };
+
+  for (uint32_t i = 0; i < 3; i++)
+    samples[i].x = i + 1;
+
+  tap_count = 0;
+  EXPECT_EQ(-1, PIOS_SENSORS_SetTap(NULL, Tap));
+  EXPECT_EQ(0, PIOS_SENSORS_SetTap(ring, Tap));
+
+  // Nothing drained, nothing tapped
+  struct pios_sensor_gyro_data out[RING_DEPTH];
+  uint32_t out_stamps[RING_DEPTH];
+  EXPECT_EQ(0, PIOS_SENSORS_Drain(ring, out, out_stamps, RING_DEPTH));
+  EXPECT_EQ(0, tap_count);
+
+  PIOS_SENSORS_Publish(ring, samples, stamps, 3);
+  ASSERT_EQ(3, PIOS_SENSORS_Drain(ring, out, out_stamps, RING_DEPTH));
+  EXPECT_EQ(3, tap_count);
+  EXPECT_EQ(3.0f, tap_last_x);
+  EXPECT_EQ(30u, tap_last_stamp);
+
+  // Removing the tap leaves the consumer untouched
+  EXPECT_EQ(0, PIOS_SENSORS_SetTap(ring, NULL));
+  PIOS_SENSORS_Publish(ring, samples, stamps, 1);
+  EXPECT_EQ(1, PIOS_SENSORS_Drain(ring, out, out_stamps, RING_DEPTH));
+  EXPECT_EQ(3, tap_count);
+}
+
+TEST_F(SensorReplay, UnstampedSamplesGetPublishTime) {
+  struct pios_sensor_gyro_data sample = { 0 };
+  uint32_t stamp;
+
+  sim_time_us = 4242;
+  EXPECT_EQ(1, PIOS_SENSORS_Publish(ring, &sample, NULL, 1));
+
+  sim_time_us = 9000;
+  ASSERT_EQ(1, PIOS_SENSORS_Drain(ring, &sample, &stamp, 1));
+  EXPECT_EQ(4242u, stamp);
+}
+
+TEST_F(SensorReplay, RingWrapsAround) {
+  struct pios_sensor_gyro_data out[RING_DEPTH];
+  uint32_t out_stamps[RING_DEPTH];
+  uint32_t next_in = 0;
+  uint32_t next_out = 0;
+
+  // Bursts that do not divide the depth end up straddling the end of the buffer
+  for (uint32_t round = 0; round < 10; round++) {
+    for (uint32_t i = 0; i < 7; i++) {
+      struct pios_sensor_gyro_data sample = { 0 };
+      sample.x = next_in;
+      ASSERT_EQ(1, PIOS_SENSORS_Publish(ring, &sample, &next_in, 1));
+      next_in++;
+    }
+
+    uint16_t count = PIOS_SENSORS_Drain(ring, out, out_stamps, RING_DEPTH);
+    ASSERT_EQ(7, count);
+    for (uint16_t i = 0; i < count; i++) {
+      EXPECT_EQ((float) next_out, out[i].x);
+      EXPECT_EQ(next_out, out_stamps[i]);
+      next_out++;
+    }
+  }
+
+  EXPECT_EQ(0u, PIOS_SENSORS_GetOverruns(ring));
+}
+
+TEST_F(SensorReplay, FullRingDropsAndCounts) {
+  struct pios_sensor_gyro_data samples[RING_DEPTH + 5];
+  uint32_t stamps[RING_DEPTH + 5];
+
+  for (uint32_t i = 0; i < RING_DEPTH + 5; i++) {
+    samples[i].x = i;
+    stamps[i] = i;
+  }
+
+  // The oldest samples are kept, the ones that do not fit are dropped
+  EXPECT_EQ(RING_DEPTH, PIOS_SENSORS_Publish(ring, samples, stamps, RING_DEPTH + 5));
+  EXPECT_EQ(5u, PIOS_SENSORS_GetOverruns(ring));
+  EXPECT_EQ(0, PIOS_SENSORS_Publish(ring, samples, stamps, 2));
+  EXPECT_EQ(7u, PIOS_SENSORS_GetOverruns(ring));
+
+  struct pios_sensor_gyro_data out[RING_DEPTH];
+  uint32_t out_stamps[RING_DEPTH];
+  ASSERT_EQ(RING_DEPTH, PIOS_SENSORS_Drain(ring, out, out_stamps, RING_DEPTH));
+  EXPECT_EQ(0.0f, out[0].x);
+  EXPECT_EQ((float) (RING_DEPTH - 1), out[RING_DEPTH - 1].x);
+  EXPECT_EQ(RING_DEPTH - 1u, out_stamps[RING_DEPTH - 1]);
+
+  // Drained, there is room again and the count of drops stays
+  EXPECT_EQ(3, PIOS_SENSORS_Publish(ring, samples, stamps, 3));
+  EXPECT_EQ(7u, PIOS_SENSORS_GetOverruns(ring));
+}
+
+TEST_F(SensorReplay, DrainTakesAtMostMaxCount) {
+  struct pios_sensor_gyro_data samples[10];
+  uint32_t stamps[10];
+
+  for (uint32_t i = 0; i < 10; i++) {
+    samples[i].x = i;
+    stamps[i] = 100 + i;
+  }
+  EXPECT_EQ(10, PIOS_SENSORS_Publish(ring, samples, stamps, 10));
+  EXPECT_TRUE(PIOS_SENSORS_RingWait(ring, 0));
+
+  struct pios_sensor_gyro_data out[RING_DEPTH];
+  uint32_t out_stamps[RING_DEPTH];
+  ASSERT_EQ(4, PIOS_SENSORS_Drain(ring, out, out_stamps, 4));
+  EXPECT_EQ(3.0f, out[3].x);
+  EXPECT_EQ(103u, out_stamps[3]);
+
+  // The timestamps can be left out
+  ASSERT_EQ(6, PIOS_SENSORS_Drain(ring, out, NULL, RING_DEPTH));
+  EXPECT_EQ(4.0f, out[0].x);
+  EXPECT_EQ(9.0f, out[5].x);
+
+  EXPECT_EQ(0, PIOS_SENSORS_Drain(ring, out, out_stamps, RING_DEPTH));
+  EXPECT_FALSE(PIOS_SENSORS_RingWait(ring, 0));
+}
+
+TEST_F(SensorReplay, PublishFromISR) {
+  struct pios_sensor_gyro_data samples[RING_DEPTH + 1];
+  uint32_t stamps[RING_DEPTH + 1];
+  bool woken = false;
+
+  for (uint32_t i = 0; i < RING_DEPTH + 1; i++) {
+    samples[i].x = i;
+    stamps[i] = i;
+  }
+
+  // The stubs abort if the ring touches the interrupt state
+  EXPECT_EQ(RING_DEPTH, PIOS_SENSORS_PublishFromISR(ring, samples, stamps, RING_DEPTH + 1, &woken));
+  EXPECT_TRUE(woken);
+  EXPECT_EQ(1u, PIOS_SENSORS_GetOverruns(ring));
+
+  struct pios_sensor_gyro_data out[RING_DEPTH];
+  ASSERT_EQ(RING_DEPTH, PIOS_SENSORS_Drain(ring, out, NULL, RING_DEPTH));
+  EXPECT_EQ((float) (RING_DEPTH - 1), out[RING_DEPTH - 1].x);
+}
+
+/*
+ * Replay a 1 kHz gyro into a consumer that wakes late by a random amount
+ * and now and then stalls for several samples, the way the attitude task
+ * does when higher priority work gets in. The same bursts are integrated
+ * once with the time between wakeups and once with the time between the
+ * capture stamps of the last sample in each burst.
+ */
+TEST_F(SensorReplay, SampleClockFallsBackToCallTime) {
+  struct sample_clock clock;
+
+  sim_time_us = 1000;
+  sample_clock_reset(&clock);
+
+  // The first sample after a reset is timed from the reset
+  sim_time_us = 3500;
+  EXPECT_FLOAT_EQ(2.5e-3f, sample_clock_dT(&clock, 3000));
+
+  // Then from the capture times, however late the task runs
+  sim_time_us = 9000;
+  EXPECT_FLOAT_EQ(1.0e-3f, sample_clock_dT(&clock, 4000));
+
+  // A capture time that does not move, or jumps too far, is not trusted
+  sim_time_us = 11000;
+  EXPECT_FLOAT_EQ(2.0e-3f, sample_clock_dT(&clock, 4000));
+  sim_time_us = 12000;
+  EXPECT_FLOAT_EQ(1.0e-3f, sample_clock_dT(&clock, 4000 + 1000000));
+}
+
+TEST_F(SensorReplay, CaptureTimeBeatsJitter) {
+  float q_true[4] = { 1, 0, 0, 0 };
+  float q_wake[4] = { 1, 0, 0, 0 };
+  float q_capture[4] = { 1, 0, 0, 0 };
+
+  uint32_t next_sample_us = SAMPLE_PERIOD_US;
+
+  // The attitude filter's clock, and one that never has a capture time
+  // as for a gyro without timestamps
+  struct sample_clock capture_clock;
+  struct sample_clock wake_clock;
+  sample_clock_reset(&capture_clock);
+  sample_clock_reset(&wake_clock);
+
+  // The true attitude starts with a sample captured at time zero
+  sample_clock_dT(&capture_clock, 0);
+
+  float max_wake_error = 0;
+  float max_capture_error = 0;
+
+  for (uint32_t n = 1; n <= REPLAY_SECONDS * 1000000 / TASK_PERIOD_US; n++) {
+    uint32_t wake_us = n * TASK_PERIOD_US + Random(TASK_PERIOD_US / 2);
+    if (Random(50) == 0)
+      wake_us += 5 * SAMPLE_PERIOD_US;
+    if (wake_us <= sim_time_us)
+      wake_us = sim_time_us + 1;
+
+    // The driver publishes every sample captured before the task runs
+    while (next_sample_us <= wake_us) {
+      struct pios_sensor_gyro_data sample;
+      TrueRates(next_sample_us - SAMPLE_PERIOD_US / 2, &sample.x);
+      ASSERT_EQ(1, PIOS_SENSORS_Publish(ring, &sample, &next_sample_us, 1));
+
+      quat_integrate(q_true, &sample.x, SAMPLE_PERIOD_US * 1.0e-6f);
+      next_sample_us += SAMPLE_PERIOD_US;
+    }
+    sim_time_us = wake_us;
+
+    struct pios_sensor_gyro_data burst[RING_DEPTH];
+    uint32_t stamps[RING_DEPTH];
+    uint16_t count = PIOS_SENSORS_Drain(ring, burst, stamps, RING_DEPTH);
+    if (count == 0)
+      continue;
+
+    float rates[3] = { 0, 0, 0 };
+    for (uint16_t i = 0; i < count; i++) {
+      rates[0] += burst[i].x / count;
+      rates[1] += burst[i].y / count;
+      rates[2] += burst[i].z / count;
+    }
+
+    quat_integrate(q_wake, rates, sample_clock_dT(&wake_clock, 0));
+    quat_integrate(q_capture, rates, sample_clock_dT(&capture_clock, stamps[count - 1]));
+
+    // Compare whenever both estimates have seen every published sample
+    max_wake_error = fmaxf(max_wake_error, AttitudeError(q_wake, q_true));
+    max_capture_error = fmaxf(max_capture_error, AttitudeError(q_capture, q_true));
+  }
+
+  EXPECT_EQ(0u, PIOS_SENSORS_GetOverruns(ring));
+
+  printf("Max attitude error: %.3f deg from wakeup time, %.3f deg from capture time\n",
+         (double) max_wake_error, (double) max_capture_error);
+
+  EXPECT_LT(max_capture_error, 1.0f);
+  EXPECT_LT(max_capture_error * 4, max_wake_error);
+}
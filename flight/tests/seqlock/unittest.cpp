@@ -0,0 +1,181 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <pthread.h>		/* pthread_* */
+
+extern "C" {
+
+#include "seqlock.h"
+
+}
+
+/* About the size of the stabilization rate setpoints */
+#define HANDOFF_WORDS 32
+#define HANDOFF_WRITES 200000
+#define HANDOFF_READERS 2
+#define HANDOFF_TRIES 3
+
+struct handoff {
+  volatile uint32_t seq;
+  uint32_t data[HANDOFF_WORDS];
+  volatile bool done;
+  uint32_t reads;
+  uint32_t misses;
+  uint32_t torn;
+  uint32_t backwards;
+};
+
+// To use a test fixture, derive a class from testing::Test.
+class Seqlock : public testing::Test {
+protected:
+  virtual void SetUp() {
+    memset(&handoff, 0, sizeof(handoff));
+  }
+
+  virtual void TearDown() {
+  }
+
+  struct handoff handoff;
+};
+
+static void publish(struct handoff *handoff, uint32_t value)
+{
+  seqlock_write_begin(&handoff->seq);
+  for (uint32_t i = 0; i < HANDOFF_WORDS; i++) {
+    handoff->data[i] = value;
+  }
+  seqlock_write_end(&handoff->seq);
+}
+
+TEST_F(Seqlock, ReadAfterWrite) {
+  uint32_t out[HANDOFF_WORDS];
+
+  publish(&handoff, 7);
+  EXPECT_EQ(2u, handoff.seq);
+
+  ASSERT_TRUE(seqlock_read(&handoff.seq, out, handoff.data, sizeof(out), HANDOFF_TRIES));
+  for (uint32_t i = 0; i < HANDOFF_WORDS; i++) {
+    EXPECT_EQ(7u, out[i]);
+  }
+}
+
+TEST_F(Seqlock, ReadDuringWriteFails) {
+  uint32_t out[HANDOFF_WORDS];
+
+  publish(&handoff, 1);
+
+  /* A reader that preempted the writer gives up instead of waiting */
+  seqlock_write_begin(&handoff.seq);
+  handoff.data[0] = 2;
+  EXPECT_FALSE(seqlock_read(&handoff.seq, out, handoff.data, sizeof(out), HANDOFF_TRIES));
+  seqlock_write_end(&handoff.seq);
+
+  EXPECT_TRUE(seqlock_read(&handoff.seq, out, handoff.data, sizeof(out), HANDOFF_TRIES));
+}
+
+static void *handoff_writer(void *arg)
+{
+  struct handoff *handoff = (struct handoff *)arg;
+
+  for (uint32_t n = 1; n <= HANDOFF_WRITES; n++) {
+    publish(handoff, n);
+  }
+  handoff->done = true;
+
+  return NULL;
+}
+
+static void *handoff_reader(void *arg)
+{
+  struct handoff *handoff = (struct handoff *)arg;
+  uint32_t out[HANDOFF_WORDS];
+  uint32_t last = 0;
+  uint32_t reads = 0;
+  uint32_t misses = 0;
+  uint32_t torn = 0;
+  uint32_t backwards = 0;
+
+  while (!handoff->done) {
+    if (!seqlock_read(&handoff->seq, out, handoff->data, sizeof(out), HANDOFF_TRIES)) {
+      misses++;
+      continue;
+    }
+    reads++;
+
+    for (uint32_t i = 1; i < HANDOFF_WORDS; i++) {
+      if (out[i] != out[0]) {
+        torn++;
+        break;
+      }
+    }
+
+    if (out[0] < last)
+      backwards++;
+    last = out[0];
+  }
+
+  __sync_fetch_and_add(&handoff->reads, reads);
+  __sync_fetch_and_add(&handoff->misses, misses);
+  __sync_fetch_and_add(&handoff->torn, torn);
+  __sync_fetch_and_add(&handoff->backwards, backwards);
+
+  return NULL;
+}
+
+TEST_F(Seqlock, HandoffStress) {
+  pthread_t writer;
+  pthread_t readers[HANDOFF_READERS];
+
+  for (uint32_t i = 0; i < HANDOFF_READERS; i++) {
+    ASSERT_EQ(0, pthread_create(&readers[i], NULL, handoff_reader, &handoff));
+  }
+  ASSERT_EQ(0, pthread_create(&writer, NULL, handoff_writer, &handoff));
+
+  pthread_join(writer, NULL);
+  for (uint32_t i = 0; i < HANDOFF_READERS; i++) {
+    pthread_join(readers[i], NULL);
+  }
+
+  fprintf(stdout, "%u writes, %u reads, %u given up, %u torn\n",
+    HANDOFF_WRITES, handoff.reads, handoff.misses, handoff.torn);
+  EXPECT_LT(0u, handoff.reads);
+  EXPECT_EQ(0u, handoff.torn);
+  EXPECT_EQ(0u, handoff.backwards);
+  EXPECT_EQ(2u * HANDOFF_WRITES, handoff.seq);
+}
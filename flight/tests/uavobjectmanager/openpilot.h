@@ -0,0 +1,17 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pios_heap.h"
+#include "pios_flashfs.h"
+#include "utlist.h"
+#include "uavobjectmanager.h"
+#include "eventdispatcher.h"
+
+/* Would be from pios_thread.h but that file requires an RTOS to be selected */
+uint32_t PIOS_Thread_Systime(void);
+
+#define PIOS_Assert(x) if (!(x)) { while (1) ; }
+#define PIOS_DEBUG_Assert(x) PIOS_Assert(x)
+
+#define NELEMENTS(x) (sizeof(x) / sizeof(*(x)))
@@ -0,0 +1,142 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "openpilot.h"
+#include "pios_mutex.h"
+
+uintptr_t pios_uavo_settings_fs_id;
+
+/* Lets tests check whether a code path took the object manager lock */
+volatile uint32_t pios_ut_mutex_lock_count;
+
+struct pios_recursive_mutex {
+	pthread_mutex_t mtx;
+};
+
+struct pios_recursive_mutex *PIOS_Recursive_Mutex_Create(void)
+{
+	struct pios_recursive_mutex *mtx = malloc(sizeof(*mtx));
+	pthread_mutexattr_t attr;
+
+	if (mtx == NULL)
+		return NULL;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&mtx->mtx, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	return mtx;
+}
+
+bool PIOS_Recursive_Mutex_Lock(struct pios_recursive_mutex *mtx, uint32_t timeout_ms)
+{
+	__sync_fetch_and_add(&pios_ut_mutex_lock_count, 1);
+
+	return pthread_mutex_lock(&mtx->mtx) == 0;
+}
+
+bool PIOS_Recursive_Mutex_Unlock(struct pios_recursive_mutex *mtx)
+{
+	return pthread_mutex_unlock(&mtx->mtx) == 0;
+}
+
+void * PIOS_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+void * PIOS_malloc_no_dma(size_t size)
+{
+	return malloc(size);
+}
+
+void PIOS_free(void * buf)
+{
+	free(buf);
+}
+
+bool PIOS_Queue_Send(struct pios_queue *queuep, const void *itemp, uint32_t timeout_ms)
+{
+	return true;
+}
+
+int32_t EventCallbackDispatch(UAVObjEvent* ev, UAVObjEventCallback cb)
+{
+	return 0;
+}
+
+uint32_t PIOS_Thread_Systime(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Called in the middle of every flash access, to change objects meanwhile */
+void (*pios_ut_flash_hook)(void);
+
+/* The last object saved, the only one that can be loaded back */
+uint32_t pios_ut_saved_obj_id;
+uint16_t pios_ut_saved_inst_id;
+uint16_t pios_ut_saved_size;
+uint8_t pios_ut_saved_data[256];
+
+int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t * obj_data, uint16_t obj_size)
+{
+	if (pios_ut_flash_hook)
+		pios_ut_flash_hook();
+
+	if (obj_size <= sizeof(pios_ut_saved_data)) {
+		pios_ut_saved_obj_id = obj_id;
+		pios_ut_saved_inst_id = obj_inst_id;
+		pios_ut_saved_size = obj_size;
+		memcpy(pios_ut_saved_data, obj_data, obj_size);
+	}
+
+	return 0;
+}
+
+int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t * obj_data, uint16_t obj_size)
+{
+	if (pios_ut_flash_hook)
+		pios_ut_flash_hook();
+
+	/* Anything but the last saved object keeps its defaults */
+	if (obj_id != pios_ut_saved_obj_id || obj_inst_id != pios_ut_saved_inst_id ||
+			obj_size != pios_ut_saved_size)
+		return -1;
+
+	memcpy(obj_data, pios_ut_saved_data, obj_size);
+
+	return 0;
+}
+
+int32_t PIOS_FLASHFS_ObjDelete(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id)
+{
+	return 0;
+}
+
+int32_t PIOS_FLASHFS_BatchBegin(uintptr_t fs_id, uint16_t num_objs)
+{
+	return 0;
+}
+
+int32_t PIOS_FLASHFS_BatchSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t * obj_data, uint16_t obj_size)
+{
+	return 0;
+}
+
+int32_t PIOS_FLASHFS_BatchCommit(uintptr_t fs_id)
+{
+	return 0;
+}
+
+int32_t PIOS_FLASHFS_BatchAbort(uintptr_t fs_id)
+{
+	return 0;
+}
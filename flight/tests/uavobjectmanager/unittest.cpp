@@ -0,0 +1,493 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock_gettime */
+#include <pthread.h>		/* pthread_mutex_* */
+
+extern "C" {
+
+#include "openpilot.h"
+#include "uavobjectsinit.h"	/* UAVOBJECTS_COUNT */
+
+extern volatile uint32_t pios_ut_mutex_lock_count;
+extern void (*pios_ut_flash_hook)(void);
+extern uint8_t pios_ut_saved_data[256];
+
+}
+
+/* Roughly the number of objects registered by a full flight target */
+#define NUM_OBJECTS 130u
+#define NUM_LOOKUPS 2000000u
+
+/* Object IDs are hashes with the low bit clear, the meta object uses id + 1 */
+static uint32_t test_obj_id(uint32_t n)
+{
+  return (n * 2654435761u) & ~1u;
+}
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+  return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class UAVObjectManager : public testing::Test {
+protected:
+  virtual void SetUp() {
+    ASSERT_EQ(0, UAVObjInitialize());
+  }
+
+  virtual void TearDown() {
+  }
+
+  void RegisterObjects(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      handles[i] = UAVObjRegister(test_obj_id(i + 1), 1, 0, 0, 16 + (i % 64), NULL);
+      ASSERT_TRUE(handles[i] != NULL);
+    }
+  }
+
+  UAVObjHandle handles[NUM_OBJECTS];
+};
+
+TEST_F(UAVObjectManager, LookupEmpty) {
+  EXPECT_TRUE(UAVObjGetByID(test_obj_id(1)) == NULL);
+}
+
+TEST_F(UAVObjectManager, LookupAllObjects) {
+  RegisterObjects(NUM_OBJECTS);
+
+  for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+    uint32_t id = test_obj_id(i + 1);
+    EXPECT_EQ(handles[i], UAVObjGetByID(id));
+    EXPECT_EQ(UAVObjGetLinkedObj(handles[i]), UAVObjGetByID(id + 1));
+    EXPECT_EQ(id + 1, UAVObjGetID(UAVObjGetByID(id + 1)));
+  }
+}
+
+TEST_F(UAVObjectManager, LookupMissing) {
+  RegisterObjects(NUM_OBJECTS);
+
+  EXPECT_TRUE(UAVObjGetByID(0) == NULL);
+  EXPECT_TRUE(UAVObjGetByID(0xFFFFFFFF) == NULL);
+  EXPECT_TRUE(UAVObjGetByID(test_obj_id(NUM_OBJECTS + 1)) == NULL);
+  EXPECT_TRUE(UAVObjGetByID(test_obj_id(1) + 2) == NULL);
+}
+
+TEST_F(UAVObjectManager, RejectDuplicate) {
+  RegisterObjects(NUM_OBJECTS);
+
+  EXPECT_TRUE(UAVObjRegister(test_obj_id(1), 1, 0, 0, 16, NULL) == NULL);
+  EXPECT_EQ(NUM_OBJECTS, (uint32_t)UAVObjCount());
+}
+
+TEST_F(UAVObjectManager, LookupBeyondIndex) {
+  /* Objects that do not fit in the index must still be found */
+  const uint32_t count = UAVOBJECTS_COUNT + 20;
+
+  for (uint32_t i = 0; i < count; i++) {
+    ASSERT_TRUE(UAVObjRegister(test_obj_id(i + 1), 1, 0, 0, 16, NULL) != NULL);
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    UAVObjHandle obj = UAVObjGetByID(test_obj_id(i + 1));
+    ASSERT_TRUE(obj != NULL);
+    EXPECT_EQ(test_obj_id(i + 1), UAVObjGetID(obj));
+  }
+  EXPECT_TRUE(UAVObjGetByID(test_obj_id(count + 1)) == NULL);
+}
+
+TEST_F(UAVObjectManager, TelemetryDeltaKeepsMetadataLayout) {
+  RegisterObjects(2);
+
+  /* Every client parses the metadata as one byte of flags and three periods */
+  EXPECT_EQ(7u, sizeof(UAVObjMetadata));
+  EXPECT_EQ(7u, UAVObjGetNumBytes(UAVObjGetLinkedObj(handles[0])));
+
+  EXPECT_FALSE(UAVObjIsTelemetryDelta(handles[0]));
+  UAVObjSetTelemetryDelta(handles[0], true);
+  EXPECT_TRUE(UAVObjIsTelemetryDelta(handles[0]));
+  EXPECT_FALSE(UAVObjIsTelemetryDelta(handles[1]));
+
+  /* Setting the metadata leaves the selection alone */
+  UAVObjMetadata metadata;
+  EXPECT_EQ(0, UAVObjGetMetadata(handles[0], &metadata));
+  metadata.flags = 0xFF;
+  EXPECT_EQ(0, UAVObjSetMetadata(handles[0], &metadata));
+  EXPECT_TRUE(UAVObjIsTelemetryDelta(handles[0]));
+
+  UAVObjSetTelemetryDelta(handles[0], false);
+  EXPECT_FALSE(UAVObjIsTelemetryDelta(handles[0]));
+}
+
+#define MULTI_OBJ_ID 0x1234ABCC
+#define MULTI_OBJ_SIZE 37
+
+/* Instances of the first allocation, UAVOBJ_INSTANCE_GROWTH_MIN in the manager */
+#define UAVOBJ_INSTANCE_GROWTH_MIN_UT 4
+
+static void fill_instance(uint8_t *data, uint16_t instId)
+{
+  for (uint32_t i = 0; i < MULTI_OBJ_SIZE; i++) {
+    data[i] = (uint8_t)(instId * 7 + i);
+  }
+}
+
+TEST_F(UAVObjectManager, MultiInstanceCreate) {
+  UAVObjHandle obj = UAVObjRegister(MULTI_OBJ_ID, 0, 0, 0, MULTI_OBJ_SIZE, NULL);
+  ASSERT_TRUE(obj != NULL);
+  EXPECT_EQ(1, UAVObjGetNumInstances(obj));
+
+  /* Grow one instance at a time, past several growth steps */
+  for (uint16_t n = 1; n < 40; n++) {
+    EXPECT_EQ(n, UAVObjCreateInstance(obj, NULL));
+    EXPECT_EQ(n + 1, UAVObjGetNumInstances(obj));
+  }
+
+  uint8_t data[MULTI_OBJ_SIZE];
+  for (uint16_t n = 0; n < 40; n++) {
+    fill_instance(data, n);
+    EXPECT_EQ(0, UAVObjSetInstanceData(obj, n, data));
+  }
+
+  /* Earlier instances must survive the array being moved by later growth */
+  for (uint16_t n = 40; n < 100; n++) {
+    EXPECT_EQ(n, UAVObjCreateInstance(obj, NULL));
+  }
+
+  uint8_t out[MULTI_OBJ_SIZE];
+  for (uint16_t n = 0; n < 40; n++) {
+    fill_instance(data, n);
+    EXPECT_EQ(0, UAVObjGetInstanceData(obj, n, out));
+    EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+  }
+
+  /* New instances start out zeroed */
+  memset(data, 0, sizeof(data));
+  EXPECT_EQ(0, UAVObjGetInstanceData(obj, 99, out));
+  EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+
+  EXPECT_EQ(-1, UAVObjGetInstanceData(obj, 100, out));
+}
+
+static UAVObjHandle flash_hook_obj;
+
+static void create_instance_during_flash(void)
+{
+  UAVObjCreateInstance(flash_hook_obj, NULL);
+}
+
+TEST_F(UAVObjectManager, MultiInstanceSaveLoadWhileGrowing) {
+  UAVObjHandle obj = UAVObjRegister(MULTI_OBJ_ID, 0, 0, 0, MULTI_OBJ_SIZE, NULL);
+  ASSERT_TRUE(obj != NULL);
+
+  /* Fill the first allocation of the instance array, so the next instance moves it */
+  for (uint16_t n = 1; n <= UAVOBJ_INSTANCE_GROWTH_MIN_UT; n++) {
+    EXPECT_EQ(n, UAVObjCreateInstance(obj, NULL));
+  }
+
+  /* Instance 1 is at the start of the array, which free() overwrites */
+  uint8_t data[MULTI_OBJ_SIZE];
+  uint8_t out[MULTI_OBJ_SIZE];
+  fill_instance(data, 1);
+  EXPECT_EQ(0, UAVObjSetInstanceData(obj, 1, data));
+
+  flash_hook_obj = obj;
+  pios_ut_flash_hook = create_instance_during_flash;
+
+  /* The saved data is the instance as it was when the save started */
+  EXPECT_EQ(0, UAVObjSave(obj, 1));
+  EXPECT_EQ(0, memcmp(data, pios_ut_saved_data, sizeof(data)));
+
+  /* A load that races the array moving still lands in the instance */
+  memset(out, 0, sizeof(out));
+  EXPECT_EQ(0, UAVObjSetInstanceData(obj, 1, out));
+  EXPECT_EQ(0, UAVObjLoad(obj, 1));
+  EXPECT_EQ(0, UAVObjGetInstanceData(obj, 1, out));
+  EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+
+  pios_ut_flash_hook = NULL;
+  EXPECT_EQ(UAVOBJ_INSTANCE_GROWTH_MIN_UT + 3, UAVObjGetNumInstances(obj));
+}
+
+TEST_F(UAVObjectManager, MultiInstanceSparse) {
+  UAVObjHandle obj = UAVObjRegister(MULTI_OBJ_ID, 0, 0, 0, MULTI_OBJ_SIZE, NULL);
+  ASSERT_TRUE(obj != NULL);
+
+  uint8_t data[MULTI_OBJ_SIZE];
+  uint8_t out[MULTI_OBJ_SIZE];
+  uint8_t zero[MULTI_OBJ_SIZE];
+  memset(zero, 0, sizeof(zero));
+
+  fill_instance(data, 0);
+  EXPECT_EQ(0, UAVObjSetInstanceData(obj, 0, data));
+
+  /* Unpacking instance 25 creates the zeroed instances 1 to 24 before it */
+  fill_instance(data, 25);
+  EXPECT_EQ(0, UAVObjUnpack(obj, 25, data));
+  EXPECT_EQ(26, UAVObjGetNumInstances(obj));
+
+  EXPECT_EQ(0, UAVObjGetInstanceData(obj, 25, out));
+  EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+
+  for (uint16_t n = 1; n < 25; n++) {
+    EXPECT_EQ(0, UAVObjGetInstanceData(obj, n, out));
+    EXPECT_EQ(0, memcmp(zero, out, sizeof(zero)));
+  }
+
+  fill_instance(data, 0);
+  EXPECT_EQ(0, UAVObjGetInstanceData(obj, 0, out));
+  EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+
+  /* Field access goes through the same storage */
+  uint8_t field = 0x5A;
+  EXPECT_EQ(0, UAVObjSetInstanceDataField(obj, 12, &field, 3, 1));
+  EXPECT_EQ(0, UAVObjGetInstanceData(obj, 12, out));
+  EXPECT_EQ(0x5A, out[3]);
+  EXPECT_EQ(-1, UAVObjSetInstanceDataField(obj, 12, &field, MULTI_OBJ_SIZE, 1));
+
+  /* A new instance goes after instance 25, and instances past the limit can not be unpacked */
+  EXPECT_EQ(26, UAVObjCreateInstance(obj, NULL));
+  EXPECT_EQ(-1, UAVObjUnpack(obj, UAVOBJ_MAX_INSTANCES, data));
+  EXPECT_EQ(27, UAVObjGetNumInstances(obj));
+}
+
+#define SEQLOCK_OBJ_ID 0x55AA1234
+#define SEQLOCK_WORDS 24
+#define SEQLOCK_READERS 3
+#define SEQLOCK_WRITES 200000u
+
+struct seqlock_stress {
+  UAVObjHandle obj;
+  volatile bool done;
+  uint32_t reads;
+  uint32_t torn;
+};
+
+/* Every write stores the same value in all words, so a mix means a torn read */
+static void *seqlock_writer(void *arg)
+{
+  struct seqlock_stress *stress = (struct seqlock_stress *)arg;
+  uint32_t data[SEQLOCK_WORDS];
+
+  for (uint32_t n = 1; n <= SEQLOCK_WRITES; n++) {
+    for (uint32_t i = 0; i < SEQLOCK_WORDS; i++) {
+      data[i] = n;
+    }
+    if (n % 2) {
+      UAVObjSetData(stress->obj, data);
+    } else {
+      UAVObjUnpack(stress->obj, 0, (uint8_t *)data);
+    }
+  }
+  stress->done = true;
+
+  return NULL;
+}
+
+static void *seqlock_reader(void *arg)
+{
+  struct seqlock_stress *stress = (struct seqlock_stress *)arg;
+  uint32_t data[SEQLOCK_WORDS];
+  uint32_t reads = 0;
+  uint32_t torn = 0;
+
+  while (!stress->done) {
+    if (reads % 2) {
+      UAVObjGetData(stress->obj, data);
+    } else {
+      UAVObjPack(stress->obj, 0, (uint8_t *)data);
+    }
+    reads++;
+
+    for (uint32_t i = 1; i < SEQLOCK_WORDS; i++) {
+      if (data[i] != data[0]) {
+        torn++;
+        break;
+      }
+    }
+  }
+
+  __sync_fetch_and_add(&stress->reads, reads);
+  __sync_fetch_and_add(&stress->torn, torn);
+
+  return NULL;
+}
+
+TEST_F(UAVObjectManager, SeqlockReadWithoutLock) {
+  UAVObjHandle obj = UAVObjRegister(SEQLOCK_OBJ_ID, 1, 0, 1, SEQLOCK_WORDS * 4, NULL);
+  ASSERT_TRUE(obj != NULL);
+
+  uint32_t data[SEQLOCK_WORDS];
+  uint32_t out[SEQLOCK_WORDS];
+  for (uint32_t i = 0; i < SEQLOCK_WORDS; i++) {
+    data[i] = i * 3;
+  }
+  EXPECT_EQ(0, UAVObjSetData(obj, data));
+
+  /* Uncontended reads must not touch the mutex */
+  UAVObjStats before, after;
+  UAVObjGetStats(&before);
+  uint32_t locks = pios_ut_mutex_lock_count;
+  EXPECT_EQ(0, UAVObjGetData(obj, out));
+  EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+  EXPECT_EQ(0, UAVObjGetDataField(obj, &out[0], 5 * 4, 4));
+  EXPECT_EQ(data[5], out[0]);
+  EXPECT_EQ(0, UAVObjPack(obj, 0, (uint8_t *)out));
+  EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+  EXPECT_EQ(locks, pios_ut_mutex_lock_count);
+  UAVObjGetStats(&after);
+  EXPECT_EQ(before.seqlockReads + 3, after.seqlockReads);
+  EXPECT_EQ(before.seqlockFallbacks, after.seqlockFallbacks);
+
+  /* Out of range requests still fail */
+  EXPECT_EQ(-1, UAVObjGetDataField(obj, &out[0], SEQLOCK_WORDS * 4, 4));
+  EXPECT_EQ(-1, UAVObjGetInstanceData(obj, 1, out));
+}
+
+TEST_F(UAVObjectManager, SeqlockStress) {
+  struct seqlock_stress stress;
+  memset(&stress, 0, sizeof(stress));
+
+  stress.obj = UAVObjRegister(SEQLOCK_OBJ_ID, 1, 0, 1, SEQLOCK_WORDS * 4, NULL);
+  ASSERT_TRUE(stress.obj != NULL);
+
+  pthread_t writer;
+  pthread_t readers[SEQLOCK_READERS];
+
+  UAVObjClearStats();
+
+  for (uint32_t i = 0; i < SEQLOCK_READERS; i++) {
+    ASSERT_EQ(0, pthread_create(&readers[i], NULL, seqlock_reader, &stress));
+  }
+  ASSERT_EQ(0, pthread_create(&writer, NULL, seqlock_writer, &stress));
+
+  pthread_join(writer, NULL);
+  for (uint32_t i = 0; i < SEQLOCK_READERS; i++) {
+    pthread_join(readers[i], NULL);
+  }
+
+  UAVObjStats stats;
+  UAVObjGetStats(&stats);
+
+  fprintf(stdout, "%u writes, %u reads, %u lock free, %u locked, %u torn\n",
+    SEQLOCK_WRITES, stress.reads, stats.seqlockReads, stats.seqlockFallbacks, stress.torn);
+  EXPECT_LT(0u, stress.reads);
+  EXPECT_EQ(0u, stress.torn);
+
+  /* Passing must not be down to every read falling back to the mutex */
+  EXPECT_LT(0u, stats.seqlockReads);
+
+  uint32_t out[SEQLOCK_WORDS];
+  EXPECT_EQ(0, UAVObjGetData(stress.obj, out));
+  EXPECT_EQ(SEQLOCK_WRITES, out[0]);
+}
+
+/*
+ * Reference lookup: the locked walk over the registration ordered list that
+ * UAVObjGetByID used before the index existed.
+ */
+struct ref_entry {
+  uint32_t id;
+  UAVObjHandle obj;
+  struct ref_entry *next;
+};
+
+static struct ref_entry ref_entries[NUM_OBJECTS];
+static pthread_mutex_t ref_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static UAVObjHandle ref_get_by_id(uint32_t id)
+{
+  UAVObjHandle found = NULL;
+
+  pthread_mutex_lock(&ref_mutex);
+  for (struct ref_entry *e = &ref_entries[0]; e; e = e->next) {
+    if (e->id == id) {
+      found = e->obj;
+      break;
+    }
+    if (e->id + 1 == id) {
+      found = UAVObjGetLinkedObj(e->obj);
+      break;
+    }
+  }
+  pthread_mutex_unlock(&ref_mutex);
+
+  return found;
+}
+
+TEST_F(UAVObjectManager, BenchmarkLookup) {
+  RegisterObjects(NUM_OBJECTS);
+
+  for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+    ref_entries[i].id = test_obj_id(i + 1);
+    ref_entries[i].obj = handles[i];
+    ref_entries[i].next = (i + 1 < NUM_OBJECTS) ? &ref_entries[i + 1] : NULL;
+  }
+
+  /* Look up data and meta objects across the whole set */
+  uint32_t ids[NUM_OBJECTS * 2];
+  for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+    ids[2 * i] = test_obj_id(i + 1);
+    ids[2 * i + 1] = test_obj_id(NUM_OBJECTS - i) + 1;
+  }
+
+  struct timespec start, end;
+  uint32_t found = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < NUM_LOOKUPS; i++) {
+    found += ref_get_by_id(ids[i % NELEMENTS(ids)]) != NULL;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double ref_ns = elapsed_ns(&start, &end) / NUM_LOOKUPS;
+  EXPECT_EQ(NUM_LOOKUPS, found);
+
+  found = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < NUM_LOOKUPS; i++) {
+    found += UAVObjGetByID(ids[i % NELEMENTS(ids)]) != NULL;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double idx_ns = elapsed_ns(&start, &end) / NUM_LOOKUPS;
+  EXPECT_EQ(NUM_LOOKUPS, found);
+
+  fprintf(stdout, "%d objects: list walk %.1f ns/lookup, index %.1f ns/lookup\n",
+    NUM_OBJECTS, ref_ns, idx_ns);
+}
@@ -0,0 +1,26 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/* pios_thread.h only defines the priorities once an RTOS is selected */
+enum pios_thread_prio_e {
+	PIOS_THREAD_PRIO_LOW = 1,
+	PIOS_THREAD_PRIO_NORMAL = 2,
+	PIOS_THREAD_PRIO_HIGH = 3,
+	PIOS_THREAD_PRIO_HIGHEST = 4,
+};
+
+#include "pios_heap.h"
+#include "pios_crc.h"
+#include "pios_flashfs.h"
+#include "pios_thread.h"
+#include "utlist.h"
+#include "uavobjectmanager.h"
+#include "eventdispatcher.h"
+#include "uavtalk.h"
+
+#define PIOS_Assert(x) if (!(x)) { while (1) ; }
+#define PIOS_DEBUG_Assert(x) PIOS_Assert(x)
+
+#define NELEMENTS(x) (sizeof(x) / sizeof(*(x)))
@@ -0,0 +1,4 @@
+/* Just enough of pios.h to build pios_crc.c on the host */
+#include <stdint.h>
+
+#include "pios_crc.h"
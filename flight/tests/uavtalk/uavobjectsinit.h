@@ -0,0 +1,3 @@
+/* Stand-in for the generated header, sized for the unit test objects */
+#define UAVOBJECTS_LARGEST 256
+#define UAVOBJECTS_COUNT 160
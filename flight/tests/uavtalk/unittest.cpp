@@ -0,0 +1,755 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <math.h>		/* sinf */
+#include <time.h>		/* clock_gettime */
+#include <vector>		/* std::vector */
+#include <algorithm>	/* std::min */
+
+extern "C" {
+
+#include "openpilot.h"
+#include "uavtalk_priv.h"	/* UAVTALK_TYPE_*, UAVTALK_MULTI_*, UAVTALK_DELTA_* */
+
+}
+
+/* A typical set of small periodic telemetry objects */
+#define NUM_OBJECTS 20u
+#define NUM_INSTANCES 3u
+
+/* Radio link model: every output call is one packet on the air */
+#define LINK_PACKET_OVERHEAD 20u	/* preamble, sync, header and CRC bytes */
+#define LINK_ROUNDS 500u
+#define LINK_BAUD 57600u
+
+typedef std::vector<uint8_t> packet;
+
+/* Packets written by each end of the link, in order */
+static std::vector<packet> a_to_b;
+static std::vector<packet> b_to_a;
+
+static int32_t output_a(uint8_t *data, int32_t length)
+{
+  a_to_b.push_back(packet(data, data + length));
+  return length;
+}
+
+static int32_t output_b(uint8_t *data, int32_t length)
+{
+  b_to_a.push_back(packet(data, data + length));
+  return length;
+}
+
+/* Small LCG so the lossy link is the same on every run */
+static uint32_t lcg_state;
+
+static uint32_t lcg_next(void)
+{
+  lcg_state = lcg_state * 1664525u + 1013904223u;
+  return lcg_state >> 8;
+}
+
+static uint32_t test_obj_id(uint32_t n)
+{
+  return (n * 2654435761u) & ~1u;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class UAVTalkBatch : public testing::Test {
+protected:
+  virtual void SetUp() {
+    ASSERT_EQ(0, UAVObjInitialize());
+
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+      sizes[i] = 4 + (i * 7) % 60;
+      objs[i] = UAVObjRegister(test_obj_id(i + 1), 1, 0, 0, sizes[i], NULL);
+      ASSERT_TRUE(objs[i] != NULL);
+    }
+
+    multi = UAVObjRegister(test_obj_id(NUM_OBJECTS + 1), 0, 0, 0, 12, NULL);
+    ASSERT_TRUE(multi != NULL);
+    for (uint32_t i = 1; i < NUM_INSTANCES; i++) {
+      ASSERT_EQ(i, UAVObjCreateInstance(multi, NULL));
+    }
+
+    a_to_b.clear();
+    b_to_a.clear();
+
+    a = UAVTalkInitialize(&output_a);
+    b = UAVTalkInitialize(&output_b);
+    ASSERT_TRUE(a != NULL);
+    ASSERT_TRUE(b != NULL);
+  }
+
+  virtual void TearDown() {
+  }
+
+  /* Fill an object with a pattern unique to the round, object and instance */
+  void Fill(UAVObjHandle obj, uint16_t inst, uint32_t round, bool zero) {
+    uint8_t data[256];
+    uint32_t len = UAVObjGetNumBytes(obj);
+
+    for (uint32_t i = 0; i < len; i++)
+      data[i] = zero ? 0 : (uint8_t)(round * 31 + UAVObjGetID(obj) + inst * 7 + i + 1);
+
+    UAVObjSetInstanceData(obj, inst, data);
+  }
+
+  /* 1 if the object holds the pattern, 0 if zeroed, -1 if anything else */
+  int32_t Check(UAVObjHandle obj, uint16_t inst, uint32_t round) {
+    uint8_t data[256];
+    uint32_t len = UAVObjGetNumBytes(obj);
+    bool pattern = true;
+    bool zero = true;
+
+    UAVObjGetInstanceData(obj, inst, data);
+    for (uint32_t i = 0; i < len; i++) {
+      if (data[i] != (uint8_t)(round * 31 + UAVObjGetID(obj) + inst * 7 + i + 1))
+        pattern = false;
+      if (data[i] != 0)
+        zero = false;
+    }
+
+    return pattern ? 1 : (zero ? 0 : -1);
+  }
+
+  void Deliver(UAVTalkConnection to, std::vector<packet> &packets) {
+    for (size_t i = 0; i < packets.size(); i++)
+      for (size_t j = 0; j < packets[i].size(); j++)
+        UAVTalkProcessInputStream(to, packets[i][j]);
+    packets.clear();
+  }
+
+  void EnableBatching() {
+    EXPECT_EQ(0, UAVTalkSendBatchCapability(b));
+    Deliver(a, b_to_a);
+    EXPECT_TRUE(UAVTalkGetBatching(a));
+  }
+
+  UAVObjHandle objs[NUM_OBJECTS];
+  uint16_t sizes[NUM_OBJECTS];
+  UAVObjHandle multi;
+  UAVTalkConnection a;
+  UAVTalkConnection b;
+};
+
+TEST_F(UAVTalkBatch, OffUntilPeerAnnounces) {
+  EXPECT_FALSE(UAVTalkGetBatching(a));
+
+  // Without an announcement every object goes out in its own packet
+  for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+    EXPECT_EQ(0, UAVTalkSendObjectBatched(a, objs[i], 0));
+  EXPECT_EQ(0, UAVTalkFlushBatch(a));
+
+  ASSERT_EQ(NUM_OBJECTS, a_to_b.size());
+  for (size_t i = 0; i < a_to_b.size(); i++)
+    EXPECT_EQ(UAVTALK_TYPE_OBJ, a_to_b[i][1]);
+}
+
+TEST_F(UAVTalkBatch, CapabilityFrame) {
+  EXPECT_EQ(0, UAVTalkSendBatchCapability(b));
+  ASSERT_EQ(1u, b_to_a.size());
+
+  // An empty frame: header and checksum only
+  packet &p = b_to_a[0];
+  ASSERT_EQ(UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH, p.size());
+  EXPECT_EQ(UAVTALK_SYNC_VAL, p[0]);
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_MULTI, p[1]);
+  EXPECT_EQ(UAVTALK_MIN_HEADER_LENGTH, (size_t)(p[2] | (p[3] << 8)));
+
+  Deliver(a, b_to_a);
+  EXPECT_TRUE(UAVTalkGetBatching(a));
+
+  // Turned off again when the owner of the link loses the peer
+  UAVTalkSetBatching(a, false);
+  EXPECT_FALSE(UAVTalkGetBatching(a));
+}
+
+TEST_F(UAVTalkBatch, RoundTrip) {
+  EnableBatching();
+
+  for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+    Fill(objs[i], 0, 1, false);
+    EXPECT_EQ(0, UAVTalkSendObjectBatched(a, objs[i], 0));
+  }
+  for (uint16_t n = 0; n < NUM_INSTANCES; n++)
+    Fill(multi, n, 1, false);
+  EXPECT_EQ(0, UAVTalkSendObjectBatched(a, multi, UAVOBJ_ALL_INSTANCES));
+
+  // Nothing leaves before the flush unless a frame filled up
+  size_t before_flush = a_to_b.size();
+  EXPECT_EQ(0, UAVTalkFlushBatch(a));
+  EXPECT_EQ(before_flush + 1, a_to_b.size());
+
+  // Fewer packets than objects, all batched and within the size limit
+  EXPECT_LT(a_to_b.size(), NUM_OBJECTS / 2);
+  for (size_t i = 0; i < a_to_b.size(); i++) {
+    EXPECT_EQ(UAVTALK_TYPE_OBJ_MULTI, a_to_b[i][1]);
+    EXPECT_LE(a_to_b[i].size(), UAVTALK_MULTI_MAX_PACKET_LENGTH);
+  }
+
+  // Both ends share the object manager, clear it before decoding
+  for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+    Fill(objs[i], 0, 1, true);
+  for (uint16_t n = 0; n < NUM_INSTANCES; n++)
+    Fill(multi, n, 1, true);
+
+  Deliver(b, a_to_b);
+
+  for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+    EXPECT_EQ(1, Check(objs[i], 0, 1)) << "object " << i;
+  for (uint16_t n = 0; n < NUM_INSTANCES; n++)
+    EXPECT_EQ(1, Check(multi, n, 1)) << "instance " << n;
+
+  // Decoding a batch also tells the receiver the sender understands them
+  EXPECT_TRUE(UAVTalkGetBatching(b));
+}
+
+TEST_F(UAVTalkBatch, UnknownEntriesAreSkipped) {
+  EnableBatching();
+
+  Fill(objs[0], 0, 2, false);
+  Fill(objs[1], 0, 2, false);
+  EXPECT_EQ(0, UAVTalkSendObjectBatched(a, objs[0], 0));
+  EXPECT_EQ(0, UAVTalkSendObjectBatched(a, objs[1], 0));
+  EXPECT_EQ(0, UAVTalkFlushBatch(a));
+  ASSERT_EQ(1u, a_to_b.size());
+
+  // Rename the first entry to an object the receiver does not know, fix up the checksum
+  packet &p = a_to_b[0];
+  p[UAVTALK_MIN_HEADER_LENGTH] ^= 0x5a;
+  p[p.size() - 1] = PIOS_CRC_updateCRC(0, &p[0], p.size() - 1);
+
+  Fill(objs[0], 0, 2, true);
+  Fill(objs[1], 0, 2, true);
+  Deliver(b, a_to_b);
+
+  EXPECT_EQ(0, Check(objs[0], 0, 2));
+  EXPECT_EQ(1, Check(objs[1], 0, 2));
+}
+
+TEST_F(UAVTalkBatch, AckedSendFlushesFirst) {
+  EnableBatching();
+
+  EXPECT_EQ(0, UAVTalkSendObjectBatched(a, objs[0], 0));
+  EXPECT_EQ(0u, a_to_b.size());
+
+  // Non batched sends keep their place behind pending updates
+  EXPECT_EQ(0, UAVTalkSendObject(a, objs[1], 0, 0, 0));
+  ASSERT_EQ(2u, a_to_b.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_MULTI, a_to_b[0][1]);
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, a_to_b[1][1]);
+}
+
+/*
+ * Send every object once per round over a link that drops some packets and
+ * flips a bit in others, then compare how much airtime each delivered update
+ * cost with and without batching.
+ */
+class UAVTalkLossyLink : public UAVTalkBatch {
+public:
+  void Run(bool batched, uint32_t *airtime, uint32_t *delivered) {
+    if (batched)
+      EnableBatching();
+
+    lcg_state = 12345;
+    *airtime = 0;
+    *delivered = 0;
+
+    for (uint32_t round = 1; round <= LINK_ROUNDS; round++) {
+      for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+        Fill(objs[i], 0, round, false);
+        UAVTalkSendObjectBatched(a, objs[i], 0);
+      }
+      UAVTalkFlushBatch(a);
+
+      for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+        Fill(objs[i], 0, round, true);
+
+      for (size_t i = 0; i < a_to_b.size(); i++) {
+        packet &p = a_to_b[i];
+        uint32_t r = lcg_next() % 100;
+
+        *airtime += p.size() + LINK_PACKET_OVERHEAD;
+
+        if (r < 5) {
+          // Lost on the air
+          continue;
+        } else if (r < 10) {
+          // Single bit error, the checksum has to catch it
+          uint32_t bit = lcg_next() % (p.size() * 8);
+          p[bit / 8] ^= 1 << (bit % 8);
+        }
+
+        for (size_t j = 0; j < p.size(); j++)
+          UAVTalkProcessInputStream(b, p[j]);
+      }
+      a_to_b.clear();
+
+      for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+        int32_t state = Check(objs[i], 0, round);
+        ASSERT_NE(-1, state) << "corrupted update accepted, round " << round << " object " << i;
+        *delivered += state;
+      }
+    }
+  }
+};
+
+TEST_F(UAVTalkLossyLink, Throughput) {
+  uint32_t single_airtime, single_delivered;
+  uint32_t batched_airtime, batched_delivered;
+
+  Run(false, &single_airtime, &single_delivered);
+  Run(true, &batched_airtime, &batched_delivered);
+
+  double single_cost = (double)single_airtime / single_delivered;
+  double batched_cost = (double)batched_airtime / batched_delivered;
+
+  fprintf(stdout, "single:  %u updates delivered of %u, %.1f bytes on air per update\n",
+    single_delivered, LINK_ROUNDS * NUM_OBJECTS, single_cost);
+  fprintf(stdout, "batched: %u updates delivered of %u, %.1f bytes on air per update\n",
+    batched_delivered, LINK_ROUNDS * NUM_OBJECTS, batched_cost);
+
+  // Most updates still make it through
+  EXPECT_GT(batched_delivered, LINK_ROUNDS * NUM_OBJECTS * 8 / 10);
+
+  // And each one costs clearly less airtime
+  EXPECT_LT(batched_cost, single_cost * 0.8);
+}
+
+/*
+ * Delta encoded telemetry.  The objects hold floats, a third of them drift
+ * with every update like an attitude or position estimate does and the rest
+ * only change now and then like status fields, DOPs or temperatures.
+ */
+class UAVTalkDelta : public UAVTalkBatch {
+protected:
+  void Expected(UAVObjHandle obj, uint32_t round, uint8_t *data) {
+    uint32_t len = UAVObjGetNumBytes(obj);
+    uint32_t n;
+
+    for (n = 0; n + 4 <= len; n += 4) {
+      uint32_t step = (n % 12 == 0) ? round : round / 50;
+      float value = 100.0f * sinf(step * 0.01f + n + UAVObjGetID(obj) % 7);
+      memcpy(&data[n], &value, 4);
+    }
+    for (; n < len; n++)
+      data[n] = (uint8_t)n;
+  }
+
+  void Fill(UAVObjHandle obj, uint32_t round, bool zero) {
+    uint8_t data[256];
+
+    if (zero)
+      memset(data, 0, sizeof(data));
+    else
+      Expected(obj, round, data);
+
+    UAVObjSetInstanceData(obj, 0, data);
+  }
+
+  /* 1 if the object holds the round's values, 0 if zeroed, -1 if anything else */
+  int32_t Check(UAVObjHandle obj, uint32_t round) {
+    uint8_t data[256];
+    uint8_t expected[256];
+    uint8_t zero[256];
+    uint32_t len = UAVObjGetNumBytes(obj);
+
+    UAVObjGetInstanceData(obj, 0, data);
+    Expected(obj, round, expected);
+    memset(zero, 0, sizeof(zero));
+
+    if (memcmp(data, expected, len) == 0)
+      return 1;
+    return (memcmp(data, zero, len) == 0) ? 0 : -1;
+  }
+
+  void EnableDelta() {
+    EXPECT_EQ(0, UAVTalkSendDeltaCapability(b));
+    Deliver(a, b_to_a);
+    EXPECT_TRUE(UAVTalkGetDelta(a));
+  }
+
+  /* Send one update of objs[4], eight floats, on its own and deliver it unless dropped */
+  uint8_t SendOne(uint32_t round, bool drop) {
+    Fill(objs[4], round, false);
+    EXPECT_EQ(0, UAVTalkSendObjectDelta(a, objs[4], 0));
+    EXPECT_EQ(1u, a_to_b.size());
+    Fill(objs[4], round, true);
+
+    uint8_t header = a_to_b[0][UAVTALK_MIN_HEADER_LENGTH];
+    if (drop)
+      a_to_b.clear();
+    else
+      Deliver(b, a_to_b);
+
+    return header;
+  }
+};
+
+TEST_F(UAVTalkDelta, OffUntilPeerAnnounces) {
+  EXPECT_FALSE(UAVTalkGetDelta(a));
+
+  Fill(objs[0], 1, false);
+  EXPECT_EQ(0, UAVTalkSendObjectDelta(a, objs[0], 0));
+  ASSERT_EQ(1u, a_to_b.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, a_to_b[0][1]);
+
+  EnableDelta();
+
+  // Turned off again when the owner of the link loses the peer
+  UAVTalkSetDelta(a, false);
+  EXPECT_FALSE(UAVTalkGetDelta(a));
+}
+
+TEST_F(UAVTalkDelta, KeyframeThenDeltas) {
+  EnableDelta();
+
+  UAVObjHandle obj = objs[4];
+  uint32_t len = UAVObjGetNumBytes(obj);
+
+  uint8_t header = SendOne(1, false);
+  EXPECT_EQ(UAVTALK_DELTA_KEYFRAME | 1, header);
+  EXPECT_EQ(1, Check(obj, 1));
+
+  // The following updates are deltas against that keyframe
+  for (uint32_t round = 2; round <= UAVTALK_DELTA_KEYFRAME_INTERVAL + 1; round++) {
+    Fill(obj, round, false);
+    EXPECT_EQ(0, UAVTalkSendObjectDelta(a, obj, 0));
+    ASSERT_EQ(1u, a_to_b.size());
+    EXPECT_EQ(UAVTALK_TYPE_OBJ_DELTA, a_to_b[0][1]);
+    EXPECT_EQ(1, a_to_b[0][UAVTALK_MIN_HEADER_LENGTH]) << "round " << round;
+    EXPECT_LT(a_to_b[0].size(), UAVTALK_MIN_HEADER_LENGTH + len + UAVTALK_CHECKSUM_LENGTH);
+
+    Fill(obj, round, true);
+    Deliver(b, a_to_b);
+    EXPECT_EQ(1, Check(obj, round)) << "round " << round;
+  }
+
+  // And then a fresh keyframe
+  header = SendOne(UAVTALK_DELTA_KEYFRAME_INTERVAL + 2, false);
+  EXPECT_EQ(UAVTALK_DELTA_KEYFRAME | 2, header);
+  EXPECT_EQ(1, Check(obj, UAVTALK_DELTA_KEYFRAME_INTERVAL + 2));
+}
+
+TEST_F(UAVTalkDelta, LostKeyframeDropsDeltas) {
+  EnableDelta();
+
+  uint32_t round = 1;
+  EXPECT_EQ(UAVTALK_DELTA_KEYFRAME | 1, SendOne(round++, false));
+  for (uint32_t i = 0; i < UAVTALK_DELTA_KEYFRAME_INTERVAL; i++)
+    SendOne(round++, false);
+
+  // The second keyframe is lost on the air
+  EXPECT_EQ(UAVTALK_DELTA_KEYFRAME | 2, SendOne(round++, true));
+
+  // Its deltas do not apply to the first keyframe
+  for (uint32_t i = 0; i < UAVTALK_DELTA_KEYFRAME_INTERVAL; i++) {
+    EXPECT_EQ(2, SendOne(round, false));
+    EXPECT_EQ(0, Check(objs[4], round)) << "round " << round;
+    round++;
+  }
+
+  // Back in sync with the next keyframe
+  EXPECT_EQ(UAVTALK_DELTA_KEYFRAME | 3, SendOne(round, false));
+  EXPECT_EQ(1, Check(objs[4], round));
+
+  // A new peer starts over from a keyframe
+  UAVTalkSetDelta(a, false);
+  EnableDelta();
+  EXPECT_EQ(UAVTALK_DELTA_KEYFRAME | 4, SendOne(++round, false));
+  EXPECT_EQ(1, Check(objs[4], round));
+}
+
+TEST_F(UAVTalkDelta, BatchedEntries) {
+  EnableBatching();
+  EnableDelta();
+
+  for (uint32_t round = 1; round <= 3; round++) {
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+      Fill(objs[i], round, false);
+      EXPECT_EQ(0, UAVTalkSendObjectDelta(a, objs[i], 0));
+    }
+    EXPECT_EQ(0, UAVTalkFlushBatch(a));
+
+    for (size_t i = 0; i < a_to_b.size(); i++)
+      EXPECT_EQ(UAVTALK_TYPE_OBJ_MULTI, a_to_b[i][1]);
+
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+      Fill(objs[i], round, true);
+    Deliver(b, a_to_b);
+
+    // Only the first UAVTALK_DELTA_SLOTS objects get delta encoded, the rest go plain
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+      EXPECT_EQ(1, Check(objs[i], round)) << "round " << round << " object " << i;
+  }
+}
+
+/*
+ * Same lossy link as above, telemetry is batched either way and the first
+ * UAVTALK_DELTA_SLOTS objects are flagged for delta encoding in the second run.
+ */
+class UAVTalkDeltaLink : public UAVTalkDelta {
+public:
+  void Run(bool delta, uint32_t *airtime, uint32_t *delivered) {
+    EnableBatching();
+    if (delta)
+      EnableDelta();
+
+    lcg_state = 12345;
+    *airtime = 0;
+    *delivered = 0;
+
+    for (uint32_t round = 1; round <= LINK_ROUNDS; round++) {
+      for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+        Fill(objs[i], round, false);
+        if (i < UAVTALK_DELTA_SLOTS)
+          UAVTalkSendObjectDelta(a, objs[i], 0);
+        else
+          UAVTalkSendObjectBatched(a, objs[i], 0);
+      }
+      UAVTalkFlushBatch(a);
+
+      for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+        Fill(objs[i], round, true);
+
+      for (size_t i = 0; i < a_to_b.size(); i++) {
+        packet &p = a_to_b[i];
+        uint32_t r = lcg_next() % 100;
+
+        *airtime += p.size() + LINK_PACKET_OVERHEAD;
+
+        if (r < 5) {
+          continue;
+        } else if (r < 10) {
+          uint32_t bit = lcg_next() % (p.size() * 8);
+          p[bit / 8] ^= 1 << (bit % 8);
+        }
+
+        for (size_t j = 0; j < p.size(); j++)
+          UAVTalkProcessInputStream(b, p[j]);
+      }
+      a_to_b.clear();
+
+      for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+        int32_t state = Check(objs[i], round);
+        ASSERT_NE(-1, state) << "corrupted update accepted, round " << round << " object " << i;
+        *delivered += state;
+      }
+    }
+  }
+};
+
+TEST_F(UAVTalkDeltaLink, Throughput) {
+  uint32_t full_airtime, full_delivered;
+  uint32_t delta_airtime, delta_delivered;
+
+  Run(false, &full_airtime, &full_delivered);
+  Run(true, &delta_airtime, &delta_delivered);
+
+  // 8N1 serial, ten bits per byte
+  double full_rate = (double)full_delivered / full_airtime * LINK_BAUD / 10;
+  double delta_rate = (double)delta_delivered / delta_airtime * LINK_BAUD / 10;
+
+  fprintf(stdout, "batched:       %u updates delivered of %u, %.0f objects/s at %u baud\n",
+    full_delivered, LINK_ROUNDS * NUM_OBJECTS, full_rate, LINK_BAUD);
+  fprintf(stdout, "batched+delta: %u updates delivered of %u, %.0f objects/s at %u baud\n",
+    delta_delivered, LINK_ROUNDS * NUM_OBJECTS, delta_rate, LINK_BAUD);
+
+  // Lost keyframes cost a few deltas, most updates still make it through
+  EXPECT_GT(delta_delivered, LINK_ROUNDS * NUM_OBJECTS * 8 / 10);
+
+  // And more of them fit through the link, even though only some objects are delta encoded
+  EXPECT_GT(delta_rate, full_rate * 1.05);
+}
+
+/*
+ * Block receive path: the same byte stream handed over in chunks of any size
+ * must give exactly the result of feeding it one byte at a time.
+ */
+class UAVTalkBuffer : public UAVTalkBatch {
+protected:
+  /* One plain packet per object followed by a few bytes of line noise */
+  void BuildStream(uint32_t round, packet *stream) {
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++) {
+      Fill(objs[i], 0, round, false);
+      EXPECT_EQ(0, UAVTalkSendObject(a, objs[i], 0, 0, 0));
+    }
+    for (uint16_t inst = 0; inst < NUM_INSTANCES; inst++) {
+      Fill(multi, inst, round, false);
+      EXPECT_EQ(0, UAVTalkSendObject(a, multi, inst, 0, 0));
+    }
+
+    stream->clear();
+    for (size_t i = 0; i < a_to_b.size(); i++) {
+      stream->insert(stream->end(), a_to_b[i].begin(), a_to_b[i].end());
+      for (uint32_t j = 0; j < i % 4; j++)
+        stream->push_back((uint8_t)(0x55 + j));
+    }
+    a_to_b.clear();
+
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+      Fill(objs[i], 0, round, true);
+    for (uint16_t inst = 0; inst < NUM_INSTANCES; inst++)
+      Fill(multi, inst, round, true);
+  }
+
+  void ExpectReceived(uint32_t round) {
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+      EXPECT_EQ(1, Check(objs[i], 0, round)) << "object " << i;
+    for (uint16_t inst = 0; inst < NUM_INSTANCES; inst++)
+      EXPECT_EQ(1, Check(multi, inst, round)) << "instance " << inst;
+  }
+
+  static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+  }
+};
+
+TEST_F(UAVTalkBuffer, MatchesByteParser) {
+  packet stream;
+  UAVTalkStats bytewise, blockwise;
+
+  BuildStream(1, &stream);
+  UAVTalkResetStats(b);
+  for (size_t i = 0; i < stream.size(); i++)
+    UAVTalkProcessInputStream(b, stream[i]);
+  ExpectReceived(1);
+  UAVTalkGetStats(b, &bytewise);
+
+  BuildStream(1, &stream);
+  UAVTalkResetStats(b);
+  EXPECT_EQ((int32_t)(NUM_OBJECTS + NUM_INSTANCES), UAVTalkProcessInputBuffer(b, &stream[0], stream.size()));
+  ExpectReceived(1);
+  UAVTalkGetStats(b, &blockwise);
+
+  EXPECT_EQ(0, memcmp(&bytewise, &blockwise, sizeof(UAVTalkStats)));
+  EXPECT_EQ(0u, blockwise.rxErrors);
+  EXPECT_EQ(stream.size(), blockwise.rxBytes);
+}
+
+TEST_F(UAVTalkBuffer, SplitAnywhere) {
+  packet stream;
+
+  // Every split point lands once in each part of a packet
+  BuildStream(1, &stream);
+  for (size_t split = 0; split <= stream.size(); split++) {
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++)
+      Fill(objs[i], 0, 1, true);
+    for (uint16_t inst = 0; inst < NUM_INSTANCES; inst++)
+      Fill(multi, inst, 1, true);
+
+    int32_t packets = UAVTalkProcessInputBuffer(b, &stream[0], split);
+    packets += UAVTalkProcessInputBuffer(b, &stream[0] + split, stream.size() - split);
+    EXPECT_EQ((int32_t)(NUM_OBJECTS + NUM_INSTANCES), packets) << "split at " << split;
+    ExpectReceived(1);
+  }
+
+  // And in chunks of every size
+  for (size_t chunk = 1; chunk <= 64; chunk++) {
+    BuildStream(chunk + 1, &stream);
+
+    int32_t packets = 0;
+    for (size_t i = 0; i < stream.size(); i += chunk)
+      packets += UAVTalkProcessInputBuffer(b, &stream[i], std::min(chunk, stream.size() - i));
+    EXPECT_EQ((int32_t)(NUM_OBJECTS + NUM_INSTANCES), packets) << "chunks of " << chunk;
+    ExpectReceived(chunk + 1);
+  }
+}
+
+TEST_F(UAVTalkBuffer, CorruptPacketsSkipped) {
+  packet stream;
+  UAVTalkStats stats;
+
+  BuildStream(1, &stream);
+
+  // Break the checksum of the first packet, the parser resyncs on the next one
+  size_t first = UAVTALK_MIN_HEADER_LENGTH + sizes[0];
+  stream[first] ^= 0xff;
+
+  UAVTalkResetStats(b);
+  EXPECT_EQ((int32_t)(NUM_OBJECTS + NUM_INSTANCES - 1), UAVTalkProcessInputBuffer(b, &stream[0], stream.size()));
+  UAVTalkGetStats(b, &stats);
+  EXPECT_EQ(1u, stats.rxErrors);
+  EXPECT_EQ(0, Check(objs[0], 0, 1));
+  for (uint32_t i = 1; i < NUM_OBJECTS; i++)
+    EXPECT_EQ(1, Check(objs[i], 0, 1)) << "object " << i;
+}
+
+/*
+ * Saturated input, as from a fast serial port or a TCP socket that hands
+ * over whatever has queued up: per byte calls against whole buffer calls.
+ */
+TEST_F(UAVTalkBuffer, Throughput) {
+  const uint32_t repeats = 200;
+  const size_t chunk = 512;
+  packet stream, input;
+
+  BuildStream(1, &stream);
+  for (uint32_t i = 0; i < repeats; i++)
+    input.insert(input.end(), stream.begin(), stream.end());
+  uint32_t expected = repeats * (NUM_OBJECTS + NUM_INSTANCES);
+
+  UAVTalkStats stats;
+  UAVTalkResetStats(b);
+  double start = now();
+  for (size_t i = 0; i < input.size(); i++)
+    UAVTalkProcessInputStream(b, input[i]);
+  double bytewise = now() - start;
+  UAVTalkGetStats(b, &stats);
+  EXPECT_EQ(expected, stats.rxObjects);
+
+  UAVTalkResetStats(b);
+  uint32_t packets = 0;
+  start = now();
+  for (size_t i = 0; i < input.size(); i += chunk)
+    packets += UAVTalkProcessInputBuffer(b, &input[i], std::min(chunk, input.size() - i));
+  double blockwise = now() - start;
+  UAVTalkGetStats(b, &stats);
+  EXPECT_EQ(expected, packets);
+  EXPECT_EQ(expected, stats.rxObjects);
+  EXPECT_EQ(0u, stats.rxErrors);
+
+  fprintf(stdout, "per byte:   %.0f packets/s, %.1f MB/s\n",
+    expected / bytewise, input.size() / bytewise / 1e6);
+  fprintf(stdout, "per buffer: %.0f packets/s, %.1f MB/s\n",
+    expected / blockwise, input.size() / blockwise / 1e6);
+}
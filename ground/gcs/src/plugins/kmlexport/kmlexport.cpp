@@ -48,6 +48,7 @@ const double ColorMap_Jet[256][3] = COLORMAP_JET;
 
 
 KmlExport::KmlExport(QString inputLogFileName, QString outputKmlFileName) :
+    bodyStart(0),
     outputFileName(outputKmlFileName)
 {
     logFile.setFileName(inputLogFileName);
@@ -256,6 +257,7 @@ bool KmlExport::open()
         //Since we could not find the file separator, we need to return to the beginning of the file
         logFile.seek(0);
     }
+    bodyStart = logFile.pos();
 
     return true;
 }
@@ -267,48 +269,9 @@ bool KmlExport::open()
  */
 bool KmlExport::preparseLogFile()
 {
-    //Read all log timestamps into array
-    timestampBuffer.clear(); //Save beginning of log for later use
-    timestampPos.clear();
-    quint64 logFileStartIdx = logFile.pos();
-    quint32 lastTimeStamp = 0;
-
-    while (!logFile.atEnd()){
-        qint64 dataSize;
-
-        //Get time stamp position
-        timestampPos.append(logFile.pos());
-
-        //Read timestamp and logfile packet size
-        logFile.read((char *) &lastTimeStamp, sizeof(lastTimeStamp));
-        logFile.read((char *) &dataSize, sizeof(dataSize));
-
-        //Check if dataSize sync bytes are correct.
-        //TODO: LIKELY AS NOT, THIS WILL FAIL TO RESYNC BECAUSE THERE IS TOO LITTLE INFORMATION IN THE STRING OF SIX 0x00
-        if ((dataSize & 0xFFFFFFFFFFFF0000)!=0){
-            qDebug() << "Wrong sync byte. At file location 0x"  << QString("%1").arg(logFile.pos(),0,16) << "Got 0x" << QString("%1").arg(dataSize & 0xFFFFFFFFFFFF0000,0,16) << ", but expected 0x""00"".";
-            logFile.seek(timestampPos.last()+1);
-            timestampPos.pop_back();
-            continue;
-        }
-
-        //Check if timestamps are sequential.
-        if (!timestampBuffer.isEmpty() && lastTimeStamp < timestampBuffer.last()){
-            QMessageBox msgBox;
-            msgBox.setText("Corrupted file.");
-            msgBox.setInformativeText("Timestamps are not sequential. Playback may have unexpected behavior"); //<--TODO: add hyperlink to webpage with better description.
-            msgBox.exec();
-
-            qDebug() << "Timestamp: " << timestampBuffer.last() << " " << lastTimeStamp;
-        }
-
-        timestampBuffer.append(lastTimeStamp);
-
-        logFile.seek(timestampPos.last()+sizeof(lastTimeStamp)+sizeof(dataSize)+dataSize);
-    }
-
-    //Check if any timestamps were successfully read
-    if (timestampBuffer.size() == 0){
+    // Takes the index from the log or its sidecar, only logs without
+    // either are scanned
+    if (!index.load(logFile, bodyStart)) {
         QMessageBox msgBox;
         msgBox.setText("Empty logfile.");
         msgBox.setInformativeText("No log data can be found.");
@@ -318,8 +281,12 @@ bool KmlExport::preparseLogFile()
         return false;
     }
 
-    //Reset to log beginning, including the timestamp.
-    logFile.seek(logFileStartIdx);
+    if (index.unorderedCount() > 0) {
+        QMessageBox msgBox;
+        msgBox.setText("Corrupted file.");
+        msgBox.setInformativeText("Timestamps are not sequential. Playback may have unexpected behavior"); //<--TODO: add hyperlink to webpage with better description.
+        msgBox.exec();
+    }
 
     return true;
 }
@@ -342,42 +309,26 @@ bool KmlExport::stopExport()
  */
 void KmlExport::parseLogFile()
 {
-    qint64 packetSize;
-    quint32 timeStampIdx;
-
-    //Read packets
-    while (!logFile.atEnd())
+    //Read packets, one chunk at a time
+    for (int i = 0; i < index.chunkCount(); i++)
     {
-        if(logFile.bytesAvailable() < 4) {
+        const QByteArray chunk = index.readPayload(logFile, i);
+        if (chunk.size() != (int) index.chunk(i).bytes) {
+            qDebug() << "Error: Logfile truncated in chunk " << i << "\n";
             break;
         }
 
-        //Read timestamp and logfile packet size
-        logFile.read((char *) &timeStamp, sizeof(timeStamp));
-        logFile.read((char *) &packetSize, sizeof(packetSize));
-
-        if (packetSize<1 || packetSize>(1024*1024)) {
-            qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << packetSize << "\n";
-            QMessageBox::critical(new QWidget(),"Corrupted file", "Incorrect packet size. Stopping export. Data up to this point will be saved.");
+        qint64 pos = 0;
+        LogRecord record;
+        while (LogIndex::readRecord(chunk.constData(), chunk.size(), pos, record)) {
+            timeStamp = record.timestamp;
 
-            break;
+            // Parse the packet. This operation passes the data to the kmlTalk object, which internally parses the data
+            // and then emits objectUpdated(UAVObject *) signals. These signals are connected to in the KmlExport constructor.
+            for (int j=0; j < record.size; j++) {
+                kmlTalk->processInputByte(record.data[j]);
+            }
         }
-
-        if(logFile.bytesAvailable() < packetSize) {
-            break;
-        }
-
-        // Read the data packet from the file.
-        QByteArray dataBuffer;
-        dataBuffer.append(logFile.read(packetSize));
-
-        // Parse the packet. This operation passes the data to the kmlTalk object, which internally parses the data
-        // and then emits objectUpdated(UAVObject *) signals. These signals are connected to in the KmlExport constructor.
-        for (int i=0; i < dataBuffer.size(); i++) {
-            kmlTalk->processInputByte(dataBuffer[i]);
-        }
-
-        timeStampIdx++;
     }
 
     stopExport();
@@ -40,6 +40,7 @@
 #include "kml/engine.h"
 
 #include "./uavtalk/uavtalk.h"
+#include "./logging/logindex.h"
 
 #include "airspeedactual.h"
 #include "attitudeactual.h"
@@ -92,8 +93,8 @@ protected:
     QFile logFile;
 
 private:
-    QList<quint32> timestampBuffer;
-    QList<quint32> timestampPos;
+    LogIndex index;
+    qint64 bodyStart;
 
     UAVTalk *kmlTalk;
 
@@ -4,10 +4,12 @@ QT += svg
 include(../../taulabsgcsplugin.pri)
 include(kmlexport_dependencies.pri)
 HEADERS += kmlexportplugin.h \
-    kmlexport.h
+    kmlexport.h \
+    ../logging/logindex.h
 
 SOURCES += kmlexportplugin.cpp \
-    kmlexport.cpp
+    kmlexport.cpp \
+    ../logging/logindex.cpp
 
 SOURCES += $$UAVOBJECT_SYNTHETICS/uavobjectsinit.cpp
 
@@ -38,9 +38,25 @@
 
 LogFile::LogFile(QObject *parent) :
     QIODevice(parent),
-    timestampBufferIdx(0)
+    dataBufferPos(0),
+    bodyStart(0),
+    firstTimestamp(0),
+    mapped(NULL),
+    mappedSize(0),
+    chunkIdx(0),
+    chunkData(NULL),
+    chunkLength(0),
+    chunkPos(0)
 {
     connect(&timer, SIGNAL(timeout()), this, SLOT(timerFired()));
+
+    // Bounds what a crash loses of the chunk being collected
+    flushTimer.setInterval(LogIndex::CHUNK_SPAN_MS);
+    connect(&flushTimer, SIGNAL(timeout()), this, SLOT(flushChunk()));
+
+    // Needed to queue dataAvailable to the telemetry thread
+    qRegisterMetaType<QList<QByteArray> >("QList<QByteArray>");
+    qRegisterMetaType<QSharedPointer<QFile> >("QSharedPointer<QFile>");
 }
 
 /**
@@ -84,6 +100,13 @@ bool LogFile::open(OpenMode mode) {
         QTextStream out(&file);
 
         out << "Tau Labs git hash:\n" <<  gitHash << "\n" << uavoHash << "\n##\n";
+        out.flush();
+
+        // The records follow in chunks, and the index is appended on close
+        file.write(LogIndex::containerHeader());
+        index.clear();
+        pendingChunk.clear();
+        flushTimer.start();
     }
     else if(mode == QIODevice::ReadOnly)
     {
@@ -123,6 +146,7 @@ bool LogFile::open(OpenMode mode) {
             //Since we could not find the file separator, we need to return to the beginning of the file
             file.seek(0);
         }
+        bodyStart = file.pos();
 
     }
     else
@@ -144,6 +168,16 @@ void LogFile::close()
 
     if (timer.isActive())
         timer.stop();
+    flushTimer.stop();
+
+    if (file.isOpen() && file.isWritable()) {
+        flushChunk();
+        if (!index.write(file, file.pos()))
+            qDebug() << "Unable to write the index of " << file.fileName();
+    }
+    index.clear();
+    chunkCopy.clear();
+
     file.close();
     QIODevice::close();
 }
@@ -154,136 +188,205 @@ qint64 LogFile::writeData(const char * data, qint64 dataSize) {
 
     quint32 timeStamp = myTime.elapsed();
 
-    file.write((char *) &timeStamp,sizeof(timeStamp));
-    file.write((char *) &dataSize, sizeof(dataSize));
+    if (!pendingChunk.isEmpty()) {
+        const LogChunkEntry &chunk = index.chunk(index.chunkCount() - 1);
+        if (chunk.bytes >= LogIndex::CHUNK_BYTES || timeStamp - chunk.firstTimestamp >= LogIndex::CHUNK_SPAN_MS)
+            flushChunk();
+    }
+    if (pendingChunk.isEmpty())
+        index.beginChunk(file.pos());
+
+    pendingChunk.append((char *) &timeStamp, sizeof(timeStamp));
+    pendingChunk.append((char *) &dataSize, sizeof(dataSize));
+    pendingChunk.append(data, dataSize);
+    index.addPacket(timeStamp, data, dataSize);
 
-    qint64 written = file.write(data, dataSize);
-    if(written != -1)
-        emit bytesWritten(written);
+    emit bytesWritten(dataSize);
 
     return dataSize;
 }
 
+/**
+ * Writes the chunk collected by writeData, preceded by its header, and
+ * hands it to the OS. Also called by flushTimer, so that a chunk is never
+ * held back for much longer than CHUNK_SPAN_MS when the updates slow down.
+ */
+void LogFile::flushChunk()
+{
+    if (pendingChunk.isEmpty())
+        return;
+
+    file.write(index.chunkHeader(index.chunkCount() - 1));
+    file.write(pendingChunk);
+    file.flush();
+    index.endChunk();
+    pendingChunk.clear();
+}
+
 qint64 LogFile::readData(char * data, qint64 maxSize) {
     QMutexLocker locker(&mutex);
-    qint64 toRead = qMin(maxSize,(qint64)dataBuffer.size());
-    memcpy(data,dataBuffer.data(),toRead);
-    dataBuffer.remove(0,toRead);
+    qint64 toRead = qMin(maxSize,(qint64)(dataBuffer.size() - dataBufferPos));
+    memcpy(data,dataBuffer.constData() + dataBufferPos,toRead);
+    dataBufferPos += toRead;
+
+    // Drop the buffer once it has been read rather than moving the rest
+    // down on every read
+    if (dataBufferPos == dataBuffer.size()) {
+        dataBuffer.clear();
+        dataBufferPos = 0;
+    }
     return toRead;
 }
 
 qint64 LogFile::bytesAvailable() const
 {
-    return dataBuffer.size();
+    return dataBuffer.size() - dataBufferPos;
 }
 
 void LogFile::timerFired()
 {
-    qint64 dataSize;
+    int time;
+    time = myTime.elapsed();
 
-    if(file.bytesAvailable() > 4)
+    QList<QByteArray> records;
+
+    //Read packets
+    while ((lastPlayTime + ((time - lastPlayTimeOffset)* playbackSpeed) > (lastTimeStamp-firstTimestamp)))
     {
+        lastPlayTime += ((time - lastPlayTimeOffset)* playbackSpeed);
+
+        // Records of a mapped log are handed out in place
+        if (mapped)
+            records.append(QByteArray::fromRawData(pendingRecord.data, pendingRecord.size));
+        else
+            records.append(QByteArray(pendingRecord.data, pendingRecord.size));
+
+        if (!nextRecord()) {
+            deliverRecords(records);
+            stopReplay();
+            return;
+        }
+        lastTimeStamp = pendingRecord.timestamp;
 
-        int time;
+        lastPlayTimeOffset = time;
         time = myTime.elapsed();
 
-        //Read packets
-        while ((lastPlayTime + ((time - lastPlayTimeOffset)* playbackSpeed) > (lastTimeStamp-firstTimestamp)))
-        {
-            lastPlayTime += ((time - lastPlayTimeOffset)* playbackSpeed);
-            if(file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
-
-            file.seek(lastTimeStampPos+sizeof(lastTimeStamp));
-
-            file.read((char *) &dataSize, sizeof(dataSize));
-
-            if (dataSize<1 || dataSize>(1024*1024)) {
-                qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
-            }
-            if(file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
-            }
-
-            mutex.lock();
-            dataBuffer.append(file.read(dataSize));
-            mutex.unlock();
-            emit readyRead();
-
-            if(file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
-
-            lastTimeStampPos = timestampPos[timestampBufferIdx];
-            lastTimeStamp = timestampBuffer[timestampBufferIdx];
-            timestampBufferIdx++;
-
-            lastPlayTimeOffset = time;
-            time = myTime.elapsed();
+        // Far behind, as when replaying fast, continue from the event loop
+        // so that the receivers get to keep up
+        if (records.size() >= REPLAY_BATCH)
+            break;
+    }
 
-        }
-    } else {
-        stopReplay();
+    deliverRecords(records);
+    timer.setInterval(records.size() >= REPLAY_BATCH ? 0 : REPLAY_INTERVAL_MS);
+}
+
+/**
+ * Hands the records to the receivers of dataAvailable, or to readData when
+ * there are none
+ */
+void LogFile::deliverRecords(const QList<QByteArray> &records)
+{
+    if (records.isEmpty())
+        return;
+
+    if (receivers(SIGNAL(dataAvailable(QList<QByteArray>,QSharedPointer<QFile>))) > 0) {
+        // Pass on whatever was buffered before the receiver connected first
+        mutex.lock();
+        QByteArray buffered = dataBuffer.mid(dataBufferPos);
+        dataBuffer.clear();
+        dataBufferPos = 0;
+        mutex.unlock();
+        if (!buffered.isEmpty())
+            emit dataAvailable(QList<QByteArray>() << buffered, QSharedPointer<QFile>());
+
+        // Queued batches hold on to the mapping until their receivers are done
+        emit dataAvailable(records, mapped ? mappedFile : QSharedPointer<QFile>());
+        return;
     }
 
+    mutex.lock();
+    foreach (const QByteArray &record, records)
+        dataBuffer.append(record);
+    mutex.unlock();
+    emit readyRead();
 }
 
-bool LogFile::startReplay() {
-    dataBuffer.clear();
-    myTime.restart();
-    lastPlayTimeOffset = 0;
-    lastPlayTime = 0;
-    playbackSpeed = 1;
+/**
+ * Maps the whole log for the replay. The previous mapping is only dropped
+ * here, it is released once the last batch emitted from it has been
+ * processed, as are the ones still queued when the LogFile goes away.
+ */
+bool LogFile::mapLog()
+{
+    mappedFile.clear();
+    mapped = NULL;
+    mappedSize = 0;
 
-    //Read all log timestamps into array
-    timestampBuffer.clear(); //Save beginning of log for later use
-    timestampPos.clear();
-    quint64 logFileStartIdx = file.pos();
-    timestampBufferIdx = 0;
-    lastTimeStamp = 0;
-
-    while (!file.atEnd()){
-        qint64 dataSize;
-
-        //Get time stamp position
-        timestampPos.append(file.pos());
-
-        //Read timestamp and logfile packet size
-        file.read((char *) &lastTimeStamp, sizeof(lastTimeStamp));
-        file.read((char *) &dataSize, sizeof(dataSize));
-
-        //Check if dataSize sync bytes are correct.
-        //TODO: LIKELY AS NOT, THIS WILL FAIL TO RESYNC BECAUSE THERE IS TOO LITTLE INFORMATION IN THE STRING OF SIX 0x00
-        if ((dataSize & 0xFFFFFFFFFFFF0000)!=0){
-            qDebug() << "Wrong sync byte. At file location 0x"  << QString("%1").arg(file.pos(),0,16) << "Got 0x" << QString("%1").arg(dataSize & 0xFFFFFFFFFFFF0000,0,16) << ", but expected 0x""00"".";
-            file.seek(timestampPos.last()+1);
-            timestampPos.pop_back();
-            continue;
-        }
+    QSharedPointer<QFile> mapping(new QFile(file.fileName()));
+    if (!mapping->open(QIODevice::ReadOnly))
+        return false;
 
-        //Check if timestamps are sequential.
-        if (!timestampBuffer.isEmpty() && lastTimeStamp < timestampBuffer.last()){
-            QMessageBox msgBox;
-            msgBox.setText("Corrupted file.");
-            msgBox.setInformativeText("Timestamps are not sequential. Playback may have unexpected behavior"); //<--TODO: add hyperlink to webpage with better description.
-            msgBox.exec();
+    mappedSize = mapping->size();
+    mapped = mapping->map(0, mappedSize);
+    if (!mapped) {
+        qDebug() << "Unable to map " << file.fileName() << ", replaying it through reads";
+        mappedSize = 0;
+        return false;
+    }
+    mappedFile = mapping;
+    return true;
+}
 
-            qDebug() << "Timestamp: " << timestampBuffer.last() << " " << lastTimeStamp;
-        }
+/**
+ * Points chunkData at chunk @p idx of the log, in the mapping when there is
+ * one and otherwise in a copy read from the file
+ */
+bool LogFile::loadChunk(int idx)
+{
+    chunkIdx = idx;
+    chunkPos = 0;
+    chunkLength = index.chunk(idx).bytes;
+
+    if (mapped) {
+        const qint64 offset = index.payloadOffset(idx);
+        if (offset + chunkLength > mappedSize)
+            return false;
+        chunkData = (const char *) mapped + offset;
+        return true;
+    }
 
-        timestampBuffer.append(lastTimeStamp);
+    chunkCopy = index.readPayload(file, idx);
+    chunkData = chunkCopy.constData();
+    return chunkCopy.size() == chunkLength;
+}
 
-        file.seek(timestampPos.last()+sizeof(lastTimeStamp)+sizeof(dataSize)+dataSize);
+/**
+ * Moves pendingRecord to the next record, loading the next chunk if needed
+ */
+bool LogFile::nextRecord()
+{
+    while (!LogIndex::readRecord(chunkData, chunkLength, chunkPos, pendingRecord)) {
+        if (chunkPos != chunkLength)
+            qDebug() << "Error: Logfile corrupted! Skipping the rest of chunk " << chunkIdx;
+        if (chunkIdx + 1 >= index.chunkCount() || !loadChunk(chunkIdx + 1))
+            return false;
     }
+    return true;
+}
 
-    //Check if any timestamps were successfully read
-    if (timestampBuffer.size() == 0){
+bool LogFile::startReplay() {
+    dataBuffer.clear();
+    dataBufferPos = 0;
+    mapLog();
+    myTime.restart();
+    lastPlayTimeOffset = 0;
+    lastPlayTime = 0;
+    playbackSpeed = 1;
+
+    // Takes the index from the log or its sidecar, only logs without
+    // either are scanned
+    if (!index.load(file, bodyStart) || !loadChunk(0) || !nextRecord()) {
         QMessageBox msgBox;
         msgBox.setText("Empty logfile.");
         msgBox.setInformativeText("No log data can be found.");
@@ -293,14 +396,17 @@ bool LogFile::startReplay() {
         return false;
     }
 
-    //Reset to log beginning.
-    file.seek(logFileStartIdx+sizeof(lastTimeStamp));
-    lastTimeStampPos = timestampPos[0];
-    lastTimeStamp = timestampBuffer[0];
-    firstTimestamp = timestampBuffer[0];
-    timestampBufferIdx = 1;
+    if (index.unorderedCount() > 0) {
+        QMessageBox msgBox;
+        msgBox.setText("Corrupted file.");
+        msgBox.setInformativeText("Timestamps are not sequential. Playback may have unexpected behavior"); //<--TODO: add hyperlink to webpage with better description.
+        msgBox.exec();
+    }
+
+    lastTimeStamp = pendingRecord.timestamp;
+    firstTimestamp = pendingRecord.timestamp;
 
-    timer.setInterval(10);
+    timer.setInterval(REPLAY_INTERVAL_MS);
     timer.start();
     emit replayStarted();
     return true;
@@ -325,21 +431,33 @@ void LogFile::resumeReplay()
 
 /**
  * @brief LogFile::setReplayTime, sets the playback time
- * @param val, the time in
+ * @param val, the time in seconds from the start of the log
+ *
+ * The chunk is found by a binary search of the index, the record by
+ * stepping through that one chunk.
  */
 void LogFile::setReplayTime(double val)
 {
-    quint32 tmpIdx=0;
-    while(timestampBuffer[tmpIdx++] <= val*1000 && tmpIdx <= timestampBufferIdx){
+    if (!file.isOpen())
+        return;
+
+    quint32 target = firstTimestamp + val*1000;
+    int idx = index.findChunk(target);
+    if (idx < 0 || !loadChunk(idx) || !nextRecord()) {
+        stopReplay();
+        return;
+    }
+    while (pendingRecord.timestamp < target && chunkIdx == idx) {
+        if (!nextRecord()) {
+            stopReplay();
+            return;
+        }
     }
 
-    lastTimeStampPos=timestampPos[tmpIdx];
-    lastTimeStamp=timestampBuffer[tmpIdx];
-    timestampBufferIdx=tmpIdx;
+    lastTimeStamp = pendingRecord.timestamp;
 
     lastPlayTimeOffset = myTime.elapsed();
-    lastPlayTime=lastTimeStamp;
+    lastPlayTime = lastTimeStamp - firstTimestamp;
 
-    qDebug() << "Replaying at: " << lastTimeStamp << ", but requestion at" << val*1000;
+    qDebug() << "Replaying at: " << lastTimeStamp - firstTimestamp << ", but requestion at" << val*1000;
 }
-
@@ -34,7 +34,9 @@
 #include <QMutexLocker>
 #include <QDebug>
 #include <QBuffer>
+#include <QSharedPointer>
 #include "uavobjectmanager.h"
+#include "logindex.h"
 #include <math.h>
 
 class LogFile : public QIODevice
@@ -62,13 +64,30 @@ public slots:
 protected slots:
     void timerFired();
 
+private slots:
+    void flushChunk();
+
+private:
+    bool mapLog();
+    bool loadChunk(int idx);
+    bool nextRecord();
+    void deliverRecords(const QList<QByteArray> &records);
+
 signals:
     void readReady();
     void replayStarted();
     void replayFinished();
 
+    //! Replayed records for receivers that take them without going through readData,
+    //! records of a mapped log point into @p mapping which keeps it mapped while held
+    void dataAvailable(const QList<QByteArray> &records, const QSharedPointer<QFile> &mapping);
+
 protected:
+    static const int REPLAY_INTERVAL_MS = 10;
+    static const int REPLAY_BATCH = 2000;      //!< most records handed out per timer tick
+
     QByteArray dataBuffer;
+    int dataBufferPos;
     QTimer timer;
     QTime myTime;
     QFile file;
@@ -81,11 +100,26 @@ protected:
     double playbackSpeed;
 
 private:
-    QList<quint32> timestampBuffer;
-    QList<quint32> timestampPos;
-    quint32 timestampBufferIdx;
-    quint32 lastTimeStampPos;
+    LogIndex index;
+    qint64 bodyStart;
     quint32 firstTimestamp;
+
+    // Mapping of the log being replayed, shared with the records handed out
+    QSharedPointer<QFile> mappedFile;
+    const uchar *mapped;
+    qint64 mappedSize;
+
+    // Replay position, pendingRecord points into chunkData
+    int chunkIdx;
+    QByteArray chunkCopy;
+    const char *chunkData;
+    qint64 chunkLength;
+    qint64 chunkPos;
+    LogRecord pendingRecord;
+
+    // Records of the chunk being written
+    QByteArray pendingChunk;
+    QTimer flushTimer;
 };
 
 #endif // LOGFILE_H
@@ -6,6 +6,7 @@ include(../../taulabsgcsplugin.pri)
 include(logging_dependencies.pri)
 HEADERS += loggingplugin.h \
     logfile.h \
+    logindex.h \
     logginggadgetwidget.h \
     logginggadget.h \
     logginggadgetfactory.h \
@@ -16,6 +17,7 @@ HEADERS += loggingplugin.h \
 
 SOURCES += loggingplugin.cpp \
     logfile.cpp \
+    logindex.cpp \
     logginggadgetwidget.cpp \
     logginggadget.cpp \
     logginggadgetfactory.cpp \
@@ -0,0 +1,602 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logindex.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Chunked log container and the packet index used for seeking
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logindex.h"
+#include <QDebug>
+#include <QtEndian>
+#include <algorithm>
+#include <string.h>
+
+static const char LOG_CONTAINER_MAGIC[4] = { 'T', 'L', 'L', 'C' };
+static const quint32 LOG_CHUNK_MAGIC = 0x4B434C54; // "TLCK"
+static const char LOG_INDEX_MAGIC[8] = { 'T', 'L', 'L', 'O', 'G', 'I', 'D', 'X' };
+
+static const qint64 RECORD_HEADER_BYTES = sizeof(quint32) + sizeof(qint64);
+static const qint64 CHUNK_ENTRY_BYTES = 24;
+static const qint64 OBJECT_ENTRY_BYTES = 8;     // object ID, length of its chunk list
+static const qint64 CHUNK_REF_BYTES = 4;
+static const qint64 TRAILER_BYTES = 40;
+static const qint64 SCAN_BLOCK_BYTES = 1024 * 1024;
+
+// UAVTalk packets start with sync(1), type(1), size(2), object ID(4)
+// and end with a checksum(1) that is not counted in size
+static const quint8 UAVTALK_SYNC_VAL = 0x3C;
+static const qint64 UAVTALK_OBJID_END = 8;
+static const qint64 UAVTALK_CHECKSUM_LENGTH = 1;
+
+const quint32 LogIndex::VERSION;
+const quint32 LogIndex::CHUNK_BYTES;
+const quint32 LogIndex::CHUNK_SPAN_MS;
+const qint64 LogIndex::MAX_RECORD_SIZE;
+const qint64 LogIndex::CONTAINER_HEADER_BYTES;
+const qint64 LogIndex::CHUNK_HEADER_BYTES;
+
+static void putChunkHeader(uchar *p, const LogChunkHeader &header)
+{
+    qToLittleEndian<quint32>(header.magic, p);
+    qToLittleEndian<quint32>(header.packets, p + 4);
+    qToLittleEndian<quint32>(header.bytes, p + 8);
+    qToLittleEndian<quint32>(header.firstTimestamp, p + 12);
+    qToLittleEndian<quint32>(header.lastTimestamp, p + 16);
+}
+
+static void getChunkHeader(const uchar *p, LogChunkHeader &header)
+{
+    header.magic = qFromLittleEndian<quint32>(p);
+    header.packets = qFromLittleEndian<quint32>(p + 4);
+    header.bytes = qFromLittleEndian<quint32>(p + 8);
+    header.firstTimestamp = qFromLittleEndian<quint32>(p + 12);
+    header.lastTimestamp = qFromLittleEndian<quint32>(p + 16);
+}
+
+static void putChunkEntry(uchar *p, const LogChunkEntry &entry)
+{
+    qToLittleEndian<qint64>(entry.offset, p);
+    qToLittleEndian<quint32>(entry.firstTimestamp, p + 8);
+    qToLittleEndian<quint32>(entry.lastTimestamp, p + 12);
+    qToLittleEndian<quint32>(entry.packets, p + 16);
+    qToLittleEndian<quint32>(entry.bytes, p + 20);
+}
+
+static void getChunkEntry(const uchar *p, LogChunkEntry &entry)
+{
+    entry.offset = qFromLittleEndian<qint64>(p);
+    entry.firstTimestamp = qFromLittleEndian<quint32>(p + 8);
+    entry.lastTimestamp = qFromLittleEndian<quint32>(p + 12);
+    entry.packets = qFromLittleEndian<quint32>(p + 16);
+    entry.bytes = qFromLittleEndian<quint32>(p + 20);
+}
+
+static void putTrailer(uchar *p, const LogIndexTrailer &trailer)
+{
+    qToLittleEndian<qint64>(trailer.indexOffset, p);
+    qToLittleEndian<qint64>(trailer.dataEnd, p + 8);
+    qToLittleEndian<quint32>(trailer.chunks, p + 16);
+    qToLittleEndian<quint32>(trailer.objects, p + 20);
+    qToLittleEndian<quint32>(trailer.objectRefs, p + 24);
+    qToLittleEndian<quint32>(trailer.version, p + 28);
+    memcpy(p + 32, trailer.magic, sizeof(trailer.magic));
+}
+
+static void getTrailer(const uchar *p, LogIndexTrailer &trailer)
+{
+    trailer.indexOffset = qFromLittleEndian<qint64>(p);
+    trailer.dataEnd = qFromLittleEndian<qint64>(p + 8);
+    trailer.chunks = qFromLittleEndian<quint32>(p + 16);
+    trailer.objects = qFromLittleEndian<quint32>(p + 20);
+    trailer.objectRefs = qFromLittleEndian<quint32>(p + 24);
+    trailer.version = qFromLittleEndian<quint32>(p + 28);
+    memcpy(trailer.magic, p + 32, sizeof(trailer.magic));
+}
+
+static bool chunkEndsBefore(const LogChunkEntry &entry, quint32 timestamp)
+{
+    return entry.lastTimestamp < timestamp;
+}
+
+LogIndex::LogIndex()
+{
+    clear();
+}
+
+void LogIndex::clear()
+{
+    logFormat = FORMAT_LEGACY;
+    sidecar = false;
+    chunkTable.clear();
+    objectChunks.clear();
+    chunkObjects.clear();
+    packets = 0;
+    previousTimestamp = 0;
+    resyncs = 0;
+    unordered = 0;
+}
+
+/**
+ * @brief LogIndex::load Builds the index of a log opened for reading
+ * @param log the log file
+ * @param bodyStart where the records start, just after the text header
+ * @return true if the log holds at least one record
+ *
+ * The index is taken from the footer of an indexed log, or from a sidecar
+ * that still matches the log. Otherwise the log is scanned once and the
+ * sidecar is written so that the next open does not have to.
+ */
+bool LogIndex::load(QFile &log, qint64 bodyStart)
+{
+    clear();
+
+    qint64 recordsStart = bodyStart;
+    log.seek(bodyStart);
+    const QByteArray header = log.read(CONTAINER_HEADER_BYTES);
+    if (header.size() == CONTAINER_HEADER_BYTES &&
+            memcmp(header.constData(), LOG_CONTAINER_MAGIC, sizeof(LOG_CONTAINER_MAGIC)) == 0) {
+        const quint32 version = qFromLittleEndian<quint32>((const uchar *) header.constData() + 4);
+        if (version != VERSION)
+            qDebug() << "Log container version" << version << "but expected" << VERSION;
+
+        if (readIndex(log, log.size(), -1)) {
+            logFormat = FORMAT_INDEXED;
+            return chunkCount() > 0;
+        }
+        recordsStart = bodyStart + CONTAINER_HEADER_BYTES;
+    }
+    Format format = (recordsStart == bodyStart) ? FORMAT_LEGACY : FORMAT_INDEXED;
+
+    QFile sidecarFile(sidecarName(log.fileName()));
+    if (sidecarFile.open(QIODevice::ReadOnly)) {
+        if (readIndex(sidecarFile, sidecarFile.size(), log.size())) {
+            logFormat = format;
+            sidecar = true;
+            return chunkCount() > 0;
+        }
+        sidecarFile.close();
+        clear();
+    }
+
+    logFormat = format;
+    if (logFormat == FORMAT_INDEXED)
+        scanChunks(log, recordsStart);
+    else
+        scanLegacy(log, recordsStart);
+
+    if (resyncs > 0)
+        qDebug() << "Logfile corrupted, skipped" << resyncs << "bytes while indexing" << log.fileName();
+    if (unordered > 0)
+        qDebug() << "Logfile has" << unordered << "timestamps that are not sequential";
+
+    writeSidecar(log);
+    return chunkCount() > 0;
+}
+
+/**
+ * @brief LogIndex::write Appends the index and its trailer
+ * @param out device positioned where the index goes
+ * @param dataEnd end of the records the index describes
+ */
+bool LogIndex::write(QIODevice &out, qint64 dataEnd) const
+{
+    QList<quint32> objIds = objectChunks.keys();
+    std::sort(objIds.begin(), objIds.end());
+
+    LogIndexTrailer trailer;
+    trailer.indexOffset = out.pos();
+    trailer.dataEnd = dataEnd;
+    trailer.chunks = chunkTable.size();
+    trailer.objects = objIds.size();
+    trailer.objectRefs = 0;
+    foreach (quint32 objId, objIds)
+        trailer.objectRefs += objectChunks[objId].size();
+    trailer.version = VERSION;
+    memcpy(trailer.magic, LOG_INDEX_MAGIC, sizeof(trailer.magic));
+
+    // Zero filled, so every byte of the file is one written on purpose
+    QByteArray index(trailer.chunks * CHUNK_ENTRY_BYTES + trailer.objects * OBJECT_ENTRY_BYTES +
+                     trailer.objectRefs * CHUNK_REF_BYTES + TRAILER_BYTES, 0);
+    uchar *p = (uchar *) index.data();
+    foreach (const LogChunkEntry &entry, chunkTable) {
+        putChunkEntry(p, entry);
+        p += CHUNK_ENTRY_BYTES;
+    }
+    foreach (quint32 objId, objIds) {
+        qToLittleEndian<quint32>(objId, p);
+        qToLittleEndian<quint32>(objectChunks[objId].size(), p + 4);
+        p += OBJECT_ENTRY_BYTES;
+    }
+    foreach (quint32 objId, objIds) {
+        foreach (quint32 ref, objectChunks[objId]) {
+            qToLittleEndian<quint32>(ref, p);
+            p += CHUNK_REF_BYTES;
+        }
+    }
+    putTrailer(p, trailer);
+
+    return out.write(index) == index.size();
+}
+
+/**
+ * @brief LogIndex::readIndex Reads an index ending at @p end
+ * @param dataEnd end of the log data the index has to describe, or -1 for
+ * an index stored in the log itself, right after the data
+ */
+bool LogIndex::readIndex(QIODevice &in, qint64 end, qint64 dataEnd)
+{
+    if (end < TRAILER_BYTES || !in.seek(end - TRAILER_BYTES))
+        return false;
+    const QByteArray tail = in.read(TRAILER_BYTES);
+    if (tail.size() != TRAILER_BYTES)
+        return false;
+
+    LogIndexTrailer trailer;
+    getTrailer((const uchar *) tail.constData(), trailer);
+
+    if (memcmp(trailer.magic, LOG_INDEX_MAGIC, sizeof(trailer.magic)) != 0 || trailer.version != VERSION)
+        return false;
+    if (trailer.dataEnd != (dataEnd < 0 ? trailer.indexOffset : dataEnd))
+        return false;
+
+    const qint64 length = trailer.chunks * CHUNK_ENTRY_BYTES +
+            trailer.objects * OBJECT_ENTRY_BYTES +
+            trailer.objectRefs * CHUNK_REF_BYTES;
+    if (trailer.indexOffset < 0 || trailer.indexOffset + length + TRAILER_BYTES != end)
+        return false;
+
+    in.seek(trailer.indexOffset);
+    const QByteArray index = in.read(length);
+    if (index.size() != length)
+        return false;
+
+    const uchar *p = (const uchar *) index.constData();
+    chunkTable.resize(trailer.chunks);
+    for (quint32 i = 0; i < trailer.chunks; i++) {
+        getChunkEntry(p, chunkTable[i]);
+        p += CHUNK_ENTRY_BYTES;
+    }
+
+    const uchar *refs = p + trailer.objects * OBJECT_ENTRY_BYTES;
+    quint32 refsLeft = trailer.objectRefs;
+    for (quint32 i = 0; i < trailer.objects; i++) {
+        const quint32 objId = qFromLittleEndian<quint32>(p);
+        const quint32 count = qFromLittleEndian<quint32>(p + 4);
+        p += OBJECT_ENTRY_BYTES;
+
+        if (count > refsLeft) {
+            clear();
+            return false;
+        }
+        QVector<quint32> &list = objectChunks[objId];
+        list.resize(count);
+        for (quint32 j = 0; j < count; j++) {
+            list[j] = qFromLittleEndian<quint32>(refs);
+            refs += CHUNK_REF_BYTES;
+        }
+        refsLeft -= count;
+    }
+
+    for (int i = 0; i < chunkTable.size(); i++) {
+        if (chunkTable[i].offset < 0 || chunkTable[i].offset + chunkTable[i].bytes > trailer.dataEnd) {
+            clear();
+            return false;
+        }
+        packets += chunkTable[i].packets;
+    }
+
+    return true;
+}
+
+/**
+ * @brief LogIndex::scanLegacy Indexes a plain sequence of records
+ *
+ * Whenever a record header does not make sense the scan steps a single
+ * byte forward and tries again, which also ends the current chunk so that
+ * chunks only ever hold consecutive valid records. While resyncing, a
+ * record is only accepted if it also holds exactly one UAVTalk packet, as
+ * the size alone is too little to go by.
+ */
+void LogIndex::scanLegacy(QFile &log, qint64 pos)
+{
+    const qint64 end = log.size();
+    QByteArray block;
+    qint64 blockStart = 0;
+    bool inChunk = false;
+    bool resyncing = false;
+
+    while (pos + RECORD_HEADER_BYTES <= end) {
+        // Keep the record header and the UAVTalk object ID in the block
+        if (pos < blockStart || pos + RECORD_HEADER_BYTES + UAVTALK_OBJID_END > blockStart + block.size()) {
+            log.seek(pos);
+            block = log.read(SCAN_BLOCK_BYTES);
+            blockStart = pos;
+            if (block.size() < RECORD_HEADER_BYTES)
+                break;
+        }
+
+        const char *p = block.constData() + (pos - blockStart);
+        quint32 timestamp;
+        qint64 size;
+        memcpy(&timestamp, p, sizeof(timestamp));
+        memcpy(&size, p + sizeof(timestamp), sizeof(size));
+
+        if (!validSize(size) || pos + RECORD_HEADER_BYTES + size > end ||
+                (resyncing && !wholePacket(p + RECORD_HEADER_BYTES, size))) {
+            if (inChunk) {
+                endChunk();
+                inChunk = false;
+            }
+            resyncing = true;
+            resyncs++;
+            pos++;
+            continue;
+        }
+        resyncing = false;
+
+        if (inChunk && (chunkTable.last().bytes >= CHUNK_BYTES ||
+                        timestamp - chunkTable.last().firstTimestamp >= CHUNK_SPAN_MS)) {
+            endChunk();
+            inChunk = false;
+        }
+        if (!inChunk) {
+            beginChunk(pos);
+            inChunk = true;
+        }
+
+        addPacket(timestamp, p + RECORD_HEADER_BYTES, size);
+        pos += RECORD_HEADER_BYTES + size;
+    }
+
+    if (inChunk)
+        endChunk();
+}
+
+/**
+ * @brief LogIndex::scanChunks Indexes an indexed log that lost its footer
+ *
+ * The chunk headers are followed one after the other until one is missing
+ * or truncated, which is where the writer stopped.
+ */
+void LogIndex::scanChunks(QFile &log, qint64 pos)
+{
+    const qint64 end = log.size();
+
+    while (pos + CHUNK_HEADER_BYTES <= end) {
+        log.seek(pos);
+        const QByteArray headerBytes = log.read(CHUNK_HEADER_BYTES);
+        if (headerBytes.size() != CHUNK_HEADER_BYTES)
+            break;
+
+        LogChunkHeader header;
+        getChunkHeader((const uchar *) headerBytes.constData(), header);
+        if (header.magic != LOG_CHUNK_MAGIC || pos + CHUNK_HEADER_BYTES + header.bytes > end)
+            break;
+
+        const QByteArray payload = log.read(header.bytes);
+        beginChunk(pos);
+
+        qint64 recordPos = 0;
+        LogRecord record;
+        while (readRecord(payload.constData(), payload.size(), recordPos, record))
+            addPacket(record.timestamp, record.data, record.size);
+        endChunk();
+
+        if (recordPos != payload.size() || chunkTable.last().packets != header.packets) {
+            qDebug() << "Logfile chunk at" << pos << "is corrupted, indexing stopped there";
+            chunkTable.last().bytes = recordPos;
+            if (chunkTable.last().packets == 0)
+                chunkTable.removeLast();
+            break;
+        }
+
+        pos += CHUNK_HEADER_BYTES + header.bytes;
+    }
+}
+
+void LogIndex::writeSidecar(const QFile &log) const
+{
+    QFile out(sidecarName(log.fileName()));
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || !write(out, log.size())) {
+        qDebug() << "Unable to write the log index" << out.fileName();
+        out.remove();
+    }
+}
+
+//! The container header as stored at the start of an indexed log
+QByteArray LogIndex::containerHeader()
+{
+    QByteArray bytes(CONTAINER_HEADER_BYTES, 0);
+    memcpy(bytes.data(), LOG_CONTAINER_MAGIC, sizeof(LOG_CONTAINER_MAGIC));
+    qToLittleEndian<quint32>(VERSION, (uchar *) bytes.data() + 4);
+    return bytes;
+}
+
+//! The header of chunk @p idx as stored in front of its records
+QByteArray LogIndex::chunkHeader(int idx) const
+{
+    const LogChunkEntry &entry = chunkTable.at(idx);
+    LogChunkHeader header;
+    header.magic = LOG_CHUNK_MAGIC;
+    header.packets = entry.packets;
+    header.bytes = entry.bytes;
+    header.firstTimestamp = entry.firstTimestamp;
+    header.lastTimestamp = entry.lastTimestamp;
+
+    QByteArray bytes(CHUNK_HEADER_BYTES, 0);
+    putChunkHeader((uchar *) bytes.data(), header);
+    return bytes;
+}
+
+/**
+ * @brief LogIndex::beginChunk Starts a new chunk
+ * @param offset of the chunk header, or of the first record in a legacy log
+ */
+void LogIndex::beginChunk(qint64 offset)
+{
+    LogChunkEntry entry;
+    entry.offset = offset;
+    entry.firstTimestamp = 0;
+    entry.lastTimestamp = 0;
+    entry.packets = 0;
+    entry.bytes = 0;
+    chunkTable.append(entry);
+    chunkObjects.clear();
+}
+
+/**
+ * @brief LogIndex::addPacket Accounts for one record of the current chunk
+ * @param data start of the UAVTalk packet, only the header is looked at
+ * @param size size of the whole record data
+ */
+void LogIndex::addPacket(quint32 timestamp, const char *data, qint64 size)
+{
+    LogChunkEntry &entry = chunkTable.last();
+    if (entry.packets == 0)
+        entry.firstTimestamp = timestamp;
+    entry.lastTimestamp = qMax(entry.lastTimestamp, timestamp);
+    entry.packets++;
+    entry.bytes += RECORD_HEADER_BYTES + size;
+
+    if (packets > 0 && timestamp < previousTimestamp)
+        unordered++;
+    previousTimestamp = timestamp;
+    packets++;
+
+    quint32 objId;
+    if (objectId(data, size, objId))
+        chunkObjects.insert(objId);
+}
+
+//! Ends the current chunk and files it under every object it holds
+void LogIndex::endChunk()
+{
+    const quint32 idx = chunkTable.size() - 1;
+    foreach (quint32 objId, chunkObjects)
+        objectChunks[objId].append(idx);
+    chunkObjects.clear();
+}
+
+qint64 LogIndex::payloadOffset(int idx) const
+{
+    qint64 offset = chunkTable.at(idx).offset;
+    if (logFormat == FORMAT_INDEXED)
+        offset += CHUNK_HEADER_BYTES;
+    return offset;
+}
+
+QByteArray LogIndex::readPayload(QFile &log, int idx) const
+{
+    if (!log.seek(payloadOffset(idx)))
+        return QByteArray();
+    return log.read(chunkTable.at(idx).bytes);
+}
+
+quint32 LogIndex::firstTimestamp() const
+{
+    return chunkTable.isEmpty() ? 0 : chunkTable.first().firstTimestamp;
+}
+
+quint32 LogIndex::lastTimestamp() const
+{
+    return chunkTable.isEmpty() ? 0 : chunkTable.last().lastTimestamp;
+}
+
+/**
+ * @brief LogIndex::findChunk Binary search for the chunk holding a time
+ * @return the first chunk that ends at or after @p timestamp, the last
+ * chunk when the log ends before it, or -1 for an empty index
+ */
+int LogIndex::findChunk(quint32 timestamp) const
+{
+    if (chunkTable.isEmpty())
+        return -1;
+
+    QVector<LogChunkEntry>::const_iterator it = std::lower_bound(
+                chunkTable.constBegin(), chunkTable.constEnd(), timestamp, chunkEndsBefore);
+    if (it == chunkTable.constEnd())
+        return chunkTable.size() - 1;
+    return it - chunkTable.constBegin();
+}
+
+/**
+ * @brief LogIndex::findObjectChunk Finds the next chunk holding an object
+ * @return the first chunk at or after @p timestamp that holds a packet of
+ * @p objId, or -1 if there is none
+ */
+int LogIndex::findObjectChunk(quint32 objId, quint32 timestamp) const
+{
+    const int first = findChunk(timestamp);
+    if (first < 0)
+        return -1;
+
+    QHash<quint32, QVector<quint32> >::const_iterator list = objectChunks.constFind(objId);
+    if (list == objectChunks.constEnd())
+        return -1;
+
+    QVector<quint32>::const_iterator it = std::lower_bound(list->constBegin(), list->constEnd(), (quint32) first);
+    return (it == list->constEnd()) ? -1 : (int) *it;
+}
+
+QString LogIndex::sidecarName(const QString &logName)
+{
+    return logName + ".idx";
+}
+
+/**
+ * @brief LogIndex::readRecord Reads the record at @p pos of a chunk payload
+ * @return false at the end of the payload or on a corrupted record,
+ * otherwise @p pos is moved to the next record
+ */
+bool LogIndex::readRecord(const char *payload, qint64 length, qint64 &pos, LogRecord &record)
+{
+    if (pos + RECORD_HEADER_BYTES > length)
+        return false;
+
+    memcpy(&record.timestamp, payload + pos, sizeof(record.timestamp));
+    memcpy(&record.size, payload + pos + sizeof(record.timestamp), sizeof(record.size));
+    if (!validSize(record.size) || pos + RECORD_HEADER_BYTES + record.size > length)
+        return false;
+
+    record.data = payload + pos + RECORD_HEADER_BYTES;
+    pos += RECORD_HEADER_BYTES + record.size;
+    return true;
+}
+
+bool LogIndex::wholePacket(const char *data, qint64 size)
+{
+    if (size < UAVTALK_OBJID_END + UAVTALK_CHECKSUM_LENGTH || (quint8) data[0] != UAVTALK_SYNC_VAL)
+        return false;
+
+    quint16 length;
+    memcpy(&length, data + 2, sizeof(length));
+    return length + UAVTALK_CHECKSUM_LENGTH == size;
+}
+
+bool LogIndex::objectId(const char *data, qint64 size, quint32 &objId)
+{
+    if (size < UAVTALK_OBJID_END || (quint8) data[0] != UAVTALK_SYNC_VAL)
+        return false;
+
+    memcpy(&objId, data + 4, sizeof(objId));
+    return true;
+}
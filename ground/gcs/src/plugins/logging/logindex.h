@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logindex.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Chunked log container and the packet index used for seeking
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QVector>
+
+/*
+ * Layout of a log file after the "##\n" header terminator.
+ *
+ * Legacy logs are a plain sequence of records:
+ *     quint32 timestamp, qint64 size, size bytes of UAVTalk data
+ *
+ * Indexed logs start with a container header, the magic LOG_CONTAINER_MAGIC
+ * and a quint32 version, and group the same records into chunks, each
+ * preceded by a LogChunkHeader. Closing the log appends the index: the
+ * chunk table, the object table, the chunk lists of every object and
+ * finally a LogIndexTrailer at the very end of the file.
+ *
+ * The headers, the index and the trailer are stored field by field in
+ * little endian, in the order the fields are declared below and without
+ * any padding, so the file does not depend on how the compiler lays out
+ * the structs.
+ *
+ * Legacy logs, and indexed logs whose writer never got to close them, get
+ * the same index written to a sidecar file next to the log the first time
+ * they are opened.
+ */
+
+//! Precedes every chunk of records in an indexed log, CHUNK_HEADER_BYTES on disk
+struct LogChunkHeader {
+    quint32 magic;                  //!< LOG_CHUNK_MAGIC
+    quint32 packets;                //!< records in the chunk
+    quint32 bytes;                  //!< bytes of records following the header
+    quint32 firstTimestamp;
+    quint32 lastTimestamp;
+};
+
+//! One entry of the chunk table, sorted by file offset and so by time
+struct LogChunkEntry {
+    qint64 offset;                  //!< chunk header, or first record of a legacy log chunk
+    quint32 firstTimestamp;
+    quint32 lastTimestamp;
+    quint32 packets;
+    quint32 bytes;
+};
+
+//! Last bytes of an indexed log or of a sidecar index
+struct LogIndexTrailer {
+    qint64 indexOffset;             //!< start of the chunk table
+    qint64 dataEnd;                 //!< end of the records the index describes
+    quint32 chunks;
+    quint32 objects;
+    quint32 objectRefs;             //!< total length of all the object chunk lists
+    quint32 version;
+    char magic[8];                  //!< LOG_INDEX_MAGIC
+};
+
+//! One record as stored in the log
+struct LogRecord {
+    quint32 timestamp;
+    qint64 size;
+    const char *data;
+};
+
+class LogIndex
+{
+public:
+    enum Format {
+        FORMAT_LEGACY,
+        FORMAT_INDEXED
+    };
+
+    static const quint32 VERSION = 1;
+    static const quint32 CHUNK_BYTES = 64 * 1024;     //!< records are grouped up to this size
+    static const quint32 CHUNK_SPAN_MS = 1000;        //!< and at most this long a time span
+    static const qint64 MAX_RECORD_SIZE = 0xFFFF;      //!< anything larger is taken as corruption
+    static const qint64 CONTAINER_HEADER_BYTES = 8;    //!< on disk size of the container header
+    static const qint64 CHUNK_HEADER_BYTES = 20;       //!< on disk size of a LogChunkHeader
+
+    LogIndex();
+
+    void clear();
+    bool load(QFile &log, qint64 bodyStart);
+    bool write(QIODevice &out, qint64 dataEnd) const;
+
+    static QByteArray containerHeader();
+    QByteArray chunkHeader(int idx) const;
+    void beginChunk(qint64 offset);
+    void addPacket(quint32 timestamp, const char *data, qint64 size);
+    void endChunk();
+
+    Format format() const { return logFormat; }
+    bool fromSidecar() const { return sidecar; }
+    int chunkCount() const { return chunkTable.size(); }
+    const LogChunkEntry &chunk(int idx) const { return chunkTable.at(idx); }
+    qint64 payloadOffset(int idx) const;
+    QByteArray readPayload(QFile &log, int idx) const;
+    quint64 packetCount() const { return packets; }
+    quint32 firstTimestamp() const;
+    quint32 lastTimestamp() const;
+
+    int findChunk(quint32 timestamp) const;
+    int findObjectChunk(quint32 objId, quint32 timestamp) const;
+    QList<quint32> objectIds() const { return objectChunks.keys(); }
+    QVector<quint32> chunksOfObject(quint32 objId) const { return objectChunks.value(objId); }
+
+    int resyncCount() const { return resyncs; }
+    int unorderedCount() const { return unordered; }
+
+    static QString sidecarName(const QString &logName);
+    static bool readRecord(const char *payload, qint64 length, qint64 &pos, LogRecord &record);
+    static bool validSize(qint64 size) { return size > 0 && size <= MAX_RECORD_SIZE; }
+
+private:
+    bool readIndex(QIODevice &in, qint64 end, qint64 dataEnd);
+    void scanLegacy(QFile &log, qint64 pos);
+    void scanChunks(QFile &log, qint64 pos);
+    void writeSidecar(const QFile &log) const;
+    static bool wholePacket(const char *data, qint64 size);
+    static bool objectId(const char *data, qint64 size, quint32 &objId);
+
+    Format logFormat;
+    bool sidecar;
+    QVector<LogChunkEntry> chunkTable;
+    QHash<quint32, QVector<quint32> > objectChunks;
+    QSet<quint32> chunkObjects;
+    quint64 packets;
+    quint32 previousTimestamp;
+    int resyncs;
+    int unordered;
+};
+
+#endif // LOGINDEX_H
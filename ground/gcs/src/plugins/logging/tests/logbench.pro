@@ -0,0 +1,12 @@
+# -------------------------------------------------
+# Benchmark of opening, seeking and replaying large logs
+# -------------------------------------------------
+QT -= gui
+TARGET = logbench
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+INCLUDEPATH += ..
+SOURCES += main.cpp \
+    ../logindex.cpp
+HEADERS += ../logindex.h
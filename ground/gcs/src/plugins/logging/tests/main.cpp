@@ -0,0 +1,348 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Benchmark of opening, seeking and replaying large logs
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logindex.h"
+
+// Usage: logbench [size in MB, default 1024] [directory]
+
+static const char LOG_HEADER[] = "Tau Labs git hash:\nbenchmark\n0\n##\n";
+static const qint64 BODY_START = sizeof(LOG_HEADER) - 1;
+static const int NUM_OBJECTS = 40;
+static const int PACKETS_PER_MS = 2;
+static const int SEEKS = 10000;
+static const int LINEAR_SEEKS = 20;
+static const int REPLAY_BATCH = 2000;               // as LogFile::REPLAY_BATCH
+static const int QIODEVICE_BUFFER = 16 * 1024;      // what a buffered QIODevice reads at a time
+
+//! Fills @p packet with a UAVTalk object packet, returns its length
+static qint64 makePacket(char *packet, quint32 objId, quint32 seq)
+{
+    const quint16 payload = 12 + (objId % 8) * 16;
+    const quint16 length = 8 + payload;
+
+    packet[0] = 0x3C;
+    packet[1] = 0x20;
+    memcpy(packet + 2, &length, sizeof(length));
+    memcpy(packet + 4, &objId, sizeof(objId));
+    for (int i = 0; i < payload; i++)
+        packet[8 + i] = (char) (seq + i);
+    packet[length] = 0;
+
+    return length + 1;
+}
+
+static void flushChunk(QFile &file, LogIndex &index, QByteArray &chunk)
+{
+    if (chunk.isEmpty())
+        return;
+
+    file.write(index.chunkHeader(index.chunkCount() - 1));
+    file.write(chunk);
+    index.endChunk();
+    chunk.clear();
+}
+
+//! Writes a log of about @p size bytes, chunked the way LogFile does or as a legacy log
+static bool writeLog(const QString &name, qint64 size, bool indexed)
+{
+    QFile file(name);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    file.write(LOG_HEADER, BODY_START);
+    if (indexed)
+        file.write(LogIndex::containerHeader());
+
+    LogIndex index;
+    QByteArray chunk;
+    char packet[256];
+    for (quint32 seq = 0; file.pos() + chunk.size() < size; seq++) {
+        const quint32 timestamp = seq / PACKETS_PER_MS;
+        const quint32 objId = 0x5A000000 + (seq % NUM_OBJECTS) * 0x10325;
+        const qint64 length = makePacket(packet, objId, seq);
+
+        if (indexed && !chunk.isEmpty()) {
+            const LogChunkEntry &entry = index.chunk(index.chunkCount() - 1);
+            if (entry.bytes >= LogIndex::CHUNK_BYTES || timestamp - entry.firstTimestamp >= LogIndex::CHUNK_SPAN_MS)
+                flushChunk(file, index, chunk);
+        }
+        if (indexed && chunk.isEmpty())
+            index.beginChunk(file.pos());
+
+        chunk.append((const char *) &timestamp, sizeof(timestamp));
+        chunk.append((const char *) &length, sizeof(length));
+        chunk.append(packet, length);
+
+        if (indexed) {
+            index.addPacket(timestamp, packet, length);
+        } else if (chunk.size() >= (int) LogIndex::CHUNK_BYTES) {
+            file.write(chunk);
+            chunk.clear();
+        }
+    }
+
+    if (indexed) {
+        flushChunk(file, index, chunk);
+        return index.write(file, file.pos());
+    }
+    return file.write(chunk) == chunk.size();
+}
+
+//! The scan LogFile::startReplay did on every replay before the index
+static int scanAsBefore(QFile &file, QList<quint32> &timestampBuffer, QList<quint32> &timestampPos)
+{
+    file.seek(BODY_START);
+    while (!file.atEnd()) {
+        quint32 timestamp;
+        qint64 dataSize;
+
+        timestampPos.append(file.pos());
+        file.read((char *) &timestamp, sizeof(timestamp));
+        file.read((char *) &dataSize, sizeof(dataSize));
+        if ((dataSize & 0xFFFFFFFFFFFF0000) != 0) {
+            file.seek(timestampPos.last() + 1);
+            timestampPos.pop_back();
+            continue;
+        }
+        timestampBuffer.append(timestamp);
+        file.seek(timestampPos.last() + sizeof(timestamp) + sizeof(dataSize) + dataSize);
+    }
+    return timestampBuffer.size();
+}
+
+//! Positions at the first record at or after @p target, as LogFile::setReplayTime does
+static quint32 seek(QFile &file, const LogIndex &index, quint32 target)
+{
+    const int idx = index.findChunk(target);
+    const QByteArray chunk = index.readPayload(file, idx);
+
+    qint64 pos = 0;
+    LogRecord record;
+    record.timestamp = 0;
+    while (LogIndex::readRecord(chunk.constData(), chunk.size(), pos, record) && record.timestamp < target) {
+    }
+    return record.timestamp;
+}
+
+//! Stands in for UAVTalk, looks at every byte it is handed
+static quint32 consume(const char *data, qint64 length, quint32 sum)
+{
+    for (qint64 i = 0; i < length; i++)
+        sum = sum * 31 + (quint8) data[i];
+    return sum;
+}
+
+//! Replay as LogFile did before mapping: a seek and two reads per packet
+//! into dataBuffer, which the reader drains from the front
+static quint32 replayAsBefore(QFile &file, const QList<quint32> &timestampPos)
+{
+    QByteArray dataBuffer;
+    char buffer[QIODEVICE_BUFFER];
+    quint32 sum = 0;
+
+    for (int i = 0; i < timestampPos.size(); i++) {
+        qint64 dataSize;
+        file.seek(timestampPos[i] + sizeof(quint32));
+        file.read((char *) &dataSize, sizeof(dataSize));
+        dataBuffer.append(file.read(dataSize));
+
+        if ((i + 1) % REPLAY_BATCH != 0 && i + 1 != timestampPos.size())
+            continue;
+        while (!dataBuffer.isEmpty()) {
+            const int toRead = qMin(QIODEVICE_BUFFER, dataBuffer.size());
+            memcpy(buffer, dataBuffer.constData(), toRead);
+            dataBuffer.remove(0, toRead);
+            sum = consume(buffer, toRead, sum);
+        }
+    }
+    return sum;
+}
+
+//! Replay as LogFile does now, with records handed out in batches, in place
+//! when the log is mapped and copied from chunk reads when it is not
+static quint32 replayChunks(QFile &file, const LogIndex &index, const uchar *mapped)
+{
+    QList<QByteArray> records;
+    QByteArray chunkCopy;
+    quint32 sum = 0;
+
+    for (int i = 0; i < index.chunkCount(); i++) {
+        const char *chunk;
+        if (mapped) {
+            chunk = (const char *) mapped + index.payloadOffset(i);
+        } else {
+            chunkCopy = index.readPayload(file, i);
+            chunk = chunkCopy.constData();
+        }
+
+        qint64 pos = 0;
+        LogRecord record;
+        while (LogIndex::readRecord(chunk, index.chunk(i).bytes, pos, record)) {
+            if (mapped)
+                records.append(QByteArray::fromRawData(record.data, record.size));
+            else
+                records.append(QByteArray(record.data, record.size));
+
+            if (records.size() < REPLAY_BATCH)
+                continue;
+            foreach (const QByteArray &data, records)
+                sum = consume(data.constData(), data.size(), sum);
+            records.clear();
+        }
+    }
+    foreach (const QByteArray &data, records)
+        sum = consume(data.constData(), data.size(), sum);
+    return sum;
+}
+
+static void benchReplay(const char *what, QElapsedTimer &timer, quint64 packets, quint32 sum)
+{
+    const double secs = timer.nsecsElapsed() / 1e9;
+    printf("%-34s %12.0f packets/s  (%08x)\n", what, packets / secs, sum);
+}
+
+static double usecs(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1000.0;
+}
+
+static bool benchOpen(const char *what, QFile &file, LogIndex &index)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = index.load(file, BODY_START);
+    printf("%-34s %12.0f us  %llu packets in %d chunks%s\n", what, usecs(timer),
+           (unsigned long long) index.packetCount(), index.chunkCount(),
+           index.fromSidecar() ? " (sidecar)" : "");
+    return ok;
+}
+
+static void benchSeeks(QFile &file, const LogIndex &index)
+{
+    const quint32 first = index.firstTimestamp();
+    const quint32 span = index.lastTimestamp() - first + 1;
+    const QList<quint32> objIds = index.objectIds();
+
+    srand(1);
+    QElapsedTimer timer;
+    timer.start();
+    quint32 sum = 0;
+    for (int i = 0; i < SEEKS; i++)
+        sum += seek(file, index, first + rand() % span);
+    printf("%-34s %12.2f us  (%u)\n", "  random seek by time", usecs(timer) / SEEKS, sum);
+
+    timer.start();
+    int found = 0;
+    for (int i = 0; i < SEEKS; i++)
+        found += index.findObjectChunk(objIds.at(rand() % objIds.size()), first + rand() % span) >= 0;
+    printf("%-34s %12.3f us  (%d found)\n", "  random object lookup", usecs(timer) / SEEKS, found);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const QStringList args = a.arguments();
+    const qint64 size = (args.size() > 1 ? args.at(1).toLongLong() : 1024) * 1024 * 1024;
+    const QString dir = args.size() > 2 ? args.at(2) : QString(".");
+    const QString legacyName = dir + "/logbench_legacy.tll";
+    const QString indexedName = dir + "/logbench_indexed.tll";
+
+    QFile::remove(LogIndex::sidecarName(legacyName));
+    if (!writeLog(legacyName, size, false) || !writeLog(indexedName, size, true)) {
+        printf("Unable to write the logs to %s\n", qPrintable(dir));
+        return 1;
+    }
+    printf("%lld MB logs, %d objects, %d packets/ms\n\n", (long long) (size / (1024 * 1024)), NUM_OBJECTS, PACKETS_PER_MS);
+
+    QFile legacy(legacyName);
+    QFile indexed(indexedName);
+    legacy.open(QIODevice::ReadOnly);
+    indexed.open(QIODevice::ReadOnly);
+
+    // What every replay used to cost
+    QElapsedTimer timer;
+    timer.start();
+    QList<quint32> timestampBuffer;
+    QList<quint32> timestampPos;
+    const int records = scanAsBefore(legacy, timestampBuffer, timestampPos);
+    printf("%-34s %12.0f us  %d packets\n", "legacy, scan as before", usecs(timer), records);
+
+    srand(1);
+    timer.start();
+    quint32 sum = 0;
+    for (int i = 0; i < LINEAR_SEEKS; i++) {
+        const quint32 target = rand() % (timestampBuffer.last() + 1);
+        int idx = 0;
+        while (idx < timestampBuffer.size() - 1 && timestampBuffer[idx] < target)
+            idx++;
+        sum += timestampBuffer[idx];
+    }
+    printf("%-34s %12.2f us  (%u)\n", "  linear seek as before", usecs(timer) / LINEAR_SEEKS, sum);
+    timestampBuffer.clear();
+
+    timer.start();
+    sum = replayAsBefore(legacy, timestampPos);
+    benchReplay("  replay as before", timer, records, sum);
+    timestampPos.clear();
+
+    LogIndex index;
+    if (!benchOpen("legacy, first open", legacy, index))
+        return 1;
+    if (!benchOpen("legacy, open with sidecar", legacy, index))
+        return 1;
+    benchSeeks(legacy, index);
+
+    if (!benchOpen("indexed, open", indexed, index))
+        return 1;
+    benchSeeks(indexed, index);
+
+    timer.start();
+    sum = replayChunks(indexed, index, NULL);
+    benchReplay("  replay from chunk reads", timer, index.packetCount(), sum);
+
+    const uchar *mapped = indexed.map(0, indexed.size());
+    if (mapped) {
+        timer.start();
+        sum = replayChunks(indexed, index, mapped);
+        benchReplay("  replay from the mapping", timer, index.packetCount(), sum);
+    }
+
+    legacy.close();
+    indexed.close();
+    QFile::remove(legacyName);
+    QFile::remove(LogIndex::sidecarName(legacyName));
+    QFile::remove(indexedName);
+
+    return 0;
+}
@@ -42,6 +42,11 @@ SUBDIRS += plugin_uavobjects
 plugin_uavobjects.subdir = uavobjects
 plugin_uavobjects.depends = plugin_coreplugin
 
+# Headless log decoder, built from the UAVObjects sources
+SUBDIRS += app_logdecoder
+app_logdecoder.subdir = uavobjects/logdecoder
+app_logdecoder.depends = plugin_uavobjects
+
 # UAVTalk plugin
 SUBDIRS += plugin_uavtalk
 plugin_uavtalk.subdir = uavtalk
@@ -41,7 +41,6 @@
  * @param p_uavFieldName The plotted UAVO field name
  */
 Plot2dData::Plot2dData(QString p_uavObject, QString p_uavFieldName):
-    yDataHistory(0),
     dataUpdated(false)
 {
     uavObjectName = p_uavObject;
@@ -61,13 +60,13 @@ Plot2dData::Plot2dData(QString p_uavObject, QString p_uavFieldName):
 
     xData = new QVector<double>();
     yData = new QVector<double>();
-    yDataHistory = new QVector<double>();
+
+    plottedObject = NULL;
+    plottedObjectField = NULL;
+    subFieldIndex = 0;
 
     scalePower = 0;
     meanSamples = 1;
-    meanSum = 0.0f;
-    correctionSum = 0.0f;
-    correctionCount = 0;
     yMinimum = 0;
     yMaximum = 120;
 
@@ -104,11 +103,12 @@ Plot3dData::Plot3dData(QString p_uavObject, QString p_uavFieldName):
     zDataHistory = new QVector<double>();
     timeDataHistory = new QVector<double>();
 
+    plottedObject = NULL;
+    plottedObjectField = NULL;
+    subFieldIndex = 0;
+
     scalePower = 0;
     meanSamples = 1;
-    meanSum = 0.0f;
-    correctionSum = 0.0f;
-    correctionCount = 0;
     xMinimum = 0;
     xMaximum = 16;
     yMinimum = 0;
@@ -124,8 +124,6 @@ Plot2dData::~Plot2dData()
         delete xData;
     if (yData != NULL)
         delete yData;
-    if (yDataHistory != NULL)
-        delete yDataHistory;
 }
 
 
@@ -145,23 +143,36 @@ Plot3dData::~Plot3dData()
 
 
 /**
- * @brief valueAsDouble Fetch the value from the UAVO and return it as a double
+ * @brief plottedField Get the plotted field of the UAVO. The field and the
+ * index of the subfield are looked up on the first update only, as this runs
+ * for every curve on every update of every plotted UAVO.
  * @param obj UAVO
- * @param field UAVO field
- * @param haveSubField TRUE if UAVO has subfield. FALSE if not.
- * @param uavSubFieldName UAVO subfield, if it exists
- * @return
+ * @return The plotted field, or NULL if this is not the plotted UAVO
  */
-double PlotData::valueAsDouble(UAVObject* obj, UAVObjectField* field, bool haveSubField, QString uavSubFieldName)
+UAVObjectField* PlotData::plottedField(UAVObject* obj)
 {
-    Q_UNUSED(obj);
-    QVariant value;
+    if (obj == plottedObject)
+        return plottedObjectField;
 
-    if(haveSubField){
-        int indexOfSubField = field->getElementNames().indexOf(QRegExp(uavSubFieldName, Qt::CaseSensitive, QRegExp::FixedString));
-        value = field->getValue(indexOfSubField);
-    }else
-        value = field->getValue();
+    if (uavObjectName != obj->getName())
+        return NULL;
+
+    plottedObject = obj;
+    plottedObjectField = obj->getField(uavFieldName);
+    subFieldIndex = 0;
+    if (plottedObjectField && haveSubField)
+        subFieldIndex = plottedObjectField->getElementNames().indexOf(uavSubFieldName);
+
+    return plottedObjectField;
+}
 
-    return value.toDouble();
+
+/**
+ * @brief valueAsDouble Fetch the value from the UAVO and return it as a double
+ * @param field UAVO field, the plotted field of the UAVO or of one of its instances
+ * @return
+ */
+double PlotData::valueAsDouble(UAVObjectField* field)
+{
+    return field->getDouble(subFieldIndex);
 }
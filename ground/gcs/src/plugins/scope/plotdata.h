@@ -46,16 +46,17 @@ class PlotData : public QObject
 {
     Q_OBJECT
 public:
-    double valueAsDouble(UAVObject* obj, UAVObjectField* field, bool haveSubField, QString uavSubFieldName);
+    UAVObjectField* plottedField(UAVObject* obj);
+    double valueAsDouble(UAVObjectField* field);
 
     //Setter functions
     void setXMinimum(double val){xMinimum=val;}
     virtual void setXMaximum(double val){xMaximum=val;}
     void setYMinimum(double val){yMinimum = val;}
     void setYMaximum(double val){yMaximum = val;}
-    void setXWindowSize(double val){m_xWindowSize=val;}
+    virtual void setXWindowSize(double val){m_xWindowSize=val;}
     void setScalePower(int val){scalePower = val;}
-    void setMeanSamples(int val){meanSamples = val;}
+    virtual void setMeanSamples(int val){meanSamples = val;}
     void setMathFunction(QString val){mathFunction = val;}
 
     //Getter functions
@@ -102,13 +103,14 @@ protected:
     QString uavSubFieldName;
     bool haveSubField;
 
+    // Resolved on the first update of the plotted object, see plottedField()
+    UAVObject* plottedObject;
+    UAVObjectField* plottedObjectField;
+    int subFieldIndex;
+
     int scalePower; //This is the power to which each value must be raised
     unsigned int meanSamples;
     QString mathFunction;
-    double meanSum;
-
-    double correctionSum;
-    int correctionCount;
 
 private:
 
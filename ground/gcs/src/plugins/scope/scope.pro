@@ -10,6 +10,7 @@ HEADERS += scopeplugin.h \
     scopes2d/histogramplotdata.h \
     scopes2d/histogramscopeconfig.h \
     scopes2d/scatterplotdata.h \
+    scopes2d/ringbufferseries.h \
     scopes2d/scatterplotscopeconfig.h \
     scopes3d/spectrogramplotdata.h \
     scopes3d/spectrogramscopeconfig.h \
@@ -29,6 +30,7 @@ SOURCES += scopeplugin.cpp \
     scopes2d/histogramplotdata.cpp \
     scopes2d/histogramscopeconfig.cpp \
     scopes2d/scatterplotdata.cpp \
+    scopes2d/ringbufferseries.cpp \
     scopes2d/scatterplotscopeconfig.cpp \
     scopes3d/spectrogramplotdata.cpp \
     scopes3d/spectrogramscopeconfig.cpp \
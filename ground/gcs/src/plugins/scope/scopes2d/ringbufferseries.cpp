@@ -0,0 +1,234 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ringbufferseries.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief Ring buffer of curve samples and moving window statistics
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "scopes2d/ringbufferseries.h"
+
+#include <math.h>
+
+
+RingBufferSeries::RingBufferSeries(int capacity, bool growable) :
+    buffer(qMax(1, capacity)),
+    head(0),
+    count(0),
+    growable(growable),
+    indexedX(false)
+{
+}
+
+
+/**
+ * @brief RingBufferSeries::setCapacity Resizes the buffer, keeping the newest samples
+ * @param capacity
+ */
+void RingBufferSeries::setCapacity(int capacity)
+{
+    capacity = qMax(1, capacity);
+    if (capacity == buffer.size())
+        return;
+
+    const int kept = qMin(count, capacity);
+    QVector<QPointF> resized(capacity);
+    for (int i = 0; i < kept; i++)
+        resized[i] = buffer.at((head + count - kept + i) % buffer.size());
+
+    buffer = resized;
+    head = 0;
+    count = kept;
+    d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+}
+
+
+/**
+ * @brief RingBufferSeries::append Appends a sample, dropping the oldest one
+ * if the buffer is full and cannot grow
+ */
+void RingBufferSeries::append(double x, double y)
+{
+    if (count == buffer.size()) {
+        if (growable) {
+            setCapacity(buffer.size() * 2);
+        } else {
+            head = (head + 1) % buffer.size();
+            count--;
+        }
+    }
+
+    buffer[(head + count) % buffer.size()] = QPointF(x, y);
+    count++;
+    d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+}
+
+
+void RingBufferSeries::removeFirst()
+{
+    if (count == 0)
+        return;
+
+    head = (head + 1) % buffer.size();
+    count--;
+    d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+}
+
+
+void RingBufferSeries::clear()
+{
+    head = 0;
+    count = 0;
+    d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+}
+
+
+QPointF RingBufferSeries::sample(size_t i) const
+{
+    const QPointF &point = buffer.at((head + i) % buffer.size());
+    if (indexedX)
+        return QPointF(i, point.y());
+    return point;
+}
+
+
+/**
+ * @brief RingBufferSeries::boundingRect Bounding rectangle of the samples,
+ * computed once per change of the samples rather than on every replot
+ */
+QRectF RingBufferSeries::boundingRect() const
+{
+    if (d_boundingRect.width() >= 0.0 || count == 0)
+        return d_boundingRect;
+
+    double minX = indexedX ? 0 : first().x();
+    double maxX = indexedX ? count - 1 : last().x();
+    double minY = first().y();
+    double maxY = minY;
+    for (int i = 0; i < count; i++) {
+        const QPointF &point = buffer.at((head + i) % buffer.size());
+        if (!indexedX) {
+            minX = qMin(minX, point.x());
+            maxX = qMax(maxX, point.x());
+        }
+        minY = qMin(minY, point.y());
+        maxY = qMax(maxY, point.y());
+    }
+
+    d_boundingRect = QRectF(minX, minY, maxX - minX, maxY - minY);
+    return d_boundingRect;
+}
+
+
+MovingStatistics::MovingStatistics(int window) :
+    values(qMax(1, window)),
+    head(0),
+    count(0),
+    sinceRecompute(0),
+    m_mean(0),
+    m2(0)
+{
+}
+
+
+void MovingStatistics::setWindow(int window)
+{
+    window = qMax(1, window);
+    if (window == values.size())
+        return;
+
+    values = QVector<double>(window);
+    clear();
+}
+
+
+void MovingStatistics::clear()
+{
+    head = 0;
+    count = 0;
+    sinceRecompute = 0;
+    m_mean = 0;
+    m2 = 0;
+}
+
+
+/**
+ * @brief MovingStatistics::append Adds a value to the window. Once the window
+ * is full the oldest value is taken out as the new one comes in.
+ */
+void MovingStatistics::append(double value)
+{
+    const int window = values.size();
+
+    if (count < window) {
+        values[(head + count) % window] = value;
+        count++;
+
+        const double delta = value - m_mean;
+        m_mean += delta / count;
+        m2 += delta * (value - m_mean);
+    } else {
+        const double oldest = values.at(head);
+        values[head] = value;
+        head = (head + 1) % window;
+
+        const double oldMean = m_mean;
+        m_mean += (value - oldest) / count;
+        m2 += (value - oldest) * (value - m_mean + oldest - oldMean);
+    }
+
+    // Start over from the window every window values, so that rounding
+    // errors of the removals cannot accumulate
+    if (++sinceRecompute >= window)
+        recompute();
+}
+
+
+void MovingStatistics::recompute()
+{
+    sinceRecompute = 0;
+    m_mean = 0;
+    m2 = 0;
+    for (int i = 0; i < count; i++) {
+        const double value = values.at((head + i) % values.size());
+        const double delta = value - m_mean;
+        m_mean += delta / (i + 1);
+        m2 += delta * (value - m_mean);
+    }
+}
+
+
+/**
+ * @brief MovingStatistics::variance Sample variance of the window, with Bessel's correction
+ */
+double MovingStatistics::variance() const
+{
+    if (count < 2 || m2 < 0)
+        return 0;
+    return m2 / (count - 1);
+}
+
+
+double MovingStatistics::standardDeviation() const
+{
+    return sqrt(variance());
+}
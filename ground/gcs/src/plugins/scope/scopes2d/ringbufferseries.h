@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ringbufferseries.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief Ring buffer of curve samples and moving window statistics
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef RINGBUFFERSERIES_H
+#define RINGBUFFERSERIES_H
+
+#include "qwt/src/qwt_series_data.h"
+
+#include <QPointF>
+#include <QVector>
+
+
+/**
+ * @brief The RingBufferSeries class Keeps the samples of a curve in a ring,
+ * appending and dropping the oldest sample are O(1). The curve draws from
+ * it in place, there is no copy of the samples on replot.
+ *
+ * A full buffer either overwrites its oldest sample, for plots of a fixed
+ * number of samples, or doubles its capacity when it is growable, for plots
+ * of a time span whose number of samples depends on the update rate.
+ */
+class RingBufferSeries : public QwtSeriesData<QPointF>
+{
+public:
+    RingBufferSeries(int capacity = 1, bool growable = false);
+
+    void setCapacity(int capacity);
+    int capacity() const { return buffer.size(); }
+
+    /*!
+      \brief The x of each sample is its position in the buffer, as
+      for the sequential plots, instead of the appended x
+      */
+    void setIndexedX(bool val) { indexedX = val; }
+
+    void append(double x, double y);
+    void removeFirst();
+    void clear();
+
+    bool isEmpty() const { return count == 0; }
+    const QPointF &first() const { return buffer.at(head); }
+    const QPointF &last() const { return buffer.at((head + count - 1) % buffer.size()); }
+
+    virtual size_t size() const { return count; }
+    virtual QPointF sample(size_t i) const;
+    virtual QRectF boundingRect() const;
+
+private:
+    QVector<QPointF> buffer;
+    int head;
+    int count;
+    bool growable;
+    bool indexedX;
+};
+
+
+/**
+ * @brief The MovingStatistics class Mean and sample variance of the last
+ * values appended, updated in O(1) per value with Welford's method.
+ */
+class MovingStatistics
+{
+public:
+    MovingStatistics(int window = 1);
+
+    void setWindow(int window);
+    void clear();
+    void append(double value);
+
+    double mean() const { return m_mean; }
+    double variance() const;
+    double standardDeviation() const;
+
+private:
+    void recompute();
+
+    QVector<double> values;
+    int head;
+    int count;
+    int sinceRecompute;
+    double m_mean;
+    double m2;
+};
+
+#endif // RINGBUFFERSERIES_H
@@ -49,13 +49,11 @@ void TimeSeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeCon
     Q_UNUSED(scopeConfig);
     Q_UNUSED(scopeGadgetWidget);
 
-    //Plot new data
+    //Plot new data, the curve draws straight from the samples
     if (readAndResetUpdatedFlag() == true)
-        curve->setSamples(*xData, *yData);
+        curve->itemChanged();
 
-    QDateTime NOW = QDateTime::currentDateTime();
-    double toTime = NOW.toTime_t();
-    toTime += NOW.time().msec() / 1000.0;
+    double toTime = QDateTime::currentMSecsSinceEpoch() / 1000.0;
 
     scopeGadgetWidget->setAxisScale(QwtPlot::xBottom, toTime - m_xWindowSize, toTime);
 }
@@ -71,9 +69,29 @@ void SeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeConfig,
     Q_UNUSED(scopeConfig);
     Q_UNUSED(scopeGadgetWidget);
 
-    //Plot new data
+    //Plot new data, the curve draws straight from the samples
     if (readAndResetUpdatedFlag() == true)
-        curve->setSamples(*xData, *yData);
+        curve->itemChanged();
+}
+
+
+/**
+ * @brief ScatterplotData::applyMathFunction Performs the scope math on a new value
+ * @param currentValue The new value
+ * @return The value to plot
+ */
+double ScatterplotData::applyMathFunction(double currentValue)
+{
+    if (mathFunction  == "Boxcar average") {
+        statistics.append(currentValue);
+        return statistics.mean();
+    } else if (mathFunction  == "Standard deviation") {
+        //Sample standard deviation, with Bessel's correction
+        statistics.append(currentValue);
+        return statistics.standardDeviation();
+    }
+
+    return currentValue;
 }
 
 
@@ -84,61 +102,17 @@ void SeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeConfig,
  */
 bool SeriesPlotData::append(UAVObject* obj)
 {
-    if (uavObjectName == obj->getName()) {
-
-        //Get the field of interest
-        UAVObjectField* field =  obj->getField(uavFieldName);
-
-        if (field) {
-
-            double currentValue = valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
-
-            //Perform scope math, if necessary
-            if (mathFunction  == "Boxcar average" || mathFunction  == "Standard deviation"){
-                //Put the new value at the front
-                yDataHistory->append( currentValue );
-
-                // calculate average value
-                meanSum += currentValue;
-                if(yDataHistory->size() > (int)meanSamples) {
-                    meanSum -= yDataHistory->first();
-                    yDataHistory->pop_front();
-                }
-
-                // make sure to correct the sum every meanSamples steps to prevent it
-                // from running away due to floating point rounding errors
-                correctionSum+=currentValue;
-                if (++correctionCount >= (int)meanSamples) {
-                    meanSum = correctionSum;
-                    correctionSum = 0.0f;
-                    correctionCount = 0;
-                }
-
-                double boxcarAvg=meanSum/yDataHistory->size();
-
-                if ( mathFunction  == "Standard deviation" ){
-                    //Calculate square of sample standard deviation, with Bessel's correction
-                    double stdSum=0;
-                    for (int i=0; i < yDataHistory->size(); i++){
-                        stdSum+= pow(yDataHistory->at(i)- boxcarAvg,2)/(meanSamples-1);
-                    }
-                    yData->append(sqrt(stdSum));
-                }
-                else  {
-                    yData->append(boxcarAvg);
-                }
-            }
-            else{
-                yData->append( currentValue );
-            }
-
-            if (yData->size() > getXWindowSize()) { //If new data overflows the window, remove old data...
-                yData->pop_front();
-            } else //...otherwise, add a new y point at position xData
-                xData->insert(xData->size(), xData->size());
-
-            return true;
-        }
+    //Get the field of interest
+    UAVObjectField* field = plottedField(obj);
+
+    if (field) {
+        double currentValue = valueAsDouble(field) * pow(10, scalePower);
+
+        //If new data overflows the window the oldest sample is dropped,
+        //the x of each sample is its position in the window
+        samples->append(0, applyMathFunction(currentValue));
+
+        return true;
     }
 
     return false;
@@ -152,60 +126,20 @@ bool SeriesPlotData::append(UAVObject* obj)
  */
 bool TimeSeriesPlotData::append(UAVObject* obj)
 {
-    if (uavObjectName == obj->getName()) {
-        //Get the field of interest
-        UAVObjectField* field =  obj->getField(uavFieldName);
-
-        if (field) {
-            QDateTime NOW = QDateTime::currentDateTime(); //THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
-            double currentValue = valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
-
-            //Perform scope math, if necessary
-            if (mathFunction  == "Boxcar average" || mathFunction  == "Standard deviation"){
-                //Put the new value at the back
-                yDataHistory->append( currentValue );
-
-                // calculate average value
-                meanSum += currentValue;
-                if(yDataHistory->size() > (int)meanSamples) {
-                    meanSum -= yDataHistory->first();
-                    yDataHistory->pop_front();
-                }
-                // make sure to correct the sum every meanSamples steps to prevent it
-                // from running away due to floating point rounding errors
-                correctionSum+=currentValue;
-                if (++correctionCount >= (int)meanSamples) {
-                    meanSum = correctionSum;
-                    correctionSum = 0.0f;
-                    correctionCount = 0;
-                }
-
-                double boxcarAvg=meanSum/yDataHistory->size();
-
-                if ( mathFunction  == "Standard deviation" ){
-                    //Calculate square of sample standard deviation, with Bessel's correction
-                    double stdSum=0;
-                    for (int i=0; i < yDataHistory->size(); i++){
-                        stdSum+= pow(yDataHistory->at(i)- boxcarAvg,2)/(meanSamples-1);
-                    }
-                    yData->append(sqrt(stdSum));
-                }
-                else  {
-                    yData->append(boxcarAvg);
-                }
-            }
-            else{
-                yData->append( currentValue );
-            }
-
-            double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
-            xData->append(valueX);
-
-            //Remove stale data
-            removeStaleData();
-
-            return true;
-        }
+    //Get the field of interest
+    UAVObjectField* field = plottedField(obj);
+
+    if (field) {
+        //THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
+        double valueX = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+        double currentValue = valueAsDouble(field) * pow(10, scalePower);
+
+        samples->append(valueX, applyMathFunction(currentValue));
+
+        //Remove stale data
+        removeStaleData();
+
+        return true;
     }
 
     return false;
@@ -217,22 +151,12 @@ bool TimeSeriesPlotData::append(UAVObject* obj)
  */
 void TimeSeriesPlotData::removeStaleData()
 {
-    double newestValue;
-    double oldestValue;
-
-    while (1) {
-        if (xData->size() == 0)
-            break;
+    if (samples->isEmpty())
+        return;
 
-        newestValue = xData->last();
-        oldestValue = xData->first();
-
-        if (newestValue - oldestValue > getXWindowSize()) {
-            yData->pop_front();
-            xData->pop_front();
-        } else
-            break;
-    }
+    const double newestValue = samples->last().x();
+    while (newestValue - samples->first().x() > getXWindowSize())
+        samples->removeFirst();
 }
 
 
@@ -252,6 +176,7 @@ void ScatterplotData::deletePlots(PlotData *scatterplotData)
 {
     curve->detach();
 
+    // Also deletes the samples
     delete curve;
     delete scatterplotData;
 }
@@ -262,6 +187,6 @@ void ScatterplotData::deletePlots(PlotData *scatterplotData)
  */
 void ScatterplotData::clearPlots()
 {
-    yData->clear();
-    xData->clear();
+    samples->clear();
+    statistics.clear();
 }
@@ -29,6 +29,7 @@
 #define SCATTERPLOTDATA_H
 
 #include "scopes2d/plotdata2d.h"
+#include "scopes2d/ringbufferseries.h"
 #include "uavobject.h"
 #include "qwt/src/qwt_plot_curve.h"
 
@@ -44,17 +45,25 @@ class ScatterplotData : public Plot2dData
 {
     Q_OBJECT
 public:
-    ScatterplotData(QString uavObject, QString uavField):
-        Plot2dData(uavObject, uavField){curve = 0;}
-    ~ScatterplotData(){}
+    ScatterplotData(QString uavObject, QString uavField, bool growable):
+        Plot2dData(uavObject, uavField){curve = 0; samples = new RingBufferSeries(1, growable);}
+    ~ScatterplotData(){if (curve == 0) delete samples;}
 
     virtual void deletePlots(PlotData *);
     void clearPlots();
+    virtual void setMeanSamples(int val){meanSamples = val; statistics.setWindow(val);}
 
-    void setCurve(QwtPlotCurve *val){curve = val;}
+    /*!
+      \brief Hands the samples to the curve, which owns them from then on
+      */
+    void setCurve(QwtPlotCurve *val){curve = val; curve->setSamples(samples);}
 
 protected:
+    double applyMathFunction(double currentValue);
+
     QwtPlotCurve* curve;
+    RingBufferSeries* samples;
+    MovingStatistics statistics;
 };
 
 
@@ -68,9 +77,11 @@ class SeriesPlotData : public ScatterplotData
     Q_OBJECT
 public:
     SeriesPlotData(QString uavObject, QString uavField)
-            : ScatterplotData(uavObject, uavField) {}
+            : ScatterplotData(uavObject, uavField, false) {samples->setIndexedX(true);}
     ~SeriesPlotData() {}
 
+    virtual void setXWindowSize(double val){m_xWindowSize = val; samples->setCapacity((int)val);}
+
     /*!
       \brief Append new data to the plot
       */
@@ -94,7 +105,7 @@ class TimeSeriesPlotData : public ScatterplotData
     Q_OBJECT
 public:
     TimeSeriesPlotData(QString uavObject, QString uavField)
-            : ScatterplotData(uavObject, uavField) {
+            : ScatterplotData(uavObject, uavField, true) {
         scalePower = 1;
     }
     ~TimeSeriesPlotData() {
@@ -135,7 +135,7 @@ bool SpectrogramData::append(UAVObject* multiObj)
     QDateTime NOW = QDateTime::currentDateTime(); //TODO: Upgrade this to show UAVO time and not system time
 
     // Check to make sure it's the correct UAVO
-    if (uavObjectName == multiObj->getName()) {
+    if (plottedField(multiObj)) {
 
         // Only run on UAVOs that have multiple instances
         if (multiObj->isSingleInstance())
@@ -176,7 +176,7 @@ bool SpectrogramData::append(UAVObject* multiObj)
             foreach (UAVObject *obj, list) {
                 UAVObjectField* field =  obj->getField(uavFieldName);
 
-                double currentValue = valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
+                double currentValue = valueAsDouble(field) * pow(10, scalePower);
 
                 double vecVal = currentValue;
                 //Normally some math would go here, modifying vecVal before appending it to values
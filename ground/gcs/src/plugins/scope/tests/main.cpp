@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Benchmark of appending to and redrawing the scope curves
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QVector>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "scopes2d/ringbufferseries.h"
+#include "qwt/src/qwt_plot_curve.h"
+#include "qwt/src/qwt_scale_map.h"
+
+// Usage: scopebench [-platform offscreen]
+
+static const int WINDOWS[] = { 1000, 10000, 100000 };
+static const int MEAN_SAMPLES[] = { 10, 100, 1000 };
+static const int APPENDS = 20000;
+static const int REDRAWS = 20;
+
+static double value(int i)
+{
+    return sin(i * 0.01) * 100 + (rand() % 100) / 10.0;
+}
+
+//! A sequential curve as SeriesPlotData kept it before the ring buffer
+static void appendAsBefore(QVector<double> &xData, QVector<double> &yData, double y, int window)
+{
+    yData.append(y);
+    if (yData.size() > window)
+        yData.pop_front();
+    else
+        xData.append(xData.size());
+}
+
+//! The standard deviation math function as it was computed before
+static double stdAsBefore(QVector<double> &history, double y, int meanSamples)
+{
+    history.append(y);
+    if (history.size() > meanSamples)
+        history.pop_front();
+
+    double sum = 0;
+    for (int i = 0; i < history.size(); i++)
+        sum += history.at(i);
+    const double mean = sum / history.size();
+
+    double stdSum = 0;
+    for (int i = 0; i < history.size(); i++)
+        stdSum += pow(history.at(i) - mean, 2) / (meanSamples - 1);
+    return sqrt(stdSum);
+}
+
+//! Draws the curve as a replot of the scope does, autoscale included
+static double redraw(QwtPlotCurve &curve, QPainter &painter, const QRectF &canvas)
+{
+    const QRectF bounds = curve.boundingRect();
+
+    QwtScaleMap xMap;
+    QwtScaleMap yMap;
+    xMap.setScaleInterval(bounds.left(), bounds.right());
+    xMap.setPaintInterval(canvas.left(), canvas.right());
+    yMap.setScaleInterval(bounds.top(), bounds.bottom());
+    yMap.setPaintInterval(canvas.bottom(), canvas.top());
+    curve.draw(&painter, xMap, yMap, canvas);
+
+    return bounds.height();
+}
+
+static double usecs(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+
+    QImage image(1200, 400, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    const QRectF canvas(image.rect());
+
+    printf("%-10s %16s %16s %14s %14s\n", "window", "appends/s before", "appends/s ring", "redraw before", "redraw ring");
+    for (unsigned int w = 0; w < sizeof(WINDOWS) / sizeof(WINDOWS[0]); w++) {
+        const int window = WINDOWS[w];
+        QElapsedTimer timer;
+        double check = 0;
+
+        // Appends to a full window, where every sample drops the oldest one
+        QVector<double> xData;
+        QVector<double> yData;
+        for (int i = 0; i < window; i++)
+            appendAsBefore(xData, yData, value(i), window);
+        timer.start();
+        for (int i = 0; i < APPENDS; i++)
+            appendAsBefore(xData, yData, value(i), window);
+        const double appendBefore = APPENDS / (usecs(timer) / 1e6);
+
+        RingBufferSeries *samples = new RingBufferSeries(window);
+        samples->setIndexedX(true);
+        for (int i = 0; i < window; i++)
+            samples->append(0, value(i));
+        timer.start();
+        for (int i = 0; i < APPENDS; i++)
+            samples->append(0, value(i));
+        const double appendRing = APPENDS / (usecs(timer) / 1e6);
+
+        // Redraws, each after a new sample
+        QwtPlotCurve before;
+        timer.start();
+        for (int i = 0; i < REDRAWS; i++) {
+            appendAsBefore(xData, yData, value(i), window);
+            before.setSamples(xData, yData);
+            check += redraw(before, painter, canvas);
+        }
+        const double redrawBefore = usecs(timer) / REDRAWS;
+
+        QwtPlotCurve ring;
+        ring.setSamples(samples);
+        timer.start();
+        for (int i = 0; i < REDRAWS; i++) {
+            samples->append(0, value(i));
+            ring.itemChanged();
+            check += redraw(ring, painter, canvas);
+        }
+        const double redrawRing = usecs(timer) / REDRAWS;
+
+        printf("%-10d %16.0f %16.0f %11.0f us %11.0f us  (%g)\n", window, appendBefore, appendRing, redrawBefore, redrawRing, check);
+    }
+
+    printf("\n%-10s %16s %16s\n", "mean of", "std/s before", "std/s Welford");
+    for (unsigned int m = 0; m < sizeof(MEAN_SAMPLES) / sizeof(MEAN_SAMPLES[0]); m++) {
+        const int meanSamples = MEAN_SAMPLES[m];
+        QElapsedTimer timer;
+        double check = 0;
+
+        QVector<double> history;
+        timer.start();
+        for (int i = 0; i < APPENDS; i++)
+            check += stdAsBefore(history, value(i), meanSamples);
+        const double before = APPENDS / (usecs(timer) / 1e6);
+
+        MovingStatistics statistics(meanSamples);
+        timer.start();
+        for (int i = 0; i < APPENDS; i++) {
+            statistics.append(value(i));
+            check += statistics.standardDeviation();
+        }
+        const double welford = APPENDS / (usecs(timer) / 1e6);
+
+        printf("%-10d %16.0f %16.0f  (%g)\n", meanSamples, before, welford, check);
+    }
+
+    return 0;
+}
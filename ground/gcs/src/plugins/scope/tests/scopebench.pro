@@ -0,0 +1,16 @@
+# -------------------------------------------------
+# Benchmark of appending to and redrawing the scope
+# curves against the size of their window
+# -------------------------------------------------
+include(../../../../gcs.pri)
+include(../../../libs/qwt/qwt.pri)
+
+QT += widgets
+TARGET = scopebench
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+INCLUDEPATH += ..
+SOURCES += main.cpp \
+    ../scopes2d/ringbufferseries.cpp
+HEADERS += ../scopes2d/ringbufferseries.h
@@ -0,0 +1,730 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logdecoder.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Decodes GCS and onboard logs into per object tables without
+ *             going through UAVTalk and the object manager
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logdecoder.h"
+#include "uavobjectmanager.h"
+#include "uavobjectfield.h"
+#include <QRunnable>
+#include <QThreadPool>
+#include <QtEndian>
+#include <algorithm>
+#include <string.h>
+
+static const char LOG_HEADER[] = "Tau Labs git hash:";
+static const char LOG_BODY_SEPARATOR[] = "##\n";
+
+const quint8 LogDecoder::crc_table[256] = {
+    0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d,
+    0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65, 0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d,
+    0xe0, 0xe7, 0xee, 0xe9, 0xfc, 0xfb, 0xf2, 0xf5, 0xd8, 0xdf, 0xd6, 0xd1, 0xc4, 0xc3, 0xca, 0xcd,
+    0x90, 0x97, 0x9e, 0x99, 0x8c, 0x8b, 0x82, 0x85, 0xa8, 0xaf, 0xa6, 0xa1, 0xb4, 0xb3, 0xba, 0xbd,
+    0xc7, 0xc0, 0xc9, 0xce, 0xdb, 0xdc, 0xd5, 0xd2, 0xff, 0xf8, 0xf1, 0xf6, 0xe3, 0xe4, 0xed, 0xea,
+    0xb7, 0xb0, 0xb9, 0xbe, 0xab, 0xac, 0xa5, 0xa2, 0x8f, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9d, 0x9a,
+    0x27, 0x20, 0x29, 0x2e, 0x3b, 0x3c, 0x35, 0x32, 0x1f, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0d, 0x0a,
+    0x57, 0x50, 0x59, 0x5e, 0x4b, 0x4c, 0x45, 0x42, 0x6f, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7d, 0x7a,
+    0x89, 0x8e, 0x87, 0x80, 0x95, 0x92, 0x9b, 0x9c, 0xb1, 0xb6, 0xbf, 0xb8, 0xad, 0xaa, 0xa3, 0xa4,
+    0xf9, 0xfe, 0xf7, 0xf0, 0xe5, 0xe2, 0xeb, 0xec, 0xc1, 0xc6, 0xcf, 0xc8, 0xdd, 0xda, 0xd3, 0xd4,
+    0x69, 0x6e, 0x67, 0x60, 0x75, 0x72, 0x7b, 0x7c, 0x51, 0x56, 0x5f, 0x58, 0x4d, 0x4a, 0x43, 0x44,
+    0x19, 0x1e, 0x17, 0x10, 0x05, 0x02, 0x0b, 0x0c, 0x21, 0x26, 0x2f, 0x28, 0x3d, 0x3a, 0x33, 0x34,
+    0x4e, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5c, 0x5b, 0x76, 0x71, 0x78, 0x7f, 0x6a, 0x6d, 0x64, 0x63,
+    0x3e, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2c, 0x2b, 0x06, 0x01, 0x08, 0x0f, 0x1a, 0x1d, 0x14, 0x13,
+    0xae, 0xa9, 0xa0, 0xa7, 0xb2, 0xb5, 0xbc, 0xbb, 0x96, 0x91, 0x98, 0x9f, 0x8a, 0x8d, 0x84, 0x83,
+    0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3
+};
+
+/*
+ * A part of the log decoded by one thread. GCS logs are split between
+ * the chunks of their index, onboard logs are split into byte ranges.
+ *
+ * What a segment cannot know without the segments before it is left to
+ * merge(): where the packets of an onboard log really start, the wraps of
+ * its 16 bit timestamps that happened earlier and the keyframes of deltas
+ * sent before the segment.
+ */
+struct LogDecoder::Segment {
+    struct Keyframe {
+        quint8 seq;
+        QByteArray image;
+    };
+
+    //! Delta ahead of the first keyframe of its instance within the segment
+    struct PendingDelta {
+        quint32 objId;
+        quint16 instId;
+        int row;                    //!< placeholder row filled in by merge()
+        QByteArray delta;
+    };
+
+    Segment() :
+        firstChunk(0), endChunk(0), begin(0), end(0), start(0), stop(0),
+        timed(false), firstRaw(0), lastRaw(0), wraps(0), lastTimestamp(UNTIMED),
+        packets(0), errors(0), unknown(0), droppedDeltas(0)
+    {
+    }
+
+    void reset(qint64 from)
+    {
+        Segment restarted;
+        restarted.begin = from;
+        restarted.end = end;
+        *this = restarted;
+    }
+
+    int firstChunk;                 //!< GCS logs: chunks [firstChunk, endChunk)
+    int endChunk;
+    qint64 begin;                   //!< onboard logs: packets starting in [begin, end)
+    qint64 end;
+    qint64 start;                   //!< first packet decoded
+    qint64 stop;                    //!< first packet left to the next segment
+
+    bool timed;                     //!< a packet had a timestamp
+    quint16 firstRaw;
+    quint16 lastRaw;
+    quint32 wraps;
+    quint32 lastTimestamp;          //!< relative to the wraps before the segment
+
+    QHash<quint32, LogObjectRows> rows;
+    QHash<quint64, Keyframe> keyframes;
+    QVector<PendingDelta> pending;
+
+    quint64 packets;
+    quint64 errors;
+    quint64 unknown;
+    quint64 droppedDeltas;
+};
+
+//! Runs on the thread pool, there is no event loop involved
+class LogDecoder::SegmentTask : public QRunnable
+{
+public:
+    SegmentTask(const LogDecoder *decoder, Segment *segment) :
+        decoder(decoder), segment(segment)
+    {
+    }
+
+    void run()
+    {
+        decoder->decodeSegment(*segment);
+    }
+
+private:
+    const LogDecoder *decoder;
+    Segment *segment;
+};
+
+static quint64 deltaKey(quint32 objId, quint16 instId)
+{
+    return ((quint64)objId << 16) | instId;
+}
+
+/**
+ * Applies a delta payload (sequence byte, bitmap of the changed bytes and
+ * the changed bytes) to the keyframe image, as UAVTalk::receiveDelta does.
+ */
+static bool applyDelta(QByteArray &image, const quint8 *data, qint64 length)
+{
+    const qint64 objLength = image.size();
+    const qint64 mapLength = (objLength + 7) / 8;
+    qint64 changed = 1 + mapLength;
+    if (length < changed)
+        return false;
+
+    char *out = image.data();
+    for (qint64 n = 0; n < objLength; ++n) {
+        if (data[1 + n / 8] & (1 << (n % 8))) {
+            if (changed >= length)
+                return false;
+            out[n] = data[changed++];
+        }
+    }
+
+    return changed == length;
+}
+
+/**
+ * @brief LogDecoder::LogDecoder Takes the layout of every object known to
+ * the manager. The objects themselves are not used while decoding.
+ */
+LogDecoder::LogDecoder(UAVObjectManager *objMngr) :
+    type(LOG_AUTO),
+    bodyStart(0),
+    logData(NULL),
+    logSize(0),
+    packets(0),
+    errors(0),
+    unknown(0),
+    droppedDeltas(0)
+{
+    QVector< QVector<UAVObject*> > objects = objMngr->getObjectsVector();
+    foreach (const QVector<UAVObject*> &instances, objects) {
+        if (!instances.isEmpty())
+            addObject(instances.first());
+    }
+}
+
+LogDecoder::~LogDecoder()
+{
+    close();
+}
+
+void LogDecoder::addObject(UAVObject *obj)
+{
+    LogObjectLayout layout;
+    layout.objId = obj->getObjID();
+    layout.name = obj->getName();
+    layout.singleInstance = obj->isSingleInstance();
+    layout.numBytes = obj->getNumBytes();
+
+    // Fields are packed in order, the same way UAVObject::unpack reads them
+    quint32 offset = 0;
+    foreach (UAVObjectField *field, obj->getFields()) {
+        LogFieldLayout f;
+        f.name = field->getName();
+        f.type = field->getType();
+        f.typeName = field->getTypeAsString();
+        f.offset = offset;
+        f.numBytes = field->getNumBytes();
+        f.numElements = field->getNumElements();
+        f.elementBytes = (f.type == UAVObjectField::BITFIELD || f.numElements == 0) ? 0 : f.numBytes / f.numElements;
+        f.elementNames = field->getElementNames();
+        f.options = field->getOptions();
+        f.optionValues = field->getIndices();
+        layout.fields.append(f);
+        offset += f.numBytes;
+    }
+
+    layoutIndex.insert(layout.objId, layouts.size());
+    layouts.append(layout);
+}
+
+/**
+ * @brief LogDecoder::open Opens a log and maps it
+ * @param type LOG_AUTO tells GCS logs from onboard logs by the "##" line
+ * that only GCS logs have after the header
+ */
+bool LogDecoder::open(const QString &fileName, LogType type)
+{
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Unable to open %1").arg(fileName);
+        return false;
+    }
+
+    if (!readHeader(type)) {
+        close();
+        return false;
+    }
+
+    logSize = file.size();
+    logData = file.map(0, logSize);
+    if (logData == NULL) {
+        file.seek(0);
+        contents = file.readAll();
+        logData = (const uchar *) contents.constData();
+    }
+
+    if (this->type == LOG_GCS && !index.load(file, bodyStart)) {
+        error = QString("No log data found in %1").arg(fileName);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void LogDecoder::close()
+{
+    index.clear();
+    contents.clear();
+    logData = NULL;
+    logSize = 0;
+    file.close();
+}
+
+bool LogDecoder::readHeader(LogType requested)
+{
+    if (!file.readLine().startsWith(LOG_HEADER)) {
+        error = QString("%1 is not a Tau Labs log").arg(file.fileName());
+        return false;
+    }
+
+    logGitHash = QString::fromLatin1(file.readLine().trimmed());
+    logUavoHash = QString::fromLatin1(file.readLine().trimmed());
+
+    // Onboard logs go straight from the header to the UAVTalk stream
+    qint64 streamStart = file.pos();
+    bool separator = (file.readLine() == LOG_BODY_SEPARATOR);
+
+    type = requested;
+    if (type == LOG_AUTO)
+        type = separator ? LOG_GCS : LOG_ONBOARD;
+
+    if (type == LOG_GCS && !separator) {
+        error = QString("%1 has no header separator, it is not a GCS log").arg(file.fileName());
+        return false;
+    }
+
+    bodyStart = (type == LOG_GCS) ? file.pos() : streamStart;
+    return true;
+}
+
+QList<quint32> LogDecoder::decodedObjects() const
+{
+    QList<quint32> objIds = objectRows.keys();
+    std::sort(objIds.begin(), objIds.end());
+    return objIds;
+}
+
+const LogObjectRows &LogDecoder::rows(quint32 objId) const
+{
+    return *objectRows.constFind(objId);
+}
+
+/**
+ * @brief LogDecoder::decode Decodes the whole log
+ * @param threads Number of threads to split the log between
+ * @return false if nothing could be decoded
+ */
+bool LogDecoder::decode(int threads)
+{
+    objectRows.clear();
+    packets = errors = unknown = droppedDeltas = 0;
+
+    if (logData == NULL) {
+        error = "No log open";
+        return false;
+    }
+
+    QVector<Segment *> segments;
+    if (type == LOG_GCS) {
+        const int chunks = index.chunkCount();
+        const int count = qBound(1, threads, chunks);
+        for (int i = 0; i < count; i++) {
+            Segment *segment = new Segment;
+            segment->firstChunk = (qint64) chunks * i / count;
+            segment->endChunk = (qint64) chunks * (i + 1) / count;
+            segments.append(segment);
+        }
+    } else {
+        const qint64 bytes = logSize - bodyStart;
+        const int count = (int) qBound((qint64) 1, (qint64) threads, qMax((qint64) 1, bytes / MIN_SEGMENT_BYTES));
+        for (int i = 0; i < count; i++) {
+            Segment *segment = new Segment;
+            segment->begin = bodyStart + bytes * i / count;
+            segment->end = bodyStart + bytes * (i + 1) / count;
+            segments.append(segment);
+        }
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(segments.size());
+    foreach (Segment *segment, segments)
+        pool.start(new SegmentTask(this, segment));
+    pool.waitForDone();
+
+    merge(segments);
+    qDeleteAll(segments);
+
+    if (packets == 0) {
+        error = QString("No packets found in %1").arg(file.fileName());
+        return false;
+    }
+    return true;
+}
+
+void LogDecoder::decodeSegment(Segment &segment) const
+{
+    if (type == LOG_GCS)
+        decodeRecords(segment);
+    else
+        decodeStream(segment);
+}
+
+/**
+ * @brief LogDecoder::decodeRecords Decodes the records of the chunks of a
+ * GCS log. Every record holds whole packets, stamped with the record time.
+ */
+void LogDecoder::decodeRecords(Segment &segment) const
+{
+    for (int i = segment.firstChunk; i < segment.endChunk; i++) {
+        const qint64 offset = index.payloadOffset(i);
+        const qint64 length = qMin((qint64) index.chunk(i).bytes, logSize - offset);
+        if (offset >= logSize || length < (qint64) index.chunk(i).bytes) {
+            segment.errors++;
+            break;
+        }
+
+        const char *payload = (const char *) logData + offset;
+        qint64 pos = 0;
+        LogRecord record;
+        while (LogIndex::readRecord(payload, length, pos, record)) {
+            const quint8 *data = (const quint8 *) record.data;
+            qint64 used = 0;
+            while (used < record.size) {
+                qint64 n = decodePacket(segment, data + used, record.size - used, record.timestamp, true);
+                if (n == 0) {
+                    segment.errors++;
+                    break;
+                }
+                used += n;
+            }
+        }
+        if (pos != length)
+            segment.errors++;
+    }
+}
+
+/**
+ * @brief LogDecoder::decodeStream Decodes the packets starting in the byte
+ * range of an onboard log segment. The segment syncs on the first valid
+ * packet, merge() checks that this is where the previous segment stopped.
+ */
+void LogDecoder::decodeStream(Segment &segment) const
+{
+    const quint8 *data = logData;
+    qint64 pos = segment.begin;
+    bool synced = false;
+    bool lost = false;
+
+    while (pos < segment.end) {
+        qint64 n = decodePacket(segment, data + pos, logSize - pos, 0, false);
+        if (n > 0) {
+            if (!synced)
+                segment.start = pos;
+            synced = true;
+            lost = false;
+            pos += n;
+        } else {
+            if (synced && !lost)
+                segment.errors++;
+            lost = true;
+            pos++;
+        }
+    }
+
+    if (!synced)
+        segment.start = pos;
+    segment.stop = pos;
+}
+
+/**
+ * @brief LogDecoder::packetLength Checks the framing and checksum of the
+ * packet at @p data
+ * @return the length of the packet with its checksum, 0 if it is not valid
+ */
+qint64 LogDecoder::packetLength(const quint8 *data, qint64 length)
+{
+    if (length < MIN_HEADER_LENGTH + 1 || data[0] != SYNC_VAL || (data[1] & TYPE_MASK) != TYPE_VER)
+        return 0;
+
+    const qint64 size = qFromLittleEndian<quint16>(&data[2]);
+    if (size < MIN_HEADER_LENGTH || size > MAX_HEADER_LENGTH + TIMESTAMP_LENGTH + MAX_PAYLOAD_LENGTH || size + 1 > length)
+        return 0;
+
+    quint8 crc = 0;
+    for (qint64 i = 0; i < size; i++)
+        crc = crc_table[crc ^ data[i]];
+
+    return (crc == data[size]) ? size + 1 : 0;
+}
+
+/**
+ * @brief LogDecoder::decodePacket Decodes the packet at @p data into rows
+ * @param timestamp Record time of GCS logs
+ * @param gcsTimestamp Use @p timestamp instead of the packet timestamp
+ * @return the length of the packet, 0 if it is not valid
+ */
+qint64 LogDecoder::decodePacket(Segment &segment, const quint8 *data, qint64 length, quint32 timestamp, bool gcsTimestamp) const
+{
+    const qint64 n = packetLength(data, length);
+    if (n == 0)
+        return 0;
+
+    const qint64 size = n - 1;
+    const quint8 packetType = data[1] & ~TIMESTAMPED;
+    const bool timestamped = data[1] & TIMESTAMPED;
+    const quint32 objId = qFromLittleEndian<quint32>(&data[4]);
+
+    if (packetType != TYPE_OBJ && packetType != TYPE_OBJ_ACK &&
+            packetType != TYPE_OBJ_MULTI && packetType != TYPE_OBJ_DELTA)
+        return n; // requests and acknowledgements carry no data
+
+    int layoutIdx = -1;
+    if (packetType != TYPE_OBJ_MULTI) {
+        QHash<quint32, int>::const_iterator it = layoutIndex.constFind(objId);
+        if (it == layoutIndex.constEnd()) {
+            segment.unknown++;
+            return n;
+        }
+        layoutIdx = it.value();
+    }
+
+    qint64 header = MIN_HEADER_LENGTH;
+    quint16 instId = 0;
+    if (layoutIdx >= 0 && !layouts[layoutIdx].singleInstance) {
+        if (size < header + 2) {
+            segment.errors++;
+            return n;
+        }
+        instId = qFromLittleEndian<quint16>(&data[header]);
+        header += 2;
+    }
+
+    if (timestamped) {
+        if (size < header + TIMESTAMP_LENGTH) {
+            segment.errors++;
+            return n;
+        }
+        const quint16 raw = qFromLittleEndian<quint16>(&data[header]);
+        header += TIMESTAMP_LENGTH;
+
+        // Timestamps are milliseconds modulo 2^16, merge() adds the wraps
+        // that happened before the segment
+        if (!segment.timed) {
+            segment.timed = true;
+            segment.firstRaw = raw;
+        } else if (raw < segment.lastRaw) {
+            segment.wraps++;
+        }
+        segment.lastRaw = raw;
+        segment.lastTimestamp = (segment.wraps << 16) + raw;
+    }
+
+    if (!gcsTimestamp)
+        timestamp = segment.lastTimestamp;
+
+    const quint8 *payload = data + header;
+    const qint64 payloadLength = size - header;
+
+    segment.packets++;
+    if (packetType == TYPE_OBJ_MULTI) {
+        decodeMulti(segment, payload, payloadLength, timestamp);
+    } else if (packetType == TYPE_OBJ_DELTA) {
+        decodeDelta(segment, layouts[layoutIdx], instId, payload, payloadLength, timestamp);
+    } else if (payloadLength == (qint64) layouts[layoutIdx].numBytes) {
+        addRow(segment, layouts[layoutIdx], instId, payload, timestamp);
+    } else {
+        segment.errors++;
+    }
+
+    return n;
+}
+
+/**
+ * @brief LogDecoder::decodeMulti Decodes the entries of a batched frame,
+ * skipping the ones UAVTalk::receiveMultiObject would skip
+ */
+void LogDecoder::decodeMulti(Segment &segment, const quint8 *data, qint64 length, quint32 timestamp) const
+{
+    while (length >= MULTI_ENTRY_HEADER_LENGTH) {
+        const quint32 objId = qFromLittleEndian<quint32>(data);
+        const quint16 instId = qFromLittleEndian<quint16>(&data[4]);
+        const qint64 objLength = data[6];
+
+        data += MULTI_ENTRY_HEADER_LENGTH;
+        length -= MULTI_ENTRY_HEADER_LENGTH;
+        if (objLength > length) {
+            segment.errors++;
+            return;
+        }
+
+        QHash<quint32, int>::const_iterator it = layoutIndex.constFind(objId);
+        if (it == layoutIndex.constEnd()) {
+            segment.unknown++;
+        } else if (instId != ALL_INSTANCES && (instId & MULTI_DELTA_INSTID)) {
+            decodeDelta(segment, layouts[it.value()], instId & ~MULTI_DELTA_INSTID, data, objLength, timestamp);
+        } else if (instId != ALL_INSTANCES && layouts[it.value()].numBytes == objLength) {
+            addRow(segment, layouts[it.value()], instId, data, timestamp);
+        } else {
+            segment.errors++;
+        }
+
+        data += objLength;
+        length -= objLength;
+    }
+
+    if (length != 0)
+        segment.errors++;
+}
+
+/**
+ * @brief LogDecoder::decodeDelta Decodes a delta encoded update. Deltas
+ * whose keyframe came before the segment get a placeholder row that
+ * merge() fills in, or drops if the keyframe was lost.
+ */
+void LogDecoder::decodeDelta(Segment &segment, const LogObjectLayout &layout, quint16 instId, const quint8 *data, qint64 length, quint32 timestamp) const
+{
+    if (length < 1) {
+        segment.errors++;
+        return;
+    }
+
+    const quint64 key = deltaKey(layout.objId, instId);
+    if (data[0] & DELTA_KEYFRAME) {
+        if (length != layout.numBytes + 1) {
+            segment.errors++;
+            return;
+        }
+        Segment::Keyframe &keyframe = segment.keyframes[key];
+        keyframe.seq = data[0] & DELTA_SEQ_MASK;
+        keyframe.image = QByteArray((const char *) &data[1], layout.numBytes);
+        addRow(segment, layout, instId, &data[1], timestamp);
+        return;
+    }
+
+    QHash<quint64, Segment::Keyframe>::const_iterator keyframe = segment.keyframes.constFind(key);
+    if (keyframe == segment.keyframes.constEnd()) {
+        Segment::PendingDelta pending;
+        pending.objId = layout.objId;
+        pending.instId = instId;
+        pending.row = segment.rows[layout.objId].count();
+        pending.delta = QByteArray((const char *) data, length);
+        segment.pending.append(pending);
+        addRow(segment, layout, instId, NULL, timestamp);
+        return;
+    }
+
+    QByteArray image = keyframe->image;
+    if (keyframe->seq != data[0] || !applyDelta(image, data, length)) {
+        segment.droppedDeltas++;
+        return;
+    }
+    addRow(segment, layout, instId, (const quint8 *) image.constData(), timestamp);
+}
+
+void LogDecoder::addRow(Segment &segment, const LogObjectLayout &layout, quint16 instId, const quint8 *data, quint32 timestamp)
+{
+    LogObjectRows &rows = segment.rows[layout.objId];
+    rows.timestamps.append(timestamp);
+    rows.instances.append(instId);
+    if (data != NULL)
+        rows.data.append((const char *) data, layout.numBytes);
+    else
+        rows.data.append(QByteArray(layout.numBytes, 0));
+}
+
+/**
+ * @brief LogDecoder::merge Joins the segments in log order. This is the
+ * only sequential part: it re-decodes onboard log segments that synced on
+ * something else than the packet the previous segment stopped at, carries
+ * the timestamp wraps and keyframes from one segment to the next and
+ * appends the rows.
+ */
+void LogDecoder::merge(QVector<Segment *> &segments)
+{
+    QHash<quint64, Segment::Keyframe> keyframes;
+    quint32 lastTimestamp = 0;
+    bool timed = false;
+
+    for (int i = 0; i < segments.size(); i++) {
+        Segment &segment = *segments[i];
+
+        if (type == LOG_ONBOARD && i > 0 && segment.start != segments[i - 1]->stop) {
+            segment.reset(segments[i - 1]->stop);
+            decodeStream(segment);
+        }
+
+        // Wraps before the segment: the first timestamp of the segment is
+        // after the last one of the previous segment, as if decoded in one go
+        quint32 base = 0;
+        if (type == LOG_ONBOARD && timed && segment.timed) {
+            base = lastTimestamp & ~0xFFFF;
+            if (segment.firstRaw < (lastTimestamp & 0xFFFF))
+                base += 0x10000;
+        }
+
+        // Deltas against keyframes of earlier segments
+        QHash<quint32, QVector<int> > dropped;
+        foreach (const Segment::PendingDelta &pending, segment.pending) {
+            const LogObjectLayout &layout = layouts[layoutIndex.value(pending.objId)];
+            QHash<quint64, Segment::Keyframe>::const_iterator keyframe = keyframes.constFind(deltaKey(pending.objId, pending.instId));
+            QByteArray image;
+            if (keyframe != keyframes.constEnd() && keyframe->seq == (quint8) pending.delta[0]) {
+                image = keyframe->image;
+                if (!applyDelta(image, (const quint8 *) pending.delta.constData(), pending.delta.size()))
+                    image.clear();
+            }
+            if (image.isEmpty()) {
+                dropped[pending.objId].append(pending.row);
+                segment.droppedDeltas++;
+                continue;
+            }
+            memcpy(segment.rows[pending.objId].data.data() + (qint64) pending.row * layout.numBytes, image.constData(), layout.numBytes);
+        }
+        for (QHash<quint64, Segment::Keyframe>::const_iterator it = segment.keyframes.constBegin(); it != segment.keyframes.constEnd(); ++it)
+            keyframes.insert(it.key(), it.value());
+
+        for (QHash<quint32, LogObjectRows>::iterator it = segment.rows.begin(); it != segment.rows.end(); ++it) {
+            const quint32 numBytes = layouts[layoutIndex.value(it.key())].numBytes;
+            const QVector<int> skip = dropped.value(it.key());
+            LogObjectRows &from = it.value();
+            LogObjectRows &to = objectRows[it.key()];
+
+            to.timestamps.reserve(to.count() + from.count());
+            to.instances.reserve(to.count() + from.count());
+            to.data.reserve(to.data.size() + from.data.size());
+
+            const int first = to.count();
+            if (skip.isEmpty()) {
+                to.timestamps += from.timestamps;
+                to.instances += from.instances;
+                to.data.append(from.data);
+            } else {
+                int next = 0;
+                for (int row = 0; row < from.count(); row++) {
+                    if (next < skip.size() && skip[next] == row) {
+                        next++;
+                        continue;
+                    }
+                    to.timestamps.append(from.timestamps[row]);
+                    to.instances.append(from.instances[row]);
+                    to.data.append(from.data.constData() + (qint64) row * numBytes, numBytes);
+                }
+            }
+            from = LogObjectRows();
+
+            if (type == LOG_ONBOARD) {
+                for (int row = first; row < to.count(); row++) {
+                    quint32 &timestamp = to.timestamps[row];
+                    timestamp = (timestamp == UNTIMED) ? lastTimestamp : timestamp + base;
+                }
+            }
+        }
+
+        if (segment.timed) {
+            lastTimestamp = segment.lastTimestamp + base;
+            timed = true;
+        }
+
+        packets += segment.packets;
+        errors += segment.errors;
+        unknown += segment.unknown;
+        droppedDeltas += segment.droppedDeltas;
+    }
+}
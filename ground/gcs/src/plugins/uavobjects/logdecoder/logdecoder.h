@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logdecoder.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Decodes GCS and onboard logs into per object tables without
+ *             going through UAVTalk and the object manager
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGDECODER_H
+#define LOGDECODER_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "../../logging/logindex.h"
+
+class UAVObject;
+class UAVObjectManager;
+
+//! Where a field lives in the packed object data
+struct LogFieldLayout {
+    QString name;
+    int type;                       //!< UAVObjectField::FieldType
+    QString typeName;
+    quint32 offset;
+    quint32 numBytes;
+    quint32 numElements;
+    quint32 elementBytes;           //!< 0 for bitfields, whose elements are single bits
+    QStringList elementNames;
+    QStringList options;
+    QList<int> optionValues;        //!< enum value of each option
+};
+
+//! Layout of one object, taken from the generated object once
+struct LogObjectLayout {
+    quint32 objId;
+    QString name;
+    bool singleInstance;
+    quint32 numBytes;
+    QVector<LogFieldLayout> fields;
+};
+
+//! Decoded updates of one object, one row of packed object data per update
+struct LogObjectRows {
+    QVector<quint32> timestamps;
+    QVector<quint16> instances;
+    QByteArray data;                //!< rows of LogObjectLayout::numBytes, as sent
+
+    int count() const { return timestamps.size(); }
+};
+
+class LogDecoder
+{
+public:
+    enum LogType {
+        LOG_AUTO,
+        LOG_GCS,                    //!< records written by the GCS logging plugin
+        LOG_ONBOARD                 //!< raw timestamped UAVTalk stream from the Logging module
+    };
+
+    explicit LogDecoder(UAVObjectManager *objMngr);
+    ~LogDecoder();
+
+    bool open(const QString &fileName, LogType type = LOG_AUTO);
+    void close();
+    bool decode(int threads);
+
+    LogType logType() const { return type; }
+    QString gitHash() const { return logGitHash; }
+    QString uavoHash() const { return logUavoHash; }
+    QString errorString() const { return error; }
+
+    QList<quint32> decodedObjects() const;
+    const LogObjectLayout &layout(quint32 objId) const { return layouts[layoutIndex.value(objId)]; }
+    const LogObjectRows &rows(quint32 objId) const;
+
+    quint64 packetCount() const { return packets; }
+    quint64 errorCount() const { return errors; }
+    quint64 unknownCount() const { return unknown; }
+    quint64 droppedDeltaCount() const { return droppedDeltas; }
+
+private:
+    struct Segment;
+    class SegmentTask;
+
+    // Same wire format as UAVTalk, with the timestamped packet types the
+    // flight side uses for onboard logs
+    static const quint8 SYNC_VAL = 0x3C;
+    static const quint8 TYPE_MASK = 0x78;
+    static const quint8 TYPE_VER = 0x20;
+    static const quint8 TIMESTAMPED = 0x80;
+    static const quint8 TYPE_OBJ = (TYPE_VER | 0x00);
+    static const quint8 TYPE_OBJ_ACK = (TYPE_VER | 0x02);
+    static const quint8 TYPE_OBJ_MULTI = (TYPE_VER | 0x05);
+    static const quint8 TYPE_OBJ_DELTA = (TYPE_VER | 0x06);
+    static const int MIN_HEADER_LENGTH = 8;
+    static const int MAX_HEADER_LENGTH = 10;
+    static const int TIMESTAMP_LENGTH = 2;
+    static const int MAX_PAYLOAD_LENGTH = 256;
+    static const int MULTI_ENTRY_HEADER_LENGTH = 7;
+    static const quint16 MULTI_DELTA_INSTID = 0x8000;
+    static const quint16 ALL_INSTANCES = 0xFFFF;
+    static const quint8 DELTA_KEYFRAME = 0x80;
+    static const quint8 DELTA_SEQ_MASK = 0x7F;
+    static const quint32 UNTIMED = 0xFFFFFFFF;
+    static const qint64 MIN_SEGMENT_BYTES = 256 * 1024;
+    static const quint8 crc_table[256];
+
+    void addObject(UAVObject *obj);
+    bool readHeader(LogType requested);
+
+    void decodeSegment(Segment &segment) const;
+    void decodeRecords(Segment &segment) const;
+    void decodeStream(Segment &segment) const;
+    qint64 decodePacket(Segment &segment, const quint8 *data, qint64 length, quint32 timestamp, bool gcsTimestamp) const;
+    static qint64 packetLength(const quint8 *data, qint64 length);
+    void decodeMulti(Segment &segment, const quint8 *data, qint64 length, quint32 timestamp) const;
+    void decodeDelta(Segment &segment, const LogObjectLayout &layout, quint16 instId, const quint8 *data, qint64 length, quint32 timestamp) const;
+    static void addRow(Segment &segment, const LogObjectLayout &layout, quint16 instId, const quint8 *data, quint32 timestamp);
+
+    void merge(QVector<Segment *> &segments);
+
+    QVector<LogObjectLayout> layouts;
+    QHash<quint32, int> layoutIndex;
+
+    QFile file;
+    LogType type;
+    QString logGitHash;
+    QString logUavoHash;
+    QString error;
+    qint64 bodyStart;
+    LogIndex index;
+    const uchar *logData;           //!< the whole log, mapped or read into contents
+    qint64 logSize;
+    QByteArray contents;            //!< holds the log when it cannot be mapped
+
+    QHash<quint32, LogObjectRows> objectRows;
+    quint64 packets;
+    quint64 errors;
+    quint64 unknown;
+    quint64 droppedDeltas;
+};
+
+#endif // LOGDECODER_H
@@ -0,0 +1,43 @@
+# -------------------------------------------------
+# Headless log decoder, decodes GCS and onboard logs
+# into per object tables using the generated objects
+# -------------------------------------------------
+include(../../../../gcs.pri)
+
+QT -= gui
+TARGET = logdecoder
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+DESTDIR = $$GCS_APP_PATH
+macx {
+DESTDIR = $$GCS_BIN_PATH
+}
+
+# The object sources are built in, the tool does not load the plugins
+DEFINES += UAVOBJECTS_LIBRARY
+UAVOBJECT_SYNTHETICS=$${GCS_BUILD_TREE}/../../uavobject-synthetics/gcs
+INCLUDEPATH *= $$PWD/.. $$PWD/../../logging $$UAVOBJECT_SYNTHETICS
+DEPENDPATH *= $$PWD/.. $$UAVOBJECT_SYNTHETICS
+
+SOURCES += main.cpp \
+    logdecoder.cpp \
+    logtablewriter.cpp \
+    ../uavobject.cpp \
+    ../uavmetaobject.cpp \
+    ../uavobjectmanager.cpp \
+    ../uavdataobject.cpp \
+    ../uavobjectfield.cpp \
+    ../../logging/logindex.cpp
+HEADERS += logdecoder.h \
+    logtablewriter.h \
+    ../uavobject.h \
+    ../uavmetaobject.h \
+    ../uavobjectmanager.h \
+    ../uavdataobject.h \
+    ../uavobjectfield.h \
+    ../uavobjectsinit.h \
+    ../../logging/logindex.h
+
+HEADERS += $$files($$UAVOBJECT_SYNTHETICS/*.h)
+SOURCES += $$files($$UAVOBJECT_SYNTHETICS/*.cpp)
@@ -0,0 +1,322 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logtablewriter.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Writes the objects decoded from a log as one table per object
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logtablewriter.h"
+#include "uavobjectfield.h"
+#include <QDir>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QtEndian>
+#include <string.h>
+
+static const int COLUMNS_VERSION = 1;
+static const int WRITE_BUFFER_BYTES = 1024 * 1024;
+
+//! Writes the tables of one object on the thread pool
+class LogTableWriter::ObjectTask : public QRunnable
+{
+public:
+    ObjectTask(LogTableWriter *writer, quint32 objId) :
+        writer(writer), objId(objId)
+    {
+    }
+
+    void run()
+    {
+        writer->writeObject(objId);
+    }
+
+private:
+    LogTableWriter *writer;
+    quint32 objId;
+};
+
+LogTableWriter::LogTableWriter(const LogDecoder &decoder, const QString &directory, int formats) :
+    decoder(decoder),
+    directory(directory),
+    formats(formats)
+{
+}
+
+/**
+ * @brief LogTableWriter::write Writes the tables of all decoded objects,
+ * several objects at a time
+ * @return false if any table could not be written, see failures()
+ */
+bool LogTableWriter::write(int threads)
+{
+    failed.clear();
+
+    if (!QDir().mkpath(directory)) {
+        failed << directory;
+        return false;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, threads));
+    foreach (quint32 objId, decoder.decodedObjects())
+        pool.start(new ObjectTask(this, objId));
+    pool.waitForDone();
+
+    return failed.isEmpty();
+}
+
+QVector<LogTableWriter::Column> LogTableWriter::columns(const LogObjectLayout &layout) const
+{
+    QVector<Column> columns;
+
+    Column column;
+    column.field = NULL;
+    column.element = 0;
+
+    column.name = "timestamp";
+    column.source = SOURCE_TIMESTAMP;
+    columns.append(column);
+
+    if (!layout.singleInstance) {
+        column.name = "instance";
+        column.source = SOURCE_INSTANCE;
+        columns.append(column);
+    }
+
+    column.source = SOURCE_FIELD;
+    for (int i = 0; i < layout.fields.size(); i++) {
+        const LogFieldLayout &field = layout.fields[i];
+        column.field = &field;
+
+        if (field.type == UAVObjectField::STRING || field.numElements == 1) {
+            column.name = field.name;
+            column.element = 0;
+            columns.append(column);
+            continue;
+        }
+
+        for (quint32 e = 0; e < field.numElements; e++) {
+            column.name = field.name + "_" + field.elementNames.value(e, QString::number(e));
+            column.element = e;
+            columns.append(column);
+        }
+    }
+
+    return columns;
+}
+
+void LogTableWriter::writeObject(quint32 objId)
+{
+    const LogObjectLayout &layout = decoder.layout(objId);
+    const LogObjectRows &rows = decoder.rows(objId);
+    const QVector<Column> objectColumns = columns(layout);
+
+    bool ok = true;
+    if (formats & FORMAT_CSV)
+        ok &= writeCsv(layout, rows, objectColumns);
+    if (formats & FORMAT_COLUMNS)
+        ok &= writeColumns(layout, rows, objectColumns);
+
+    if (!ok) {
+        QMutexLocker locker(&mutex);
+        failed << layout.name;
+    }
+}
+
+bool LogTableWriter::writeCsv(const LogObjectLayout &layout, const LogObjectRows &rows, const QVector<Column> &columns) const
+{
+    QFile out(QDir(directory).filePath(layout.name + ".csv"));
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QByteArray buffer;
+    buffer.reserve(WRITE_BUFFER_BYTES + 4096);
+    for (int c = 0; c < columns.size(); c++) {
+        if (c > 0)
+            buffer.append(',');
+        buffer.append(columns[c].name.toLatin1());
+    }
+    buffer.append('\n');
+
+    for (int row = 0; row < rows.count(); row++) {
+        const char *data = rows.data.constData() + (qint64) row * layout.numBytes;
+        for (int c = 0; c < columns.size(); c++) {
+            const Column &column = columns[c];
+            if (c > 0)
+                buffer.append(',');
+            if (column.source == SOURCE_TIMESTAMP)
+                buffer.append(QByteArray::number(rows.timestamps[row]));
+            else if (column.source == SOURCE_INSTANCE)
+                buffer.append(QByteArray::number(rows.instances[row]));
+            else
+                appendValue(buffer, *column.field, column.element, data);
+        }
+        buffer.append('\n');
+
+        if (buffer.size() >= WRITE_BUFFER_BYTES) {
+            if (out.write(buffer) != buffer.size())
+                return false;
+            buffer.clear();
+        }
+    }
+
+    return out.write(buffer) == buffer.size();
+}
+
+void LogTableWriter::appendValue(QByteArray &line, const LogFieldLayout &field, quint32 element, const char *row) const
+{
+    const uchar *value = (const uchar *) row + field.offset + element * field.elementBytes;
+
+    switch (field.type) {
+    case UAVObjectField::INT8:
+        line.append(QByteArray::number(*(const qint8 *) value));
+        break;
+    case UAVObjectField::INT16:
+        line.append(QByteArray::number(qFromLittleEndian<qint16>(value)));
+        break;
+    case UAVObjectField::INT32:
+        line.append(QByteArray::number(qFromLittleEndian<qint32>(value)));
+        break;
+    case UAVObjectField::UINT8:
+        line.append(QByteArray::number(*value));
+        break;
+    case UAVObjectField::UINT16:
+        line.append(QByteArray::number(qFromLittleEndian<quint16>(value)));
+        break;
+    case UAVObjectField::UINT32:
+        line.append(QByteArray::number(qFromLittleEndian<quint32>(value)));
+        break;
+    case UAVObjectField::FLOAT32: {
+        quint32 bits = qFromLittleEndian<quint32>(value);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        line.append(QByteArray::number(f, 'g', 9));
+        break;
+    }
+    case UAVObjectField::ENUM: {
+        int option = field.optionValues.indexOf(*value);
+        if (option >= 0)
+            line.append(field.options[option].toLatin1());
+        else
+            line.append(QByteArray::number(*value));
+        break;
+    }
+    case UAVObjectField::BITFIELD:
+        value = (const uchar *) row + field.offset + element / 8;
+        line.append((*value >> (element % 8)) & 1 ? '1' : '0');
+        break;
+    case UAVObjectField::STRING: {
+        QByteArray text((const char *) value, field.numBytes);
+        int end = text.indexOf('\0');
+        if (end >= 0)
+            text.truncate(end);
+        line.append('"');
+        line.append(text.replace("\"", "\"\""));
+        line.append('"');
+        break;
+    }
+    }
+}
+
+bool LogTableWriter::writeColumns(const LogObjectLayout &layout, const LogObjectRows &rows, const QVector<Column> &columns) const
+{
+    QFile out(QDir(directory).filePath(layout.name + ".col"));
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QVector<int> widths;
+    QByteArray header;
+    header.append(QString("TLCOLUMNS\t%1\n").arg(COLUMNS_VERSION).toLatin1());
+    header.append(QString("object\t%1\t%2\n").arg(layout.name).arg(layout.objId, 8, 16, QChar('0')).toLatin1());
+    header.append(QString("rows\t%1\n").arg(rows.count()).toLatin1());
+    foreach (const Column &column, columns) {
+        QString type;
+        int width;
+        if (column.source == SOURCE_TIMESTAMP) {
+            type = "uint32";
+            width = sizeof(quint32);
+        } else if (column.source == SOURCE_INSTANCE) {
+            type = "uint16";
+            width = sizeof(quint16);
+        } else {
+            type = column.field->typeName;
+            if (column.field->type == UAVObjectField::STRING)
+                width = column.field->numBytes;
+            else if (column.field->type == UAVObjectField::BITFIELD)
+                width = sizeof(quint8);
+            else
+                width = column.field->elementBytes;
+        }
+        widths.append(width);
+
+        QString line = QString("column\t%1\t%2\t%3").arg(column.name).arg(type).arg(width);
+        if (column.source == SOURCE_FIELD && column.field->type == UAVObjectField::ENUM) {
+            QStringList options;
+            for (int i = 0; i < column.field->options.size(); i++)
+                options << QString("%1=%2").arg(column.field->optionValues.value(i, i)).arg(column.field->options[i]);
+            line += "\t" + options.join("|");
+        }
+        header.append(line.toLatin1());
+        header.append('\n');
+    }
+    header.append("data\n");
+
+    if (out.write(header) != header.size())
+        return false;
+
+    // Transpose the rows, one column at a time
+    const int count = rows.count();
+    const char *data = rows.data.constData();
+    QByteArray buffer;
+    for (int c = 0; c < columns.size(); c++) {
+        const Column &column = columns[c];
+        const int width = widths[c];
+
+        if (column.source == SOURCE_TIMESTAMP) {
+            buffer.resize(count * width);
+            for (int row = 0; row < count; row++)
+                qToLittleEndian<quint32>(rows.timestamps[row], (uchar *) buffer.data() + row * width);
+        } else if (column.source == SOURCE_INSTANCE) {
+            buffer.resize(count * width);
+            for (int row = 0; row < count; row++)
+                qToLittleEndian<quint16>(rows.instances[row], (uchar *) buffer.data() + row * width);
+        } else if (column.field->type == UAVObjectField::BITFIELD) {
+            buffer.resize(count);
+            const quint32 offset = column.field->offset + column.element / 8;
+            const int shift = column.element % 8;
+            for (int row = 0; row < count; row++)
+                buffer.data()[row] = (data[(qint64) row * layout.numBytes + offset] >> shift) & 1;
+        } else {
+            // Objects are sent little endian already
+            buffer.resize(count * width);
+            const quint32 offset = column.field->offset + column.element * column.field->elementBytes;
+            for (int row = 0; row < count; row++)
+                memcpy(buffer.data() + (qint64) row * width, data + (qint64) row * layout.numBytes + offset, width);
+        }
+
+        if (out.write(buffer) != buffer.size())
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logtablewriter.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Writes the objects decoded from a log as one table per object
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGTABLEWRITER_H
+#define LOGTABLEWRITER_H
+
+#include "logdecoder.h"
+#include <QMutex>
+
+/*
+ * Every object gets <Name>.csv, <Name>.col or both in the output directory.
+ * Rows are in log order, the columns are the timestamp in milliseconds,
+ * the instance for multi instance objects and one column per element of
+ * every field. Elements are named Field_Element, or just Field for fields
+ * with a single element.
+ *
+ * The .col files hold the columns one after the other, so that each can be
+ * loaded as a plain array (numpy.fromfile, MATLAB fread...). A text header
+ * describes them:
+ *
+ *     TLCOLUMNS 1
+ *     object <name> <object id in hex>
+ *     rows <number of rows>
+ *     column <name> <type> <bytes per value> [<value>=<option>|...]
+ *     ...
+ *     data
+ *
+ * Fields are separated by tabs, the data starts after the newline of the
+ * "data" line. Values are little endian. Types are the UAVObject field
+ * types: bitfields are expanded to one 0/1 column per bit, enums keep
+ * their value and list their options, strings are a single column of
+ * fixed width.
+ */
+class LogTableWriter
+{
+public:
+    enum Format {
+        FORMAT_CSV = 0x1,
+        FORMAT_COLUMNS = 0x2
+    };
+
+    LogTableWriter(const LogDecoder &decoder, const QString &directory, int formats);
+
+    bool write(int threads);
+    QStringList failures() const { return failed; }
+
+private:
+    class ObjectTask;
+
+    enum Source {
+        SOURCE_TIMESTAMP,
+        SOURCE_INSTANCE,
+        SOURCE_FIELD
+    };
+
+    struct Column {
+        QString name;
+        Source source;
+        const LogFieldLayout *field;
+        quint32 element;
+    };
+
+    QVector<Column> columns(const LogObjectLayout &layout) const;
+    void writeObject(quint32 objId);
+    bool writeCsv(const LogObjectLayout &layout, const LogObjectRows &rows, const QVector<Column> &columns) const;
+    bool writeColumns(const LogObjectLayout &layout, const LogObjectRows &rows, const QVector<Column> &columns) const;
+    void appendValue(QByteArray &line, const LogFieldLayout &field, quint32 element, const char *row) const;
+
+    const LogDecoder &decoder;
+    QString directory;
+    int formats;
+
+    QMutex mutex;
+    QStringList failed;
+};
+
+#endif // LOGTABLEWRITER_H
@@ -0,0 +1,175 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Command line log decoder, writes every object of a GCS or
+ *             onboard log as a table without replaying it
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtCore/QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <iostream>
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "logdecoder.h"
+#include "logtablewriter.h"
+
+#define RETURN_ERR_USAGE 1
+#define RETURN_ERR_LOG 2
+#define RETURN_ERR_WRITE 3
+#define RETURN_OK 0
+
+using namespace std;
+
+/**
+ * print usage info
+ */
+void usage() {
+    cout << "Usage: logdecoder [-csv] [-columns] [-gcs|-onboard] [-threads N] [-o output_dir] log_file" << endl;
+    cout << "Output: "<< endl;
+    cout << "\t-csv           write a <Object>.csv table per object" << endl;
+    cout << "\t-columns       write a <Object>.col column file per object, see logtablewriter.h" << endl;
+    cout << "\tIf no output format is specified -> csv is written." << endl;
+    cout << "\t-o output_dir  directory of the tables, <log_file>.tables by default" << endl;
+    cout << "Misc: "<< endl;
+    cout << "\t-gcs           the log was recorded by the GCS" << endl;
+    cout << "\t-onboard       the log was recorded by the flight controller" << endl;
+    cout << "\tIf the log type is not specified it is told from the log header." << endl;
+    cout << "\t-threads N     threads to decode with, one per core by default" << endl;
+    cout << "\t-h             this help" << endl;
+}
+
+/**
+ * inform user of invalid usage
+ */
+int usage_err() {
+    cout << "Invalid usage!" << endl;
+    usage();
+    return RETURN_ERR_USAGE;
+}
+
+/**
+ * entrance
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QStringList arguments_stringlist;
+    for (int argi=1;argi<argc;argi++)
+        arguments_stringlist << argv[argi];
+
+    if (arguments_stringlist.removeAll("-h")>0) {
+        usage();
+        return RETURN_OK;
+    }
+
+    int formats = 0;
+    if (arguments_stringlist.removeAll("-csv")>0)
+        formats |= LogTableWriter::FORMAT_CSV;
+    if (arguments_stringlist.removeAll("-columns")>0)
+        formats |= LogTableWriter::FORMAT_COLUMNS;
+    if (formats == 0)
+        formats = LogTableWriter::FORMAT_CSV;
+
+    LogDecoder::LogType type = LogDecoder::LOG_AUTO;
+    if (arguments_stringlist.removeAll("-gcs")>0)
+        type = LogDecoder::LOG_GCS;
+    if (arguments_stringlist.removeAll("-onboard")>0) {
+        if (type != LogDecoder::LOG_AUTO)
+            return usage_err();
+        type = LogDecoder::LOG_ONBOARD;
+    }
+
+    int threads = qMax(1, QThread::idealThreadCount());
+    int idx = arguments_stringlist.indexOf("-threads");
+    if (idx >= 0) {
+        bool ok = false;
+        threads = arguments_stringlist.value(idx + 1).toInt(&ok);
+        if (!ok || threads < 1)
+            return usage_err();
+        arguments_stringlist.removeAt(idx + 1);
+        arguments_stringlist.removeAt(idx);
+    }
+
+    QString outputpath;
+    idx = arguments_stringlist.indexOf("-o");
+    if (idx >= 0) {
+        if (idx + 1 >= arguments_stringlist.length())
+            return usage_err();
+        outputpath = arguments_stringlist.at(idx + 1);
+        arguments_stringlist.removeAt(idx + 1);
+        arguments_stringlist.removeAt(idx);
+    }
+
+    if (arguments_stringlist.length() != 1)
+        return usage_err();
+    QString logpath = arguments_stringlist.at(0);
+    if (outputpath.isEmpty())
+        outputpath = QFileInfo(logpath).filePath() + ".tables";
+
+    // The objects only provide the layouts, nothing is unpacked into them
+    UAVObjectManager objMngr;
+    UAVObjectsInitialize(&objMngr);
+
+    LogDecoder decoder(&objMngr);
+    if (!decoder.open(logpath, type)) {
+        cout << qPrintable(decoder.errorString()) << endl;
+        return RETURN_ERR_LOG;
+    }
+
+    cout << "Log " << qPrintable(logpath) << ", "
+         << (decoder.logType() == LogDecoder::LOG_GCS ? "GCS" : "onboard") << " log of "
+         << qPrintable(decoder.gitHash()) << ", UAVO hash " << qPrintable(decoder.uavoHash()) << endl;
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!decoder.decode(threads)) {
+        cout << qPrintable(decoder.errorString()) << endl;
+        return RETURN_ERR_LOG;
+    }
+    qint64 decodeMs = timer.elapsed();
+
+    cout << "Decoded " << decoder.packetCount() << " packets of "
+         << decoder.decodedObjects().size() << " objects in " << decodeMs << " ms with "
+         << threads << " threads" << endl;
+    if (decoder.errorCount() > 0 || decoder.unknownCount() > 0 || decoder.droppedDeltaCount() > 0)
+        cout << decoder.errorCount() << " corrupted packets, " << decoder.unknownCount()
+             << " updates of unknown objects, " << decoder.droppedDeltaCount()
+             << " deltas without keyframe" << endl;
+
+    timer.restart();
+    LogTableWriter writer(decoder, outputpath, formats);
+    if (!writer.write(threads)) {
+        cout << "Unable to write " << qPrintable(writer.failures().join(", ")) << " to "
+             << qPrintable(outputpath) << endl;
+        return RETURN_ERR_WRITE;
+    }
+
+    cout << "Wrote the tables to " << qPrintable(outputpath) << " in " << timer.elapsed() << " ms" << endl;
+
+    return RETURN_OK;
+}
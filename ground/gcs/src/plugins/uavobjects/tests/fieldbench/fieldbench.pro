@@ -0,0 +1,22 @@
+# -------------------------------------------------
+# Benchmark of reading object fields the way the
+# scope and the other gadgets do on every update
+# -------------------------------------------------
+QT -= gui
+TARGET = fieldbench
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+DEFINES += UAVOBJECTS_LIBRARY
+INCLUDEPATH += ../..
+SOURCES += main.cpp \
+    ../../uavobject.cpp \
+    ../../uavmetaobject.cpp \
+    ../../uavobjectmanager.cpp \
+    ../../uavdataobject.cpp \
+    ../../uavobjectfield.cpp
+HEADERS += ../../uavobject.h \
+    ../../uavmetaobject.h \
+    ../../uavobjectmanager.h \
+    ../../uavdataobject.h \
+    ../../uavobjectfield.h
@@ -0,0 +1,192 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Benchmark of reading object fields as the gadgets do
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QStringList>
+#include <stdio.h>
+#include "uavdataobject.h"
+#include "uavobjectfield.h"
+
+// Usage: fieldbench [millions of reads, default 10]
+
+//! Laid out like a generated object, the generator is not part of the benchmark
+class BenchObject : public UAVDataObject
+{
+public:
+    typedef struct {
+        float Roll;
+        float Pitch;
+        float Yaw;
+        float Gyro[3];
+        quint16 Status;
+        quint8 Mode;
+    } __attribute__((packed)) DataFields;
+
+    static const quint32 OBJID = 0x5A5A0001;
+    static const quint32 NUMBYTES = sizeof(DataFields);
+
+    BenchObject() : UAVDataObject(OBJID, true, false, "BenchObject")
+    {
+        QList<UAVObjectField*> fields;
+        fields.append(new UAVObjectField("Roll", "deg", UAVObjectField::FLOAT32, 1, QStringList(), QList<int>()));
+        fields.append(new UAVObjectField("Pitch", "deg", UAVObjectField::FLOAT32, 1, QStringList(), QList<int>()));
+        fields.append(new UAVObjectField("Yaw", "deg", UAVObjectField::FLOAT32, 1, QStringList(), QList<int>()));
+        fields.append(new UAVObjectField("Gyro", "deg/s", UAVObjectField::FLOAT32, QStringList() << "X" << "Y" << "Z", QStringList(), QList<int>()));
+        fields.append(new UAVObjectField("Status", "", UAVObjectField::UINT16, 1, QStringList(), QList<int>()));
+        fields.append(new UAVObjectField("Mode", "", UAVObjectField::ENUM, 1, QStringList() << "Disabled" << "Rate" << "Attitude", QList<int>() << 0 << 1 << 2));
+        initializeFields(fields, (quint8*)&data, NUMBYTES);
+
+        data.Roll = 12.5f;
+        data.Pitch = -3.25f;
+        data.Yaw = 181.0f;
+        data.Gyro[0] = 0.5f;
+        data.Gyro[1] = -1.5f;
+        data.Gyro[2] = 2.5f;
+        data.Status = 7;
+        data.Mode = 2;
+    }
+
+    //! As the generated getData()
+    DataFields getData()
+    {
+        QMutexLocker locker(mutex);
+        return data;
+    }
+
+    //! As a generated Q_PROPERTY getter
+    float getGyro(quint32 index) const
+    {
+        QMutexLocker locker(mutex);
+        return data.Gyro[index];
+    }
+
+    Metadata getDefaultMetadata() { return Metadata(); }
+    UAVDataObject* clone(quint32) { return new BenchObject(); }
+    UAVDataObject* dirtyClone() { return new BenchObject(); }
+
+private:
+    DataFields data;
+};
+
+static void report(const char *what, const QElapsedTimer &timer, quint64 reads, double sum)
+{
+    const double secs = timer.nsecsElapsed() / 1e9;
+    printf("%-40s %12.0f reads/s  (%g)\n", what, reads / secs, sum);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const QStringList args = a.arguments();
+    const quint64 reads = (args.size() > 1 ? args.at(1).toLongLong() : 10) * 1000 * 1000;
+
+    BenchObject obj;
+    UAVObjectField *gyro = obj.getField("Gyro");
+    UAVObjectField *status = obj.getField("Status");
+    UAVObjectField *mode = obj.getField("Mode");
+    printf("%llu reads of each kind\n\n", (unsigned long long) reads);
+
+    QElapsedTimer timer;
+    double sum;
+
+    // Element reads through the field
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i++)
+        sum += gyro->getValue(i % 3).toDouble();
+    report("float, getValue().toDouble()", timer, reads, sum);
+
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i++)
+        sum += gyro->getDouble(i % 3);
+    report("float, getDouble()", timer, reads, sum);
+
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i++)
+        sum += status->getValue().toDouble();
+    report("uint16, getValue().toDouble()", timer, reads, sum);
+
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i++)
+        sum += status->getDouble();
+    report("uint16, getDouble()", timer, reads, sum);
+
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i++)
+        sum += mode->getValue().toString().length();
+    report("enum, getValue() option", timer, reads, sum);
+
+    // Typed access of the generated objects
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i++)
+        sum += obj.getGyro(i % 3);
+    report("float, typed getter", timer, reads, sum);
+
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i += 8) {
+        const BenchObject::DataFields data = obj.getData();
+        sum += data.Roll + data.Pitch + data.Yaw + data.Gyro[0] + data.Gyro[1] + data.Gyro[2] + data.Status + data.Mode;
+    }
+    report("all fields, getData()", timer, reads, sum);
+
+    // One scope curve, for every update of the plotted object
+    const QString objectName("BenchObject");
+    const QString fieldName("Gyro");
+    const QString subFieldName("Y");
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i++) {
+        if (objectName != obj.getName())
+            continue;
+        UAVObjectField *field = obj.getField(fieldName);
+        int index = field->getElementNames().indexOf(QRegExp(subFieldName, Qt::CaseSensitive, QRegExp::FixedString));
+        sum += field->getValue(index).toDouble();
+    }
+    report("scope curve, as before", timer, reads, sum);
+
+    UAVObject *plottedObject = &obj;
+    UAVObjectField *plottedField = obj.getField(fieldName);
+    const int subFieldIndex = plottedField->getElementNames().indexOf(subFieldName);
+    timer.start();
+    sum = 0;
+    for (quint64 i = 0; i < reads; i++) {
+        if (&obj != plottedObject)
+            continue;
+        sum += plottedField->getDouble(subFieldIndex);
+    }
+    report("scope curve, cached field", timer, reads, sum);
+
+    return 0;
+}
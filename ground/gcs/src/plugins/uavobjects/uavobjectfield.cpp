@@ -556,6 +556,11 @@ QStringList UAVObjectField::getOptions()
     return options;
 }
 
+QList<int> UAVObjectField::getIndices()
+{
+    return indices;
+}
+
 quint32 UAVObjectField::getNumElements()
 {
     return numElements;
@@ -1046,8 +1051,68 @@ void UAVObjectField::setValue(const QVariant& value, quint32 index)
     }
 }
 
+/**
+ * Get an element as a double. Numeric and bitfield elements are read
+ * straight from the object data, without going through a QVariant, so
+ * this is the accessor to use for anything read on every update.
+ */
 double UAVObjectField::getDouble(quint32 index)
 {
+    QMutexLocker locker(obj->getMutex());
+    // Check that index is not out of bounds
+    if ( index >= numElements )
+    {
+        return 0;
+    }
+    const quint8* element = &data[offset + numBytesPerElement*index];
+    switch (type)
+    {
+    case INT8:
+    {
+        qint8 tmpint8;
+        memcpy(&tmpint8, element, numBytesPerElement);
+        return tmpint8;
+    }
+    case INT16:
+    {
+        qint16 tmpint16;
+        memcpy(&tmpint16, element, numBytesPerElement);
+        return tmpint16;
+    }
+    case INT32:
+    {
+        qint32 tmpint32;
+        memcpy(&tmpint32, element, numBytesPerElement);
+        return tmpint32;
+    }
+    case UINT8:
+        return *element;
+    case UINT16:
+    {
+        quint16 tmpuint16;
+        memcpy(&tmpuint16, element, numBytesPerElement);
+        return tmpuint16;
+    }
+    case UINT32:
+    {
+        quint32 tmpuint32;
+        memcpy(&tmpuint32, element, numBytesPerElement);
+        return tmpuint32;
+    }
+    case FLOAT32:
+    {
+        float tmpfloat;
+        memcpy(&tmpfloat, element, numBytesPerElement);
+        return tmpfloat;
+    }
+    case BITFIELD:
+        return (data[offset + numBytesPerElement*((quint32)(index/8))] >> (index % 8)) & 1;
+    case ENUM:
+    case STRING:
+        break;
+    }
+    locker.unlock();
+    // Enums and strings keep converting from their text
     return getValue(index).toDouble();
 }
 
@@ -62,6 +62,7 @@ public:
     quint32 getNumElements();
     QStringList getElementNames();
     QStringList getOptions();
+    QList<int> getIndices();
     qint32 pack(quint8* dataOut);
     qint32 unpack(const quint8* dataIn);
     QVariant getValue(quint32 index = 0);
@@ -51,6 +51,7 @@ $(FIELDSINIT)
     initializeFields(fields, (quint8*)&data, NUMBYTES);
     // Set the default field values
     setDefaultFieldValues();
+    notifiedData = data;
     // Set the object description
     setDescription(DESCRIPTION);
 
@@ -116,9 +117,19 @@ void $(NAME)::setData(const DataFields& data)
     }
 }
 
+/**
+ * Notify the properties that changed since the last update, so that
+ * bindings on fields that did not change are not evaluated again
+ */
 void $(NAME)::emitNotifications()
 {
-    $(NOTIFY_PROPERTIES_CHANGED)
+    mutex->lock();
+    DataFields oldData = notifiedData;
+    DataFields newData = data;
+    notifiedData = data;
+    mutex->unlock();
+
+$(NOTIFY_PROPERTIES_CHANGED)
 }
 
 /**
@@ -97,6 +97,8 @@ private slots:
 	
 private:
     DataFields data;
+    // The values the property notifications were last emitted for
+    DataFields notifiedData;
 
     void setDefaultFieldValues();
 
@@ -96,6 +96,25 @@ end
 
 buffer=fread(fid,Inf,'uchar=>uchar');
 
+% Indexed GCS logs follow the "##" line with a container header (magic
+% 'TLLC', 4 byte version) and group the records in chunks, each preceded
+% by a 20 byte header (magic 'TLCK', record count, length in bytes, first
+% and last timestamp). The index after the last chunk is not needed here,
+% so keep only the records of the chunks.
+if ~overo && length(buffer) >= 11 && strcmp(char(buffer(1:2))', '##') && ...
+		strcmp(char(buffer(4:7))', 'TLLC')
+	chunks = cell(0, 1);
+	chunkIdx = 12;
+	while chunkIdx + 19 <= length(buffer) && ...
+			typecast(buffer(chunkIdx:chunkIdx+3), 'uint32') == hex2dec('4B434C54')
+		chunkBytes = double(typecast(buffer(chunkIdx+8:chunkIdx+11), 'uint32'));
+		chunkEnd = min(chunkIdx + 19 + chunkBytes, length(buffer));
+		chunks{end+1} = buffer(chunkIdx+20:chunkEnd); %#ok<AGROW>
+		chunkIdx = chunkEnd + 1;
+	end
+	buffer = vertcat(chunks{:});
+end
+
 
 bufferIdx=1;
 
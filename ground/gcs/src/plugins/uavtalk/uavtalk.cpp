@@ -26,8 +26,10 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavtalk.h"
+#include "gcstelemetrystats.h"
 #include <QtEndian>
 #include <QDebug>
+#include <cstring>
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/generalsettings.h>
 
@@ -77,6 +79,13 @@ UAVTalk::UAVTalk(QIODevice* iodev, UAVObjectManager* objMngr)
     memset(&stats, 0, sizeof(ComStats));
 
     connect(io, SIGNAL(readyRead()), this, SLOT(processInputStream()));
+
+    // Devices that replay from memory, like log files, hand out their data
+    // in place rather than through read(), along with what keeps that data
+    // valid until the slot returned
+    if (io->metaObject()->indexOfSignal("dataAvailable(QList<QByteArray>,QSharedPointer<QFile>)") >= 0)
+        connect(io, SIGNAL(dataAvailable(QList<QByteArray>,QSharedPointer<QFile>)), this, SLOT(processInputData(QList<QByteArray>)));
+
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     Core::Internal::GeneralSettings * settings=pm->getObject<Core::Internal::GeneralSettings>();
     useUDPMirror=settings->useUDPMirror();
@@ -123,14 +132,77 @@ UAVTalk::ComStats UAVTalk::getStats()
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
-
     if (io && io->isReadable()) {
         while (io->bytesAvailable() > 0)
         {
-            io->read((char*)&tmp, 1);
-            processInputByte(tmp);
+            QByteArray data = io->read(io->bytesAvailable());
+            if (data.isEmpty())
+                break;
+            processInputBuffer((const quint8*)data.constData(), data.size());
+        }
+    }
+}
+
+/**
+ * Called with blocks the device hands out directly, see LogFile::dataAvailable
+ */
+void UAVTalk::processInputData(const QList<QByteArray> &blocks)
+{
+    foreach (const QByteArray &data, blocks)
+        processInputBuffer((const quint8*)data.constData(), data.size());
+}
+
+/**
+ * Process a block of bytes from the telemetry stream.
+ * Bytes between packets are skipped in one scan for the sync byte and
+ * payloads are copied and checksummed in one go, everything else goes
+ * through processInputByte(). Packets may be split over several calls.
+ * \param[in] data Received bytes
+ * \param[in] length Number of received bytes
+ */
+void UAVTalk::processInputBuffer(const quint8* data, qint64 length)
+{
+    const quint8* end = data + length;
+
+    while (data < end)
+    {
+        if (rxState == STATE_SYNC)
+        {
+            // Skip everything up to the next sync byte
+            const quint8* sync = (const quint8*)memchr(data, SYNC_VAL, end - data);
+            if (sync == NULL)
+                sync = end;
+            stats.rxBytes += sync - data;
+            rxPacketLength += sync - data;
+            data = sync;
+            if (data == end)
+                break;
+        }
+        else if (rxState == STATE_DATA)
+        {
+            // Copy as much of the payload as is available
+            qint32 count = rxLength - rxCount;
+            if (count > end - data)
+                count = end - data;
+            memcpy(&rxBuffer[rxCount], data, count);
+            rxCS = updateCRC(rxCS, data, count);
+            if (useUDPMirror)
+                rxDataArray.append((const char*)data, count);
+            stats.rxBytes += count;
+            rxPacketLength += count;
+            rxCount += count;
+            data += count;
+
+            if (rxCount < rxLength)
+                break;
+
+            rxState = STATE_CS;
+            UAVTALK_QXTLOG_DEBUG("UAVTalk: Data->CSum");
+            rxCount = 0;
+            continue;
         }
+
+        processInputByte(*data++);
     }
 }
 
@@ -168,6 +240,13 @@ bool UAVTalk::sendObjectRequest(UAVObject* obj, bool allInstances)
 bool UAVTalk::sendObject(UAVObject* obj, bool acked, bool allInstances)
 {
     QMutexLocker locker(mutex);
+    // Announce that we decode batched and delta frames along with every handshake
+    // object, so the autopilot learns about it again after each reconnection
+    if (obj->getObjID() == GCSTelemetryStats::OBJID)
+    {
+        transmitCapability(TYPE_OBJ_MULTI, MULTI_OBJID);
+        transmitCapability(TYPE_OBJ_DELTA, DELTA_OBJID);
+    }
     if (acked)
     {
         return objectTransaction(obj, TYPE_OBJ_ACK, allInstances);
@@ -302,6 +381,23 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
             // Search for object, if not found reset state machine
             rxObjId = (qint32)qFromLittleEndian<quint32>(rxTmpBuffer);
+            if (rxType == TYPE_OBJ_MULTI)
+            {
+                // Batched frame, the entries are unpacked once the checksum is verified
+                rxLength = packetSize - rxPacketLength;
+                if (rxLength >= MAX_PAYLOAD_LENGTH)
+                {
+                    stats.rxErrors++;
+                    rxState = STATE_SYNC;
+                    UAVTALK_QXTLOG_DEBUG("UAVTalk: ObjID->Sync (oversize batch)");
+                    break;
+                }
+                rxState = (rxLength > 0) ? STATE_DATA : STATE_CS;
+                UAVTALK_QXTLOG_DEBUG("UAVTalk: ObjID->Data (batch)");
+                rxInstId = 0;
+                rxCount = 0;
+                break;
+            }
             {
                 UAVObject *rxObj = objMngr->getObject(rxObjId);
                 if (rxObj == NULL && rxType != TYPE_OBJ_REQ)
@@ -322,11 +418,18 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
                    break;
                 }
 
+                quint8 rxInstanceLength = (rxObj->isSingleInstance() ? 0 : 2);
+
                 // Determine data length
                 if (rxType == TYPE_OBJ_REQ || rxType == TYPE_ACK || rxType == TYPE_NACK)
                 {
                     rxLength = 0;
                 }
+                else if (rxType == TYPE_OBJ_DELTA)
+                {
+                    // Delta payloads are variable length
+                    rxLength = packetSize - rxPacketLength - rxInstanceLength;
+                }
                 else
                 {
                     rxLength = rxObj->getNumBytes();
@@ -341,7 +444,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
                     break;
                 }
 
-                quint8 rxInstanceLength = (rxObj->isSingleInstance() ? 0 : 2);
                 if ((rxPacketLength + rxInstanceLength + rxLength) != packetSize)
                 {   // packet error - mismatched packet size
                     stats.rxErrors++;
@@ -478,7 +580,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
  */
 bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8* data, qint32 length)
 {
-    Q_UNUSED(length);
     UAVObject* obj = NULL;
     bool error = false;
     bool allInstances =  (instId == ALL_INSTANCES);
@@ -589,6 +690,12 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8*
             }
         }
         break;
+    case TYPE_OBJ_MULTI: // We have received a batch of object updates
+        error = !receiveMultiObject(data, length);
+        break;
+    case TYPE_OBJ_DELTA: // We have received a delta encoded object update
+        error = allInstances || !receiveDelta(objId, instId, data, length);
+        break;
     default:
         error = true;
     }
@@ -596,6 +703,128 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8*
     return !error;
 }
 
+/**
+ * Unpack the entries of a batched frame. Entries for unknown objects or
+ * with a length that does not match the local definition are skipped.
+ * \param[in] data Frame payload
+ * \param[in] length Payload length
+ * \return Success (true), Failure (false) if any entry was skipped
+ */
+bool UAVTalk::receiveMultiObject(quint8* data, qint32 length)
+{
+    bool error = false;
+
+    while (length >= MULTI_ENTRY_HEADER_LENGTH)
+    {
+        quint32 objId = qFromLittleEndian<quint32>(data);
+        quint16 instId = qFromLittleEndian<quint16>(&data[4]);
+        qint32 objLength = data[6];
+
+        data += MULTI_ENTRY_HEADER_LENGTH;
+        length -= MULTI_ENTRY_HEADER_LENGTH;
+
+        if (objLength > length)
+        {
+            return false;
+        }
+
+        UAVObject* obj = objMngr->getObject(objId);
+        if (obj != NULL && instId != ALL_INSTANCES && (instId & MULTI_DELTA_INSTID))
+        {
+            if (!receiveDelta(objId, instId & ~MULTI_DELTA_INSTID, data, objLength))
+            {
+                error = true;
+            }
+        }
+        else if (obj != NULL && instId != ALL_INSTANCES && (qint32)obj->getNumBytes() == objLength)
+        {
+            if (updateObject(objId, instId, data) == NULL)
+            {
+                error = true;
+            }
+        }
+        else
+        {
+            UAVTALK_QXTLOG_DEBUG(QString("[uavtalk.cpp  ] Skipped a batched update for OBJID:%0 INSTID:%1").arg(QString(QString("0x") + QString::number(objId, 16).toUpper())).arg(instId));
+            error = true;
+        }
+
+        data += objLength;
+        length -= objLength;
+    }
+
+    // Done (trailing bytes that do not form an entry are an error)
+    return !error && length == 0;
+}
+
+/**
+ * Unpack a delta encoded object update. Keyframes are kept for the deltas
+ * that follow, deltas against any other keyframe than the one held (the
+ * keyframe was lost) are dropped until the next keyframe arrives.
+ * \param[in] objId Object ID
+ * \param[in] instId Instance ID
+ * \param[in] data Delta payload
+ * \param[in] length Payload length
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::receiveDelta(quint32 objId, quint16 instId, quint8* data, qint32 length)
+{
+    UAVObject* obj = objMngr->getObject(objId);
+    if (obj == NULL || length < 1)
+    {
+        return false;
+    }
+
+    qint32 objLength = obj->getNumBytes();
+    quint64 key = ((quint64)objId << 16) | instId;
+
+    if (data[0] & DELTA_KEYFRAME)
+    {
+        if (length != objLength + 1)
+        {
+            return false;
+        }
+        DeltaKeyframe& keyframe = rxDelta[key];
+        keyframe.seq = data[0] & DELTA_SEQ_MASK;
+        keyframe.image = QByteArray((const char*)&data[1], objLength);
+        return updateObject(objId, instId, &data[1]) != NULL;
+    }
+
+    QMap<quint64, DeltaKeyframe>::const_iterator keyframe = rxDelta.constFind(key);
+    if (keyframe == rxDelta.constEnd() || keyframe->seq != data[0])
+    {
+        UAVTALK_QXTLOG_DEBUG(QString("[uavtalk.cpp  ] Dropped a delta without keyframe for OBJID:%0 INSTID:%1").arg(QString(QString("0x") + QString::number(objId, 16).toUpper())).arg(instId));
+        return false;
+    }
+
+    qint32 mapLength = (objLength + 7) / 8;
+    qint32 changed = 1 + mapLength;
+    if (length < changed)
+    {
+        return false;
+    }
+
+    QByteArray image = keyframe->image;
+    for (qint32 n = 0; n < objLength; ++n)
+    {
+        if (data[1 + n / 8] & (1 << (n % 8)))
+        {
+            if (changed >= length)
+            {
+                return false;
+            }
+            image[n] = data[changed++];
+        }
+    }
+
+    if (changed != length)
+    {
+        return false;
+    }
+
+    return updateObject(objId, instId, (quint8*)image.data()) != NULL;
+}
+
 /**
  * Update the data of an object from a byte array (unpack).
  * If the object instance could not be found in the list, then a
@@ -737,6 +966,48 @@ bool UAVTalk::transmitNack(quint32 objId)
 }
 
 
+/**
+ * Transmit an empty frame of the given type. This tells the autopilot that
+ * frames of that type (batched or delta) can be decoded on this end, older
+ * firmware ignores it.
+ * \param[in] type Frame type
+ * \param[in] objId Reserved object ID of the frame type
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::transmitCapability(quint8 type, quint32 objId)
+{
+    int dataOffset = 8;
+
+    txBuffer[0] = SYNC_VAL;
+    txBuffer[1] = type;
+    qToLittleEndian<quint16>(dataOffset, &txBuffer[2]);
+    qToLittleEndian<quint32>(objId, &txBuffer[4]);
+
+    // Calculate checksum
+    txBuffer[dataOffset] = updateCRC(0, txBuffer, dataOffset);
+
+    // Send buffer, check that the transmit backlog does not grow above limit
+    if (!io.isNull() && io->isWritable() && io->bytesToWrite() < TX_BUFFER_SIZE )
+    {
+        io->write((const char*)txBuffer, dataOffset+CHECKSUM_LENGTH);
+        if(useUDPMirror)
+        {
+            udpSocketRx->writeDatagram((const char*)txBuffer,dataOffset+CHECKSUM_LENGTH,QHostAddress::LocalHost,udpSocketTx->localPort());
+        }
+    }
+    else
+    {
+        ++stats.txErrors;
+        return false;
+    }
+
+    // Update stats
+    stats.txBytes += dataOffset+CHECKSUM_LENGTH;
+
+    // Done
+    return true;
+}
+
 /**
  * Send an object through the telemetry link.
  * \param[in] obj Object handle to send
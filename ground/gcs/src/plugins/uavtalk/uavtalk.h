@@ -62,6 +62,7 @@ public:
     void resetStats();
 
     bool processInputByte(quint8 rxbyte);
+    void processInputBuffer(const quint8* data, qint64 length);
 
 signals:
     // The only signals we send to the upper level are when we
@@ -71,6 +72,7 @@ signals:
 
 private slots:
     void processInputStream(void);
+    void processInputData(const QList<QByteArray> &blocks);
     void dummyUDPRead();
 
 protected:
@@ -83,12 +85,27 @@ protected:
     static const int TYPE_OBJ_ACK = (TYPE_VER | 0x02);
     static const int TYPE_ACK = (TYPE_VER | 0x03);
     static const int TYPE_NACK = (TYPE_VER | 0x04);
+    static const int TYPE_OBJ_MULTI = (TYPE_VER | 0x05);
+    static const int TYPE_OBJ_DELTA = (TYPE_VER | 0x06);
 
     static const int MIN_HEADER_LENGTH = 8; // sync(1), type (1), size(2), object ID(4)
     static const int MAX_HEADER_LENGTH = 10; // sync(1), type (1), size(2), object ID (4), instance ID(2, not used in single objects)
 
     static const int CHECKSUM_LENGTH = 1;
 
+    // Batched frames: minimal header with a reserved object ID, then entries of
+    // object ID(4), instance ID(2), length(1) and the object data
+    static const quint32 MULTI_OBJID = 0x00000000;
+    static const int MULTI_ENTRY_HEADER_LENGTH = 7;
+    static const quint16 MULTI_DELTA_INSTID = 0x8000; // instance ID flag of an entry holding a delta payload
+
+    // Delta payloads: a byte with the keyframe flag and a 7 bit keyframe sequence,
+    // then either the object data (keyframe) or a bitmap of the bytes that differ
+    // from the keyframe followed by those bytes (delta)
+    static const quint32 DELTA_OBJID = 0x00000000;
+    static const quint8 DELTA_KEYFRAME = 0x80;
+    static const quint8 DELTA_SEQ_MASK = 0x7F;
+
     static const int MAX_PAYLOAD_LENGTH = 256;
 
     static const int MAX_PACKET_LENGTH = (MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
@@ -127,11 +144,21 @@ protected:
     QUdpSocket * udpSocketRx;
     QByteArray rxDataArray;
 
+    // Last keyframe received for each delta encoded object instance
+    typedef struct {
+        quint8 seq;
+        QByteArray image;
+    } DeltaKeyframe;
+    QMap<quint64, DeltaKeyframe> rxDelta;
+
     // Methods
     bool objectTransaction(UAVObject* obj, quint8 type, bool allInstances);
     virtual bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8* data, qint32 length);
     UAVObject* updateObject(quint32 objId, quint16 instId, quint8* data);
+    bool receiveMultiObject(quint8* data, qint32 length);
+    bool receiveDelta(quint32 objId, quint16 instId, quint8* data, qint32 length);
     bool transmitNack(quint32 objId);
+    bool transmitCapability(quint8 type, quint32 objId);
     bool transmitObject(UAVObject* obj, quint8 type, bool allInstances);
     bool transmitSingleObject(UAVObject* obj, quint8 type, bool allInstances);
     quint8 updateCRC(quint8 crc, const quint8 data);
@@ -178,6 +178,14 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                             "   return data.%3[index];\n"
                             "}\n")
                     .arg(type).arg(info->name).arg(field->name);
+            // The setters compare with and update the values last notified,
+            // so emitNotifications() does not miss or repeat their changes
+            QString elementNotifications;
+            for (int elementIndex = 0; elementIndex < field->numElements; elementIndex++) {
+                elementNotifications +=
+                        QString("       case %1: emit %2_%3Changed(value); break;\n")
+                        .arg(elementIndex).arg(field->name).arg(field->elementNames[elementIndex]);
+            }
             propertySetters +=
                     QString("    void set%1(quint32 index, %2 value);\n")
                     .arg(field->name).arg(type);
@@ -185,12 +193,18 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                     QString("void %1::set%2(quint32 index, %3 value)\n"
                             "{\n"
                             "   mutex->lock();\n"
-                            "   bool changed = data.%2[index] != value;\n"
+                            "   bool changed = notifiedData.%2[index] != value;\n"
                             "   data.%2[index] = value;\n"
+                            "   notifiedData.%2[index] = value;\n"
                             "   mutex->unlock();\n"
-                            "   if (changed) emit %2Changed(index,value);\n"
+                            "   if (changed) {\n"
+                            "       emit %2Changed(index,value);\n"
+                            "       switch (index) {\n"
+                            "%4"
+                            "       }\n"
+                            "   }\n"
                             "}\n\n")
-                    .arg(info->name).arg(field->name).arg(type);
+                    .arg(info->name).arg(field->name).arg(type).arg(elementNotifications);
             propertyNotifications +=
                     QString("    void %1Changed(quint32 index, %2 value);\n")
                     .arg(field->name).arg(type);
@@ -216,8 +230,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                         QString("void %1::set%2_%3(%4 value)\n"
                                 "{\n"
                                 "   mutex->lock();\n"
-                                "   bool changed = data.%2[%5] != value;\n"
+                                "   bool changed = notifiedData.%2[%5] != value;\n"
                                 "   data.%2[%5] = value;\n"
+                                "   notifiedData.%2[%5] = value;\n"
                                 "   mutex->unlock();\n"
                                 "   if (changed) emit %2_%3Changed(value);\n"
                                 "}\n\n")
@@ -226,8 +241,8 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                         QString("    void %1_%2Changed(%3 value);\n")
                         .arg(field->name).arg(elementName).arg(type);
                 propertyNotificationsImpl +=
-                        QString("        //if (data.%1[%2] != oldData.%1[%2])\n"
-                                "            emit %1_%3Changed(data.%1[%2]);\n")
+                        QString("    if (newData.%1[%2] != oldData.%1[%2])\n"
+                                "        emit %1_%3Changed(newData.%1[%2]);\n")
                         .arg(field->name).arg(elementIndex).arg(elementName);
             }
         } else {
@@ -250,8 +265,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                     QString("void %1::set%2(%3 value)\n"
                             "{\n"
                             "   mutex->lock();\n"
-                            "   bool changed = data.%2 != value;\n"
+                            "   bool changed = notifiedData.%2 != value;\n"
                             "   data.%2 = value;\n"
+                            "   notifiedData.%2 = value;\n"
                             "   mutex->unlock();\n"
                             "   if (changed) emit %2Changed(value);\n"
                             "}\n\n")
@@ -260,8 +276,8 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                     QString("    void %1Changed(%2 value);\n")
                     .arg(field->name).arg(type);
             propertyNotificationsImpl +=
-                    QString("        //if (data.%1 != oldData.%1)\n"
-                            "            emit %1Changed(data.%1);\n")
+                    QString("    if (newData.%1 != oldData.%1)\n"
+                            "        emit %1Changed(newData.%1);\n")
                     .arg(field->name);
         }
 
@@ -73,6 +73,8 @@ void replaceCommonTags(QString& out, ObjectInfo* info)
     // Replace $(ISSETTINGS) tag
     out.replace(QString("$(ISSETTINGS)"), boolTo01String( info->isSettings ));
     out.replace(QString("$(ISSETTINGSTF)"), boolToTRUEFALSEString( info->isSettings ));    
+    // Replace $(ISSEQLOCK) tag
+    out.replace(QString("$(ISSEQLOCK)"), boolTo01String( info->isSeqlock ));
     // Replace $(NUMBYTES) tag
     out.replace(QString("$(NUMBYTES)"), QString().setNum(info->numBytes));
     // Replace $(GCSACCESS) tag
@@ -89,6 +91,8 @@ void replaceCommonTags(QString& out, ObjectInfo* info)
     out.replace(QString("$(FLIGHTTELEM_UPDATEMODE)"), value);
     // Replace $(FLIGHTTELEM_UPDATEPERIOD) tag
     out.replace(QString("$(FLIGHTTELEM_UPDATEPERIOD)"), QString().setNum(info->flightTelemetryUpdatePeriod));
+    // Replace $(FLIGHTTELEM_DELTA) tag
+    out.replace(QString("$(FLIGHTTELEM_DELTA)"), boolTo01String( info->flightTelemetryDelta ));
     // Replace $(GCSTELEM_ACKED) tag
     out.replace(QString("$(GCSTELEM_ACKED)"),  boolTo01String( info->gcsTelemetryAcked ));
     out.replace(QString("$(GCSTELEM_ACKEDTF)"),  boolToTRUEFALSEString( info->gcsTelemetryAcked ));
@@ -384,6 +384,17 @@ QString UAVObjectParser::parseXML(QString& xml, QString& filename)
                     return genErrorMsg(filename, status,
                             childNode.lineNumber(), childNode.columnNumber());
 
+                // Get the optional delta attribute
+                info->flightTelemetryDelta = false;
+                QDomNode deltaAttr = childNode.attributes().namedItem("delta");
+                if ( !deltaAttr.isNull() ) {
+                    if ( deltaAttr.nodeValue().compare(QString("true")) == 0 )
+                        info->flightTelemetryDelta = true;
+                    else if ( deltaAttr.nodeValue().compare(QString("false")) != 0 )
+                        return genErrorMsg(filename, "Object:telemetryflight:delta attribute value is invalid",
+                                childNode.lineNumber(), childNode.columnNumber());
+                }
+
                 telFlightFound++;
             }
             else if ( childNode.nodeName().compare(QString("logging")) == 0 ) {
@@ -882,6 +893,19 @@ QString UAVObjectParser::processObjectAttributes(QDomNode& node, ObjectInfo* inf
     if ( info->isSettings && !info->isSingleInst )
         return QString("Object: Settings objects can not have multiple instances");
 
+    // Get seqlock attribute if present
+    attr = attributes.namedItem("seqlock");
+    if ( attr.isNull() || attr.nodeValue().compare(QString("false")) == 0 )
+        info->isSeqlock = false;
+    else if ( attr.nodeValue().compare(QString("true")) == 0 )
+        info->isSeqlock = true;
+    else
+        return QString("Object:seqlock attribute value is invalid");
+
+    // Seqlock objects are read lock free, which is only supported for single instance data
+    if ( info->isSeqlock && (info->isSettings || !info->isSingleInst) )
+        return QString("Object: Only single instance data objects can use seqlock");
+
     // Done
     return QString();
 }
@@ -99,11 +99,13 @@ struct ObjectInfo_s {
     quint32 id;
     bool isSingleInst;
     bool isSettings;
+    bool isSeqlock; /** Flight readers copy the data without taking the object manager lock */
     AccessMode gcsAccess;
     AccessMode flightAccess;
     bool flightTelemetryAcked;
     UpdateMode flightTelemetryUpdateMode; /** Update mode used by the autopilot (UpdateMode) */
     int flightTelemetryUpdatePeriod; /** Update period used by the autopilot (only if telemetry mode is PERIODIC) */
+    bool flightTelemetryDelta; /** Autopilot updates may be delta encoded against the previous update */
     bool gcsTelemetryAcked;
     UpdateMode gcsTelemetryUpdateMode; /** Update mode used by the GCS (UpdateMode) */
     int gcsTelemetryUpdatePeriod; /** Update period used by the GCS (only if telemetry mode is PERIODIC) */
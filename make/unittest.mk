@@ -52,7 +52,7 @@ GCOV_CFLAGS := -fprofile-arcs -ftest-coverage
 override THUMB :=
 
 EXTRAINCDIRS    += .
-UTMOCKSRC       := $(wildcard ./*.c)
+UTMOCKSRC       := $(wildcard ./*.c) $(UTSHAREDMOCKSRC)
 ALLSRC          := $(SRC) $(UTMOCKSRC)
 ALLCPPSRC       := $(wildcard ./*.cpp) $(GTEST_DIR)/src/gtest_main.cc
 ALLSRCBASE      := $(notdir $(basename $(ALLSRC) $(ALLCPPSRC)))
@@ -0,0 +1,85 @@
+#!/usr/bin/python -B
+"""
+Replay a flight log through the C INSGPS once per set of noise variances.
+
+Looks up the object ids of the sensor UAVOs for the log, from the git hash
+in the GCS log header or from a UAVO definition directory, builds the
+native ins_replay tool and runs it. ins_replay spreads the runs over all
+cpus and prints the innovation statistics of every run.
+
+   python batch_replay.py [-t] [-j jobs] [-b 400,0,1600] logfile params
+
+params has one run per line, the variances as INSSettings names them:
+   gyro_var[3] accel_var[3] mag_var[3] baro_var gps_pos_var gps_vel_var gps_vert_pos_var
+"""
+
+# Insert the parent directory into the module import search path.
+import os
+import sys
+sys.path.insert(1, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import argparse
+import subprocess
+
+import taulabs
+
+SENSORS = ['Gyros', 'Accels', 'Magnetometer', 'GPSPosition', 'GPSVelocity', 'BaroAltitude']
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+def log_githash(logfile):
+    """ Get the git hash from the header the GCS writes, or None """
+    with open(logfile, 'rb') as f:
+        if f.readline() != b'Tau Labs git hash:\n':
+            return None
+        githash = f.readline()[:-1].decode()
+        if githash.find(':') != -1:
+            import re
+            githash = re.search(':(\w*)\W', githash).group(1)
+        return githash
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument('logfile', help='UAVTalk log to replay')
+    parser.add_argument('params', help='file with one set of variances per line')
+    parser.add_argument('-t', '--timestamped', action='store_true',
+                        help='the log has GCS timestamps before every packet')
+    parser.add_argument('-j', '--jobs', type=int, help='number of worker processes')
+    parser.add_argument('-b', '--be', help='earth magnetic field, like 400,0,1600')
+    parser.add_argument('--githash', help='git hash of the UAVO definitions of the log')
+    parser.add_argument('--xml', help='directory of the UAVO definitions of the log')
+    args = parser.parse_args()
+
+    uavo_defs = taulabs.uavo_collection.UAVOCollection()
+    githash = args.githash or log_githash(args.logfile)
+    if args.xml is None and githash is not None:
+        print("Using the UAVO definitions of git hash %s" % githash)
+        uavo_defs.from_git_hash(githash)
+    else:
+        xml = args.xml or os.path.join(HERE, '..', '..', 'shared', 'uavobjectdefinition')
+        print("Using the UAVO definitions in %s" % xml)
+        uavo_defs.from_uavo_xml_path(xml)
+
+    ids = []
+    for name in SENSORS:
+        uavo = uavo_defs.find_by_name(name)
+        if uavo is None:
+            print("No definition of %s" % name)
+            return 1
+        ids.append('%08x' % uavo._id)
+
+    subprocess.check_call(['make', '-C', HERE, '-s', 'ins_replay'])
+
+    cmd = [os.path.join(HERE, 'ins_replay'), '-i', ','.join(ids)]
+    if args.timestamped:
+        cmd.append('-t')
+    if args.jobs:
+        cmd += ['-j', str(args.jobs)]
+    if args.be:
+        cmd += ['-b', args.be]
+    cmd += [args.logfile, args.params]
+
+    return subprocess.call(cmd)
+
+if __name__ == '__main__':
+    sys.exit(main())
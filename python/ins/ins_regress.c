@@ -0,0 +1,208 @@
+/**
+ ******************************************************************************
+ * @file       ins_regress.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Host driver for INSGPS regression and timing runs
+ *
+ * Runs the same sequence of predictions and corrections as the static
+ * tests in test.py, set up the way insmodule.c sets up the filter, and
+ * writes the state and variances after every update to a trace file so
+ * two builds of the filter can be compared bit for bit. Also reports
+ * the time spent per update. Normally driven by regress.py.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include <insgps.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TIME_UNITS "cycles"
+static uint64_t now(void)
+{
+	return __rdtsc();
+}
+#else
+#define TIME_UNITS "ns"
+static uint64_t now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+#define MAX_STATES 16
+
+/* Deterministic gaussian-ish noise so every build sees the same inputs */
+static uint32_t seed = 1;
+static float noise(float sigma)
+{
+	float sum = 0;
+	for (int i = 0; i < 4; i++) {
+		seed = seed * 1103515245u + 12345u;
+		sum += ((seed >> 8) & 0xffff) / 65536.0f - 0.5f;
+	}
+	return sum * sigma * 1.7320508f;
+}
+
+/* Advance the true attitude with the same kinematics as StateEq */
+static void rotate(float q[4], const float w[3], float dT)
+{
+	float qdot[4] = {
+		(-q[1] * w[0] - q[2] * w[1] - q[3] * w[2]) / 2.0f,
+		(q[0] * w[0] - q[3] * w[1] + q[2] * w[2]) / 2.0f,
+		(q[3] * w[0] + q[0] * w[1] - q[1] * w[2]) / 2.0f,
+		(-q[2] * w[0] + q[1] * w[1] + q[0] * w[2]) / 2.0f
+	};
+	float qmag = 0;
+	for (int i = 0; i < 4; i++) {
+		q[i] += qdot[i] * dT;
+		qmag += q[i] * q[i];
+	}
+	qmag = sqrtf(qmag);
+	for (int i = 0; i < 4; i++)
+		q[i] /= qmag;
+}
+
+/* Rotate an earth frame vector into the body frame */
+static void earth_to_body(const float q[4], const float e[3], float b[3])
+{
+	const float Reb[3][3] = {
+		{ q[0]*q[0] + q[1]*q[1] - q[2]*q[2] - q[3]*q[3], 2*(q[1]*q[2] - q[0]*q[3]), 2*(q[1]*q[3] + q[0]*q[2]) },
+		{ 2*(q[1]*q[2] + q[0]*q[3]), q[0]*q[0] - q[1]*q[1] + q[2]*q[2] - q[3]*q[3], 2*(q[2]*q[3] - q[0]*q[1]) },
+		{ 2*(q[1]*q[3] - q[0]*q[2]), 2*(q[2]*q[3] + q[0]*q[1]), q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3] }
+	};
+	for (int i = 0; i < 3; i++)
+		b[i] = Reb[0][i] * e[0] + Reb[1][i] * e[1] + Reb[2][i] * e[2];
+}
+
+static void write_trace(FILE *trace)
+{
+	float state[16];
+	float var[MAX_STATES] = { 0 };
+
+	INSGetState(&state[0], &state[3], &state[6], &state[10], &state[13]);
+	INSGetVariance(var);
+
+	fwrite(state, sizeof(state), 1, trace);
+	fwrite(var, sizeof(var), 1, trace);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3) {
+		fprintf(stderr, "usage: %s <steps> <trace file>\n", argv[0]);
+		return 1;
+	}
+
+	uint32_t steps = strtoul(argv[1], NULL, 0);
+	FILE *trace = fopen(argv[2], "wb");
+	if (trace == NULL) {
+		perror(argv[2]);
+		return 1;
+	}
+
+	/* Same setup as init() in insmodule.c and CINS.prepare() */
+	INSGPSInit();
+	const float Be[] = {400, 0, 1600};
+	INSSetMagNorth(Be);
+
+	const float mag_var[] = {10.0f, 10.0f, 100.0f};
+	const float gyro_var[] = {1e-5f, 1e-5f, 1e-4f};
+	const float accel_var[] = {0.01f, 0.01f, 0.01f};
+	INSSetMagVar(mag_var);
+	INSSetGyroVar(gyro_var);
+	INSSetAccelVar(accel_var);
+	INSSetBaroVar(0.1f);
+	INSSetPosVelVar(1e-3f, 1e-2f, 10);
+
+	const float dT = 1.0f / 666.0f;
+	const float mag[3] = {400, 0, 1600};
+	const float gravity[3] = {0, 0, -9.805f};
+	const float zeros[3] = {0, 0, 0};
+	float q_true[4] = {1, 0, 0, 0};
+
+	uint64_t predict_time = 0, correct_time = 0;
+	uint32_t corrections = 0;
+
+	for (uint32_t k = 0; k < steps; k++) {
+		/* Slow wobble in place so the attitude blocks of F and H are exercised */
+		float t = k * dT;
+		float w[3] = { 0.3f * sinf(t * 1.3f), 0.2f * sinf(t * 0.7f), 0.1f * sinf(t * 0.4f) };
+		rotate(q_true, w, dT);
+
+		float gyro[3] = { w[0] + noise(1e-3f), w[1] + noise(1e-3f), w[2] + noise(1e-3f) };
+		float accel[3];
+		earth_to_body(q_true, gravity, accel);
+		for (int i = 0; i < 3; i++)
+			accel[i] += noise(1e-3f);
+
+		uint64_t start = now();
+		INSStatePrediction(gyro, accel, dT);
+		INSCovariancePrediction(dT);
+		predict_time += now() - start;
+
+		write_trace(trace);
+
+		uint16_t sensors = 0;
+		float pos[3] = { noise(1e-3f), noise(1e-3f), noise(1e-3f) };
+		float vel[3] = { noise(1e-3f), noise(1e-3f), noise(1e-3f) };
+		float mag_meas[3];
+		earth_to_body(q_true, mag, mag_meas);
+		for (int i = 0; i < 3; i++)
+			mag_meas[i] += noise(10);
+
+		if (k % 60 == 59)
+			sensors |= POS_SENSORS | HORIZ_VEL_SENSORS | VERT_VEL_SENSORS;
+		if (k % 20 == 8)
+			sensors |= BARO_SENSOR;
+		if (k % 20 == 15)
+			sensors |= MAG_SENSORS;
+
+		if (sensors) {
+			start = now();
+			INSCorrection(mag_meas, pos, vel, -pos[2], sensors);
+			correct_time += now() - start;
+			corrections++;
+
+			write_trace(trace);
+		}
+
+		/* Keep the biases pinned the way the attitude module does while warming up */
+		if (k < steps / 10) {
+			INSSetGyroBias(zeros);
+			INSSetAccelBias(zeros);
+		}
+	}
+
+	fclose(trace);
+
+	printf("states %u\n", ins_get_num_states());
+	printf("prediction %.1f %s/update\n", (double) predict_time / steps, TIME_UNITS);
+	printf("correction %.1f %s/update\n", corrections ? (double) correct_time / corrections : 0.0, TIME_UNITS);
+
+	return 0;
+}
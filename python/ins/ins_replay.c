@@ -0,0 +1,709 @@
+/**
+ ******************************************************************************
+ * @file       ins_replay.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2016
+ * @brief      Replay a flight log through the INSGPS many times in parallel
+ *
+ * Decodes the Gyros, Accels, Magnetometer, GPSPosition, GPSVelocity and
+ * BaroAltitude updates from a UAVTalk log once, then replays them through
+ * insgps14state.c once for every set of noise parameters given, spread
+ * over worker processes (the filter keeps its state in globals). Each run
+ * reports the normalized innovation squared of the GPS and baro updates
+ * and the heading innovation of the mag, which is what tuning the
+ * INSSettings variances is about. The object ids depend on the UAVO
+ * definitions the log was made with, batch_replay.py looks them up.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <insgps.h>
+#include "physical_constants.h"
+
+/* UAVTalk framing, see flight/UAVTalk/uavtalk.c */
+#define UAVTALK_SYNC_VAL       0x3C
+#define UAVTALK_TYPE_MASK      0x78
+#define UAVTALK_TYPE_VER       0x20
+#define UAVTALK_TIMESTAMPED    0x80
+#define UAVTALK_TYPE_OBJ       0x00
+#define UAVTALK_TYPE_OBJ_ACK   0x02
+#define UAVTALK_TYPE_OBJ_MULTI 0x05
+#define UAVTALK_HEADER_LENGTH  8
+#define UAVTALK_MAX_LENGTH     256
+
+/* Indexed GCS logs group the records in chunks, see logindex.h in the GCS */
+#define LOG_CONTAINER_MAGIC    "TLLC"
+#define LOG_CONTAINER_LENGTH   8
+#define LOG_CHUNK_MAGIC        0x4B434C54
+#define LOG_CHUNK_HEADER_LENGTH 20
+
+enum sensor {
+	SENSOR_GYROS,
+	SENSOR_ACCELS,
+	SENSOR_MAG,
+	SENSOR_GPS_POSITION,
+	SENSOR_GPS_VELOCITY,
+	SENSOR_BARO,
+	SENSOR_LAST
+};
+
+static const char *sensor_names[SENSOR_LAST] = {
+	"Gyros", "Accels", "Magnetometer", "GPSPosition", "GPSVelocity", "BaroAltitude"
+};
+
+/* Bytes of each object that are read. Fields are serialized largest type
+ * first, so these are the leading float/int32 fields of each object. */
+static const uint8_t sensor_min_len[SENSOR_LAST] = { 12, 12, 12, 12, 12, 4 };
+
+struct event {
+	uint32_t time_ms;
+	uint8_t sensor;
+	float v[3];
+};
+
+struct log {
+	struct event *events;
+	uint32_t num_events;
+	uint32_t num_gyros;
+	float dT;
+};
+
+/* The variances of one run, in the order of a parameter file line */
+struct params {
+	float gyro_var[3];
+	float accel_var[3];
+	float mag_var[3];
+	float baro_var;
+	float gps_pos_var;
+	float gps_vel_var;
+	float gps_vert_pos_var;
+};
+#define NUM_PARAMS 13
+
+struct innovation {
+	uint32_t count;
+	double sum_sq;		//!< sum of innovation squared
+	double sum_nis;		//!< sum of innovation squared over its predicted variance
+};
+
+enum innovation_type {
+	INNOV_POS,
+	INNOV_VEL,
+	INNOV_BARO,
+	INNOV_HEADING,
+	INNOV_LAST
+};
+
+struct result {
+	uint32_t run;
+	struct innovation innov[INNOV_LAST];
+	bool diverged;
+};
+
+static uint8_t crc8(uint8_t crc, const uint8_t *data, uint32_t length)
+{
+	while (length--) {
+		crc ^= *data++;
+		for (int i = 0; i < 8; i++)
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+	}
+	return crc;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static float get_float(const uint8_t *p)
+{
+	uint32_t u = get_u32(p);
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+/**
+ * Append an object update to the event list if it is one of the sensors
+ */
+static void add_event(struct log *log, uint32_t *capacity, const uint32_t ids[SENSOR_LAST],
+		uint32_t obj_id, uint32_t time_ms, const uint8_t *data, uint32_t len)
+{
+	int s;
+	for (s = 0; s < SENSOR_LAST; s++)
+		if (ids[s] == obj_id)
+			break;
+
+	if (s == SENSOR_LAST || len < sensor_min_len[s])
+		return;
+
+	if (log->num_events == *capacity) {
+		*capacity = *capacity ? *capacity * 2 : 65536;
+		log->events = realloc(log->events, *capacity * sizeof(*log->events));
+		if (log->events == NULL) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+
+	struct event *ev = &log->events[log->num_events++];
+	ev->time_ms = time_ms;
+	ev->sensor = s;
+
+	if (s == SENSOR_GPS_POSITION) {
+		// Latitude and longitude stay in 1e-7 deg until home is known
+		ev->v[0] = (int32_t) get_u32(&data[0]);
+		ev->v[1] = (int32_t) get_u32(&data[4]);
+		ev->v[2] = get_float(&data[8]);
+	} else {
+		for (int i = 0; i < (s == SENSOR_BARO ? 1 : 3); i++)
+			ev->v[i] = get_float(&data[i * 4]);
+	}
+
+	if (s == SENSOR_GYROS)
+		log->num_gyros++;
+}
+
+struct parse_state {
+	uint32_t capacity;
+	uint32_t time_ms;
+	uint32_t last_timestamp;
+	uint32_t timestamp_base;
+	uint32_t bad_packets;
+};
+
+/**
+ * Decode the sensor updates of a run of UAVTalk packets
+ * @param[in] buf the log contents
+ * @param[in] pos start of the packets
+ * @param[in] end end of the packets
+ * @param[in] ids the object ids of the sensors, indexed by enum sensor
+ * @param[in] gcs_timestamps the log has the GCS timestamp before every packet
+ * @param[in,out] state decoder state carried over from the previous run
+ * @param[out] log the decoded sensor updates
+ */
+static void parse_packets(const uint8_t *buf, uint32_t pos, uint32_t end,
+		const uint32_t ids[SENSOR_LAST], bool gcs_timestamps,
+		struct parse_state *state, struct log *log)
+{
+	while (pos + UAVTALK_HEADER_LENGTH + 1 <= end) {
+		if (gcs_timestamps) {
+			if (pos + 12 > end)
+				break;
+			state->time_ms = get_u32(&buf[pos]);
+			pos += 12;
+		}
+
+		if (buf[pos] != UAVTALK_SYNC_VAL ||
+				(buf[pos + 1] & UAVTALK_TYPE_MASK) != UAVTALK_TYPE_VER) {
+			pos++;
+			state->bad_packets++;
+			continue;
+		}
+
+		uint8_t type = buf[pos + 1] & ~UAVTALK_TYPE_MASK;
+		uint16_t length = buf[pos + 2] | (buf[pos + 3] << 8);
+		uint32_t obj_id = get_u32(&buf[pos + 4]);
+
+		if (length < UAVTALK_HEADER_LENGTH || length > UAVTALK_MAX_LENGTH ||
+				pos + length + 1 > end ||
+				crc8(0, &buf[pos], length) != buf[pos + length]) {
+			pos++;
+			state->bad_packets++;
+			continue;
+		}
+
+		const uint8_t *data = &buf[pos + UAVTALK_HEADER_LENGTH];
+		uint32_t data_len = length - UAVTALK_HEADER_LENGTH;
+
+		if ((type & UAVTALK_TIMESTAMPED) && data_len >= 2) {
+			// The sensors are all single instance so the timestamp comes first
+			uint32_t timestamp = data[0] | (data[1] << 8);
+			if (timestamp < state->last_timestamp)
+				state->timestamp_base += 65536;
+			state->last_timestamp = timestamp;
+			if (!gcs_timestamps)
+				state->time_ms = state->timestamp_base + timestamp;
+			data += 2;
+			data_len -= 2;
+		}
+
+		type &= ~UAVTALK_TIMESTAMPED;
+
+		if (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_ACK) {
+			add_event(log, &state->capacity, ids, obj_id, state->time_ms, data, data_len);
+		} else if (type == UAVTALK_TYPE_OBJ_MULTI) {
+			// Entries of a batched frame: objid(4) + instid(2) + len(1) + data
+			uint32_t offset = 0;
+			while (offset + 7 <= data_len) {
+				uint32_t entry_id = get_u32(&data[offset]);
+				uint8_t entry_len = data[offset + 6];
+				offset += 7;
+				if (offset + entry_len > data_len)
+					break;
+				add_event(log, &state->capacity, ids, entry_id, state->time_ms, &data[offset], entry_len);
+				offset += entry_len;
+			}
+		}
+
+		pos += length + 1;
+	}
+}
+
+/**
+ * Decode the sensor updates of a UAVTalk log
+ * @param[in] buf the log contents
+ * @param[in] size length of the log
+ * @param[in] ids the object ids of the sensors, indexed by enum sensor
+ * @param[in] gcs_timestamps the log has the GCS timestamp before every packet
+ * @param[out] log the decoded sensor updates
+ */
+static void parse_log(const uint8_t *buf, uint32_t size, const uint32_t ids[SENSOR_LAST],
+		bool gcs_timestamps, struct log *log)
+{
+	struct parse_state state = { 0 };
+	uint32_t pos = 0;
+
+	// Skip the header GCS puts ahead of the data, four lines ending with ##
+	if (size > 18 && memcmp(buf, "Tau Labs git hash:", 18) == 0) {
+		for (int lines = 0; lines < 4 && pos < size; pos++)
+			if (buf[pos] == '\n')
+				lines++;
+	}
+
+	if (pos + LOG_CONTAINER_LENGTH <= size &&
+			memcmp(&buf[pos], LOG_CONTAINER_MAGIC, 4) == 0) {
+		// Walk the chunks of an indexed log, the index follows the last one
+		pos += LOG_CONTAINER_LENGTH;
+		while (pos + LOG_CHUNK_HEADER_LENGTH <= size &&
+				get_u32(&buf[pos]) == LOG_CHUNK_MAGIC) {
+			uint32_t start = pos + LOG_CHUNK_HEADER_LENGTH;
+			uint32_t bytes = get_u32(&buf[pos + 8]);
+			uint32_t end = (bytes > size - start) ? size : start + bytes;
+
+			parse_packets(buf, start, end, ids, gcs_timestamps, &state, log);
+			pos = end;
+		}
+	} else {
+		parse_packets(buf, pos, size, ids, gcs_timestamps, &state, log);
+	}
+
+	if (state.bad_packets)
+		fprintf(stderr, "skipped %u bytes that were not valid packets\n", state.bad_packets);
+}
+
+/**
+ * Turn the GPS positions into NED relative to the first one, the baro
+ * into height above the first reading, and work out the gyro period
+ * @return false if the log can not be replayed
+ */
+static bool prepare_log(struct log *log)
+{
+	struct event *first[SENSOR_LAST] = { NULL };
+	struct event *last_gyro = NULL;
+
+	for (uint32_t i = 0; i < log->num_events; i++) {
+		struct event *ev = &log->events[i];
+		if (first[ev->sensor] == NULL)
+			first[ev->sensor] = ev;
+		if (ev->sensor == SENSOR_GYROS)
+			last_gyro = ev;
+	}
+
+	for (int s = 0; s < SENSOR_LAST; s++)
+		fprintf(stderr, "%-14s %s\n", sensor_names[s], first[s] ? "found" : "missing");
+
+	if (first[SENSOR_GYROS] == NULL || first[SENSOR_ACCELS] == NULL || log->num_gyros < 2)
+		return false;
+
+	// Like replay_log.py the prediction steps at the mean gyro period,
+	// the log timestamps are only milliseconds
+	log->dT = (last_gyro->time_ms - first[SENSOR_GYROS]->time_ms) / 1000.0f / (log->num_gyros - 1);
+	if (!(log->dT > 0))
+		return false;
+
+	if (first[SENSOR_GPS_POSITION]) {
+		float lat0 = first[SENSOR_GPS_POSITION]->v[0];
+		float lon0 = first[SENSOR_GPS_POSITION]->v[1];
+		float alt0 = first[SENSOR_GPS_POSITION]->v[2];
+		float T[2] = {
+			alt0 + 6.378137E6f,
+			cosf(lat0 / 10e6f * DEG2RAD) * (alt0 + 6.378137E6f)
+		};
+
+		for (uint32_t i = 0; i < log->num_events; i++) {
+			struct event *ev = &log->events[i];
+			if (ev->sensor != SENSOR_GPS_POSITION)
+				continue;
+			float ned[3] = {
+				(ev->v[0] - lat0) / 10e6f * DEG2RAD * T[0],
+				(ev->v[1] - lon0) / 10e6f * DEG2RAD * T[1],
+				-(ev->v[2] - alt0)
+			};
+			memcpy(ev->v, ned, sizeof(ned));
+		}
+	}
+
+	if (first[SENSOR_BARO]) {
+		float baro0 = first[SENSOR_BARO]->v[0];
+		for (uint32_t i = 0; i < log->num_events; i++)
+			if (log->events[i].sensor == SENSOR_BARO)
+				log->events[i].v[0] -= baro0;
+	}
+
+	return true;
+}
+
+static void add_innovation(struct innovation *innov, float error, float variance)
+{
+	innov->count++;
+	innov->sum_sq += error * error;
+	innov->sum_nis += error * error / variance;
+}
+
+/**
+ * Heading of the body frame mag in the earth frame, relative to the
+ * heading of the expected field
+ */
+static float heading_error(const float q[4], const float mag[3], const float Be[3])
+{
+	const float Reb[2][3] = {
+		{ q[0]*q[0] + q[1]*q[1] - q[2]*q[2] - q[3]*q[3], 2*(q[1]*q[2] - q[0]*q[3]), 2*(q[1]*q[3] + q[0]*q[2]) },
+		{ 2*(q[1]*q[2] + q[0]*q[3]), q[0]*q[0] - q[1]*q[1] + q[2]*q[2] - q[3]*q[3], 2*(q[2]*q[3] - q[0]*q[1]) },
+	};
+	float north = Reb[0][0] * mag[0] + Reb[0][1] * mag[1] + Reb[0][2] * mag[2];
+	float east = Reb[1][0] * mag[0] + Reb[1][1] * mag[1] + Reb[1][2] * mag[2];
+
+	float error = atan2f(east, north) - atan2f(Be[1], Be[0]);
+	if (error > PI)
+		error -= 2 * PI;
+	else if (error < -PI)
+		error += 2 * PI;
+
+	return error * RAD2DEG;
+}
+
+/**
+ * Run the whole log through the filter with one set of variances
+ */
+static void replay(const struct log *log, const struct params *params, const float Be[3],
+		struct result *result)
+{
+	INSGPSInit();
+	INSSetMagNorth(Be);
+	INSSetGyroVar(params->gyro_var);
+	INSSetAccelVar(params->accel_var);
+	INSSetMagVar(params->mag_var);
+	INSSetBaroVar(params->baro_var);
+	INSSetPosVelVar(params->gps_pos_var, params->gps_vel_var, params->gps_vert_pos_var);
+
+	float accel[3] = { 0, 0, -GRAVITY };
+	float mag[3] = { 0 }, gps_pos[3] = { 0 }, gps_vel[3] = { 0 }, baro = 0;
+	uint16_t sensors = 0;
+
+	for (uint32_t i = 0; i < log->num_events; i++) {
+		const struct event *ev = &log->events[i];
+
+		switch (ev->sensor) {
+		case SENSOR_ACCELS:
+			memcpy(accel, ev->v, sizeof(accel));
+			continue;
+		case SENSOR_MAG:
+			memcpy(mag, ev->v, sizeof(mag));
+			sensors |= MAG_SENSORS;
+			continue;
+		case SENSOR_GPS_POSITION:
+			memcpy(gps_pos, ev->v, sizeof(gps_pos));
+			sensors |= POS_SENSORS;
+			continue;
+		case SENSOR_GPS_VELOCITY:
+			memcpy(gps_vel, ev->v, sizeof(gps_vel));
+			sensors |= HORIZ_VEL_SENSORS | VERT_VEL_SENSORS;
+			continue;
+		case SENSOR_BARO:
+			baro = ev->v[0];
+			sensors |= BARO_SENSOR;
+			continue;
+		}
+
+		// Every gyro sample advances the filter, like updateAttitudeINSGPS
+		const float gyro[3] = { ev->v[0] * DEG2RAD, ev->v[1] * DEG2RAD, ev->v[2] * DEG2RAD };
+		INSStatePrediction(gyro, accel, log->dT);
+		INSCovariancePrediction(log->dT);
+
+		if (sensors == 0)
+			continue;
+
+		// Innovations against the prediction, before the correction uses them
+		float pos[3], vel[3], q[4], var[16];
+		INSGetState(pos, vel, q, NULL, NULL);
+		INSGetVariance(var);
+
+		if (sensors & POS_SENSORS) {
+			add_innovation(&result->innov[INNOV_POS], gps_pos[0] - pos[0], var[0] + params->gps_pos_var);
+			add_innovation(&result->innov[INNOV_POS], gps_pos[1] - pos[1], var[1] + params->gps_pos_var);
+			add_innovation(&result->innov[INNOV_POS], gps_pos[2] - pos[2], var[2] + params->gps_vert_pos_var);
+		}
+		if (sensors & HORIZ_VEL_SENSORS) {
+			for (int j = 0; j < 3; j++)
+				add_innovation(&result->innov[INNOV_VEL], gps_vel[j] - vel[j], var[3 + j] + params->gps_vel_var);
+		}
+		if (sensors & BARO_SENSOR)
+			add_innovation(&result->innov[INNOV_BARO], baro + pos[2], var[2] + params->baro_var);
+		if (sensors & MAG_SENSORS)
+			add_innovation(&result->innov[INNOV_HEADING], heading_error(q, mag, Be), 1);
+
+		INSCorrection(mag, gps_pos, gps_vel, baro, sensors);
+		sensors = 0;
+
+		INSGetState(pos, NULL, q, NULL, NULL);
+		if (isnan(q[0]) || isnan(pos[0])) {
+			result->diverged = true;
+			return;
+		}
+	}
+}
+
+static uint32_t read_params(const char *path, struct params **params)
+{
+	FILE *f = fopen(path, "r");
+	if (f == NULL) {
+		perror(path);
+		exit(1);
+	}
+
+	uint32_t count = 0, capacity = 0;
+	char line[1024];
+	while (fgets(line, sizeof(line), f)) {
+		char *p = line;
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '#' || *p == '\n' || *p == 0)
+			continue;
+
+		float v[NUM_PARAMS];
+		int n = 0;
+		for (; n < NUM_PARAMS; n++) {
+			char *end;
+			v[n] = strtof(p, &end);
+			if (end == p)
+				break;
+			p = end;
+		}
+		if (n != NUM_PARAMS) {
+			fprintf(stderr, "%s: expected %d variances on line: %s", path, NUM_PARAMS, line);
+			exit(1);
+		}
+
+		if (count == capacity) {
+			capacity = capacity ? capacity * 2 : 64;
+			*params = realloc(*params, capacity * sizeof(**params));
+		}
+		struct params *set = &(*params)[count++];
+		memcpy(set->gyro_var, &v[0], sizeof(set->gyro_var));
+		memcpy(set->accel_var, &v[3], sizeof(set->accel_var));
+		memcpy(set->mag_var, &v[6], sizeof(set->mag_var));
+		set->baro_var = v[9];
+		set->gps_pos_var = v[10];
+		set->gps_vel_var = v[11];
+		set->gps_vert_pos_var = v[12];
+	}
+
+	fclose(f);
+	return count;
+}
+
+static void print_result(const struct params *params, const struct result *result)
+{
+	const struct params *p = &params[result->run];
+	printf("%4u  %g %g %g  %g %g %g  %g %g %g  %g  %g %g %g ", result->run,
+		p->gyro_var[0], p->gyro_var[1], p->gyro_var[2],
+		p->accel_var[0], p->accel_var[1], p->accel_var[2],
+		p->mag_var[0], p->mag_var[1], p->mag_var[2],
+		p->baro_var, p->gps_pos_var, p->gps_vel_var, p->gps_vert_pos_var);
+
+	if (result->diverged) {
+		printf(" diverged\n");
+		return;
+	}
+
+	for (int i = 0; i < INNOV_LAST; i++) {
+		const struct innovation *innov = &result->innov[i];
+		if (innov->count == 0)
+			printf(" %8s", "-");
+		else
+			printf(" %8.3f", sqrt(innov->sum_sq / innov->count));
+
+		// The heading has no variance in the filter to normalize with
+		if (i == INNOV_HEADING)
+			continue;
+
+		if (innov->count == 0)
+			printf(" %8s", "-");
+		else
+			printf(" %8.3f", innov->sum_nis / innov->count);
+	}
+	printf("\n");
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-j jobs] [-t] [-b Be_n,Be_e,Be_d] -i gyros,accels,mag,gpspos,gpsvel,baro log params\n"
+		"  -i    object ids (hex) of the sensors, see batch_replay.py\n"
+		"  -t    the log has GCS timestamps before every packet\n"
+		"  -b    earth magnetic field in the units of the Magnetometer (default 400,0,1600)\n"
+		"  -j    number of worker processes (default one per cpu)\n"
+		"  params has one run per line: gyro_var[3] accel_var[3] mag_var[3] baro_var\n"
+		"        gps_pos_var gps_vel_var gps_vert_pos_var\n", name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t ids[SENSOR_LAST];
+	bool have_ids = false, gcs_timestamps = false;
+	float Be[3] = { 400, 0, 1600 };
+	long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	int opt;
+
+	while ((opt = getopt(argc, argv, "i:tb:j:")) != -1) {
+		switch (opt) {
+		case 'i':
+			have_ids = sscanf(optarg, "%x,%x,%x,%x,%x,%x", &ids[0], &ids[1], &ids[2],
+					&ids[3], &ids[4], &ids[5]) == SENSOR_LAST;
+			break;
+		case 't':
+			gcs_timestamps = true;
+			break;
+		case 'b':
+			if (sscanf(optarg, "%f,%f,%f", &Be[0], &Be[1], &Be[2]) != 3)
+				usage(argv[0]);
+			break;
+		case 'j':
+			jobs = strtol(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+
+	if (!have_ids || argc - optind != 2 || jobs < 1)
+		usage(argv[0]);
+
+	FILE *f = fopen(argv[optind], "rb");
+	if (f == NULL) {
+		perror(argv[optind]);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	uint8_t *buf = malloc(size);
+	if (buf == NULL || fread(buf, 1, size, f) != (size_t) size) {
+		perror(argv[optind]);
+		return 1;
+	}
+	fclose(f);
+
+	struct log log = { 0 };
+	parse_log(buf, size, ids, gcs_timestamps, &log);
+	free(buf);
+
+	if (!prepare_log(&log)) {
+		fprintf(stderr, "%s: not enough gyro and accel data to replay\n", argv[optind]);
+		return 1;
+	}
+
+	struct params *params = NULL;
+	uint32_t num_runs = read_params(argv[optind + 1], &params);
+	if (num_runs < (uint32_t) jobs)
+		jobs = num_runs;
+
+	fprintf(stderr, "%u events, %u gyro samples at %.1f Hz, %u runs on %ld workers\n",
+		log.num_events, log.num_gyros, 1.0f / log.dT, num_runs, jobs);
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	// Every worker replays runs worker, worker + jobs, ... and sends back the results
+	int pipes[jobs];
+	for (long w = 0; w < jobs; w++) {
+		int fds[2];
+		if (pipe(fds) != 0) {
+			perror("pipe");
+			return 1;
+		}
+
+		pid_t pid = fork();
+		if (pid < 0) {
+			perror("fork");
+			return 1;
+		}
+
+		if (pid == 0) {
+			close(fds[0]);
+			for (uint32_t run = w; run < num_runs; run += jobs) {
+				struct result result = { .run = run };
+				replay(&log, &params[run], Be, &result);
+				if (write(fds[1], &result, sizeof(result)) != sizeof(result))
+					_exit(1);
+			}
+			_exit(0);
+		}
+
+		close(fds[1]);
+		pipes[w] = fds[0];
+	}
+
+	struct result *results = calloc(num_runs, sizeof(*results));
+	for (long w = 0; w < jobs; w++) {
+		struct result result;
+		while (read(pipes[w], &result, sizeof(result)) == sizeof(result))
+			if (result.run < num_runs)
+				results[result.run] = result;
+		close(pipes[w]);
+	}
+
+	int failed = 0, status;
+	while (wait(&status) > 0)
+		failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	printf("# run  gyro_var[3]  accel_var[3]  mag_var[3]  baro_var  gps_pos/vel/vert_var "
+		" pos_rms pos_nis  vel_rms vel_nis  baro_rms baro_nis  heading_rms(deg)\n");
+	for (uint32_t run = 0; run < num_runs; run++)
+		print_result(params, &results[run]);
+
+	fprintf(stderr, "%u runs in %.2f s\n", num_runs,
+		(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9);
+
+	return failed;
+}
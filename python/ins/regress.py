@@ -0,0 +1,87 @@
+#!/usr/bin/env python
+"""
+Compare the INSGPS filter in the working tree against a reference revision.
+
+Both versions are built into ins_regress (the same setup insmodule.c uses)
+and fed an identical sequence of predictions and corrections. The state
+and variance trace of the two runs must match bit for bit, and the time
+per update of each is reported.
+
+   python regress.py [--ref HEAD] [--filter insgps14state] [--steps 20000] [-D GENERAL_COV]
+"""
+
+from __future__ import print_function
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TOP = os.path.normpath(os.path.join(HERE, '..', '..'))
+
+CFLAGS = ['-O2', '-std=gnu99', '-ffp-contract=off',
+          '-I' + os.path.join(TOP, 'flight', 'Libraries', 'inc'),
+          '-I' + os.path.join(TOP, 'shared', 'api')]
+
+def build(source, output, defines):
+    cmd = [os.environ.get('CC', 'gcc')] + CFLAGS + ['-D' + d for d in defines] + \
+          [os.path.join(HERE, 'ins_regress.c'), source, '-lm', '-o', output]
+    subprocess.check_call(cmd)
+
+def run(binary, steps, trace):
+    out = subprocess.check_output([binary, str(steps), trace]).decode()
+    return dict(line.rsplit(' ', 2)[0:2] for line in out.splitlines()[1:]), out
+
+def first_difference(a, b, record):
+    for i in range(0, min(len(a), len(b)), record):
+        if a[i:i + record] != b[i:i + record]:
+            return i // record
+    return min(len(a), len(b)) // record
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument('--ref', default='HEAD', help='git revision to compare against')
+    parser.add_argument('--filter', default='insgps14state', help='filter source in flight/Libraries')
+    parser.add_argument('--steps', type=int, default=20000, help='number of predictions to run')
+    parser.add_argument('-D', dest='defines', action='append', default=[], help='extra define for both builds')
+    args = parser.parse_args()
+
+    path = 'flight/Libraries/%s.c' % args.filter
+    tmp = tempfile.mkdtemp()
+    try:
+        ref_source = os.path.join(tmp, 'ref_' + os.path.basename(path))
+        with open(ref_source, 'wb') as f:
+            f.write(subprocess.check_output(['git', 'show', '%s:%s' % (args.ref, path)], cwd=TOP))
+
+        ref_bin = os.path.join(tmp, 'ins_regress_ref')
+        new_bin = os.path.join(tmp, 'ins_regress_new')
+        build(ref_source, ref_bin, args.defines)
+        build(os.path.join(TOP, path), new_bin, args.defines)
+
+        ref_times, _ = run(ref_bin, args.steps, os.path.join(tmp, 'ref.trace'))
+        new_times, _ = run(new_bin, args.steps, os.path.join(tmp, 'new.trace'))
+
+        print('%-12s %16s %16s' % ('', args.ref, 'working tree'))
+        for update in ('prediction', 'correction'):
+            print('%-12s %16s %16s' % (update, ref_times[update], new_times[update]))
+
+        with open(os.path.join(tmp, 'ref.trace'), 'rb') as f:
+            ref_trace = f.read()
+        with open(os.path.join(tmp, 'new.trace'), 'rb') as f:
+            new_trace = f.read()
+
+        if ref_trace == new_trace:
+            print('traces match bit for bit (%d bytes)' % len(ref_trace))
+            return 0
+
+        # 16 state floats and 16 variances per record
+        print('traces differ from update %d' % first_difference(ref_trace, new_trace, 32 * 4))
+        return 1
+    finally:
+        shutil.rmtree(tmp)
+
+if __name__ == '__main__':
+    sys.exit(main())
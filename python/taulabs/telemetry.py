@@ -16,6 +16,7 @@ import threading
 import uavtalk, uavo_collection, uavo
 
 import os
+import struct
 
 from abc import ABCMeta, abstractmethod
 
@@ -496,6 +497,7 @@ class FileTelemetry(TelemetryBase):
         """
 
         self.f = file_obj
+        self.chunked = False
 
         if parse_header:
             # Check the header signature
@@ -519,6 +521,15 @@ class FileTelemetry(TelemetryBase):
             uavohash = self.f.readline()
             divider = self.f.readline()
 
+            # Indexed logs group the records in chunks and end with an
+            # index; only the records are handed on to the parser
+            container = self.f.read(4)
+            if container == 'TLLC':
+                self.f.read(4)      # container version
+                self.chunked = True
+            else:
+                self.f.seek(-len(container), os.SEEK_CUR)
+
             TelemetryBase.__init__(self, service_in_iter=False, iter_blocks=True,
                 do_handshaking=False, githash=githash, use_walltime=False,
                 *args, **kwargs)
@@ -532,10 +543,30 @@ class FileTelemetry(TelemetryBase):
     def _receive(self, finish_time):
         """ Fetch available data from file """
 
+        if self.chunked:
+            return self._receive_chunk()
+
         buf = self.f.read(524288)   # 512k
 
         return buf
 
+    chunk_fmt = struct.Struct("<IIIII")
+    chunk_magic = 0x4B434C54    # "TLCK"
+
+    def _receive_chunk(self):
+        """ Fetch the records of the next chunk of an indexed log """
+
+        hdr = self.f.read(self.chunk_fmt.size)
+        if len(hdr) < self.chunk_fmt.size:
+            return ''
+
+        (magic, packets, length, first, last) = self.chunk_fmt.unpack(hdr)
+        if magic != self.chunk_magic:
+            # Reached the index after the last chunk
+            return ''
+
+        return self.f.read(length)
+
 def get_telemetry_by_args(desc="Process telemetry", service_in_iter=True,
         iter_blocks=True):
     """ Parses command line to decide how to get a telemetry object. """
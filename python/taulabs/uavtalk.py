@@ -20,6 +20,7 @@ __all__ = [ "send_object", "process_stream" ]
 (TYPE_MASK, TYPE_VER) = (0x78, 0x20)
 (TIMESTAMPED) = (0x80)
 (TYPE_OBJ, TYPE_OBJ_REQ, TYPE_OBJ_ACK, TYPE_ACK, TYPE_NACK, TYPE_OBJ_TS, TYPE_OBJ_ACK_TS) = (0x00, 0x01, 0x02, 0x03, 0x04, 0x80, 0x82)
+(TYPE_OBJ_MULTI) = (0x05)
 
 # Serialization of header elements
 
@@ -29,6 +30,9 @@ logheader_fmt = struct.Struct("<IQ")
 timestamp_fmt = struct.Struct("<H")
 instance_fmt = struct.Struct("<H")
 
+# Entries of a batched frame: objid(4) + instid(2) + len(1)
+multi_entry_fmt = struct.Struct("<LHB")
+
 # CRC lookup table
 crc_table = [
     0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d,
@@ -236,6 +240,32 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=False):
         if gcs_timestamps:
             timestamp = overrideTimestamp
 
+        if pack_type == TYPE_OBJ_MULTI:
+            # Batched frame, hand out every entry we know about
+            entry_offset = header_fmt.size + buf_offset
+            entry_end = calc_size + buf_offset
+
+            while entry_offset + multi_entry_fmt.size <= entry_end:
+                (entry_id, entry_inst, entry_len) = multi_entry_fmt.unpack_from(buf, entry_offset)
+                entry_offset += multi_entry_fmt.size
+
+                entry_obj = uavo_defs.get('{0:08x}'.format(entry_id))
+
+                if entry_obj is not None and entry_obj.get_size_of_data() == entry_len:
+                    instance_id = None if entry_obj._single else entry_inst
+                    objInstance = entry_obj.from_bytes(buf, timestamp, instance_id, offset=entry_offset)
+                    received += 1
+
+                    next_recv = yield objInstance
+
+                    if next_recv is not None and next_recv != '':
+                        pending_pieces.append(next_recv)
+
+                entry_offset += entry_len
+
+            buf_offset += calc_size + 1
+            continue
+
         if obj is not None:
             offset = header_fmt.size + instance_len + timestamp_len + buf_offset
             objInstance = obj.from_bytes(buf, timestamp, instance_id, offset=offset)